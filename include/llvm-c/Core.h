@@ -681,6 +681,19 @@ void LLVMAddNamedMetadataOperand(LLVMModuleRef M, const char* name,
 LLVMValueRef LLVMAddFunction(LLVMModuleRef M, const char *Name,
                              LLVMTypeRef FunctionTy);
 
+/**
+ * Add a function to a module under a specified name, where the name is
+ * given with an explicit length and need not be null terminated.
+ *
+ * The caller retains ownership of the name buffer; it is not read after
+ * the call returns. Bindings holding counted strings can use this to
+ * avoid materializing a null-terminated copy per call.
+ *
+ * @see llvm::Function::Create()
+ */
+LLVMValueRef LLVMAddFunction2(LLVMModuleRef M, const char *Name,
+                              size_t NameLen, LLVMTypeRef FunctionTy);
+
 /**
  * Obtain a Function value from a Module by its name.
  *
@@ -690,6 +703,15 @@ LLVMValueRef LLVMAddFunction(LLVMModuleRef M, const char *Name,
  */
 LLVMValueRef LLVMGetNamedFunction(LLVMModuleRef M, const char *Name);
 
+/**
+ * Obtain a Function value from a Module by its name, where the name is
+ * given with an explicit length and need not be null terminated.
+ *
+ * @see llvm::Module::getFunction()
+ */
+LLVMValueRef LLVMGetNamedFunction2(LLVMModuleRef M, const char *Name,
+                                   size_t NameLen);
+
 /**
  * Obtain an iterator to the first Function in a Module.
  *
@@ -1251,6 +1273,15 @@ LLVMTypeRef LLVMTypeOf(LLVMValueRef Val);
  */
 const char *LLVMGetValueName(LLVMValueRef Val);
 
+/**
+ * Obtain the string name of a value, returning its length through
+ * \p Length. The result points at the value's own storage and is not
+ * null terminated; it stays valid until the value is renamed or deleted.
+ *
+ * @see llvm::Value::getName()
+ */
+const char *LLVMGetValueName2(LLVMValueRef Val, size_t *Length);
+
 /**
  * Set the string name of a value.
  *
@@ -1258,6 +1289,15 @@ const char *LLVMGetValueName(LLVMValueRef Val);
  */
 void LLVMSetValueName(LLVMValueRef Val, const char *Name);
 
+/**
+ * Set the string name of a value, where the name is given with an
+ * explicit length and need not be null terminated. The caller retains
+ * ownership of the buffer.
+ *
+ * @see llvm::Value::setName()
+ */
+void LLVMSetValueName2(LLVMValueRef Val, const char *Name, size_t NameLen);
+
 /**
  * Dump a representation of a value to stderr.
  *
@@ -0,0 +1,48 @@
+//===- llvm/ADT/ADTStatistics.h - Container instrumentation -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Opt-in counters for the hot paths of the core containers.  Building with
+// -DLLVM_ENABLE_ADT_STATS=1 (for the whole tree, so the out-of-line hooks in
+// libSupport exist) makes DenseMap and SmallVector count grows, rehash
+// traffic, probe lengths and heap spills, reported through the usual -stats
+// machinery.  When the mode is off, LLVM_ADT_STAT expands to nothing and the
+// containers are exactly as before.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_ADTSTATISTICS_H
+#define LLVM_ADT_ADTSTATISTICS_H
+
+#ifndef LLVM_ENABLE_ADT_STATS
+#define LLVM_ENABLE_ADT_STATS 0
+#endif
+
+#if LLVM_ENABLE_ADT_STATS
+namespace llvm {
+namespace adtstats {
+/// The bucket array was doubled because the map exceeded its load factor.
+void countDenseMapGrow();
+/// The bucket array was rebuilt at the same size to purge tombstones.
+void countDenseMapRehash();
+/// \p NumEntries entries were reinserted while rebuilding a bucket array.
+void countDenseMapRehashedEntries(unsigned NumEntries);
+/// A bucket search finished after examining \p ProbeLength buckets.
+void countDenseMapLookup(unsigned ProbeLength);
+/// A vector grew its storage; \p SpilledFromInline is true when this was the
+/// first heap allocation, abandoning the inline elements.
+void countSmallVectorGrow(bool SpilledFromInline);
+} // end namespace adtstats
+} // end namespace llvm
+
+#define LLVM_ADT_STAT(expr) ::llvm::adtstats::expr
+#else
+#define LLVM_ADT_STAT(expr) ((void)0)
+#endif
+
+#endif
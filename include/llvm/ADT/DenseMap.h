@@ -14,6 +14,7 @@
 #ifndef LLVM_ADT_DENSEMAP_H
 #define LLVM_ADT_DENSEMAP_H
 
+#include "llvm/ADT/ADTStatistics.h"
 #include "llvm/ADT/DenseMapInfo.h"
 #include "llvm/Support/AlignOf.h"
 #include "llvm/Support/Compiler.h"
@@ -85,6 +86,18 @@ public:
       grow(Size);
   }
 
+  /// Grow the densemap so that it can contain at least \p NumEntries items
+  /// before resizing again. Unlike resize, this is in terms of entries, not
+  /// buckets: it accounts for the maximum load factor, so inserting up to
+  /// NumEntries elements afterwards is guaranteed not to rehash. Clients
+  /// that know (or can cheaply bound) their final size should call this up
+  /// front to avoid re-inserting every element on each doubling.
+  void reserve(size_type NumEntries) {
+    unsigned NumBuckets = getMinBucketToReserveForEntries(NumEntries);
+    if (NumBuckets > getNumBuckets())
+      grow(NumBuckets);
+  }
+
   void clear() {
     if (getNumEntries() == 0 && getNumTombstones() == 0) return;
 
@@ -305,6 +318,8 @@ protected:
       B->getFirst().~KeyT();
     }
 
+    LLVM_ADT_STAT(countDenseMapRehashedEntries(getNumEntries()));
+
 #ifndef NDEBUG
     if (OldBucketsBegin != OldBucketsEnd)
       memset((void*)OldBucketsBegin, 0x5a,
@@ -399,6 +414,17 @@ private:
     static_cast<DerivedT *>(this)->grow(AtLeast);
   }
 
+  /// Returns the number of buckets to allocate to ensure that the DenseMap
+  /// can accommodate \p NumEntries without needing to grow().
+  unsigned getMinBucketToReserveForEntries(unsigned NumEntries) const {
+    // Ensure that "NumEntries * 4 < NumBuckets * 3"
+    if (NumEntries == 0)
+      return 0;
+    // +1 is required because of the strict equality.
+    // For example if NumEntries is 48, we need to return 128.
+    return NextPowerOf2(NumEntries * 4 / 3 + 1);
+  }
+
   void shrink_and_clear() {
     static_cast<DerivedT *>(this)->shrink_and_clear();
   }
@@ -443,11 +469,13 @@ private:
     unsigned NewNumEntries = getNumEntries() + 1;
     unsigned NumBuckets = getNumBuckets();
     if (LLVM_UNLIKELY(NewNumEntries * 4 >= NumBuckets * 3)) {
+      LLVM_ADT_STAT(countDenseMapGrow());
       this->grow(NumBuckets * 2);
       LookupBucketFor(Key, TheBucket);
       NumBuckets = getNumBuckets();
     } else if (LLVM_UNLIKELY(NumBuckets-(NewNumEntries+getNumTombstones()) <=
                              NumBuckets/8)) {
+      LLVM_ADT_STAT(countDenseMapRehash());
       this->grow(NumBuckets);
       LookupBucketFor(Key, TheBucket);
     }
@@ -494,6 +522,7 @@ private:
       const BucketT *ThisBucket = BucketsPtr + BucketNo;
       // Found Val's bucket?  If so, return it.
       if (LLVM_LIKELY(KeyInfoT::isEqual(Val, ThisBucket->getFirst()))) {
+        LLVM_ADT_STAT(countDenseMapLookup(ProbeAmt));
         FoundBucket = ThisBucket;
         return true;
       }
@@ -503,6 +532,7 @@ private:
       if (LLVM_LIKELY(KeyInfoT::isEqual(ThisBucket->getFirst(), EmptyKey))) {
         // If we've already seen a tombstone while probing, fill it in instead
         // of the empty bucket we eventually probed to.
+        LLVM_ADT_STAT(countDenseMapLookup(ProbeAmt));
         FoundBucket = FoundTombstone ? FoundTombstone : ThisBucket;
         return false;
       }
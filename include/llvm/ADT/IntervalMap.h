@@ -102,6 +102,7 @@
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/RecyclingAllocator.h"
 #include <iterator>
 
@@ -606,6 +607,26 @@ public:
     return Traits::startLess(x, start(i)) ? NotFound : value(i);
   }
 
+  /// safeLookup - Lookup mapped value for a safe key when the node size is
+  /// known. The search is a branchless binary search over the stop keys: the
+  /// range update compiles to a conditional move, so the descent does not
+  /// depend on branch prediction. Prefer this form for lookups without a
+  /// position hint.
+  /// @param x        Key to search for.
+  /// @param NotFound Value to return if x is not in any interval.
+  /// @param Size     Number of elements in node.
+  /// @return         The mapped value at x or NotFound.
+  ValT safeLookup(KeyT x, ValT NotFound, unsigned Size) const {
+    assert(Size >= 1 && Size <= N && "Bad size");
+    assert(!Traits::stopLess(stop(Size - 1), x) && "Unsafe intervals");
+    unsigned i = 0;
+    for (unsigned Len = Size; Len > 1; Len -= Len / 2) {
+      unsigned Half = Len / 2;
+      i = Traits::stopLess(stop(i + Half - 1), x) ? i + Half : i;
+    }
+    return Traits::startLess(x, start(i)) ? NotFound : value(i);
+  }
+
   unsigned insertFrom(unsigned &Pos, unsigned Size, KeyT a, KeyT b, ValT y);
 };
 
@@ -738,6 +759,27 @@ public:
     return subtree(safeFind(0, x));
   }
 
+  /// safeLookup - Get the subtree containing x when the node size is known,
+  /// using a branchless binary search over the stop keys. The middle child is
+  /// prefetched up front so its fetch overlaps the key search; it is the
+  /// first node the next level may probe either way the search goes.
+  /// @param x    Key to search for.
+  /// @param Size Number of elements in node.
+  /// @return     Subtree containing x
+  NodeRef safeLookup(KeyT x, unsigned Size) const {
+    assert(Size >= 1 && Size <= N && "Bad size");
+    assert(!Traits::stopLess(stop(Size - 1), x) && "Unsafe intervals");
+    // &subtree(i).subtree(0) is the address of child i's first element; this
+    // only forms the address, it does not dereference the child.
+    LLVM_PREFETCH(&subtree(Size / 2).subtree(0), 0, 3);
+    unsigned i = 0;
+    for (unsigned Len = Size; Len > 1; Len -= Len / 2) {
+      unsigned Half = Len / 2;
+      i = Traits::stopLess(stop(i + Half - 1), x) ? i + Half : i;
+    }
+    return subtree(i);
+  }
+
   /// insert - Insert a new (subtree, stop) pair.
   /// @param i    Insert position, following entries will be shifted.
   /// @param Size Number of elements in node.
@@ -1153,10 +1195,10 @@ ValT IntervalMap<KeyT, ValT, N, Traits>::
 treeSafeLookup(KeyT x, ValT NotFound) const {
   assert(branched() && "treeLookup assumes a branched root");
 
-  IntervalMapImpl::NodeRef NR = rootBranch().safeLookup(x);
+  IntervalMapImpl::NodeRef NR = rootBranch().safeLookup(x, rootSize);
   for (unsigned h = height-1; h; --h)
-    NR = NR.get<Branch>().safeLookup(x);
-  return NR.get<Leaf>().safeLookup(x, NotFound);
+    NR = NR.get<Branch>().safeLookup(x, NR.size());
+  return NR.get<Leaf>().safeLookup(x, NotFound, NR.size());
 }
 
 
@@ -171,6 +171,12 @@ public:
   AllocatorTy &getAllocator() { return Allocator; }
   const AllocatorTy &getAllocator() const { return Allocator; }
 
+  /// Pre-size the underlying map for \p NumEntries concurrently live keys,
+  /// so that insertions up to that count never rehash.
+  void reserve(size_type NumEntries) {
+    TopLevelMap.reserve(NumEntries);
+  }
+
   /// Return 1 if the specified key is in the table, 0 otherwise.
   size_type count(const K &Key) const {
     return TopLevelMap.count(Key);
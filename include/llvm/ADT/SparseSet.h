@@ -196,6 +196,16 @@ public:
     Dense.clear();
   }
 
+  /// pop_back_val - Remove the last element of the set and return its value.
+  ///
+  /// This is a constant time operation. The stale Sparse entry is harmless,
+  /// see find().
+  ///
+  ValueT pop_back_val() {
+    assert(!empty() && "Cannot pop an empty set");
+    return Dense.pop_back_val();
+  }
+
   /// findIndex - Find an element by its index.
   ///
   /// @param   Idx A valid index to find.
@@ -26,11 +26,48 @@
 #ifndef LLVM_ADT_STATISTIC_H
 #define LLVM_ADT_STATISTIC_H
 
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Atomic.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Valgrind.h"
+#include <stdint.h>
 
 namespace llvm {
 class raw_ostream;
+class Statistic;
+
+#if LLVM_ENABLE_THREADS && (!defined(NDEBUG) || defined(LLVM_ENABLE_STATS))
+namespace stats_detail {
+
+/// One pending update: the counter it belongs to and the amount that has
+/// not yet been folded into its value.
+struct StatisticSlot {
+  Statistic *Stat;
+  int64_t Delta;
+};
+
+/// Per-thread buffer of pending statistic updates.
+///
+/// The buffer is a small direct-mapped table indexed by a hash of the
+/// Statistic's address. Updates accumulate in the slot without any atomic
+/// operations; a slot is flushed to its counter only when another
+/// statistic hashes to the same slot, or when the statistics are printed.
+/// Buckets are registered in a global list and are intentionally never
+/// freed, so deltas left behind by exited threads can still be folded.
+struct StatisticBucket {
+  enum { NumSlots = 256 };
+  StatisticSlot Slots[NumSlots];
+  StatisticBucket *Next;
+};
+
+/// The calling thread's bucket, or null before its first update.
+extern LLVM_THREAD_LOCAL StatisticBucket *ThreadBucket;
+
+/// Allocate a bucket for the calling thread and register it.
+StatisticBucket *claimBucket();
+
+} // End namespace stats_detail
+#endif
 
 class Statistic {
 public:
@@ -49,61 +86,63 @@ public:
     Value = 0; Initialized = false;
   }
 
-  // Allow use of this class as the value itself.
+  // Allow use of this class as the value itself.  Note that when threads
+  // are enabled, this does not include deltas still buffered by other
+  // threads; those are folded in when the statistics are printed.
   operator unsigned() const { return Value; }
 
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
    const Statistic &operator=(unsigned Val) {
+    discardPending();
     Value = Val;
     return init();
   }
 
   const Statistic &operator++() {
-    // FIXME: This function and all those that follow carefully use an
-    // atomic operation to update the value safely in the presence of
-    // concurrent accesses, but not to read the return value, so the
-    // return value is not thread safe.
-    sys::AtomicIncrement(&Value);
-    return init();
+    // FIXME: This function and all those that follow update the value
+    // safely in the presence of concurrent accesses, but not the read of
+    // the return value, so the return value is not thread safe.
+    addValue(1);
+    return *this;
   }
 
   unsigned operator++(int) {
-    init();
     unsigned OldValue = Value;
-    sys::AtomicIncrement(&Value);
+    addValue(1);
     return OldValue;
   }
 
   const Statistic &operator--() {
-    sys::AtomicDecrement(&Value);
-    return init();
+    addValue(-1);
+    return *this;
   }
 
   unsigned operator--(int) {
-    init();
     unsigned OldValue = Value;
-    sys::AtomicDecrement(&Value);
+    addValue(-1);
     return OldValue;
   }
 
   const Statistic &operator+=(const unsigned &V) {
     if (!V) return *this;
-    sys::AtomicAdd(&Value, V);
-    return init();
+    addValue(V);
+    return *this;
   }
 
   const Statistic &operator-=(const unsigned &V) {
     if (!V) return *this;
-    sys::AtomicAdd(&Value, -V);
-    return init();
+    addValue(-(int64_t)V);
+    return *this;
   }
 
   const Statistic &operator*=(const unsigned &V) {
+    flushPending();
     sys::AtomicMul(&Value, V);
     return init();
   }
 
   const Statistic &operator/=(const unsigned &V) {
+    flushPending();
     sys::AtomicDiv(&Value, V);
     return init();
   }
@@ -149,6 +188,50 @@ public:
 #endif  // !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
 
 protected:
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
+#if LLVM_ENABLE_THREADS
+  /// \brief Buffer \p V into the calling thread's bucket.
+  ///
+  /// The common case is a plain add to a slot this statistic already
+  /// owns, with no atomic operations or registration checks.
+  void addValue(int64_t V) {
+    stats_detail::StatisticBucket *B = stats_detail::ThreadBucket;
+    if (LLVM_UNLIKELY(!B))
+      B = stats_detail::claimBucket();
+    stats_detail::StatisticSlot &S = B->Slots[bucketIndex()];
+    if (LLVM_LIKELY(S.Stat == this)) {
+      S.Delta += V;
+      return;
+    }
+    evictAndOccupy(S, V);
+  }
+
+  /// \brief Slot this statistic maps to in every thread's bucket.
+  unsigned bucketIndex() const {
+    uintptr_t Key = reinterpret_cast<uintptr_t>(this);
+    return (unsigned)((Key >> 4) ^ (Key >> 9)) &
+           (stats_detail::StatisticBucket::NumSlots - 1);
+  }
+
+  /// \brief Flush the delta held in \p S and take the slot over.
+  void evictAndOccupy(stats_detail::StatisticSlot &S, int64_t V);
+
+  /// \brief Fold this thread's pending delta into the value.
+  void flushPending();
+
+  /// \brief Drop this thread's pending delta without applying it.
+  void discardPending();
+#else
+  // With threads disabled, counters are plain non-atomic variables.
+  void addValue(int64_t V) {
+    Value += (sys::cas_flag)V;
+    init();
+  }
+  void flushPending() {}
+  void discardPending() {}
+#endif
+#endif
+
   Statistic &init() {
     bool tmp = Initialized;
     sys::MemoryFence();
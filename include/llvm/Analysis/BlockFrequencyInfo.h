@@ -51,6 +51,13 @@ public:
   /// floating points.
   BlockFrequency getBlockFreq(const BasicBlock *BB) const;
 
+  /// setBlockFreq - Overwrite the frequency of the given block, e.g. after a
+  /// pass has changed the CFG locally.  This keeps the analysis usable across
+  /// small updates without rerunning the full loop-scaled propagation; the
+  /// caller is responsible for supplying a frequency consistent with the new
+  /// edges.  BB may be a block created after the analysis ran.
+  void setBlockFreq(const BasicBlock *BB, uint64_t Freq);
+
   // Print the block frequency Freq to OS using the current functions entry
   // frequency to convert freq into a relative decimal form.
   raw_ostream &printBlockFreq(raw_ostream &OS, const BlockFrequency Freq) const;
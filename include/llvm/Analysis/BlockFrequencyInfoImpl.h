@@ -456,6 +456,9 @@ public:
 
   BlockFrequency getBlockFreq(const BlockNode &Node) const;
 
+  /// \brief Overwrite the frequency of a node after the analysis has run.
+  void setBlockFreq(const BlockNode &Node, uint64_t Freq);
+
   raw_ostream &printBlockFreq(raw_ostream &OS, const BlockNode &Node) const;
   raw_ostream &printBlockFreq(raw_ostream &OS,
                               const BlockFrequency &Freq) const;
@@ -889,6 +892,7 @@ public:
   BlockFrequency getBlockFreq(const BlockT *BB) const {
     return BlockFrequencyInfoImplBase::getBlockFreq(getNode(BB));
   }
+  void setBlockFreq(const BlockT *BB, uint64_t Freq);
   Scaled64 getFloatingBlockFreq(const BlockT *BB) const {
     return BlockFrequencyInfoImplBase::getFloatingBlockFreq(getNode(BB));
   }
@@ -941,6 +945,21 @@ void BlockFrequencyInfoImpl<BT>::doFunction(const FunctionT *F,
   finalizeMetrics();
 }
 
+template <class BT>
+void BlockFrequencyInfoImpl<BT>::setBlockFreq(const BlockT *BB,
+                                              uint64_t Freq) {
+  if (Nodes.count(BB)) {
+    BlockFrequencyInfoImplBase::setBlockFreq(getNode(BB), Freq);
+    return;
+  }
+  // The block was created after the analysis ran; give it a fresh node.  Such
+  // nodes have no position in RPOT, which only matters for debug printing.
+  BlockNode NewNode(Freqs.size());
+  Nodes[BB] = NewNode;
+  Freqs.emplace_back();
+  BlockFrequencyInfoImplBase::setBlockFreq(NewNode, Freq);
+}
+
 template <class BT> void BlockFrequencyInfoImpl<BT>::initializeRPOT() {
   const BlockT *Entry = F->begin();
   RPOT.reserve(F->size());
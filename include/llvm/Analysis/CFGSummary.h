@@ -0,0 +1,69 @@
+//===- CFGSummary.h - Cached per-function body summaries --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a cache of compact per-function summaries of the
+// interesting instruction positions in a function body, so that consumers
+// which repeatedly scan whole functions for the same instruction classes
+// (call graph construction being the motivating one) can reuse a single walk.
+//
+// A summary records instruction *positions* only: consumers must re-read the
+// operands of the recorded instructions, which is what keeps a summary valid
+// across in-place rewrites like RAUW of a callee. Validity is checked against
+// Function::getInstructionGeneration(), which is bumped whenever an
+// instruction or basic block is added to or removed from the function.
+//
+// Successor lists are deliberately not summarized: BasicBlock::getTerminator
+// is already constant time, and edge retargeting would not bump the
+// generation counter.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ANALYSIS_CFGSUMMARY_H
+#define LLVM_ANALYSIS_CFGSUMMARY_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace llvm {
+
+class Function;
+class Instruction;
+
+/// A cache of per-function instruction-position summaries, rebuilt lazily
+/// when a function's instruction generation changes.
+///
+/// The cache holds raw Function keys and Instruction pointers; a function
+/// that is going to be deleted must be removed with invalidate() first.
+class CFGSummaryCache {
+  struct FunctionSummary {
+    /// Function::getInstructionGeneration() value the summary was built at.
+    uint64_t Generation;
+    /// Every instruction in the function that is a call site (calls and
+    /// invokes), in program order.
+    SmallVector<Instruction *, 8> CallSites;
+  };
+
+  DenseMap<const Function *, FunctionSummary> Summaries;
+
+public:
+  /// Return the call sites of \p F in program order, building or rebuilding
+  /// the summary if the cached one is missing or stale. The result is
+  /// invalidated by any later instruction insertion or removal in \p F.
+  ArrayRef<Instruction *> getCallSites(Function &F);
+
+  /// Drop the summary for \p F. Must be called before \p F is deleted.
+  void invalidate(const Function *F) { Summaries.erase(F); }
+
+  void clear() { Summaries.clear(); }
+};
+
+} // End llvm namespace
+
+#endif
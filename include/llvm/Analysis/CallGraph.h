@@ -62,6 +62,7 @@
 
 namespace llvm {
 
+class CFGSummaryCache;
 class Function;
 class Module;
 class CallGraphNode;
@@ -91,6 +92,18 @@ class CallGraph {
   /// or calling an external function.
   CallGraphNode *CallsExternalNode;
 
+  /// \brief If non-null, a cache of call-site summaries used to build nodes
+  /// without rescanning unchanged function bodies. Not owned.
+  CFGSummaryCache *Summaries;
+
+  /// \brief The SCCs of the graph in bottom-up post-order, captured the last
+  /// time an SCC walk completed without the graph being modified.  Only
+  /// meaningful while \c SCCCacheValid is set.
+  std::vector<std::vector<CallGraphNode *>> SCCCache;
+
+  /// \brief True when \c SCCCache matches the current shape of the graph.
+  bool SCCCacheValid;
+
   /// \brief Replace the function represented by this node by another.
   ///
   /// This does not rescan the body of the function, so it is suitable when
@@ -102,8 +115,15 @@ class CallGraph {
   /// functions that it calls.
   void addToCallGraph(Function *F);
 
+  /// \brief Record the edge for one call site of \p Node's function.
+  void addCallEdge(CallGraphNode *Node, CallSite CS);
+
 public:
-  CallGraph(Module &M);
+  /// If \p Summaries is given, node construction reads call-site positions
+  /// from it instead of walking every instruction; a caller that keeps the
+  /// cache alive across repeated CallGraph constructions only pays for the
+  /// functions that changed in between.
+  CallGraph(Module &M, CFGSummaryCache *Summaries = nullptr);
   ~CallGraph();
 
   void print(raw_ostream &OS) const;
@@ -156,6 +176,39 @@ public:
   /// \brief Similar to operator[], but this will insert a new CallGraphNode for
   /// \c F if one does not already exist.
   CallGraphNode *getOrInsertFunction(const Function *F);
+
+  //===---------------------------------------------------------------------
+  // SCC post-order cache.  Repeated SCC walks over an unchanged graph (e.g.
+  // back-to-back CGSCC pass sequences) can reuse the partition computed by
+  // the previous walk instead of re-running the SCC finder.
+  //
+
+  /// \brief Returns true if a cached SCC post-order is available.
+  bool sccCacheValid() const { return SCCCacheValid; }
+
+  /// \brief Returns the cached bottom-up SCC post-order.
+  ///
+  /// Only valid while \c sccCacheValid() is true; any mutation of the graph
+  /// invalidates the cache.
+  const std::vector<std::vector<CallGraphNode *>> &getCachedSCCs() const {
+    assert(SCCCacheValid && "SCC cache is not populated");
+    return SCCCache;
+  }
+
+  /// \brief Record \p SCCs as the bottom-up SCC post-order of the graph.
+  void cacheSCCs(std::vector<std::vector<CallGraphNode *>> SCCs) {
+    SCCCache = std::move(SCCs);
+    SCCCacheValid = true;
+  }
+
+  /// \brief Drop the cached SCC post-order.
+  ///
+  /// Called by the mutation methods above; clients that update edges through
+  /// \c CallGraphNode directly must call this themselves.
+  void invalidateSCCCache() {
+    SCCCacheValid = false;
+    SCCCache.clear();
+  }
 };
 
 /// \brief A node in the call graph for a module.
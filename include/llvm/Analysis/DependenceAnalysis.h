@@ -40,6 +40,7 @@
 #ifndef LLVM_ANALYSIS_DEPENDENCEANALYSIS_H
 #define LLVM_ANALYSIS_DEPENDENCEANALYSIS_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Pass.h"
@@ -339,6 +340,26 @@ namespace llvm {
     LoopInfo *LI;
     Function *F;
 
+    /// Cached outcomes of depends() queries, for clients that test the same
+    /// instruction pairs repeatedly while building dependence graphs.  Only
+    /// the two outcomes that can be reconstituted from the query key alone
+    /// are remembered: "independent" (depends returned null) and "confused"
+    /// (a Dependence with no information).  Full dependences carry
+    /// per-level direction vectors and are recomputed.  The cache lives for
+    /// the pass lifetime and is dropped by releaseMemory().
+    enum DependsOutcome { OutcomeUnknown, OutcomeIndependent, OutcomeConfused };
+    struct DependsCacheEntry {
+      /// Outcome of the query, indexed by PossiblyLoopIndependent.
+      uint8_t Outcome[2];
+      DependsCacheEntry() { Outcome[0] = Outcome[1] = OutcomeUnknown; }
+    };
+    DenseMap<std::pair<Instruction *, Instruction *>, DependsCacheEntry>
+        DependsCache;
+
+    /// dependsImpl - Does the work of depends() on a cache miss.
+    std::unique_ptr<Dependence> dependsImpl(Instruction *Src, Instruction *Dst,
+                                            bool PossiblyLoopIndependent);
+
     /// Subscript - This private struct represents a pair of subscripts from
     /// a pair of potentially multi-dimensional array references. We use a
     /// vector of them to guide subscript partitioning.
@@ -798,14 +819,17 @@ namespace llvm {
     /// search space, combining the directions of discovered dependences
     /// in the DirSet field of Bound. Returns the number of distinct
     /// dependences discovered. If the dependence is disproved,
-    /// it will return 0.
+    /// it will return 0. Budget limits the number of nodes visited; when
+    /// it reaches zero the remaining search space is conservatively
+    /// recorded as dependent in all directions.
     unsigned exploreDirections(unsigned Level,
                                CoefficientInfo *A,
                                CoefficientInfo *B,
                                BoundInfo *Bound,
                                const SmallBitVector &Loops,
                                unsigned &DepthExpanded,
-                               const SCEV *Delta) const;
+                               const SCEV *Delta,
+                               unsigned &Budget) const;
 
     /// testBounds - Returns true iff the current bounds are plausible.
     ///
@@ -14,6 +14,7 @@
 #ifndef LLVM_ANALYSIS_INLINECOST_H
 #define LLVM_ANALYSIS_INLINECOST_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include <cassert>
 #include <climits>
@@ -103,6 +104,36 @@ class InlineCostAnalysis : public CallGraphSCCPass {
   TargetTransformInfoWrapperPass *TTIWP;
   AssumptionCacheTracker *ACT;
 
+public:
+  /// \brief Callee-local results of a completed cost analysis.
+  ///
+  /// A call site which supplies no constants, no constant-offset pointers and
+  /// no alloca-derived arguments gives the analysis nothing to specialize on,
+  /// so the simulation of the callee's body depends only on the callee itself
+  /// and its result can be shared between such sites. Entries are validated
+  /// against a hash of the callee's body so that they are recomputed when
+  /// inlining or simplification changes the function between iterations.
+  struct CalleeCostInfo {
+    uint64_t BodyHash;
+    /// The cost accumulated while walking the body, excluding the per-site
+    /// argument and linkage adjustments.
+    int Cost;
+    unsigned NumInstructions;
+    unsigned NumVectorInstructions;
+    /// Whether the callee would still be a single basic block after inlining.
+    bool SingleBB;
+    bool ContainsNoDuplicateCall;
+    /// False when the body contains a construct which blocks inlining at
+    /// every such call site (dynamic alloca, indirectbr, recursion, ...).
+    bool Viable;
+    bool Valid;
+
+    CalleeCostInfo() : BodyHash(0), Valid(false) {}
+  };
+
+private:
+  DenseMap<Function *, CalleeCostInfo> CalleeCostCache;
+
 public:
   static char ID;
 
@@ -302,6 +302,13 @@ namespace llvm {
                      SmallPtrSet<ValueIsLoadPair, 4> > ReverseNonLocalPtrDepTy;
     ReverseNonLocalPtrDepTy ReverseNonLocalPtrDeps;
 
+    /// BlockAccessesMemory - Cached summary of whether a block contains any
+    /// instruction that may read or write memory.  A block with none is
+    /// transparent to every pointer query, so the non-local walk can cross it
+    /// without a per-pointer scan.  This summary is shared by all pointers,
+    /// unlike the caches above.
+    DenseMap<BasicBlock*, bool> BlockAccessesMemory;
+
 
     /// PerInstNLInfo - This is the instruction we keep for each cached access
     /// that we have for an instruction.  The pointer is an owning pointer and
@@ -440,6 +447,7 @@ namespace llvm {
                                          bool isLoad, BasicBlock *BB,
                                          NonLocalDepInfo *Cache,
                                          unsigned NumSortedEntries);
+    bool blockAccessesMemory(BasicBlock *BB);
 
     void RemoveCachedNonLocalPointerDependencies(ValueIsLoadPair P);
 
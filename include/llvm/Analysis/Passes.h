@@ -44,6 +44,14 @@ namespace llvm {
   //
   ModulePass *createAliasAnalysisCounterPass();
 
+  //===--------------------------------------------------------------------===//
+  //
+  // createAAQueryProfilerPass - This pass attributes alias query counts and
+  // sampled latencies to the pass that issued them, cheaply enough to stay
+  // enabled on production builds.
+  //
+  ModulePass *createAAQueryProfilerPass();
+
   //===--------------------------------------------------------------------===//
   //
   // createAAEvalPass - This pass implements a simple N^2 alias analysis
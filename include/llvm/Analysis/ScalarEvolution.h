@@ -248,15 +248,31 @@ namespace llvm {
     /// counts and things.
     SCEVCouldNotCompute CouldNotCompute;
 
+    /// ValueExprEntry - A cached SCEV for a value, tagged with the epoch at
+    /// which it was computed.  Entries from earlier epochs are stale and are
+    /// filtered out (and erased) lazily on lookup.
+    struct ValueExprEntry {
+      const SCEV *S;
+      unsigned Epoch;
+      ValueExprEntry() : S(nullptr), Epoch(0) {}
+      ValueExprEntry(const SCEV *S, unsigned Epoch) : S(S), Epoch(Epoch) {}
+    };
+
     /// ValueExprMapType - The typedef for ValueExprMap.
     ///
-    typedef DenseMap<SCEVCallbackVH, const SCEV *, DenseMapInfo<Value *> >
+    typedef DenseMap<SCEVCallbackVH, ValueExprEntry, DenseMapInfo<Value *> >
       ValueExprMapType;
 
     /// ValueExprMap - This is a cache of the values we have analyzed so far.
     ///
     ValueExprMapType ValueExprMap;
 
+    /// SCEVEpoch - The current cache epoch.  forgetLoop and forgetValue
+    /// invalidate the value cache by bumping this rather than walking the
+    /// transitive users of the changed values; see bumpEpoch().  Starts at 1
+    /// so a default-constructed (epoch 0) entry can never appear current.
+    unsigned SCEVEpoch;
+
     /// Mark predicate values currently being processed by isImpliedCond.
     DenseSet<Value*> PendingLoopPredicates;
 
@@ -358,6 +374,18 @@ namespace llvm {
     /// this function as they are computed.
     DenseMap<const Loop*, BackedgeTakenInfo> BackedgeTakenCounts;
 
+    /// TripCountCacheKey - Key identifying the body of the current function in
+    /// the persistent trip count cache (-scev-trip-count-cache). Computed
+    /// lazily from a hash of the printed function; empty until first needed.
+    std::string TripCountCacheKey;
+
+    /// TripCountCacheDisabled - Set once forgetLoop or forgetValue runs on the
+    /// current function. From then on the IR no longer matches the body the
+    /// key was hashed from, so the persistent cache can neither be consulted
+    /// (a hit would resurrect a pre-transformation count) nor written (the
+    /// stale key would poison the on-disk cache for future runs).
+    bool TripCountCacheDisabled;
+
     /// ConstantEvolutionLoopExitValue - This map contains entries for all of
     /// the PHI instructions that we attempt to compute constant evolutions for.
     /// This allows us to avoid potentially expensive recomputation of these
@@ -446,6 +474,21 @@ namespace llvm {
     /// loop will iterate.
     BackedgeTakenInfo ComputeBackedgeTakenCount(const Loop *L);
 
+    /// getTripCountCacheKey - Return the persistent trip count cache key for
+    /// the given loop, or an empty string if the loop's shape makes it
+    /// unsuitable for caching.
+    std::string getTripCountCacheKey(const Loop *L);
+
+    /// lookupCachedBackedgeTakenCount - Try to satisfy a backedge-taken count
+    /// query for L from the persistent trip count cache. On a hit, fill in
+    /// Result and return true.
+    bool lookupCachedBackedgeTakenCount(const Loop *L, BackedgeTakenInfo &Result);
+
+    /// recordCachedBackedgeTakenCount - If L's computed backedge-taken count
+    /// is a constant, record it in the persistent trip count cache.
+    void recordCachedBackedgeTakenCount(const Loop *L,
+                                        const BackedgeTakenInfo &Result);
+
     /// ComputeExitLimit - Compute the number of times the backedge of the
     /// specified loop will execute if it exits via the specified block.
     ExitLimit ComputeExitLimit(const Loop *L, BasicBlock *ExitingBlock);
@@ -557,6 +600,12 @@ namespace llvm {
     /// forgetMemoizedResults - Drop memoized information computed for S.
     void forgetMemoizedResults(const SCEV *S);
 
+    /// bumpEpoch - Invalidate every cached value mapping by advancing
+    /// SCEVEpoch, and drop the side tables (trip counts, ranges,
+    /// dispositions) in bulk.  This replaces the transitive def-use walks
+    /// that forgetLoop and forgetValue used to do per entry.
+    void bumpEpoch();
+
     /// Return false iff given SCEV contains a SCEVUnknown with NULL value-
     /// pointer.
     bool checkValidity(const SCEV *S) const;
@@ -22,6 +22,7 @@
 #ifndef LLVM_ANALYSIS_TARGETTRANSFORMINFO_H
 #define LLVM_ANALYSIS_TARGETTRANSFORMINFO_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Intrinsics.h"
@@ -493,6 +494,20 @@ private:
   template <typename T> class Model;
 
   std::unique_ptr<Concept> TTIImpl;
+
+  /// \name Cost query memoization
+  /// The target cost hooks are pure functions of their arguments, and the
+  /// vectorizers repeat identical queries thousands of times while costing
+  /// candidate plans, so the answers to the hottest queries are remembered
+  /// here keyed by their full argument lists. Types are uniqued in the
+  /// LLVMContext, so their addresses identify them.
+  /// @{
+  mutable DenseMap<std::pair<Type *, unsigned>, unsigned> ArithmeticCostCache;
+  mutable DenseMap<std::pair<std::pair<Type *, Type *>, unsigned>, unsigned>
+      CastCostCache;
+  mutable DenseMap<std::pair<std::pair<Type *, Type *>, unsigned>, unsigned>
+      CmpSelCostCache;
+  /// @}
 };
 
 class TargetTransformInfo::Concept {
@@ -14,14 +14,58 @@
 #ifndef LLVM_ASMPARSER_PARSER_H
 #define LLVM_ASMPARSER_PARSER_H
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <functional>
+#include <memory>
 
 namespace llvm {
 
+class Function;
 class Module;
 class SMDiagnostic;
 class LLVMContext;
 
+/// A cache of parsed function definitions keyed by their source text, for
+/// tools that repeatedly parse near-identical modules in one LLVMContext.
+/// Attach one to parseAssembly and a textually identical function definition
+/// is spliced in as a copy of the previously parsed body instead of being
+/// re-parsed; the function's own name is excluded from the key, so renamed
+/// but otherwise identical definitions share an entry. Only self-contained
+/// definitions are cached: anything whose meaning depends on module-level
+/// state that can change between modules (metadata, attribute groups, named
+/// struct types, comdats, block addresses, prefix or prologue data) always
+/// takes the normal parsing path.
+class FunctionParseCache {
+public:
+  explicit FunctionParseCache(LLVMContext &Context);
+  ~FunctionParseCache();
+
+  LLVMContext &getContext() const;
+
+  /// Look up a previously parsed definition by key.
+  Function *lookup(StringRef Key) const;
+
+  /// Record a definition that was just parsed. Definitions that are not
+  /// self-contained are silently ignored.
+  void insert(StringRef Key, const Function *F);
+
+private:
+  /// Holds private copies of the cached functions, so that callers remain
+  /// free to modify or delete the modules the parser produced.
+  std::unique_ptr<Module> CacheModule;
+  StringMap<Function *> Entries;
+};
+
+/// A callback invoked by the parser as each function definition is completed,
+/// before the rest of the input has been consumed. Streaming clients that
+/// cannot afford to hold a large module in memory can process the function
+/// and then call Function::deleteBody() to discard it; references from later
+/// functions see only the remaining declaration. Note that forward references
+/// to entities defined later in the input (such as numbered metadata) are not
+/// resolved until the whole input has been parsed.
+typedef std::function<void(Function &)> AsmFunctionCallback;
+
 /// This function is the main interface to the LLVM Assembly Parser. It parses
 /// an ASCII file that (presumably) contains LLVM Assembly code. It returns a
 /// Module (intermediate representation) with the corresponding features. Note
@@ -31,9 +75,14 @@ class LLVMContext;
 /// @param Filename The name of the file to parse
 /// @param Error Error result info.
 /// @param Context Context in which to allocate globals info.
+/// @param FunctionCallback If non-null, called as each function definition
+///                         completes; see AsmFunctionCallback.
 std::unique_ptr<Module> parseAssemblyFile(StringRef Filename,
                                           SMDiagnostic &Error,
-                                          LLVMContext &Context);
+                                          LLVMContext &Context,
+                                          AsmFunctionCallback FunctionCallback =
+                                              nullptr,
+                                          FunctionParseCache *Cache = nullptr);
 
 /// The function is a secondary interface to the LLVM Assembly Parser. It parses
 /// an ASCII string that (presumably) contains LLVM Assembly code. It returns a
@@ -46,15 +95,21 @@ std::unique_ptr<Module> parseAssemblyFile(StringRef Filename,
 /// @param Context Context in which to allocate globals info.
 std::unique_ptr<Module> parseAssemblyString(StringRef AsmString,
                                             SMDiagnostic &Error,
-                                            LLVMContext &Context);
+                                            LLVMContext &Context,
+                                            FunctionParseCache *Cache = nullptr);
 
 /// parseAssemblyFile and parseAssemblyString are wrappers around this function.
 /// @brief Parse LLVM Assembly from a MemoryBuffer.
 /// @param F The MemoryBuffer containing assembly
 /// @param Err Error result info.
 /// @param Context Context in which to allocate globals info.
+/// @param FunctionCallback If non-null, called as each function definition
+///                         completes; see AsmFunctionCallback.
 std::unique_ptr<Module> parseAssembly(MemoryBufferRef F, SMDiagnostic &Err,
-                                      LLVMContext &Context);
+                                      LLVMContext &Context,
+                                      AsmFunctionCallback FunctionCallback =
+                                          nullptr,
+                                      FunctionParseCache *Cache = nullptr);
 
 /// This function is the low-level interface to the LLVM Assembly Parser.
 /// This is kept as an independent function instead of being inlined into
@@ -64,8 +119,12 @@ std::unique_ptr<Module> parseAssembly(MemoryBufferRef F, SMDiagnostic &Err,
 /// @param F The MemoryBuffer containing assembly
 /// @param M The module to add data to.
 /// @param Err Error result info.
+/// @param FunctionCallback If non-null, called as each function definition
+///                         completes; see AsmFunctionCallback.
 /// @return true on error.
-bool parseAssemblyInto(MemoryBufferRef F, Module &M, SMDiagnostic &Err);
+bool parseAssemblyInto(MemoryBufferRef F, Module &M, SMDiagnostic &Err,
+                       AsmFunctionCallback FunctionCallback = nullptr,
+                       FunctionParseCache *Cache = nullptr);
 
 } // End llvm namespace
 
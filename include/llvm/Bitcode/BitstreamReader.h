@@ -110,6 +110,11 @@ public:
     return nullptr;
   }
 
+  /// Return all the block info read so far.
+  const std::vector<BlockInfo> &getBlockInfoRecords() const {
+    return BlockInfoRecords;
+  }
+
   BlockInfo &getOrCreateBlockInfo(unsigned BlockID) {
     if (const BlockInfo *BI = getBlockInfo(BlockID))
       return *const_cast<BlockInfo*>(BI);
@@ -199,6 +204,12 @@ class BitstreamCursor {
   /// This tracks the codesize of parent blocks.
   SmallVector<Block, 8> BlockScope;
 
+  /// If the bitcode is backed by a contiguous, fully resident buffer, its
+  /// base address and size; fillCurWord then loads words straight from the
+  /// buffer rather than copying them out through MemoryObject::readBytes.
+  /// Null when the bitcode is streamed.
+  const uint8_t *DirectData;
+  size_t DirectSize;
 
 public:
   BitstreamCursor() { init(nullptr); }
@@ -213,6 +224,16 @@ public:
     Size = 0;
     BitsInCurWord = 0;
     CurCodeSize = 2;
+
+    DirectData = nullptr;
+    DirectSize = 0;
+    if (R) {
+      MemoryObject &MO = R->getBitcodeBytes();
+      if (MO.isContiguous() && MO.getExtent() != 0) {
+        DirectSize = static_cast<size_t>(MO.getExtent());
+        DirectData = MO.getPointer(0, DirectSize);
+      }
+    }
   }
 
   void freeState();
@@ -318,6 +339,18 @@ public:
     if (Size != 0 && NextChar >= Size)
       report_fatal_error("Unexpected end of file");
 
+    // Fast path: the stream is fully resident in memory, so the next word can
+    // be loaded directly from the buffer. The last partial word of the stream
+    // still goes through readBytes below.
+    if (NextChar + sizeof(word_t) <= DirectSize) {
+      CurWord =
+          support::endian::read<word_t, support::little, support::unaligned>(
+              DirectData + NextChar);
+      NextChar += sizeof(word_t);
+      BitsInCurWord = sizeof(word_t) * 8;
+      return;
+    }
+
     // Read the next word from the stream.
     uint8_t Array[sizeof(word_t)] = {0};
 
@@ -15,6 +15,7 @@
 #ifndef LLVM_BITCODE_BITSTREAMWRITER_H
 #define LLVM_BITCODE_BITSTREAMWRITER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitcode/BitCodes.h"
@@ -104,6 +105,35 @@ public:
   /// \brief Retrieve the current position in the stream, in bits.
   uint64_t GetCurrentBitNo() const { return GetBufferOffset() * 8 + CurBit; }
 
+  /// getBuffer - Give read access to the bytes emitted so far; only bytes
+  /// that have been flushed out of the current word are present.
+  const SmallVectorImpl<char> &getBuffer() const { return Out; }
+
+  /// BackpatchWordAtBit - Backpatch a 32-bit word at an arbitrary bit
+  /// position in the output. The 32 bits at that position must have been
+  /// emitted already (typically as a Fixed(32) placeholder of zero) and
+  /// flushed out of the current word.
+  void BackpatchWordAtBit(uint64_t BitNo, uint32_t NewWord) {
+    uint64_t ByteNo = BitNo / 8;
+    unsigned StartBit = unsigned(BitNo) & 7;
+    unsigned NumBytes = StartBit ? 5 : 4;
+    assert(ByteNo + NumBytes <= Out.size() && "Backpatch target not emitted");
+    uint64_t Cur = 0;
+    for (unsigned i = 0; i != NumBytes; ++i)
+      Cur |= uint64_t(uint8_t(Out[ByteNo + i])) << (8 * i);
+    Cur &= ~(uint64_t(0xFFFFFFFFULL) << StartBit);
+    Cur |= uint64_t(NewWord) << StartBit;
+    for (unsigned i = 0; i != NumBytes; ++i)
+      Out[ByteNo + i] = char((Cur >> (8 * i)) & 0xFF);
+  }
+
+  /// BackpatchWord64AtBit - Backpatch two consecutive Fixed(32) operands with
+  /// the given 64-bit value, least significant word first.
+  void BackpatchWord64AtBit(uint64_t BitNo, uint64_t Val) {
+    BackpatchWordAtBit(BitNo, uint32_t(Val));
+    BackpatchWordAtBit(BitNo + 32, uint32_t(Val >> 32));
+  }
+
   //===--------------------------------------------------------------------===//
   // Basic Primitives for emitting bits to the stream.
   //===--------------------------------------------------------------------===//
@@ -179,6 +209,33 @@ public:
     Emit(Val, CurCodeSize);
   }
 
+  /// SetCurrentAbbrevIDWidth - Set the abbrev ID width in effect at the start
+  /// of an empty stream. This lets a block be encoded out of line with the
+  /// same width it will have at the point in the main stream it is spliced
+  /// into.
+  void SetCurrentAbbrevIDWidth(unsigned Width) {
+    assert(GetCurrentBitNo() == 0 && BlockScope.empty() &&
+           "Can only set the abbrev ID width of an empty stream");
+    CurCodeSize = Width;
+  }
+
+  /// EmitPreEncodedData - Append a whole number of pre-encoded words, as
+  /// produced by encoding complete blocks with another word-aligned writer.
+  /// The current position must be word aligned.
+  void EmitPreEncodedData(ArrayRef<char> Bytes) {
+    assert(CurBit == 0 && "Unflushed data remaining");
+    assert((Bytes.size() & 3) == 0 && "Not a whole number of words");
+    Out.append(Bytes.begin(), Bytes.end());
+  }
+
+  /// CopyBlockInfo - Copy the BLOCKINFO abbreviation definitions from \p
+  /// Other, so that blocks encoded with this writer can use abbreviations
+  /// defined in \p Other's BLOCKINFO block.
+  void CopyBlockInfo(const BitstreamWriter &Other) {
+    assert(BlockInfoRecords.empty() && "Already have block info");
+    BlockInfoRecords = Other.BlockInfoRecords;
+  }
+
   //===--------------------------------------------------------------------===//
   // Block Manipulation
   //===--------------------------------------------------------------------===//
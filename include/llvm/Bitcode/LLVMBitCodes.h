@@ -42,7 +42,13 @@ namespace bitc {
 
     TYPE_BLOCK_ID_NEW,
 
-    USELIST_BLOCK_ID
+    USELIST_BLOCK_ID,
+
+    FUNCTION_INDEX_BLOCK_ID,
+
+    SYMTAB_BLOCK_ID,
+
+    FUNCTION_DIGEST_BLOCK_ID
   };
 
 
@@ -135,6 +141,51 @@ namespace bitc {
     VST_CODE_BBENTRY = 2   // VST_BBENTRY: [bbid, namechar x N]
   };
 
+  /// FUNCTION_INDEX block codes. The index records the absolute bit offset of
+  /// every function body block, in module order, plus the offset of the first
+  /// bit after the last body, so lazy readers can jump straight to (or over)
+  /// any body without scanning the stream. Offsets are backpatched fixed-width
+  /// pairs of 32-bit words, least significant word first.
+  enum FunctionIndexCodes {
+    FNINDEX_CODE_ENTRY = 1, // ENTRY: [offsetlo, offsethi]
+    FNINDEX_CODE_END   = 2  // END:   [offsetlo, offsethi]
+  };
+
+  /// SYMTAB block codes. The symbol table carries one record per module
+  /// symbol with its mangled name and the linkage information a symbol scan
+  /// needs, so consumers like the gold plugin can enumerate the symbols of a
+  /// bitcode file without materializing the module. The record operands are
+  /// the flags below, the visibility (a GlobalValue::VisibilityTypes value),
+  /// the name length, and the name characters followed by the comdat key
+  /// characters.
+  enum SymtabCodes {
+    SYMTAB_CODE_SYMBOL = 1 // SYMBOL: [flags, visibility, namelen, chars x N]
+  };
+
+  /// Flag bits of a SYMTAB_CODE_SYMBOL record.
+  enum SymtabSymbolFlags {
+    SYMTAB_SYMBOL_UNDEFINED       = 1 << 0, // Declaration for the linker.
+    SYMTAB_SYMBOL_GLOBAL          = 1 << 1, // Not local linkage.
+    SYMTAB_SYMBOL_WEAK            = 1 << 2, // Weak or linkonce linkage.
+    SYMTAB_SYMBOL_COMMON          = 1 << 3, // Common linkage.
+    SYMTAB_SYMBOL_FORMAT_SPECIFIC = 1 << 4, // Private or llvm.* symbol.
+    SYMTAB_SYMBOL_EXTERNAL_WEAK   = 1 << 5, // Extern_weak linkage.
+    SYMTAB_SYMBOL_WEAK_FOR_LINKER = 1 << 6, // May be overridden at link time.
+    SYMTAB_SYMBOL_SELF_COMDAT     = 1 << 7  // The comdat key is the name.
+  };
+
+  /// FUNCTION_DIGEST block codes. The block carries one record per function
+  /// body with a truncated MD5 of the body block's encoded bytes and the
+  /// function's name, so a build cache can detect, at block granularity,
+  /// which bodies are byte-identical across rebuilds. Combined with the
+  /// FUNCTION_INDEX offsets this addresses each body by content. Note that
+  /// the encoding of a body embeds module-level value IDs, so a digest is
+  /// stable only while the enumeration around the function is unchanged; the
+  /// digest detects identical blocks, it does not canonicalize them.
+  enum FunctionDigestCodes {
+    FNDIGEST_CODE_ENTRY = 1 // ENTRY: [hashlo, hashhi, namechar x N]
+  };
+
   enum MetadataCodes {
     METADATA_STRING        = 1,   // MDSTRING:      [values]
     METADATA_VALUE         = 2,   // VALUE:         [type num, value num]
@@ -19,6 +19,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace llvm {
   class BitstreamWriter;
@@ -54,11 +55,38 @@ namespace llvm {
   parseBitcodeFile(MemoryBufferRef Buffer, LLVMContext &Context,
                    DiagnosticHandlerFunction DiagnosticHandler = nullptr);
 
+  /// An entry of the bitcode symbol table block: the mangled symbol name plus
+  /// the linkage information a symbol scan needs. The flags are the
+  /// bitc::SymtabSymbolFlags bits and the visibility is a
+  /// GlobalValue::VisibilityTypes value.
+  struct BitcodeSymbol {
+    std::string Name;
+    std::string ComdatKey;
+    uint32_t Flags;
+    unsigned Visibility;
+  };
+
+  /// Read the symbol table block of the specified bitcode buffer without
+  /// materializing a module. Returns false when the bitcode has no symbol
+  /// table block, in which case the caller must parse the module to find the
+  /// symbols.
+  ErrorOr<bool>
+  readBitcodeSymbols(MemoryBufferRef Buffer,
+                     std::vector<BitcodeSymbol> &Symbols,
+                     DiagnosticHandlerFunction DiagnosticHandler = nullptr);
+
   /// WriteBitcodeToFile - Write the specified module to the specified
   /// raw output stream.  For streams where it matters, the given stream
   /// should be in "binary" mode.
   void WriteBitcodeToFile(const Module *M, raw_ostream &Out);
 
+  /// Write the specified module to the specified raw output stream as a
+  /// zlib-compressed bitcode container (see isCompressedBitcode). The buffer
+  /// based readers decompress such containers transparently. It is a fatal
+  /// error to call this when zlib is not available; check zlib::isAvailable()
+  /// first.
+  void WriteCompressedBitcodeToFile(const Module *M, raw_ostream &Out);
+
 
   /// isBitcodeWrapper - Return true if the given bytes are the magic bytes
   /// for an LLVM IR bitcode wrapper.
@@ -88,13 +116,36 @@ namespace llvm {
            BufPtr[3] == 0xde;
   }
 
+  /// isCompressedBitcode - Return true if the given bytes are the magic bytes
+  /// for a compressed bitcode container. The format of the container is:
+  ///
+  /// struct bcc_header {
+  ///   uint8_t  Magic[4];         // 'B', 'C', 'C', 'Z'
+  ///   uint32_t Version;          // Currently always 0.
+  ///   uint32_t UncompressedSize; // Size of the decompressed bitcode stream.
+  /// };
+  ///
+  /// followed by the zlib-compressed bitcode stream. The multi-byte fields
+  /// are little-endian like in the plain bitcode wrapper.
+  ///
+  inline bool isCompressedBitcode(const unsigned char *BufPtr,
+                                  const unsigned char *BufEnd) {
+    return BufEnd - BufPtr >= 4 &&
+           BufPtr[0] == 'B' &&
+           BufPtr[1] == 'C' &&
+           BufPtr[2] == 'C' &&
+           BufPtr[3] == 'Z';
+  }
+
   /// isBitcode - Return true if the given bytes are the magic bytes for
-  /// LLVM IR bitcode, either with or without a wrapper.
+  /// LLVM IR bitcode, either with or without a wrapper, or in a compressed
+  /// container.
   ///
   inline bool isBitcode(const unsigned char *BufPtr,
                         const unsigned char *BufEnd) {
     return isBitcodeWrapper(BufPtr, BufEnd) ||
-           isRawBitcode(BufPtr, BufEnd);
+           isRawBitcode(BufPtr, BufEnd) ||
+           isCompressedBitcode(BufPtr, BufEnd);
   }
 
   /// SkipBitcodeWrapperHeader - Some systems wrap bc files with a special
@@ -281,6 +281,11 @@ namespace llvm {
       segments.clear();
     }
 
+    /// Release excess heap capacity left behind by incremental construction
+    /// of the segment and value number vectors. The range itself is
+    /// unchanged; the vectors simply regrow if the range is extended later.
+    void shrinkStorageToFit();
+
     size_t size() const {
       return segments.size();
     }
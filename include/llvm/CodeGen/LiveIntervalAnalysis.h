@@ -136,7 +136,11 @@ extern cl::opt<bool> UseSegmentSetForPhysRegs;
       return LI;
     }
 
-    // Interval removal.
+    // Interval removal.  Paired with the on-demand computation in
+    // getInterval, this also lets a client discard the storage of intervals
+    // outside its working set: an interval that has not been modified since
+    // it was computed is recomputed from the machine code the next time it
+    // is queried.
     void removeInterval(unsigned Reg) {
       delete VirtRegIntervals[Reg];
       VirtRegIntervals[Reg] = nullptr;
@@ -25,6 +25,7 @@
 #define LLVM_CODEGEN_LIVEREGMATRIX_H
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/LiveIntervalUnion.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 
@@ -52,11 +53,30 @@ class LiveRegMatrix : public MachineFunctionPass {
   // Cached queries per register unit.
   std::unique_ptr<LiveIntervalUnion::Query[]> Queries;
 
+  // Coarse per-unit occupancy summary. Bit N of CoarseMatrix[Unit] covers a
+  // 1/64 slice of the function's basic blocks; a unit whose mask doesn't
+  // intersect VirtReg's mask cannot interfere with it, so most interference
+  // checks are answered by a single AND without probing the IntervalMaps.
+  SmallVector<uint64_t, 0> CoarseMatrix;
+  unsigned CoarseNumBlocks;
+  // True if block numbers increase in layout order, which lets coarse masks
+  // be computed with one bucket-range fill per segment instead of a walk.
+  bool CoarseMonotonic;
+
+  // Cached coarse mask for the current VirtReg.
+  unsigned CoarseVirtReg;
+  unsigned CoarseTag;
+  uint64_t CoarseVirtRegMask;
+
   // Cached register mask interference info.
   unsigned RegMaskTag;
   unsigned RegMaskVirtReg;
   BitVector RegMaskUsable;
 
+  uint64_t computeCoarseMask(const LiveRange &Range) const;
+  uint64_t getCoarseMask(LiveInterval &VirtReg);
+  void recomputeCoarseMask(unsigned Unit);
+
   // MachineFunctionPass boilerplate.
   void getAnalysisUsage(AnalysisUsage&) const override;
   bool runOnMachineFunction(MachineFunction&) override;
@@ -0,0 +1,58 @@
+//===-- MachineFunctionCheckpoint.h - Machine IR checkpoints ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Save and restore of post-instruction-selection machine function state, so
+// that register allocation and scheduling experiments can resume from a
+// checkpoint instead of re-running the front of the codegen pipeline.
+//
+// The format is a simple versioned binary encoding of the basic blocks,
+// instructions, virtual register classes and frame objects of a single
+// MachineFunction. It is a tool-internal format: it must be written and read
+// by the same compiler version, for the same target and the same module.
+// State that later passes recompute or that can be conservatively dropped
+// (debug locations, memory operands) is not serialized; functions using
+// constructs the format does not encode (constant pools, jump tables,
+// variable sized frame objects) are rejected with a fatal error.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_MACHINEFUNCTIONCHECKPOINT_H
+#define LLVM_CODEGEN_MACHINEFUNCTIONCHECKPOINT_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace llvm {
+
+class MachineFunction;
+class MachineFunctionPass;
+class raw_ostream;
+
+/// Write a checkpoint of \p MF to \p OS. Reports a fatal error if the
+/// function uses state the checkpoint format cannot represent.
+void serializeMachineFunction(const MachineFunction &MF, raw_ostream &OS);
+
+/// Rebuild \p MF, which must be empty, from the checkpoint in \p Buffer.
+/// The checkpoint must have been written for the same function of the same
+/// module by the same compiler; malformed or mismatched input is a fatal
+/// error.
+void deserializeMachineFunction(MachineFunction &MF, MemoryBufferRef Buffer);
+
+/// Returns a pass that writes a checkpoint of each machine function to
+/// <Dir>/<function name>.mfc.
+MachineFunctionPass *createMachineFunctionCheckpointSaverPass(StringRef Dir);
+
+/// Returns a pass that rebuilds each machine function from
+/// <Dir>/<function name>.mfc. Scheduled in place of the instruction
+/// selector, it resumes codegen from saved checkpoints.
+MachineFunctionPass *createMachineFunctionCheckpointLoaderPass(StringRef Dir);
+
+} // End llvm namespace
+
+#endif
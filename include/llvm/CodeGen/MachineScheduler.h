@@ -96,6 +96,30 @@ class ScheduleDAGInstrs;
 class SchedDFSResult;
 class ScheduleHazardRecognizer;
 
+/// A cache of schedule orders keyed by a structural fingerprint of the
+/// scheduling region. Generated code often contains many structurally
+/// identical regions (unrolled loop bodies, expanded templates); once one of
+/// them has been scheduled the others can replay the computed order instead
+/// of rerunning the scheduling heuristic. The fingerprint covers the whole
+/// dependence graph by SUnit index, so equal signatures imply isomorphic
+/// graphs and make replaying a cached order legal.
+class SchedOrderCache {
+  struct Entry {
+    std::vector<uint64_t> Signature; ///< Full signature, checked on lookup.
+    std::vector<unsigned> Order;     ///< Scheduled SUnit indices, top-down.
+  };
+  DenseMap<uint64_t, Entry> Entries;
+
+public:
+  /// Return the order cached for a region with this signature, or null.
+  const std::vector<unsigned> *lookup(ArrayRef<uint64_t> Signature) const;
+
+  /// Record the order computed for a region with this signature. A signature
+  /// that collides with an existing entry on hash but not content is dropped;
+  /// such regions are simply rescheduled.
+  void insert(ArrayRef<uint64_t> Signature, std::vector<unsigned> Order);
+};
+
 /// MachineSchedContext provides enough context from the MachineScheduler pass
 /// for the target to instantiate a scheduler.
 struct MachineSchedContext {
@@ -108,6 +132,9 @@ struct MachineSchedContext {
 
   RegisterClassInfo *RegClassInfo;
 
+  /// Schedule orders cached across regions and functions for -misched-cache.
+  SchedOrderCache SchedCache;
+
   MachineSchedContext();
   virtual ~MachineSchedContext();
 };
@@ -241,6 +268,13 @@ protected:
   const SUnit *NextClusterPred;
   const SUnit *NextClusterSucc;
 
+  /// Schedule orders shared with structurally identical regions, or null if
+  /// the cache is disabled.
+  SchedOrderCache *OrderCache;
+
+  /// Fingerprint of the current region, valid while OrderCache is set.
+  std::vector<uint64_t> RegionSignature;
+
 #ifndef NDEBUG
   /// The number of instructions scheduled so far. Used to cut off the
   /// scheduler at the point determined by misched-cutoff.
@@ -252,7 +286,8 @@ public:
       : ScheduleDAGInstrs(*C->MF, C->MLI, IsPostRA,
                           /*RemoveKillFlags=*/IsPostRA, C->LIS),
         AA(C->AA), SchedImpl(std::move(S)), Topo(SUnits, &ExitSU), CurrentTop(),
-        CurrentBottom(), NextClusterPred(nullptr), NextClusterSucc(nullptr) {
+        CurrentBottom(), NextClusterPred(nullptr), NextClusterSucc(nullptr),
+        OrderCache(nullptr) {
 #ifndef NDEBUG
     NumInstrsScheduled = 0;
 #endif
@@ -284,6 +319,9 @@ public:
   /// equivalent edge already existed (false indicates failure).
   bool addEdge(SUnit *SuccSU, const SDep &PredDep);
 
+  /// Share schedule orders with structurally identical regions through Cache.
+  void setOrderCache(SchedOrderCache *Cache) { OrderCache = Cache; }
+
   MachineBasicBlock::iterator top() const { return CurrentTop; }
   MachineBasicBlock::iterator bottom() const { return CurrentBottom; }
 
@@ -326,6 +364,16 @@ protected:
   /// Reinsert debug_values recorded in ScheduleDAGInstrs::DbgValues.
   void placeDebugValues();
 
+  /// Compute the current region's fingerprint into RegionSignature.
+  void computeRegionSignature();
+
+  /// Finalize the region with a cached schedule order if one exists for
+  /// RegionSignature. Returns false if the region must be scheduled.
+  bool replayCachedSchedule();
+
+  /// Record the order just computed for the current region in OrderCache.
+  void recordSchedule();
+
   /// \brief dump the scheduled Sequence.
   void dumpSchedule() const;
 
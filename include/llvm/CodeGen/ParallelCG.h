@@ -0,0 +1,54 @@
+//===-- llvm/CodeGen/ParallelCG.h - Parallel code generation ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This header declares functions that can be used for parallel code generation.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_PARALLELCG_H
+#define LLVM_CODEGEN_PARALLELCG_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Target/TargetMachine.h"
+#include <memory>
+
+namespace llvm {
+
+class Module;
+class raw_ostream;
+class TargetOptions;
+
+/// Split M into OSs.size() partitions, and generate code for each. Writes
+/// OSs.size() output files to the output streams in OSs. The resulting output
+/// files if linked together are equivalent to the single output file that
+/// would have been code generated from M.
+///
+/// Writes bitcode for individual partitions into output streams that worker
+/// threads reparse into per-thread modules, so the caller's module must not be
+/// shared with any other thread for the duration of the call. Functions are
+/// distributed across partitions by a greedy balance on instruction counts;
+/// global variable and alias definitions are pinned to the first partition.
+///
+/// \returns M. If OSs.size() == 1 the module is unchanged and code was
+/// generated directly from it; otherwise its local symbols have been
+/// externalized by the split and it should not be used for anything but
+/// ownership bookkeeping.
+std::unique_ptr<Module>
+splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_ostream *> OSs,
+             StringRef CPU, StringRef Features, const TargetOptions &Options,
+             Reloc::Model RM = Reloc::Default,
+             CodeModel::Model CM = CodeModel::Default,
+             CodeGenOpt::Level OL = CodeGenOpt::Default,
+             TargetMachine::CodeGenFileType FT = TargetMachine::CGFT_ObjectFile);
+
+} // namespace llvm
+
+#endif
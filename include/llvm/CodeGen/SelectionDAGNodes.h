@@ -365,6 +365,17 @@ private:
   /// NodeId - Unique id per SDNode in the DAG.
   int NodeId;
 
+  /// CombinerWorklistIndex - This node's position on the DAG combiner's
+  /// worklist, or -1 if it is not queued. Scratch state owned by the
+  /// combiner; it replaces a side table keyed by node pointer.
+  int CombinerWorklistIndex;
+
+  /// CombinerEpoch - The combiner run in which this node was last visited.
+  /// Comparing against the current run's epoch replaces a visited set that
+  /// would otherwise have to be cleared between the several combine runs
+  /// over the same DAG. Scratch state owned by the combiner.
+  unsigned CombinerEpoch;
+
   /// OperandList - The values that are used by this operation.
   ///
   SDUse *OperandList;
@@ -467,6 +478,18 @@ public:
   /// setNodeId - Set unique node id.
   void setNodeId(int Id) { NodeId = Id; }
 
+  /// Return this node's position on the DAG combiner's worklist, or -1.
+  int getCombinerWorklistIndex() const { return CombinerWorklistIndex; }
+
+  /// Set this node's position on the DAG combiner's worklist.
+  void setCombinerWorklistIndex(int Index) { CombinerWorklistIndex = Index; }
+
+  /// Return the combiner run in which this node was last visited.
+  unsigned getCombinerEpoch() const { return CombinerEpoch; }
+
+  /// Record that this node was visited in combiner run \p Epoch.
+  void setCombinerEpoch(unsigned Epoch) { CombinerEpoch = Epoch; }
+
   /// getIROrder - Return the node ordering.
   ///
   unsigned getIROrder() const { return IROrder; }
@@ -757,7 +780,8 @@ protected:
   SDNode(unsigned Opc, unsigned Order, DebugLoc dl, SDVTList VTs,
          ArrayRef<SDValue> Ops)
       : NodeType(Opc), OperandsNeedDelete(true), HasDebugValue(false),
-        SubclassData(0), NodeId(-1),
+        SubclassData(0), NodeId(-1), CombinerWorklistIndex(-1),
+        CombinerEpoch(0),
         OperandList(Ops.size() ? new SDUse[Ops.size()] : nullptr),
         ValueList(VTs.VTs), UseList(nullptr), NumOperands(Ops.size()),
         NumValues(VTs.NumVTs), debugLoc(std::move(dl)), IROrder(Order) {
@@ -778,7 +802,8 @@ protected:
   /// set later with InitOperands.
   SDNode(unsigned Opc, unsigned Order, DebugLoc dl, SDVTList VTs)
       : NodeType(Opc), OperandsNeedDelete(false), HasDebugValue(false),
-        SubclassData(0), NodeId(-1), OperandList(nullptr), ValueList(VTs.VTs),
+        SubclassData(0), NodeId(-1), CombinerWorklistIndex(-1),
+        CombinerEpoch(0), OperandList(nullptr), ValueList(VTs.VTs),
         UseList(nullptr), NumOperands(0), NumValues(VTs.NumVTs),
         debugLoc(std::move(dl)), IROrder(Order) {
     assert(debugLoc.hasTrivialDestructor() && "Expected trivial destructor");
@@ -21,6 +21,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFDebugRangeList.h"
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/DebugInfo/DWARF/DWARFTypeUnit.h"
+#include <future>
 #include <vector>
 
 namespace llvm {
@@ -39,6 +40,10 @@ class DWARFContext : public DIContext {
   std::unique_ptr<DWARFDebugLine> Line;
   std::unique_ptr<DWARFDebugFrame> DebugFrame;
 
+  /// Line table prefetches still running on the shared thread pool. They
+  /// borrow the Line object, so the destructor waits for them.
+  std::vector<std::shared_future<void>> PrefetchFutures;
+
   DWARFUnitSection<DWARFCompileUnit> DWOCUs;
   std::vector<DWARFUnitSection<DWARFTypeUnit>> DWOTUs;
   std::unique_ptr<DWARFDebugAbbrev> AbbrevDWO;
@@ -63,8 +68,14 @@ class DWARFContext : public DIContext {
   /// and store them in DWOTUs.
   void parseDWOTypeUnits();
 
+  /// Kick off background parses of the line tables of compile units whose
+  /// address ranges neighbor \p Address, since consecutive address lookups
+  /// tend to cluster. A no-op unless line table prefetching is enabled.
+  void prefetchLineTables(uint64_t Address);
+
 public:
   DWARFContext() : DIContext(CK_DWARF) {}
+  ~DWARFContext() override;
 
   static bool classof(const DIContext *DICtx) {
     return DICtx->getKind() == CK_DWARF;
@@ -11,6 +11,7 @@
 #define LLVM_LIB_DEBUGINFO_DWARFDEBUGARANGES_H
 
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/DataExtractor.h"
 #include <vector>
 
@@ -20,8 +21,21 @@ class DWARFContext;
 
 class DWARFDebugAranges {
 public:
+  /// Populate the table from the .debug_aranges section alone. This is cheap
+  /// as it doesn't parse any DIEs.
   void generate(DWARFContext *CTX);
+  /// Add ranges collected from the DIEs of any compile units .debug_aranges
+  /// didn't describe and rebuild the table. This parses DIEs and is therefore
+  /// expensive, so it should only be called after findAddress has failed.
+  /// Returns false if the table was already complete.
+  bool generateFromMissingUnits(DWARFContext *CTX);
   uint32_t findAddress(uint64_t Address) const;
+  /// Collect the offsets of up to \p Count distinct compile units other than
+  /// the one containing \p Address whose ranges are closest to it on either
+  /// side. Used to pick prefetch candidates, since consecutive lookups tend
+  /// to land in neighboring units.
+  void findNeighborCUs(uint64_t Address, unsigned Count,
+                       SmallVectorImpl<uint32_t> &CUOffsets) const;
 
 private:
   void clear();
@@ -10,10 +10,12 @@
 #ifndef LLVM_LIB_DEBUGINFO_DWARFDEBUGLINE_H
 #define LLVM_LIB_DEBUGINFO_DWARFDEBUGLINE_H
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/DebugInfo/DWARF/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFRelocMap.h"
 #include "llvm/Support/DataExtractor.h"
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -209,6 +211,12 @@ public:
   const LineTable *getOrParseLineTable(DataExtractor debug_line_data,
                                        uint32_t offset);
 
+  /// Parse the line table at the given offset into the cache if it is not
+  /// there yet. Unlike the accessors above, which may only race with this
+  /// function, prefetches may run concurrently with each other and with the
+  /// accessors, so this can be called from worker threads.
+  void prefetchLineTable(DataExtractor debug_line_data, uint32_t offset);
+
 private:
   struct ParsingState {
     ParsingState(struct LineTable *LT);
@@ -230,7 +238,13 @@ private:
   typedef LineTableMapTy::const_iterator LineTableConstIter;
 
   const RelocAddrMap *RelocMap;
+  /// Guards LineTableMap and PrefetchesInFlight against concurrent
+  /// prefetches. Entries are never erased, so pointers into the map stay
+  /// valid after the lock is dropped.
+  mutable std::mutex Mutex;
   LineTableMapTy LineTableMap;
+  /// Offsets a background prefetch is currently parsing.
+  DenseSet<uint32_t> PrefetchesInFlight;
 };
 
 }
@@ -0,0 +1,58 @@
+//===-- DiskObjectCache.h - On-disk object cache for MCJIT ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines an ObjectCache that persists compiled objects in a
+// directory, keyed by a hash of the module contents, so identical modules
+// are never code generated twice across process restarts.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_DISKOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_DISKOBJECTCACHE_H
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include <string>
+
+namespace llvm {
+
+/// An ObjectCache that stores each compiled object as a file in a cache
+/// directory, named by a hash of the module it was generated from. Hits are
+/// returned as memory-mapped buffers, so reattaching a cached object costs a
+/// stat and an mmap rather than a codegen run.
+///
+/// The cache is safe to share between processes: objects are written to a
+/// unique temporary and renamed into place, so readers never observe a
+/// partially written file, and pruning is serialized with a LockFileManager
+/// lock. All cache failures are silent; a broken cache only costs
+/// recompilation.
+class DiskObjectCache : public ObjectCache {
+public:
+  /// Create a cache rooted at \p Dir, creating the directory if needed.
+  /// If \p MaxSize is non-zero, the cache is pruned back to at most that many
+  /// bytes after each insertion, discarding the least recently used objects.
+  DiskObjectCache(StringRef Dir, uint64_t MaxSize = 0);
+  ~DiskObjectCache() override;
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+private:
+  /// Return the path of the cache entry for \p M.
+  std::string getEntryPath(const Module *M);
+
+  /// Delete least recently used entries until the cache fits in MaxSize.
+  void prune();
+
+  std::string CacheDir;
+  uint64_t MaxSize;
+};
+
+} // End llvm namespace
+
+#endif
@@ -27,6 +27,7 @@
 #include "llvm/Support/Mutex.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -469,6 +470,14 @@ public:
     LazyFunctionCreator = P;
   }
 
+  /// InstallTierUpCompiler - For tiered execution in the interpreter: once a
+  /// function has been entered Threshold times, Compiler is asked for a native
+  /// entry point for it on every subsequent entry until it returns one, so
+  /// compilers that work asynchronously may return null while a function is
+  /// still in flight. Engines that always run native code ignore this.
+  virtual void InstallTierUpCompiler(std::function<void *(Function &)> Compiler,
+                                     unsigned Threshold) {}
+
 protected:
   ExecutionEngine() : EEState(*this) {}
   explicit ExecutionEngine(std::unique_ptr<Module> M);
@@ -18,6 +18,7 @@
 #include "IndirectionUtils.h"
 #include "LookasideRTDyldMM.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/LazyCallGraph.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include <list>
 
@@ -142,9 +143,16 @@ public:
   typedef std::function<uint64_t(const std::string &)> LookupFtor;
 
   /// @brief Construct a compile-on-demand layer instance.
-  CompileOnDemandLayer(BaseLayerT &BaseLayer, LLVMContext &Context)
+  ///
+  ///   If SpecQueue is non-null then a hit on a function's stub will, in
+  /// addition to compiling that function, enqueue background compiles for
+  /// the functions its body statically references, so that they are likely
+  /// to be ready before their own stubs are reached.
+  CompileOnDemandLayer(BaseLayerT &BaseLayer, LLVMContext &Context,
+                       SpeculativeCompileQueue *SpecQueue = nullptr)
     : BaseLayer(BaseLayer),
-      CompileCallbackMgr(BaseLayer, Context, 0, 64) {}
+      CompileCallbackMgr(BaseLayer, Context, 0, 64),
+      SpecQueue(SpecQueue) {}
 
   /// @brief Add a module to the compile-on-demand layer.
   template <typename ModuleSetT>
@@ -217,6 +225,25 @@ private:
     auto LogicalModule = DylibLookup->createLogicalModule();
     MSI.LMHandles.push_back(LogicalModule);
 
+    // Map each function to the functions its body statically references, so
+    // that a stub hit can speculatively trigger its callees' compiles. This
+    // must be computed up front: the function bodies are renamed and split
+    // into separate modules below.
+    std::map<std::string, std::vector<std::string>> CalleeNames;
+    if (SpecQueue) {
+      LazyCallGraph CG(M);
+      for (auto &F : M) {
+        if (F.isDeclaration())
+          continue;
+        auto &Callees = CalleeNames[F.getName()];
+        for (auto &CalleeN : CG.get(F)) {
+          Function &Callee = CalleeN.getFunction();
+          if (!Callee.isDeclaration() && &Callee != &F)
+            Callees.push_back(Callee.getName());
+        }
+      }
+    }
+
     // Partition M into a "globals and stubs" module, a "common symbols" module,
     // and a list of single-function modules.
     auto PartitionedModule = fullyPartition(M);
@@ -236,6 +263,9 @@ private:
       StubInfoMap;
     StubInfoMap StubInfos;
 
+    // Map of definition names to the base layer module holding each body.
+    std::map<std::string, BaseLayerModuleSetHandleT> BodyHandles;
+
     // Now we need to take each of the extracted Modules and add them to
     // base layer. Each Module will be added individually to make sure they
     // can be compiled separately, and each will get its own lookaside
@@ -271,28 +301,48 @@ private:
 
       auto H = addModule(std::move(SubM), MSI, LogicalModule, FallbackLookup);
 
-      // Set the compile actions for this module:
-      for (auto &KVPair : NewStubInfos) {
-        std::string BodyName = Mangle(KVPair->first + BodySuffix,
-                                      *M.getDataLayout());
-        auto &CCInfo = KVPair->second;
-        CCInfo.setCompileAction(
-          [=](){
-            return BaseLayer.findSymbolIn(H, BodyName, false).getAddress();
-          });
-      }
+      // Remember which base layer module holds each body. The compile
+      // actions are set below, once the stubs for the whole logical module
+      // exist, so that each action can reference its callees' callbacks.
+      for (auto &KVPair : NewStubInfos)
+        BodyHandles[KVPair->first] = H;
 
     }
 
     // Ok - we've processed all the partitioned modules. Now add the
-    // stubs/globals module and set the update actions.
+    // stubs/globals module and set the compile and update actions.
     auto StubsH =
       addModule(std::move(StubsModule), MSI, LogicalModule, FallbackLookup);
 
     for (auto &KVPair : StubInfos) {
-      std::string AddrName = Mangle(KVPair.first + AddrSuffix,
-                                    *M.getDataLayout());
+      const std::string &Name = KVPair.first;
       auto &CCInfo = KVPair.second;
+
+      // Collect the callback ids of this function's static callees. A hit
+      // on this function's stub pushes these onto the speculation queue, on
+      // the theory that a function is likely to call what its body
+      // references.
+      std::vector<TargetAddress> CalleeIds;
+      if (SpecQueue)
+        for (auto &CalleeName : CalleeNames[Name]) {
+          auto CalleeI = StubInfos.find(CalleeName);
+          if (CalleeI != StubInfos.end())
+            CalleeIds.push_back(CalleeI->second.getId());
+        }
+
+      std::string BodyName = Mangle(Name + BodySuffix, *M.getDataLayout());
+      auto H = BodyHandles[Name];
+      CCInfo.setCompileAction(
+        [=](){
+          if (SpecQueue)
+            for (auto CalleeId : CalleeIds)
+              SpecQueue->enqueue([=]() {
+                CompileCallbackMgr.executeCompileCallback(CalleeId);
+              });
+          return BaseLayer.findSymbolIn(H, BodyName, false).getAddress();
+        });
+
+      std::string AddrName = Mangle(Name + AddrSuffix, *M.getDataLayout());
       CCInfo.setUpdateAction(
         CompileCallbackMgr.getLocalFPUpdater(StubsH, AddrName));
     }
@@ -347,6 +397,7 @@ private:
   BaseLayerT &BaseLayer;
   CompileCallbackMgrT CompileCallbackMgr;
   ModuleSetInfoListT ModuleSetInfos;
+  SpeculativeCompileQueue *SpecQueue;
 };
 
 } // End namespace orc.
@@ -0,0 +1,157 @@
+//===- ConstantPoolingLayer.h - Share constants across modules --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definition of a layer that interns large constant data arrays
+// across the modules added to the JIT, so that modules sharing big lookup
+// tables do not each carry their own copy in the JIT heap.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_CONSTANTPOOLINGLAYER_H
+#define LLVM_EXECUTIONENGINE_ORC_CONSTANTPOOLINGLAYER_H
+
+#include "JITSymbol.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Module.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace llvm {
+namespace orc {
+
+/// @brief Constant interning layer.
+///
+///   This layer accepts sets of LLVM IR Modules (via addModuleSet) and scans
+/// them for large internal constants with ConstantDataSequential initializers
+/// (typically machine-generated lookup tables).  The first time a given byte
+/// pattern is seen, its bytes are copied into memory owned by this layer; the
+/// defining global, and every later global with the same contents, is replaced
+/// by a pointer to that single copy and deleted from its module.  The modules
+/// are then passed down to the base layer unchanged in every other respect.
+///
+///   Only constants whose address identity does not matter are pooled: the
+/// global must be internal or private, marked unnamed_addr, untyped by a
+/// custom section, and at least MinPoolSize bytes long.  Because the pooled
+/// bytes are referenced directly by emitted code, this layer must outlive any
+/// code emitted from the modules it has processed.
+template <typename BaseLayerT> class ConstantPoolingLayer {
+public:
+  typedef typename BaseLayerT::ModuleSetHandleT ModuleSetHandleT;
+
+  /// @brief Construct a ConstantPoolingLayer with the given BaseLayer.
+  ///        Constants smaller than MinPoolSize bytes are left alone.
+  ConstantPoolingLayer(BaseLayerT &BaseLayer, uint64_t MinPoolSize = 4096)
+      : BaseLayer(BaseLayer), MinPoolSize(MinPoolSize) {}
+
+  /// @brief Intern large constants in each module of the set, then add the
+  ///        set to the layer below.
+  ///
+  /// @return A handle for the added modules.
+  template <typename ModuleSetT>
+  ModuleSetHandleT addModuleSet(ModuleSetT Ms,
+                                std::unique_ptr<RTDyldMemoryManager> MM) {
+    for (auto &M : Ms)
+      poolConstantsIn(*M);
+    return BaseLayer.addModuleSet(std::move(Ms), std::move(MM));
+  }
+
+  /// @brief Remove the module set associated with the handle H.  The pooled
+  ///        constants are retained: other module sets may reference them.
+  void removeModuleSet(ModuleSetHandleT H) { BaseLayer.removeModuleSet(H); }
+
+  /// @brief Search for the given named symbol.
+  JITSymbol findSymbol(const std::string &Name, bool ExportedSymbolsOnly) {
+    return BaseLayer.findSymbol(Name, ExportedSymbolsOnly);
+  }
+
+  /// @brief Search for the given named symbol in the module set represented
+  ///        by the handle H.
+  JITSymbol findSymbolIn(ModuleSetHandleT H, const std::string &Name,
+                         bool ExportedSymbolsOnly) {
+    return BaseLayer.findSymbolIn(H, Name, ExportedSymbolsOnly);
+  }
+
+  /// @brief Immediately emit and finalize the module set represented by the
+  ///        given handle.
+  void emitAndFinalize(ModuleSetHandleT H) { BaseLayer.emitAndFinalize(H); }
+
+private:
+  struct PoolEntry {
+    std::unique_ptr<char[]> Storage;
+    char *Data;
+    size_t Size;
+  };
+
+  // All pooled constants are aligned to this, so any global with an alignment
+  // requirement up to it can share a pool entry.
+  static const uint64_t PoolAlignment = 64;
+
+  void poolConstantsIn(Module &M) {
+    for (auto I = M.global_begin(), E = M.global_end(); I != E;) {
+      GlobalVariable &GV = *I++;
+
+      // Pooling replaces distinct globals with one address, so it is only
+      // legal for constants whose address identity is declared meaningless.
+      if (!GV.isConstant() || !GV.hasInitializer() || !GV.hasLocalLinkage() ||
+          !GV.hasUnnamedAddr() || GV.isThreadLocal() || GV.hasSection() ||
+          GV.getType()->getAddressSpace() != 0 ||
+          GV.getAlignment() > PoolAlignment)
+        continue;
+
+      auto *CDS = dyn_cast<ConstantDataSequential>(GV.getInitializer());
+      if (!CDS)
+        continue;
+
+      StringRef Bytes = CDS->getRawDataValues();
+      if (Bytes.size() < MinPoolSize)
+        continue;
+
+      const char *Pooled = getPooledCopy(Bytes);
+      Constant *Addr =
+          ConstantInt::get(Type::getInt64Ty(M.getContext()),
+                           static_cast<uint64_t>(
+                               reinterpret_cast<uintptr_t>(Pooled)));
+      GV.replaceAllUsesWith(ConstantExpr::getIntToPtr(Addr, GV.getType()));
+      GV.eraseFromParent();
+    }
+  }
+
+  /// Return the canonical copy of Bytes, allocating one if this is the first
+  /// time these contents have been seen.
+  const char *getPooledCopy(StringRef Bytes) {
+    std::vector<PoolEntry> &Bucket = Pool[hash_value(Bytes)];
+    for (const PoolEntry &PE : Bucket)
+      if (PE.Size == Bytes.size() &&
+          memcmp(PE.Data, Bytes.data(), PE.Size) == 0)
+        return PE.Data;
+
+    PoolEntry PE;
+    PE.Storage.reset(new char[Bytes.size() + PoolAlignment - 1]);
+    uintptr_t Raw = reinterpret_cast<uintptr_t>(PE.Storage.get());
+    PE.Data = reinterpret_cast<char *>(
+        (Raw + PoolAlignment - 1) & ~uintptr_t(PoolAlignment - 1));
+    PE.Size = Bytes.size();
+    memcpy(PE.Data, Bytes.data(), PE.Size);
+    Bucket.push_back(std::move(PE));
+    return Bucket.back().Data;
+  }
+
+  BaseLayerT &BaseLayer;
+  uint64_t MinPoolSize;
+  DenseMap<uint64_t, std::vector<PoolEntry>> Pool;
+};
+
+} // End namespace orc.
+} // End namespace llvm.
+
+#endif // LLVM_EXECUTIONENGINE_ORC_CONSTANTPOOLINGLAYER_H
@@ -19,7 +19,13 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace llvm {
 namespace orc {
@@ -43,28 +49,59 @@ public:
 
   /// @brief Execute the callback for the given trampoline id. Called by the JIT
   ///        to compile functions on demand.
+  ///
+  ///   This method is thread safe: compile and update actions run outside the
+  /// manager lock, so callbacks for distinct functions are dispatched
+  /// concurrently, while racing calls through the same stub block on the
+  /// in-flight compile and share its result.
   TargetAddress executeCompileCallback(TargetAddress TrampolineID) {
+    std::unique_lock<std::mutex> Lock(ManagerMtx);
+
+    // If another thread raced through the same stub and is already running
+    // this compile, wait for its result rather than compiling twice.
+    auto P = PendingCompiles.find(TrampolineID);
+    if (P != PendingCompiles.end()) {
+      auto State = P->second;
+      State->Done.wait(Lock, [&] { return State->Finished; });
+      return State->Result ? State->Result : ErrorHandlerAddress;
+    }
+
+    // A call that picked up the trampoline address before the stub was
+    // patched, but only reaches the resolver after the compile finished, is
+    // answered from the cached result. This is also why the trampoline is
+    // never recycled: reassigning its id would dispatch such a straggler to
+    // the wrong function.
+    auto R = CompiledAddrs.find(TrampolineID);
+    if (R != CompiledAddrs.end())
+      return R->second;
+
     typename TrampolineMapT::iterator I = ActiveTrampolines.find(TrampolineID);
     // FIXME: Also raise an error in the Orc error-handler when we finally have
     //        one.
     if (I == ActiveTrampolines.end())
       return ErrorHandlerAddress;
 
-    // Found a callback handler. Yank this trampoline out of the active list and
-    // put it back in the available trampolines list, then try to run the
-    // handler's compile and update actions.
-    // Moving the trampoline ID back to the available list first means there's at
-    // least one available trampoline if the compile action triggers a request for
-    // a new one.
-    AvailableTrampolines.push_back(I->first - TargetT::CallSize);
+    // Found a callback handler. Take ownership of the compile for this
+    // trampoline, then run the handler's compile and update actions with the
+    // lock dropped.
+    auto State = std::make_shared<CompileState>();
+    PendingCompiles[TrampolineID] = State;
     auto CallbackHandler = std::move(I->second);
     ActiveTrampolines.erase(I);
 
-    if (auto Addr = CallbackHandler.Compile()) {
+    Lock.unlock();
+    TargetAddress Addr = CallbackHandler.Compile();
+    if (Addr)
       CallbackHandler.Update(Addr);
-      return Addr;
-    }
-    return ErrorHandlerAddress;
+    Lock.lock();
+
+    if (Addr)
+      CompiledAddrs[TrampolineID] = Addr;
+    State->Result = Addr;
+    State->Finished = true;
+    PendingCompiles.erase(TrampolineID);
+    State->Done.notify_all();
+    return Addr ? Addr : ErrorHandlerAddress;
   }
 
 protected:
@@ -77,12 +114,27 @@ protected:
     UpdateFtorT Update;
   };
 
+  /// Tracks one in-flight compile so that racing calls through the same stub
+  /// can wait for it instead of compiling twice.
+  struct CompileState {
+    CompileState() : Finished(false), Result(0) {}
+    std::condition_variable Done;
+    bool Finished;
+    TargetAddress Result;
+  };
+
   TargetAddress ErrorHandlerAddress;
   unsigned NumTrampolinesPerBlock;
 
+  /// Guards the trampoline maps below. Compile and update actions are always
+  /// run with this lock dropped.
+  std::mutex ManagerMtx;
+
   typedef std::map<TargetAddress, CallbackHandler> TrampolineMapT;
   TrampolineMapT ActiveTrampolines;
   std::vector<TargetAddress> AvailableTrampolines;
+  std::map<TargetAddress, std::shared_ptr<CompileState>> PendingCompiles;
+  std::map<TargetAddress, TargetAddress> CompiledAddrs;
 };
 
 /// @brief Manage compile callbacks.
@@ -120,10 +172,16 @@ public:
   class CompileCallbackInfo {
   public:
     CompileCallbackInfo(Constant *Addr, CompileFtorT &Compile,
-                        UpdateFtorT &Update)
-      : Addr(Addr), Compile(Compile), Update(Update) {}
+                        UpdateFtorT &Update, TargetAddress Id)
+      : Addr(Addr), Compile(Compile), Update(Update), Id(Id) {}
 
     Constant* getAddress() const { return Addr; }
+
+    /// @brief Get the callback id for this callback. Passing the id to
+    ///        executeCompileCallback triggers the callback's compile and
+    ///        update actions exactly as if its stub had been called.
+    TargetAddress getId() const { return Id; }
+
     void setCompileAction(CompileFtorT Compile) {
       this->Compile = std::move(Compile);
     }
@@ -134,10 +192,12 @@ public:
     Constant *Addr;
     CompileFtorT &Compile;
     UpdateFtorT &Update;
+    TargetAddress Id;
   };
 
   /// @brief Get/create a compile callback with the given signature.
   CompileCallbackInfo getCompileCallback(FunctionType &FT) {
+    std::lock_guard<std::mutex> Lock(this->ManagerMtx);
     TargetAddress TrampolineAddr = getAvailableTrampolineAddr(FT.getContext());
     auto &CallbackHandler =
       this->ActiveTrampolines[TrampolineAddr + TargetT::CallSize];
@@ -148,7 +208,8 @@ public:
                             PointerType::get(&FT, 0));
 
     return CompileCallbackInfo(AddrPtrVal, CallbackHandler.Compile,
-                               CallbackHandler.Update);
+                               CallbackHandler.Update,
+                               TrampolineAddr + TargetT::CallSize);
   }
 
   /// @brief Get a functor for updating the value of a named function pointer.
@@ -160,7 +221,11 @@ public:
       assert(FPSym && "Cannot find function pointer to update.");
       void *FPAddr = reinterpret_cast<void*>(
                        static_cast<uintptr_t>(FPSym.getAddress()));
-      memcpy(FPAddr, &Addr, sizeof(uintptr_t));
+      // Stub calls may load this pointer while it is being updated. The slot
+      // is pointer aligned, so a release store keeps a racing call from ever
+      // seeing a torn pointer.
+      reinterpret_cast<std::atomic<uintptr_t>*>(FPAddr)
+          ->store(static_cast<uintptr_t>(Addr), std::memory_order_release);
     };
   }
 
@@ -216,6 +281,38 @@ private:
   TargetAddress ResolverBlockAddr;
 };
 
+/// @brief Background queue for speculative function compiles.
+///
+///   Jobs enqueued here run in FIFO order on a dedicated worker thread. The
+/// CompileOnDemandLayer uses the queue to compile the static callees of a
+/// function whose stub has just been hit, so that they are (hopefully) ready
+/// before their own stubs are reached. Jobs must be safe to run concurrently
+/// with compiles on the execution thread; compiles dispatched through
+/// JITCompileCallbackManagerBase::executeCompileCallback satisfy this, since
+/// racing compiles of the same function are serialized there.
+class SpeculativeCompileQueue {
+public:
+  typedef std::function<void()> CompileJob;
+
+  SpeculativeCompileQueue();
+
+  /// @brief Stop the worker thread. Jobs that have not started are
+  ///        discarded; speculative work is best-effort by definition.
+  ~SpeculativeCompileQueue();
+
+  /// @brief Add a job to the back of the queue.
+  void enqueue(CompileJob Job);
+
+private:
+  void run();
+
+  std::mutex QueueMtx;
+  std::condition_variable JobsAvailable;
+  std::deque<CompileJob> Jobs;
+  bool Stop;
+  std::thread Worker;
+};
+
 GlobalVariable* createImplPointer(Function &F, const Twine &Name,
                                   Constant *Initializer);
 
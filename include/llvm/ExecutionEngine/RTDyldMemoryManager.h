@@ -15,6 +15,7 @@
 #define LLVM_EXECUTIONENGINE_RTDYLDMEMORYMANAGER_H
 
 #include "llvm-c/ExecutionEngine.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/CBindingWrapping.h"
 #include "llvm/Support/Memory.h"
@@ -89,6 +90,22 @@ public:
     return getSymbolAddressInProcess(Name);
   }
 
+  /// Resolve the addresses of a set of symbols in one call. On entry \p
+  /// Symbols maps each name to be resolved to zero; on return each entry
+  /// holds the symbol's address, or zero if it could not be resolved.
+  ///
+  /// RuntimeDyld resolves the external symbols of a loaded object through
+  /// this interface, so memory managers that forward resolution somewhere
+  /// expensive (for example over IPC to another process) can override it to
+  /// answer all queries for an object in a single round trip. The default
+  /// implementation just calls getSymbolAddress once per name, and clients
+  /// that override getSymbolAddress need not care that this exists.
+  virtual void getSymbolAddresses(StringMap<uint64_t> &Symbols) {
+    for (StringMap<uint64_t>::iterator I = Symbols.begin(), E = Symbols.end();
+         I != E; ++I)
+      I->second = getSymbolAddress(I->first().str());
+  }
+
   /// This method returns the address of the specified symbol if it exists
   /// within the logical dynamic library represented by this
   /// RTDyldMemoryManager. Unlike getSymbolAddress, queries through this
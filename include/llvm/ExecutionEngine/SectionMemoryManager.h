@@ -39,7 +39,16 @@ class SectionMemoryManager : public RTDyldMemoryManager {
   void operator=(const SectionMemoryManager&) = delete;
 
 public:
-  SectionMemoryManager() { }
+  /// Create a new SectionMemoryManager.
+  ///
+  /// If \p SlabSize is non-zero, memory is requested from the OS in multiples
+  /// of that many bytes and sections are carved out of the resulting slabs,
+  /// rather than one mapping per section. Packing sections into a few large
+  /// contiguous mappings keeps JITed hot code from being scattered across the
+  /// address space, and on systems with transparent huge pages a 2MB multiple
+  /// lets the kernel back code sections with huge pages, both of which reduce
+  /// iTLB pressure.
+  SectionMemoryManager(uintptr_t SlabSize = 0) : SlabSize(SlabSize) { }
   virtual ~SectionMemoryManager();
 
   /// \brief Allocates a memory block of (at least) the given size suitable for
@@ -84,9 +93,15 @@ public:
 
 private:
   struct MemoryGroup {
+      MemoryGroup() : NumFinalized(0) {}
+
       SmallVector<sys::MemoryBlock, 16> AllocatedMem;
       SmallVector<sys::MemoryBlock, 16> FreeMem;
       sys::MemoryBlock Near;
+
+      // Blocks in AllocatedMem below this index already carry their final
+      // permissions; only newer blocks need a protection pass.
+      unsigned NumFinalized;
   };
 
   uint8_t *allocateSection(MemoryGroup &MemGroup, uintptr_t Size,
@@ -98,6 +113,7 @@ private:
   MemoryGroup CodeMem;
   MemoryGroup RWDataMem;
   MemoryGroup RODataMem;
+  uintptr_t SlabSize;
 };
 
 }
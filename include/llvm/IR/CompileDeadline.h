@@ -0,0 +1,68 @@
+//===- llvm/IR/CompileDeadline.h - Compile-time budget ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the CompileDeadline class, which lets latency-sensitive
+// clients (JITs in particular) bound the wall time spent in the optimization
+// pipeline.  A CompileDeadline carries a set of pass IDs that the client has
+// declared deferrable; once the armed budget is exhausted, the legacy pass
+// managers skip those passes and run only the remainder of the pipeline.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_COMPILEDEADLINE_H
+#define LLVM_IR_COMPILEDEADLINE_H
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Timer.h"
+
+namespace llvm {
+
+class Pass;
+
+/// \brief A wall-time budget for one compile request.
+///
+/// Typical use: mark the expensive passes as deferrable while building the
+/// pipeline (PassManagerBuilder does this when its Deadline field is set),
+/// install the object on the LLVMContext with setCompileDeadline, and call
+/// begin() just before running the pass managers for each compile request.
+/// Only passes explicitly marked deferrable are ever skipped, so analyses
+/// and required lowering passes are unaffected.
+class CompileDeadline {
+public:
+  CompileDeadline() : Armed(false), BudgetSeconds(0) {}
+
+  /// \brief Arm the deadline for the next compile request, giving it a
+  /// budget of \p Milliseconds of wall time starting now.
+  void begin(unsigned Milliseconds);
+
+  /// \brief Disarm the deadline; no passes are skipped until the next
+  /// begin().
+  void clear() { Armed = false; }
+
+  /// \brief Return true if the deadline is armed and its budget is spent.
+  bool expired() const;
+
+  /// \brief Mark the pass identified by \p ID as safe to skip once the
+  /// budget is exhausted.
+  void addDeferrablePass(const void *ID) { DeferrableIDs.insert(ID); }
+
+  /// \brief Return true if \p P should be skipped: the deadline is armed,
+  /// the budget is spent, and \p P was marked deferrable.
+  bool shouldSkipPass(const Pass *P) const;
+
+private:
+  bool Armed;
+  double BudgetSeconds;
+  TimeRecord Start;
+  SmallPtrSet<const void *, 16> DeferrableIDs;
+};
+
+} // End llvm namespace
+
+#endif
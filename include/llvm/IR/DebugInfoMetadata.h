@@ -52,6 +52,16 @@ class MDLocation : public MDNode {
              unsigned Column, ArrayRef<Metadata *> MDs);
   ~MDLocation() { dropAllReferences(); }
 
+  /// Debug locations are numerous enough under -g to get their own
+  /// per-context pool instead of individual heap allocations.
+  void *operator new(size_t Size, LLVMContext &Context, unsigned NumOps);
+  void operator delete(void *Mem);
+
+  /// \brief Required by std, but never called.
+  void operator delete(void *, LLVMContext &, unsigned) {
+    llvm_unreachable("Constructor throws?");
+  }
+
   static MDLocation *getImpl(LLVMContext &Context, unsigned Line,
                              unsigned Column, Metadata *Scope,
                              Metadata *InlinedAt, StorageType Storage,
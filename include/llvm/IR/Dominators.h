@@ -115,6 +115,22 @@ public:
   /// \brief Provide an overload for a Use.
   bool isReachableFromEntry(const Use &U) const;
 
+  /// \brief Update the tree to reflect the insertion of the CFG edge
+  /// \p From -> \p To. Call this after the edge has been added.
+  ///
+  /// Edge changes that provably cannot affect dominance (back edges, and
+  /// edges out of unreachable code) are recognized and cost a couple of tree
+  /// queries; other changes currently fall back to recomputing the tree.
+  /// Using this instead of invalidating the analysis lets a pass that makes
+  /// mostly-trivial CFG edits keep its tree without paying for a
+  /// recomputation per edit.
+  void insertEdge(BasicBlock *From, BasicBlock *To);
+
+  /// \brief Update the tree to reflect the deletion of the CFG edge
+  /// \p From -> \p To. Call this after the edge has been removed.
+  /// See insertEdge for the cost model.
+  void deleteEdge(BasicBlock *From, BasicBlock *To);
+
   /// \brief Verify the correctness of the domtree by re-computing it.
   ///
   /// This should only be used for debugging as it aborts the program if the
@@ -86,6 +86,7 @@ private:
   mutable ArgumentListType ArgumentList;  ///< The formal arguments
   ValueSymbolTable *SymTab;               ///< Symbol table of args/instructions
   AttributeSet AttributeSets;             ///< Parameter attributes
+  uint64_t InstructionGeneration;         ///< Bumped on inst/block add/remove
 
   /*
    * Value::SubclassData
@@ -149,6 +150,15 @@ public:
   bool isMaterializable() const;
   void setIsMaterializable(bool V);
 
+  /// Generation counter bumped whenever an instruction or basic block is
+  /// added to or removed from this function. On-the-side summaries of the
+  /// body (see CFGSummaryCache) compare it to detect that their snapshot is
+  /// stale. In-place operand or successor rewrites do not bump the counter,
+  /// so consumers may only cache instruction positions, never what the
+  /// instructions refer to.
+  uint64_t getInstructionGeneration() const { return InstructionGeneration; }
+  void bumpInstructionGeneration() { ++InstructionGeneration; }
+
   /// getIntrinsicID - This method returns the ID number of the specified
   /// function, or Intrinsic::not_intrinsic if the function is not an
   /// intrinsic, or if the pointer is null.  This value is always defined to be
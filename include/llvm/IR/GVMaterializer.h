@@ -42,6 +42,13 @@ public:
   ///
   virtual std::error_code materialize(GlobalValue *GV) = 0;
 
+  /// Make sure \p F and the functions it statically calls are read, following
+  /// call edges up to \p Depth levels. Materializers that can batch their
+  /// reads override this to bring in whole call closures more cheaply than a
+  /// seek per callee; the default just materializes \p F itself.
+  ///
+  virtual std::error_code materializeClosure(Function &F, unsigned Depth);
+
   /// If the given GlobalValue is read in, and if the GVMaterializer supports
   /// it, release the memory for the GV, and set it up to be materialized
   /// lazily. If the Materializer doesn't support this capability, this method
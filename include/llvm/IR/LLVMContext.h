@@ -22,6 +22,7 @@
 
 namespace llvm {
 
+class CompileDeadline;
 class LLVMContextImpl;
 class StringRef;
 class Twine;
@@ -120,6 +121,13 @@ public:
   /// setDiagnosticContext.
   void *getDiagnosticContext() const;
 
+  /// diagnosticFiltersRespected - Return true if diagnostics that are not
+  /// enabled by the -pass-remarks* filters will be dropped by diagnose().
+  /// Remark emitters use this to avoid constructing diagnostics nothing will
+  /// consume; it is only false when a handler that asked for unfiltered
+  /// diagnostics is installed.
+  bool diagnosticFiltersRespected() const;
+
   /// \brief Report a message to the currently installed diagnostic handler.
   ///
   /// This function returns, in particular in the case of error reporting
@@ -158,6 +166,32 @@ public:
   /// any global mutex or cannot block the execution in another LLVM context.
   void yield();
 
+  /// \brief Install a compile deadline on this context, or remove the
+  /// current one if \p Deadline is null.
+  ///
+  /// While a deadline is installed and armed, the legacy pass managers skip
+  /// passes the deadline marks as deferrable once its budget is exhausted.
+  /// The deadline object is owned by the client and must outlive any pass
+  /// manager run on this context.
+  void setCompileDeadline(CompileDeadline *Deadline);
+
+  /// \brief Return the compile deadline installed on this context, if any.
+  CompileDeadline *getCompileDeadline() const;
+
+  /// \brief Allow ConstantInt and ConstantFP to be created from multiple
+  /// threads in this context.
+  ///
+  /// When enabled, the scalar constant uniquing tables are guarded by
+  /// per-shard locks so concurrent ConstantInt::get and ConstantFP::get calls
+  /// are safe. All other IR construction, including type creation, must still
+  /// be externally synchronized, so clients should create the types they need
+  /// up front. Has no effect (beyond some locking overhead) when LLVM is
+  /// built without threads.
+  void enableConcurrentConstants(bool Enable = true);
+
+  /// \brief Whether concurrent scalar constant creation is enabled.
+  bool concurrentConstantsEnabled() const;
+
   /// emitError - Emit an error message to the currently installed error handler
   /// with optional location information.  This function returns, so code should
   /// be prepared to drop the erroneous construct on the floor and "not crash".
@@ -95,6 +95,12 @@ private:
 
 } // End legacy namespace
 
+/// getExecutingPass - Return the pass whose run method is currently
+/// executing on this thread under a legacy pass manager, or null outside of
+/// one. Instrumentation (the alias analysis query profiler, for example)
+/// uses this to attribute work to the pass that requested it.
+const Pass *getExecutingPass();
+
 // Create wrappers for C Binding types (see CBindingWrapping.h).
 DEFINE_STDCXX_CONVERSION_FUNCTIONS(legacy::PassManagerBase, LLVMPassManagerRef)
 
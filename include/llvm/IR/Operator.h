@@ -85,10 +85,12 @@ private:
   void setHasNoUnsignedWrap(bool B) {
     SubclassOptionalData =
       (SubclassOptionalData & ~NoUnsignedWrap) | (B * NoUnsignedWrap);
+    ++ValueMutationEpoch;
   }
   void setHasNoSignedWrap(bool B) {
     SubclassOptionalData =
       (SubclassOptionalData & ~NoSignedWrap) | (B * NoSignedWrap);
+    ++ValueMutationEpoch;
   }
 
 public:
@@ -135,6 +137,7 @@ private:
   friend class ConstantExpr;
   void setIsExact(bool B) {
     SubclassOptionalData = (SubclassOptionalData & ~IsExact) | (B * IsExact);
+    ++ValueMutationEpoch;
   }
 
 public:
@@ -222,6 +225,7 @@ private:
     SubclassOptionalData =
       (SubclassOptionalData & ~FastMathFlags::UnsafeAlgebra) |
       (B * FastMathFlags::UnsafeAlgebra);
+    ++ValueMutationEpoch;
 
     // Unsafe algebra implies all the others
     if (B) {
@@ -235,33 +239,39 @@ private:
     SubclassOptionalData =
       (SubclassOptionalData & ~FastMathFlags::NoNaNs) |
       (B * FastMathFlags::NoNaNs);
+    ++ValueMutationEpoch;
   }
   void setHasNoInfs(bool B) {
     SubclassOptionalData =
       (SubclassOptionalData & ~FastMathFlags::NoInfs) |
       (B * FastMathFlags::NoInfs);
+    ++ValueMutationEpoch;
   }
   void setHasNoSignedZeros(bool B) {
     SubclassOptionalData =
       (SubclassOptionalData & ~FastMathFlags::NoSignedZeros) |
       (B * FastMathFlags::NoSignedZeros);
+    ++ValueMutationEpoch;
   }
   void setHasAllowReciprocal(bool B) {
     SubclassOptionalData =
       (SubclassOptionalData & ~FastMathFlags::AllowReciprocal) |
       (B * FastMathFlags::AllowReciprocal);
+    ++ValueMutationEpoch;
   }
 
   /// Convenience function for setting multiple fast-math flags.
   /// FMF is a mask of the bits to set.
   void setFastMathFlags(FastMathFlags FMF) {
     SubclassOptionalData |= FMF.Flags;
+    ++ValueMutationEpoch;
   }
 
   /// Convenience function for copying all fast-math flags.
   /// All values in FMF are transferred to this operator.
   void copyFastMathFlags(FastMathFlags FMF) {
     SubclassOptionalData = FMF.Flags;
+    ++ValueMutationEpoch;
   }
 
 public:
@@ -372,6 +382,7 @@ class GEPOperator
   void setIsInBounds(bool B) {
     SubclassOptionalData =
       (SubclassOptionalData & ~IsInBounds) | (B * IsInBounds);
+    ++ValueMutationEpoch;
   }
 
 public:
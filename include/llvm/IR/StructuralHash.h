@@ -0,0 +1,41 @@
+//===- llvm/IR/StructuralHash.h - IR Hash for expensive checks --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides a cheap digest of a function's structure, for use as a
+// first-stage filter wherever a full structural comparison would be too
+// expensive: function merging buckets, JIT object caches, "has this function
+// changed" checks, and the like.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_STRUCTURALHASH_H
+#define LLVM_IR_STRUCTURALHASH_H
+
+#include <stdint.h>
+
+namespace llvm {
+
+class Function;
+
+/// \brief Compute a digest of \p F's structure.
+///
+/// The hash is computed in a single pass over the function, walking the CFG
+/// from the entry block in the same order used by structural comparison, so
+/// it is independent of the layout order of basic blocks. It depends only on
+/// instruction opcodes, operand counts and type kinds -- never on pointer
+/// values or names -- so it is stable across runs and across hosts.
+///
+/// Two functions that are structurally equivalent are guaranteed to have the
+/// same hash; the converse does not hold, so callers must still compare
+/// functions that hash alike.
+uint64_t StructuralHash(const Function &F);
+
+} // End llvm namespace
+
+#endif
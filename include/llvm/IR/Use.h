@@ -29,6 +29,7 @@
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/Support/CBindingWrapping.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/DataTypes.h"
 #include <cstddef>
 #include <iterator>
 
@@ -39,6 +40,16 @@ class User;
 class Use;
 template <typename> struct simplify_type;
 
+/// ValueMutationEpoch - A thread-local counter bumped whenever IR visible to
+/// this thread is mutated: operand writes (and thus RAUW), value deletion,
+/// instruction motion (insertion, removal or moving between positions),
+/// optional-flag changes and instruction metadata changes.  Caches of derived
+/// facts (e.g. the SimplifyInstruction memo table) record the epoch at which
+/// an entry was computed and treat any entry from an older epoch as stale.
+/// Contexts may only be mutated by one thread at a time, so a thread-local
+/// counter is sufficient and keeps the bump off any shared cache line.
+extern LLVM_THREAD_LOCAL uint64_t ValueMutationEpoch;
+
 // Use** is only 4-byte aligned.
 template <> class PointerLikeTypeTraits<Use **> {
 public:
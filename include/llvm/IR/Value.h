@@ -377,6 +377,7 @@ public:
   /// \brief Clear the optional flags contained in this value.
   void clearSubclassOptionalData() {
     SubclassOptionalData = 0;
+    ++ValueMutationEpoch;
   }
 
   /// \brief Check the optional flags for equality.
@@ -387,6 +388,7 @@ public:
   /// \brief Clear any optional flags not set in the given Value.
   void intersectOptionalDataWith(const Value *V) {
     SubclassOptionalData &= V->SubclassOptionalData;
+    ++ValueMutationEpoch;
   }
 
   /// \brief Return true if there is a value handle associated with this value.
@@ -527,6 +529,7 @@ void Use::set(Value *V) {
   if (Val) removeFromList();
   Val = V;
   if (V) V->addUse(*this);
+  ++ValueMutationEpoch;
 }
 
 template <class Compare> void Value::sortUseList(Compare Cmp) {
@@ -128,6 +128,34 @@ private:
 /// @}
 };
 
+/// An immutable copy of a ValueSymbolTable taken at a point in time.
+///
+/// A snapshot may be queried from any number of threads without locking
+/// while a writer keeps mutating the live table and, when ready, publishes a
+/// fresh snapshot.  Names added, removed or changed after construction are
+/// not visible, and the Value pointers handed out are only safe to use for
+/// values the client keeps alive for the snapshot's lifetime.
+class ValueSymbolTableSnapshot {
+  StringMap<Value *> Map;
+
+  ValueSymbolTableSnapshot(const ValueSymbolTableSnapshot &) = delete;
+  void operator=(const ValueSymbolTableSnapshot &) = delete;
+
+public:
+  explicit ValueSymbolTableSnapshot(const ValueSymbolTable &VST);
+
+  /// Look up \p Name in the frozen view.
+  /// @returns the value \p Name was bound to when the snapshot was taken, or
+  /// null if it was not present then.
+  Value *lookup(StringRef Name) const { return Map.lookup(Name); }
+
+  /// @returns true iff the table was empty when the snapshot was taken.
+  bool empty() const { return Map.empty(); }
+
+  /// @brief The number of name/value pairs in the frozen view.
+  unsigned size() const { return unsigned(Map.size()); }
+};
+
 } // End llvm namespace
 
 #endif
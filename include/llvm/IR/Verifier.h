@@ -21,6 +21,7 @@
 #ifndef LLVM_IR_VERIFIER_H
 #define LLVM_IR_VERIFIER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include <string>
 
@@ -28,6 +29,7 @@ namespace llvm {
 
 class Function;
 class FunctionPass;
+class GlobalValue;
 class ModulePass;
 class Module;
 class PreservedAnalyses;
@@ -48,6 +50,30 @@ bool verifyFunction(const Function &F, raw_ostream *OS = nullptr);
 /// returned.
 bool verifyModule(const Module &M, raw_ostream *OS = nullptr);
 
+/// \brief Incrementally re-check a module after a small change.
+///
+/// Verifies only the function bodies that can have been invalidated by
+/// changing the values in \p Dirty: the dirty functions themselves plus every
+/// function containing a use of a dirty value (looking through constant
+/// expressions), along with the module-level rules. This is a fraction of the
+/// cost of verifyModule when few functions changed, which matters to JIT
+/// clients that verify after every patch. Debug info metadata is not
+/// re-verified. Returns true if an error was found, as verifyModule does.
+bool verifyModuleIncremental(const Module &M,
+                             ArrayRef<const GlobalValue *> Dirty,
+                             raw_ostream *OS = nullptr);
+
+/// \brief Check a module for errors, verifying function bodies in parallel.
+///
+/// Function-local checks are independent of each other, so each body is
+/// verified on a worker thread while the module-level rules (including debug
+/// info) are checked on the calling thread. Each worker writes into its own
+/// buffer and the buffers are emitted in module order once all workers
+/// finish, so the diagnostics are identical to verifyModule's. The module
+/// must not be mutated concurrently. Returns true if an error was found, as
+/// verifyModule does.
+bool verifyModuleParallel(const Module &M, raw_ostream *OS = nullptr);
+
 /// \brief Create a verifier pass.
 ///
 /// Check a module or function for validity. This is essentially a pass wrapped
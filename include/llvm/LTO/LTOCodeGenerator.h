@@ -40,6 +40,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Support/CodeGen.h"
 #include "llvm/Target/TargetOptions.h"
 #include <string>
 #include <vector>
@@ -70,6 +71,14 @@ struct LTOCodeGenerator {
   // Set the destination module.
   void setModule(struct LTOModule *);
 
+  // Resolve symbol liveness across all added modules and strip dead
+  // definitions before they are merged, instead of internalizing and
+  // dead-stripping the (much larger) merged module. In this mode modules
+  // handed to addModule() are not linked immediately but on the first
+  // compile or writeMergedModules() request, and the caller must keep them
+  // alive until then.
+  void setPreMergeDeadStrip(bool Value) { PreMergeDeadStrip = Value; }
+
   void setTargetOptions(TargetOptions options);
   void setDebugInfo(lto_debug_model);
   void setCodePICModel(lto_codegen_model);
@@ -132,6 +141,14 @@ struct LTOCodeGenerator {
   // if the compilation was not successful.
   const void *compileOptimized(size_t *length, std::string &errMsg);
 
+  // Compiles the merged optimized module into out.size() object files, with
+  // the i'th object file written to stream out[i]. When more than one stream
+  // is given, the module is partitioned by function and code generation runs
+  // on one thread per partition; the resulting object files must all be fed
+  // to the final link. Returns true on success.
+  bool compileOptimized(ArrayRef<raw_ostream *> out,
+                        std::string &errMsg);
+
   void setDiagnosticHandler(lto_diagnostic_handler_t, void *);
 
   LLVMContext &getContext() { return Context; }
@@ -147,6 +164,7 @@ private:
                         SmallPtrSetImpl<GlobalValue *> &AsmUsed,
                         Mangler &Mangler);
   bool determineTarget(std::string &errMsg);
+  bool mergePendingModules(std::string &errMsg);
 
   static void DiagnosticHandler(const DiagnosticInfo &DI, void *Context);
 
@@ -169,11 +187,15 @@ private:
   std::vector<char *> CodegenOptions;
   std::string MCpu;
   std::string MAttr;
+  std::string FeatureStr;
+  Reloc::Model RelocModel;
   std::string NativeObjectPath;
   TargetOptions Options;
   lto_diagnostic_handler_t DiagHandler;
   void *DiagContext;
   LTOModule *OwnedModule;
+  bool PreMergeDeadStrip;
+  std::vector<LTOModule *> PendingModules;
 };
 }
 #endif
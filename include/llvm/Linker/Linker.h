@@ -53,10 +53,22 @@ public:
     // The set of identified but non opaque structures in the composite module.
     NonOpaqueStructTypeSet NonOpaqueStructTypes;
 
+    // Cached structural signatures of types in the composite module. A
+    // signature is a name-insensitive hash of a type's shape; it survives
+    // across the modules linked into the composite. Only types whose
+    // reachable type graph contains no opaque type are cached, since giving
+    // an opaque type a body changes the shape of everything that reaches it.
+    DenseMap<Type *, uint64_t> StructuralHashes;
+
     void addNonOpaque(StructType *Ty);
     void addOpaque(StructType *Ty);
     StructType *findNonOpaque(ArrayRef<Type *> ETypes, bool IsPacked);
     bool hasType(StructType *Ty);
+
+    /// Return false if \p DstTy and \p SrcTy are known not to be isomorphic
+    /// because their structural signatures differ. A true result is only a
+    /// hash match; the caller must still run the full recursive check.
+    bool mayBeIsomorphic(Type *DstTy, Type *SrcTy);
   };
 
   Linker(Module *M, DiagnosticHandlerFunction DiagnosticHandler);
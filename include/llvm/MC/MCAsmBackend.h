@@ -102,6 +102,15 @@ public:
                                     const MCRelaxableFragment *DF,
                                     const MCAsmLayout &Layout) const = 0;
 
+  /// fixupValueNeedsRelaxation - Variant of fixupNeedsRelaxation for fixups
+  /// whose value is already known before layout, such as a branch to a target
+  /// placed earlier in the same fragment. Targets that cannot decide without
+  /// a layout should conservatively return true.
+  virtual bool fixupValueNeedsRelaxation(const MCFixup &Fixup,
+                                         uint64_t Value) const {
+    return true;
+  }
+
   /// RelaxInstruction - Relax the instruction in the given fragment to the next
   /// wider instruction.
   ///
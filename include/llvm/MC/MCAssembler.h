@@ -307,17 +307,18 @@ class MCRelaxableFragment : public MCEncodedFragmentWithFixups {
   SmallVector<MCFixup, 1> Fixups;
 
 public:
-  MCRelaxableFragment(const MCInst &_Inst,
+  MCRelaxableFragment(MCInst _Inst,
                       const MCSubtargetInfo &_STI,
                       MCSectionData *SD = nullptr)
-    : MCEncodedFragmentWithFixups(FT_Relaxable, SD), Inst(_Inst), STI(_STI) {
+    : MCEncodedFragmentWithFixups(FT_Relaxable, SD), Inst(std::move(_Inst)),
+      STI(_STI) {
   }
 
   SmallVectorImpl<char> &getContents() override { return Contents; }
   const SmallVectorImpl<char> &getContents() const override { return Contents; }
 
   const MCInst &getInst() const { return Inst; }
-  void setInst(const MCInst& Value) { Inst = Value; }
+  void setInst(MCInst Value) { Inst = std::move(Value); }
 
   const MCSubtargetInfo &getSubtargetInfo() { return STI; }
 
@@ -1005,6 +1006,11 @@ public:
   void writeSectionData(const MCSectionData *Section,
                         const MCAsmLayout &Layout) const;
 
+  /// Emit the section contents through \p OW instead of the assembler's own
+  /// object writer. Used when rendering section contents into memory buffers.
+  void writeSectionData(const MCSectionData *Section, const MCAsmLayout &Layout,
+                        MCObjectWriter &OW) const;
+
   /// Check whether a given symbol has been flagged with .thumb_func.
   bool isThumbFunc(const MCSymbol *Func) const;
 
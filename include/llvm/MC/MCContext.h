@@ -20,7 +20,9 @@
 #include "llvm/MC/SectionKind.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <map>
 #include <tuple>
 #include <vector> // FIXME: Shouldn't be needed.
@@ -70,8 +72,22 @@ namespace llvm {
     /// objects.
     BumpPtrAllocator Allocator;
 
-    /// Symbols - Bindings of names to symbols.
-    SymbolTable Symbols;
+    /// The symbol table is sharded by name hash so that symbol creation from
+    /// concurrent streamers does not serialize on a single map. Each shard
+    /// owns the allocator its symbols are created from, and its lock must be
+    /// held for any access to the shard's table or allocator. Mutable so that
+    /// logically-const lookups can take the lock.
+    struct SymbolTableShard {
+      sys::SmartMutex<true> Lock;
+      BumpPtrAllocator Allocator;
+      SymbolTable Symbols;
+      SymbolTableShard() : Symbols(Allocator) {}
+    };
+    static const unsigned NumSymbolShards = 16;
+    mutable SymbolTableShard SymbolShards[NumSymbolShards];
+
+    /// Return the shard responsible for \p Name.
+    SymbolTableShard &getSymbolShard(StringRef Name) const;
 
     /// ELF sections can have a corresponding symbol. This maps one to the
     /// other.
@@ -86,12 +102,16 @@ namespace llvm {
     DenseMap<std::pair<unsigned, unsigned>, MCSymbol*> LocalSymbols;
 
     /// UsedNames - Keeps tracks of names that were used both for used declared
-    /// and artificial symbols.
+    /// and artificial symbols. Guarded by UsedNamesLock, which is always
+    /// acquired after a shard lock, never before; the critical sections are a
+    /// single hash insertion so this map is not worth sharding.
+    sys::SmartMutex<true> UsedNamesLock;
+    BumpPtrAllocator UsedNamesAllocator;
     StringMap<bool, BumpPtrAllocator&> UsedNames;
 
     /// NextUniqueID - The next ID to dole out to an unnamed assembler temporary
     /// symbol.
-    unsigned NextUniqueID;
+    std::atomic<unsigned> NextUniqueID;
 
     /// Instances of directional local labels.
     DenseMap<unsigned, MCLabel *> Instances;
@@ -175,6 +195,8 @@ namespace llvm {
     bool AutoReset;
 
     MCSymbol *CreateSymbol(StringRef Name);
+    /// Create a symbol in \p Shard, whose lock the caller must hold.
+    MCSymbol *CreateSymbol(SymbolTableShard &Shard, StringRef Name);
 
     MCSymbol *getOrCreateDirectionalLocalSymbol(unsigned LocalLabelVal,
                                                 unsigned Instance);
@@ -243,13 +265,10 @@ namespace llvm {
     MCSymbol *LookupSymbol(StringRef Name) const;
     MCSymbol *LookupSymbol(const Twine &Name) const;
 
-    /// getSymbols - Get a reference for the symbol table for clients that
-    /// want to, for example, iterate over all symbols. 'const' because we
-    /// still want any modifications to the table itself to use the MCContext
-    /// APIs.
-    const SymbolTable &getSymbols() const {
-      return Symbols;
-    }
+    /// getSymbols - Append every named symbol in the context to \p Syms, in
+    /// no particular order. Each shard lock is taken in turn, so the snapshot
+    /// is only consistent if no other thread is creating symbols.
+    void getSymbols(SmallVectorImpl<MCSymbol *> &Syms) const;
 
     /// @}
 
@@ -11,13 +11,14 @@
 
 #include "llvm-c/Disassembler.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/MC/MCInst.h"
 #include "llvm/MC/MCRelocationInfo.h"
 #include "llvm/MC/MCSymbolizer.h"
 #include "llvm/Support/DataTypes.h"
+#include <vector>
 
 namespace llvm {
-
-class MCInst;
 class MCSubtargetInfo;
 class raw_ostream;
 class MCContext;
@@ -79,6 +80,41 @@ public:
                                       raw_ostream &VStream,
                                       raw_ostream &CStream) const = 0;
 
+  /// The result of decoding one instruction through the batch interface.
+  struct DecodedInst {
+    MCInst Inst;
+    /// The size of the instruction, or the number of bytes skipped when the
+    /// encoding was invalid.
+    uint64_t Size;
+    DecodeStatus Status;
+    /// Comments and annotations the decoder produced for this instruction.
+    SmallString<16> Comments;
+
+    DecodedInst() : Size(0), Status(Fail) {}
+  };
+
+  /// Disassemble a run of instructions into \p Insts in one call, amortizing
+  /// the per-instruction setup that callers of getInstruction() repeat in
+  /// their decode loops.
+  ///
+  /// Instructions are appended to \p Insts for each offset below \p NumBytes,
+  /// starting at offset zero and advancing by each instruction's size.
+  /// \p Bytes may extend beyond \p NumBytes, in which case the final
+  /// instruction is permitted to overhang the decode window; this matches
+  /// disassembling one symbol's run out of a larger section. An invalid
+  /// encoding is recorded with a Fail status and a size that skips at least
+  /// one byte, so decoding always makes progress.
+  ///
+  /// @param Insts    - Filled with the decoded instructions.
+  /// @param Bytes    - The bytes of the region, starting at \p Address.
+  /// @param NumBytes - The size of the decode window.
+  /// @param Address  - The address of the first byte of the region.
+  /// @param VStream  - The stream to print warnings and diagnostics on.
+  /// @return         - The number of bytes consumed.
+  uint64_t getInstructions(std::vector<DecodedInst> &Insts,
+                           ArrayRef<uint8_t> Bytes, uint64_t NumBytes,
+                           uint64_t Address, raw_ostream &VStream) const;
+
 private:
   MCContext &Ctx;
 
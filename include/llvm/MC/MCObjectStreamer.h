@@ -10,6 +10,7 @@
 #ifndef LLVM_MC_MCOBJECTSTREAMER_H
 #define LLVM_MC_MCOBJECTSTREAMER_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/MC/MCAssembler.h"
 #include "llvm/MC/MCStreamer.h"
@@ -41,6 +42,13 @@ class MCObjectStreamer : public MCStreamer {
   SmallVector<MCSymbolData *, 2> PendingLabels;
 
   virtual void EmitInstToData(const MCInst &Inst, const MCSubtargetInfo&) = 0;
+
+  /// If \p Inst encodes to a single pc-relative fixup against a symbol that
+  /// is already placed in the current data fragment, the distance is final
+  /// before layout; apply the fixup now and append plain bytes instead of
+  /// starting a new MCRelaxableFragment. Returns true on success.
+  bool tryEmitInstResolved(const MCInst &Inst, const MCSubtargetInfo &STI);
+
   void EmitCFIStartProcImpl(MCDwarfFrameInfo &Frame) override;
   void EmitCFIEndProcImpl(MCDwarfFrameInfo &Frame) override;
 
@@ -95,6 +103,7 @@ public:
 
   void EmitLabel(MCSymbol *Symbol) override;
   void EmitAssignment(MCSymbol *Symbol, const MCExpr *Value) override;
+  void EmitIntValue(uint64_t Value, unsigned Size) override;
   void EmitValueImpl(const MCExpr *Value, unsigned Size,
                      const SMLoc &Loc = SMLoc()) override;
   void EmitULEB128Value(const MCExpr *Value) override;
@@ -122,6 +131,11 @@ public:
                              unsigned Column, unsigned Flags,
                              unsigned Isa, unsigned Discriminator,
                              StringRef FileName) override;
+  /// If the difference \p Hi - \p Lo is already known at streaming time -
+  /// both are offsets into the same data fragment - return it without
+  /// waiting for layout.
+  Optional<int64_t> absoluteSymbolDiff(const MCSymbol *Hi,
+                                       const MCSymbol *Lo) const;
   void EmitDwarfAdvanceLineAddr(int64_t LineDelta, const MCSymbol *LastLabel,
                                 const MCSymbol *Label,
                                 unsigned PointerSize);
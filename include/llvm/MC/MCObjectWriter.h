@@ -15,12 +15,14 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
+#include <map>
 
 namespace llvm {
 class MCAsmLayout;
 class MCAssembler;
 class MCFixup;
 class MCFragment;
+class MCSectionData;
 class MCSymbolData;
 class MCSymbolRefExpr;
 class MCValue;
@@ -45,6 +47,10 @@ protected:
 
   unsigned IsLittleEndian : 1;
 
+private:
+  /// Section contents pre-rendered by renderSections(), keyed by section.
+  std::map<const MCSectionData *, SmallVector<char, 0>> RenderedSections;
+
 protected: // Can only create subclasses.
   MCObjectWriter(raw_ostream &_OS, bool _IsLittleEndian)
     : OS(_OS), IsLittleEndian(_IsLittleEndian) {}
@@ -53,7 +59,7 @@ public:
   virtual ~MCObjectWriter();
 
   /// lifetime management
-  virtual void reset() { }
+  virtual void reset() { RenderedSections.clear(); }
 
   bool isLittleEndian() const { return IsLittleEndian; }
 
@@ -81,6 +87,22 @@ public:
                                 const MCFixup &Fixup, MCValue Target,
                                 bool &IsPCRel, uint64_t &FixedValue) = 0;
 
+  /// \brief Render the contents of every non-virtual section into an
+  /// in-memory buffer, on several worker threads when enabled.
+  ///
+  /// The format-specific writers keep full control over where the bytes land
+  /// in the file: a later writeSectionContents() call copies the pre-rendered
+  /// buffer to the output stream, so the object file is byte-identical to
+  /// what direct emission produces. This is a no-op unless multi-threaded
+  /// section rendering is requested.
+  void renderSections(const MCAssembler &Asm, const MCAsmLayout &Layout);
+
+  /// \brief Write the contents of \p SD to the output stream, from the
+  /// pre-rendered buffer when renderSections() produced one and directly from
+  /// the fragments otherwise.
+  void writeSectionContents(const MCAssembler &Asm, const MCSectionData *SD,
+                            const MCAsmLayout &Layout);
+
   /// \brief Check whether the difference (A - B) between two symbol
   /// references is fully resolved.
   ///
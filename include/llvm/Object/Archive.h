@@ -14,6 +14,7 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Object/Binary.h"
@@ -133,6 +134,7 @@ public:
   };
 
   class Symbol {
+    friend class Archive;
     const Archive *Parent;
     uint32_t SymbolIndex;
     uint32_t StringIndex; // Extra index to the string.
@@ -212,6 +214,10 @@ private:
   child_iterator FirstRegular;
   unsigned Format : 2;
   unsigned IsThin : 1;
+  /// Hash index over the symbol table, built lazily by findSym so that
+  /// repeated lookups do not rescan the table.
+  mutable StringMap<std::pair<uint32_t, uint32_t>> SymbolIndexMap;
+  mutable bool SymbolIndexBuilt;
 };
 
 }
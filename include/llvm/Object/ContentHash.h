@@ -0,0 +1,56 @@
+//===- ContentHash.h - Object file content hashing --------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares utilities for computing stable content hashes for the
+// sections and symbols of an object file.  Incremental build systems and
+// object caches use these to detect changed sections and functions without
+// byte-diffing whole objects.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_OBJECT_CONTENTHASH_H
+#define LLVM_OBJECT_CONTENTHASH_H
+
+#include "llvm/Object/ObjectFile.h"
+#include <vector>
+
+namespace llvm {
+namespace object {
+
+/// Content hash of a single section.
+struct SectionContentHash {
+  SectionRef Section;
+  uint64_t Hash;
+};
+
+/// Content hash of a single defined symbol.
+struct SymbolContentHash {
+  SymbolRef Symbol;
+  uint64_t Hash;
+};
+
+/// Compute a hash of the raw contents of \p Sec as stored in the file.
+/// Sections that occupy no file space (e.g. .bss) hash their size instead.
+/// The hash is stable across processes and may be persisted.
+uint64_t hashSectionContents(const SectionRef &Sec);
+
+/// Compute content hashes for all sections of \p Obj, in section order.
+std::vector<SectionContentHash> computeSectionHashes(const ObjectFile &Obj);
+
+/// Compute content hashes for the symbols of \p Obj that name a slice of a
+/// section's contents, hashing the bytes of that slice.  Undefined, absolute
+/// and common symbols are omitted.  The hash covers only the symbol's own
+/// bytes; a change that only affects its relocations shows up in the hash of
+/// the containing relocation section.
+std::vector<SymbolContentHash> computeSymbolHashes(const ObjectFile &Obj);
+
+} // end namespace object
+} // end namespace llvm
+
+#endif
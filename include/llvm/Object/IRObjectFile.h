@@ -65,6 +65,25 @@ public:
   static ErrorOr<MemoryBufferRef>
   findBitcodeInMemBuffer(MemoryBufferRef Object);
 
+  /// \brief A symbol read from the symbol table block of a bitcode file. It
+  /// carries everything a linker's symbol resolution needs, so the module
+  /// itself does not have to be materialized.
+  struct FileSymbol {
+    std::string Name;
+    std::string Comdat;  // The comdat key, empty if there is none.
+    uint32_t Flags;      // BasicSymbolRef flags.
+    unsigned Visibility; // A GlobalValue::VisibilityTypes value.
+    bool IsExternalWeak;
+    bool IsWeakForLinker;
+  };
+
+  /// \brief Reads the symbols of the given buffer from its bitcode symbol
+  /// table block, without materializing the module. Returns false when the
+  /// bitcode has no symbol table block; the caller must then fall back to
+  /// create().
+  static ErrorOr<bool> readSymbols(MemoryBufferRef Object,
+                                   std::vector<FileSymbol> &Symbols);
+
   static ErrorOr<std::unique_ptr<IRObjectFile>> create(MemoryBufferRef Object,
                                                        LLVMContext &Context);
 };
@@ -25,6 +25,8 @@
 #include "llvm/PassInfo.h"
 #include "llvm/Support/CBindingWrapping.h"
 #include "llvm/Support/RWMutex.h"
+#include <atomic>
+#include <memory>
 #include <vector>
 
 namespace llvm {
@@ -35,24 +37,41 @@ struct PassRegistrationListener;
 /// PassRegistry - This class manages the registration and intitialization of
 /// the pass subsystem as application startup, and assists the PassManager
 /// in resolving pass dependencies.
-/// NOTE: PassRegistry is NOT thread-safe.  If you want to use LLVM on multiple
-/// threads simultaneously, you will need to use a separate PassRegistry on
-/// each thread.
+///
+/// Registration is rare (almost all of it happens from static initializers
+/// and library init entry points) while lookups happen on every pipeline
+/// construction, so the lookup tables are published as immutable snapshots
+/// through an atomic pointer.  Lookups are lock-free; registration takes the
+/// writer lock, rebuilds the snapshot and republishes it, retiring the old
+/// snapshot until destruction since readers are never tracked.
 class PassRegistry {
   mutable sys::SmartRWMutex<true> Lock;
 
   /// PassInfoMap - Keep track of the PassInfo object for each registered pass.
   typedef DenseMap<const void *, const PassInfo *> MapType;
-  MapType PassInfoMap;
 
   typedef StringMap<const PassInfo *> StringMapType;
-  StringMapType PassInfoStringMap;
+
+  /// An immutable snapshot of the lookup tables.  Readers obtain it with an
+  /// acquire load of \c Tables and never take the lock.
+  struct LookupTables {
+    MapType PassInfoMap;
+    StringMapType PassInfoStringMap;
+  };
+
+  /// Tables - The currently published snapshot, or null before the first
+  /// registration.  Written only while holding \c Lock.
+  mutable std::atomic<const LookupTables *> Tables;
+
+  /// RetiredTables - Superseded snapshots.  A concurrent lookup may still be
+  /// walking one of these, so they are only freed with the registry itself.
+  std::vector<std::unique_ptr<const LookupTables>> RetiredTables;
 
   std::vector<std::unique_ptr<const PassInfo>> ToFree;
   std::vector<PassRegistrationListener *> Listeners;
 
 public:
-  PassRegistry() {}
+  PassRegistry() : Tables(nullptr) {}
   ~PassRegistry();
 
   /// getPassRegistry - Access the global registry object, which is
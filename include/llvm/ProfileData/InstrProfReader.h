@@ -166,8 +166,12 @@ private:
   const ProfileData *Data;
   const ProfileData *DataEnd;
   const uint64_t *CountersStart;
+  const uint64_t *CountersEnd;
   const char *NamesStart;
   const char *ProfileEnd;
+  /// Counters expanded from a run-length encoded counter section.  Empty for
+  /// version 1 profiles, whose counter sections are used in place.
+  std::vector<uint64_t> DecodedCounters;
 
   RawInstrProfReader(const RawInstrProfReader &) = delete;
   RawInstrProfReader &operator=(const RawInstrProfReader &) = delete;
@@ -206,16 +210,27 @@ enum class HashT : uint32_t;
 /// Trait for lookups into the on-disk hash table for the binary instrprof
 /// format.
 class InstrProfLookupTrait {
-  std::vector<uint64_t> DataBuffer;
   IndexedInstrProf::HashT HashType;
 public:
   InstrProfLookupTrait(IndexedInstrProf::HashT HashType) : HashType(HashType) {}
 
+  /// The profile data for a function. The counter words are left in their
+  /// on-disk form and decoded as they are used, so looking up a function only
+  /// touches the pages its own counters live on.
   struct data_type {
-    data_type(StringRef Name, ArrayRef<uint64_t> Data)
-        : Name(Name), Data(Data) {}
+    data_type(StringRef Name, const unsigned char *Data, uint64_t NumWords)
+        : Name(Name), Data(Data), NumWords(NumWords) {}
     StringRef Name;
-    ArrayRef<uint64_t> Data;
+    /// The raw, little endian data, \c NumWords 64-bit words long.
+    const unsigned char *Data;
+    uint64_t NumWords;
+
+    /// Decode the I'th word of the data.
+    uint64_t getWord(uint64_t I) const {
+      using namespace support;
+      return endian::read<uint64_t, little, unaligned>(Data +
+                                                       I * sizeof(uint64_t));
+    }
   };
   typedef StringRef internal_key_type;
   typedef StringRef external_key_type;
@@ -240,19 +255,13 @@ public:
   }
 
   data_type ReadData(StringRef K, const unsigned char *D, offset_type N) {
-    DataBuffer.clear();
     if (N % sizeof(uint64_t))
       // The data is corrupt, don't try to read it.
-      return data_type("", DataBuffer);
+      return data_type("", nullptr, 0);
 
-    using namespace support;
-    // We just treat the data as opaque here. It's simpler to handle in
+    // We just treat the data as opaque here. It's decoded on demand in
     // IndexedInstrProfReader.
-    unsigned NumEntries = N / sizeof(uint64_t);
-    DataBuffer.reserve(NumEntries);
-    for (unsigned I = 0; I < NumEntries; ++I)
-      DataBuffer.push_back(endian::readNext<uint64_t, little, unaligned>(D));
-    return data_type(K, DataBuffer);
+    return data_type(K, D, N / sizeof(uint64_t));
   }
 };
 typedef OnDiskIterableChainedHashTable<InstrProfLookupTrait>
@@ -267,8 +276,10 @@ private:
   std::unique_ptr<InstrProfReaderIndex> Index;
   /// Iterator over the profile data.
   InstrProfReaderIndex::data_iterator RecordIterator;
-  /// Offset into our current data set.
+  /// Offset into our current data set, in words.
   size_t CurrentOffset;
+  /// Decoded counts for the current record.
+  std::vector<uint64_t> CountBuffer;
   /// The file format version of the profile data.
   uint64_t FormatVersion;
   /// The maximal execution count among all functions.
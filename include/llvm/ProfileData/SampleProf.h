@@ -57,6 +57,15 @@ static inline uint64_t SPMagic() {
          uint64_t('2') << (64 - 56) | uint64_t(0xff);
 }
 
+/// \brief Magic number for the indexed binary format. The trailing 'I'
+/// distinguishes it from the stream-oriented binary format above.
+static inline uint64_t SPMagicIndexed() {
+  return uint64_t('S') << (64 - 8) | uint64_t('P') << (64 - 16) |
+         uint64_t('R') << (64 - 24) | uint64_t('O') << (64 - 32) |
+         uint64_t('F') << (64 - 40) | uint64_t('4') << (64 - 48) |
+         uint64_t('I') << (64 - 56) | uint64_t(0xff);
+}
+
 static inline uint64_t SPVersion() { return 100; }
 
 /// \brief Represents the relative location of an instruction.
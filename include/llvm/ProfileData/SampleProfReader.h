@@ -20,6 +20,7 @@
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
 #include "llvm/ProfileData/SampleProf.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -71,6 +72,13 @@ public:
   /// \brief Read sample profiles from the associated file.
   virtual std::error_code read() = 0;
 
+  /// \brief Read the sample profiles needed to compile module \p M.
+  ///
+  /// By default this reads the whole file. Readers backed by an indexed
+  /// format override it to load only the profiles of functions defined
+  /// in \p M.
+  virtual std::error_code read(const Module &M) { return read(); }
+
   /// \brief Print the profile for \p FName on stream \p OS.
   void dumpFunctionProfile(StringRef FName, raw_ostream &OS = dbgs());
 
@@ -153,6 +161,9 @@ protected:
   /// \returns the read value.
   ErrorOr<StringRef> readString();
 
+  /// \brief Read a single function record starting at the current position.
+  std::error_code readFunctionProfile();
+
   /// \brief Return true if we've reached the end of file.
   bool at_eof() const { return Data >= End; }
 
@@ -163,6 +174,38 @@ protected:
   const uint8_t *End;
 };
 
+/// \brief Reader for the indexed binary format.
+///
+/// The file carries the same function records as the binary format,
+/// followed by an index mapping each function name to the offset of its
+/// record. Only the index is parsed up front; records are decoded on
+/// demand, so compiling a module touches just the profiles of the
+/// functions it defines.
+class SampleProfileReaderIndexed : public SampleProfileReaderBinary {
+public:
+  SampleProfileReaderIndexed(std::unique_ptr<MemoryBuffer> B, LLVMContext &C)
+      : SampleProfileReaderBinary(std::move(B), C) {}
+
+  /// \brief Read and validate the file header and the function index.
+  std::error_code readHeader() override;
+
+  /// \brief Read every function record mentioned in the index.
+  std::error_code read() override;
+
+  /// \brief Read only the records for functions defined in \p M.
+  std::error_code read(const Module &M) override;
+
+  /// \brief Return true if \p Buffer is in the format supported by this class.
+  static bool hasFormat(const MemoryBuffer &Buffer);
+
+private:
+  /// \brief Read the record for \p FName if the index mentions it.
+  std::error_code readFunctionProfile(StringRef FName);
+
+  /// \brief Offset of each function record, keyed by function name.
+  StringMap<uint64_t> FuncOffsets;
+};
+
 } // End namespace sampleprof
 
 } // End namespace llvm
@@ -25,7 +25,13 @@ namespace llvm {
 
 namespace sampleprof {
 
-enum SampleProfileFormat { SPF_None = 0, SPF_Text, SPF_Binary, SPF_GCC };
+enum SampleProfileFormat {
+  SPF_None = 0,
+  SPF_Text,
+  SPF_Binary,
+  SPF_GCC,
+  SPF_Indexed
+};
 
 /// \brief Sample-based profile writer. Base class.
 class SampleProfileWriter {
@@ -95,12 +101,45 @@ public:
 /// \brief Sample-based profile writer (binary format).
 class SampleProfileWriterBinary : public SampleProfileWriter {
 public:
-  SampleProfileWriterBinary(StringRef F, std::error_code &EC);
+  SampleProfileWriterBinary(StringRef F, std::error_code &EC)
+      : SampleProfileWriterBinary(F, EC, SPMagic()) {}
+
+  bool write(StringRef F, const FunctionSamples &S) override;
+  bool write(const Module &M, StringMap<FunctionSamples> &P) {
+    return SampleProfileWriter::write(M, P);
+  }
+
+protected:
+  /// \brief Open \p F and emit a header with the given magic number.
+  ///
+  /// The record encoding is shared with the indexed format, which only
+  /// differs in its magic number and the index it appends to the file.
+  SampleProfileWriterBinary(StringRef F, std::error_code &EC, uint64_t Magic);
+};
+
+/// \brief Sample-based profile writer (indexed binary format).
+///
+/// Function records use the same encoding as the binary format, but the
+/// file ends with an index mapping each function name to the offset of
+/// its record, so readers can load individual functions on demand. The
+/// index is emitted when the writer is destroyed, once all the records
+/// are known.
+class SampleProfileWriterIndexed : public SampleProfileWriterBinary {
+public:
+  SampleProfileWriterIndexed(StringRef F, std::error_code &EC)
+      : SampleProfileWriterBinary(F, EC, SPMagicIndexed()) {}
+  ~SampleProfileWriterIndexed() { writeIndex(); }
 
   bool write(StringRef F, const FunctionSamples &S) override;
   bool write(const Module &M, StringMap<FunctionSamples> &P) {
     return SampleProfileWriter::write(M, P);
   }
+
+private:
+  void writeIndex();
+
+  /// \brief Name and file offset of every record written so far.
+  std::vector<std::pair<std::string, uint64_t>> IndexEntries;
 };
 
 } // End namespace sampleprof
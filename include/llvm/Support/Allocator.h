@@ -142,10 +142,11 @@ public:
                 "allocation.");
 
   BumpPtrAllocatorImpl()
-      : CurPtr(nullptr), End(nullptr), BytesAllocated(0), Allocator() {}
+      : CurPtr(nullptr), End(nullptr), CurSlabIdx(0), BytesAllocated(0),
+        Allocator() {}
   template <typename T>
   BumpPtrAllocatorImpl(T &&Allocator)
-      : CurPtr(nullptr), End(nullptr), BytesAllocated(0),
+      : CurPtr(nullptr), End(nullptr), CurSlabIdx(0), BytesAllocated(0),
         Allocator(std::forward<T &&>(Allocator)) {}
 
   // Manually implement a move constructor as we must clear the old allocators
@@ -153,9 +154,10 @@ public:
   BumpPtrAllocatorImpl(BumpPtrAllocatorImpl &&Old)
       : CurPtr(Old.CurPtr), End(Old.End), Slabs(std::move(Old.Slabs)),
         CustomSizedSlabs(std::move(Old.CustomSizedSlabs)),
-        BytesAllocated(Old.BytesAllocated),
+        CurSlabIdx(Old.CurSlabIdx), BytesAllocated(Old.BytesAllocated),
         Allocator(std::move(Old.Allocator)) {
     Old.CurPtr = Old.End = nullptr;
+    Old.CurSlabIdx = 0;
     Old.BytesAllocated = 0;
     Old.Slabs.clear();
     Old.CustomSizedSlabs.clear();
@@ -172,12 +174,14 @@ public:
 
     CurPtr = RHS.CurPtr;
     End = RHS.End;
+    CurSlabIdx = RHS.CurSlabIdx;
     BytesAllocated = RHS.BytesAllocated;
     Slabs = std::move(RHS.Slabs);
     CustomSizedSlabs = std::move(RHS.CustomSizedSlabs);
     Allocator = std::move(RHS.Allocator);
 
     RHS.CurPtr = RHS.End = nullptr;
+    RHS.CurSlabIdx = 0;
     RHS.BytesAllocated = 0;
     RHS.Slabs.clear();
     RHS.CustomSizedSlabs.clear();
@@ -192,6 +196,7 @@ public:
 
     // Reset the state.
     BytesAllocated = 0;
+    CurSlabIdx = 0;
     CurPtr = (char *)Slabs.front();
     End = CurPtr + SlabSize;
 
@@ -202,6 +207,24 @@ public:
     CustomSizedSlabs.clear();
   }
 
+  /// \brief Reset the allocator without returning any slabs to the
+  /// underlying allocator. Retained slabs are reused by subsequent
+  /// allocations, which makes this the preferred form of Reset for an
+  /// allocator that is repeatedly filled to a similar level, at the cost of
+  /// holding on to the high-water mark of memory. Custom-sized slabs are
+  /// still returned: each was sized for a single oversized allocation and is
+  /// unlikely to fit another.
+  void ResetKeepingSlabs() {
+    BytesAllocated = 0;
+    if (!Slabs.empty()) {
+      CurSlabIdx = 0;
+      CurPtr = (char *)Slabs.front();
+      End = CurPtr + SlabSize;
+    }
+    DeallocateCustomSizedSlabs();
+    CustomSizedSlabs.clear();
+  }
+
   /// \brief Allocate space at the specified alignment.
   LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size, size_t Alignment) {
     assert(Alignment > 0 && "0-byte alignnment is not allowed. Use 1 instead.");
@@ -286,6 +309,12 @@ private:
   /// \brief Custom-sized slabs allocated for too-large allocation requests.
   SmallVector<std::pair<void *, size_t>, 0> CustomSizedSlabs;
 
+  /// \brief The index of the slab CurPtr points into.
+  ///
+  /// This is only less than Slabs.size() - 1 after ResetKeepingSlabs, when
+  /// retained slabs beyond the current one are waiting to be reused.
+  size_t CurSlabIdx;
+
   /// \brief How many bytes we've allocated.
   ///
   /// Used so that we can compute how much space was wasted.
@@ -302,13 +331,22 @@ private:
     return SlabSize * ((size_t)1 << std::min<size_t>(30, SlabIdx / 128));
   }
 
-  /// \brief Allocate a new slab and move the bump pointers over into the new
-  /// slab, modifying CurPtr and End.
+  /// \brief Move the bump pointers over into the next slab, modifying CurPtr
+  /// and End. A slab retained by ResetKeepingSlabs is reused if one is
+  /// available; otherwise a new slab is allocated.
   void StartNewSlab() {
+    if (!Slabs.empty() && CurSlabIdx + 1 < Slabs.size()) {
+      ++CurSlabIdx;
+      CurPtr = (char *)Slabs[CurSlabIdx];
+      End = CurPtr + computeSlabSize(CurSlabIdx);
+      return;
+    }
+
     size_t AllocatedSlabSize = computeSlabSize(Slabs.size());
 
     void *NewSlab = Allocator.Allocate(AllocatedSlabSize, 0);
     Slabs.push_back(NewSlab);
+    CurSlabIdx = Slabs.size() - 1;
     CurPtr = (char *)(NewSlab);
     End = ((char *)NewSlab) + AllocatedSlabSize;
   }
@@ -174,6 +174,18 @@
 #define LLVM_UNLIKELY(EXPR) (EXPR)
 #endif
 
+/// \macro LLVM_PREFETCH
+/// \brief Hint to the processor to bring the given address into cache.
+/// \p RW is 0 for an expected read, 1 for a write; \p Locality ranges from 0
+/// (no temporal locality) to 3 (keep in all cache levels). Expands to nothing
+/// on compilers without a prefetch builtin.
+#if __has_builtin(__builtin_prefetch) || LLVM_GNUC_PREREQ(4, 0, 0)
+#define LLVM_PREFETCH(ADDR, RW, LOCALITY) \
+  __builtin_prefetch(ADDR, RW, LOCALITY)
+#else
+#define LLVM_PREFETCH(ADDR, RW, LOCALITY) ((void)0)
+#endif
+
 // C++ doesn't support 'extern template' of template specializations.  GCC does,
 // but requires __extension__ before it.  In the header, use this:
 //   EXTERN_TEMPLATE_INSTANTIATION(class foo<bar>);
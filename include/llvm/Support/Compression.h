@@ -45,6 +45,34 @@ bool isAvailable();
 Status compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                 CompressionLevel Level = DefaultCompression);
 
+/// Streaming variant of compress(). Input is fed in a chunk at a time and the
+/// compressed bytes are appended to the output buffer as they are produced,
+/// so callers whose data is only available piecewise need not concatenate it
+/// first. The output is identical to a one-shot compress() of the
+/// concatenated input.
+class StreamCompressor {
+  void *Strm; ///< Opaque z_stream, keeping <zlib.h> out of this header.
+  SmallVectorImpl<char> &Out;
+
+  StreamCompressor(const StreamCompressor &) = delete;
+  void operator=(const StreamCompressor &) = delete;
+
+public:
+  StreamCompressor(SmallVectorImpl<char> &CompressedBuffer,
+                   CompressionLevel Level = DefaultCompression);
+  ~StreamCompressor();
+
+  /// Compress another chunk of input.
+  Status update(StringRef Chunk);
+
+  /// Flush any pending output and finalize the stream. No further update()
+  /// calls are allowed afterwards.
+  Status finish();
+};
+
+Status uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                  size_t &UncompressedSize);
+
 Status uncompress(StringRef InputBuffer,
                   SmallVectorImpl<char> &UncompressedBuffer,
                   size_t UncompressedSize);
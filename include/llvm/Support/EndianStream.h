@@ -15,8 +15,10 @@
 #ifndef LLVM_SUPPORT_ENDIANSTREAM_H
 #define LLVM_SUPPORT_ENDIANSTREAM_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 namespace llvm {
 namespace support {
@@ -30,6 +32,49 @@ template <endianness endian> struct Writer {
     Val = byte_swap<value_type, endian>(Val);
     OS.write((const char *)&Val, sizeof(value_type));
   }
+
+  /// Write an array of values, byte-swapping each into a fixed-size chunk and
+  /// issuing one stream write per chunk.  The swap loop over a chunk contains
+  /// no stream call and vectorizes, which matters when emitting large
+  /// cross-endian tables.
+  template <typename value_type> void writeArray(ArrayRef<value_type> Vals) {
+    value_type Chunk[256 / sizeof(value_type)];
+    while (!Vals.empty()) {
+      size_t N = std::min(Vals.size(), sizeof(Chunk) / sizeof(value_type));
+      for (size_t I = 0; I != N; ++I)
+        Chunk[I] = byte_swap<value_type, endian>(Vals[I]);
+      OS.write((const char *)Chunk, N * sizeof(value_type));
+      Vals = Vals.slice(N);
+    }
+  }
+};
+
+/// Stages the scalars of one fixed-size record, byte-swapped to the requested
+/// byte order, in a small stack buffer so the caller can append the whole
+/// record to its output with a single copy instead of one append per field.
+/// Unlike Writer the byte order is a runtime parameter, matching emitters
+/// (e.g. the ELF object writer) that pick it per target.
+template <unsigned Capacity> class RecordBuffer {
+  char Buf[Capacity];
+  unsigned Size;
+  bool IsLittleEndian;
+
+public:
+  explicit RecordBuffer(bool IsLittleEndian)
+      : Size(0), IsLittleEndian(IsLittleEndian) {}
+
+  template <typename value_type> void write(value_type Val) {
+    assert(Size + sizeof(value_type) <= Capacity && "record overflows buffer");
+    if (IsLittleEndian)
+      endian::write<value_type, little, unaligned>(Buf + Size, Val);
+    else
+      endian::write<value_type, big, unaligned>(Buf + Size, Val);
+    Size += sizeof(value_type);
+  }
+
+  const char *begin() const { return Buf; }
+  const char *end() const { return Buf + Size; }
+  unsigned size() const { return Size; }
 };
 
 template <>
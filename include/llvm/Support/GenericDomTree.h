@@ -24,6 +24,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -94,9 +95,8 @@ public:
   DomTreeNodeBase(NodeT *BB, DomTreeNodeBase<NodeT> *iDom)
       : TheBB(BB), IDom(iDom), DFSNumIn(-1), DFSNumOut(-1) {}
 
-  std::unique_ptr<DomTreeNodeBase<NodeT>>
-  addChild(std::unique_ptr<DomTreeNodeBase<NodeT>> C) {
-    Children.push_back(C.get());
+  DomTreeNodeBase<NodeT> *addChild(DomTreeNodeBase<NodeT> *C) {
+    Children.push_back(C);
     return C;
   }
 
@@ -212,11 +212,17 @@ template <class NodeT> class DominatorTreeBase : public DominatorBase<NodeT> {
   }
 
 protected:
-  typedef DenseMap<NodeT *, std::unique_ptr<DomTreeNodeBase<NodeT>>>
-      DomTreeNodeMapType;
+  typedef DenseMap<NodeT *, DomTreeNodeBase<NodeT> *> DomTreeNodeMapType;
   DomTreeNodeMapType DomTreeNodes;
   DomTreeNodeBase<NodeT> *RootNode;
 
+  /// Tree nodes are carved out of this allocator in creation order, which
+  /// recalculate() makes approximately DFS pre-order (immediate dominators
+  /// are always created before the blocks they dominate).  That keeps the
+  /// nodes a dominance query touches adjacent in memory, and lets reset()
+  /// reclaim them in bulk instead of freeing one heap allocation per block.
+  BumpPtrAllocator NodeAllocator;
+
   mutable bool DFSInfoValid;
   mutable unsigned int SlowQueries;
   // Information record used during immediate dominators computation.
@@ -237,8 +243,20 @@ protected:
   // Info - Collection of information used during the computation of idoms.
   DenseMap<NodeT *, InfoRec> Info;
 
+  /// createNode - Allocate a new tree node for BB from the node allocator.
+  /// The caller is responsible for linking it into its parent's child list.
+  DomTreeNodeBase<NodeT> *createNode(NodeT *BB, DomTreeNodeBase<NodeT> *IDom) {
+    return new (NodeAllocator) DomTreeNodeBase<NodeT>(BB, IDom);
+  }
+
   void reset() {
+    // Run the node destructors (the child vectors own heap memory), then
+    // give the node storage itself back in one shot.
+    for (auto &Entry : DomTreeNodes)
+      if (Entry.second)
+        Entry.second->~DomTreeNodeBase();
     DomTreeNodes.clear();
+    NodeAllocator.Reset();
     IDoms.clear();
     this->Roots.clear();
     Vertex.clear();
@@ -319,6 +337,7 @@ public:
             std::move(static_cast<DominatorBase<NodeT> &>(Arg))),
         DomTreeNodes(std::move(Arg.DomTreeNodes)),
         RootNode(std::move(Arg.RootNode)),
+        NodeAllocator(std::move(Arg.NodeAllocator)),
         DFSInfoValid(std::move(Arg.DFSInfoValid)),
         SlowQueries(std::move(Arg.SlowQueries)), IDoms(std::move(Arg.IDoms)),
         Vertex(std::move(Arg.Vertex)), Info(std::move(Arg.Info)) {
@@ -329,6 +348,7 @@ public:
         std::move(static_cast<DominatorBase<NodeT> &>(RHS)));
     DomTreeNodes = std::move(RHS.DomTreeNodes);
     RootNode = std::move(RHS.RootNode);
+    NodeAllocator = std::move(RHS.NodeAllocator);
     DFSInfoValid = std::move(RHS.DFSInfoValid);
     SlowQueries = std::move(RHS.SlowQueries);
     IDoms = std::move(RHS.IDoms);
@@ -372,10 +392,7 @@ public:
   /// block.  This is the same as using operator[] on this class.
   ///
   DomTreeNodeBase<NodeT> *getNode(NodeT *BB) const {
-    auto I = DomTreeNodes.find(BB);
-    if (I != DomTreeNodes.end())
-      return I->second.get();
-    return nullptr;
+    return DomTreeNodes.lookup(BB);
   }
 
   DomTreeNodeBase<NodeT> *operator[](NodeT *BB) const { return getNode(BB); }
@@ -556,8 +573,7 @@ public:
     DomTreeNodeBase<NodeT> *IDomNode = getNode(DomBB);
     assert(IDomNode && "Not immediate dominator specified for block!");
     DFSInfoValid = false;
-    return (DomTreeNodes[BB] = IDomNode->addChild(
-                llvm::make_unique<DomTreeNodeBase<NodeT>>(BB, IDomNode))).get();
+    return DomTreeNodes[BB] = IDomNode->addChild(createNode(BB, IDomNode));
   }
 
   /// changeImmediateDominator - This method is used to update the dominator
@@ -593,6 +609,9 @@ public:
       IDom->Children.erase(I);
     }
 
+    // The node's storage stays in the allocator until the next reset(); run
+    // its destructor now so the child vector doesn't leak until then.
+    Node->~DomTreeNodeBase();
     DomTreeNodes.erase(BB);
   }
 
@@ -606,37 +625,6 @@ public:
       this->Split<NodeT *, GraphTraits<NodeT *>>(*this, NewBB);
   }
 
-  /// print - Convert to human readable form
-  ///
-  void print(raw_ostream &o) const {
-    o << "=============================--------------------------------\n";
-    if (this->isPostDominator())
-      o << "Inorder PostDominator Tree: ";
-    else
-      o << "Inorder Dominator Tree: ";
-    if (!this->DFSInfoValid)
-      o << "DFSNumbers invalid: " << SlowQueries << " slow queries.";
-    o << "\n";
-
-    // The postdom tree can have a null root if there are no returns.
-    if (getRootNode())
-      PrintDomTree<NodeT>(getRootNode(), o, 1);
-  }
-
-protected:
-  template <class GraphT>
-  friend typename GraphT::NodeType *
-  Eval(DominatorTreeBase<typename GraphT::NodeType> &DT,
-       typename GraphT::NodeType *V, unsigned LastLinked);
-
-  template <class GraphT>
-  friend unsigned DFSPass(DominatorTreeBase<typename GraphT::NodeType> &DT,
-                          typename GraphT::NodeType *V, unsigned N);
-
-  template <class FuncT, class N>
-  friend void
-  Calculate(DominatorTreeBase<typename GraphTraits<N>::NodeType> &DT, FuncT &F);
-
   /// updateDFSNumbers - Assign In and Out numbers to the nodes while walking
   /// dominator tree in dfs order.
   void updateDFSNumbers() const {
@@ -682,6 +670,37 @@ protected:
     DFSInfoValid = true;
   }
 
+  /// print - Convert to human readable form
+  ///
+  void print(raw_ostream &o) const {
+    o << "=============================--------------------------------\n";
+    if (this->isPostDominator())
+      o << "Inorder PostDominator Tree: ";
+    else
+      o << "Inorder Dominator Tree: ";
+    if (!this->DFSInfoValid)
+      o << "DFSNumbers invalid: " << SlowQueries << " slow queries.";
+    o << "\n";
+
+    // The postdom tree can have a null root if there are no returns.
+    if (getRootNode())
+      PrintDomTree<NodeT>(getRootNode(), o, 1);
+  }
+
+protected:
+  template <class GraphT>
+  friend typename GraphT::NodeType *
+  Eval(DominatorTreeBase<typename GraphT::NodeType> &DT,
+       typename GraphT::NodeType *V, unsigned LastLinked);
+
+  template <class GraphT>
+  friend unsigned DFSPass(DominatorTreeBase<typename GraphT::NodeType> &DT,
+                          typename GraphT::NodeType *V, unsigned N);
+
+  template <class FuncT, class N>
+  friend void
+  Calculate(DominatorTreeBase<typename GraphTraits<N>::NodeType> &DT, FuncT &F);
+
   DomTreeNodeBase<NodeT> *getNodeForBlock(NodeT *BB) {
     if (DomTreeNodeBase<NodeT> *Node = getNode(BB))
       return Node;
@@ -695,8 +714,8 @@ protected:
 
     // Add a new tree node for this NodeT, and link it as a child of
     // IDomNode
-    return (this->DomTreeNodes[BB] = IDomNode->addChild(
-                llvm::make_unique<DomTreeNodeBase<NodeT>>(BB, IDomNode))).get();
+    return this->DomTreeNodes[BB] =
+               IDomNode->addChild(createNode(BB, IDomNode));
   }
 
   NodeT *getIDom(NodeT *BB) const { return IDoms.lookup(BB); }
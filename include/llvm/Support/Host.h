@@ -68,6 +68,14 @@ namespace sys {
   ///
   /// \return - True on success.
   bool getHostCPUFeatures(StringMap<bool> &Features);
+
+  /// getHostNumPhysicalCores - Get the number of physical cores, as opposed
+  /// to the logical CPU count reported by std::thread::hardware_concurrency(),
+  /// which counts hyperthreads as well.
+  ///
+  /// \return - The number of physical cores, or -1 if it cannot be
+  /// determined.
+  int getHostNumPhysicalCores();
 }
 }
 
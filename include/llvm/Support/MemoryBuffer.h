@@ -101,6 +101,15 @@ public:
   static std::unique_ptr<MemoryBuffer>
   getMemBuffer(MemoryBufferRef Ref, bool RequiresNullTerminator = true);
 
+  /// Return a buffer for the sub-range [Offset, Offset+Length) of \p Buffer
+  /// that shares ownership of the underlying data instead of copying it. The
+  /// data is kept alive until the last slice and the original handle are
+  /// destroyed, so archive members, bitcode inside wrappers and similar
+  /// sub-range consumers can all alias a single mapping.
+  static std::unique_ptr<MemoryBuffer>
+  getSlice(const std::shared_ptr<MemoryBuffer> &Buffer, uint64_t Offset,
+           uint64_t Length, const Twine &BufferName = "");
+
   /// Open the specified memory range as a MemoryBuffer, copying the contents
   /// and taking ownership of it. InputData does not have to be null terminated.
   static std::unique_ptr<MemoryBuffer>
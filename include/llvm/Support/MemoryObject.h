@@ -61,6 +61,11 @@ public:
   /// @param address - address of the byte, in the same space as getBase()
   /// @result        - true if the address may be read with readByte()
   virtual bool isValidAddress(uint64_t address) const = 0;
+
+  /// Returns true if the entire object is already resident in contiguous
+  /// memory, i.e. getPointer never blocks and readBytes is just a memcpy.
+  /// Clients may use this to read directly from the underlying buffer.
+  virtual bool isContiguous() const { return false; }
 };
 
 }
@@ -0,0 +1,147 @@
+//===- llvm/Support/Parallel.h - Parallel algorithms ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Parallel counterparts of std::for_each and std::sort, running on a shared
+// process-wide ThreadPool.  Small ranges are handled inline, so callers can
+// use these unconditionally and only large inputs pay for the pool.
+//
+// These algorithms block until the whole range has been processed.  They must
+// not be called from inside a task running on the shared pool: the pool does
+// not steal work while a task waits, so nested use would deadlock once all
+// workers are occupied.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PARALLEL_H
+#define LLVM_SUPPORT_PARALLEL_H
+
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+namespace llvm {
+namespace parallel {
+
+/// Return the process-wide pool the algorithms below run on.  Created on
+/// first use with one thread per physical core.
+ThreadPool &getPool();
+
+namespace detail {
+/// Ranges shorter than this are not worth a trip through the pool.
+enum { MinParallelSize = 1024 };
+}
+
+/// Apply \p Fn to every element in [Begin, End), processing chunks of the
+/// range concurrently.  \p Fn must be safe to run on multiple elements at
+/// once.
+template <class IterTy, class FuncTy>
+void for_each(IterTy Begin, IterTy End, FuncTy Fn) {
+  size_t Distance = std::distance(Begin, End);
+  ThreadPool &Pool = getPool();
+  if (Distance < detail::MinParallelSize || Pool.getThreadCount() <= 1) {
+    std::for_each(Begin, End, Fn);
+    return;
+  }
+
+  // Over-split so uneven per-element cost still balances across threads.
+  size_t ChunkSize = std::max<size_t>(1, Distance / (Pool.getThreadCount() * 4));
+  std::vector<std::shared_future<void>> Futures;
+  while (Distance > ChunkSize) {
+    IterTy ChunkEnd = Begin;
+    std::advance(ChunkEnd, ChunkSize);
+    Futures.push_back(
+        Pool.async([=] { std::for_each(Begin, ChunkEnd, Fn); }));
+    Begin = ChunkEnd;
+    Distance -= ChunkSize;
+  }
+  // Process the tail on the submitting thread rather than going idle.
+  std::for_each(Begin, End, Fn);
+  for (std::shared_future<void> &F : Futures)
+    F.wait();
+}
+
+/// Call \p Fn on every index in [Begin, End), chunked as in for_each.
+template <class IndexTy, class FuncTy>
+void for_each_n(IndexTy Begin, IndexTy End, FuncTy Fn) {
+  ThreadPool &Pool = getPool();
+  if (End - Begin < (IndexTy)detail::MinParallelSize ||
+      Pool.getThreadCount() <= 1) {
+    for (IndexTy I = Begin; I != End; ++I)
+      Fn(I);
+    return;
+  }
+
+  IndexTy ChunkSize =
+      std::max<IndexTy>(1, (End - Begin) / (Pool.getThreadCount() * 4));
+  std::vector<std::shared_future<void>> Futures;
+  while (End - Begin > ChunkSize) {
+    IndexTy ChunkEnd = Begin + ChunkSize;
+    Futures.push_back(Pool.async([=] {
+      for (IndexTy I = Begin; I != ChunkEnd; ++I)
+        Fn(I);
+    }));
+    Begin = ChunkEnd;
+  }
+  for (IndexTy I = Begin; I != End; ++I)
+    Fn(I);
+  for (std::shared_future<void> &F : Futures)
+    F.wait();
+}
+
+/// Sort [Start, End) under \p Comp.  Equal slices of the range are sorted
+/// concurrently and then merged pairwise in rounds, so the work is
+/// O(n log n) total with O(log threads) merge rounds on the critical path.
+template <class RandomIt, class Comparator>
+void sort(RandomIt Start, RandomIt End, const Comparator &Comp) {
+  size_t Size = End - Start;
+  ThreadPool &Pool = getPool();
+  size_t NumChunks = Pool.getThreadCount();
+  if (Size < detail::MinParallelSize || NumChunks <= 1) {
+    std::sort(Start, End, Comp);
+    return;
+  }
+
+  std::vector<size_t> Bounds;
+  Bounds.reserve(NumChunks + 1);
+  for (size_t I = 0; I <= NumChunks; ++I)
+    Bounds.push_back(Size * I / NumChunks);
+
+  std::vector<std::shared_future<void>> Futures;
+  for (size_t I = 0; I < NumChunks; ++I)
+    Futures.push_back(Pool.async(
+        [=] { std::sort(Start + Bounds[I], Start + Bounds[I + 1], Comp); }));
+  for (std::shared_future<void> &F : Futures)
+    F.wait();
+
+  // Merge neighbouring sorted slices; each round's merges are independent.
+  for (size_t Width = 1; Width < NumChunks; Width *= 2) {
+    Futures.clear();
+    for (size_t I = 0; I + Width < NumChunks; I += 2 * Width) {
+      size_t Last = std::min(I + 2 * Width, NumChunks);
+      Futures.push_back(Pool.async([=] {
+        std::inplace_merge(Start + Bounds[I], Start + Bounds[I + Width],
+                           Start + Bounds[Last], Comp);
+      }));
+    }
+    for (std::shared_future<void> &F : Futures)
+      F.wait();
+  }
+}
+
+template <class RandomIt> void sort(RandomIt Start, RandomIt End) {
+  parallel::sort(
+      Start, End,
+      std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+} // end namespace parallel
+} // end namespace llvm
+
+#endif
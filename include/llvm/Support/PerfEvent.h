@@ -0,0 +1,65 @@
+//===- llvm/Support/PerfEvent.h - Hardware counter access -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the llvm::sys::PerfEvent class, a thin wrapper around
+// the host's hardware performance counters.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PERFEVENT_H
+#define LLVM_SUPPORT_PERFEVENT_H
+
+#include "llvm/Support/DataTypes.h"
+#include <system_error>
+
+namespace llvm {
+namespace sys {
+
+/// \brief A handle to a single hardware performance counter, counting events
+/// for the current thread only.
+///
+/// This is currently implemented on top of perf_event_open(2) and therefore
+/// only functional on Linux; on other hosts, or when the kernel denies access
+/// to the counters, open() fails with an error code and the object stays
+/// unusable. Counting excludes time spent in the kernel.
+class PerfEvent {
+public:
+  enum EventKind {
+    /// Core clock cycles, unaffected by frequency scaling where the
+    /// hardware supports that.
+    CPUCycles,
+    /// Instructions retired.
+    InstructionsRetired
+  };
+
+  PerfEvent() : FD(-1) {}
+  ~PerfEvent();
+
+  /// \brief Open a counter for \p Kind. Counting is initially disabled.
+  std::error_code open(EventKind Kind);
+
+  /// \brief Reset the counter to zero and enable counting.
+  std::error_code start();
+
+  /// \brief Disable counting and read the accumulated count into \p Count.
+  std::error_code stop(uint64_t &Count);
+
+  bool isOpen() const { return FD != -1; }
+
+private:
+  PerfEvent(const PerfEvent &) = delete;
+  PerfEvent &operator=(const PerfEvent &) = delete;
+
+  int FD;
+};
+
+} // End sys namespace
+} // End llvm namespace
+
+#endif
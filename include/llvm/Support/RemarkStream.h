@@ -0,0 +1,97 @@
+//===- llvm/Support/RemarkStream.h - Binary remark stream -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a compact binary container for optimization remarks.
+// The stream is a sequence of LEB128-encoded records over a string table
+// that is built incrementally as the stream is written, so producers can
+// append records without any buffering and readers can consume the stream
+// in a single forward pass.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_REMARKSTREAM_H
+#define LLVM_SUPPORT_REMARKSTREAM_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+
+/// Record kinds in a remark stream. Every record starts with its kind as a
+/// ULEB128 value.
+enum RemarkStreamRecordKind {
+  /// Defines the next string table entry: ULEB128 size followed by the
+  /// bytes. Entries are numbered in order of appearance, starting at 0.
+  RS_String = 0,
+  /// One remark: pass name ID, function name ID, file name ID plus one
+  /// (zero when no debug location is available), line, column, message
+  /// size and the message bytes. All scalars are ULEB128.
+  RS_Remark = 1
+};
+
+/// A single decoded remark record. The StringRef members point into the
+/// reader's underlying buffer.
+struct RemarkRecord {
+  StringRef PassName;
+  StringRef FunctionName;
+  StringRef File; ///< Empty if no debug location was recorded.
+  unsigned Line;
+  unsigned Column;
+  StringRef Message;
+};
+
+/// Append remarks to a raw_ostream as a binary remark stream. The header
+/// is written on construction and string table entries are interned and
+/// emitted on first use, so the stream is valid after every emitRemark
+/// call and can simply be truncated by a crash without corrupting the
+/// records already written.
+class RemarkStreamWriter {
+  raw_ostream &OS;
+  StringMap<unsigned> StringIDs;
+
+public:
+  explicit RemarkStreamWriter(raw_ostream &OS);
+
+  /// Append one remark to the stream. Pass an empty \p File when no debug
+  /// location is available.
+  void emitRemark(StringRef PassName, StringRef FunctionName, StringRef File,
+                  unsigned Line, unsigned Column, StringRef Message);
+
+private:
+  unsigned getStringID(StringRef Str);
+};
+
+/// Read a stream produced by RemarkStreamWriter. The buffer must outlive
+/// the reader and any records handed out, which point into it.
+class RemarkStreamReader {
+  StringRef Buffer;
+  size_t Pos;
+  std::vector<StringRef> Strings;
+  bool Malformed;
+
+public:
+  explicit RemarkStreamReader(StringRef Buffer);
+
+  /// Read the next remark into \p R. Returns false at the end of the
+  /// stream or on a malformed record; use malformed() to tell the two
+  /// apart.
+  bool readRemark(RemarkRecord &R);
+
+  bool malformed() const { return Malformed; }
+
+private:
+  bool readULEB(uint64_t &Value);
+  bool readBytes(uint64_t Size, StringRef &Str);
+};
+
+} // end namespace llvm
+
+#endif
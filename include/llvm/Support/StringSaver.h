@@ -0,0 +1,52 @@
+//===- llvm/Support/StringSaver.h -------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_STRINGSAVER_H
+#define LLVM_SUPPORT_STRINGSAVER_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Allocator.h"
+
+namespace llvm {
+
+/// \brief Saves strings in the bump allocator it wraps and returns a stable,
+/// null-terminated copy.
+class StringSaver {
+  BumpPtrAllocator &Alloc;
+
+public:
+  StringSaver(BumpPtrAllocator &Alloc) : Alloc(Alloc) {}
+  const char *save(const char *S) { return save(StringRef(S)); }
+  const char *save(StringRef S);
+  const char *save(const Twine &S) { return save(StringRef(S.str())); }
+  const char *save(const std::string &S) { return save(StringRef(S)); }
+};
+
+/// \brief A \c StringSaver that hands out the same copy for equal strings.
+///
+/// Useful when the input is known to repeat the same strings many times
+/// (symbol names, repeated flags); the copies are uniqued at the cost of a
+/// hash lookup per save.
+class UniqueStringSaver {
+  StringMap<char, BumpPtrAllocator &> Unique;
+
+public:
+  UniqueStringSaver(BumpPtrAllocator &Alloc) : Unique(Alloc) {}
+  const char *save(const char *S) { return save(StringRef(S)); }
+  const char *save(StringRef S) {
+    // StringMap copies the key into its own allocation, null-terminated.
+    return Unique.insert(std::make_pair(S, '\0')).first->getKeyData();
+  }
+};
+
+} // end namespace llvm
+
+#endif
@@ -50,6 +50,7 @@ namespace llvm {
   class MCTargetStreamer;
   class TargetMachine;
   class TargetOptions;
+  struct TargetRegistrySnapshot;
   class raw_ostream;
   class formatted_raw_ostream;
 
@@ -77,6 +78,7 @@ namespace llvm {
   class Target {
   public:
     friend struct TargetRegistry;
+    friend struct TargetRegistrySnapshot;
 
     typedef bool (*ArchMatchFnTy)(Triple::ArchType Arch);
 
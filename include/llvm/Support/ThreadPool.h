@@ -0,0 +1,80 @@
+//===-- llvm/Support/ThreadPool.h - A ThreadPool implementation -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a crude C++11 based thread pool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_THREADPOOL_H
+#define LLVM_SUPPORT_THREADPOOL_H
+
+#include "llvm/Support/Compiler.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace llvm {
+
+/// A pool of threads executing queued tasks in FIFO order.  Tasks are plain
+/// callables returning void; submission hands back a shared future that
+/// becomes ready when the task has run.  When LLVM is built without thread
+/// support the same interface exists but tasks run inline on submission.
+///
+/// Tasks must not block on futures of other tasks queued to the same pool:
+/// the worker threads do not pick up new work while a task is waiting.
+class ThreadPool {
+public:
+  typedef std::function<void()> TaskTy;
+
+  /// Construct a pool with one thread per physical core of the host, falling
+  /// back to the logical CPU count when the physical count is unknown.
+  ThreadPool();
+
+  /// Construct a pool of \p ThreadCount threads.
+  explicit ThreadPool(unsigned ThreadCount);
+
+  /// Blocking destructor: waits for all queued and running tasks.
+  ~ThreadPool();
+
+  /// Submit a task to the pool.
+  template <typename Function, typename... Args>
+  std::shared_future<void> async(Function &&F, Args &&... ArgList) {
+    return asyncImpl(std::bind(std::forward<Function>(F),
+                               std::forward<Args>(ArgList)...));
+  }
+
+  /// Blocking wait for all queued tasks to complete and all threads to go
+  /// idle.  Other threads may still submit tasks concurrently; those are not
+  /// waited for.
+  void wait();
+
+  unsigned getThreadCount() const { return ThreadCount; }
+
+private:
+  std::shared_future<void> asyncImpl(TaskTy F);
+
+  const unsigned ThreadCount;
+  std::deque<std::packaged_task<void()>> Tasks;
+  std::mutex QueueLock;
+  std::condition_variable QueueCondition;
+  std::condition_variable CompletionCondition;
+  unsigned ActiveThreads;
+  bool EnableFlag;
+  // The workers reference the members above, so they are created (and
+  // declared) last and joined in the destructor before anything else dies.
+  std::vector<std::thread> Threads;
+};
+
+} // end namespace llvm
+
+#endif
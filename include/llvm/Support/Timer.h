@@ -78,7 +78,8 @@ public:
 /// if they are never started.
 ///
 class Timer {
-  TimeRecord Time;
+  TimeRecord Time;       // Aggregated time; folded in from the per-thread
+                         // accumulators when a report is produced.
   std::string Name;      // The name of this time variable.
   bool Started;          // Has this time variable ever been started?
   TimerGroup *TG;        // The TimerGroup this Timer is in.
@@ -106,7 +107,10 @@ public:
   
   /// startTimer - Start the timer running.  Time between calls to
   /// startTimer/stopTimer is counted by the Timer class.  Note that these calls
-  /// must be correctly paired.
+  /// must be correctly paired on each thread.  The elapsed time is accumulated
+  /// per thread, so a timer may be running on several threads at once without
+  /// any serialization between them; the contributions are summed when the
+  /// report is produced.
   ///
   void startTimer();
 
@@ -119,6 +123,28 @@ private:
 };
 
 
+/// FineTimer - A minimal wall-clock timer with nanosecond resolution, for
+/// phases too short for Timer's getrusage-based clock to resolve.  A FineTimer
+/// belongs to the thread using it: startTimer/stopTimer read only the
+/// monotonic clock and touch no shared state, so instances can be used freely
+/// from parallel pipelines and summed into a report once the work is done.
+///
+class FineTimer {
+  uint64_t TotalNanos;   // Accumulated time, in nanoseconds.
+  uint64_t StartNanos;   // Clock value at the last startTimer.
+public:
+  FineTimer() : TotalNanos(0), StartNanos(0) {}
+
+  /// startTimer/stopTimer - Accumulate the wall time between each pair of
+  /// calls.  Calls must be correctly paired.
+  void startTimer();
+  void stopTimer();
+
+  uint64_t getTotalNanos() const { return TotalNanos; }
+  double getTotalSeconds() const { return TotalNanos * 1e-9; }
+};
+
+
 /// The TimeRegion class is used as a helper class to call the startTimer() and
 /// stopTimer() methods of the Timer class.  When the object is constructed, it
 /// starts the timer specified as its argument.  When it is destroyed, it stops
@@ -174,15 +200,28 @@ public:
 
   /// print - Print any started timers in this group and zero them.
   void print(raw_ostream &OS);
-  
+
   /// printAll - This static method prints all timers and clears them all out.
   static void printAll(raw_ostream &OS);
-  
+
+  /// printJSON - Print any started timers in this group as one JSON object
+  /// per line of the form
+  ///   {"group": <name>, "timers": {<name>: {"wall": <sec>, ...}, ...}}
+  /// and zero them.  Emitting a complete object per report keeps appended
+  /// output from multiple compilations easy to parse.  This is also what the
+  /// normal report paths produce when -info-output-json is given.
+  void printJSON(raw_ostream &OS);
+
+  /// printAllJSON - This static method prints all timers as JSON and clears
+  /// them all out.
+  static void printAllJSON(raw_ostream &OS);
+
 private:
   friend class Timer;
   void addTimer(Timer &T);
   void removeTimer(Timer &T);
   void PrintQueuedTimers(raw_ostream &OS);
+  void PrintQueuedTimersJSON(raw_ostream &OS);
 };
 
 } // End llvm namespace
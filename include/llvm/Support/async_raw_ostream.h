@@ -0,0 +1,70 @@
+//===- async_raw_ostream.h - Asynchronously drained stream ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains raw_ostream implementations for streams whose writes are
+// drained by a background thread, overlapping I/O with computation.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_ASYNC_RAW_OSTREAM_H
+#define LLVM_SUPPORT_ASYNC_RAW_OSTREAM_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace llvm {
+
+/// async_raw_ostream - A raw_ostream that hands filled buffers to a background
+/// writer thread, so that a producer emitting large sequential output (such as
+/// AsmPrinter) is not stalled by slow file systems. Writes are double
+/// buffered: the producer appends to one buffer while the writer thread
+/// drains the other into the underlying stream.
+///
+/// The wrapped stream must not be written by anyone else while this stream is
+/// attached, and must outlive it. The stream is strictly sequential. The
+/// writer thread is started by the constructor; processes that fork() while
+/// an async_raw_ostream is live must call drain() first so that no buffer or
+/// lock state is duplicated into the child.
+class async_raw_ostream : public raw_ostream {
+  raw_ostream &OS;
+
+  std::mutex Mtx;
+  std::condition_variable WorkAvailable;
+  std::condition_variable Drained;
+  std::thread Writer;
+
+  /// Buffer the producer is appending to; swapped wholesale into the writer
+  /// thread under the lock.
+  SmallVector<char, 0> Pending;
+  bool Done;
+  bool WriterBusy;
+
+  /// Bytes accepted from the producer so far.
+  uint64_t Pos;
+
+  void write_impl(const char *Ptr, size_t Size) override;
+  uint64_t current_pos() const override { return Pos; }
+
+  void writerLoop();
+
+public:
+  explicit async_raw_ostream(raw_ostream &OS);
+  ~async_raw_ostream() override;
+
+  /// Block until every byte written so far has reached the underlying stream
+  /// and the writer thread is idle.
+  void drain();
+};
+
+} // end namespace llvm
+
+#endif
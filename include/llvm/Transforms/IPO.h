@@ -24,6 +24,7 @@ class Pass;
 class Function;
 class BasicBlock;
 class GlobalValue;
+class StringRef;
 
 //===----------------------------------------------------------------------===//
 //
@@ -58,6 +59,13 @@ ModulePass *createStripDeadDebugInfoPass();
 ///
 ModulePass *createConstantMergePass();
 
+//===----------------------------------------------------------------------===//
+/// createIndirectCallPromotionPass - This pass promotes indirect call sites
+/// with profiled dominant targets (recorded in !indirect.call.targets
+/// metadata) to guarded direct calls so the inliner can see through them.
+///
+ModulePass *createIndirectCallPromotionPass();
+
 //===----------------------------------------------------------------------===//
 /// createGlobalOptimizerPass - This function returns a new pass that optimizes
 /// non-address taken internal globals.
@@ -70,6 +78,13 @@ ModulePass *createGlobalOptimizerPass();
 ///
 ModulePass *createGlobalDCEPass();
 
+//===----------------------------------------------------------------------===//
+/// createHotColdSplittingPass - This pass outlines cold regions of functions
+/// into separate functions marked cold and minsize, shrinking the hot paths'
+/// instruction cache footprint.
+///
+ModulePass *createHotColdSplittingPass();
+
 //===----------------------------------------------------------------------===//
 /// createGVExtractionPass - If deleteFn is true, this pass deletes
 /// the specified global values. Otherwise, it deletes as much of the module as
@@ -185,6 +200,20 @@ Pass *createFunctionAttrsPass();
 ModulePass *createMergeFunctionsPass();
 
 //===----------------------------------------------------------------------===//
+/// createParallelFunctionPassesPass - Run a comma-separated pipeline of
+/// function passes over partitions of the module on NumThreads worker
+/// threads, relinking the optimized partitions afterwards.
+ModulePass *createParallelFunctionPassesPass(StringRef Pipeline,
+                                             unsigned NumThreads);
+
+//===----------------------------------------------------------------------===//
+/// createParallelIPOPassesPass - Run a comma-separated pipeline of module
+/// passes over weight-balanced partitions of the module on NumThreads worker
+/// threads, then relink the partitions and run GlobalDCE and ConstantMerge to
+/// reconcile across them.
+ModulePass *createParallelIPOPassesPass(StringRef Pipeline,
+                                        unsigned NumThreads);
+
 /// createPartialInliningPass - This pass inlines parts of functions.
 ///
 ModulePass *createPartialInliningPass();
@@ -42,6 +42,10 @@ struct Inliner : public CallGraphSCCPass {
   // Pass class.
   bool runOnSCC(CallGraphSCC &SCC) override;
 
+  using llvm::Pass::doInitialization;
+  // doInitialization - Reset the module's inlining growth accounting.
+  bool doInitialization(CallGraph &CG) override;
+
   using llvm::Pass::doFinalization;
   // doFinalization - Remove now-dead linkonce functions at the end of
   // processing to avoid breaking the SCC traversal.
@@ -81,6 +85,10 @@ private:
   // InsertLifetime - Insert @llvm.lifetime intrinsics.
   bool InsertLifetime;
 
+  // GrowthSoFar - Estimated instructions this pass has added to the module by
+  // inlining; used to decay thresholds against -inline-size-budget.
+  uint64_t GrowthSoFar;
+
   /// shouldInline - Return true if the inliner should attempt to
   /// inline at the given CallSite.
   bool shouldInline(CallSite CS);
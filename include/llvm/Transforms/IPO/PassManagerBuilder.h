@@ -18,6 +18,8 @@
 #include <vector>
 
 namespace llvm {
+class CompileDeadline;
+class Module;
 class Pass;
 class TargetLibraryInfoImpl;
 class TargetMachine;
@@ -109,6 +111,14 @@ public:
   /// added to the per-module passes.
   Pass *Inliner;
 
+  /// Deadline - If this is non-null, the expensive passes added by the
+  /// populate methods (GVN and the vectorizers) are registered as deferrable
+  /// on it.  A latency-sensitive client (typically a JIT) installs the same
+  /// object on its LLVMContext with setCompileDeadline and arms it before
+  /// each compile request; once the budget is spent the pass managers run
+  /// only the cheap remainder of the pipeline.  Not owned by the builder.
+  CompileDeadline *Deadline;
+
   bool DisableTailCalls;
   bool DisableUnitAtATime;
   bool DisableUnrollLoops;
@@ -141,8 +151,17 @@ private:
                          legacy::PassManagerBase &PM) const;
   void addInitialAliasAnalysisPasses(legacy::PassManagerBase &PM) const;
   void addLTOOptimizationPasses(legacy::PassManagerBase &PM);
+  Pass *deferrable(Pass *P) const;
 
 public:
+  /// applyPipelineTuning - Apply the knob overrides for \p M's category from
+  /// the file named by -pipeline-tuning-file, if any. The file assigns
+  /// modules to categories by cheap shape features (function count, average
+  /// block count) and lists threshold and pass toggles per category; the
+  /// values are typically derived offline from aggregated per-pass timer
+  /// reports. Must be called before the populate methods.
+  void applyPipelineTuning(const Module &M);
+
   /// populateFunctionPassManager - This fills in the function pass manager,
   /// which is expected to be run on each function immediately as it is
   /// generated.  The idea is to reduce the size of the IR in memory.
@@ -12,6 +12,7 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Constant.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
@@ -27,6 +28,10 @@ class InstCombineWorklist {
   SmallVector<Instruction*, 256> Worklist;
   DenseMap<Instruction*, unsigned> WorklistMap;
 
+  /// How far below the top of the stack RemoveOne looks for an entry in the
+  /// preferred block.  Small enough that the scan stays in cache.
+  enum { ScanWindow = 16 };
+
   void operator=(const InstCombineWorklist&RHS) = delete;
   InstCombineWorklist(const InstCombineWorklist&) = delete;
 public:
@@ -83,7 +88,42 @@ public:
     WorklistMap.erase(It);
   }
 
-  Instruction *RemoveOne() {
+  /// RemoveOne - Pop the next instruction to visit.  If \p PreferBB is given,
+  /// scan a small window below the top of the stack for an entry in that
+  /// block and visit it first, preferring entries that are immediately
+  /// constant-foldable.  Draining one block at a time keeps the combiner from
+  /// ping-ponging across the function and revisiting cold lines.
+  Instruction *RemoveOne(const BasicBlock *PreferBB = nullptr) {
+    if (PreferBB && Worklist.size() > 1) {
+      unsigned Top = Worklist.size() - 1;
+      unsigned Limit = Worklist.size() <= ScanWindow ? 0 : Top - ScanWindow;
+      unsigned Best = Top;
+      bool FoundLocal = false;
+      for (unsigned Idx = Top; ; --Idx) {
+        Instruction *Cand = Worklist[Idx];
+        if (Cand && Cand->getParent() == PreferBB) {
+          if (!FoundLocal) {
+            Best = Idx;
+            FoundLocal = true;
+          }
+          // A constant first operand means a cheap, always-profitable fold;
+          // take it over any other block-local entry.
+          if (Cand->getNumOperands() &&
+              isa<Constant>(Cand->getOperand(0))) {
+            Best = Idx;
+            break;
+          }
+        }
+        if (Idx == Limit)
+          break;
+      }
+      if (FoundLocal && Best != Top) {
+        std::swap(Worklist[Best], Worklist[Top]);
+        // The old top-of-stack entry moved down; keep its map index current.
+        if (Instruction *Moved = Worklist[Best])
+          WorklistMap[Moved] = Best;
+      }
+    }
     Instruction *I = Worklist.pop_back_val();
     WorklistMap.erase(I);
     return I;
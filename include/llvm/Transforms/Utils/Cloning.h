@@ -23,11 +23,13 @@
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/IR/ValueMap.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
+#include <functional>
 
 namespace llvm {
 
 class Module;
 class Function;
+class GlobalValue;
 class Instruction;
 class Pass;
 class LPPassManager;
@@ -51,6 +53,23 @@ class AssumptionCacheTracker;
 Module *CloneModule(const Module *M);
 Module *CloneModule(const Module *M, ValueToValueMapTy &VMap);
 
+/// Return a copy of the specified module. The ShouldCloneDefinition function
+/// controls whether a specific GlobalValue's definition is cloned. If the
+/// function returns false, the module copy will contain an external reference
+/// in place of the global definition.
+Module *
+CloneModule(const Module *M, ValueToValueMapTy &VMap,
+            std::function<bool(const GlobalValue *)> ShouldCloneDefinition);
+
+/// Return a copy of \p M that shares \p M's storage for function bodies until
+/// they are first needed. Functions start out as materializable declarations
+/// backed by a GVMaterializer that copies the body out of \p M on the first
+/// Module::materialize (or materializeAll) touching them; global variable
+/// initializers, aliases and named metadata are cloned eagerly since they are
+/// small compared to function bodies. \p M must outlive the returned module
+/// and must not be mutated while lazy clones of it are alive.
+Module *CloneModuleLazily(const Module *M);
+
 /// ClonedCodeInfo - This struct can be used to capture information about code
 /// being cloned, while it is being cloned.
 struct ClonedCodeInfo {
@@ -14,10 +14,12 @@
 #ifndef LLVM_TRANSFORMS_UTILS_SSAUPDATER_H
 #define LLVM_TRANSFORMS_UTILS_SSAUPDATER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Compiler.h"
 
 namespace llvm {
+  class AllocaInst;
   class BasicBlock;
   class Instruction;
   class LoadInst;
@@ -172,6 +174,18 @@ public:
   }
 };
 
+/// \brief Promote a batch of allocas into SSA form with a shared SSAUpdater.
+///
+/// Each alloca in \p Allocas must be used only by direct (non-volatile) loads
+/// and stores. Unlike PromoteMemToReg this requires no dominator tree, so
+/// clients that repeatedly splice small amounts of code into a function (JITs,
+/// for example) can promote just the allocas the splice introduced instead of
+/// re-running mem2reg over the whole function. The updater's bookkeeping is
+/// reused across the batch, and any PHI nodes created are reported through the
+/// vector \p SSA was constructed with. The allocas are deleted.
+void promoteAllocasWithSSAUpdater(ArrayRef<AllocaInst *> Allocas,
+                                  SSAUpdater &SSA);
+
 } // End llvm namespace
 
 #endif
@@ -0,0 +1,235 @@
+//===- AAQueryProfiler.cpp - Sampling alias analysis query profiler -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a decorator alias analysis that attributes query
+// counts and sampled latencies to the (caller pass, query kind) pair.  It is
+// modeled on AliasAnalysisCounter, but is designed to be cheap enough to
+// leave enabled on production builds: counters live in a fixed-size
+// open-addressed table of relaxed atomics, so no query ever takes a lock,
+// and latency is only measured for one query in every -aa-profile-interval.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/Passes.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+#include <vector>
+using namespace llvm;
+
+static cl::opt<unsigned> SampleInterval(
+    "aa-profile-interval", cl::ReallyHidden, cl::init(64),
+    cl::desc("Measure the latency of one alias query in every N"));
+
+namespace {
+
+/// The query kinds the profiler distinguishes.
+enum QueryKind {
+  QK_Alias,
+  QK_ModRef,
+  QK_PointsToConstMem,
+  QK_NumKinds
+};
+
+static const char *const QueryKindNames[QK_NumKinds] = {
+    "alias", "getModRefInfo", "pointsToConstantMemory"};
+
+/// One row of the profile table: the counters for a single attributed pass.
+/// The key is the pass's name string, which is a string literal and so
+/// outlives both the pass object and the profiler.
+struct ProfileSlot {
+  std::atomic<const char *> PassName;
+  std::atomic<uint64_t> Count[QK_NumKinds];
+  std::atomic<uint64_t> SampledNanos[QK_NumKinds];
+  std::atomic<uint64_t> Samples[QK_NumKinds];
+};
+
+// Slots are claimed with a compare-and-swap on PassName and never released,
+// so the table must comfortably exceed the number of distinct passes that
+// issue alias queries in a pipeline.
+static const unsigned NumProfileSlots = 256;
+
+// Per-thread query tick used to pick which queries get timed.  A plain
+// counter (rather than a shared atomic) keeps the common path to a single
+// thread-local increment.
+static LLVM_THREAD_LOCAL unsigned QueryTick = 0;
+
+class AAQueryProfiler : public ModulePass, public AliasAnalysis {
+  ProfileSlot Slots[NumProfileSlots];
+
+  /// Return the slot for the currently executing pass, claiming one on
+  /// first use.  Lock-free: a lost race on the claiming CAS just retries at
+  /// the next probe position.
+  ProfileSlot *getSlot() {
+    const Pass *P = getExecutingPass();
+    const char *Name = P ? P->getPassName() : "<no pass>";
+    unsigned Idx = (unsigned)((uintptr_t)Name >> 4) % NumProfileSlots;
+    for (unsigned Probe = 0; Probe != NumProfileSlots; ++Probe) {
+      ProfileSlot &S = Slots[(Idx + Probe) % NumProfileSlots];
+      const char *Cur = S.PassName.load(std::memory_order_acquire);
+      if (Cur == Name)
+        return &S;
+      if (!Cur) {
+        const char *Expected = nullptr;
+        if (S.PassName.compare_exchange_strong(Expected, Name,
+                                               std::memory_order_acq_rel))
+          return &S;
+        if (Expected == Name)
+          return &S;
+      }
+    }
+    return nullptr; // Table full; drop the sample.
+  }
+
+  /// Run one underlying query, bumping the count for (executing pass, Kind)
+  /// and timing it if this query falls on the sampling interval.
+  template <typename FnTy>
+  typename std::result_of<FnTy()>::type profiled(QueryKind Kind, FnTy Fn) {
+    ProfileSlot *S = getSlot();
+    if (!S)
+      return Fn();
+    S->Count[Kind].fetch_add(1, std::memory_order_relaxed);
+    if (++QueryTick % SampleInterval != 0)
+      return Fn();
+
+    auto Start = std::chrono::steady_clock::now();
+    auto Result = Fn();
+    auto End = std::chrono::steady_clock::now();
+    uint64_t Nanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start)
+            .count();
+    S->SampledNanos[Kind].fetch_add(Nanos, std::memory_order_relaxed);
+    S->Samples[Kind].fetch_add(1, std::memory_order_relaxed);
+    return Result;
+  }
+
+  void printReport() const;
+
+public:
+  static char ID; // Class identification, replacement for typeinfo
+  AAQueryProfiler() : ModulePass(ID) {
+    initializeAAQueryProfilerPass(*PassRegistry::getPassRegistry());
+    for (unsigned i = 0; i != NumProfileSlots; ++i) {
+      Slots[i].PassName = nullptr;
+      for (unsigned k = 0; k != QK_NumKinds; ++k) {
+        Slots[i].Count[k] = 0;
+        Slots[i].SampledNanos[k] = 0;
+        Slots[i].Samples[k] = 0;
+      }
+    }
+  }
+
+  ~AAQueryProfiler() override { printReport(); }
+
+  bool runOnModule(Module &M) override {
+    InitializeAliasAnalysis(this);
+    return false;
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AliasAnalysis::getAnalysisUsage(AU);
+    AU.addRequired<AliasAnalysis>();
+    AU.setPreservesAll();
+  }
+
+  /// getAdjustedAnalysisPointer - This method is used when a pass implements
+  /// an analysis interface through multiple inheritance.  If needed, it
+  /// should override this to adjust the this pointer as needed for the
+  /// specified pass info.
+  void *getAdjustedAnalysisPointer(AnalysisID PI) override {
+    if (PI == &AliasAnalysis::ID)
+      return (AliasAnalysis *)this;
+    return this;
+  }
+
+  AliasResult alias(const Location &LocA, const Location &LocB) override {
+    return profiled(QK_Alias, [&] {
+      return getAnalysis<AliasAnalysis>().alias(LocA, LocB);
+    });
+  }
+
+  ModRefResult getModRefInfo(ImmutableCallSite CS,
+                             const Location &Loc) override {
+    return profiled(QK_ModRef, [&] {
+      return getAnalysis<AliasAnalysis>().getModRefInfo(CS, Loc);
+    });
+  }
+
+  ModRefResult getModRefInfo(ImmutableCallSite CS1,
+                             ImmutableCallSite CS2) override {
+    return AliasAnalysis::getModRefInfo(CS1, CS2);
+  }
+
+  bool pointsToConstantMemory(const Location &Loc, bool OrLocal) override {
+    return profiled(QK_PointsToConstMem, [&] {
+      return getAnalysis<AliasAnalysis>().pointsToConstantMemory(Loc, OrLocal);
+    });
+  }
+};
+
+} // End anonymous namespace
+
+void AAQueryProfiler::printReport() const {
+  // Gather the used slots; the table is only written with relaxed atomics,
+  // but by destruction time all querying threads have joined.
+  struct Row {
+    const char *PassName;
+    const ProfileSlot *Slot;
+    uint64_t Total;
+  };
+  std::vector<Row> Rows;
+  for (unsigned i = 0; i != NumProfileSlots; ++i) {
+    const char *Name = Slots[i].PassName.load(std::memory_order_relaxed);
+    if (!Name)
+      continue;
+    uint64_t Total = 0;
+    for (unsigned k = 0; k != QK_NumKinds; ++k)
+      Total += Slots[i].Count[k].load(std::memory_order_relaxed);
+    if (Total)
+      Rows.push_back(Row{Name, &Slots[i], Total});
+  }
+  if (Rows.empty())
+    return;
+  std::sort(Rows.begin(), Rows.end(),
+            [](const Row &A, const Row &B) { return A.Total > B.Total; });
+
+  errs() << "\n===== Alias Analysis Query Profile =====\n";
+  for (unsigned i = 0, e = Rows.size(); i != e; ++i) {
+    errs() << Rows[i].PassName << ": " << Rows[i].Total << " queries\n";
+    for (unsigned k = 0; k != QK_NumKinds; ++k) {
+      uint64_t Count = Rows[i].Slot->Count[k].load(std::memory_order_relaxed);
+      if (!Count)
+        continue;
+      uint64_t Samples =
+          Rows[i].Slot->Samples[k].load(std::memory_order_relaxed);
+      uint64_t Nanos =
+          Rows[i].Slot->SampledNanos[k].load(std::memory_order_relaxed);
+      errs() << "  " << format("%-24s", QueryKindNames[k]) << " " << Count;
+      if (Samples)
+        errs() << "  (~" << Nanos / Samples << " ns/query, " << Samples
+               << " sampled)";
+      errs() << "\n";
+    }
+  }
+}
+
+char AAQueryProfiler::ID = 0;
+INITIALIZE_AG_PASS(AAQueryProfiler, AliasAnalysis, "profile-aa",
+                   "Profile Alias Analysis Queries Per Pass", false, true,
+                   false)
+
+ModulePass *llvm::createAAQueryProfilerPass() { return new AAQueryProfiler(); }
@@ -0,0 +1,35 @@
+//===- CFGSummary.cpp - Cached per-function body summaries ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the lazily rebuilt per-function summaries of call-site
+// positions used to avoid rescanning whole function bodies.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/CFGSummary.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Function.h"
+
+using namespace llvm;
+
+ArrayRef<Instruction *> CFGSummaryCache::getCallSites(Function &F) {
+  // A freshly inserted entry has generation zero, which only ever matches a
+  // function with no blocks at all, for which the empty summary is correct.
+  FunctionSummary &Summary = Summaries[&F];
+  if (Summary.Generation == F.getInstructionGeneration())
+    return Summary.CallSites;
+
+  Summary.Generation = F.getInstructionGeneration();
+  Summary.CallSites.clear();
+  for (BasicBlock &BB : F)
+    for (Instruction &I : BB)
+      if (CallSite(&I))
+        Summary.CallSites.push_back(&I);
+  return Summary.CallSites;
+}
@@ -31,6 +31,7 @@
 #include "StratifiedSets.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Analysis/AliasAnalysis.h"
@@ -54,6 +55,9 @@ using namespace llvm;
 
 #define DEBUG_TYPE "cfl-aa"
 
+STATISTIC(NumSummaryQueries, "Number of queries answered from the summary");
+STATISTIC(NumDelegatedQueries, "Number of queries delegated down the chain");
+
 // Try to go from a Value* to a Function*. Never returns nullptr.
 static Optional<Function *> parentFunctionOfValue(Value *);
 
@@ -234,9 +238,12 @@ public:
     }
 
     AliasResult QueryResult = query(LocA, LocB);
-    if (QueryResult == MayAlias)
+    if (QueryResult == MayAlias) {
+      ++NumDelegatedQueries;
       return AliasAnalysis::alias(LocA, LocB);
+    }
 
+    ++NumSummaryQueries;
     return QueryResult;
   }
 
@@ -1757,10 +1757,141 @@ static Constant *ConstantFoldScalarCall(StringRef Name, unsigned IntrinsicID,
   return nullptr;
 }
 
+typedef double (*HostFPUnaryOp)(double);
+
+/// Return the host libm function the scalar folder would evaluate this call
+/// with, if it maps to a single unconditional unary function; null otherwise.
+/// Callees with per-lane special cases in the scalar folder (sqrt's negative
+/// input handling, exp2's pow(2, x) expansion) are excluded so the fast path
+/// below cannot diverge from it.
+static HostFPUnaryOp getHostUnaryFPFn(unsigned IntrinsicID, StringRef Name,
+                                      const TargetLibraryInfo *TLI) {
+  switch (IntrinsicID) {
+  default: break;
+  case Intrinsic::fabs:  return fabs;
+  case Intrinsic::floor: return floor;
+  case Intrinsic::ceil:  return ceil;
+#if HAVE_LOG2
+  case Intrinsic::log2:  return log2;
+#endif
+#if HAVE_LOG
+  case Intrinsic::log:   return log;
+#endif
+#if HAVE_LOG10
+  case Intrinsic::log10: return log10;
+#endif
+#if HAVE_EXP
+  case Intrinsic::exp:   return exp;
+#endif
+#if HAVE_EXP2
+  case Intrinsic::exp2:  return exp2;
+#endif
+  }
+
+  if (!TLI)
+    return nullptr;
+
+  if (Name == "acos" && TLI->has(LibFunc::acos))
+    return acos;
+  if (Name == "asin" && TLI->has(LibFunc::asin))
+    return asin;
+  if (Name == "atan" && TLI->has(LibFunc::atan))
+    return atan;
+  if (Name == "ceil" && TLI->has(LibFunc::ceil))
+    return ceil;
+  if (Name == "cos" && TLI->has(LibFunc::cos))
+    return cos;
+  if (Name == "cosf" && TLI->has(LibFunc::cosf))
+    return cos;
+  if (Name == "cosh" && TLI->has(LibFunc::cosh))
+    return cosh;
+  if (Name == "exp" && TLI->has(LibFunc::exp))
+    return exp;
+  if (Name == "fabs" && TLI->has(LibFunc::fabs))
+    return fabs;
+  if (Name == "floor" && TLI->has(LibFunc::floor))
+    return floor;
+  if (Name == "sin" && TLI->has(LibFunc::sin))
+    return sin;
+  if (Name == "sinf" && TLI->has(LibFunc::sinf))
+    return sin;
+  if (Name == "sinh" && TLI->has(LibFunc::sinh))
+    return sinh;
+  if (Name == "tan" && TLI->has(LibFunc::tan))
+    return tan;
+  if (Name == "tanh" && TLI->has(LibFunc::tanh))
+    return tanh;
+  return nullptr;
+}
+
+/// Fold a call over an f32/f64 ConstantDataVector directly on host floats.
+/// The generic lane loop below rebuilds a uniqued ConstantFP and re-runs the
+/// callee dispatch for every lane; on the enormous constant vectors that
+/// machine-generated code contains, that bookkeeping is most of the folding
+/// time. The arithmetic here is exactly what the scalar folder does for
+/// these callees — evaluate in double, re-round floats, fail the whole fold
+/// on a NaN/infinity lane or a raised FP exception — and is verified against
+/// it lane by lane in assertion builds.
+static Constant *ConstantFoldVectorCallFast(unsigned IntrinsicID,
+                                            StringRef Name, VectorType *VTy,
+                                            ConstantDataVector *Op,
+                                            const TargetLibraryInfo *TLI) {
+  Type *Ty = VTy->getElementType();
+  HostFPUnaryOp NativeFP = getHostUnaryFPFn(IntrinsicID, Name, TLI);
+  if (!NativeFP)
+    return nullptr;
+
+  unsigned NumElts = VTy->getNumElements();
+  bool IsFloat = Ty->isFloatTy();
+  SmallVector<float, 16> FloatResult(IsFloat ? NumElts : 0);
+  SmallVector<double, 16> DoubleResult(IsFloat ? 0 : NumElts);
+
+  llvm_fenv_clearexcept();
+  for (unsigned I = 0; I != NumElts; ++I) {
+    double V =
+        IsFloat ? (double)Op->getElementAsFloat(I) : Op->getElementAsDouble(I);
+    // Only fold finite lanes; see the scalar folder.
+    if (std::isnan(V) || std::isinf(V)) {
+      llvm_fenv_clearexcept();
+      return nullptr;
+    }
+    double W = NativeFP(V);
+    if (IsFloat)
+      FloatResult[I] = (float)W;
+    else
+      DoubleResult[I] = W;
+  }
+  if (llvm_fenv_testexcept()) {
+    llvm_fenv_clearexcept();
+    return nullptr;
+  }
+
+#ifndef NDEBUG
+  for (unsigned I = 0; I != NumElts; ++I) {
+    Constant *Lane = Op->getElementAsConstant(I);
+    Constant *Ref = ConstantFoldScalarCall(Name, IntrinsicID, Ty, Lane, TLI);
+    APFloat Folded = IsFloat ? APFloat(FloatResult[I]) : APFloat(DoubleResult[I]);
+    assert(Ref && cast<ConstantFP>(Ref)->getValueAPF().bitwiseIsEqual(Folded) &&
+           "Host fold diverged from the scalar constant folder");
+  }
+#endif
+
+  if (IsFloat)
+    return ConstantDataVector::get(VTy->getContext(), FloatResult);
+  return ConstantDataVector::get(VTy->getContext(), DoubleResult);
+}
+
 static Constant *ConstantFoldVectorCall(StringRef Name, unsigned IntrinsicID,
                                         VectorType *VTy,
                                         ArrayRef<Constant *> Operands,
                                         const TargetLibraryInfo *TLI) {
+  Type *EltTy = VTy->getElementType();
+  if (Operands.size() == 1 && (EltTy->isFloatTy() || EltTy->isDoubleTy()))
+    if (ConstantDataVector *CDV = dyn_cast<ConstantDataVector>(Operands[0]))
+      if (Constant *C = ConstantFoldVectorCallFast(IntrinsicID, Name, VTy,
+                                                   CDV, TLI))
+        return C;
+
   SmallVector<Constant *, 4> Result(VTy->getNumElements());
   SmallVector<Constant *, 4> Lane(Operands.size());
   Type *Ty = VTy->getElementType();
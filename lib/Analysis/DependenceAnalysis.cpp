@@ -73,6 +73,7 @@ using namespace llvm;
 // statistics
 
 STATISTIC(TotalArrayPairs, "Array pairs tested");
+STATISTIC(CachedQueries, "Dependence queries answered from the cache");
 STATISTIC(SeparableSubscriptPairs, "Separable subscript pairs");
 STATISTIC(CoupledSubscriptPairs, "Coupled subscript pairs");
 STATISTIC(NonlinearSubscriptPairs, "Nonlinear subscript pairs");
@@ -104,11 +105,18 @@ STATISTIC(GCDindependence, "GCD independence");
 STATISTIC(BanerjeeApplications, "Banerjee applications");
 STATISTIC(BanerjeeIndependence, "Banerjee independence");
 STATISTIC(BanerjeeSuccesses, "Banerjee successes");
+STATISTIC(BanerjeeBudgetExhausted, "Banerjee direction searches cut short");
 
 static cl::opt<bool>
 Delinearize("da-delinearize", cl::init(false), cl::Hidden, cl::ZeroOrMore,
             cl::desc("Try to delinearize array references."));
 
+static cl::opt<unsigned> BanerjeeBudget(
+    "da-banerjee-budget", cl::init(4096), cl::Hidden, cl::ZeroOrMore,
+    cl::desc("Maximum number of direction vectors explored per Banerjee MIV "
+             "test; the search is 3^levels and degrades to all directions "
+             "when the budget runs out."));
+
 //===----------------------------------------------------------------------===//
 // basics
 
@@ -133,11 +141,13 @@ bool DependenceAnalysis::runOnFunction(Function &F) {
   AA = &getAnalysis<AliasAnalysis>();
   SE = &getAnalysis<ScalarEvolution>();
   LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  DependsCache.clear();
   return false;
 }
 
 
 void DependenceAnalysis::releaseMemory() {
+  DependsCache.clear();
 }
 
 
@@ -2491,8 +2501,9 @@ bool DependenceAnalysis::banerjeeMIVtest(const SCEV *Src,
   if (testBounds(Dependence::DVEntry::ALL, 0, Bound, Delta)) {
     // Explore the direction vector hierarchy.
     unsigned DepthExpanded = 0;
+    unsigned Budget = BanerjeeBudget;
     unsigned NewDeps = exploreDirections(1, A, B, Bound,
-                                         Loops, DepthExpanded, Delta);
+                                         Loops, DepthExpanded, Delta, Budget);
     if (NewDeps > 0) {
       bool Improved = false;
       for (unsigned K = 1; K <= CommonLevels; ++K) {
@@ -2537,7 +2548,23 @@ unsigned DependenceAnalysis::exploreDirections(unsigned Level,
                                                BoundInfo *Bound,
                                                const SmallBitVector &Loops,
                                                unsigned &DepthExpanded,
-                                               const SCEV *Delta) const {
+                                               const SCEV *Delta,
+                                               unsigned &Budget) const {
+  // The search visits up to 3^CommonLevels nodes, which is unbounded for
+  // deeply nested loops. When the budget runs out, stop refining and record
+  // the levels we haven't fully explored as dependent in every direction.
+  // That's always safe; we only lose precision.
+  if (Budget == 0) {
+    ++BanerjeeBudgetExhausted;
+    DEBUG(dbgs() << "\tBanerjee budget exhausted, assuming all directions\n");
+    for (unsigned K = 1; K <= CommonLevels; ++K)
+      if (Loops[K])
+        Bound[K].DirSet |=
+            K < Level ? Bound[K].Direction : Dependence::DVEntry::ALL;
+    return 1;
+  }
+  --Budget;
+
   if (Level > CommonLevels) {
     // record result
     DEBUG(dbgs() << "\t[");
@@ -2611,23 +2638,24 @@ unsigned DependenceAnalysis::exploreDirections(unsigned Level,
     // test bounds for <, *, *, ...
     if (testBounds(Dependence::DVEntry::LT, Level, Bound, Delta))
       NewDeps += exploreDirections(Level + 1, A, B, Bound,
-                                   Loops, DepthExpanded, Delta);
+                                   Loops, DepthExpanded, Delta, Budget);
 
     // Test bounds for =, *, *, ...
     if (testBounds(Dependence::DVEntry::EQ, Level, Bound, Delta))
       NewDeps += exploreDirections(Level + 1, A, B, Bound,
-                                   Loops, DepthExpanded, Delta);
+                                   Loops, DepthExpanded, Delta, Budget);
 
     // test bounds for >, *, *, ...
     if (testBounds(Dependence::DVEntry::GT, Level, Bound, Delta))
       NewDeps += exploreDirections(Level + 1, A, B, Bound,
-                                   Loops, DepthExpanded, Delta);
+                                   Loops, DepthExpanded, Delta, Budget);
 
     Bound[Level].Direction = Dependence::DVEntry::ALL;
     return NewDeps;
   }
   else
-    return exploreDirections(Level + 1, A, B, Bound, Loops, DepthExpanded, Delta);
+    return exploreDirections(Level + 1, A, B, Bound, Loops, DepthExpanded,
+                             Delta, Budget);
 }
 
 
@@ -3300,6 +3328,35 @@ DependenceAnalysis::depends(Instruction *Src, Instruction *Dst,
   if (Src == Dst)
     PossiblyLoopIndependent = false;
 
+  // Answer repeated queries from the cache when the outcome was one we can
+  // reconstitute without having stored a Dependence object.
+  auto Key = std::make_pair(Src, Dst);
+  switch (DependsCache[Key].Outcome[PossiblyLoopIndependent]) {
+  case OutcomeIndependent:
+    ++CachedQueries;
+    return nullptr;
+  case OutcomeConfused:
+    ++CachedQueries;
+    return make_unique<Dependence>(Src, Dst);
+  default:
+    break;
+  }
+
+  std::unique_ptr<Dependence> Result =
+      dependsImpl(Src, Dst, PossiblyLoopIndependent);
+  uint8_t Outcome = OutcomeUnknown;
+  if (!Result)
+    Outcome = OutcomeIndependent;
+  else if (Result->isConfused())
+    Outcome = OutcomeConfused;
+  if (Outcome != OutcomeUnknown)
+    DependsCache[Key].Outcome[PossiblyLoopIndependent] = Outcome;
+  return Result;
+}
+
+std::unique_ptr<Dependence>
+DependenceAnalysis::dependsImpl(Instruction *Src, Instruction *Dst,
+                                bool PossiblyLoopIndependent) {
   if ((!Src->mayReadFromMemory() && !Src->mayWriteToMemory()) ||
       (!Dst->mayReadFromMemory() && !Dst->mayWriteToMemory()))
     // if both instructions don't reference memory, there's no dependence
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Analysis/CallGraph.h"
+#include "llvm/Analysis/CFGSummary.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
@@ -20,9 +21,10 @@ using namespace llvm;
 // Implementations of the CallGraph class methods.
 //
 
-CallGraph::CallGraph(Module &M)
+CallGraph::CallGraph(Module &M, CFGSummaryCache *Summaries)
     : M(M), Root(nullptr), ExternalCallingNode(getOrInsertFunction(nullptr)),
-      CallsExternalNode(new CallGraphNode(nullptr)) {
+      CallsExternalNode(new CallGraphNode(nullptr)), Summaries(Summaries),
+      SCCCacheValid(false) {
   // Add every function to the call graph.
   for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
     addToCallGraph(I);
@@ -74,22 +76,33 @@ void CallGraph::addToCallGraph(Function *F) {
   if (F->isDeclaration() && !F->isIntrinsic())
     Node->addCalledFunction(CallSite(), CallsExternalNode);
 
-  // Look for calls by this function.
+  // Look for calls by this function. The summary only records call-site
+  // positions; the callee is re-read here, so a cached summary stays valid
+  // across callee rewrites.
+  if (Summaries) {
+    for (Instruction *I : Summaries->getCallSites(*F))
+      addCallEdge(Node, CallSite(I));
+    return;
+  }
+
   for (Function::iterator BB = F->begin(), BBE = F->end(); BB != BBE; ++BB)
     for (BasicBlock::iterator II = BB->begin(), IE = BB->end(); II != IE;
          ++II) {
       CallSite CS(cast<Value>(II));
-      if (CS) {
-        const Function *Callee = CS.getCalledFunction();
-        if (!Callee)
-          // Indirect calls of intrinsics are not allowed so no need to check.
-          Node->addCalledFunction(CS, CallsExternalNode);
-        else if (!Callee->isIntrinsic())
-          Node->addCalledFunction(CS, getOrInsertFunction(Callee));
-      }
+      if (CS)
+        addCallEdge(Node, CS);
     }
 }
 
+void CallGraph::addCallEdge(CallGraphNode *Node, CallSite CS) {
+  const Function *Callee = CS.getCalledFunction();
+  if (!Callee)
+    // Indirect calls of intrinsics are not allowed so no need to check.
+    Node->addCalledFunction(CS, CallsExternalNode);
+  else if (!Callee->isIntrinsic())
+    Node->addCalledFunction(CS, getOrInsertFunction(Callee));
+}
+
 void CallGraph::print(raw_ostream &OS) const {
   OS << "CallGraph Root is: ";
   if (Function *F = Root->getFunction())
@@ -115,6 +128,7 @@ void CallGraph::dump() const { print(dbgs()); }
 Function *CallGraph::removeFunctionFromModule(CallGraphNode *CGN) {
   assert(CGN->empty() && "Cannot remove function from call "
          "graph if it references other functions!");
+  invalidateSCCCache();
   Function *F = CGN->getFunction(); // Get the function for the call graph node
   delete CGN;                       // Delete the call graph node for this func
   FunctionMap.erase(F);             // Remove the call graph node from the map
@@ -147,6 +161,7 @@ CallGraphNode *CallGraph::getOrInsertFunction(const Function *F) {
     return CGN;
 
   assert((!F || F->getParent() == &M) && "Function not in current module!");
+  invalidateSCCCache();
   return CGN = new CallGraphNode(const_cast<Function*>(F));
 }
 
@@ -93,9 +93,11 @@ public:
   }
   
 private:
+  bool RunPassesOnSCCWithIteration(CallGraphSCC &CurSCC, CallGraph &CG);
+
   bool RunAllPassesOnSCC(CallGraphSCC &CurSCC, CallGraph &CG,
                          bool &DevirtualizedCall);
-  
+
   bool RunPassOnSCC(Pass *P, CallGraphSCC &CurSCC,
                     CallGraph &CG, bool &CallGraphUpToDate,
                     bool &DevirtualizedCall);
@@ -438,8 +440,30 @@ bool CGPassManager::RunAllPassesOnSCC(CallGraphSCC &CurSCC, CallGraph &CG,
 bool CGPassManager::runOnModule(Module &M) {
   CallGraph &CG = getAnalysis<CallGraphWrapperPass>().getCallGraph();
   bool Changed = doInitialization(CG);
-  
-  // Walk the callgraph in bottom-up SCC order.
+
+  // If a previous pass sequence walked the SCCs and left the graph unchanged,
+  // reuse the post-order it recorded instead of re-running the SCC finder.
+  // The cache is copied up front because a pass that deletes a function
+  // invalidates the copy held by the call graph.
+  if (CG.sccCacheValid()) {
+    std::vector<std::vector<CallGraphNode *>> SCCs = CG.getCachedSCCs();
+    CallGraphSCC CurSCC(nullptr);
+    for (unsigned i = 0, e = SCCs.size(); i != e; ++i) {
+      const std::vector<CallGraphNode *> &NodeVec = SCCs[i];
+      CurSCC.initialize(NodeVec.data(), NodeVec.data() + NodeVec.size());
+      Changed |= RunPassesOnSCCWithIteration(CurSCC, CG);
+    }
+    // Any modification may have changed the shape of the graph; make the next
+    // run recompute the partition.
+    if (Changed)
+      CG.invalidateSCCCache();
+    Changed |= doFinalization(CG);
+    return Changed;
+  }
+
+  // Walk the callgraph in bottom-up SCC order, remembering the partition so
+  // that the next run over an unchanged graph can skip the computation.
+  std::vector<std::vector<CallGraphNode *>> ComputedSCCs;
   scc_iterator<CallGraph*> CGI = scc_begin(&CG);
 
   CallGraphSCC CurSCC(&CGI);
@@ -448,42 +472,59 @@ bool CGPassManager::runOnModule(Module &M) {
     // on the SCC if it wants to without invalidating our iterator.
     const std::vector<CallGraphNode *> &NodeVec = *CGI;
     CurSCC.initialize(NodeVec.data(), NodeVec.data() + NodeVec.size());
+    ComputedSCCs.push_back(NodeVec);
     ++CGI;
-    
-    // At the top level, we run all the passes in this pass manager on the
-    // functions in this SCC.  However, we support iterative compilation in the
-    // case where a function pass devirtualizes a call to a function.  For
-    // example, it is very common for a function pass (often GVN or instcombine)
-    // to eliminate the addressing that feeds into a call.  With that improved
-    // information, we would like the call to be an inline candidate, infer
-    // mod-ref information etc.
-    //
-    // Because of this, we allow iteration up to a specified iteration count.
-    // This only happens in the case of a devirtualized call, so we only burn
-    // compile time in the case that we're making progress.  We also have a hard
-    // iteration count limit in case there is crazy code.
-    unsigned Iteration = 0;
-    bool DevirtualizedCall = false;
-    do {
-      DEBUG(if (Iteration)
-              dbgs() << "  SCCPASSMGR: Re-visiting SCC, iteration #"
-                     << Iteration << '\n');
-      DevirtualizedCall = false;
-      Changed |= RunAllPassesOnSCC(CurSCC, CG, DevirtualizedCall);
-    } while (Iteration++ < MaxIterations && DevirtualizedCall);
-    
-    if (DevirtualizedCall)
-      DEBUG(dbgs() << "  CGSCCPASSMGR: Stopped iteration after " << Iteration
-                   << " times, due to -max-cg-scc-iterations\n");
-    
-    if (Iteration > MaxSCCIterations)
-      MaxSCCIterations = Iteration;
-    
+
+    Changed |= RunPassesOnSCCWithIteration(CurSCC, CG);
   }
+
+  // If nothing changed, the post-order we just walked is still the post-order
+  // of the graph; keep it for the next pass sequence.
+  if (!Changed)
+    CG.cacheSCCs(std::move(ComputedSCCs));
+
   Changed |= doFinalization(CG);
   return Changed;
 }
 
+/// RunPassesOnSCCWithIteration - Run the whole pass sequence on one SCC,
+/// re-visiting it when a call was devirtualized.
+///
+/// At the top level, we run all the passes in this pass manager on the
+/// functions in this SCC.  However, we support iterative compilation in the
+/// case where a function pass devirtualizes a call to a function.  For
+/// example, it is very common for a function pass (often GVN or instcombine)
+/// to eliminate the addressing that feeds into a call.  With that improved
+/// information, we would like the call to be an inline candidate, infer
+/// mod-ref information etc.
+///
+/// Because of this, we allow iteration up to a specified iteration count.
+/// This only happens in the case of a devirtualized call, so we only burn
+/// compile time in the case that we're making progress.  We also have a hard
+/// iteration count limit in case there is crazy code.
+bool CGPassManager::RunPassesOnSCCWithIteration(CallGraphSCC &CurSCC,
+                                                CallGraph &CG) {
+  bool Changed = false;
+  unsigned Iteration = 0;
+  bool DevirtualizedCall = false;
+  do {
+    DEBUG(if (Iteration)
+            dbgs() << "  SCCPASSMGR: Re-visiting SCC, iteration #"
+                   << Iteration << '\n');
+    DevirtualizedCall = false;
+    Changed |= RunAllPassesOnSCC(CurSCC, CG, DevirtualizedCall);
+  } while (Iteration++ < MaxIterations && DevirtualizedCall);
+
+  if (DevirtualizedCall)
+    DEBUG(dbgs() << "  CGSCCPASSMGR: Stopped iteration after " << Iteration
+                 << " times, due to -max-cg-scc-iterations\n");
+
+  if (Iteration > MaxSCCIterations)
+    MaxSCCIterations = Iteration;
+
+  return Changed;
+}
+
 
 /// Initialize CG
 bool CGPassManager::doInitialization(CallGraph &CG) {
@@ -531,9 +572,11 @@ void CallGraphSCC::ReplaceNode(CallGraphNode *Old, CallGraphNode *New) {
   }
   
   // Update the active scc_iterator so that it doesn't contain dangling
-  // pointers to the old CallGraphNode.
-  scc_iterator<CallGraph*> *CGI = (scc_iterator<CallGraph*>*)Context;
-  CGI->ReplaceNode(Old, New);
+  // pointers to the old CallGraphNode.  When running over the cached SCC
+  // post-order there is no iterator; the cache itself is invalidated by the
+  // graph mutation that accompanies the replacement.
+  if (scc_iterator<CallGraph*> *CGI = (scc_iterator<CallGraph*>*)Context)
+    CGI->ReplaceNode(Old, New);
 }
 
 
@@ -30,6 +30,7 @@
 #include "llvm/IR/InstVisitor.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Operator.h"
+#include "llvm/IR/StructuralHash.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -38,6 +39,8 @@ using namespace llvm;
 #define DEBUG_TYPE "inline-cost"
 
 STATISTIC(NumCallsAnalyzed, "Number of call sites analyzed");
+STATISTIC(NumCalleeCostsReused,
+          "Number of call sites reusing cached callee cost components");
 
 namespace {
 
@@ -60,6 +63,14 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
   int Threshold;
   int Cost;
 
+  /// Cache slot for this callee's cost components, or null when caching is
+  /// not available (empty callees, the speculative indirect call analysis).
+  InlineCostAnalysis::CalleeCostInfo *CacheEntry;
+
+  /// Whether the call site being analyzed supplies nothing for the analysis
+  /// to specialize on, making the body walk reusable at other such sites.
+  bool IsGenericCallSite;
+
   bool IsCallerRecursive;
   bool IsRecursiveCall;
   bool ExposesReturnsTwice;
@@ -107,6 +118,7 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
   bool accumulateGEPOffset(GEPOperator &GEP, APInt &Offset);
   bool simplifyCallSite(Function *F, CallSite CS);
   ConstantInt *stripAndComputeInBoundsConstantOffsets(Value *&V);
+  void cacheCalleeCost(bool Viable, int BodyCost, bool SingleBB);
 
   // Custom analysis routines.
   bool analyzeBlock(BasicBlock *BB, SmallPtrSetImpl<const Value *> &EphValues);
@@ -146,8 +158,10 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
 
 public:
   CallAnalyzer(const DataLayout *DL, const TargetTransformInfo &TTI,
-               AssumptionCacheTracker *ACT, Function &Callee, int Threshold)
+               AssumptionCacheTracker *ACT, Function &Callee, int Threshold,
+               InlineCostAnalysis::CalleeCostInfo *CacheEntry = nullptr)
       : DL(DL), TTI(TTI), ACT(ACT), F(Callee), Threshold(Threshold), Cost(0),
+        CacheEntry(CacheEntry), IsGenericCallSite(false),
         IsCallerRecursive(false), IsRecursiveCall(false),
         ExposesReturnsTwice(false), HasDynamicAlloca(false),
         ContainsNoDuplicateCall(false), HasReturn(false), HasIndirectBr(false),
@@ -1007,6 +1021,23 @@ ConstantInt *CallAnalyzer::stripAndComputeInBoundsConstantOffsets(Value *&V) {
   return cast<ConstantInt>(ConstantInt::get(IntPtrTy, Offset));
 }
 
+/// \brief Record callee-local analysis results for reuse at later call sites.
+///
+/// This is a no-op unless the current call site is generic (supplies nothing
+/// to specialize the analysis on) and a cache slot was provided, since
+/// otherwise the results depend on the particular site.
+void CallAnalyzer::cacheCalleeCost(bool Viable, int BodyCost, bool SingleBB) {
+  if (!IsGenericCallSite || !CacheEntry)
+    return;
+  CacheEntry->Cost = BodyCost;
+  CacheEntry->NumInstructions = NumInstructions;
+  CacheEntry->NumVectorInstructions = NumVectorInstructions;
+  CacheEntry->SingleBB = SingleBB;
+  CacheEntry->ContainsNoDuplicateCall = ContainsNoDuplicateCall;
+  CacheEntry->Viable = Viable;
+  CacheEntry->Valid = true;
+}
+
 /// \brief Analyze a call site for potential inlining.
 ///
 /// Returns true if inlining this call is viable, and false if it is not
@@ -1130,6 +1161,38 @@ bool CallAnalyzer::analyzeCall(CallSite CS) {
   NumConstantOffsetPtrArgs = ConstantOffsetPtrs.size();
   NumAllocaArgs = SROAArgValues.size();
 
+  // If the call site gave us nothing to specialize on, the walk over the body
+  // below depends only on the callee, so its results can be shared with every
+  // other such site and across inliner iterations. Reuse them if a previous
+  // analysis cached them, applying only the site-specific threshold
+  // adjustments.
+  IsGenericCallSite = SimplifiedValues.empty() && ConstantOffsetPtrs.empty() &&
+                      SROAArgValues.empty() && !IsCallerRecursive;
+  if (IsGenericCallSite && CacheEntry && CacheEntry->Valid) {
+    ++NumCalleeCostsReused;
+    if (!CacheEntry->Viable)
+      return false;
+
+    Cost += CacheEntry->Cost;
+    NumInstructions = CacheEntry->NumInstructions;
+    NumVectorInstructions = CacheEntry->NumVectorInstructions;
+    ContainsNoDuplicateCall = CacheEntry->ContainsNoDuplicateCall;
+    if (!CacheEntry->SingleBB)
+      Threshold -= SingleBBBonus;
+    if (NumVectorInstructions > NumInstructions / 2)
+      VectorBonus = FiftyPercentVectorBonus;
+    else if (NumVectorInstructions > NumInstructions / 10)
+      VectorBonus = TenPercentVectorBonus;
+    else
+      VectorBonus = 0;
+
+    if (!OnlyOneCallAndLocalLinkage && ContainsNoDuplicateCall)
+      return false;
+
+    Threshold += VectorBonus;
+    return Cost < Threshold;
+  }
+
   // FIXME: If a caller has multiple calls to a callee, we end up recomputing
   // the ephemeral values multiple times (and they're completely determined by
   // the callee, so this is purely duplicate work).
@@ -1147,12 +1210,19 @@ bool CallAnalyzer::analyzeCall(CallSite CS) {
                                   SmallPtrSet<BasicBlock *, 16> > BBSetVector;
   BBSetVector BBWorklist;
   BBWorklist.insert(&F.getEntryBlock());
+  // Track what the walk adds to the cost and whether it visits every live
+  // block; only a completed walk yields threshold-independent results that
+  // are safe to cache.
+  int CostAtBodyStart = Cost;
+  bool WalkCompleted = true;
   // Note that we *must not* cache the size, this loop grows the worklist.
   for (unsigned Idx = 0; Idx != BBWorklist.size(); ++Idx) {
     // Bail out the moment we cross the threshold. This means we'll under-count
     // the cost, but only when undercounting doesn't matter.
-    if (Cost > (Threshold + VectorBonus))
+    if (Cost > (Threshold + VectorBonus)) {
+      WalkCompleted = false;
       break;
+    }
 
     BasicBlock *BB = BBWorklist[Idx];
     if (BB->empty())
@@ -1164,15 +1234,19 @@ bool CallAnalyzer::analyzeCall(CallSite CS) {
     // see an indirect branch that ends up being dead code at a particular call
     // site. If the blockaddress escapes the function, e.g., via a global
     // variable, inlining may lead to an invalid cross-function reference.
-    if (BB->hasAddressTaken())
+    if (BB->hasAddressTaken()) {
+      cacheCalleeCost(/*Viable=*/false, 0, false);
       return false;
+    }
 
     // Analyze the cost of this block. If we blow through the threshold, this
     // returns false, and we can bail on out.
     if (!analyzeBlock(BB, EphValues)) {
       if (IsRecursiveCall || ExposesReturnsTwice || HasDynamicAlloca ||
-          HasIndirectBr)
+          HasIndirectBr) {
+        cacheCalleeCost(/*Viable=*/false, 0, false);
         return false;
+      }
 
       // If the caller is a recursive function then we don't want to inline
       // functions which allocate a lot of stack space because it would increase
@@ -1181,6 +1255,7 @@ bool CallAnalyzer::analyzeCall(CallSite CS) {
           AllocatedSize > InlineConstants::TotalAllocaSizeRecursiveCaller)
         return false;
 
+      WalkCompleted = false;
       break;
     }
 
@@ -1223,6 +1298,9 @@ bool CallAnalyzer::analyzeCall(CallSite CS) {
     }
   }
 
+  if (WalkCompleted)
+    cacheCalleeCost(/*Viable=*/true, Cost - CostAtBodyStart, SingleBB);
+
   // If this is a noduplicate call, we can still inline as long as
   // inlining this would cause the removal of the caller (so the instruction
   // is not actually duplicated, just moved).
@@ -1333,8 +1411,22 @@ InlineCost InlineCostAnalysis::getInlineCost(CallSite CS, Function *Callee,
   DEBUG(llvm::dbgs() << "      Analyzing call of " << Callee->getName()
         << "...\n");
 
+  // Look up the cache slot for this callee's body-walk results, invalidating
+  // it if the body has changed since they were recorded. Hashing the body is
+  // much cheaper than re-simulating it, and a hash collision merely reuses
+  // the cost of a structurally identical function.
+  CalleeCostInfo *CCI = nullptr;
+  if (!Callee->empty()) {
+    uint64_t BodyHash = StructuralHash(*Callee);
+    CCI = &CalleeCostCache[Callee];
+    if (CCI->BodyHash != BodyHash) {
+      CCI->BodyHash = BodyHash;
+      CCI->Valid = false;
+    }
+  }
+
   CallAnalyzer CA(Callee->getDataLayout(), TTIWP->getTTI(*Callee),
-                  ACT, *Callee, Threshold);
+                  ACT, *Callee, Threshold, CCI);
   bool ShouldInline = CA.analyzeCall(CS);
 
   DEBUG(CA.dump());
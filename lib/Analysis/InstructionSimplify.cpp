@@ -32,6 +32,7 @@
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/PatternMatch.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/CommandLine.h"
 #include <algorithm>
 using namespace llvm;
 using namespace llvm::PatternMatch;
@@ -40,6 +41,10 @@ using namespace llvm::PatternMatch;
 
 enum { RecursionLimit = 3 };
 
+static cl::opt<bool> EnableSimplifyMemo(
+    "instsimplify-memo", cl::init(true), cl::Hidden,
+    cl::desc("Memoize SimplifyInstruction results until the IR next changes"));
+
 STATISTIC(NumExpand,  "Number of expansions");
 STATISTIC(NumReassoc, "Number of reassociations");
 
@@ -3619,11 +3624,61 @@ Value *llvm::SimplifyCall(Value *V, ArrayRef<Value *> Args,
                         Query(DL, TLI, DT, AC, CxtI), RecursionLimit);
 }
 
+namespace {
+/// A slot in the SimplifyInstruction memo table.  An entry is live only while
+/// its recorded epoch matches the thread's current ValueMutationEpoch; any IR
+/// mutation since the entry was computed (operand write, value deletion,
+/// instruction motion, flag or metadata change) makes it stale, so a hit can
+/// safely return the cached
+/// result - including cached "no simplification" (null) results, which is the
+/// common case when InstCombine revisits unchanged code.
+struct SimplifyMemoEntry {
+  const Instruction *Key;
+  Value *Result;
+  uint64_t Epoch;
+};
+}
+
+// Must be a power of two; 1024 direct-mapped slots cost 24K per thread.
+enum { SimplifyMemoSize = 1024 };
+
+static LLVM_THREAD_LOCAL SimplifyMemoEntry SimplifyMemo[SimplifyMemoSize];
+
+/// The analysis pointers the memo entries were computed against.  Results
+/// depend on them, so if a caller passes a different set we invalidate the
+/// whole table by bumping the epoch rather than tagging each entry.
+namespace {
+struct SimplifyMemoContext {
+  const void *DL, *TLI, *DT, *AC;
+};
+}
+static LLVM_THREAD_LOCAL SimplifyMemoContext SimplifyMemoCtx;
+
+static SimplifyMemoEntry *lookupSimplifyMemo(const Instruction *I) {
+  uintptr_t H = reinterpret_cast<uintptr_t>(I);
+  return &SimplifyMemo[((H >> 4) ^ (H >> 9)) & (SimplifyMemoSize - 1)];
+}
+
 /// SimplifyInstruction - See if we can compute a simplified version of this
 /// instruction.  If not, this returns null.
 Value *llvm::SimplifyInstruction(Instruction *I, const DataLayout *DL,
                                  const TargetLibraryInfo *TLI,
                                  const DominatorTree *DT, AssumptionCache *AC) {
+  SimplifyMemoEntry *Memo = nullptr;
+  if (EnableSimplifyMemo) {
+    if (DL != SimplifyMemoCtx.DL || TLI != SimplifyMemoCtx.TLI ||
+        DT != SimplifyMemoCtx.DT || AC != SimplifyMemoCtx.AC) {
+      SimplifyMemoCtx.DL = DL;
+      SimplifyMemoCtx.TLI = TLI;
+      SimplifyMemoCtx.DT = DT;
+      SimplifyMemoCtx.AC = AC;
+      ++ValueMutationEpoch;
+    }
+    Memo = lookupSimplifyMemo(I);
+    if (Memo->Key == I && Memo->Epoch == ValueMutationEpoch)
+      return Memo->Result;
+  }
+
   Value *Result;
 
   switch (I->getOpcode()) {
@@ -3754,7 +3809,17 @@ Value *llvm::SimplifyInstruction(Instruction *I, const DataLayout *DL,
   /// If called on unreachable code, the above logic may report that the
   /// instruction simplified to itself.  Make life easier for users by
   /// detecting that case here, returning a safe value instead.
-  return Result == I ? UndefValue::get(I->getType()) : Result;
+  if (Result == I)
+    Result = UndefValue::get(I->getType());
+
+  // Record the result under the epoch read *after* the computation, so any
+  // constants materialized along the way do not immediately stale the entry.
+  if (Memo) {
+    Memo->Key = I;
+    Memo->Result = Result;
+    Memo->Epoch = ValueMutationEpoch;
+  }
+  return Result;
 }
 
 /// \brief Implementation of recursive simplification through an instructions
@@ -79,6 +79,7 @@ void MemoryDependenceAnalysis::releaseMemory() {
   ReverseLocalDeps.clear();
   ReverseNonLocalDeps.clear();
   ReverseNonLocalPtrDeps.clear();
+  BlockAccessesMemory.clear();
   PredCache->clear();
 }
 
@@ -941,6 +942,26 @@ getNonLocalPointerDependency(Instruction *QueryInst,
                                      const_cast<Value *>(Loc.Ptr)));
 }
 
+/// blockAccessesMemory - Return true if any instruction in BB may read or
+/// write memory.  The result is computed once per block and then shared by
+/// every pointer query, so crossing memory-free blocks (common in branchy
+/// code) costs a map lookup instead of an instruction scan per pointer.
+/// Instruction removal can only turn the answer from true to false, so stale
+/// entries are conservative and merely cost a scan.
+bool MemoryDependenceAnalysis::blockAccessesMemory(BasicBlock *BB) {
+  DenseMap<BasicBlock*, bool>::iterator It = BlockAccessesMemory.find(BB);
+  if (It != BlockAccessesMemory.end())
+    return It->second;
+
+  bool AccessesMemory = false;
+  for (Instruction &I : *BB)
+    if (I.mayReadOrWriteMemory()) {
+      AccessesMemory = true;
+      break;
+    }
+  return BlockAccessesMemory[BB] = AccessesMemory;
+}
+
 /// GetNonLocalInfoForBlock - Compute the memdep value for BB with
 /// Pointer/PointeeSize using either cached information in Cache or by doing a
 /// lookup (which may use dirty cache info if available).  If we do a lookup,
@@ -987,9 +1008,12 @@ GetNonLocalInfoForBlock(Instruction *QueryInst,
     ++NumUncacheNonLocalPtr;
   }
 
-  // Scan the block for the dependency.
-  MemDepResult Dep = getPointerDependencyFrom(Loc, isLoad, ScanPos, BB,
-                                              QueryInst);
+  // Scan the block for the dependency.  Blocks with no memory operations at
+  // all are transparent to any location; skip the scan entirely for those.
+  MemDepResult Dep = blockAccessesMemory(BB)
+                         ? getPointerDependencyFrom(Loc, isLoad, ScanPos, BB,
+                                                    QueryInst)
+                         : MemDepResult::getNonLocal();
 
   // If we had a dirty entry for the block, update it.  Otherwise, just add
   // a new entry.
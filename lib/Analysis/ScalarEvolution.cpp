@@ -63,6 +63,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/InstructionSimplify.h"
@@ -86,7 +87,12 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 using namespace llvm;
@@ -114,6 +120,11 @@ static cl::opt<bool>
 VerifySCEV("verify-scev",
            cl::desc("Verify ScalarEvolution's backedge taken counts (slow)"));
 
+static cl::opt<std::string> TripCountCacheFile(
+    "scev-trip-count-cache", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Persist constant backedge-taken counts to the given file and "
+             "reuse them across runs for unchanged function bodies"));
+
 INITIALIZE_PASS_BEGIN(ScalarEvolution, "scalar-evolution",
                 "Scalar Evolution Analysis", false, true)
 INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
@@ -3190,8 +3201,10 @@ const SCEV *ScalarEvolution::getSCEV(Value *V) {
 
   ValueExprMapType::iterator I = ValueExprMap.find_as(V);
   if (I != ValueExprMap.end()) {
-    const SCEV *S = I->second;
-    if (checkValidity(S))
+    const SCEV *S = I->second.S;
+    // Entries from an earlier epoch were invalidated by forgetLoop or
+    // forgetValue; filter them out here and reclaim the slot.
+    if (I->second.Epoch == SCEVEpoch && checkValidity(S))
       return S;
     else
       ValueExprMap.erase(I);
@@ -3202,7 +3215,8 @@ const SCEV *ScalarEvolution::getSCEV(Value *V) {
   // to have been created, so it's necessary to insert the new entry
   // from scratch, rather than trying to remember the insert position
   // above.
-  ValueExprMap.insert(std::make_pair(SCEVCallbackVH(V, this), S));
+  ValueExprMap.insert(std::make_pair(SCEVCallbackVH(V, this),
+                                     ValueExprEntry(S, SCEVEpoch)));
   return S;
 }
 
@@ -3434,7 +3448,7 @@ ScalarEvolution::ForgetSymbolicName(Instruction *PN, const SCEV *SymName) {
     ValueExprMapType::iterator It =
       ValueExprMap.find_as(static_cast<Value *>(I));
     if (It != ValueExprMap.end()) {
-      const SCEV *Old = It->second;
+      const SCEV *Old = It->second.S;
 
       // Short-circuit the def-use traversal if the symbolic name
       // ceases to appear in expressions.
@@ -3491,7 +3505,9 @@ const SCEV *ScalarEvolution::createNodeForPHI(PHINode *PN) {
         const SCEV *SymbolicName = getUnknown(PN);
         assert(ValueExprMap.find_as(PN) == ValueExprMap.end() &&
                "PHI node already processed?");
-        ValueExprMap.insert(std::make_pair(SCEVCallbackVH(PN, this), SymbolicName));
+        ValueExprMap.insert(std::make_pair(SCEVCallbackVH(PN, this),
+                                           ValueExprEntry(SymbolicName,
+                                                          SCEVEpoch)));
 
         // Using this symbolic name for the PHI, analyze the value coming around
         // the back-edge.
@@ -3568,7 +3584,8 @@ const SCEV *ScalarEvolution::createNodeForPHI(PHINode *PN) {
               // to be symbolic.  We now need to go back and purge all of the
               // entries for the scalars that use the symbolic expression.
               ForgetSymbolicName(PN, SymbolicName);
-              ValueExprMap[SCEVCallbackVH(PN, this)] = PHISCEV;
+              ValueExprMap[SCEVCallbackVH(PN, this)] =
+                ValueExprEntry(PHISCEV, SCEVEpoch);
               return PHISCEV;
             }
           }
@@ -3596,7 +3613,8 @@ const SCEV *ScalarEvolution::createNodeForPHI(PHINode *PN) {
               // to be symbolic.  We now need to go back and purge all of the
               // entries for the scalars that use the symbolic expression.
               ForgetSymbolicName(PN, SymbolicName);
-              ValueExprMap[SCEVCallbackVH(PN, this)] = PHISCEV;
+              ValueExprMap[SCEVCallbackVH(PN, this)] =
+                ValueExprEntry(PHISCEV, SCEVEpoch);
               return PHISCEV;
             }
           }
@@ -4588,6 +4606,147 @@ PushLoopPHIs(const Loop *L, SmallVectorImpl<Instruction *> &Worklist) {
     Worklist.push_back(PN);
 }
 
+namespace {
+/// TripCountCache - On-disk map from (function body hash, loop header index)
+/// to a constant backedge-taken count, shared by every ScalarEvolution
+/// instance in the process. The file is line oriented text, one
+/// "<key> <bitwidth> <count>" entry per line; it is read once on first use
+/// and written back at llvm_shutdown if any entry was added. Concurrent
+/// processes updating the same file race and the last writer wins, which can
+/// lose cache entries but never correctness.
+class TripCountCache {
+  sys::SmartMutex<true> Lock;
+  StringMap<std::pair<unsigned, uint64_t> > Entries;
+  bool Loaded;
+  bool Dirty;
+
+  void load() {
+    Loaded = true;
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFile(TripCountCacheFile);
+    if (!BufOrErr)
+      return; // A missing or unreadable file is just an empty cache.
+    StringRef Rest = BufOrErr.get()->getBuffer();
+    while (!Rest.empty()) {
+      std::pair<StringRef, StringRef> LineAndRest = Rest.split('\n');
+      Rest = LineAndRest.second;
+      SmallVector<StringRef, 3> Fields;
+      LineAndRest.first.split(Fields, " ", -1, false);
+      unsigned BitWidth;
+      uint64_t Count;
+      // Skip malformed lines rather than failing the run.
+      if (Fields.size() != 3 || Fields[1].getAsInteger(10, BitWidth) ||
+          Fields[2].getAsInteger(10, Count) || BitWidth == 0)
+        continue;
+      Entries[Fields[0]] = std::make_pair(BitWidth, Count);
+    }
+  }
+
+public:
+  TripCountCache() : Loaded(false), Dirty(false) {}
+
+  ~TripCountCache() {
+    if (!Dirty)
+      return;
+    std::error_code EC;
+    raw_fd_ostream OS(TripCountCacheFile, EC, sys::fs::F_Text);
+    if (EC)
+      return;
+    for (StringMap<std::pair<unsigned, uint64_t> >::const_iterator
+           I = Entries.begin(), E = Entries.end(); I != E; ++I)
+      OS << I->getKey() << ' ' << I->second.first << ' ' << I->second.second
+         << '\n';
+  }
+
+  bool lookup(StringRef Key, unsigned &BitWidth, uint64_t &Count) {
+    sys::SmartScopedLock<true> Guard(Lock);
+    if (!Loaded)
+      load();
+    StringMap<std::pair<unsigned, uint64_t> >::const_iterator I =
+        Entries.find(Key);
+    if (I == Entries.end())
+      return false;
+    BitWidth = I->second.first;
+    Count = I->second.second;
+    return true;
+  }
+
+  void insert(StringRef Key, unsigned BitWidth, uint64_t Count) {
+    sys::SmartScopedLock<true> Guard(Lock);
+    if (!Loaded)
+      load();
+    if (Entries.insert(std::make_pair(Key,
+                                      std::make_pair(BitWidth, Count))).second)
+      Dirty = true;
+  }
+};
+} // end anonymous namespace
+
+static ManagedStatic<TripCountCache> TheTripCountCache;
+
+std::string ScalarEvolution::getTripCountCacheKey(const Loop *L) {
+  // Hash the printed function once per function; names are included, so any
+  // textual change to the body invalidates all of its cached counts. A
+  // cryptographic hash is used because a key collision here would silently
+  // produce a wrong trip count.
+  if (TripCountCacheKey.empty()) {
+    SmallString<256> Body;
+    raw_svector_ostream BodyOS(Body);
+    F->print(BodyOS);
+    MD5 Hash;
+    Hash.update(BodyOS.str());
+    MD5::MD5Result HashResult;
+    Hash.final(HashResult);
+    SmallString<32> Digest;
+    MD5::stringifyResult(HashResult, Digest);
+    TripCountCacheKey = Digest.str().str();
+  }
+
+  // Identify the loop by the position of its header block in the function.
+  unsigned HeaderIdx = 0;
+  for (Function::const_iterator BB = F->begin(), E = F->end(); BB != E;
+       ++BB, ++HeaderIdx)
+    if (&*BB == L->getHeader())
+      break;
+
+  std::string Key;
+  raw_string_ostream KeyOS(Key);
+  KeyOS << TripCountCacheKey << ':' << HeaderIdx;
+  return KeyOS.str();
+}
+
+bool ScalarEvolution::lookupCachedBackedgeTakenCount(const Loop *L,
+                                                     BackedgeTakenInfo &Result) {
+  // Only loops with a unique exiting block are cached; that is the only shape
+  // a (block, count) pair can faithfully reconstruct.
+  BasicBlock *ExitingBB = L->getExitingBlock();
+  if (!ExitingBB)
+    return false;
+
+  unsigned BitWidth;
+  uint64_t Count;
+  if (!TheTripCountCache->lookup(getTripCountCacheKey(L), BitWidth, Count))
+    return false;
+
+  const SCEV *BECount = getConstant(APInt(BitWidth, Count));
+  SmallVector<std::pair<BasicBlock *, const SCEV *>, 1> ExitCounts;
+  ExitCounts.push_back(std::make_pair(ExitingBB, BECount));
+  Result = BackedgeTakenInfo(ExitCounts, /*Complete=*/true, BECount);
+  return true;
+}
+
+void ScalarEvolution::recordCachedBackedgeTakenCount(
+    const Loop *L, const BackedgeTakenInfo &Result) {
+  const SCEVConstant *Exact = dyn_cast<SCEVConstant>(Result.getExact(this));
+  if (!Exact || !L->getExitingBlock())
+    return;
+  const APInt &Count = Exact->getValue()->getValue();
+  if (Count.getBitWidth() > 64)
+    return;
+  TheTripCountCache->insert(getTripCountCacheKey(L), Count.getBitWidth(),
+                            Count.getZExtValue());
+}
+
 const ScalarEvolution::BackedgeTakenInfo &
 ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
   // Initially insert an invalid entry for this loop. If the insertion
@@ -4603,7 +4762,18 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
   // ComputeBackedgeTakenCount may allocate memory for its result. Inserting it
   // into the BackedgeTakenCounts map transfers ownership. Otherwise, the result
   // must be cleared in this scope.
-  BackedgeTakenInfo Result = ComputeBackedgeTakenCount(L);
+  //
+  // With -scev-trip-count-cache, first try to reuse a constant count recorded
+  // by an earlier run over an identical function body, which skips the exit
+  // condition analysis entirely.
+  BackedgeTakenInfo Result;
+  bool UseCache = !TripCountCacheFile.empty() && !TripCountCacheDisabled;
+  bool FromCache = UseCache && lookupCachedBackedgeTakenCount(L, Result);
+  if (!FromCache) {
+    Result = ComputeBackedgeTakenCount(L);
+    if (UseCache)
+      recordCachedBackedgeTakenCount(L, Result);
+  }
 
   if (Result.getExact(this) != getCouldNotCompute()) {
     assert(isLoopInvariant(Result.getExact(this), L) &&
@@ -4635,7 +4805,7 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
       ValueExprMapType::iterator It =
         ValueExprMap.find_as(static_cast<Value *>(I));
       if (It != ValueExprMap.end()) {
-        const SCEV *Old = It->second;
+        const SCEV *Old = It->second.S;
 
         // SCEVUnknown for a PHI either means that it has an unrecognized
         // structure, or it's a PHI that's in the progress of being computed
@@ -4663,74 +4833,69 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
   return BackedgeTakenCounts.find(L)->second = Result;
 }
 
+/// bumpEpoch - Invalidate every cached value mapping by advancing SCEVEpoch,
+/// and drop the side tables in bulk.
+///
+/// The side tables are not epoch-tagged because their entries can encode
+/// facts (trip counts, ranges, dispositions) that a client's change may have
+/// invalidated even when the keyed expression itself survives; clearing them
+/// wholesale is still far cheaper than the old per-entry erasure, which
+/// scanned BackedgeTakenCounts once for every forgotten expression.
+void ScalarEvolution::bumpEpoch() {
+  ++SCEVEpoch;
+
+  // Every ValueExprMap entry is now stale.  Small maps are left to be
+  // filtered lazily by getSCEV; large ones are swept here in one pass so a
+  // long IndVarSimplify/LSR session cannot accumulate unbounded dead
+  // entries.
+  if (ValueExprMap.size() >= 4096)
+    ValueExprMap.clear();
+
+  // Free any extra memory created for ExitNotTakenInfo in the unlikely event
+  // that a loop had multiple computable exits.
+  for (DenseMap<const Loop*, BackedgeTakenInfo>::iterator I =
+         BackedgeTakenCounts.begin(), E = BackedgeTakenCounts.end();
+       I != E; ++I)
+    I->second.clear();
+
+  BackedgeTakenCounts.clear();
+  ConstantEvolutionLoopExitValue.clear();
+  ValuesAtScopes.clear();
+  LoopDispositions.clear();
+  BlockDispositions.clear();
+  UnsignedRanges.clear();
+  SignedRanges.clear();
+}
+
 /// forgetLoop - This method should be called by the client when it has
 /// changed a loop in a way that may effect ScalarEvolution's ability to
 /// compute a trip count, or if the loop is deleted.
 void ScalarEvolution::forgetLoop(const Loop *L) {
-  // Drop any stored trip count value.
-  DenseMap<const Loop*, BackedgeTakenInfo>::iterator BTCPos =
-    BackedgeTakenCounts.find(L);
-  if (BTCPos != BackedgeTakenCounts.end()) {
-    BTCPos->second.clear();
-    BackedgeTakenCounts.erase(BTCPos);
-  }
-
-  // Drop information about expressions based on loop-header PHIs.
-  SmallVector<Instruction *, 16> Worklist;
-  PushLoopPHIs(L, Worklist);
+  // Invalidation used to walk the transitive users of the loop-header PHIs,
+  // erasing cached results one entry at a time.  An epoch bump invalidates a
+  // superset of those entries at a small constant cost; the price is that
+  // unrelated values have to be re-analyzed on their next query.
+  bumpEpoch();
 
-  SmallPtrSet<Instruction *, 8> Visited;
-  while (!Worklist.empty()) {
-    Instruction *I = Worklist.pop_back_val();
-    if (!Visited.insert(I).second)
-      continue;
-
-    ValueExprMapType::iterator It =
-      ValueExprMap.find_as(static_cast<Value *>(I));
-    if (It != ValueExprMap.end()) {
-      forgetMemoizedResults(It->second);
-      ValueExprMap.erase(It);
-      if (PHINode *PN = dyn_cast<PHINode>(I))
-        ConstantEvolutionLoopExitValue.erase(PN);
-    }
-
-    PushDefUseChildren(I, Worklist);
-  }
-
-  // Forget all contained loops too, to avoid dangling entries in the
-  // ValuesAtScopes map.
-  for (Loop::iterator I = L->begin(), E = L->end(); I != E; ++I)
-    forgetLoop(*I);
+  // A forget signals that the function body is changing, so the hash-keyed
+  // persistent trip count cache no longer describes this IR.
+  TripCountCacheDisabled = true;
 }
 
 /// forgetValue - This method should be called by the client when it has
 /// changed a value in a way that may effect its value, or which may
 /// disconnect it from a def-use chain linking it to a loop.
 void ScalarEvolution::forgetValue(Value *V) {
-  Instruction *I = dyn_cast<Instruction>(V);
-  if (!I) return;
-
-  // Drop information about expressions based on loop-header PHIs.
-  SmallVector<Instruction *, 16> Worklist;
-  Worklist.push_back(I);
-
-  SmallPtrSet<Instruction *, 8> Visited;
-  while (!Worklist.empty()) {
-    I = Worklist.pop_back_val();
-    if (!Visited.insert(I).second)
-      continue;
+  if (!isa<Instruction>(V))
+    return;
 
-    ValueExprMapType::iterator It =
-      ValueExprMap.find_as(static_cast<Value *>(I));
-    if (It != ValueExprMap.end()) {
-      forgetMemoizedResults(It->second);
-      ValueExprMap.erase(It);
-      if (PHINode *PN = dyn_cast<PHINode>(I))
-        ConstantEvolutionLoopExitValue.erase(PN);
-    }
+  // See forgetLoop: the epoch bump conservatively covers everything the old
+  // def-use walk from V would have erased.
+  bumpEpoch();
 
-    PushDefUseChildren(I, Worklist);
-  }
+  // See forgetLoop: the body is being mutated, so the persistent trip count
+  // cache keyed on its original hash must not be used any more.
+  TripCountCacheDisabled = true;
 }
 
 /// getExact - Get the exact loop backedge taken count considering all loop
@@ -7947,8 +8112,9 @@ ScalarEvolution::SCEVCallbackVH::SCEVCallbackVH(Value *V, ScalarEvolution *se)
 //===----------------------------------------------------------------------===//
 
 ScalarEvolution::ScalarEvolution()
-  : FunctionPass(ID), ValuesAtScopes(64), LoopDispositions(64),
-    BlockDispositions(64), FirstUnknown(nullptr) {
+  : FunctionPass(ID), SCEVEpoch(1), TripCountCacheDisabled(false),
+    ValuesAtScopes(64), LoopDispositions(64), BlockDispositions(64),
+    FirstUnknown(nullptr) {
   initializeScalarEvolutionPass(*PassRegistry::getPassRegistry());
 }
 
@@ -7971,6 +8137,7 @@ void ScalarEvolution::releaseMemory() {
   FirstUnknown = nullptr;
 
   ValueExprMap.clear();
+  SCEVEpoch = 1;
 
   // Free any extra memory created for ExitNotTakenInfo in the unlikely event
   // that a loop had multiple computable exits.
@@ -7983,6 +8150,8 @@ void ScalarEvolution::releaseMemory() {
   assert(PendingLoopPredicates.empty() && "isImpliedCond garbage");
 
   BackedgeTakenCounts.clear();
+  TripCountCacheKey.clear();
+  TripCountCacheDisabled = false;
   ConstantEvolutionLoopExitValue.clear();
   ValuesAtScopes.clear();
   LoopDispositions.clear();
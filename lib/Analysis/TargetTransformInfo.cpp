@@ -43,6 +43,10 @@ TargetTransformInfo::TargetTransformInfo(TargetTransformInfo &&Arg)
 
 TargetTransformInfo &TargetTransformInfo::operator=(TargetTransformInfo &&RHS) {
   TTIImpl = std::move(RHS.TTIImpl);
+  // The memoized costs belong to the old implementation.
+  ArithmeticCostCache.clear();
+  CastCostCache.clear();
+  CmpSelCostCache.clear();
   return *this;
 }
 
@@ -186,8 +190,18 @@ unsigned TargetTransformInfo::getArithmeticInstrCost(
     unsigned Opcode, Type *Ty, OperandValueKind Opd1Info,
     OperandValueKind Opd2Info, OperandValueProperties Opd1PropInfo,
     OperandValueProperties Opd2PropInfo) const {
-  return TTIImpl->getArithmeticInstrCost(Opcode, Ty, Opd1Info, Opd2Info,
-                                         Opd1PropInfo, Opd2PropInfo);
+  // Pack the whole query into a key and check the memo table before entering
+  // the target hooks. Operand kinds take two bits each, properties one.
+  unsigned Key = Opcode << 8 | Opd1Info << 6 | Opd2Info << 4 |
+                 Opd1PropInfo << 2 | Opd2PropInfo;
+  auto It = ArithmeticCostCache.find(std::make_pair(Ty, Key));
+  if (It != ArithmeticCostCache.end())
+    return It->second;
+  unsigned Cost = TTIImpl->getArithmeticInstrCost(Opcode, Ty, Opd1Info,
+                                                  Opd2Info, Opd1PropInfo,
+                                                  Opd2PropInfo);
+  ArithmeticCostCache.insert(std::make_pair(std::make_pair(Ty, Key), Cost));
+  return Cost;
 }
 
 unsigned TargetTransformInfo::getShuffleCost(ShuffleKind Kind, Type *Ty,
@@ -197,7 +211,13 @@ unsigned TargetTransformInfo::getShuffleCost(ShuffleKind Kind, Type *Ty,
 
 unsigned TargetTransformInfo::getCastInstrCost(unsigned Opcode, Type *Dst,
                                                Type *Src) const {
-  return TTIImpl->getCastInstrCost(Opcode, Dst, Src);
+  auto Key = std::make_pair(std::make_pair(Dst, Src), Opcode);
+  auto It = CastCostCache.find(Key);
+  if (It != CastCostCache.end())
+    return It->second;
+  unsigned Cost = TTIImpl->getCastInstrCost(Opcode, Dst, Src);
+  CastCostCache.insert(std::make_pair(Key, Cost));
+  return Cost;
 }
 
 unsigned TargetTransformInfo::getCFInstrCost(unsigned Opcode) const {
@@ -206,7 +226,13 @@ unsigned TargetTransformInfo::getCFInstrCost(unsigned Opcode) const {
 
 unsigned TargetTransformInfo::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
                                                  Type *CondTy) const {
-  return TTIImpl->getCmpSelInstrCost(Opcode, ValTy, CondTy);
+  auto Key = std::make_pair(std::make_pair(ValTy, CondTy), Opcode);
+  auto It = CmpSelCostCache.find(Key);
+  if (It != CmpSelCostCache.end())
+    return It->second;
+  unsigned Cost = TTIImpl->getCmpSelInstrCost(Opcode, ValTy, CondTy);
+  CmpSelCostCache.insert(std::make_pair(Key, Cost));
+  return Cost;
 }
 
 unsigned TargetTransformInfo::getVectorInstrCost(unsigned Opcode, Type *Val,
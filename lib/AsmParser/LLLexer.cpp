@@ -141,20 +141,52 @@ static void UnEscapeLexed(std::string &Str) {
   Str.resize(BOut-Buffer);
 }
 
+namespace {
+/// Character classes tested by the scanning loops below. One table lookup
+/// per byte keeps the hot identifier, number and whitespace runs free of
+/// libc calls and branchy character tests.
+enum {
+  CharWhitespace = 1, // [ \t\n\r]
+  CharDigit      = 2, // [0-9]
+  CharLabel      = 4, // [-a-zA-Z$._0-9]
+  CharKeyword    = 8  // [a-zA-Z0-9_]
+};
+} // end anonymous namespace
+
+static const uint8_t CharTraits[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  1,  0,  0,  1,  0,  0,  // 0x00
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0x10
+     1,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  0,  0,  4,  4,  0,  // 0x20
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14,  0,  0,  0,  0,  0,  0,  // 0x30
+     0, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,  // 0x40
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,  0,  0,  0,  0, 12,  // 0x50
+     0, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,  // 0x60
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,  0,  0,  0,  0,  0,  // 0x70
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0x80
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0x90
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0xa0
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0xb0
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0xc0
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0xd0
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0xe0
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0   // 0xf0
+};
+
+static uint8_t charTraits(char C) {
+  return CharTraits[static_cast<unsigned char>(C)];
+}
+
 /// isLabelChar - Return true for [-a-zA-Z$._0-9].
 static bool isLabelChar(char C) {
-  return isalnum(static_cast<unsigned char>(C)) || C == '-' || C == '$' ||
-         C == '.' || C == '_';
+  return (charTraits(C) & CharLabel) != 0;
 }
 
 
 /// isLabelTail - Return true if this pointer points to a valid end of a label.
 static const char *isLabelTail(const char *CurPtr) {
-  while (1) {
-    if (CurPtr[0] == ':') return CurPtr+1;
-    if (!isLabelChar(CurPtr[0])) return nullptr;
+  while (charTraits(CurPtr[0]) & CharLabel)
     ++CurPtr;
-  }
+  return CurPtr[0] == ':' ? CurPtr + 1 : nullptr;
 }
 
 
@@ -187,6 +219,10 @@ int LLLexer::getNextChar() {
 
 
 lltok::Kind LLLexer::LexToken() {
+  // Skip runs of whitespace in one tight loop; the switch below still
+  // handles interior nul characters and the end of the buffer.
+  while (charTraits(CurPtr[0]) & CharWhitespace)
+    ++CurPtr;
   TokStart = CurPtr;
 
   int CurChar = getNextChar();
@@ -246,10 +282,8 @@ lltok::Kind LLLexer::LexToken() {
 }
 
 void LLLexer::SkipLineComment() {
-  while (1) {
-    if (CurPtr[0] == '\n' || CurPtr[0] == '\r' || getNextChar() == EOF)
-      return;
-  }
+  while (CurPtr != CurBuf.end() && CurPtr[0] != '\n' && CurPtr[0] != '\r')
+    ++CurPtr;
 }
 
 /// LexAt - Lex all tokens that start with an @ character:
@@ -271,23 +305,21 @@ lltok::Kind LLLexer::LexDollar() {
   if (CurPtr[0] == '"') {
     ++CurPtr;
 
-    while (1) {
-      int CurChar = getNextChar();
-
-      if (CurChar == EOF) {
-        Error("end of file in COMDAT variable name");
-        return lltok::Error;
-      }
-      if (CurChar == '"') {
-        StrVal.assign(TokStart + 2, CurPtr - 1);
-        UnEscapeLexed(StrVal);
-        if (StringRef(StrVal).find_first_of(0) != StringRef::npos) {
-          Error("Null bytes are not allowed in names");
-          return lltok::Error;
-        }
-        return lltok::ComdatVar;
-      }
+    const char *Quote = static_cast<const char *>(
+        memchr(CurPtr, '"', CurBuf.end() - CurPtr));
+    if (!Quote) {
+      CurPtr = CurBuf.end();
+      Error("end of file in COMDAT variable name");
+      return lltok::Error;
     }
+    CurPtr = Quote + 1;
+    StrVal.assign(TokStart + 2, CurPtr - 1);
+    UnEscapeLexed(StrVal);
+    if (StringRef(StrVal).find_first_of(0) != StringRef::npos) {
+      Error("Null bytes are not allowed in names");
+      return lltok::Error;
+    }
+    return lltok::ComdatVar;
   }
 
   // Handle ComdatVarName: $[-a-zA-Z$._][-a-zA-Z$._0-9]*
@@ -300,31 +332,26 @@ lltok::Kind LLLexer::LexDollar() {
 /// ReadString - Read a string until the closing quote.
 lltok::Kind LLLexer::ReadString(lltok::Kind kind) {
   const char *Start = CurPtr;
-  while (1) {
-    int CurChar = getNextChar();
-
-    if (CurChar == EOF) {
-      Error("end of file in string constant");
-      return lltok::Error;
-    }
-    if (CurChar == '"') {
-      StrVal.assign(Start, CurPtr-1);
-      UnEscapeLexed(StrVal);
-      return kind;
-    }
+  const char *Quote = static_cast<const char *>(
+      memchr(CurPtr, '"', CurBuf.end() - CurPtr));
+  if (!Quote) {
+    CurPtr = CurBuf.end();
+    Error("end of file in string constant");
+    return lltok::Error;
   }
+  CurPtr = Quote + 1;
+  StrVal.assign(Start, CurPtr-1);
+  UnEscapeLexed(StrVal);
+  return kind;
 }
 
 /// ReadVarName - Read the rest of a token containing a variable name.
 bool LLLexer::ReadVarName() {
   const char *NameStart = CurPtr;
-  if (isalpha(static_cast<unsigned char>(CurPtr[0])) ||
-      CurPtr[0] == '-' || CurPtr[0] == '$' ||
-      CurPtr[0] == '.' || CurPtr[0] == '_') {
+  uint8_t Traits = charTraits(CurPtr[0]);
+  if ((Traits & CharLabel) && !(Traits & CharDigit)) {
     ++CurPtr;
-    while (isalnum(static_cast<unsigned char>(CurPtr[0])) ||
-           CurPtr[0] == '-' || CurPtr[0] == '$' ||
-           CurPtr[0] == '.' || CurPtr[0] == '_')
+    while (charTraits(CurPtr[0]) & CharLabel)
       ++CurPtr;
 
     StrVal.assign(NameStart, CurPtr);
@@ -338,23 +365,21 @@ lltok::Kind LLLexer::LexVar(lltok::Kind Var, lltok::Kind VarID) {
   if (CurPtr[0] == '"') {
     ++CurPtr;
 
-    while (1) {
-      int CurChar = getNextChar();
-
-      if (CurChar == EOF) {
-        Error("end of file in global variable name");
-        return lltok::Error;
-      }
-      if (CurChar == '"') {
-        StrVal.assign(TokStart+2, CurPtr-1);
-        UnEscapeLexed(StrVal);
-        if (StringRef(StrVal).find_first_of(0) != StringRef::npos) {
-          Error("Null bytes are not allowed in names");
-          return lltok::Error;
-        }
-        return Var;
-      }
+    const char *Quote = static_cast<const char *>(
+        memchr(CurPtr, '"', CurBuf.end() - CurPtr));
+    if (!Quote) {
+      CurPtr = CurBuf.end();
+      Error("end of file in global variable name");
+      return lltok::Error;
     }
+    CurPtr = Quote + 1;
+    StrVal.assign(TokStart+2, CurPtr-1);
+    UnEscapeLexed(StrVal);
+    if (StringRef(StrVal).find_first_of(0) != StringRef::npos) {
+      Error("Null bytes are not allowed in names");
+      return lltok::Error;
+    }
+    return Var;
   }
 
   // Handle VarName: [-a-zA-Z$._][-a-zA-Z$._0-9]*
@@ -362,8 +387,8 @@ lltok::Kind LLLexer::LexVar(lltok::Kind Var, lltok::Kind VarID) {
     return Var;
 
   // Handle VarID: [0-9]+
-  if (isdigit(static_cast<unsigned char>(CurPtr[0]))) {
-    for (++CurPtr; isdigit(static_cast<unsigned char>(CurPtr[0])); ++CurPtr)
+  if (charTraits(CurPtr[0]) & CharDigit) {
+    for (++CurPtr; charTraits(CurPtr[0]) & CharDigit; ++CurPtr)
       /*empty*/;
 
     uint64_t Val = atoull(TokStart+1, CurPtr);
@@ -453,12 +478,11 @@ lltok::Kind LLLexer::LexIdentifier() {
   const char *IntEnd = CurPtr[-1] == 'i' ? nullptr : StartChar;
   const char *KeywordEnd = nullptr;
 
-  for (; isLabelChar(*CurPtr); ++CurPtr) {
+  for (uint8_t Traits; (Traits = charTraits(*CurPtr)) & CharLabel; ++CurPtr) {
     // If we decide this is an integer, remember the end of the sequence.
-    if (!IntEnd && !isdigit(static_cast<unsigned char>(*CurPtr)))
+    if (!IntEnd && !(Traits & CharDigit))
       IntEnd = CurPtr;
-    if (!KeywordEnd && !isalnum(static_cast<unsigned char>(*CurPtr)) &&
-        *CurPtr != '_')
+    if (!KeywordEnd && !(Traits & CharKeyword))
       KeywordEnd = CurPtr;
   }
 
@@ -869,8 +893,8 @@ lltok::Kind LLLexer::Lex0x() {
 ///    HexPPC128Constant 0xM[0-9A-Fa-f]+
 lltok::Kind LLLexer::LexDigitOrNegative() {
   // If the letter after the negative is not a number, this is probably a label.
-  if (!isdigit(static_cast<unsigned char>(TokStart[0])) &&
-      !isdigit(static_cast<unsigned char>(CurPtr[0]))) {
+  if (!(charTraits(TokStart[0]) & CharDigit) &&
+      !(charTraits(CurPtr[0]) & CharDigit)) {
     // Okay, this is not a number after the -, it's probably a label.
     if (const char *End = isLabelTail(CurPtr)) {
       StrVal.assign(TokStart, End-1);
@@ -884,7 +908,7 @@ lltok::Kind LLLexer::LexDigitOrNegative() {
   // At this point, it is either a label, int or fp constant.
 
   // Skip digits, we have at least one.
-  for (; isdigit(static_cast<unsigned char>(CurPtr[0])); ++CurPtr)
+  for (; charTraits(CurPtr[0]) & CharDigit; ++CurPtr)
     /*empty*/;
 
   // Check to see if this really is a label afterall, e.g. "-1:".
@@ -921,14 +945,14 @@ lltok::Kind LLLexer::LexDigitOrNegative() {
   ++CurPtr;
 
   // Skip over [0-9]*([eE][-+]?[0-9]+)?
-  while (isdigit(static_cast<unsigned char>(CurPtr[0]))) ++CurPtr;
+  while (charTraits(CurPtr[0]) & CharDigit) ++CurPtr;
 
   if (CurPtr[0] == 'e' || CurPtr[0] == 'E') {
-    if (isdigit(static_cast<unsigned char>(CurPtr[1])) ||
+    if ((charTraits(CurPtr[1]) & CharDigit) ||
         ((CurPtr[1] == '-' || CurPtr[1] == '+') &&
-          isdigit(static_cast<unsigned char>(CurPtr[2])))) {
+          (charTraits(CurPtr[2]) & CharDigit))) {
       CurPtr += 2;
-      while (isdigit(static_cast<unsigned char>(CurPtr[0]))) ++CurPtr;
+      while (charTraits(CurPtr[0]) & CharDigit) ++CurPtr;
     }
   }
 
@@ -940,11 +964,11 @@ lltok::Kind LLLexer::LexDigitOrNegative() {
 lltok::Kind LLLexer::LexPositive() {
   // If the letter after the negative is a number, this is probably not a
   // label.
-  if (!isdigit(static_cast<unsigned char>(CurPtr[0])))
+  if (!(charTraits(CurPtr[0]) & CharDigit))
     return lltok::Error;
 
   // Skip digits.
-  for (++CurPtr; isdigit(static_cast<unsigned char>(CurPtr[0])); ++CurPtr)
+  for (++CurPtr; charTraits(CurPtr[0]) & CharDigit; ++CurPtr)
     /*empty*/;
 
   // At this point, we need a '.'.
@@ -956,14 +980,14 @@ lltok::Kind LLLexer::LexPositive() {
   ++CurPtr;
 
   // Skip over [0-9]*([eE][-+]?[0-9]+)?
-  while (isdigit(static_cast<unsigned char>(CurPtr[0]))) ++CurPtr;
+  while (charTraits(CurPtr[0]) & CharDigit) ++CurPtr;
 
   if (CurPtr[0] == 'e' || CurPtr[0] == 'E') {
-    if (isdigit(static_cast<unsigned char>(CurPtr[1])) ||
+    if ((charTraits(CurPtr[1]) & CharDigit) ||
         ((CurPtr[1] == '-' || CurPtr[1] == '+') &&
-        isdigit(static_cast<unsigned char>(CurPtr[2])))) {
+        (charTraits(CurPtr[2]) & CharDigit))) {
       CurPtr += 2;
-      while (isdigit(static_cast<unsigned char>(CurPtr[0]))) ++CurPtr;
+      while (charTraits(CurPtr[0]) & CharDigit) ++CurPtr;
     }
   }
 
@@ -13,6 +13,7 @@
 
 #include "LLParser.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/IR/AutoUpgrade.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Constants.h"
@@ -27,7 +28,9 @@
 #include "llvm/IR/ValueSymbolTable.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
@@ -363,11 +366,350 @@ bool LLParser::ParseDeclare() {
 ///   ::= 'define' FunctionHeader '{' ...
 bool LLParser::ParseDefine() {
   assert(Lex.getKind() == lltok::kw_define);
+
+  if (FnCache) {
+    bool Handled = false;
+    if (ParseCachedDefine(Handled))
+      return true;
+    if (Handled)
+      return false;
+  }
+
   Lex.Lex();
 
   Function *F;
-  return ParseFunctionHeader(F, true) ||
-         ParseFunctionBody(*F);
+  if (ParseFunctionHeader(F, true) || ParseFunctionBody(*F))
+    return true;
+
+  if (FnCache && !PendingCacheKey.empty()) {
+    FnCache->insert(PendingCacheKey, F);
+    PendingCacheKey.clear();
+  }
+
+  // Hand the finished function to a streaming client before parsing the rest
+  // of the input, so it can release the body if it needs bounded memory.
+  if (FunctionCallback)
+    FunctionCallback(*F);
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// Function definition caching.
+//===----------------------------------------------------------------------===//
+
+FunctionParseCache::FunctionParseCache(LLVMContext &Context)
+    : CacheModule(new Module("llparser.function.cache", Context)) {}
+
+FunctionParseCache::~FunctionParseCache() {}
+
+LLVMContext &FunctionParseCache::getContext() const {
+  return CacheModule->getContext();
+}
+
+Function *FunctionParseCache::lookup(StringRef Key) const {
+  return Entries.lookup(Key);
+}
+
+/// Returns true if Ty transitively involves an identified struct type. The
+/// same definition text can resolve such types differently in different
+/// modules, so functions touching them are never cached.
+static bool typeContainsNamedStruct(Type *Ty, SmallPtrSetImpl<Type *> &Visited) {
+  if (!Visited.insert(Ty).second)
+    return false;
+  if (StructType *STy = dyn_cast<StructType>(Ty))
+    if (STy->hasName())
+      return true;
+  for (Type *SubTy : Ty->subtypes())
+    if (typeContainsNamedStruct(SubTy, Visited))
+      return true;
+  return false;
+}
+
+/// Collect the global values referenced by the constant C. Returns false when
+/// C makes the containing function uncacheable.
+static bool findConstantRefs(Constant *C, SmallPtrSetImpl<GlobalValue *> &Refs,
+                             SmallPtrSetImpl<Constant *> &Visited) {
+  if (!Visited.insert(C).second)
+    return true;
+  if (isa<BlockAddress>(C))
+    return false;
+  if (GlobalValue *GV = dyn_cast<GlobalValue>(C)) {
+    Refs.insert(GV);
+    return true;
+  }
+  for (User::op_iterator OI = C->op_begin(), OE = C->op_end(); OI != OE; ++OI)
+    if (Constant *OpC = dyn_cast<Constant>(*OI))
+      if (!findConstantRefs(OpC, Refs, Visited))
+        return false;
+  return true;
+}
+
+/// Collect every global value referenced by F's body. Returns false when the
+/// body is not self-contained enough to cache.
+static bool findFunctionRefs(const Function &F,
+                             SmallPtrSetImpl<GlobalValue *> &Refs) {
+  SmallPtrSet<Constant *, 16> ConstVisited;
+  SmallPtrSet<Type *, 16> TyVisited;
+  if (typeContainsNamedStruct(F.getFunctionType(), TyVisited))
+    return false;
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB)
+    for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE;
+         ++I) {
+      if (I->hasMetadata())
+        return false;
+      if (typeContainsNamedStruct(I->getType(), TyVisited))
+        return false;
+      for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+        Value *Op = I->getOperand(i);
+        if (isa<MetadataAsValue>(Op))
+          return false;
+        if (typeContainsNamedStruct(Op->getType(), TyVisited))
+          return false;
+        if (Constant *C = dyn_cast<Constant>(Op))
+          if (!findConstantRefs(C, Refs, ConstVisited))
+            return false;
+      }
+    }
+  return true;
+}
+
+/// Rebuild the constant C with any global values it involves replaced
+/// according to GVMap. Constants not touching a mapped global are shared.
+static Constant *remapConstant(Constant *C,
+                               const DenseMap<GlobalValue *, Constant *> &GVMap) {
+  if (GlobalValue *GV = dyn_cast<GlobalValue>(C)) {
+    DenseMap<GlobalValue *, Constant *>::const_iterator I = GVMap.find(GV);
+    return I != GVMap.end() ? I->second : C;
+  }
+  if (C->getNumOperands() == 0)
+    return C;
+  SmallVector<Constant *, 8> Ops;
+  bool Changed = false;
+  for (User::op_iterator OI = C->op_begin(), OE = C->op_end(); OI != OE; ++OI) {
+    Constant *Op = cast<Constant>(*OI);
+    Constant *NewOp = remapConstant(Op, GVMap);
+    Changed |= NewOp != Op;
+    Ops.push_back(NewOp);
+  }
+  if (!Changed)
+    return C;
+  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(C))
+    return CE->getWithOperands(Ops);
+  if (isa<ConstantStruct>(C))
+    return ConstantStruct::get(cast<StructType>(C->getType()), Ops);
+  if (isa<ConstantArray>(C))
+    return ConstantArray::get(cast<ArrayType>(C->getType()), Ops);
+  assert(isa<ConstantVector>(C) && "Unexpected constant with operands");
+  return ConstantVector::get(Ops);
+}
+
+/// Copy OldF's body into the empty function NewF, rewriting references to
+/// global values according to GVMap. Both functions must be in the same
+/// context, and the body must have passed findFunctionRefs.
+static void copyFunctionBody(Function *NewF, const Function *OldF,
+                             const DenseMap<GlobalValue *, Constant *> &GVMap) {
+  DenseMap<const Value *, Value *> VMap;
+  Function::arg_iterator NAI = NewF->arg_begin();
+  for (Function::const_arg_iterator AI = OldF->arg_begin(),
+       AE = OldF->arg_end(); AI != AE; ++AI, ++NAI) {
+    NAI->setName(AI->getName());
+    VMap[AI] = NAI;
+  }
+
+  for (Function::const_iterator BB = OldF->begin(), BE = OldF->end(); BB != BE;
+       ++BB) {
+    BasicBlock *NBB = BasicBlock::Create(NewF->getContext(), BB->getName(),
+                                         NewF);
+    VMap[BB] = NBB;
+    for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE;
+         ++I) {
+      Instruction *NI = I->clone();
+      NI->setName(I->getName());
+      NBB->getInstList().push_back(NI);
+      VMap[I] = NI;
+    }
+  }
+
+  // The clones still refer to the original's values; rewrite the operands.
+  for (Function::iterator BB = NewF->begin(), BE = NewF->end(); BB != BE; ++BB)
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I)
+      for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+        Value *Op = I->getOperand(i);
+        DenseMap<const Value *, Value *>::iterator VI = VMap.find(Op);
+        if (VI != VMap.end()) {
+          I->setOperand(i, VI->second);
+          continue;
+        }
+        if (Constant *C = dyn_cast<Constant>(Op))
+          I->setOperand(i, remapConstant(C, GVMap));
+      }
+}
+
+void FunctionParseCache::insert(StringRef Key, const Function *F) {
+  if (Entries.count(Key))
+    return;
+  // Prefix and prologue data defeat the brace matching used to find the
+  // definition's extent, and comdats are module state; see also the
+  // restrictions enforced while scanning for the key.
+  if (F->hasPrefixData() || F->hasPrologueData() || F->getComdat())
+    return;
+
+  SmallPtrSet<GlobalValue *, 8> Refs;
+  if (!findFunctionRefs(*F, Refs))
+    return;
+  Refs.erase(const_cast<Function *>(F));
+
+  // Declare (or reuse) each referenced global in the cache module. A name
+  // already present with a different type means two cached bodies disagree
+  // about the global; leave this one uncached.
+  DenseMap<GlobalValue *, Constant *> GVMap;
+  for (SmallPtrSetImpl<GlobalValue *>::iterator RI = Refs.begin(),
+       RE = Refs.end(); RI != RE; ++RI) {
+    GlobalValue *GV = *RI;
+    if (GV->getName().empty())
+      return;
+    if (GlobalValue *Existing = CacheModule->getNamedValue(GV->getName())) {
+      if (Existing->getType() != GV->getType())
+        return;
+      GVMap[GV] = Existing;
+      continue;
+    }
+    if (Function *Fn = dyn_cast<Function>(GV))
+      GVMap[GV] = Function::Create(Fn->getFunctionType(),
+                                   GlobalValue::ExternalLinkage, Fn->getName(),
+                                   CacheModule.get());
+    else if (GlobalVariable *GVar = dyn_cast<GlobalVariable>(GV))
+      GVMap[GV] = new GlobalVariable(
+          *CacheModule, GVar->getType()->getElementType(), GVar->isConstant(),
+          GlobalValue::ExternalLinkage, nullptr, GVar->getName(), nullptr,
+          GVar->getThreadLocalMode(), GVar->getType()->getAddressSpace());
+    else
+      return; // Aliases cannot be redeclared.
+  }
+
+  Function *NewF = Function::Create(F->getFunctionType(), F->getLinkage(),
+                                    F->getName(), CacheModule.get());
+  NewF->copyAttributesFrom(F);
+  GVMap[const_cast<Function *>(F)] = NewF;
+  copyFunctionBody(NewF, F, GVMap);
+  Entries[Key] = NewF;
+}
+
+/// ParseCachedDefine - Called at a 'define' token when a function cache is
+/// attached. Scans ahead for the extent of the definition; on a cache hit
+/// the cached body is copied into the module and the input is skipped, with
+/// Handled set. Otherwise the caller parses the definition normally, and
+/// PendingCacheKey (when non-empty) is the key to record it under. Returns
+/// true only on a hard error.
+bool LLParser::ParseCachedDefine(bool &Handled) {
+  Handled = false;
+  PendingCacheKey.clear();
+
+  const char *Begin = Lex.getLoc().getPointer();
+  StringRef Tail = SourceText.substr(Begin - SourceText.data());
+
+  // Scan ahead with a scratch lexer to find the extent of the definition and
+  // the function's name. Anything surprising just disables caching for this
+  // definition; the real parse will diagnose actual errors.
+  SourceMgr ScanSM;
+  SMDiagnostic ScanErr;
+  ScanSM.AddNewSourceBuffer(MemoryBuffer::getMemBuffer(Tail, "", false),
+                            SMLoc());
+  LLLexer ScanLex(Tail, ScanSM, ScanErr, Context);
+
+  std::string FnName;
+  const char *NameStart = nullptr, *AfterName = nullptr, *End = nullptr;
+  bool PrevWasName = false;
+  unsigned Depth = 0;
+  while (true) {
+    lltok::Kind K = ScanLex.Lex();
+    if (PrevWasName) {
+      AfterName = ScanLex.getLoc().getPointer();
+      PrevWasName = false;
+    }
+    if (K == lltok::Eof || K == lltok::Error)
+      return false;
+    if (K == lltok::AttrGrpID)
+      return false; // Attribute group contents are module state.
+    if ((K == lltok::kw_prefix || K == lltok::kw_prologue) && Depth == 0)
+      return false; // Braced constants in the header defeat extent finding.
+    if (K == lltok::GlobalID && !NameStart)
+      return false; // Unnamed functions renumber per module.
+    if (K == lltok::GlobalVar && !NameStart) {
+      NameStart = ScanLex.getLoc().getPointer();
+      FnName = ScanLex.getStrVal();
+      PrevWasName = true;
+    } else if (K == lltok::lbrace) {
+      ++Depth;
+    } else if (K == lltok::rbrace) {
+      if (Depth == 0)
+        return false;
+      if (--Depth == 0) {
+        ScanLex.Lex();
+        End = ScanLex.getLoc().getPointer();
+        break;
+      }
+    }
+  }
+  if (!NameStart || !AfterName || !End)
+    return false;
+
+  // The key is the definition's text with the function's own name spliced
+  // out, so identical bodies under different names share an entry. It is
+  // whitespace sensitive, which only ever costs a miss.
+  SmallString<256> Key;
+  Key.append(Begin, NameStart);
+  StringRef Rest = StringRef(AfterName, End - AfterName).rtrim();
+  Key.append(Rest.begin(), Rest.end());
+
+  Function *Cached = FnCache->lookup(Key);
+  if (!Cached) {
+    PendingCacheKey = Key.str();
+    return false;
+  }
+
+  // Splice only into a fresh name; redefinitions and bodies for functions
+  // that were already forward referenced take the normal path.
+  if (M->getNamedValue(FnName))
+    return false;
+
+  // Every global the cached body refers to must resolve to the same type
+  // here; otherwise re-parse so the user gets the usual diagnostics.
+  SmallPtrSet<GlobalValue *, 8> Refs;
+  if (!findFunctionRefs(*Cached, Refs))
+    return false;
+  Refs.erase(Cached);
+  for (SmallPtrSetImpl<GlobalValue *>::iterator RI = Refs.begin(),
+       RE = Refs.end(); RI != RE; ++RI)
+    if (GlobalValue *Existing = M->getNamedValue((*RI)->getName()))
+      if (Existing->getType() != (*RI)->getType())
+        return false;
+
+  LocTy DefineLoc = Lex.getLoc();
+  DenseMap<GlobalValue *, Constant *> GVMap;
+  for (SmallPtrSetImpl<GlobalValue *>::iterator RI = Refs.begin(),
+       RE = Refs.end(); RI != RE; ++RI) {
+    GlobalValue *Mapped =
+        GetGlobalVal((*RI)->getName().str(), (*RI)->getType(), DefineLoc);
+    if (!Mapped)
+      return true;
+    GVMap[*RI] = Mapped;
+  }
+
+  Function *NewF = Function::Create(Cached->getFunctionType(),
+                                    Cached->getLinkage(), FnName, M);
+  NewF->copyAttributesFrom(Cached);
+  GVMap[Cached] = NewF;
+  copyFunctionBody(NewF, Cached, GVMap);
+
+  // Advance the real lexer past the definition we just spliced in.
+  while (Lex.getLoc().getPointer() < End)
+    Lex.Lex();
+
+  if (FunctionCallback)
+    FunctionCallback(*NewF);
+  Handled = true;
+  return false;
 }
 
 /// ParseGlobalType
@@ -17,12 +17,14 @@
 #include "LLLexer.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/ValueHandle.h"
+#include <functional>
 #include <map>
 
 namespace llvm {
@@ -134,10 +136,27 @@ namespace llvm {
     std::map<Value*, std::vector<unsigned> > ForwardRefAttrGroups;
     std::map<unsigned, AttrBuilder> NumberedAttrBuilders;
 
+    /// If non-null, called as each function definition completes.
+    std::function<void(Function &)> FunctionCallback;
+
+    /// If non-null, previously parsed function definitions are reused rather
+    /// than re-parsed; see FunctionParseCache.
+    FunctionParseCache *FnCache;
+    /// The complete input text; needed to scan ahead for cache keys.
+    StringRef SourceText;
+    /// The cache key for the definition being parsed, when it is cacheable.
+    std::string PendingCacheKey;
+
   public:
-    LLParser(StringRef F, SourceMgr &SM, SMDiagnostic &Err, Module *m)
+    LLParser(StringRef F, SourceMgr &SM, SMDiagnostic &Err, Module *m,
+             std::function<void(Function &)> Callback = nullptr,
+             FunctionParseCache *Cache = nullptr)
         : Context(m->getContext()), Lex(F, SM, Err, m->getContext()), M(m),
-          BlockAddressPFS(nullptr) {}
+          BlockAddressPFS(nullptr), FunctionCallback(std::move(Callback)),
+          FnCache(Cache), SourceText(F) {
+      assert((!Cache || &Cache->getContext() == &m->getContext()) &&
+             "Function cache must use the module's context");
+    }
     bool Run();
 
     LLVMContext &getContext() { return Context; }
@@ -249,6 +268,7 @@ namespace llvm {
     bool ParseNamedType();
     bool ParseDeclare();
     bool ParseDefine();
+    bool ParseCachedDefine(bool &Handled);
 
     bool ParseGlobalType(bool &IsConstant);
     bool ParseUnnamedGlobal();
@@ -24,7 +24,9 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/OperandTraits.h"
 #include "llvm/IR/Operator.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/DataStream.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -80,16 +82,16 @@ BitcodeReader::BitcodeReader(MemoryBuffer *buffer, LLVMContext &C,
     : Context(C), DiagnosticHandler(getDiagHandler(DiagnosticHandler, C)),
       TheModule(nullptr), Buffer(buffer), LazyStreamer(nullptr),
       NextUnreadBit(0), SeenValueSymbolTable(false), ValueList(C),
-      MDValueList(C), SeenFirstFunctionBody(false), UseRelativeIDs(false),
-      WillMaterializeAllForwardRefs(false) {}
+      MDValueList(C), SeenFirstFunctionBody(false), FunctionIndexEndBit(0),
+      UseRelativeIDs(false), WillMaterializeAllForwardRefs(false) {}
 
 BitcodeReader::BitcodeReader(DataStreamer *streamer, LLVMContext &C,
                              DiagnosticHandlerFunction DiagnosticHandler)
     : Context(C), DiagnosticHandler(getDiagHandler(DiagnosticHandler, C)),
       TheModule(nullptr), Buffer(nullptr), LazyStreamer(streamer),
       NextUnreadBit(0), SeenValueSymbolTable(false), ValueList(C),
-      MDValueList(C), SeenFirstFunctionBody(false), UseRelativeIDs(false),
-      WillMaterializeAllForwardRefs(false) {}
+      MDValueList(C), SeenFirstFunctionBody(false), FunctionIndexEndBit(0),
+      UseRelativeIDs(false), WillMaterializeAllForwardRefs(false) {}
 
 std::error_code BitcodeReader::materializeForwardReferencedFunctions() {
   if (WillMaterializeAllForwardRefs)
@@ -2170,6 +2172,45 @@ std::error_code BitcodeReader::ParseConstants() {
   }
 }
 
+std::error_code BitcodeReader::ParseFunctionOffsetIndex() {
+  if (Stream.EnterSubBlock(bitc::FUNCTION_INDEX_BLOCK_ID))
+    return Error("Invalid record");
+
+  // Read all the records.
+  SmallVector<uint64_t, 64> Record;
+  while (1) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return Error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      return std::error_code();
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    // Read an index record.
+    Record.clear();
+    switch (Stream.readRecord(Entry.ID, Record)) {
+    default: // Default behavior: unknown type.
+      break;
+    case bitc::FNINDEX_CODE_ENTRY:
+      if (Record.size() < 2)
+        return Error("Invalid record");
+      FunctionIndexOffsets.push_back(Record[0] | (Record[1] << 32));
+      break;
+    case bitc::FNINDEX_CODE_END:
+      if (Record.size() < 2)
+        return Error("Invalid record");
+      FunctionIndexEndBit = Record[0] | (Record[1] << 32);
+      break;
+    }
+  }
+}
+
 std::error_code BitcodeReader::ParseUseLists() {
   if (Stream.EnterSubBlock(bitc::USELIST_BLOCK_ID))
     return Error("Invalid record");
@@ -2351,6 +2392,24 @@ std::error_code BitcodeReader::ParseModule(bool Resume) {
           SeenFirstFunctionBody = true;
         }
 
+        // If the module carries a complete function offset index, every
+        // remaining body position is already known: record them all and jump
+        // over the bodies without touching their pages. The streaming reader
+        // must keep its sequential scan, since its resume logic assumes
+        // bodies are parsed in stream order.
+        if (!LazyStreamer && FunctionIndexEndBit &&
+            FunctionIndexOffsets.size() == FunctionsWithBodies.size()) {
+          // FunctionsWithBodies was reversed above; the index is in module
+          // order.
+          size_t e = FunctionIndexOffsets.size();
+          for (size_t i = 0; i != e; ++i)
+            DeferredFunctionInfo[FunctionsWithBodies[e - i - 1]] =
+                FunctionIndexOffsets[i];
+          FunctionsWithBodies.clear();
+          Stream.JumpToBit(FunctionIndexEndBit);
+          continue;
+        }
+
         if (std::error_code EC = RememberAndSkipFunctionBody())
           return EC;
         // For streaming bitcode, suspend parsing when we reach the function
@@ -2368,6 +2427,10 @@ std::error_code BitcodeReader::ParseModule(bool Resume) {
         if (std::error_code EC = ParseUseLists())
           return EC;
         break;
+      case bitc::FUNCTION_INDEX_BLOCK_ID:
+        if (std::error_code EC = ParseFunctionOffsetIndex())
+          return EC;
+        break;
       }
       continue;
 
@@ -2914,6 +2977,10 @@ std::error_code BitcodeReader::ParseFunctionBody(Function *F) {
         if (std::error_code EC = ParseUseLists())
           return EC;
         break;
+      case bitc::FUNCTION_INDEX_BLOCK_ID:
+        if (std::error_code EC = ParseFunctionOffsetIndex())
+          return EC;
+        break;
       }
       continue;
 
@@ -3927,6 +3994,46 @@ std::error_code BitcodeReader::materialize(GlobalValue *GV) {
   return materializeForwardReferencedFunctions();
 }
 
+std::error_code BitcodeReader::materializeClosure(Function &F, unsigned Depth) {
+  if (std::error_code EC = materialize(&F))
+    return EC;
+
+  // Expand the static call graph one level at a time. The callee set of each
+  // level is known once its callers' bodies are read; sorting a level by
+  // stream offset before decoding turns the per-callee seeks into a single
+  // forward sweep over the function block.
+  SmallVector<Function *, 16> Frontier(1, &F);
+  SmallPtrSet<Function *, 16> Visited;
+  Visited.insert(&F);
+  while (Depth-- && !Frontier.empty()) {
+    SmallVector<std::pair<uint64_t, Function *>, 16> Level;
+    for (Function *Caller : Frontier)
+      for (const BasicBlock &BB : *Caller)
+        for (const Instruction &I : BB) {
+          Function *Callee = nullptr;
+          if (const CallInst *CI = dyn_cast<CallInst>(&I))
+            Callee = CI->getCalledFunction();
+          else if (const InvokeInst *II = dyn_cast<InvokeInst>(&I))
+            Callee = II->getCalledFunction();
+          if (!Callee || !Callee->isMaterializable())
+            continue;
+          if (!Visited.insert(Callee).second)
+            continue;
+          Level.push_back(
+              std::make_pair(DeferredFunctionInfo.lookup(Callee), Callee));
+        }
+
+    std::sort(Level.begin(), Level.end());
+    Frontier.clear();
+    for (unsigned i = 0, e = Level.size(); i != e; ++i) {
+      if (std::error_code EC = materialize(Level[i].second))
+        return EC;
+      Frontier.push_back(Level[i].second);
+    }
+  }
+  return std::error_code();
+}
+
 bool BitcodeReader::isDematerializable(const GlobalValue *GV) const {
   const Function *F = dyn_cast<Function>(GV);
   if (!F || F->isDeclaration())
@@ -4048,6 +4155,11 @@ std::error_code BitcodeReader::InitLazyStream() {
   if (!isBitcode(buf, buf + 16))
     return Error("Invalid bitcode signature");
 
+  // Compressed containers need random access to the whole buffer and cannot
+  // be decompressed incrementally from a stream.
+  if (isCompressedBitcode(buf, buf + 16))
+    return Error("Compressed bitcode cannot be streamed");
+
   if (isBitcodeWrapper(buf, buf + 4)) {
     const unsigned char *bitcodeStart = buf;
     const unsigned char *bitcodeEnd = buf + 16;
@@ -4086,6 +4198,50 @@ const std::error_category &llvm::BitcodeErrorCategory() {
 // External interface
 //===----------------------------------------------------------------------===//
 
+/// \brief Decompress a compressed bitcode container.
+///
+/// Expands a container recognized by \a isCompressedBitcode() into a
+/// heap-allocated buffer holding the plain bitcode stream it wraps.
+static ErrorOr<std::unique_ptr<MemoryBuffer>>
+decompressBitcode(MemoryBufferRef Buffer,
+                  DiagnosticHandlerFunction DiagnosticHandler) {
+  enum {
+    KnownHeaderSize = 3 * 4, // Magic, Version, UncompressedSize.
+    VersionField = 1 * 4,
+    SizeField = 2 * 4
+  };
+
+  StringRef Data = Buffer.getBuffer();
+  if (Data.size() < KnownHeaderSize)
+    return Error(DiagnosticHandler,
+                 make_error_code(BitcodeError::CorruptedBitcode),
+                 "Truncated compressed bitcode header");
+  if (!zlib::isAvailable())
+    return Error(DiagnosticHandler,
+                 make_error_code(BitcodeError::CorruptedBitcode),
+                 "Compressed bitcode needs zlib, which is not available");
+  if (support::endian::read<uint32_t, support::little, support::unaligned>(
+          Data.data() + VersionField) != 0)
+    return Error(DiagnosticHandler,
+                 make_error_code(BitcodeError::CorruptedBitcode),
+                 "Unsupported compressed bitcode version");
+
+  size_t UncompressedSize =
+      support::endian::read<uint32_t, support::little, support::unaligned>(
+          Data.data() + SizeField);
+  std::unique_ptr<MemoryBuffer> Result = MemoryBuffer::getNewUninitMemBuffer(
+      UncompressedSize, Buffer.getBufferIdentifier());
+  size_t Size = UncompressedSize;
+  if (zlib::uncompress(Data.substr(KnownHeaderSize),
+                       const_cast<char *>(Result->getBufferStart()),
+                       Size) != zlib::StatusOK ||
+      Size != UncompressedSize)
+    return Error(DiagnosticHandler,
+                 make_error_code(BitcodeError::CorruptedBitcode),
+                 "Malformed compressed bitcode stream");
+  return std::move(Result);
+}
+
 /// \brief Get a lazy one-at-time loading module from bitcode.
 ///
 /// This isn't always used in a lazy context.  In particular, it's also used by
@@ -4098,9 +4254,23 @@ static ErrorOr<Module *>
 getLazyBitcodeModuleImpl(std::unique_ptr<MemoryBuffer> &&Buffer,
                          LLVMContext &Context, bool WillMaterializeAll,
                          DiagnosticHandlerFunction DiagnosticHandler) {
-  Module *M = new Module(Buffer->getBufferIdentifier(), Context);
-  BitcodeReader *R =
-      new BitcodeReader(Buffer.get(), Context, DiagnosticHandler);
+  // Transparently unpack compressed bitcode containers. The container is only
+  // released on success; until then the caller keeps ownership of Buffer.
+  std::unique_ptr<MemoryBuffer> Decompressed;
+  MemoryBuffer *Buf = Buffer.get();
+  if (isCompressedBitcode((const unsigned char *)Buf->getBufferStart(),
+                          (const unsigned char *)Buf->getBufferEnd())) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> DecompressedOrErr =
+        decompressBitcode(Buf->getMemBufferRef(),
+                          getDiagHandler(DiagnosticHandler, Context));
+    if (std::error_code EC = DecompressedOrErr.getError())
+      return EC;
+    Decompressed = std::move(*DecompressedOrErr);
+    Buf = Decompressed.get();
+  }
+
+  Module *M = new Module(Buf->getBufferIdentifier(), Context);
+  BitcodeReader *R = new BitcodeReader(Buf, Context, DiagnosticHandler);
   M->setMaterializer(R);
 
   auto cleanupOnError = [&](std::error_code EC) {
@@ -4117,7 +4287,14 @@ getLazyBitcodeModuleImpl(std::unique_ptr<MemoryBuffer> &&Buffer,
     if (std::error_code EC = R->materializeForwardReferencedFunctions())
       return cleanupOnError(EC);
 
-  Buffer.release(); // The BitcodeReader owns it now.
+  if (Decompressed) {
+    // The reader parses from the decompressed copy; the container itself is
+    // no longer needed.
+    Decompressed.release(); // The BitcodeReader owns it now.
+    Buffer.reset();
+  } else {
+    Buffer.release(); // The BitcodeReader owns it now.
+  }
   return M;
 }
 
@@ -4166,6 +4343,14 @@ std::string
 llvm::getBitcodeTargetTriple(MemoryBufferRef Buffer, LLVMContext &Context,
                              DiagnosticHandlerFunction DiagnosticHandler) {
   std::unique_ptr<MemoryBuffer> Buf = MemoryBuffer::getMemBuffer(Buffer, false);
+  if (isCompressedBitcode((const unsigned char *)Buf->getBufferStart(),
+                          (const unsigned char *)Buf->getBufferEnd())) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> DecompressedOrErr =
+        decompressBitcode(Buffer, getDiagHandler(DiagnosticHandler, Context));
+    if (!DecompressedOrErr)
+      return "";
+    Buf = std::move(*DecompressedOrErr);
+  }
   auto R = llvm::make_unique<BitcodeReader>(Buf.release(), Context,
                                             DiagnosticHandler);
   ErrorOr<std::string> Triple = R->parseTriple();
@@ -4173,3 +4358,119 @@ llvm::getBitcodeTargetTriple(MemoryBufferRef Buffer, LLVMContext &Context,
     return "";
   return Triple.get();
 }
+
+ErrorOr<bool>
+llvm::readBitcodeSymbols(MemoryBufferRef Buffer,
+                         std::vector<BitcodeSymbol> &Symbols,
+                         DiagnosticHandlerFunction DiagnosticHandler) {
+  if (!DiagnosticHandler)
+    DiagnosticHandler = [](const DiagnosticInfo &) {};
+
+  std::unique_ptr<MemoryBuffer> Decompressed;
+  const unsigned char *BufPtr = (const unsigned char *)Buffer.getBufferStart();
+  const unsigned char *BufEnd = BufPtr + Buffer.getBufferSize();
+  if (isCompressedBitcode(BufPtr, BufEnd)) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> DecompressedOrErr =
+        decompressBitcode(Buffer, DiagnosticHandler);
+    if (std::error_code EC = DecompressedOrErr.getError())
+      return EC;
+    Decompressed = std::move(*DecompressedOrErr);
+    BufPtr = (const unsigned char *)Decompressed->getBufferStart();
+    BufEnd = (const unsigned char *)Decompressed->getBufferEnd();
+  }
+  if (isBitcodeWrapper(BufPtr, BufEnd))
+    if (SkipBitcodeWrapperHeader(BufPtr, BufEnd, true))
+      return Error(DiagnosticHandler,
+                   make_error_code(BitcodeError::CorruptedBitcode),
+                   "Invalid bitcode wrapper header");
+
+  BitstreamReader StreamFile(BufPtr, BufEnd);
+  BitstreamCursor Stream(StreamFile);
+
+  // Sniff for the signature.
+  if (Stream.Read(8) != 'B' ||
+      Stream.Read(8) != 'C' ||
+      Stream.Read(4) != 0x0 ||
+      Stream.Read(4) != 0xC ||
+      Stream.Read(4) != 0xE ||
+      Stream.Read(4) != 0xD)
+    return Error(DiagnosticHandler,
+                 make_error_code(BitcodeError::InvalidBitcodeSignature),
+                 "Invalid bitcode signature");
+
+  // Find the symbol table block. It is a top-level block, so the module
+  // block in front of it is skipped in constant time.
+  while (1) {
+    if (Stream.AtEndOfStream())
+      return false;
+
+    BitstreamEntry Entry =
+        Stream.advance(BitstreamCursor::AF_DontAutoprocessAbbrevs);
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      return Error(DiagnosticHandler,
+                   make_error_code(BitcodeError::CorruptedBitcode),
+                   "Malformed block");
+    case BitstreamEntry::Record:
+      // The top level holds no records, but archive member padding can look
+      // like one; see the matching case in ParseBitcodeInto().
+      return false;
+    case BitstreamEntry::EndBlock:
+      return false;
+    case BitstreamEntry::SubBlock:
+      break;
+    }
+
+    if (Entry.ID == bitc::SYMTAB_BLOCK_ID)
+      break;
+    if (Stream.SkipBlock())
+      return Error(DiagnosticHandler,
+                   make_error_code(BitcodeError::CorruptedBitcode),
+                   "Malformed block");
+  }
+
+  if (Stream.EnterSubBlock(bitc::SYMTAB_BLOCK_ID))
+    return Error(DiagnosticHandler,
+                 make_error_code(BitcodeError::CorruptedBitcode),
+                 "Invalid record");
+
+  // Read all the records.
+  SmallVector<uint64_t, 64> Record;
+  while (1) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return Error(DiagnosticHandler,
+                   make_error_code(BitcodeError::CorruptedBitcode),
+                   "Malformed block");
+    case BitstreamEntry::EndBlock:
+      return true;
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    // Read a symbol record.
+    Record.clear();
+    switch (Stream.readRecord(Entry.ID, Record)) {
+    default: // Default behavior: unknown type.
+      break;
+    case bitc::SYMTAB_CODE_SYMBOL: {
+      if (Record.size() < 3 || Record.size() < 3 + Record[2])
+        return Error(DiagnosticHandler,
+                     make_error_code(BitcodeError::CorruptedBitcode),
+                     "Invalid record");
+      unsigned NameLen = Record[2];
+      Symbols.push_back(BitcodeSymbol());
+      BitcodeSymbol &Sym = Symbols.back();
+      Sym.Flags = Record[0];
+      Sym.Visibility = Record[1];
+      ConvertToString(makeArrayRef(Record).slice(0, 3 + NameLen), 3, Sym.Name);
+      ConvertToString(Record, 3 + NameLen, Sym.ComdatKey);
+      break;
+    }
+    }
+  }
+}
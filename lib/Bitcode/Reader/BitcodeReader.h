@@ -190,6 +190,16 @@ class BitcodeReader : public GVMaterializer {
   /// stream.
   DenseMap<Function*, uint64_t> DeferredFunctionInfo;
 
+  /// Body offsets read from the optional FUNCTION_INDEX block, in module
+  /// order. When present and complete, the initial lazy parse records every
+  /// deferred body position from here and jumps over the bodies instead of
+  /// scanning them.
+  std::vector<uint64_t> FunctionIndexOffsets;
+
+  /// Bit position of the first bit after the last function body, from the
+  /// FUNCTION_INDEX block; zero if no index was seen.
+  uint64_t FunctionIndexEndBit;
+
   /// These are basic blocks forward-referenced by block addresses.  They are
   /// inserted lazily into functions when they're loaded.  The basic block ID is
   /// its index into the vector.
@@ -231,6 +241,7 @@ public:
 
   bool isDematerializable(const GlobalValue *GV) const override;
   std::error_code materialize(GlobalValue *GV) override;
+  std::error_code materializeClosure(Function &F, unsigned Depth) override;
   std::error_code MaterializeModule(Module *M) override;
   std::vector<StructType *> getIdentifiedStructTypes() const override;
   void Dematerialize(GlobalValue *GV) override;
@@ -356,6 +367,7 @@ private:
   std::error_code ParseMetadataAttachment();
   ErrorOr<std::string> parseModuleTriple();
   std::error_code ParseUseLists();
+  std::error_code ParseFunctionOffsetIndex();
   std::error_code InitStream();
   std::error_code InitStreamFromBuffer();
   std::error_code InitLazyStream();
@@ -8,6 +8,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Bitcode/BitstreamReader.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
 
 using namespace llvm;
 
@@ -271,12 +274,74 @@ void BitstreamCursor::ReadAbbrevRecord() {
   CurAbbrevs.push_back(Abbv);
 }
 
+// One process often reads many bitcode files emitted by the same producer,
+// whose BLOCKINFO blocks are bit-for-bit identical. Cache parsed blockinfo
+// keyed by the raw bytes of the block body, so later readers can install the
+// result and skip re-decoding the abbreviation definitions. The cache keeps
+// its own deep copies and hands out fresh ones: BitCodeAbbrev reference
+// counts are not atomic, so no abbreviation object may be shared between
+// readers on different threads.
+typedef std::vector<BitstreamReader::BlockInfo> BlockInfoList;
+static ManagedStatic<StringMap<BlockInfoList>> BlockInfoCache;
+static ManagedStatic<sys::SmartMutex<true>> BlockInfoCacheLock;
+
+static BitstreamReader::BlockInfo
+copyBlockInfo(const BitstreamReader::BlockInfo &BI) {
+  BitstreamReader::BlockInfo Copy;
+  Copy.BlockID = BI.BlockID;
+  Copy.Abbrevs.reserve(BI.Abbrevs.size());
+  for (unsigned i = 0, e = BI.Abbrevs.size(); i != e; ++i) {
+    BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+    for (unsigned Op = 0, OpE = BI.Abbrevs[i]->getNumOperandInfos();
+         Op != OpE; ++Op)
+      Abbv->Add(BI.Abbrevs[i]->getOperandInfo(Op));
+    Copy.Abbrevs.push_back(Abbv);
+  }
+  // Block and record names are deliberately not copied; the cache is only
+  // used by readers that ignore them.
+  return Copy;
+}
+
 bool BitstreamCursor::ReadBlockInfoBlock() {
   // If this is the second stream to get to the block info block, skip it.
   if (BitStream->hasBlockInfoRecords())
     return SkipBlock();
 
-  if (EnterSubBlock(bitc::BLOCKINFO_BLOCK_ID)) return true;
+  unsigned NumWords = 0;
+  if (EnterSubBlock(bitc::BLOCKINFO_BLOCK_ID, &NumWords)) return true;
+
+  // Try the cache, keyed on the raw bytes of the block body. Readers that
+  // collect block and record names bypass it, since the cache stores
+  // neither.
+  uint64_t BodyStart = GetCurrentBitNo();
+  uint64_t BodySize = (uint64_t)NumWords * 4;
+  SmallVector<uint8_t, 256> Body;
+  bool UseCache = BitStream->isIgnoringBlockInfoNames() && BodySize != 0;
+  if (UseCache) {
+    Body.resize(BodySize);
+    UseCache = BitStream->getBitcodeBytes().readBytes(Body.data(), BodySize,
+                                                      BodyStart / 8) ==
+               BodySize;
+  }
+  StringRef CacheKey(reinterpret_cast<const char *>(Body.data()), Body.size());
+
+  if (UseCache) {
+    sys::SmartScopedLock<true> Lock(*BlockInfoCacheLock);
+    StringMap<BlockInfoList>::iterator I = BlockInfoCache->find(CacheKey);
+    if (I != BlockInfoCache->end()) {
+      for (unsigned i = 0, e = I->second.size(); i != e; ++i)
+        BitStream->getOrCreateBlockInfo(I->second[i].BlockID) =
+            copyBlockInfo(I->second[i]);
+
+      // Every record in the block is accounted for; skip to its end and pop
+      // the block scope.
+      size_t SkipTo = BodyStart + BodySize * 8;
+      if (!canSkipToPos(SkipTo / 8))
+        return true;
+      JumpToBit(SkipTo);
+      return ReadBlockEnd();
+    }
+  }
 
   SmallVector<uint64_t, 64> Record;
   BitstreamReader::BlockInfo *CurBlockInfo = nullptr;
@@ -290,6 +355,19 @@ bool BitstreamCursor::ReadBlockInfoBlock() {
     case llvm::BitstreamEntry::Error:
       return true;
     case llvm::BitstreamEntry::EndBlock:
+      // Parsed successfully; populate the cache for the next reader that
+      // sees an identical block.
+      if (UseCache) {
+        sys::SmartScopedLock<true> Lock(*BlockInfoCacheLock);
+        BlockInfoList &Cached = (*BlockInfoCache)[CacheKey];
+        if (Cached.empty()) {
+          const std::vector<BitstreamReader::BlockInfo> &Parsed =
+              BitStream->getBlockInfoRecords();
+          Cached.reserve(Parsed.size());
+          for (unsigned i = 0, e = Parsed.size(); i != e; ++i)
+            Cached.push_back(copyBlockInfo(Parsed[i]));
+        }
+      }
       return false;
     case llvm::BitstreamEntry::Record:
       // The interesting case.
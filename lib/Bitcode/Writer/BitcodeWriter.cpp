@@ -21,19 +21,36 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/UseListOrder.h"
 #include "llvm/IR/ValueSymbolTable.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <cctype>
 #include <map>
+#include <thread>
 using namespace llvm;
 
+static cl::opt<unsigned> BitcodeWriterThreads(
+    "bitcode-writer-threads", cl::Hidden, cl::init(1),
+    cl::desc("Encode function blocks with this many threads when writing "
+             "bitcode"));
+
+static cl::opt<bool> EmitFunctionDigests(
+    "bitcode-function-digests", cl::Hidden, cl::init(false),
+    cl::desc("Emit a FUNCTION_DIGEST block hashing every function body "
+             "block, for block-granular build caching"));
+
 /// These are manifest constants used by the bitcode writer. They do not need to
 /// be kept in sync with the reader, but need to be consistent within this file.
 enum {
@@ -2307,6 +2324,142 @@ static void WriteBlockInfo(const ValueEnumerator &VE, BitstreamWriter &Stream) {
   Stream.ExitBlock();
 }
 
+/// WriteFunctionOffsetIndex - Emit the FUNCTION_INDEX block, which carries
+/// the absolute bit offset of every function body block in module order plus
+/// the first bit after the last body. The offsets are not known yet, so each
+/// is emitted as a pair of Fixed(32) zero placeholders whose bit positions
+/// are returned for backpatching once the bodies have been written.
+static void WriteFunctionOffsetIndex(const Module *M, BitstreamWriter &Stream,
+                                     SmallVectorImpl<uint64_t> &EntryBits,
+                                     uint64_t &EndBits) {
+  Stream.EnterSubblock(bitc::FUNCTION_INDEX_BLOCK_ID, 3);
+
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FNINDEX_CODE_ENTRY));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  unsigned EntryAbbrev = Stream.EmitAbbrev(Abbv);
+
+  Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FNINDEX_CODE_END));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  unsigned EndAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SmallVector<uint64_t, 3> Vals;
+  Vals.push_back(bitc::FNINDEX_CODE_ENTRY);
+  Vals.push_back(0);
+  Vals.push_back(0);
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    // The operands follow the 3-bit abbrev ID; the literal code emits no bits.
+    EntryBits.push_back(Stream.GetCurrentBitNo() + 3);
+    Stream.EmitRecordWithAbbrev(EntryAbbrev, Vals);
+  }
+  Vals[0] = bitc::FNINDEX_CODE_END;
+  EndBits = Stream.GetCurrentBitNo() + 3;
+  Stream.EmitRecordWithAbbrev(EndAbbrev, Vals);
+
+  Stream.ExitBlock();
+}
+
+/// hashFunctionBlock - Content hash of one encoded function body block: an
+/// MD5 of the block's bytes truncated to 64 bits. Body blocks begin and end
+/// on word boundaries, so the hashed range is well defined whether the block
+/// was encoded in place or spliced in from a side buffer.
+static uint64_t hashFunctionBlock(ArrayRef<char> Bytes) {
+  MD5 Hash;
+  MD5::MD5Result Digest;
+  Hash.update(StringRef(Bytes.data(), Bytes.size()));
+  Hash.final(Digest);
+  return support::endian::read<uint64_t, support::little, support::unaligned>(
+      Digest);
+}
+
+/// WriteFunctionDigestBlock - Emit the FUNCTION_DIGEST block: one record per
+/// function body, in module order, carrying the truncated MD5 of the body
+/// block's encoded bytes (least significant word first) and the function
+/// name.
+static void WriteFunctionDigestBlock(
+    ArrayRef<std::pair<const Function *, uint64_t>> Digests,
+    BitstreamWriter &Stream) {
+  Stream.EnterSubblock(bitc::FUNCTION_DIGEST_BLOCK_ID, 3);
+
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FNDIGEST_CODE_ENTRY));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 8));
+  unsigned EntryAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SmallVector<uint64_t, 64> Vals;
+  for (unsigned i = 0, e = Digests.size(); i != e; ++i) {
+    Vals.push_back(bitc::FNDIGEST_CODE_ENTRY);
+    Vals.push_back(uint32_t(Digests[i].second));
+    Vals.push_back(uint32_t(Digests[i].second >> 32));
+    StringRef Name = Digests[i].first->getName();
+    for (unsigned j = 0, n = Name.size(); j != n; ++j)
+      Vals.push_back((unsigned char)Name[j]);
+    Stream.EmitRecordWithAbbrev(EntryAbbrev, Vals);
+    Vals.clear();
+  }
+
+  Stream.ExitBlock();
+}
+
+/// WriteFunctionsParallel - Encode all function blocks on NumThreads threads,
+/// then splice them into the module stream in module order. Function blocks
+/// are self-contained and word aligned, so each worker can encode complete
+/// subblocks into a private buffer that is appended to the stream verbatim.
+/// Each worker incorporates functions into its own copy of the
+/// ValueEnumerator, since incorporateFunction mutates it.
+static void WriteFunctionsParallel(
+    const Module *M, const ValueEnumerator &VE, BitstreamWriter &Stream,
+    unsigned NumThreads, ArrayRef<uint64_t> IndexEntryBits,
+    SmallVectorImpl<std::pair<const Function *, uint64_t>> *Digests) {
+  std::vector<const Function *> Funcs;
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
+    if (!F->isDeclaration())
+      Funcs.push_back(&*F);
+
+  std::vector<SmallVector<char, 0>> Buffers(Funcs.size());
+  std::atomic<unsigned> NextFn(0);
+
+  auto Worker = [&] {
+    ValueEnumerator ThreadVE(VE);
+    while (true) {
+      unsigned i = NextFn++;
+      if (i >= Funcs.size())
+        return;
+      BitstreamWriter W(Buffers[i]);
+      // The blocks will be spliced into the module block, where the abbrev ID
+      // width is 3, so the out-of-line encoding must start from that width
+      // for the bit layout to match.
+      W.SetCurrentAbbrevIDWidth(3);
+      W.CopyBlockInfo(Stream);
+      WriteFunction(*Funcs[i], ThreadVE, W);
+    }
+  };
+
+  std::vector<std::thread> Workers;
+  unsigned NumWorkers = std::min(NumThreads, unsigned(Funcs.size()));
+  for (unsigned i = 0; i != NumWorkers; ++i)
+    Workers.push_back(std::thread(Worker));
+  for (unsigned i = 0; i != NumWorkers; ++i)
+    Workers[i].join();
+
+  for (unsigned i = 0, e = Funcs.size(); i != e; ++i) {
+    Stream.BackpatchWord64AtBit(IndexEntryBits[i],
+                                Stream.GetCurrentBitNo() + 3);
+    Stream.EmitPreEncodedData(Buffers[i]);
+    if (Digests)
+      Digests->push_back(
+          std::make_pair(Funcs[i], hashFunctionBlock(Buffers[i])));
+  }
+}
+
 /// WriteModule - Emit the specified module to the bitstream.
 static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   Stream.EnterSubblock(bitc::MODULE_BLOCK_ID, 3);
@@ -2353,10 +2506,158 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   if (shouldPreserveBitcodeUseListOrder())
     WriteUseListBlock(nullptr, VE, Stream);
 
-  // Emit function bodies.
+  // Emit the function offset index, to be backpatched below as the bodies
+  // are written.
+  SmallVector<uint64_t, 16> IndexEntryBits;
+  uint64_t IndexEndBits = 0;
+  WriteFunctionOffsetIndex(M, Stream, IndexEntryBits, IndexEndBits);
+
+  // Emit function bodies. Use-list orders are consumed destructively as
+  // bodies are written, so parallel encoding only applies without them.
+  SmallVector<std::pair<const Function *, uint64_t>, 16> Digests;
+  if (BitcodeWriterThreads > 1 && llvm_is_multithreaded() &&
+      !shouldPreserveBitcodeUseListOrder()) {
+    WriteFunctionsParallel(M, VE, Stream, BitcodeWriterThreads, IndexEntryBits,
+                           EmitFunctionDigests ? &Digests : nullptr);
+  } else {
+    unsigned FnIndex = 0;
+    for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
+      if (!F->isDeclaration()) {
+        // Readers position themselves just past the 3-bit ENTER_SUBBLOCK
+        // abbrev ID when materializing a body.
+        Stream.BackpatchWord64AtBit(IndexEntryBits[FnIndex++],
+                                    Stream.GetCurrentBitNo() + 3);
+        // Body blocks start and end on word boundaries (the previous block's
+        // ExitBlock flushed to a word), so the encoded bytes of this body are
+        // exactly the buffer bytes emitted while writing it.
+        size_t StartByte = Stream.GetCurrentBitNo() / 8;
+        WriteFunction(*F, VE, Stream);
+        if (EmitFunctionDigests) {
+          const SmallVectorImpl<char> &Buf = Stream.getBuffer();
+          Digests.push_back(std::make_pair(
+              &*F, hashFunctionBlock(makeArrayRef(Buf.data() + StartByte,
+                                                  Buf.size() - StartByte))));
+        }
+      }
+  }
+  Stream.BackpatchWord64AtBit(IndexEndBits, Stream.GetCurrentBitNo());
+
+  if (EmitFunctionDigests)
+    WriteFunctionDigestBlock(Digests, Stream);
+
+  Stream.ExitBlock();
+}
+
+static const GlobalObject *getBaseObject(const GlobalValue &GV) {
+  if (auto *GA = dyn_cast<GlobalAlias>(&GV))
+    return GA->getBaseObject();
+  return cast<GlobalObject>(&GV);
+}
+
+/// getSymtabSymbolFlags - Compute the SYMTAB flags of GV. This mirrors
+/// IRObjectFile::getSymbolFlags() and must be kept in sync with it, so that a
+/// scan of the symbol table block sees exactly the symbols a scan of the
+/// materialized module would.
+static uint64_t getSymtabSymbolFlags(const GlobalValue &GV) {
+  uint64_t Flags = 0;
+  if (GV.isDeclarationForLinker())
+    Flags |= bitc::SYMTAB_SYMBOL_UNDEFINED;
+  if (GV.hasPrivateLinkage())
+    Flags |= bitc::SYMTAB_SYMBOL_FORMAT_SPECIFIC;
+  if (!GV.hasLocalLinkage())
+    Flags |= bitc::SYMTAB_SYMBOL_GLOBAL;
+  if (GV.hasCommonLinkage())
+    Flags |= bitc::SYMTAB_SYMBOL_COMMON;
+  if (GV.hasLinkOnceLinkage() || GV.hasWeakLinkage())
+    Flags |= bitc::SYMTAB_SYMBOL_WEAK;
+  if (GV.hasExternalWeakLinkage())
+    Flags |= bitc::SYMTAB_SYMBOL_EXTERNAL_WEAK;
+  if (GV.isWeakForLinker())
+    Flags |= bitc::SYMTAB_SYMBOL_WEAK_FOR_LINKER;
+
+  if (GV.getName().startswith("llvm."))
+    Flags |= bitc::SYMTAB_SYMBOL_FORMAT_SPECIFIC;
+  else if (auto *Var = dyn_cast<GlobalVariable>(&GV))
+    if (Var->getSection() == StringRef("llvm.metadata"))
+      Flags |= bitc::SYMTAB_SYMBOL_FORMAT_SPECIFIC;
+
+  return Flags;
+}
+
+/// WriteSymtab - Emit the SYMTAB block, which describes every module symbol
+/// in the order IRObjectFile enumerates them: functions, then global
+/// variables, then aliases. The block sits at the top level after the module
+/// block; readers that do not know it skip it like any other unknown block.
+static void WriteSymtab(const Module *M, BitstreamWriter &Stream) {
+  // Inline assembly can define and reference symbols that only the target
+  // assembly parser finds, so such modules must be scanned the slow way.
+  if (!M->getModuleInlineAsm().empty())
+    return;
+
+  // An alias of an alias or of a constant expression has no base object to
+  // take a comdat key from; leave those rare modules to the slow path too.
+  for (Module::const_alias_iterator A = M->alias_begin(), E = M->alias_end();
+       A != E; ++A)
+    if (!A->getBaseObject())
+      return;
+
+  // Mangle names the same way IRObjectFile does: only when the module has a
+  // DataLayout to mangle with.
+  std::unique_ptr<Mangler> Mang;
+  if (const DataLayout *DL = M->getDataLayout())
+    Mang.reset(new Mangler(DL));
+
+  Stream.EnterSubblock(bitc::SYMTAB_BLOCK_ID, 3);
+
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::SYMTAB_CODE_SYMBOL));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 2)); // visibility
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // name length
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 8)); // name, comdat key
+  unsigned SymbolAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SmallVector<uint64_t, 64> Vals;
+  SmallString<64> Name;
+  auto EmitSymbol = [&](const GlobalValue &GV) {
+    Name.clear();
+    {
+      raw_svector_ostream OS(Name);
+      if (Mang)
+        Mang->getNameWithPrefix(OS, &GV, false);
+      else
+        OS << GV.getName();
+    }
+
+    uint64_t Flags = getSymtabSymbolFlags(GV);
+    StringRef ComdatKey;
+    const GlobalObject *Base = getBaseObject(GV);
+    if (const Comdat *C = Base->getComdat())
+      ComdatKey = C->getName();
+    else if (Base->hasWeakLinkage() || Base->hasLinkOnceLinkage())
+      Flags |= bitc::SYMTAB_SYMBOL_SELF_COMDAT;
+
+    Vals.clear();
+    Vals.push_back(bitc::SYMTAB_CODE_SYMBOL);
+    Vals.push_back(Flags);
+    Vals.push_back(GV.getVisibility());
+    Vals.push_back(Name.size());
+    for (unsigned i = 0, e = Name.size(); i != e; ++i)
+      Vals.push_back((unsigned char)Name[i]);
+    for (unsigned i = 0, e = ComdatKey.size(); i != e; ++i)
+      Vals.push_back((unsigned char)ComdatKey[i]);
+    Stream.EmitRecordWithAbbrev(SymbolAbbrev, Vals);
+  };
+
   for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
-    if (!F->isDeclaration())
-      WriteFunction(*F, VE, Stream);
+    EmitSymbol(*F);
+  for (Module::const_global_iterator G = M->global_begin(),
+       E = M->global_end(); G != E; ++G)
+    EmitSymbol(*G);
+  for (Module::const_alias_iterator A = M->alias_begin(), E = M->alias_end();
+       A != E; ++A)
+    EmitSymbol(*A);
 
   Stream.ExitBlock();
 }
@@ -2460,6 +2761,9 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out) {
 
     // Emit the module.
     WriteModule(M, Stream);
+
+    // Emit the symbol table, so symbol scans need not parse the module.
+    WriteSymtab(M, Stream);
   }
 
   if (TT.isOSDarwin())
@@ -2468,3 +2772,38 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out) {
   // Write the generated bitstream to "Out".
   Out.write((char*)&Buffer.front(), Buffer.size());
 }
+
+/// WriteCompressedBitcodeToFile - Write the specified module to the specified
+/// output stream as a zlib-compressed container. The header layout is
+/// documented next to isCompressedBitcode().
+void llvm::WriteCompressedBitcodeToFile(const Module *M, raw_ostream &Out) {
+  if (!zlib::isAvailable())
+    report_fatal_error("compressed bitcode output requires zlib");
+
+  // Emit the plain bitcode stream into a buffer first. Compressing the stream
+  // as a whole keeps the absolute block offsets inside it valid, so a reader
+  // can decompress once and then materialize functions lazily as usual.
+  SmallVector<char, 0> Bitcode;
+  Bitcode.reserve(256*1024);
+  {
+    raw_svector_ostream BitcodeOut(Bitcode);
+    WriteBitcodeToFile(M, BitcodeOut);
+  }
+  if (Bitcode.size() > UINT32_MAX)
+    report_fatal_error("bitcode stream too large to compress");
+
+  SmallVector<char, 0> Compressed;
+  if (zlib::compress(StringRef(Bitcode.data(), Bitcode.size()), Compressed) !=
+      zlib::StatusOK)
+    report_fatal_error("failed to compress bitcode stream");
+
+  SmallVector<char, 16> Header(3*4);
+  uint32_t Position = 0;
+  WriteInt32ToBuffer('B' | ('C' << 8) | ('C' << 16) | ('Z' << 24), Header,
+                     Position);
+  WriteInt32ToBuffer(0, Header, Position);              // Version.
+  WriteInt32ToBuffer(Bitcode.size(), Header, Position); // Uncompressed size.
+
+  Out.write(Header.data(), Header.size());
+  Out.write(Compressed.data(), Compressed.size());
+}
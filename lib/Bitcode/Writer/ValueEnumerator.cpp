@@ -138,13 +138,22 @@ static OrderMap orderModule(const Module &M) {
 static void predictValueUseListOrderImpl(const Value *V, const Function *F,
                                          unsigned ID, const OrderMap &OM,
                                          UseListOrderStack &Stack) {
-  // Predict use-list order for this one.
-  typedef std::pair<const Use *, unsigned> Entry;
+  // Predict use-list order for this one.  Pack the uses into an array up
+  // front, caching each user's ID, so the sort below works on a flat array
+  // and compares plain integers instead of looking users up in the order map
+  // O(n log n) times.
+  struct Entry {
+    const Use *U;
+    unsigned OrigIdx;
+    unsigned UserID;
+  };
   SmallVector<Entry, 64> List;
-  for (const Use &U : V->uses())
+  for (const Use &U : V->uses()) {
     // Check if this user will be serialized.
-    if (OM.lookup(U.getUser()).first)
-      List.push_back(std::make_pair(&U, List.size()));
+    unsigned UserID = OM.lookup(U.getUser()).first;
+    if (UserID)
+      List.push_back({&U, unsigned(List.size()), UserID});
+  }
 
   if (List.size() < 2)
     // We may have lost some users.
@@ -152,13 +161,13 @@ static void predictValueUseListOrderImpl(const Value *V, const Function *F,
 
   bool IsGlobalValue = OM.isGlobalValue(ID);
   std::sort(List.begin(), List.end(), [&](const Entry &L, const Entry &R) {
-    const Use *LU = L.first;
-    const Use *RU = R.first;
+    const Use *LU = L.U;
+    const Use *RU = R.U;
     if (LU == RU)
       return false;
 
-    auto LID = OM.lookup(LU->getUser()).first;
-    auto RID = OM.lookup(RU->getUser()).first;
+    unsigned LID = L.UserID;
+    unsigned RID = R.UserID;
 
     // Global values are processed in reverse order.
     //
@@ -193,7 +202,7 @@ static void predictValueUseListOrderImpl(const Value *V, const Function *F,
 
   if (std::is_sorted(
           List.begin(), List.end(),
-          [](const Entry &L, const Entry &R) { return L.second < R.second; }))
+          [](const Entry &L, const Entry &R) { return L.OrigIdx < R.OrigIdx; }))
     // Order is already correct.
     return;
 
@@ -201,7 +210,7 @@ static void predictValueUseListOrderImpl(const Value *V, const Function *F,
   Stack.emplace_back(V, F, List.size());
   assert(List.size() == Stack.back().Shuffle.size() && "Wrong size");
   for (size_t I = 0, E = List.size(); I != E; ++I)
-    Stack.back().Shuffle[I] = List[I].second;
+    Stack.back().Shuffle[I] = List[I].OrigIdx;
 }
 
 static void predictValueUseListOrder(const Value *V, const Function *F,
@@ -283,11 +292,58 @@ static bool isIntOrIntVectorValue(const std::pair<const Value*, unsigned> &V) {
   return V.first->getType()->isIntOrIntVectorTy();
 }
 
+ValueEnumerator::ValueEnumerator(const ValueEnumerator &VE)
+    : TypeMap(VE.TypeMap), Types(VE.Types), ValueMap(VE.ValueMap),
+      Values(VE.Values), Comdats(VE.Comdats), MDs(VE.MDs),
+      FunctionLocalMDs(VE.FunctionLocalMDs), MDValueMap(VE.MDValueMap),
+      HasMDString(VE.HasMDString), HasMDLocation(VE.HasMDLocation),
+      HasGenericDebugNode(VE.HasGenericDebugNode),
+      AttributeGroupMap(VE.AttributeGroupMap),
+      AttributeGroups(VE.AttributeGroups), AttributeMap(VE.AttributeMap),
+      Attribute(VE.Attribute), GlobalBasicBlockIDs(VE.GlobalBasicBlockIDs),
+      InstructionMap(VE.InstructionMap), InstructionCount(VE.InstructionCount),
+      BasicBlocks(VE.BasicBlocks), NumModuleValues(VE.NumModuleValues),
+      NumModuleMDs(VE.NumModuleMDs),
+      FirstFuncConstantID(VE.FirstFuncConstantID),
+      FirstInstID(VE.FirstInstID) {
+  // UseListOrder entries are move-only and are consumed as function blocks
+  // are written, so enumerators carrying them cannot be duplicated.
+  assert(VE.UseListOrders.empty() &&
+         "Cannot copy a ValueEnumerator with use-list orders");
+}
+
 ValueEnumerator::ValueEnumerator(const Module &M)
     : HasMDString(false), HasMDLocation(false), HasGenericDebugNode(false) {
   if (shouldPreserveBitcodeUseListOrder())
     UseListOrders = predictUseListOrder(M);
 
+  // Pre-size the tables so enumeration does not rehash while it runs; on
+  // merged modules the incremental growth of these maps dominates write
+  // time.  An exact count of distinct values would cost as much as the
+  // enumeration itself, but a cheap counting pass gives a good bound: every
+  // global, function, argument and instruction gets an ID, and the constants
+  // and metadata they reference ride on a slack factor.
+  {
+    size_t NumValues = M.getGlobalList().size() + M.getAliasList().size() +
+                       M.getFunctionList().size();
+    size_t NumInsts = 0;
+    for (const Function &F : M) {
+      NumValues += F.arg_size();
+      for (const BasicBlock &BB : F)
+        NumInsts += BB.size();
+    }
+    NumValues += NumInsts;
+    // Constants typically add another quarter or so on top of the named
+    // values.
+    NumValues += NumValues / 4;
+    ValueMap.resize(NumValues);
+    Values.reserve(NumValues);
+    // Debug-info-heavy modules carry a metadata node population on the same
+    // order as the instruction count.
+    MDValueMap.resize(NumInsts);
+    MDs.reserve(NumInsts);
+  }
+
   // Enumerate the global variables.
   for (Module::const_global_iterator I = M.global_begin(), E = M.global_end();
        I != E; ++I)
@@ -99,11 +99,17 @@ private:
   unsigned FirstFuncConstantID;
   unsigned FirstInstID;
 
-  ValueEnumerator(const ValueEnumerator &) = delete;
   void operator=(const ValueEnumerator &) = delete;
 public:
   ValueEnumerator(const Module &M);
 
+  /// Copying an enumerator is expensive, but it is the only way to encode
+  /// function blocks on multiple threads: incorporateFunction mutates the
+  /// enumerator, so each writer thread incorporates functions into its own
+  /// copy of the module-level state. Only enumerators that do not carry
+  /// use-list orders may be copied.
+  ValueEnumerator(const ValueEnumerator &VE);
+
   void dump() const;
   void print(raw_ostream &OS, const ValueMapType &Map, const char *Name) const;
   void print(raw_ostream &OS, const MetadataMapType &Map,
@@ -19,6 +19,10 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
 
 namespace llvm {
 class ByteStreamer {
@@ -51,6 +55,54 @@ public:
   }
 };
 
+class BufferByteStreamer : public ByteStreamer {
+private:
+  SmallVectorImpl<char> &Buffer;
+  std::vector<std::string> &Comments;
+
+  /// Only verbose textual output needs comments.  This will be set to
+  /// true for that case, and false otherwise.
+  bool GenerateComments;
+
+public:
+  BufferByteStreamer(SmallVectorImpl<char> &Buffer,
+                     std::vector<std::string> &Comments,
+                     bool GenerateComments)
+      : Buffer(Buffer), Comments(Comments),
+        GenerateComments(GenerateComments) {}
+  void EmitInt8(uint8_t Byte, const Twine &Comment) override {
+    Buffer.push_back(Byte);
+    if (GenerateComments)
+      Comments.push_back(Comment.str());
+  }
+  void EmitSLEB128(uint64_t DWord, const Twine &Comment) override {
+    size_t Length = Buffer.size();
+    {
+      raw_svector_ostream OSE(Buffer);
+      encodeSLEB128(DWord, OSE);
+    }
+    // Attach the comment to the first byte of the encoding; each byte
+    // carries a comment slot so the buffer and comments stay in step.
+    if (GenerateComments) {
+      Comments.push_back(Comment.str());
+      for (size_t I = Buffer.size() - Length; I > 1; --I)
+        Comments.push_back("");
+    }
+  }
+  void EmitULEB128(uint64_t DWord, const Twine &Comment) override {
+    size_t Length = Buffer.size();
+    {
+      raw_svector_ostream OSE(Buffer);
+      encodeULEB128(DWord, OSE);
+    }
+    if (GenerateComments) {
+      Comments.push_back(Comment.str());
+      for (size_t I = Buffer.size() - Length; I > 1; --I)
+        Comments.push_back("");
+    }
+  }
+};
+
 class HashingByteStreamer : public ByteStreamer {
  private:
   DIEHash &Hash;
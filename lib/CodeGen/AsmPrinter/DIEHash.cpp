@@ -283,11 +283,13 @@ void DIEHash::hashBlockData(const SmallVectorImpl<DIEValue *> &Values) {
 
 // Hash the contents of a loclistptr class.
 void DIEHash::hashLocList(const DIELocList &LocList) {
-  HashingByteStreamer Streamer(*this);
+  // The location expressions were rendered to bytes when their function was
+  // finished; hashing the rendered bytes gives the same stream the
+  // HashingByteStreamer used to see.
   DwarfDebug &DD = *AP->getDwarfDebug();
-  for (const auto &Entry :
-       DD.getDebugLocEntries()[LocList.getValue()].List)
-    DD.emitDebugLocEntry(Streamer, Entry);
+  for (const auto &Entry : DD.getDebugLocEntries()[LocList.getValue()].List)
+    for (char Byte : Entry.Bytes)
+      update(static_cast<uint8_t>(Byte));
 }
 
 // Hash an individual attribute \param Attr based on the type of attribute and
@@ -10,16 +10,30 @@
 #ifndef LLVM_LIB_CODEGEN_ASMPRINTER_DEBUGLOCLIST_H
 #define LLVM_LIB_CODEGEN_ASMPRINTER_DEBUGLOCLIST_H
 
-#include "DebugLocEntry.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include <string>
+#include <vector>
 
 namespace llvm {
 class DwarfCompileUnit;
 class MCSymbol;
 struct DebugLocList {
+  /// One range of a location list. The location expression is rendered to
+  /// bytes as soon as the entry's function is finished, so the per-function
+  /// machine values and expressions it was built from do not have to be kept
+  /// alive until the end of the module.
+  struct Entry {
+    const MCSymbol *Begin;
+    const MCSymbol *End;
+    SmallString<32> Bytes;
+    /// One comment per rendered byte; only filled for verbose assembly
+    /// output.
+    std::vector<std::string> Comments;
+  };
   MCSymbol *Label;
   DwarfCompileUnit *CU;
-  SmallVector<DebugLocEntry, 4> List;
+  SmallVector<Entry, 4> List;
 };
 }
 #endif
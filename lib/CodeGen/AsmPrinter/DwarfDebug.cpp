@@ -980,7 +980,20 @@ DwarfDebug::collectVariableInfo(DwarfCompileUnit &TheCU, DISubprogram SP,
         Asm->GetTempSymbol("debug_loc", DotDebugLocEntries.size() - 1);
 
     // Build the location list for this variable.
-    buildLocationList(LocList.List, Ranges);
+    SmallVector<DebugLocEntry, 8> Entries;
+    buildLocationList(Entries, Ranges);
+
+    // Render the entries now, while the function's machine values and
+    // expressions are at hand; only the range symbols and the rendered bytes
+    // are kept until the lists are emitted at the end of the module.
+    for (auto &Entry : Entries) {
+      LocList.List.push_back(DebugLocList::Entry());
+      DebugLocList::Entry &E = LocList.List.back();
+      E.Begin = Entry.getBeginSym();
+      E.End = Entry.getEndSym();
+      BufferByteStreamer Streamer(E.Bytes, E.Comments, Asm->isVerbose());
+      emitDebugLocEntry(Streamer, Entry);
+    }
   }
 
   // Collect info for variables that were optimized out.
@@ -1736,17 +1749,21 @@ void DwarfDebug::emitDebugLocValue(ByteStreamer &Streamer,
   // FIXME: ^
 }
 
-void DwarfDebug::emitDebugLocEntryLocation(const DebugLocEntry &Entry) {
+void DwarfDebug::emitDebugLocEntryLocation(const DebugLocList::Entry &Entry) {
+  // The expression was rendered to bytes when its function was finished, so
+  // its size is known and no label pair is needed.
   Asm->OutStreamer.AddComment("Loc expr size");
-  MCSymbol *begin = Asm->OutStreamer.getContext().CreateTempSymbol();
-  MCSymbol *end = Asm->OutStreamer.getContext().CreateTempSymbol();
-  Asm->EmitLabelDifference(end, begin, 2);
-  Asm->OutStreamer.EmitLabel(begin);
-  // Emit the entry.
-  APByteStreamer Streamer(*Asm);
-  emitDebugLocEntry(Streamer, Entry);
-  // Close the range.
-  Asm->OutStreamer.EmitLabel(end);
+  Asm->EmitInt16(Entry.Bytes.size());
+  if (Asm->isVerbose()) {
+    for (unsigned I = 0, E = Entry.Bytes.size(); I != E; ++I) {
+      if (I < Entry.Comments.size())
+        Asm->OutStreamer.AddComment(Entry.Comments[I]);
+      Asm->EmitInt8(static_cast<uint8_t>(Entry.Bytes[I]));
+    }
+  } else {
+    Asm->OutStreamer.EmitBytes(
+        StringRef(Entry.Bytes.data(), Entry.Bytes.size()));
+  }
 }
 
 // Emit locations into the debug loc section.
@@ -1763,11 +1780,11 @@ void DwarfDebug::emitDebugLoc() {
       // compile unit. This is a hard coded 0 for low_pc when we're emitting
       // ranges, or the DW_AT_low_pc on the compile unit otherwise.
       if (auto *Base = CU->getBaseAddress()) {
-        Asm->EmitLabelDifference(Entry.getBeginSym(), Base, Size);
-        Asm->EmitLabelDifference(Entry.getEndSym(), Base, Size);
+        Asm->EmitLabelDifference(Entry.Begin, Base, Size);
+        Asm->EmitLabelDifference(Entry.End, Base, Size);
       } else {
-        Asm->OutStreamer.EmitSymbolValue(Entry.getBeginSym(), Size);
-        Asm->OutStreamer.EmitSymbolValue(Entry.getEndSym(), Size);
+        Asm->OutStreamer.EmitSymbolValue(Entry.Begin, Size);
+        Asm->OutStreamer.EmitSymbolValue(Entry.End, Size);
       }
 
       emitDebugLocEntryLocation(Entry);
@@ -1788,9 +1805,9 @@ void DwarfDebug::emitDebugLocDWO() {
       // address we know we've emitted elsewhere (the start of the function?
       // The start of the CU or CU subrange that encloses this range?)
       Asm->EmitInt8(dwarf::DW_LLE_start_length_entry);
-      unsigned idx = AddrPool.getIndex(Entry.getBeginSym());
+      unsigned idx = AddrPool.getIndex(Entry.Begin);
       Asm->EmitULEB128(idx);
-      Asm->EmitLabelDifference(Entry.getEndSym(), Entry.getBeginSym(), 4);
+      Asm->EmitLabelDifference(Entry.End, Entry.Begin, 4);
 
       emitDebugLocEntryLocation(Entry);
     }
@@ -62,6 +62,14 @@ TailMergeSize("tail-merge-size",
           cl::desc("Min number of instructions to consider tail merging"),
                               cl::init(3), cl::Hidden);
 
+// A block is considered cold, and its tail merged as aggressively as under
+// -Os, when its frequency is no more than 1/N of the entry frequency.
+static cl::opt<unsigned>
+TailMergeColdRatio("tail-merge-cold-ratio",
+          cl::desc("Entry/block frequency ratio above which a block is cold "
+                   "enough to tail merge for size"),
+          cl::init(32), cl::Hidden);
+
 namespace {
   /// BranchFolderPass - Wrap branch folder in a machine function pass.
   class BranchFolderPass : public MachineFunctionPass {
@@ -526,6 +534,10 @@ void BranchFolder::MBFIWrapper::setBlockFreq(const MachineBasicBlock *MBB,
   MergedBBFreq[MBB] = F;
 }
 
+uint64_t BranchFolder::MBFIWrapper::getEntryFreq() const {
+  return MBFI.getEntryFreq();
+}
+
 /// CountTerminators - Count the number of terminators in the given
 /// block and set I to the position of the first non-terminator, if there
 /// is one, or MBB->end() otherwise.
@@ -556,7 +568,8 @@ static bool ProfitableToMerge(MachineBasicBlock *MBB1,
                               MachineBasicBlock::iterator &I1,
                               MachineBasicBlock::iterator &I2,
                               MachineBasicBlock *SuccBB,
-                              MachineBasicBlock *PredBB) {
+                              MachineBasicBlock *PredBB,
+                              const BranchFolder::MBFIWrapper &MBBFreqInfo) {
   CommonTailLen = ComputeCommonTailLength(MBB1, MBB2, I1, I2);
   if (CommonTailLen == 0)
     return false;
@@ -605,6 +618,16 @@ static bool ProfitableToMerge(MachineBasicBlock *MBB1,
       (I1 == MBB1->begin() || I2 == MBB2->begin()))
     return true;
 
+  // Likewise if both blocks are cold: an extra branch on a rarely executed
+  // path is cheap relative to the code size saved.
+  if (EffectiveTailLen >= 2 && TailMergeColdRatio &&
+      (I1 == MBB1->begin() || I2 == MBB2->begin())) {
+    uint64_t ColdThreshold = MBBFreqInfo.getEntryFreq() / TailMergeColdRatio;
+    if (MBBFreqInfo.getBlockFreq(MBB1).getFrequency() <= ColdThreshold &&
+        MBBFreqInfo.getBlockFreq(MBB2).getFrequency() <= ColdThreshold)
+      return true;
+  }
+
   return false;
 }
 
@@ -634,7 +657,7 @@ unsigned BranchFolder::ComputeSameTails(unsigned CurHash,
       if (ProfitableToMerge(CurMPIter->getBlock(), I->getBlock(),
                             minCommonTailLength,
                             CommonTailLen, TrialBBI1, TrialBBI2,
-                            SuccBB, PredBB)) {
+                            SuccBB, PredBB, MBBFreqInfo)) {
         if (CommonTailLen > maxCommonTailLength) {
           SameTails.clear();
           maxCommonTailLength = CommonTailLen;
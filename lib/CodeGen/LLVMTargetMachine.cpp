@@ -19,6 +19,7 @@
 #include "llvm/CodeGen/ForwardControlFlowIntegrity.h"
 #include "llvm/CodeGen/JumpInstrTables.h"
 #include "llvm/CodeGen/MachineFunctionAnalysis.h"
+#include "llvm/CodeGen/MachineFunctionCheckpoint.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/IR/IRPrintingPasses.h"
@@ -49,6 +50,17 @@ static cl::opt<cl::boolOrDefault>
 EnableFastISelOption("fast-isel", cl::Hidden,
   cl::desc("Enable the \"fast\" instruction selector"));
 
+// Machine function checkpoints let codegen experiments resume after
+// instruction selection instead of re-running the front of the pipeline.
+static cl::opt<std::string> MFCheckpointSaveDir(
+    "mf-checkpoint-save", cl::Hidden, cl::value_desc("directory"),
+    cl::desc("Save a machine function checkpoint for each function after "
+             "instruction selection into the given directory"));
+static cl::opt<std::string> MFCheckpointLoadDir(
+    "mf-checkpoint-load", cl::Hidden, cl::value_desc("directory"),
+    cl::desc("Restore machine function checkpoints from the given directory "
+             "instead of running instruction selection"));
+
 void LLVMTargetMachine::initAsmInfo() {
   MCAsmInfo *TmpAsmInfo = TheTarget.createMCAsmInfo(
       *getSubtargetImpl()->getRegisterInfo(), getTargetTriple());
@@ -128,10 +140,16 @@ static MCContext *addPassesToGenerateCode(LLVMTargetMachine *TM,
        EnableFastISelOption != cl::BOU_FALSE))
     TM->setFastISel(true);
 
-  // Ask the target for an isel.
-  if (PassConfig->addInstSelector())
+  // Ask the target for an isel, unless we are resuming from checkpoints, in
+  // which case the loader rebuilds the selected machine code directly.
+  if (!MFCheckpointLoadDir.empty())
+    PM.add(createMachineFunctionCheckpointLoaderPass(MFCheckpointLoadDir));
+  else if (PassConfig->addInstSelector())
     return nullptr;
 
+  if (!MFCheckpointSaveDir.empty())
+    PM.add(createMachineFunctionCheckpointSaverPass(MFCheckpointSaveDir));
+
   PassConfig->addMachinePasses();
 
   PassConfig->setInitialized();
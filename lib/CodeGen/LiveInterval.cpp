@@ -752,6 +752,20 @@ void LiveRange::flushSegmentSet() {
   verify();
 }
 
+void LiveRange::shrinkStorageToFit() {
+  // Swapping with an exactly sized copy releases the doubling slack.  Skip
+  // vectors with little excess capacity; regrowing those would cost more
+  // than the few bytes reclaimed.
+  if (segments.size() >= 8 && segments.capacity() >= 2 * segments.size()) {
+    Segments Tmp(segments.begin(), segments.end());
+    segments.swap(Tmp);
+  }
+  if (valnos.size() >= 8 && valnos.capacity() >= 2 * valnos.size()) {
+    VNInfoList Tmp(valnos.begin(), valnos.end());
+    valnos.swap(Tmp);
+  }
+}
+
 void LiveInterval::freeSubRange(SubRange *S) {
   S->~SubRange();
   // Memory was allocated with BumpPtr allocator and is not freed here.
@@ -201,6 +201,13 @@ void LiveIntervals::computeVirtRegInterval(LiveInterval &LI) {
   LRCalc->reset(MF, getSlotIndexes(), DomTree, &getVNInfoAllocator());
   LRCalc->calculate(LI);
   computeDeadValues(LI, nullptr);
+  // Calculation grows the segment vectors incrementally, so on functions with
+  // very many segments per interval roughly half of the committed memory can
+  // be doubling slack.  Give it back now that the interval has its final
+  // pre-allocation shape.
+  LI.shrinkStorageToFit();
+  for (LiveInterval::SubRange &S : LI.subranges())
+    S.shrinkStorageToFit();
 }
 
 void LiveIntervals::computeVirtRegs() {
@@ -38,7 +38,8 @@ INITIALIZE_PASS_END(LiveRegMatrix, "liveregmatrix",
                     "Live Register Matrix", false, false)
 
 LiveRegMatrix::LiveRegMatrix() : MachineFunctionPass(ID),
-  UserTag(0), RegMaskTag(0), RegMaskVirtReg(0) {}
+  UserTag(0), CoarseNumBlocks(0), CoarseMonotonic(false), CoarseVirtReg(0),
+  CoarseTag(0), CoarseVirtRegMask(0), RegMaskTag(0), RegMaskVirtReg(0) {}
 
 void LiveRegMatrix::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesAll();
@@ -58,12 +59,27 @@ bool LiveRegMatrix::runOnMachineFunction(MachineFunction &MF) {
     Queries.reset(new LiveIntervalUnion::Query[NumRegUnits]);
   Matrix.init(LIUAlloc, NumRegUnits);
 
+  CoarseMatrix.assign(NumRegUnits, 0);
+  CoarseNumBlocks = std::max(1u, MF.getNumBlockIDs());
+  // Blocks are almost always numbered in layout order at this point. Check
+  // once so coarse masks for multi-block segments can be bucket-range fills.
+  CoarseMonotonic = true;
+  int PrevNumber = -1;
+  for (const MachineBasicBlock &MBB : MF) {
+    if (MBB.getNumber() < PrevNumber) {
+      CoarseMonotonic = false;
+      break;
+    }
+    PrevNumber = MBB.getNumber();
+  }
+
   // Make sure no stale queries get reused.
   invalidateVirtRegs();
   return false;
 }
 
 void LiveRegMatrix::releaseMemory() {
+  CoarseMatrix.clear();
   for (unsigned i = 0, e = Matrix.size(); i != e; ++i) {
     Matrix[i].clear();
     // No need to clear Queries here, since LiveIntervalUnion::Query doesn't
@@ -96,6 +112,76 @@ bool foreachUnit(const TargetRegisterInfo *TRI, LiveInterval &VRegInterval,
   return false;
 }
 
+/// Return the coarse bucket covering basic block number \p Number.
+static unsigned coarseBucket(unsigned Number, unsigned NumBlocks) {
+  return std::min<uint64_t>(63, uint64_t(Number) * 64 / NumBlocks);
+}
+
+/// Return the coarse mask for the half-open slot range [Start, End). The
+/// mapping depends only on block numbers, which are stable while the
+/// allocator runs, so masks computed at different times stay comparable even
+/// if slot indexes have been renumbered in between.
+static uint64_t coarseSegmentMask(SlotIndexes *Indexes, SlotIndex Start,
+                                  SlotIndex End, unsigned NumBlocks,
+                                  bool Monotonic) {
+  const MachineBasicBlock *MBB = Indexes->getMBBFromIndex(Start);
+  const MachineBasicBlock *LastMBB =
+      Indexes->getMBBFromIndex(End.getPrevSlot());
+  if (Monotonic) {
+    unsigned Lo = coarseBucket(MBB->getNumber(), NumBlocks);
+    unsigned Hi = coarseBucket(LastMBB->getNumber(), NumBlocks);
+    if (Hi - Lo >= 63)
+      return ~UINT64_C(0);
+    return ((UINT64_C(1) << (Hi - Lo + 1)) - 1) << Lo;
+  }
+  // Out-of-order numbering; enumerate the covered blocks in layout order,
+  // which matches index order.
+  uint64_t Mask = 0;
+  do {
+    Mask |= UINT64_C(1) << coarseBucket(MBB->getNumber(), NumBlocks);
+    if (MBB == LastMBB)
+      break;
+    MBB = MBB->getNextNode();
+  } while (MBB);
+  return Mask;
+}
+
+uint64_t LiveRegMatrix::computeCoarseMask(const LiveRange &Range) const {
+  SlotIndexes *Indexes = LIS->getSlotIndexes();
+  uint64_t Mask = 0;
+  for (const LiveRange::Segment &S : Range.segments) {
+    Mask |= coarseSegmentMask(Indexes, S.start, S.end, CoarseNumBlocks,
+                              CoarseMonotonic);
+    if (Mask == ~UINT64_C(0))
+      break;
+  }
+  return Mask;
+}
+
+uint64_t LiveRegMatrix::getCoarseMask(LiveInterval &VirtReg) {
+  // Cache the mask like the regmask info: it stays valid for this VirtReg
+  // until live ranges are modified.
+  if (CoarseVirtReg != VirtReg.reg || CoarseTag != UserTag) {
+    CoarseVirtReg = VirtReg.reg;
+    CoarseTag = UserTag;
+    CoarseVirtRegMask = computeCoarseMask(VirtReg);
+  }
+  return CoarseVirtRegMask;
+}
+
+void LiveRegMatrix::recomputeCoarseMask(unsigned Unit) {
+  SlotIndexes *Indexes = LIS->getSlotIndexes();
+  uint64_t Mask = 0;
+  for (LiveIntervalUnion::SegmentIter SI = Matrix[Unit].begin(); SI.valid();
+       ++SI) {
+    Mask |= coarseSegmentMask(Indexes, SI.start(), SI.stop(), CoarseNumBlocks,
+                              CoarseMonotonic);
+    if (Mask == ~UINT64_C(0))
+      break;
+  }
+  CoarseMatrix[Unit] = Mask;
+}
+
 void LiveRegMatrix::assign(LiveInterval &VirtReg, unsigned PhysReg) {
   DEBUG(dbgs() << "assigning " << PrintReg(VirtReg.reg, TRI)
                << " to " << PrintReg(PhysReg, TRI) << ':');
@@ -103,9 +189,18 @@ void LiveRegMatrix::assign(LiveInterval &VirtReg, unsigned PhysReg) {
   VRM->assignVirt2Phys(VirtReg.reg, PhysReg);
   MRI->setPhysRegUsed(PhysReg);
 
+  // Without subranges every unit sees the same range; remember the last
+  // coarse mask so it is only computed once.
+  const LiveRange *LastCoarseRange = nullptr;
+  uint64_t LastCoarseMask = 0;
   foreachUnit(TRI, VirtReg, PhysReg, [&](unsigned Unit,
                                          const LiveRange &Range) {
     DEBUG(dbgs() << ' ' << PrintRegUnit(Unit, TRI) << ' ' << Range);
+    if (&Range != LastCoarseRange) {
+      LastCoarseRange = &Range;
+      LastCoarseMask = computeCoarseMask(Range);
+    }
+    CoarseMatrix[Unit] |= LastCoarseMask;
     Matrix[Unit].unify(VirtReg, Range);
     return false;
   });
@@ -124,6 +219,9 @@ void LiveRegMatrix::unassign(LiveInterval &VirtReg) {
                                          const LiveRange &Range) {
     DEBUG(dbgs() << ' ' << PrintRegUnit(Unit, TRI));
     Matrix[Unit].extract(VirtReg, Range);
+    // Bits can't simply be cleared since other ranges may cover the same
+    // buckets; rebuild the summary from what is left in the union.
+    recomputeCoarseMask(Unit);
     return false;
   });
 
@@ -183,10 +281,16 @@ LiveRegMatrix::checkInterference(LiveInterval &VirtReg, unsigned PhysReg) {
   if (checkRegUnitInterference(VirtReg, PhysReg))
     return IK_RegUnit;
 
-  // Check the matrix for virtual register interference.
-  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units)
+  // Check the matrix for virtual register interference. Units whose coarse
+  // occupancy doesn't intersect VirtReg's can't interfere and are skipped
+  // without touching the IntervalMaps.
+  uint64_t CoarseMask = getCoarseMask(VirtReg);
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    if ((CoarseMatrix[*Units] & CoarseMask) == 0)
+      continue;
     if (query(VirtReg, *Units).checkInterference())
       return IK_VirtReg;
+  }
 
   return IK_Free;
 }
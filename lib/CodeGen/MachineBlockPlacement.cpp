@@ -52,6 +52,7 @@ STATISTIC(NumCondBranches, "Number of conditional branches");
 STATISTIC(NumUncondBranches, "Number of uncondittional branches");
 STATISTIC(CondBranchTakenFreq,
           "Potential frequency of taking conditional branches");
+STATISTIC(NumColdRegionsMoved, "Number of cold regions moved to function tail");
 STATISTIC(UncondBranchTakenFreq,
           "Potential frequency of taking unconditional branches");
 
@@ -67,6 +68,13 @@ ExitBlockBias("block-placement-exit-block-bias",
                        "over the original exit to be considered the new exit."),
               cl::init(0), cl::Hidden);
 
+// FIXME: Benchmark this on a wider range of code and flip the default.
+static cl::opt<bool> PackColdRegions(
+    "block-placement-pack-cold-regions",
+    cl::desc("Move cold regions that are only reached by explicit jumps to "
+             "the end of the function to compact the hot path."),
+    cl::init(false), cl::Hidden);
+
 namespace {
 class BlockChain;
 /// \brief Type for our function-wide basic block -> block chain mapping.
@@ -232,6 +240,7 @@ class MachineBlockPlacement : public MachineFunctionPass {
   void rotateLoop(BlockChain &LoopChain, MachineBasicBlock *ExitingBB,
                   const BlockFilterSet &LoopBlockSet);
   void buildCFGChains(MachineFunction &F);
+  void packColdRegions(MachineFunction &F);
 
 public:
   static char ID; // Pass identification, replacement for typeid
@@ -1097,6 +1106,57 @@ void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
   }
 }
 
+/// \brief Move cold regions of the laid out function to its tail.
+///
+/// The chain layout above is driven by branch probabilities and will happily
+/// leave a cold region in the middle of the hot path when no fallthrough ties
+/// it there. Each such region pushes the hot blocks around it onto more cache
+/// lines and pages than the hot path needs. This phase walks the final layout,
+/// finds maximal runs of cold blocks whose boundaries carry no fallthrough
+/// (the layout predecessor cannot fall into the run and the run cannot fall
+/// out of itself), and splices them to the end of the function. Because every
+/// edge crossing a moved boundary is an explicit jump, no terminators need
+/// updating. The compaction is deliberately size-agnostic: shrinking the hot
+/// footprint helps for any line or page size.
+void MachineBlockPlacement::packColdRegions(MachineFunction &F) {
+  const BranchProbability ColdProb(1, 5); // Matches the alignment heuristic.
+  BlockFrequency ColdThreshold = MBFI->getBlockFreq(F.begin()) * ColdProb;
+
+  // Collect movable regions first; splicing invalidates the walk.
+  SmallVector<std::pair<MachineBasicBlock *, MachineBasicBlock *>, 8> Regions;
+  for (MachineFunction::iterator FI = std::next(F.begin()), FE = F.end();
+       FI != FE;) {
+    if (!(MBFI->getBlockFreq(FI) < ColdThreshold)) {
+      ++FI;
+      continue;
+    }
+    MachineFunction::iterator Head = FI, Tail = FI;
+    while (std::next(Tail) != FE &&
+           MBFI->getBlockFreq(std::next(Tail)) < ColdThreshold)
+      ++Tail;
+    FI = std::next(Tail);
+
+    // A region already at the end of the function is where we want it.
+    if (std::next(Tail) == FE)
+      continue;
+    // Only move the region if no fallthrough crosses its boundaries.
+    if (std::prev(Head)->canFallThrough() || Tail->canFallThrough())
+      continue;
+    Regions.push_back(std::make_pair(&*Head, &*Tail));
+  }
+
+  // Maximal cold runs are separated by at least one hot block, so the regions
+  // are disjoint and their boundary blocks are unaffected by earlier moves.
+  for (unsigned i = 0, e = Regions.size(); i != e; ++i) {
+    DEBUG(dbgs() << "Packing cold region to function tail: "
+                 << getBlockName(Regions[i].first) << " .. "
+                 << getBlockName(Regions[i].second) << "\n");
+    F.splice(F.end(), MachineFunction::iterator(Regions[i].first),
+             std::next(MachineFunction::iterator(Regions[i].second)));
+    ++NumColdRegionsMoved;
+  }
+}
+
 bool MachineBlockPlacement::runOnMachineFunction(MachineFunction &F) {
   // Check for single-block functions and skip them.
   if (std::next(F.begin()) == F.end())
@@ -1114,6 +1174,10 @@ bool MachineBlockPlacement::runOnMachineFunction(MachineFunction &F) {
 
   buildCFGChains(F);
 
+  if (PackColdRegions &&
+      !F.getFunction()->hasFnAttribute(Attribute::OptimizeForSize))
+    packColdRegions(F);
+
   BlockToChain.clear();
   ChainAllocator.DestroyAll();
 
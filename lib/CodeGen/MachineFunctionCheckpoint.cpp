@@ -0,0 +1,600 @@
+//===-- MachineFunctionCheckpoint.cpp - Machine IR checkpoints ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Save and restore of post-instruction-selection machine function state.
+// See MachineFunctionCheckpoint.h for the scope of the format.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/MachineFunctionCheckpoint.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/CodeGen/MachineConstantPool.h"
+#include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "mf-checkpoint"
+
+static const uint32_t CheckpointMagic = 0x4D46434B; // "MFCK"
+static const uint32_t CheckpointVersion = 1;
+
+//===----------------------------------------------------------------------===//
+//                               Serialization
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Little-endian writer with the few extra encodings the format needs.
+class CheckpointWriter {
+  raw_ostream &OS;
+  support::endian::Writer<support::little> EW;
+
+public:
+  explicit CheckpointWriter(raw_ostream &OS) : OS(OS), EW(OS) {}
+
+  void writeU8(uint8_t V) { EW.write(V); }
+  void writeU32(uint32_t V) { EW.write(V); }
+  void writeU64(uint64_t V) { EW.write(V); }
+  void writeI64(int64_t V) { EW.write(V); }
+  void writeString(StringRef Str) {
+    writeU32(Str.size());
+    OS.write(Str.data(), Str.size());
+  }
+};
+}
+
+static void cannotCheckpoint(const MachineFunction &MF, const Twine &Why) {
+  report_fatal_error("cannot checkpoint machine function '" + MF.getName() +
+                     "': " + Why);
+}
+
+static void serializeOperand(const MachineFunction &MF,
+                             const MachineOperand &MO, CheckpointWriter &W,
+                             const DenseMap<const MachineBasicBlock *, unsigned>
+                                 &BlockIndex) {
+  W.writeU8(MO.getType());
+  switch (MO.getType()) {
+  case MachineOperand::MO_Register: {
+    W.writeU32(MO.getReg());
+    W.writeU32(MO.getSubReg());
+    uint8_t Flags = (MO.isDef() << 0) | (MO.isImplicit() << 1) |
+                    (MO.isKill() << 2) | (MO.isDead() << 3) |
+                    (MO.isUndef() << 4) | (MO.isEarlyClobber() << 5) |
+                    (MO.isDebug() << 6) | (MO.isInternalRead() << 7);
+    W.writeU8(Flags);
+    break;
+  }
+  case MachineOperand::MO_Immediate:
+    W.writeI64(MO.getImm());
+    break;
+  case MachineOperand::MO_MachineBasicBlock:
+    W.writeU8(MO.getTargetFlags());
+    W.writeU32(BlockIndex.lookup(MO.getMBB()));
+    break;
+  case MachineOperand::MO_FrameIndex:
+    W.writeI64(MO.getIndex());
+    break;
+  case MachineOperand::MO_GlobalAddress:
+    // Globals are referenced by name and looked up again in the module on
+    // restore; an unnamed global has no stable identity across processes.
+    if (!MO.getGlobal()->hasName())
+      cannotCheckpoint(MF, "reference to unnamed global");
+    W.writeU8(MO.getTargetFlags());
+    W.writeString(MO.getGlobal()->getName());
+    W.writeI64(MO.getOffset());
+    break;
+  case MachineOperand::MO_ExternalSymbol:
+    W.writeU8(MO.getTargetFlags());
+    W.writeString(MO.getSymbolName());
+    break;
+  case MachineOperand::MO_RegisterMask: {
+    const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+    unsigned NumWords = (TRI->getNumRegs() + 31) / 32;
+    W.writeU32(NumWords);
+    const uint32_t *Mask = MO.getRegMask();
+    for (unsigned i = 0; i != NumWords; ++i)
+      W.writeU32(Mask[i]);
+    break;
+  }
+  default:
+    // Constant pool and jump table indices are rejected with the whole
+    // function before we get here; the remaining kinds (FP and wide
+    // immediates, block addresses, metadata, MCSymbols, CFI indices) are
+    // rare enough after isel that version 1 does not encode them.
+    cannotCheckpoint(MF, "unsupported machine operand kind");
+  }
+}
+
+void llvm::serializeMachineFunction(const MachineFunction &MF,
+                                    raw_ostream &OS) {
+  const MachineFrameInfo &MFI = *MF.getFrameInfo();
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+
+  if (!MF.getConstantPool()->getConstants().empty())
+    cannotCheckpoint(MF, "constant pool is not empty");
+  if (MF.getJumpTableInfo() && !MF.getJumpTableInfo()->isEmpty())
+    cannotCheckpoint(MF, "jump tables are not empty");
+  if (MFI.hasVarSizedObjects())
+    cannotCheckpoint(MF, "variable sized frame objects");
+
+  CheckpointWriter W(OS);
+  W.writeU32(CheckpointMagic);
+  W.writeU32(CheckpointVersion);
+  W.writeString(MF.getName());
+
+  // Function-level state.
+  W.writeU32(MF.getAlignment());
+  W.writeU8((MF.exposesReturnsTwice() << 0) | (MF.hasInlineAsm() << 1));
+
+  // Virtual registers, identified by their register class. Register indexes
+  // are dense, so recreating them in order reproduces the numbering.
+  W.writeU32(MRI.getNumVirtRegs());
+  for (unsigned i = 0, e = MRI.getNumVirtRegs(); i != e; ++i)
+    W.writeU32(MRI.getRegClass(TargetRegisterInfo::index2VirtReg(i))->getID());
+  unsigned NumLiveIns = 0;
+  for (MachineRegisterInfo::livein_iterator I = MRI.livein_begin(),
+       E = MRI.livein_end(); I != E; ++I)
+    ++NumLiveIns;
+  W.writeU32(NumLiveIns);
+  for (MachineRegisterInfo::livein_iterator I = MRI.livein_begin(),
+       E = MRI.livein_end(); I != E; ++I) {
+    W.writeU32(I->first);
+    W.writeU32(I->second);
+  }
+
+  // Frame state. Fixed objects are written in creation order (index -1
+  // downwards) so that recreating them reproduces the indexes.
+  W.writeU8((MFI.adjustsStack() << 0) | (MFI.hasCalls() << 1) |
+            (MFI.isFrameAddressTaken() << 2) |
+            (MFI.isReturnAddressTaken() << 3));
+  W.writeU32(MFI.getMaxCallFrameSize());
+  W.writeU32(MFI.getNumFixedObjects());
+  for (int Idx = -1, End = MFI.getObjectIndexBegin(); Idx >= End; --Idx) {
+    bool Dead = MFI.isDeadObjectIndex(Idx);
+    W.writeU64(Dead ? 0 : MFI.getObjectSize(Idx));
+    W.writeI64(Dead ? 0 : MFI.getObjectOffset(Idx));
+    W.writeU8((Dead << 0) | (MFI.isImmutableObjectIndex(Idx) << 1) |
+              (MFI.isAliasedObjectIndex(Idx) << 2));
+  }
+  W.writeU32(MFI.getObjectIndexEnd());
+  for (int Idx = 0, End = MFI.getObjectIndexEnd(); Idx != End; ++Idx) {
+    bool Dead = MFI.isDeadObjectIndex(Idx);
+    W.writeU64(Dead ? 0 : MFI.getObjectSize(Idx));
+    W.writeU32(Dead ? 1 : MFI.getObjectAlignment(Idx));
+    W.writeU8((Dead << 0) | (MFI.isSpillSlotObjectIndex(Idx) << 1));
+  }
+
+  // Block headers. Blocks are identified by layout position, and their link
+  // back to the IR is recorded as the position of the basic block in the
+  // function. Instructions follow in a second pass so that branch operands
+  // can refer to any block.
+  // Edge weights are only readable through the branch probability analysis;
+  // it is stateless, so a local instance serves. Edges that never had a
+  // weight come back as the analysis' default, which preserves the ratios.
+  MachineBranchProbabilityInfo MBPI;
+  DenseMap<const MachineBasicBlock *, unsigned> BlockIndex;
+  for (MachineFunction::const_iterator MBB = MF.begin(), MBE = MF.end();
+       MBB != MBE; ++MBB)
+    BlockIndex[MBB] = BlockIndex.size();
+  DenseMap<const BasicBlock *, unsigned> IRBlockIndex;
+  for (Function::const_iterator BB = MF.getFunction()->begin(),
+       BE = MF.getFunction()->end(); BB != BE; ++BB)
+    IRBlockIndex[BB] = IRBlockIndex.size();
+
+  W.writeU32(BlockIndex.size());
+  for (MachineFunction::const_iterator MBB = MF.begin(), MBE = MF.end();
+       MBB != MBE; ++MBB) {
+    const BasicBlock *BB = MBB->getBasicBlock();
+    W.writeU32(BB ? IRBlockIndex.lookup(BB) : ~0U);
+    W.writeU32(MBB->getAlignment());
+    W.writeU8((MBB->isLandingPad() << 0) | (MBB->hasAddressTaken() << 1));
+    unsigned NumMBBLiveIns = 0;
+    for (MachineBasicBlock::livein_iterator I = MBB->livein_begin(),
+         E = MBB->livein_end(); I != E; ++I)
+      ++NumMBBLiveIns;
+    W.writeU32(NumMBBLiveIns);
+    for (MachineBasicBlock::livein_iterator I = MBB->livein_begin(),
+         E = MBB->livein_end(); I != E; ++I)
+      W.writeU32(*I);
+    W.writeU32(MBB->succ_size());
+    for (MachineBasicBlock::const_succ_iterator SI = MBB->succ_begin(),
+         SE = MBB->succ_end(); SI != SE; ++SI) {
+      W.writeU32(BlockIndex.lookup(*SI));
+      W.writeU32(MBPI.getEdgeWeight(MBB, SI));
+    }
+  }
+
+  // Instructions. Debug locations and memory operands are deliberately
+  // dropped: locations only affect diagnostics and debug info, and an
+  // instruction without memory operands is treated conservatively.
+  for (MachineFunction::const_iterator MBB = MF.begin(), MBE = MF.end();
+       MBB != MBE; ++MBB) {
+    W.writeU32(MBB->size());
+    for (MachineBasicBlock::const_instr_iterator MI = MBB->instr_begin(),
+         ME = MBB->instr_end(); MI != ME; ++MI) {
+      if (MI->isBundledWithPred() || MI->isBundledWithSucc())
+        cannotCheckpoint(MF, "bundled instructions");
+      W.writeU32(MI->getOpcode());
+      W.writeU8(MI->getFlags());
+      W.writeU32(MI->getNumOperands());
+      for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i)
+        serializeOperand(MF, MI->getOperand(i), W, BlockIndex);
+      // Tied operand pairs, recorded as (def index, use index).
+      unsigned NumTied = 0;
+      for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+        const MachineOperand &MO = MI->getOperand(i);
+        if (MO.isReg() && MO.isUse() && MO.isTied())
+          ++NumTied;
+      }
+      W.writeU32(NumTied);
+      for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+        const MachineOperand &MO = MI->getOperand(i);
+        if (MO.isReg() && MO.isUse() && MO.isTied()) {
+          W.writeU32(MI->findTiedOperandIdx(i));
+          W.writeU32(i);
+        }
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+//                              Deserialization
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Bounds-checked little-endian reader over the checkpoint buffer. Any
+/// malformed input is a fatal error; checkpoints are tool-internal files,
+/// not untrusted input worth recovering from.
+class CheckpointReader {
+  StringRef Data;
+  size_t Pos;
+
+  const char *read(size_t Size) {
+    if (Data.size() - Pos < Size)
+      report_fatal_error("truncated machine function checkpoint");
+    const char *Result = Data.data() + Pos;
+    Pos += Size;
+    return Result;
+  }
+
+public:
+  explicit CheckpointReader(StringRef Data) : Data(Data), Pos(0) {}
+
+  uint8_t readU8() {
+    return *reinterpret_cast<const uint8_t *>(read(1));
+  }
+  uint32_t readU32() {
+    return support::endian::read<uint32_t, support::little,
+                                 support::unaligned>(read(4));
+  }
+  uint64_t readU64() {
+    return support::endian::read<uint64_t, support::little,
+                                 support::unaligned>(read(8));
+  }
+  int64_t readI64() { return (int64_t)readU64(); }
+  StringRef readString() {
+    uint32_t Size = readU32();
+    return StringRef(read(Size), Size);
+  }
+};
+}
+
+static void badCheckpoint(const MachineFunction &MF, const Twine &Why) {
+  report_fatal_error("invalid checkpoint for machine function '" +
+                     MF.getName() + "': " + Why);
+}
+
+/// Copy Str into storage owned by MF, for operands that keep a C string
+/// alive. The register mask allocator is the function's only public
+/// allocation hook; a zero-initialized word array doubles as a terminated
+/// character buffer.
+static const char *copyStringIntoFunction(MachineFunction &MF, StringRef Str) {
+  uint32_t *Words = MF.allocateRegisterMask(/*NumRegister=*/(Str.size() + 1) *
+                                            8);
+  char *Buffer = reinterpret_cast<char *>(Words);
+  std::memcpy(Buffer, Str.data(), Str.size());
+  return Buffer;
+}
+
+static MachineOperand deserializeOperand(
+    MachineFunction &MF, CheckpointReader &R,
+    const std::vector<MachineBasicBlock *> &Blocks) {
+  uint8_t Kind = R.readU8();
+  switch (Kind) {
+  case MachineOperand::MO_Register: {
+    unsigned Reg = R.readU32();
+    unsigned SubReg = R.readU32();
+    uint8_t Flags = R.readU8();
+    return MachineOperand::CreateReg(
+        Reg, /*isDef=*/Flags & (1 << 0), /*isImp=*/Flags & (1 << 1),
+        /*isKill=*/Flags & (1 << 2), /*isDead=*/Flags & (1 << 3),
+        /*isUndef=*/Flags & (1 << 4), /*isEarlyClobber=*/Flags & (1 << 5),
+        SubReg, /*isDebug=*/Flags & (1 << 6),
+        /*isInternalRead=*/Flags & (1 << 7));
+  }
+  case MachineOperand::MO_Immediate:
+    return MachineOperand::CreateImm(R.readI64());
+  case MachineOperand::MO_MachineBasicBlock: {
+    uint8_t TF = R.readU8();
+    uint32_t Index = R.readU32();
+    if (Index >= Blocks.size())
+      badCheckpoint(MF, "basic block operand out of range");
+    return MachineOperand::CreateMBB(Blocks[Index], TF);
+  }
+  case MachineOperand::MO_FrameIndex:
+    return MachineOperand::CreateFI(R.readI64());
+  case MachineOperand::MO_GlobalAddress: {
+    uint8_t TF = R.readU8();
+    StringRef Name = R.readString();
+    int64_t Offset = R.readI64();
+    GlobalValue *GV =
+        MF.getFunction()->getParent()->getNamedValue(Name);
+    if (!GV)
+      badCheckpoint(MF, "reference to unknown global '" + Name + "'");
+    return MachineOperand::CreateGA(GV, Offset, TF);
+  }
+  case MachineOperand::MO_ExternalSymbol: {
+    uint8_t TF = R.readU8();
+    StringRef Name = R.readString();
+    return MachineOperand::CreateES(copyStringIntoFunction(MF, Name), TF);
+  }
+  case MachineOperand::MO_RegisterMask: {
+    const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+    unsigned NumWords = R.readU32();
+    if (NumWords != (TRI->getNumRegs() + 31) / 32)
+      badCheckpoint(MF, "register mask size mismatch");
+    uint32_t *Mask = MF.allocateRegisterMask(TRI->getNumRegs());
+    for (unsigned i = 0; i != NumWords; ++i)
+      Mask[i] = R.readU32();
+    return MachineOperand::CreateRegMask(Mask);
+  }
+  default:
+    badCheckpoint(MF, "unsupported machine operand kind");
+  }
+  llvm_unreachable("badCheckpoint returned");
+}
+
+void llvm::deserializeMachineFunction(MachineFunction &MF,
+                                      MemoryBufferRef Buffer) {
+  assert(MF.empty() && "can only restore into an empty machine function");
+  MachineFrameInfo &MFI = *MF.getFrameInfo();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+
+  CheckpointReader R(Buffer.getBuffer());
+  if (R.readU32() != CheckpointMagic)
+    badCheckpoint(MF, "bad magic number");
+  if (R.readU32() != CheckpointVersion)
+    badCheckpoint(MF, "version mismatch");
+  if (R.readString() != MF.getName())
+    badCheckpoint(MF, "checkpoint is for a different function");
+
+  MF.setAlignment(R.readU32());
+  uint8_t Props = R.readU8();
+  MF.setExposesReturnsTwice(Props & (1 << 0));
+  MF.setHasInlineAsm(Props & (1 << 1));
+
+  // Virtual registers.
+  uint32_t NumVRegs = R.readU32();
+  for (uint32_t i = 0; i != NumVRegs; ++i) {
+    uint32_t RCID = R.readU32();
+    if (RCID >= TRI->getNumRegClasses())
+      badCheckpoint(MF, "register class out of range");
+    unsigned VReg = MRI.createVirtualRegister(TRI->getRegClass(RCID));
+    (void)VReg;
+    assert(TargetRegisterInfo::virtReg2Index(VReg) == i &&
+           "Virtual register numbering not reproduced");
+  }
+  uint32_t NumLiveIns = R.readU32();
+  for (uint32_t i = 0; i != NumLiveIns; ++i) {
+    unsigned PReg = R.readU32();
+    unsigned VReg = R.readU32();
+    MRI.addLiveIn(PReg, VReg);
+  }
+
+  // Frame state.
+  uint8_t FrameFlags = R.readU8();
+  MFI.setAdjustsStack(FrameFlags & (1 << 0));
+  MFI.setHasCalls(FrameFlags & (1 << 1));
+  MFI.setFrameAddressIsTaken(FrameFlags & (1 << 2));
+  MFI.setReturnAddressIsTaken(FrameFlags & (1 << 3));
+  MFI.setMaxCallFrameSize(R.readU32());
+  uint32_t NumFixed = R.readU32();
+  for (uint32_t i = 0; i != NumFixed; ++i) {
+    uint64_t Size = R.readU64();
+    int64_t Offset = R.readI64();
+    uint8_t Flags = R.readU8();
+    int Idx = MFI.CreateFixedObject(Flags & (1 << 0) ? 4 : Size, Offset,
+                                    /*Immutable=*/Flags & (1 << 1),
+                                    /*isAliased=*/Flags & (1 << 2));
+    if (Flags & (1 << 0))
+      MFI.RemoveStackObject(Idx);
+  }
+  uint32_t NumObjects = R.readU32();
+  for (uint32_t i = 0; i != NumObjects; ++i) {
+    uint64_t Size = R.readU64();
+    uint32_t Align = R.readU32();
+    uint8_t Flags = R.readU8();
+    bool Dead = Flags & (1 << 0);
+    int Idx = MFI.CreateStackObject(Dead ? 4 : Size, Dead ? 4 : Align,
+                                    /*isSS=*/Flags & (1 << 1));
+    if (Dead)
+      MFI.RemoveStackObject(Idx);
+  }
+
+  // Basic blocks: create them all first so that successor lists and branch
+  // operands can be resolved, then read the instructions.
+  std::vector<const BasicBlock *> IRBlocks;
+  for (Function::const_iterator BB = MF.getFunction()->begin(),
+       BE = MF.getFunction()->end(); BB != BE; ++BB)
+    IRBlocks.push_back(BB);
+
+  uint32_t NumBlocks = R.readU32();
+  std::vector<MachineBasicBlock *> Blocks;
+  Blocks.reserve(NumBlocks);
+  // Successor indexes can be forward references; stash the (index, weight)
+  // pairs until every block exists.
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> SuccLists(NumBlocks);
+  for (uint32_t i = 0; i != NumBlocks; ++i) {
+    uint32_t IRIndex = R.readU32();
+    if (IRIndex != ~0U && IRIndex >= IRBlocks.size())
+      badCheckpoint(MF, "IR basic block out of range");
+    MachineBasicBlock *MBB = MF.CreateMachineBasicBlock(
+        IRIndex == ~0U ? nullptr : IRBlocks[IRIndex]);
+    MF.push_back(MBB);
+    MBB->setAlignment(R.readU32());
+    uint8_t Flags = R.readU8();
+    MBB->setIsLandingPad(Flags & (1 << 0));
+    if (Flags & (1 << 1))
+      MBB->setHasAddressTaken();
+    uint32_t NumMBBLiveIns = R.readU32();
+    for (uint32_t li = 0; li != NumMBBLiveIns; ++li)
+      MBB->addLiveIn(R.readU32());
+    uint32_t NumSuccs = R.readU32();
+    for (uint32_t s = 0; s != NumSuccs; ++s) {
+      uint32_t Index = R.readU32();
+      uint32_t Weight = R.readU32();
+      SuccLists[i].push_back(std::make_pair(Index, Weight));
+    }
+    Blocks.push_back(MBB);
+  }
+  for (uint32_t i = 0; i != NumBlocks; ++i)
+    for (unsigned s = 0, e = SuccLists[i].size(); s != e; ++s) {
+      if (SuccLists[i][s].first >= NumBlocks)
+        badCheckpoint(MF, "successor out of range");
+      Blocks[i]->addSuccessor(Blocks[SuccLists[i][s].first],
+                              SuccLists[i][s].second);
+    }
+
+  // Instructions.
+  for (uint32_t i = 0; i != NumBlocks; ++i) {
+    MachineBasicBlock *MBB = Blocks[i];
+    uint32_t NumInstrs = R.readU32();
+    for (uint32_t mi = 0; mi != NumInstrs; ++mi) {
+      uint32_t Opcode = R.readU32();
+      if (Opcode >= TII->getNumOpcodes())
+        badCheckpoint(MF, "opcode out of range");
+      uint8_t Flags = R.readU8();
+      // Every operand was saved explicitly, including implicit ones, so
+      // suppress the automatic implicit operands here.
+      MachineInstr *MI =
+          MF.CreateMachineInstr(TII->get(Opcode), DebugLoc(),
+                                /*NoImp=*/true);
+      MBB->push_back(MI);
+      MI->setFlags(Flags);
+      uint32_t NumOps = R.readU32();
+      for (uint32_t op = 0; op != NumOps; ++op)
+        MI->addOperand(MF, deserializeOperand(MF, R, Blocks));
+      uint32_t NumTied = R.readU32();
+      for (uint32_t t = 0; t != NumTied; ++t) {
+        uint32_t DefIdx = R.readU32();
+        uint32_t UseIdx = R.readU32();
+        if (DefIdx >= NumOps || UseIdx >= NumOps)
+          badCheckpoint(MF, "tied operand out of range");
+        MI->tieOperands(DefIdx, UseIdx);
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+//                            Checkpoint passes
+//===----------------------------------------------------------------------===//
+
+static std::string checkpointFileName(StringRef Dir,
+                                      const MachineFunction &MF) {
+  SmallString<128> Path(Dir);
+  sys::path::append(Path, MF.getName() + ".mfc");
+  return Path.str();
+}
+
+namespace {
+struct MachineFunctionCheckpointSaver : public MachineFunctionPass {
+  static char ID;
+  std::string Dir;
+
+  MachineFunctionCheckpointSaver() : MachineFunctionPass(ID) {}
+  explicit MachineFunctionCheckpointSaver(StringRef Dir)
+      : MachineFunctionPass(ID), Dir(Dir) {}
+
+  const char *getPassName() const override {
+    return "Machine Function Checkpoint Saver";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override {
+    std::string Path = checkpointFileName(Dir, MF);
+    std::error_code EC;
+    raw_fd_ostream OS(Path, EC, sys::fs::F_None);
+    if (EC)
+      report_fatal_error("cannot write machine function checkpoint '" + Path +
+                         "': " + EC.message());
+    serializeMachineFunction(MF, OS);
+    return false;
+  }
+};
+
+struct MachineFunctionCheckpointLoader : public MachineFunctionPass {
+  static char ID;
+  std::string Dir;
+
+  MachineFunctionCheckpointLoader() : MachineFunctionPass(ID) {}
+  explicit MachineFunctionCheckpointLoader(StringRef Dir)
+      : MachineFunctionPass(ID), Dir(Dir) {}
+
+  const char *getPassName() const override {
+    return "Machine Function Checkpoint Loader";
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override {
+    std::string Path = checkpointFileName(Dir, MF);
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOr =
+        MemoryBuffer::getFile(Path);
+    if (std::error_code EC = BufferOr.getError())
+      report_fatal_error("cannot read machine function checkpoint '" + Path +
+                         "': " + EC.message());
+    deserializeMachineFunction(MF, (*BufferOr)->getMemBufferRef());
+    return true;
+  }
+};
+}
+
+char MachineFunctionCheckpointSaver::ID = 0;
+char MachineFunctionCheckpointLoader::ID = 0;
+
+MachineFunctionPass *
+llvm::createMachineFunctionCheckpointSaverPass(StringRef Dir) {
+  return new MachineFunctionCheckpointSaver(Dir);
+}
+
+MachineFunctionPass *
+llvm::createMachineFunctionCheckpointLoaderPass(StringRef Dir) {
+  return new MachineFunctionCheckpointLoader(Dir);
+}
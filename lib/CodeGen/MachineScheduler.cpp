@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/CodeGen/MachineScheduler.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PriorityQueue.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
@@ -76,6 +77,10 @@ static cl::opt<bool> EnableMacroFusion("misched-fusion", cl::Hidden,
 static cl::opt<bool> VerifyScheduling("verify-misched", cl::Hidden,
   cl::desc("Verify machine instrs before and after machine scheduling"));
 
+static cl::opt<bool> EnableSchedCache("misched-cache", cl::Hidden,
+  cl::desc("Reuse schedule orders between structurally identical regions"),
+  cl::init(false));
+
 // DAG subtrees must have at least this many nodes.
 static const unsigned MinSubtreeSize = 8;
 
@@ -87,6 +92,27 @@ void ScheduleDAGMutation::anchor() {}
 // Machine Instruction Scheduling Pass and Registry
 //===----------------------------------------------------------------------===//
 
+const std::vector<unsigned> *
+SchedOrderCache::lookup(ArrayRef<uint64_t> Signature) const {
+  uint64_t H = hash_combine_range(Signature.begin(), Signature.end());
+  DenseMap<uint64_t, Entry>::const_iterator I = Entries.find(H);
+  if (I == Entries.end() || I->second.Signature.size() != Signature.size() ||
+      !std::equal(Signature.begin(), Signature.end(),
+                  I->second.Signature.begin()))
+    return nullptr;
+  return &I->second.Order;
+}
+
+void SchedOrderCache::insert(ArrayRef<uint64_t> Signature,
+                             std::vector<unsigned> Order) {
+  uint64_t H = hash_combine_range(Signature.begin(), Signature.end());
+  Entry &E = Entries[H];
+  if (!E.Signature.empty())
+    return; // Hash collision or duplicate: keep the first entry.
+  E.Signature.assign(Signature.begin(), Signature.end());
+  E.Order = std::move(Order);
+}
+
 MachineSchedContext::MachineSchedContext():
     MF(nullptr), MLI(nullptr), MDT(nullptr), PassConfig(nullptr), AA(nullptr), LIS(nullptr) {
   RegClassInfo = new RegisterClassInfo();
@@ -656,6 +682,14 @@ void ScheduleDAGMI::schedule() {
 
   postprocessDAG();
 
+  // A structurally identical region may already have been scheduled; if so,
+  // replay its order instead of running the heuristic again.
+  if (OrderCache) {
+    computeRegionSignature();
+    if (replayCachedSchedule())
+      return;
+  }
+
   SmallVector<SUnit*, 8> TopRoots, BotRoots;
   findRootsAndBiasEdges(TopRoots, BotRoots);
 
@@ -709,6 +743,9 @@ void ScheduleDAGMI::schedule() {
 
   placeDebugValues();
 
+  if (OrderCache)
+    recordSchedule();
+
   DEBUG({
       unsigned BBNum = begin()->getParent()->getNumber();
       dbgs() << "*** Final schedule for BB#" << BBNum << " ***\n";
@@ -810,6 +847,76 @@ void ScheduleDAGMI::placeDebugValues() {
   FirstDbgValue = nullptr;
 }
 
+/// Fingerprint the dependence graph of the current region. Virtual registers
+/// are identified by register class rather than number so that structurally
+/// identical regions (e.g. unrolled loop bodies) produce the same signature.
+/// Dependence edges are recorded by SUnit index, so the signature captures the
+/// full graph structure: two regions with equal signatures have isomorphic
+/// DAGs and can legally share a schedule order.
+void ScheduleDAGMI::computeRegionSignature() {
+  RegionSignature.clear();
+  for (const SUnit &SU : SUnits) {
+    const MachineInstr *MI = SU.getInstr();
+    RegionSignature.push_back(((uint64_t)MI->getOpcode() << 32) |
+                              ((uint64_t)SU.Latency << 16) | SU.NumPreds);
+    for (const SDep &D : SU.Succs) {
+      uint64_t Reg = 0;
+      if (D.getKind() == SDep::Data && D.getReg()) {
+        unsigned R = D.getReg();
+        Reg = TargetRegisterInfo::isVirtualRegister(R)
+                  ? MRI.getRegClass(R)->getID()
+                  : R;
+      }
+      RegionSignature.push_back(((uint64_t)D.getSUnit()->NodeNum << 32) |
+                                ((uint64_t)D.getKind() << 24) |
+                                ((uint64_t)D.getLatency() << 8) |
+                                ((uint64_t)D.isArtificial() << 1) |
+                                (uint64_t)D.isCluster());
+      RegionSignature.push_back(Reg);
+    }
+  }
+}
+
+/// Replay a previously computed schedule order for a structurally identical
+/// region. This places instructions top-down the same way the main driver's
+/// IsTopNode branch does, so LiveIntervals and the region boundary iterators
+/// are updated through the usual moveInstruction path; only the scheduling
+/// heuristic itself is skipped.
+bool ScheduleDAGMI::replayCachedSchedule() {
+  const std::vector<unsigned> *Order = OrderCache->lookup(RegionSignature);
+  if (!Order)
+    return false;
+  assert(Order->size() == SUnits.size() && "cached order size mismatch");
+
+  DEBUG(dbgs() << "Replaying cached schedule for "
+               << SUnits.size() << " SUnits\n");
+  CurrentTop = nextIfDebug(RegionBegin, RegionEnd);
+  CurrentBottom = RegionEnd;
+  for (unsigned Idx : *Order) {
+    SUnit *SU = &SUnits[Idx];
+    MachineInstr *MI = SU->getInstr();
+    if (&*CurrentTop == MI)
+      CurrentTop = nextIfDebug(++CurrentTop, CurrentBottom);
+    else
+      moveInstruction(MI, CurrentTop);
+    SU->isScheduled = true;
+  }
+  placeDebugValues();
+  return true;
+}
+
+void ScheduleDAGMI::recordSchedule() {
+  std::vector<unsigned> Order;
+  Order.reserve(SUnits.size());
+  for (MachineBasicBlock::iterator I = RegionBegin; I != RegionEnd; ++I)
+    if (SUnit *SU = getSUnit(&(*I)))
+      Order.push_back(SU->NodeNum);
+  // A partial schedule (misched-cutoff) leaves instructions unordered; don't
+  // cache it.
+  if (Order.size() == SUnits.size())
+    OrderCache->insert(RegionSignature, std::move(Order));
+}
+
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
 void ScheduleDAGMI::dumpSchedule() const {
   for (MachineBasicBlock::iterator MI = begin(), ME = end(); MI != ME; ++MI) {
@@ -998,6 +1105,15 @@ void ScheduleDAGMILive::schedule() {
 
   postprocessDAG();
 
+  // A structurally identical region may already have been scheduled; if so,
+  // replay its order instead of running the heuristic again. LiveIntervals
+  // are kept up to date by moveInstruction during the replay.
+  if (OrderCache) {
+    computeRegionSignature();
+    if (replayCachedSchedule())
+      return;
+  }
+
   SmallVector<SUnit*, 8> TopRoots, BotRoots;
   findRootsAndBiasEdges(TopRoots, BotRoots);
 
@@ -1043,6 +1159,9 @@ void ScheduleDAGMILive::schedule() {
 
   placeDebugValues();
 
+  if (OrderCache)
+    recordSchedule();
+
   DEBUG({
       unsigned BBNum = begin()->getParent()->getNumber();
       dbgs() << "*** Final schedule for BB#" << BBNum << " ***\n";
@@ -2867,6 +2986,8 @@ void GenericScheduler::schedNode(SUnit *SU, bool IsTopNode) {
 /// default scheduler if the target does not set a default.
 static ScheduleDAGInstrs *createGenericSchedLive(MachineSchedContext *C) {
   ScheduleDAGMILive *DAG = new ScheduleDAGMILive(C, make_unique<GenericScheduler>(C));
+  if (EnableSchedCache)
+    DAG->setOrderCache(&C->SchedCache);
   // Register DAG post-processors.
   //
   // FIXME: extend the mutation API to allow earlier mutations to instantiate
@@ -3015,7 +3136,11 @@ void PostGenericScheduler::schedNode(SUnit *SU, bool IsTopNode) {
 
 /// Create a generic scheduler with no vreg liveness or DAG mutation passes.
 static ScheduleDAGInstrs *createGenericSchedPostRA(MachineSchedContext *C) {
-  return new ScheduleDAGMI(C, make_unique<PostGenericScheduler>(C), /*IsPostRA=*/true);
+  ScheduleDAGMI *DAG =
+      new ScheduleDAGMI(C, make_unique<PostGenericScheduler>(C), /*IsPostRA=*/true);
+  if (EnableSchedCache)
+    DAG->setOrderCache(&C->SchedCache);
+  return DAG;
 }
 
 //===----------------------------------------------------------------------===//
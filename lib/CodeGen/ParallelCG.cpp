@@ -0,0 +1,168 @@
+//===-- ParallelCG.cpp ----------------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements functions that can be used for parallel code generation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+static void codegen(Module *M, raw_ostream &OS, StringRef CPU,
+                    StringRef Features, const TargetOptions &Options,
+                    Reloc::Model RM, CodeModel::Model CM, CodeGenOpt::Level OL,
+                    TargetMachine::CodeGenFileType FT) {
+  std::string Error;
+  const Target *TheTarget =
+      TargetRegistry::lookupTarget(M->getTargetTriple(), Error);
+  if (!TheTarget)
+    report_fatal_error(Twine("splitCodeGen: ") + Error);
+  std::unique_ptr<TargetMachine> TM(TheTarget->createTargetMachine(
+      M->getTargetTriple(), CPU, Features, Options, RM, CM, OL));
+  if (!TM)
+    report_fatal_error("splitCodeGen: could not allocate target machine");
+
+  legacy::PassManager CodeGenPasses;
+  formatted_raw_ostream FOS(OS);
+  if (TM->addPassesToEmitFile(CodeGenPasses, FOS, FT))
+    report_fatal_error("splitCodeGen: target does not support file emission");
+  CodeGenPasses.run(*M);
+}
+
+/// Give every local symbol a name and external linkage so that definitions
+/// and references can be spread across partitions and resolved by the linker.
+static void externalize(GlobalValue &GV) {
+  if (!GV.hasLocalLinkage())
+    return;
+  if (!GV.hasName())
+    GV.setName("__llvmsplit_unnamed");
+  GV.setLinkage(GlobalValue::ExternalLinkage);
+  GV.setVisibility(GlobalValue::HiddenVisibility);
+}
+
+std::unique_ptr<Module>
+llvm::splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_ostream *> OSs,
+                   StringRef CPU, StringRef Features,
+                   const TargetOptions &Options, Reloc::Model RM,
+                   CodeModel::Model CM, CodeGenOpt::Level OL,
+                   TargetMachine::CodeGenFileType FT) {
+  assert(!OSs.empty() && "Output streams must be provided");
+
+  unsigned NumParts = OSs.size();
+  if (NumParts == 1 || !llvm_is_multithreaded()) {
+    codegen(M.get(), *OSs[0], CPU, Features, Options, RM, CM, OL, FT);
+    return M;
+  }
+
+  // The pass managers, MCContext and object writer are all single-threaded, so
+  // rather than trying to share them we round-trip the module through bitcode
+  // and give each worker thread a private copy in its own LLVMContext, with
+  // the function bodies it does not own stripped back to declarations.
+  for (GlobalVariable &GV : M->globals())
+    externalize(GV);
+  for (Function &F : *M)
+    externalize(F);
+  for (GlobalAlias &GA : M->aliases())
+    externalize(GA);
+
+  // Alias definitions must stay in the same partition as their aliasees, and
+  // global variable initializers are cheap to emit, so both are pinned to
+  // partition 0. Function bodies are distributed greedily by instruction
+  // count onto the least loaded partition.
+  DenseSet<const GlobalValue *> Pinned;
+  for (GlobalAlias &GA : M->aliases())
+    if (const GlobalValue *Aliasee =
+            dyn_cast<GlobalValue>(GA.getAliasee()->stripPointerCasts()))
+      Pinned.insert(Aliasee);
+
+  std::vector<unsigned> Partition;
+  std::vector<uint64_t> Load(NumParts, 0);
+  for (Function &F : *M) {
+    unsigned Part = 0;
+    if (!F.isDeclaration() && !Pinned.count(&F)) {
+      for (unsigned I = 1; I != NumParts; ++I)
+        if (Load[I] < Load[Part])
+          Part = I;
+      uint64_t Cost = 1;
+      for (const BasicBlock &BB : F)
+        Cost += BB.size();
+      Load[Part] += Cost;
+    }
+    Partition.push_back(Part);
+  }
+
+  SmallString<0> BC;
+  raw_svector_ostream BCOS(BC);
+  WriteBitcodeToFile(M.get(), BCOS);
+  BCOS.flush();
+
+  std::vector<std::thread> Threads;
+  for (unsigned ThreadNo = 0; ThreadNo != NumParts; ++ThreadNo) {
+    raw_ostream *OS = OSs[ThreadNo];
+    Threads.emplace_back([=, &BC, &Partition] {
+      LLVMContext Ctx;
+      ErrorOr<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+          MemoryBufferRef(StringRef(BC.data(), BC.size()), "split"), Ctx);
+      if (!MOrErr)
+        report_fatal_error("splitCodeGen: failed to read bitcode");
+      std::unique_ptr<Module> MPart = std::move(MOrErr.get());
+
+      unsigned Idx = 0;
+      for (Function &F : *MPart) {
+        if (Partition[Idx] != ThreadNo && !F.isDeclaration())
+          F.deleteBody();
+        ++Idx;
+      }
+      if (ThreadNo != 0) {
+        for (GlobalVariable &GV : MPart->globals())
+          if (GV.hasInitializer())
+            GV.setInitializer(nullptr);
+        for (auto I = MPart->alias_begin(), E = MPart->alias_end(); I != E;) {
+          GlobalAlias *GA = &*I++;
+          std::string Name = GA->getName();
+          GA->setName("");
+          GlobalValue *Decl;
+          Type *ValTy = GA->getType()->getElementType();
+          if (FunctionType *FTy = dyn_cast<FunctionType>(ValTy))
+            Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, Name,
+                                    MPart.get());
+          else
+            Decl = new GlobalVariable(*MPart, ValTy, false,
+                                      GlobalValue::ExternalLinkage, nullptr,
+                                      Name);
+          GA->replaceAllUsesWith(Decl);
+          GA->eraseFromParent();
+        }
+      }
+
+      codegen(MPart.get(), *OS, CPU, Features, Options, RM, CM, OL, FT);
+    });
+  }
+
+  for (std::thread &T : Threads)
+    T.join();
+
+  return M;
+}
@@ -20,6 +20,8 @@
 #include "SpillPlacement.h"
 #include "Spiller.h"
 #include "SplitKit.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/CalcSpillWeights.h"
@@ -92,6 +94,14 @@ CSRFirstTimeCost("regalloc-csr-first-time-cost",
               cl::desc("Cost for first time use of callee-saved register."),
               cl::init(0), cl::Hidden);
 
+static cl::opt<unsigned> HugeFunctionThreshold(
+    "regalloc-huge-function-threshold", cl::Hidden,
+    cl::desc("Number of virtual registers above which the greedy allocator "
+             "trades code quality for allocation time: each range is "
+             "assigned or spilled in a single round, without eviction or "
+             "splitting. 0 disables the cutoff."),
+    cl::init(50000));
+
 static RegisterRegAlloc greedyRegAlloc("greedy", "greedy register allocator",
                                        createGreedyRegisterAllocator);
 
@@ -126,6 +136,12 @@ class RAGreedy : public MachineFunctionPass,
   PQueue Queue;
   unsigned NextCascade;
 
+  // Set when the function has more virtual registers than
+  // HugeFunctionThreshold. Eviction and splitting are quadratic in the worst
+  // case because every decision can requeue other ranges; above the
+  // threshold each range is assigned or spilled in one round instead.
+  bool IsHugeFunction;
+
   // Live ranges pass through a number of stages as we try to allocate them.
   // Some of the stages may also create new live ranges:
   //
@@ -354,6 +370,8 @@ private:
                     SmallVectorImpl<unsigned>&, unsigned = ~0u);
   unsigned tryRegionSplit(LiveInterval&, AllocationOrder&,
                           SmallVectorImpl<unsigned>&);
+  /// Compute a digest of a candidate's interference pattern.
+  uint64_t interferenceSignature(InterferenceCache::Cursor &Intf);
   /// Calculate cost of region splitting.
   unsigned calculateRegionSplitCost(LiveInterval &VirtReg,
                                     AllocationOrder &Order,
@@ -1339,12 +1357,50 @@ unsigned RAGreedy::tryRegionSplit(LiveInterval &VirtReg, AllocationOrder &Order,
   return doRegionSplit(VirtReg, BestCand, HasCompact, NewVRegs);
 }
 
+/// interferenceSignature - Compute a digest of the interference pattern seen
+/// by Intf over all the blocks region splitting may inspect: the use blocks
+/// and the live-through blocks of the current live range. Candidates with
+/// identical signatures present identical constraints to SpillPlacement and
+/// therefore produce the same live bundles and the same split cost.
+uint64_t RAGreedy::interferenceSignature(InterferenceCache::Cursor &Intf) {
+  hash_code Hash = hash_value(0);
+  ArrayRef<SplitAnalysis::BlockInfo> UseBlocks = SA->getUseBlocks();
+  for (unsigned i = 0; i != UseBlocks.size(); ++i) {
+    unsigned Number = UseBlocks[i].MBB->getNumber();
+    Intf.moveToBlock(Number);
+    if (!Intf.hasInterference())
+      continue;
+    SlotIndex Start = Indexes->getMBBStartIdx(Number);
+    Hash = hash_combine(Hash, Number, Start.distance(Intf.first()),
+                        Start.distance(Intf.last()));
+  }
+  const BitVector &ThroughBlocks = SA->getThroughBlocks();
+  for (int Number = ThroughBlocks.find_first(); Number >= 0;
+       Number = ThroughBlocks.find_next(Number)) {
+    Intf.moveToBlock(Number);
+    if (!Intf.hasInterference())
+      continue;
+    SlotIndex Start = Indexes->getMBBStartIdx(Number);
+    Hash = hash_combine(Hash, Number, Start.distance(Intf.first()),
+                        Start.distance(Intf.last()));
+  }
+  return Hash;
+}
+
 unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
                                             AllocationOrder &Order,
                                             BlockFrequency &BestCost,
                                             unsigned &NumCands,
                                             bool IgnoreCSR) {
   unsigned BestCand = NoCand;
+
+  // Registers with identical interference patterns yield the same bundles at
+  // the same cost, and a later candidate never beats an earlier one of equal
+  // cost, so the duplicated SpillPlacement solves can be skipped entirely.
+  // Large register classes frequently contain many such twins: all registers
+  // without fixed interference look the same to the split algorithm.
+  SmallDenseMap<uint64_t, unsigned, 8> SeenPatterns;
+
   Order.rewind();
   while (unsigned PhysReg = Order.next()) {
    if (unsigned CSR = RegClassInfo.getLastCalleeSavedAlias(PhysReg))
@@ -1374,6 +1430,15 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
     GlobalSplitCandidate &Cand = GlobalCand[NumCands];
     Cand.reset(IntfCache, PhysReg);
 
+    uint64_t Sig = interferenceSignature(Cand.Intf);
+    std::pair<SmallDenseMap<uint64_t, unsigned, 8>::iterator, bool> Seen =
+        SeenPatterns.insert(std::make_pair(Sig, PhysReg));
+    if (!Seen.second) {
+      DEBUG(dbgs() << PrintReg(PhysReg, TRI) << "\tsame interference as "
+                   << PrintReg(Seen.first->second, TRI) << ", skipping\n");
+      continue;
+    }
+
     SpillPlacer->prepare(Cand.LiveBundles);
     BlockFrequency Cost;
     if (!addSplitConstraints(Cand.Intf, Cost)) {
@@ -2448,7 +2513,8 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
     // When NewVRegs is not empty, we may have made decisions such as evicting
     // a virtual register, go with the earlier decisions and use the physical
     // register.
-    if (CSRCost.getFrequency() && CSRFirstUse && NewVRegs.empty()) {
+    if (CSRCost.getFrequency() && CSRFirstUse && NewVRegs.empty() &&
+        !IsHugeFunction) {
       unsigned CSRReg = tryAssignCSRFirstTime(VirtReg, Order, PhysReg,
                                               CostPerUseLimit, NewVRegs);
       if (CSRReg || !NewVRegs.empty())
@@ -2465,8 +2531,12 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
 
   // Try to evict a less worthy live range, but only for ranges from the primary
   // queue. The RS_Split ranges already failed to do this, and they should not
-  // get a second chance until they have been split.
-  if (Stage != RS_Split)
+  // get a second chance until they have been split. In huge functions
+  // eviction chains are one of the main sources of queue churn; skip them
+  // along with splitting and go straight to the spiller below. Ranges the
+  // spiller itself created must keep their eviction privilege, though, or
+  // an unlucky reload could fail to allocate at all.
+  if (Stage != RS_Split && (!IsHugeFunction || Stage == RS_Done))
     if (unsigned PhysReg =
             tryEvict(VirtReg, Order, NewVRegs, CostPerUseLimit)) {
       unsigned Hint = MRI->getSimpleHint(VirtReg.reg);
@@ -2485,7 +2555,7 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
   // The first time we see a live range, don't try to split or spill.
   // Wait until the second time, when all smaller ranges have been allocated.
   // This gives a better picture of the interference to split around.
-  if (Stage < RS_Split) {
+  if (Stage < RS_Split && !IsHugeFunction) {
     setStage(VirtReg, RS_Split);
     DEBUG(dbgs() << "wait for second round\n");
     NewVRegs.push_back(VirtReg.reg);
@@ -2499,9 +2569,11 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
                                    Depth);
 
   // Try splitting VirtReg or interferences.
-  unsigned PhysReg = trySplit(VirtReg, Order, NewVRegs);
-  if (PhysReg || !NewVRegs.empty())
-    return PhysReg;
+  if (!IsHugeFunction) {
+    unsigned PhysReg = trySplit(VirtReg, Order, NewVRegs);
+    if (PhysReg || !NewVRegs.empty())
+      return PhysReg;
+  }
 
   // Finally spill VirtReg itself.
   NamedRegionTimer T("Spiller", TimerGroupName, TimePassesIsEnabled);
@@ -2556,6 +2628,10 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   ExtraRegInfo.clear();
   ExtraRegInfo.resize(MRI->getNumVirtRegs());
   NextCascade = 1;
+  IsHugeFunction = HugeFunctionThreshold &&
+                   MRI->getNumVirtRegs() > HugeFunctionThreshold;
+  DEBUG(if (IsHugeFunction) dbgs()
+        << "Huge function: allocating without eviction or splitting.\n");
   IntfCache.init(MF, Matrix->getLiveUnions(), Indexes, LIS, TRI);
   GlobalCand.resize(32);  // This will grow as needed.
   SetOfBrokenHints.clear();
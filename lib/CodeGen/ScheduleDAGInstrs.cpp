@@ -49,6 +49,12 @@ static cl::opt<bool> EnableAASchedMI("enable-aa-sched-mi", cl::Hidden,
 static cl::opt<bool> UseTBAA("use-tbaa-in-sched-mi", cl::Hidden,
     cl::init(true), cl::desc("Enable use of TBAA during MI DAG construction"));
 
+static cl::opt<unsigned> HugeRegion("sched-huge-region", cl::Hidden,
+    cl::init(1000),
+    cl::desc("Limit on the number of memory operations tracked for precise "
+             "chain dependencies during MI DAG construction; above it the "
+             "tracked state is collapsed onto a single representative"));
+
 ScheduleDAGInstrs::ScheduleDAGInstrs(MachineFunction &mf,
                                      const MachineLoopInfo *mli,
                                      bool IsPostRAFlag, bool RemoveKillFlags,
@@ -678,6 +684,56 @@ void addChainDependency (AliasAnalysis *AA, const MachineFrameInfo *MFI,
   }
 }
 
+/// Order SUb after SUa with an unconditional may-alias chain edge. Helper for
+/// coarsenChainDeps; SUnit::addPred ignores duplicate edges.
+static void addCoarsenedChainDep(SUnit *SUa, SUnit *SUb,
+                                 unsigned TrueMemOrderLatency) {
+  if (SUa == SUb)
+    return;
+  SDep Dep(SUa, SDep::MayAliasMem);
+  Dep.setLatency(SUb->getInstr()->mayLoad() ? TrueMemOrderLatency : 0);
+  SUb->addPred(Dep);
+}
+
+/// Collapse the may-alias tracking state onto SU: order SU before every
+/// tracked SUnit with an unconditional may-alias edge, then clear the
+/// containers, leaving SU as the single representative (the alias chain) that
+/// the remaining, earlier instructions in the region link against. This caps
+/// the number of dependence edges and alias queries in memory-op-dense
+/// regions at the price of some false dependencies. Precision for an earlier
+/// instruction that is proven not to alias SU itself is recovered by
+/// adjustChainDeps walking SU's memory successors, which now include the
+/// whole collapsed set.
+static void coarsenChainDeps(SUnit *SU, SUnit *AliasChain,
+                      MapVector<ValueType, std::vector<SUnit *> > &AliasMemDefs,
+                      MapVector<ValueType, std::vector<SUnit *> > &AliasMemUses,
+                      std::vector<SUnit *> &PendingLoads,
+                      std::set<SUnit *> &RejectMemNodes,
+                      unsigned TrueMemOrderLatency) {
+  DEBUG(dbgs() << "Coarsening chain deps onto SU(" << SU->NodeNum << ")\n");
+
+  if (AliasChain)
+    addCoarsenedChainDep(SU, AliasChain, TrueMemOrderLatency);
+  for (MapVector<ValueType, std::vector<SUnit *> >::iterator I =
+         AliasMemDefs.begin(), E = AliasMemDefs.end(); I != E; ++I)
+    for (unsigned i = 0, e = I->second.size(); i != e; ++i)
+      addCoarsenedChainDep(SU, I->second[i], TrueMemOrderLatency);
+  for (MapVector<ValueType, std::vector<SUnit *> >::iterator I =
+         AliasMemUses.begin(), E = AliasMemUses.end(); I != E; ++I)
+    for (unsigned i = 0, e = I->second.size(); i != e; ++i)
+      addCoarsenedChainDep(SU, I->second[i], TrueMemOrderLatency);
+  for (unsigned k = 0, m = PendingLoads.size(); k != m; ++k)
+    addCoarsenedChainDep(SU, PendingLoads[k], TrueMemOrderLatency);
+  for (std::set<SUnit *>::iterator I = RejectMemNodes.begin(),
+         E = RejectMemNodes.end(); I != E; ++I)
+    addCoarsenedChainDep(SU, *I, TrueMemOrderLatency);
+
+  AliasMemDefs.clear();
+  AliasMemUses.clear();
+  PendingLoads.clear();
+  RejectMemNodes.clear();
+}
+
 /// Create an SUnit for each real instruction, numbered in top-down toplological
 /// order. The instruction order A < B, implies that no edge exists from B to A.
 ///
@@ -770,6 +826,12 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
   MapVector<ValueType, std::vector<SUnit *> > AliasMemUses, NonAliasMemUses;
   std::set<SUnit*> RejectMemNodes;
 
+  // Number of SUnits held by the may-alias containers above, excluding
+  // RejectMemNodes whose size is directly available. Once the total passes
+  // HugeRegion, the tracked state is collapsed by coarsenChainDeps so that
+  // dependence construction cannot go quadratic in memory-op-dense regions.
+  unsigned NumAliasMemSUs = 0;
+
   // Remove any stale debug info; sometimes BuildSchedGraph is called again
   // without emitting the info from the previous call.
   DbgValues.clear();
@@ -892,7 +954,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
       // fall-through
     new_alias_chain:
       // Chain all possibly aliasing memory references through SU.
-      if (AliasChain) {
+      if (AliasChain && AliasChain != SU) {
         unsigned ChainLatency = 0;
         if (AliasChain->getInstr()->mayLoad())
           ChainLatency = TrueMemOrderLatency;
@@ -919,6 +981,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
       PendingLoads.clear();
       AliasMemDefs.clear();
       AliasMemUses.clear();
+      NumAliasMemSUs = 0;
     } else if (MI->mayStore()) {
       // Add dependence on barrier chain, if needed.
       // There is no point to check aliasing on barrier event. Even if
@@ -927,6 +990,15 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
       if (BarrierChain)
         BarrierChain->addPred(SDep(SU, SDep::Barrier));
 
+      // If the may-alias tracking state has grown huge, collapse it onto
+      // this store, which becomes the new alias chain.
+      if (NumAliasMemSUs + RejectMemNodes.size() > HugeRegion) {
+        coarsenChainDeps(SU, AliasChain, AliasMemDefs, AliasMemUses,
+                         PendingLoads, RejectMemNodes, TrueMemOrderLatency);
+        AliasChain = SU;
+        NumAliasMemSUs = 0;
+      }
+
       UnderlyingObjectsVector Objs;
       getUnderlyingObjectsForInstr(MI, MFI, Objs);
 
@@ -956,14 +1028,20 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
                                0, true);
 
           // If we're not using AA, then we only need one store per object.
-          if (!AAForDep)
+          if (!AAForDep) {
+            if (ThisMayAlias)
+              NumAliasMemSUs -= I->second.size();
             I->second.clear();
+          }
           I->second.push_back(SU);
+          if (ThisMayAlias)
+            ++NumAliasMemSUs;
         } else {
           if (ThisMayAlias) {
             if (!AAForDep)
               AliasMemDefs[V].clear();
             AliasMemDefs[V].push_back(SU);
+            ++NumAliasMemSUs;
           } else {
             if (!AAForDep)
               NonAliasMemDefs[V].clear();
@@ -979,6 +1057,8 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
           for (unsigned i = 0, e = J->second.size(); i != e; ++i)
             addChainDependency(AAForDep, MFI, SU, J->second[i], RejectMemNodes,
                                TrueMemOrderLatency, true);
+          if (ThisMayAlias)
+            NumAliasMemSUs -= J->second.size();
           J->second.clear();
         }
       }
@@ -989,7 +1069,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
           addChainDependency(AAForDep, MFI, SU, PendingLoads[k], RejectMemNodes,
                              TrueMemOrderLatency);
         // Add dependence on alias chain, if needed.
-        if (AliasChain)
+        if (AliasChain && AliasChain != SU)
           addChainDependency(AAForDep, MFI, SU, AliasChain, RejectMemNodes);
       }
       adjustChainDeps(AA, MFI, SU, &ExitSU, RejectMemNodes,
@@ -999,6 +1079,15 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
       if (MI->isInvariantLoad(AA)) {
         // Invariant load, no chain dependencies needed!
       } else {
+        // If the may-alias tracking state has grown huge, collapse it onto
+        // this load, which becomes the new alias chain.
+        if (NumAliasMemSUs + RejectMemNodes.size() > HugeRegion) {
+          coarsenChainDeps(SU, AliasChain, AliasMemDefs, AliasMemUses,
+                           PendingLoads, RejectMemNodes, TrueMemOrderLatency);
+          AliasChain = SU;
+          NumAliasMemSUs = 0;
+        }
+
         UnderlyingObjectsVector Objs;
         getUnderlyingObjectsForInstr(MI, MFI, Objs);
 
@@ -1012,6 +1101,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
                                  RejectMemNodes);
 
           PendingLoads.push_back(SU);
+          ++NumAliasMemSUs;
           MayAlias = true;
         } else {
           MayAlias = false;
@@ -1034,15 +1124,16 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
             for (unsigned i = 0, e = I->second.size(); i != e; ++i)
               addChainDependency(AAForDep, MFI, SU, I->second[i],
                                  RejectMemNodes, 0, true);
-          if (ThisMayAlias)
+          if (ThisMayAlias) {
             AliasMemUses[V].push_back(SU);
-          else
+            ++NumAliasMemSUs;
+          } else
             NonAliasMemUses[V].push_back(SU);
         }
         if (MayAlias)
           adjustChainDeps(AA, MFI, SU, &ExitSU, RejectMemNodes, /*Latency=*/0);
         // Add dependencies on alias and barrier chains, if needed.
-        if (MayAlias && AliasChain)
+        if (MayAlias && AliasChain && AliasChain != SU)
           addChainDependency(AAForDep, MFI, SU, AliasChain, RejectMemNodes);
         if (BarrierChain)
           BarrierChain->addPred(SDep(SU, SDep::Barrier));
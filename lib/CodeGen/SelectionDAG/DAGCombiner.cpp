@@ -98,21 +98,18 @@ namespace {
     /// back and when processing we pop off of the back.
     ///
     /// The worklist will not contain duplicates but may contain null entries
-    /// due to nodes being deleted from the underlying DAG.
+    /// due to nodes being deleted from the underlying DAG. Membership and
+    /// each node's position are stored in the node itself
+    /// (SDNode::getCombinerWorklistIndex), not in a side table.
     SmallVector<SDNode *, 64> Worklist;
 
-    /// \brief Mapping from an SDNode to its position on the worklist.
+    /// \brief The epoch of this combiner run.
     ///
-    /// This is used to find and remove nodes from the worklist (by nulling
-    /// them) when they are deleted from the underlying DAG. It relies on
-    /// stable indices of nodes within the worklist.
-    DenseMap<SDNode *, unsigned> WorklistMap;
-
-    /// \brief Set of nodes which have been combined (at least once).
-    ///
-    /// This is used to allow us to reliably add any operands of a DAG node
-    /// which have not yet been combined to the worklist.
-    SmallPtrSet<SDNode *, 64> CombinedNodes;
+    /// A node whose combiner epoch matches this has been combined at least
+    /// once during this run; its not-yet-combined operands still need to be
+    /// queued. Stamps from earlier runs over the same DAG are stale by
+    /// construction, so nothing has to be cleared between runs.
+    unsigned CombineEpoch;
 
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis &AA;
@@ -136,21 +133,25 @@ namespace {
       if (N->getOpcode() == ISD::HANDLENODE)
         return;
 
-      if (WorklistMap.insert(std::make_pair(N, Worklist.size())).second)
+      if (N->getCombinerWorklistIndex() < 0) {
+        N->setCombinerWorklistIndex(Worklist.size());
         Worklist.push_back(N);
+      }
     }
 
     /// Remove all instances of N from the worklist.
     void removeFromWorklist(SDNode *N) {
-      CombinedNodes.erase(N);
+      // Drop the visit stamp, so N is treated as never combined if it is
+      // queued again.
+      N->setCombinerEpoch(0);
 
-      auto It = WorklistMap.find(N);
-      if (It == WorklistMap.end())
+      int Index = N->getCombinerWorklistIndex();
+      if (Index < 0)
         return; // Not in the worklist.
 
       // Null out the entry rather than erasing it to avoid a linear operation.
-      Worklist[It->second] = nullptr;
-      WorklistMap.erase(It);
+      Worklist[Index] = nullptr;
+      N->setCombinerWorklistIndex(-1);
     }
 
     void deleteAndRecombine(SDNode *N);
@@ -402,7 +403,8 @@ namespace {
   public:
     DAGCombiner(SelectionDAG &D, AliasAnalysis &A, CodeGenOpt::Level OL)
         : DAG(D), TLI(D.getTargetLoweringInfo()), Level(BeforeLegalizeTypes),
-          OptLevel(OL), LegalOperations(false), LegalTypes(false), AA(A) {
+          OptLevel(OL), LegalOperations(false), LegalTypes(false),
+          CombineEpoch(0), AA(A) {
       auto *F = DAG.getMachineFunction().getFunction();
       ForCodeSize = F->hasFnAttribute(Attribute::OptimizeForSize) ||
                     F->hasFnAttribute(Attribute::MinSize);
@@ -1174,11 +1176,17 @@ bool DAGCombiner::recursivelyDeleteUnusedNodes(SDNode *N) {
 //  Main DAG Combiner implementation
 //===----------------------------------------------------------------------===//
 
+/// Monotonic count of combiner runs on this thread. Each DAGCombiner::Run
+/// draws a fresh epoch from it, which makes the per-node visit stamps left
+/// behind by earlier runs over the same DAG stale by construction.
+static LLVM_THREAD_LOCAL unsigned CombinerRunEpoch = 0;
+
 void DAGCombiner::Run(CombineLevel AtLevel) {
   // set the instance variables, so that the various visit routines may use it.
   Level = AtLevel;
   LegalOperations = Level >= AfterLegalizeVectorOps;
   LegalTypes = Level >= AfterLegalizeTypes;
+  CombineEpoch = ++CombinerRunEpoch;
 
   // Early exit if this basic block is in an optnone function.
   if (DAG.getMachineFunction().getFunction()->hasFnAttribute(
@@ -1197,17 +1205,16 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
 
   // while the worklist isn't empty, find a node and
   // try and combine it.
-  while (!WorklistMap.empty()) {
-    SDNode *N;
-    // The Worklist holds the SDNodes in order, but it may contain null entries.
-    do {
-      N = Worklist.pop_back_val();
-    } while (!N);
+  while (!Worklist.empty()) {
+    // The Worklist holds the SDNodes in order, but it may contain null
+    // entries for nodes that were deleted from the underlying DAG.
+    SDNode *N = Worklist.pop_back_val();
+    if (!N)
+      continue;
 
-    bool GoodWorklistEntry = WorklistMap.erase(N);
-    (void)GoodWorklistEntry;
-    assert(GoodWorklistEntry &&
-           "Found a worklist entry without a corresponding map entry!");
+    assert(N->getCombinerWorklistIndex() == (int)Worklist.size() &&
+           "Found a worklist entry without a matching index on the node!");
+    N->setCombinerWorklistIndex(-1);
 
     // If N has no uses, it is dead.  Make sure to revisit all N's operands once
     // N is deleted from the DAG, since they too may now be dead or may have a
@@ -1236,9 +1243,9 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
     // Add any operands of the new node which have not yet been combined to the
     // worklist as well. Because the worklist uniques things already, this
     // won't repeatedly process the same operand.
-    CombinedNodes.insert(N);
+    N->setCombinerEpoch(CombineEpoch);
     for (unsigned i = 0, e = N->getNumOperands(); i != e; ++i)
-      if (!CombinedNodes.count(N->getOperand(i).getNode()))
+      if (N->getOperand(i).getNode()->getCombinerEpoch() != CombineEpoch)
         AddToWorklist(N->getOperand(i).getNode());
 
     SDValue RV = combine(N);
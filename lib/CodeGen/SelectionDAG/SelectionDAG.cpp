@@ -707,8 +707,11 @@ void SelectionDAG::DeallocateNode(SDNode *N) {
   NodeAllocator.Deallocate(AllNodes.remove(N));
 
   // If any of the SDDbgValue nodes refer to this SDNode, invalidate
-  // them and forget about that node.
-  DbgInfo->erase(N);
+  // them and forget about that node. Checking first saves a hash lookup per
+  // deallocated node when the function has no debug info, which matters when
+  // the whole DAG is torn down after each block.
+  if (!DbgInfo->empty())
+    DbgInfo->erase(N);
 }
 
 #ifndef NDEBUG
@@ -961,7 +964,12 @@ BinarySDNode *SelectionDAG::GetBinarySDNode(unsigned Opcode, SDLoc DL,
 
 void SelectionDAG::clear() {
   allnodes_clear();
-  OperandAllocator.Reset();
+  // Keep the operand slabs for the next block rather than returning them to
+  // malloc: clear() runs once per basic block, and the next block's operand
+  // lists will fill to a similar level. This retains the high-water mark of
+  // operand memory, just as the recycling NodeAllocator (which is never
+  // reset) does for the nodes themselves.
+  OperandAllocator.ResetKeepingSlabs();
   CSEMap.clear();
 
   ExtendedValueTypeNodes.clear();
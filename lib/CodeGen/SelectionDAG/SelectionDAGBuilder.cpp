@@ -78,6 +78,13 @@ LimitFPPrecision("limit-float-precision",
                  cl::location(LimitFloatPrecision),
                  cl::init(0));
 
+static cl::opt<unsigned> SwitchPeelThreshold(
+    "switch-peel-threshold", cl::Hidden, cl::init(66),
+    cl::desc("Set the case weight threshold (in percent of the total weight "
+             "of the switch) above which a case is peeled into a "
+             "compare-and-branch ahead of the rest of the lowering. A value "
+             "greater than 100 disables peeling."));
+
 // Limit the width of DAG chains. This is important in general to prevent
 // prevent DAG-based analysis from blowing up. For example, alias analysis and
 // load clustering may not complete in reasonable time. It is difficult to
@@ -2785,9 +2792,50 @@ void SelectionDAGBuilder::visitSwitch(const SwitchInst &SI) {
   // Get the Value to be switched on.
   const Value *SV = SI.getCondition();
 
+  // If profile info shows one case taking the bulk of the hits, peel it off
+  // into a compare-and-branch ahead of whatever the remaining cases lower to,
+  // so the dominant case does not pay for a jump table load or a walk down
+  // the binary tree.  Small ranges already order their compares by weight in
+  // handleSmallSwitchRange.
+  MachineBasicBlock *FirstCaseMBB = SwitchMBB;
+  if (FuncInfo.BPI && Cases.size() > 3 && SwitchPeelThreshold <= 100) {
+    uint64_t TotalWeight =
+        FuncInfo.BPI->getEdgeWeight(SI.getParent(), (unsigned)0);
+    CaseItr Dominant = Cases.begin();
+    for (CaseItr I = Cases.begin(), E = Cases.end(); I != E; ++I) {
+      TotalWeight += I->ExtraWeight;
+      if (I->ExtraWeight > Dominant->ExtraWeight)
+        Dominant = I;
+    }
+    if (TotalWeight && Dominant->Low == Dominant->High &&
+        uint64_t(Dominant->ExtraWeight) * 100 >=
+            uint64_t(SwitchPeelThreshold) * TotalWeight) {
+      // Lower the remaining cases from a fresh block that becomes the false
+      // destination of the peeled compare.  Insert it right after the switch
+      // block so the false branch falls through.
+      MachineFunction::iterator BBI = SwitchMBB;
+      ++BBI;
+      MachineBasicBlock *PeeledSwitchMBB =
+          FuncInfo.MF->CreateMachineBasicBlock(SI.getParent());
+      FuncInfo.MF->insert(BBI, PeeledSwitchMBB);
+
+      uint32_t PeeledWeight = Dominant->ExtraWeight;
+      CaseBlock CB(ISD::SETEQ, SV, Dominant->Low, nullptr, Dominant->BB,
+                   PeeledSwitchMBB, SwitchMBB, PeeledWeight,
+                   uint32_t(TotalWeight - PeeledWeight));
+
+      // Put SV in a virtual register to make it available from the new block.
+      ExportFromCurrentBlock(SV);
+      visitSwitchCase(CB, SwitchMBB);
+
+      Cases.erase(Dominant);
+      FirstCaseMBB = PeeledSwitchMBB;
+    }
+  }
+
   // Push the initial CaseRec onto the worklist
   CaseRecVector WorkList;
-  WorkList.push_back(CaseRec(SwitchMBB,nullptr,nullptr,
+  WorkList.push_back(CaseRec(FirstCaseMBB,nullptr,nullptr,
                              CaseRange(Cases.begin(),Cases.end())));
 
   while (!WorkList.empty()) {
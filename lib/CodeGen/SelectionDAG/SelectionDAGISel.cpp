@@ -46,6 +46,8 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
@@ -1488,6 +1490,12 @@ SelectionDAGISel::FinishBasicBlock() {
   if (MustUpdatePHINodes)
     return;
 
+  // Remember the block the LLVM BB expanded to; the lowering loops below
+  // repoint FuncInfo->MBB at the auxiliary blocks they emit, but branches
+  // emitted directly from the switch block (e.g. a peeled dominant case)
+  // still need their PHI nodes updated against this block.
+  MachineBasicBlock *SwitchMBB = FuncInfo->MBB;
+
   for (unsigned i = 0, e = SDB->BitTestCases.size(); i != e; ++i) {
     // Lower header first, if it wasn't already lowered
     if (!SDB->BitTestCases[i].Emitted) {
@@ -1607,8 +1615,8 @@ SelectionDAGISel::FinishBasicBlock() {
     MachineInstrBuilder PHI(*MF, FuncInfo->PHINodesToUpdate[i].first);
     assert(PHI->isPHI() &&
            "This is not a machine PHI node that we are updating!");
-    if (FuncInfo->MBB->isSuccessor(PHI->getParent()))
-      PHI.addReg(FuncInfo->PHINodesToUpdate[i].second).addMBB(FuncInfo->MBB);
+    if (SwitchMBB->isSuccessor(PHI->getParent()))
+      PHI.addReg(FuncInfo->PHINodesToUpdate[i].second).addMBB(SwitchMBB);
   }
 
   // If we generated any switch lowering information, build and codegen any
@@ -2558,6 +2566,119 @@ public:
 };
 }
 
+static cl::opt<bool> EnableMatcherStats(
+    "dagisel-matcher-stats", cl::Hidden,
+    cl::desc("Print a dynamic frequency histogram of interpreted matcher "
+             "table opcodes at exit"));
+
+/// getMatcherOpcodeName - Return the name of a matcher table opcode for the
+/// -dagisel-matcher-stats histogram, or null if the byte is not a known
+/// opcode.
+static const char *getMatcherOpcodeName(unsigned Opcode) {
+  switch ((SelectionDAGISel::BuiltinOpcodes)Opcode) {
+  case SelectionDAGISel::OPC_Scope:                 return "OPC_Scope";
+  case SelectionDAGISel::OPC_RecordNode:            return "OPC_RecordNode";
+  case SelectionDAGISel::OPC_RecordChild0:          return "OPC_RecordChild0";
+  case SelectionDAGISel::OPC_RecordChild1:          return "OPC_RecordChild1";
+  case SelectionDAGISel::OPC_RecordChild2:          return "OPC_RecordChild2";
+  case SelectionDAGISel::OPC_RecordChild3:          return "OPC_RecordChild3";
+  case SelectionDAGISel::OPC_RecordChild4:          return "OPC_RecordChild4";
+  case SelectionDAGISel::OPC_RecordChild5:          return "OPC_RecordChild5";
+  case SelectionDAGISel::OPC_RecordChild6:          return "OPC_RecordChild6";
+  case SelectionDAGISel::OPC_RecordChild7:          return "OPC_RecordChild7";
+  case SelectionDAGISel::OPC_RecordMemRef:          return "OPC_RecordMemRef";
+  case SelectionDAGISel::OPC_CaptureGlueInput:      return "OPC_CaptureGlueInput";
+  case SelectionDAGISel::OPC_MoveChild:             return "OPC_MoveChild";
+  case SelectionDAGISel::OPC_MoveParent:            return "OPC_MoveParent";
+  case SelectionDAGISel::OPC_CheckSame:             return "OPC_CheckSame";
+  case SelectionDAGISel::OPC_CheckChild0Same:       return "OPC_CheckChild0Same";
+  case SelectionDAGISel::OPC_CheckChild1Same:       return "OPC_CheckChild1Same";
+  case SelectionDAGISel::OPC_CheckChild2Same:       return "OPC_CheckChild2Same";
+  case SelectionDAGISel::OPC_CheckChild3Same:       return "OPC_CheckChild3Same";
+  case SelectionDAGISel::OPC_CheckPatternPredicate: return "OPC_CheckPatternPredicate";
+  case SelectionDAGISel::OPC_CheckPredicate:        return "OPC_CheckPredicate";
+  case SelectionDAGISel::OPC_CheckOpcode:           return "OPC_CheckOpcode";
+  case SelectionDAGISel::OPC_SwitchOpcode:          return "OPC_SwitchOpcode";
+  case SelectionDAGISel::OPC_CheckType:             return "OPC_CheckType";
+  case SelectionDAGISel::OPC_SwitchType:            return "OPC_SwitchType";
+  case SelectionDAGISel::OPC_CheckChild0Type:       return "OPC_CheckChild0Type";
+  case SelectionDAGISel::OPC_CheckChild1Type:       return "OPC_CheckChild1Type";
+  case SelectionDAGISel::OPC_CheckChild2Type:       return "OPC_CheckChild2Type";
+  case SelectionDAGISel::OPC_CheckChild3Type:       return "OPC_CheckChild3Type";
+  case SelectionDAGISel::OPC_CheckChild4Type:       return "OPC_CheckChild4Type";
+  case SelectionDAGISel::OPC_CheckChild5Type:       return "OPC_CheckChild5Type";
+  case SelectionDAGISel::OPC_CheckChild6Type:       return "OPC_CheckChild6Type";
+  case SelectionDAGISel::OPC_CheckChild7Type:       return "OPC_CheckChild7Type";
+  case SelectionDAGISel::OPC_CheckInteger:          return "OPC_CheckInteger";
+  case SelectionDAGISel::OPC_CheckChild0Integer:    return "OPC_CheckChild0Integer";
+  case SelectionDAGISel::OPC_CheckChild1Integer:    return "OPC_CheckChild1Integer";
+  case SelectionDAGISel::OPC_CheckChild2Integer:    return "OPC_CheckChild2Integer";
+  case SelectionDAGISel::OPC_CheckChild3Integer:    return "OPC_CheckChild3Integer";
+  case SelectionDAGISel::OPC_CheckChild4Integer:    return "OPC_CheckChild4Integer";
+  case SelectionDAGISel::OPC_CheckCondCode:         return "OPC_CheckCondCode";
+  case SelectionDAGISel::OPC_CheckValueType:        return "OPC_CheckValueType";
+  case SelectionDAGISel::OPC_CheckComplexPat:       return "OPC_CheckComplexPat";
+  case SelectionDAGISel::OPC_CheckAndImm:           return "OPC_CheckAndImm";
+  case SelectionDAGISel::OPC_CheckOrImm:            return "OPC_CheckOrImm";
+  case SelectionDAGISel::OPC_CheckFoldableChainNode:
+    return "OPC_CheckFoldableChainNode";
+  case SelectionDAGISel::OPC_EmitInteger:           return "OPC_EmitInteger";
+  case SelectionDAGISel::OPC_EmitRegister:          return "OPC_EmitRegister";
+  case SelectionDAGISel::OPC_EmitRegister2:         return "OPC_EmitRegister2";
+  case SelectionDAGISel::OPC_EmitConvertToTarget:   return "OPC_EmitConvertToTarget";
+  case SelectionDAGISel::OPC_EmitMergeInputChains:  return "OPC_EmitMergeInputChains";
+  case SelectionDAGISel::OPC_EmitMergeInputChains1_0:
+    return "OPC_EmitMergeInputChains1_0";
+  case SelectionDAGISel::OPC_EmitMergeInputChains1_1:
+    return "OPC_EmitMergeInputChains1_1";
+  case SelectionDAGISel::OPC_EmitCopyToReg:         return "OPC_EmitCopyToReg";
+  case SelectionDAGISel::OPC_EmitNodeXForm:         return "OPC_EmitNodeXForm";
+  case SelectionDAGISel::OPC_EmitNode:              return "OPC_EmitNode";
+  case SelectionDAGISel::OPC_MorphNodeTo:           return "OPC_MorphNodeTo";
+  case SelectionDAGISel::OPC_MarkGlueResults:       return "OPC_MarkGlueResults";
+  case SelectionDAGISel::OPC_CompleteMatch:         return "OPC_CompleteMatch";
+  }
+  return nullptr;
+}
+
+namespace {
+/// MatcherOpcodeStats - Counts how many times each matcher table opcode is
+/// interpreted by SelectCodeCommon.  The histogram it prints at shutdown is
+/// the profile the DAG isel matcher emitter's scope ordering is tuned
+/// against; regenerate it when changing how tables are laid out.
+struct MatcherOpcodeStats {
+  uint64_t Counts[256];
+
+  MatcherOpcodeStats() { memset(Counts, 0, sizeof(Counts)); }
+  ~MatcherOpcodeStats() {
+    uint64_t Total = 0;
+    std::vector<std::pair<uint64_t, unsigned> > Sorted;
+    for (unsigned i = 0; i != 256; ++i)
+      if (Counts[i]) {
+        Sorted.push_back(std::make_pair(Counts[i], i));
+        Total += Counts[i];
+      }
+    if (!Total)
+      return;
+    std::sort(Sorted.begin(), Sorted.end(),
+              std::greater<std::pair<uint64_t, unsigned> >());
+
+    errs() << "DAG isel matcher opcode frequencies (" << Total
+           << " operations interpreted):\n";
+    for (unsigned i = 0, e = Sorted.size(); i != e; ++i) {
+      errs() << format("  %12" PRIu64 "  %6.2f%%  ", Sorted[i].first,
+                       Sorted[i].first * 100.0 / Total);
+      if (const char *Name = getMatcherOpcodeName(Sorted[i].second))
+        errs() << Name << '\n';
+      else
+        errs() << "<unknown opcode " << Sorted[i].second << ">\n";
+    }
+  }
+};
+}
+
+static ManagedStatic<MatcherOpcodeStats> MatcherStats;
+
 SDNode *SelectionDAGISel::
 SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
                  unsigned TableSize) {
@@ -2679,6 +2800,20 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
     unsigned CurrentOpcodeIndex = MatcherIndex;
 #endif
     BuiltinOpcodes Opcode = (BuiltinOpcodes)MatcherTable[MatcherIndex++];
+    if (EnableMatcherStats)
+      ++MatcherStats->Counts[Opcode];
+
+    // OPC_CheckOpcode and OPC_CheckType dominate the dynamic opcode
+    // frequency (together over half of all interpreted operations on a clang
+    // bootstrap, per -dagisel-matcher-stats), so dispatch them before the
+    // full switch.  A failed check falls through to the scope unwinding code
+    // below, exactly as the corresponding switch cases would.
+    if (Opcode == OPC_CheckOpcode || Opcode == OPC_CheckType) {
+      if (Opcode == OPC_CheckOpcode
+              ? ::CheckOpcode(MatcherTable, MatcherIndex, N.getNode())
+              : ::CheckType(MatcherTable, MatcherIndex, N, TLI))
+        continue;
+    } else
     switch (Opcode) {
     case OPC_Scope: {
       // Okay, the semantics of this operation are that we should push a scope
@@ -2824,14 +2959,8 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
         break;
       continue;
     }
-    case OPC_CheckOpcode:
-      if (!::CheckOpcode(MatcherTable, MatcherIndex, N.getNode())) break;
-      continue;
-
-    case OPC_CheckType:
-      if (!::CheckType(MatcherTable, MatcherIndex, N, TLI))
-        break;
-      continue;
+    // Note: OPC_CheckOpcode and OPC_CheckType are dispatched on the fast
+    // path before this switch.
 
     case OPC_SwitchOpcode: {
       unsigned CurNodeOpcode = N.getOpcode();
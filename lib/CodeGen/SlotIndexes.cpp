@@ -125,19 +125,66 @@ void SlotIndexes::renumberIndexes() {
 // Renumber indexes locally after curItr was inserted, but failed to get a new
 // index.
 void SlotIndexes::renumberIndexes(IndexList::iterator curItr) {
-  // Number indexes with half the default spacing so we can catch up quickly.
-  const unsigned Space = SlotIndex::InstrDist/2;
-  assert((Space & 3) == 0 && "InstrDist must be a multiple of 2*NUM");
+  // Treat the index list as a gap buffer: rather than pushing every following
+  // index up until we catch up, spread the entries after curItr evenly over
+  // the index range up to the first entry with enough headroom, which keeps
+  // its old number. The blank entry between basic blocks preserves an
+  // InstrDist-wide gap at every block boundary, so the walk normally stops
+  // there and inserting into one block never renumbers any other.
+
+  // The minimum spacing that keeps the four slots of neighboring instructions
+  // distinct, and the spacing we aim for so that the next insertion at the
+  // same point doesn't immediately renumber again.
+  const unsigned MinSpace = SlotIndex::Slot_Count;
+  const unsigned Headroom = 2 * SlotIndex::Slot_Count;
 
   IndexList::iterator startItr = std::prev(curItr);
-  unsigned index = startItr->getIndex();
-  do {
+  const unsigned startIdx = startItr->getIndex();
+
+  // If curItr numbers an instruction, don't let the walk escape its block:
+  // past the block's trailing blank entry lies the next block's numbering.
+  IndexList::iterator blockLimit = indexList.end();
+  if (MachineInstr *mi = curItr->getInstr())
+    blockLimit =
+        std::next(IndexList::iterator(getMBBEndIdx(mi->getParent()).listEntry()));
+
+  // Find the first entry that leaves at least Headroom numbers for every
+  // entry renumbered before it.
+  unsigned numEntries = 0;
+  IndexList::iterator endItr = curItr;
+  while (endItr != indexList.end() && endItr != blockLimit &&
+         endItr->getIndex() < startIdx + (numEntries + 1) * Headroom) {
+    ++numEntries;
+    ++endItr;
+  }
+
+  if (endItr == indexList.end()) {
+    // Ran off the end of the list. The index space above the last entry is
+    // unused, so number the tail with the default spacing.
+    unsigned index = startIdx;
+    for (; curItr != endItr; ++curItr)
+      curItr->setIndex(index += SlotIndex::InstrDist);
+    DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << startIdx << '-'
+                 << index << " ***\n");
+    ++NumLocalRenum;
+    return;
+  }
+
+  unsigned Space =
+      ((endItr->getIndex() - startIdx) / (numEntries + 1)) & ~(MinSpace - 1);
+  if (Space == 0) {
+    // The block's index range is exhausted. Renumber the whole function to
+    // restore the default spacing everywhere; with gaps replenished this is
+    // rare enough to amortize away.
+    renumberIndexes();
+    return;
+  }
+
+  unsigned index = startIdx;
+  for (; curItr != endItr; ++curItr)
     curItr->setIndex(index += Space);
-    ++curItr;
-    // If the next index is bigger, we have caught up.
-  } while (curItr != indexList.end() && curItr->getIndex() <= index);
 
-  DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << startItr->getIndex() << '-'
+  DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << startIdx << '-'
                << index << " ***\n");
   ++NumLocalRenum;
 }
@@ -35,6 +35,7 @@
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/Passes.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -43,6 +44,11 @@ using namespace llvm;
 
 #define DEBUG_TYPE "spillplacement"
 
+static cl::opt<unsigned>
+NodeUpdateBudget("spill-placement-budget", cl::Hidden, cl::init(0),
+                 cl::desc("Maximum number of node updates per iterate() call "
+                          "(0 scales the budget with the number of bundles)"));
+
 char SpillPlacement::ID = 0;
 INITIALIZE_PASS_BEGIN(SpillPlacement, "spill-code-placement",
                       "Spill Code Placement Analysis", true, true)
@@ -174,6 +180,20 @@ struct SpillPlacement::Node {
       Value = 0;
     return Before != preferReg();
   }
+
+  /// getDissentingNeighbors - Add the neighbors holding a different value than
+  /// this node to List. They are the only nodes this update can have affected.
+  void getDissentingNeighbors(SparseSet<unsigned> &List,
+                              const Node nodes[]) const {
+    for (LinkVector::const_iterator I = Links.begin(), E = Links.end();
+         I != E; ++I) {
+      unsigned n = I->second;
+      // Neighbors that already agree with this node are not going to change
+      // because of this update.
+      if (nodes[n].Value != Value)
+        List.insert(n);
+    }
+  }
 };
 
 bool SpillPlacement::runOnMachineFunction(MachineFunction &mf) {
@@ -249,6 +269,7 @@ void SpillPlacement::addConstraints(ArrayRef<BlockConstraint> LiveBlocks) {
       unsigned ib = bundles->getBundle(I->Number, 0);
       activate(ib);
       nodes[ib].addBias(Freq, I->Entry);
+      TodoList.insert(ib);
     }
 
     // Live-out from block?
@@ -256,6 +277,7 @@ void SpillPlacement::addConstraints(ArrayRef<BlockConstraint> LiveBlocks) {
       unsigned ob = bundles->getBundle(I->Number, 1);
       activate(ob);
       nodes[ob].addBias(Freq, I->Exit);
+      TodoList.insert(ob);
     }
   }
 }
@@ -273,6 +295,8 @@ void SpillPlacement::addPrefSpill(ArrayRef<unsigned> Blocks, bool Strong) {
     activate(ob);
     nodes[ib].addBias(Freq, PrefSpill);
     nodes[ob].addBias(Freq, PrefSpill);
+    TodoList.insert(ib);
+    TodoList.insert(ob);
   }
 }
 
@@ -288,87 +312,72 @@ void SpillPlacement::addLinks(ArrayRef<unsigned> Links) {
       continue;
     activate(ib);
     activate(ob);
-    if (nodes[ib].Links.empty() && !nodes[ib].mustSpill())
-      Linked.push_back(ib);
-    if (nodes[ob].Links.empty() && !nodes[ob].mustSpill())
-      Linked.push_back(ob);
     BlockFrequency Freq = BlockFrequencies[Number];
     nodes[ib].addLink(ob, Freq);
     nodes[ob].addLink(ib, Freq);
+    TodoList.insert(ib);
+    TodoList.insert(ob);
   }
 }
 
+/// update - Update a single node and push any neighbors it may have affected
+/// onto the Todo list. Return true when the node preference changed.
+bool SpillPlacement::update(unsigned n) {
+  if (!nodes[n].update(nodes, Threshold))
+    return false;
+  nodes[n].getDissentingNeighbors(TodoList, nodes);
+  return true;
+}
+
 bool SpillPlacement::scanActiveBundles() {
-  Linked.clear();
   RecentPositive.clear();
+  // Starting from scratch, every active node is updated below, so the pending
+  // updates queued by addConstraints and friends are already covered.
+  TodoList.clear();
   for (int n = ActiveNodes->find_first(); n>=0; n = ActiveNodes->find_next(n)) {
-    nodes[n].update(nodes, Threshold);
+    update(n);
     // A node that must spill, or a node without any links is not going to
     // change its value ever again, so exclude it from iterations.
     if (nodes[n].mustSpill())
       continue;
-    if (!nodes[n].Links.empty())
-      Linked.push_back(n);
     if (nodes[n].preferReg())
       RecentPositive.push_back(n);
   }
   return !RecentPositive.empty();
 }
 
-/// iterate - Repeatedly update the Hopfield nodes until stability or the
-/// maximum number of iterations is reached.
-/// @param Linked - Numbers of linked nodes that need updating.
+/// iterate - Repeatedly update the nodes on the Todo list until it is empty
+/// or the update budget is exhausted.
 void SpillPlacement::iterate() {
   // First update the recently positive nodes. They have likely received new
   // negative bias that will turn them off.
   while (!RecentPositive.empty())
-    nodes[RecentPositive.pop_back_val()].update(nodes, Threshold);
-
-  if (Linked.empty())
-    return;
-
-  // Run up to 10 iterations. The edge bundle numbering is closely related to
-  // basic block numbering, so there is a strong tendency towards chains of
-  // linked nodes with sequential numbers. By scanning the linked nodes
-  // backwards and forwards, we make it very likely that a single node can
-  // affect the entire network in a single iteration. That means very fast
-  // convergence, usually in a single iteration.
-  for (unsigned iteration = 0; iteration != 10; ++iteration) {
-    // Scan backwards, skipping the last node when iteration is not zero. When
-    // iteration is not zero, the last node was just updated.
-    bool Changed = false;
-    for (SmallVectorImpl<unsigned>::const_reverse_iterator I =
-           iteration == 0 ? Linked.rbegin() : std::next(Linked.rbegin()),
-           E = Linked.rend(); I != E; ++I) {
-      unsigned n = *I;
-      if (nodes[n].update(nodes, Threshold)) {
-        Changed = true;
-        if (nodes[n].preferReg())
-          RecentPositive.push_back(n);
-      }
-    }
-    if (!Changed || !RecentPositive.empty())
-      return;
-
-    // Scan forwards, skipping the first node which was just updated.
-    Changed = false;
-    for (SmallVectorImpl<unsigned>::const_iterator I =
-           std::next(Linked.begin()), E = Linked.end(); I != E; ++I) {
-      unsigned n = *I;
-      if (nodes[n].update(nodes, Threshold)) {
-        Changed = true;
-        if (nodes[n].preferReg())
-          RecentPositive.push_back(n);
-      }
-    }
-    if (!Changed || !RecentPositive.empty())
-      return;
+    update(RecentPositive.pop_back_val());
+
+  // Update nodes one at a time. Since each update pushes exactly the neighbors
+  // it may have affected, only the disturbed part of the network is revisited,
+  // and the energy function guarantees that the list eventually drains. The
+  // budget is a safety net for irregular CFGs where the ripples take a long
+  // time to die out: when it runs out, the remaining nodes simply keep their
+  // current values, which finish() turns into a valid, if conservative,
+  // placement. Leftover entries stay on the list, so a later call resumes
+  // where this one stopped.
+  unsigned Budget = NodeUpdateBudget ? unsigned(NodeUpdateBudget)
+                                     : 10 * bundles->getNumBundles();
+  while (Budget && !TodoList.empty()) {
+    --Budget;
+    unsigned n = TodoList.pop_back_val();
+    if (!update(n))
+      continue;
+    if (nodes[n].preferReg())
+      RecentPositive.push_back(n);
   }
 }
 
 void SpillPlacement::prepare(BitVector &RegBundles) {
-  Linked.clear();
   RecentPositive.clear();
+  TodoList.clear();
+  TodoList.setUniverse(bundles->getNumBundles());
   // Reuse RegBundles as our ActiveNodes vector.
   ActiveNodes = &RegBundles;
   ActiveNodes->clear();
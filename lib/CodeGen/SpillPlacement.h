@@ -29,6 +29,7 @@
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SparseSet.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/Support/BlockFrequency.h"
 
@@ -52,13 +53,16 @@ class SpillPlacement : public MachineFunctionPass {
   // caller.
   BitVector *ActiveNodes;
 
-  // Nodes with active links. Populated by scanActiveBundles.
-  SmallVector<unsigned, 8> Linked;
-
   // Nodes that went positive during the last call to scanActiveBundles or
   // iterate.
   SmallVector<unsigned, 8> RecentPositive;
 
+  // Nodes whose inputs have changed since they were last updated. This list
+  // persists between iterate() calls, so a query that grows the region only
+  // revisits the part of the network that was disturbed since the previous
+  // convergence instead of rescanning every linked node.
+  SparseSet<unsigned> TodoList;
+
   // Block frequencies are computed once. Indexed by block number.
   SmallVector<BlockFrequency, 8> BlockFrequencies;
 
@@ -127,8 +131,8 @@ public:
   /// Return true is there are any positive nodes.
   bool scanActiveBundles();
 
-  /// iterate - Update the network iteratively until convergence, or new bundles
-  /// are found.
+  /// iterate - Update the network iteratively until convergence, the update
+  /// budget is exhausted, or new bundles are found.
   void iterate();
 
   /// getRecentPositive - Return an array of bundles that became positive during
@@ -157,6 +161,8 @@ private:
 
   void activate(unsigned);
   void setThreshold(const BlockFrequency &Entry);
+
+  bool update(unsigned);
 };
 
 } // end namespace llvm
@@ -221,9 +221,17 @@ const MCSection *TargetLoweringObjectFileELF::getExplicitSectionGlobal(
 
 /// Return the section prefix name used by options FunctionsSections and
 /// DataSections.
-static StringRef getSectionPrefixForGlobal(SectionKind Kind) {
-  if (Kind.isText())
+static StringRef getSectionPrefixForGlobal(const GlobalValue *GV,
+                                           SectionKind Kind) {
+  if (Kind.isText()) {
+    // Group rarely executed functions away from the hot parts of .text. The
+    // standard linker scripts place .text.unlikely* ahead of the rest of
+    // .text, so cold code stops diluting the instruction cache and TLB.
+    if (const Function *F = dyn_cast<Function>(GV))
+      if (F->hasFnAttribute(Attribute::Cold))
+        return ".text.unlikely";
     return ".text";
+  }
   if (Kind.isReadOnly())
     return ".rodata";
   if (Kind.isBSS())
@@ -302,7 +310,7 @@ SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
     Name = ".rodata.cst";
     Name += utostr(EntrySize);
   } else {
-    Name = getSectionPrefixForGlobal(Kind);
+    Name = getSectionPrefixForGlobal(GV, Kind);
   }
 
   if (EmitUniqueSection && UniqueSectionNames) {
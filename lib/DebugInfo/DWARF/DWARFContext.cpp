@@ -12,18 +12,29 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugArangeSet.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <string>
+#include <vector>
 using namespace llvm;
 using namespace dwarf;
 using namespace object;
 
 #define DEBUG_TYPE "dwarf"
 
+static cl::opt<unsigned> LinePrefetchCount(
+    "dwarf-line-prefetch", cl::init(0), cl::Hidden,
+    cl::desc("Number of address-adjacent compile units whose line tables are "
+             "parsed in the background after an address lookup (0 disables "
+             "prefetching)"));
+
 typedef DWARFDebugLine::LineTable DWARFLineTable;
 typedef DILineInfoSpecifier::FileLineInfoKind FileLineInfoKind;
 typedef DILineInfoSpecifier::FunctionNameKind FunctionNameKind;
@@ -71,6 +82,51 @@ static void dumpAccelSection(raw_ostream &OS, StringRef Name,
   Accel.dump(OS);
 }
 
+/// Dump each unit in \p CUs into its own buffer on the shared thread pool
+/// and print the buffers in unit order.
+///
+/// Units are self-contained once the shared lazily-parsed state is in
+/// place: unit headers and abbreviation sets were resolved when the unit
+/// list was built, and the line tables consulted when dumping file
+/// attributes are parsed up front below. After that, a worker only
+/// touches state owned by its own unit.
+static void dumpCompileUnits(DWARFContext &Ctx, raw_ostream &OS,
+                             DWARFContext::cu_iterator_range CUs) {
+  SmallVector<DWARFCompileUnit *, 16> Units;
+  for (const auto &CU : CUs)
+    Units.push_back(CU.get());
+
+  if (Units.size() <= 1) {
+    for (DWARFCompileUnit *U : Units)
+      U->dump(OS);
+    return;
+  }
+
+  for (DWARFCompileUnit *U : Units)
+    Ctx.getLineTableForUnit(U);
+
+  std::vector<std::string> Buffers(Units.size());
+  ThreadPool &Pool = parallel::getPool();
+  std::vector<std::shared_future<void>> Futures;
+  Futures.reserve(Units.size());
+  for (size_t I = 0, E = Units.size(); I != E; ++I) {
+    DWARFCompileUnit *U = Units[I];
+    std::string *Buf = &Buffers[I];
+    Futures.push_back(Pool.async([U, Buf] {
+      raw_string_ostream BufOS(*Buf);
+      U->dump(BufOS);
+    }));
+  }
+
+  // Stitch the output together in the original unit order, releasing each
+  // buffer once it has been printed.
+  for (size_t I = 0, E = Units.size(); I != E; ++I) {
+    Futures[I].wait();
+    OS << Buffers[I];
+    std::string().swap(Buffers[I]);
+  }
+}
+
 void DWARFContext::dump(raw_ostream &OS, DIDumpType DumpType) {
   if (DumpType == DIDT_All || DumpType == DIDT_Abbrev) {
     OS << ".debug_abbrev contents:\n";
@@ -85,15 +141,13 @@ void DWARFContext::dump(raw_ostream &OS, DIDumpType DumpType) {
 
   if (DumpType == DIDT_All || DumpType == DIDT_Info) {
     OS << "\n.debug_info contents:\n";
-    for (const auto &CU : compile_units())
-      CU->dump(OS);
+    dumpCompileUnits(*this, OS, compile_units());
   }
 
   if ((DumpType == DIDT_All || DumpType == DIDT_InfoDwo) &&
       getNumDWOCompileUnits()) {
     OS << "\n.debug_info.dwo contents:\n";
-    for (const auto &DWOCU : dwo_compile_units())
-      DWOCU->dump(OS);
+    dumpCompileUnits(*this, OS, dwo_compile_units());
   }
 
   if ((DumpType == DIDT_All || DumpType == DIDT_Types) && getNumTypeUnits()) {
@@ -341,6 +395,55 @@ DWARFContext::getLineTableForUnit(DWARFUnit *cu) {
   return Line->getOrParseLineTable(lineData, stmtOffset);
 }
 
+DWARFContext::~DWARFContext() {
+  // Wait for outstanding line table prefetches; they parse into state this
+  // context owns.
+  for (const auto &Future : PrefetchFutures)
+    Future.wait();
+}
+
+void DWARFContext::prefetchLineTables(uint64_t Address) {
+  if (LinePrefetchCount == 0 || !llvm_is_multithreaded())
+    return;
+
+  // Drop the futures of prefetches that already finished.
+  PrefetchFutures.erase(
+      std::remove_if(PrefetchFutures.begin(), PrefetchFutures.end(),
+                     [](const std::shared_future<void> &F) {
+                       return F.wait_for(std::chrono::seconds(0)) ==
+                              std::future_status::ready;
+                     }),
+      PrefetchFutures.end());
+
+  SmallVector<uint32_t, 4> CUOffsets;
+  getDebugAranges()->findNeighborCUs(Address, LinePrefetchCount, CUOffsets);
+  for (uint32_t CUOffset : CUOffsets) {
+    DWARFCompileUnit *CU = getCompileUnitForOffset(CUOffset);
+    if (!CU)
+      continue;
+
+    // Resolve everything that touches lazily-parsed unit state on this
+    // thread; the worker only parses the line table itself.
+    unsigned stmtOffset =
+        CU->getCompileUnitDIE()->getAttributeValueAsSectionOffset(
+            CU, DW_AT_stmt_list, -1U);
+    if (stmtOffset == -1U)
+      continue;
+    if (!Line)
+      Line.reset(new DWARFDebugLine(&getLineSection().Relocs));
+    if (Line->getLineTable(stmtOffset))
+      continue;
+
+    DataExtractor lineData(getLineSection().Data, isLittleEndian(),
+                           CU->getAddressByteSize());
+    DWARFDebugLine *LineParser = Line.get();
+    PrefetchFutures.push_back(
+        parallel::getPool().async([LineParser, lineData, stmtOffset] {
+          LineParser->prefetchLineTable(lineData, stmtOffset);
+        }));
+  }
+}
+
 void DWARFContext::parseCompileUnits() {
   CUs.parse(*this, getInfoSection());
 }
@@ -373,10 +476,16 @@ DWARFCompileUnit *DWARFContext::getCompileUnitForOffset(uint32_t Offset) {
 }
 
 DWARFCompileUnit *DWARFContext::getCompileUnitForAddress(uint64_t Address) {
-  // First, get the offset of the compile unit.
+  // First, get the offset of the compile unit. Check the cheap table built
+  // from .debug_aranges alone before falling back to ranges collected from
+  // the DIEs of any units the section didn't describe.
   uint32_t CUOffset = getDebugAranges()->findAddress(Address);
+  if (DWARFCompileUnit *CU = getCompileUnitForOffset(CUOffset))
+    return CU;
+  if (!Aranges->generateFromMissingUnits(this))
+    return nullptr;
   // Retrieve the compile unit.
-  return getCompileUnitForOffset(CUOffset);
+  return getCompileUnitForOffset(Aranges->findAddress(Address));
 }
 
 static bool getFunctionNameForAddress(DWARFCompileUnit *CU, uint64_t Address,
@@ -407,6 +516,7 @@ DILineInfo DWARFContext::getLineInfoForAddress(uint64_t Address,
   DWARFCompileUnit *CU = getCompileUnitForAddress(Address);
   if (!CU)
     return Result;
+  prefetchLineTables(Address);
   getFunctionNameForAddress(CU, Address, Spec.FNKind, Result.FunctionName);
   if (Spec.FLIKind != FileLineInfoKind::None) {
     if (const DWARFLineTable *LineTable = getLineTableForUnit(CU))
@@ -467,6 +577,7 @@ DWARFContext::getInliningInfoForAddress(uint64_t Address,
   if (!CU)
     return InliningInfo;
 
+  prefetchLineTables(Address);
   const DWARFLineTable *LineTable = nullptr;
   const DWARFDebugInfoEntryInlinedChain &InlinedChain =
       CU->getInlinedChainForAddress(Address);
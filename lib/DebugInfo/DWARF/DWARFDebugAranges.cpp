@@ -40,25 +40,40 @@ void DWARFDebugAranges::generate(DWARFContext *CTX) {
   if (!CTX)
     return;
 
-  // Extract aranges from .debug_aranges section.
+  // Extract aranges from .debug_aranges section. Even if the section is
+  // present it may describe only a small subset of compilation units; ranges
+  // for the rest are generated from their DIEs on demand by
+  // generateFromMissingUnits, so that lookups which hit the section never
+  // have to parse any DIEs.
   DataExtractor ArangesData(CTX->getARangeSection(), CTX->isLittleEndian(), 0);
   extract(ArangesData);
+  construct();
+}
 
-  // Generate aranges from DIEs: even if .debug_aranges section is present,
-  // it may describe only a small subset of compilation units, so we need to
-  // manually build aranges for the rest of them.
+bool DWARFDebugAranges::generateFromMissingUnits(DWARFContext *CTX) {
+  // Collect ranges from the DIEs of the compilation units .debug_aranges
+  // didn't describe.
+  bool Changed = false;
   for (const auto &CU : CTX->compile_units()) {
     uint32_t CUOffset = CU->getOffset();
-    if (ParsedCUOffsets.insert(CUOffset).second) {
-      DWARFAddressRangesVector CURanges;
-      CU->collectAddressRanges(CURanges);
-      for (const auto &R : CURanges) {
-        appendRange(CUOffset, R.first, R.second);
-      }
-    }
+    if (!ParsedCUOffsets.insert(CUOffset).second)
+      continue;
+    Changed = true;
+    DWARFAddressRangesVector CURanges;
+    CU->collectAddressRanges(CURanges);
+    for (const auto &R : CURanges)
+      appendRange(CUOffset, R.first, R.second);
   }
+  if (!Changed)
+    return false;
 
+  // Re-expand the ranges built so far so that the endpoint sweep in construct
+  // sees the whole table, then rebuild it.
+  for (const auto &R : Aranges)
+    appendRange(R.CUOffset, R.LowPC, R.HighPC());
+  Aranges.clear();
   construct();
+  return true;
 }
 
 void DWARFDebugAranges::clear() {
@@ -127,3 +142,49 @@ uint32_t DWARFDebugAranges::findAddress(uint64_t Address) const {
   }
   return -1U;
 }
+
+void DWARFDebugAranges::findNeighborCUs(
+    uint64_t Address, unsigned Count,
+    SmallVectorImpl<uint32_t> &CUOffsets) const {
+  if (Aranges.empty() || Count == 0)
+    return;
+
+  // Locate the range containing Address, the same way findAddress does.
+  Range range(Address);
+  RangeCollIterator pos =
+      std::lower_bound(Aranges.begin(), Aranges.end(), range);
+  if (pos == Aranges.end() || !pos->containsAddress(Address)) {
+    if (pos == Aranges.begin())
+      return;
+    --pos;
+    if (!pos->containsAddress(Address))
+      return;
+  }
+
+  uint32_t Home = pos->CUOffset;
+  auto Add = [&](uint32_t CUOffset) {
+    if (CUOffsets.size() >= Count || CUOffset == Home || CUOffset == -1U)
+      return;
+    if (std::find(CUOffsets.begin(), CUOffsets.end(), CUOffset) !=
+        CUOffsets.end())
+      return;
+    CUOffsets.push_back(CUOffset);
+  };
+
+  // Walk outward from the containing range, alternating sides, until enough
+  // distinct units were found or both ends of the table are reached.
+  size_t Idx = pos - Aranges.begin();
+  for (size_t Step = 1; CUOffsets.size() < Count; ++Step) {
+    bool InBounds = false;
+    if (Step <= Idx) {
+      Add(Aranges[Idx - Step].CUOffset);
+      InBounds = true;
+    }
+    if (Idx + Step < Aranges.size()) {
+      Add(Aranges[Idx + Step].CUOffset);
+      InBounds = true;
+    }
+    if (!InBounds)
+      return;
+  }
+}
@@ -225,6 +225,7 @@ void DWARFDebugLine::ParsingState::appendRowToMatrix(uint32_t offset) {
 
 const DWARFDebugLine::LineTable *
 DWARFDebugLine::getLineTable(uint32_t offset) const {
+  std::lock_guard<std::mutex> Lock(Mutex);
   LineTableConstIter pos = LineTableMap.find(offset);
   if (pos != LineTableMap.end())
     return &pos->second;
@@ -234,6 +235,7 @@ DWARFDebugLine::getLineTable(uint32_t offset) const {
 const DWARFDebugLine::LineTable *
 DWARFDebugLine::getOrParseLineTable(DataExtractor debug_line_data,
                                     uint32_t offset) {
+  std::lock_guard<std::mutex> Lock(Mutex);
   std::pair<LineTableIter, bool> pos =
     LineTableMap.insert(LineTableMapTy::value_type(offset, LineTable()));
   LineTable *LT = &pos.first->second;
@@ -244,6 +246,29 @@ DWARFDebugLine::getOrParseLineTable(DataExtractor debug_line_data,
   return LT;
 }
 
+void DWARFDebugLine::prefetchLineTable(DataExtractor debug_line_data,
+                                       uint32_t offset) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (LineTableMap.count(offset))
+      return;
+    if (!PrefetchesInFlight.insert(offset).second)
+      return; // Another prefetch is already parsing this table.
+  }
+
+  // Parse outside the lock so a cache lookup never waits for a prefetch of
+  // an unrelated table. If a foreground parse of the same offset wins the
+  // insertion race below, this copy is simply discarded.
+  LineTable LT;
+  uint32_t table_offset = offset;
+  bool Parsed = LT.parse(debug_line_data, RelocMap, &table_offset);
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  PrefetchesInFlight.erase(offset);
+  if (Parsed)
+    LineTableMap.insert(LineTableMapTy::value_type(offset, std::move(LT)));
+}
+
 bool DWARFDebugLine::LineTable::parse(DataExtractor debug_line_data,
                                       const RelocAddrMap *RMap,
                                       uint32_t *offset_ptr) {
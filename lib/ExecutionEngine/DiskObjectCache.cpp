@@ -0,0 +1,138 @@
+//===-- DiskObjectCache.cpp - On-disk object cache for MCJIT --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the DiskObjectCache, an ObjectCache that persists
+// compiled objects across process restarts.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/DiskObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+DiskObjectCache::DiskObjectCache(StringRef Dir, uint64_t MaxSize)
+    : CacheDir(Dir), MaxSize(MaxSize) {
+  sys::fs::create_directories(CacheDir);
+}
+
+DiskObjectCache::~DiskObjectCache() {}
+
+std::string DiskObjectCache::getEntryPath(const Module *M) {
+  // Key on a hash of the printed module. The text covers everything that
+  // affects codegen (including the target triple and data layout), and any
+  // change to it changes the key. MD5 rather than a cheap hash because a key
+  // collision would silently run the wrong code.
+  SmallString<256> Text;
+  raw_svector_ostream TextOS(Text);
+  M->print(TextOS, nullptr);
+
+  MD5 Hash;
+  Hash.update(TextOS.str());
+  MD5::MD5Result HashResult;
+  Hash.final(HashResult);
+  SmallString<32> Digest;
+  MD5::stringifyResult(HashResult, Digest);
+
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, Twine(Digest.str()) + ".o");
+  return Path.str().str();
+}
+
+std::unique_ptr<MemoryBuffer> DiskObjectCache::getObject(const Module *M) {
+  std::string EntryPath = getEntryPath(M);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFile(EntryPath, -1, /*RequiresNullTerminator=*/false);
+  if (!BufOrErr)
+    return nullptr;
+
+  // Best-effort touch so that pruning sees this entry as recently used.
+  int FD;
+  if (!sys::fs::openFileForWrite(EntryPath, FD, sys::fs::F_Append)) {
+    sys::fs::setLastModificationAndAccessTime(FD, sys::TimeValue::now());
+    sys::Process::SafelyCloseFileDescriptor(FD);
+  }
+
+  return std::move(BufOrErr.get());
+}
+
+void DiskObjectCache::notifyObjectCompiled(const Module *M,
+                                           MemoryBufferRef Obj) {
+  if (sys::fs::create_directories(CacheDir))
+    return;
+  std::string EntryPath = getEntryPath(M);
+
+  // Write to a unique temporary in the cache directory and rename it into
+  // place, so a concurrent reader sees either no entry or a complete one.
+  SmallString<128> TempModel(EntryPath);
+  TempModel += "-%%%%%%%%";
+  int FD;
+  SmallString<128> TempPath;
+  if (sys::fs::createUniqueFile(TempModel, FD, TempPath))
+    return;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write(Obj.getBufferStart(), Obj.getBufferSize());
+  }
+  if (sys::fs::rename(TempPath, EntryPath)) {
+    sys::fs::remove(TempPath);
+    return;
+  }
+
+  if (MaxSize)
+    prune();
+}
+
+void DiskObjectCache::prune() {
+  // Only one process prunes at a time. If another one holds the lock it will
+  // do the work; there is no reason to wait for it.
+  SmallString<128> PruneFile(CacheDir);
+  sys::path::append(PruneFile, "prune");
+  LockFileManager Lock(PruneFile);
+  if (Lock != LockFileManager::LFS_Owned)
+    return;
+
+  // Collect all cache entries with their sizes and modification times.
+  typedef std::pair<sys::TimeValue, std::pair<std::string, uint64_t>> EntryT;
+  std::vector<EntryT> Entries;
+  uint64_t TotalSize = 0;
+  std::error_code EC;
+  for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    if (sys::path::extension(I->path()) != ".o")
+      continue;
+    sys::fs::file_status Status;
+    if (I->status(Status))
+      continue;
+    Entries.push_back(EntryT(Status.getLastModificationTime(),
+                             std::make_pair(I->path(), Status.getSize())));
+    TotalSize += Status.getSize();
+  }
+  if (TotalSize <= MaxSize)
+    return;
+
+  // Discard the least recently used entries until the cache fits.
+  std::sort(Entries.begin(), Entries.end());
+  for (std::vector<EntryT>::iterator I = Entries.begin(), E = Entries.end();
+       I != E && TotalSize > MaxSize; ++I) {
+    if (sys::fs::remove(I->second.first))
+      continue;
+    TotalSize -= I->second.second;
+  }
+}
@@ -2090,6 +2090,25 @@ void Interpreter::callFunction(Function *F,
     return;
   }
 
+  // Tiered execution: count invocations and ask the installed compiler for a
+  // native body once a function is hot. The compiler may work asynchronously,
+  // so keep asking on every entry until it delivers; meanwhile the function
+  // is interpreted as usual.
+  if (TierUpThreshold && canCallNatively(F)) {
+    void *Native = NativeBodies.lookup(F);
+    if (!Native && ++InvocationCounts[F] >= TierUpThreshold)
+      if ((Native = TierUpCompiler(*F)))
+        NativeBodies[F] = Native;
+    if (Native) {
+      GenericValue Result;
+      if (callNativeFunction(F, Native, ArgVals, Result)) {
+        // Simulate a 'ret' instruction of the appropriate type.
+        popStackAndReturnValueToCaller(F->getReturnType(), Result);
+        return;
+      }
+    }
+  }
+
   // Get pointers to first LLVM BB & Instruction in function.
   StackFrame.CurBB     = F->begin();
   StackFrame.CurInst   = StackFrame.CurBB->begin();
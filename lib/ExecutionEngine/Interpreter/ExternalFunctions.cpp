@@ -245,6 +245,52 @@ static bool ffiInvoke(RawFunc Fn, Function *F,
 }
 #endif // USE_LIBFFI
 
+// Tier-up support: a call can be transferred to a natively compiled body only
+// if libffi is available to assemble it and every type involved has an ffi
+// mapping (see ffiTypeFor).
+bool Interpreter::canCallNatively(Function *F) {
+#ifdef USE_LIBFFI
+  FunctionType *FTy = F->getFunctionType();
+  if (FTy->isVarArg())
+    return false;
+  auto HasFFIType = [](Type *Ty) {
+    switch (Ty->getTypeID()) {
+      case Type::IntegerTyID:
+        switch (cast<IntegerType>(Ty)->getBitWidth()) {
+          case 8: case 16: case 32: case 64: return true;
+          default: return false;
+        }
+      case Type::FloatTyID:
+      case Type::DoubleTyID:
+      case Type::PointerTyID:
+        return true;
+      default:
+        return false;
+    }
+  };
+  Type *RetTy = FTy->getReturnType();
+  if (!RetTy->isVoidTy() && !HasFFIType(RetTy))
+    return false;
+  for (unsigned i = 0, e = FTy->getNumParams(); i != e; ++i)
+    if (!HasFFIType(FTy->getParamType(i)))
+      return false;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool Interpreter::callNativeFunction(Function *F, void *FPtr,
+                                     const std::vector<GenericValue> &ArgVals,
+                                     GenericValue &Result) {
+#ifdef USE_LIBFFI
+  return ffiInvoke((RawFunc)(intptr_t)FPtr, F, ArgVals, getDataLayout(),
+                   Result);
+#else
+  return false;
+#endif
+}
+
 GenericValue Interpreter::callExternalFunction(Function *F,
                                      const std::vector<GenericValue> &ArgVals) {
   TheInterpreter = this;
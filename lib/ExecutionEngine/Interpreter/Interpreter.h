@@ -14,6 +14,7 @@
 #ifndef LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 #define LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/IR/CallSite.h"
@@ -106,6 +107,13 @@ class Interpreter : public ExecutionEngine, public InstVisitor<Interpreter> {
   // registered with the atexit() library function.
   std::vector<Function*> AtExitHandlers;
 
+  // Tiered execution state: the compiler installed by InstallTierUpCompiler,
+  // per-function invocation counts, and the native bodies delivered so far.
+  std::function<void *(Function &)> TierUpCompiler;
+  unsigned TierUpThreshold;
+  DenseMap<Function *, unsigned> InvocationCounts;
+  DenseMap<Function *, void *> NativeBodies;
+
 public:
   explicit Interpreter(std::unique_ptr<Module> M);
   ~Interpreter();
@@ -135,6 +143,12 @@ public:
     return nullptr;
   }
 
+  void InstallTierUpCompiler(std::function<void *(Function &)> Compiler,
+                             unsigned Threshold) override {
+    TierUpCompiler = std::move(Compiler);
+    TierUpThreshold = Threshold;
+  }
+
   // Methods used to execute code:
   // Place a call on the stack
   void callFunction(Function *F, const std::vector<GenericValue> &ArgVals);
@@ -219,6 +233,13 @@ private:  // Helper functions
 
   void initializeExecutionEngine() { }
   void initializeExternalFunctions();
+
+  // Tiered execution helpers, implemented in ExternalFunctions.cpp next to
+  // the libffi marshalling they reuse.
+  bool canCallNatively(Function *F);
+  bool callNativeFunction(Function *F, void *FPtr,
+                          const std::vector<GenericValue> &ArgVals,
+                          GenericValue &Result);
   GenericValue getConstantExprValue(ConstantExpr *CE, ExecutionContext &SF);
   GenericValue getOperandValue(Value *V, ExecutionContext &SF);
   GenericValue executeTruncInst(Value *SrcVal, Type *DstTy,
@@ -17,6 +17,40 @@
 namespace llvm {
 namespace orc {
 
+SpeculativeCompileQueue::SpeculativeCompileQueue()
+  : Stop(false), Worker([this]() { run(); }) {}
+
+SpeculativeCompileQueue::~SpeculativeCompileQueue() {
+  {
+    std::lock_guard<std::mutex> Lock(QueueMtx);
+    Stop = true;
+  }
+  JobsAvailable.notify_one();
+  Worker.join();
+}
+
+void SpeculativeCompileQueue::enqueue(CompileJob Job) {
+  {
+    std::lock_guard<std::mutex> Lock(QueueMtx);
+    Jobs.push_back(std::move(Job));
+  }
+  JobsAvailable.notify_one();
+}
+
+void SpeculativeCompileQueue::run() {
+  std::unique_lock<std::mutex> Lock(QueueMtx);
+  while (true) {
+    JobsAvailable.wait(Lock, [this]() { return Stop || !Jobs.empty(); });
+    if (Stop)
+      return;
+    CompileJob Job = std::move(Jobs.front());
+    Jobs.pop_front();
+    Lock.unlock();
+    Job();
+    Lock.lock();
+  }
+}
+
 GlobalVariable* createImplPointer(Function &F, const Twine &Name,
                                   Constant *Initializer) {
   assert(F.getParent() && "Function isn't in a module.");
@@ -19,6 +19,7 @@
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/ExecutionEngine/Orc/LazyEmittingLayer.h"
 #include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/IR/Verifier.h"
 #include "llvm/Object/Archive.h"
 
 namespace llvm {
@@ -104,6 +105,31 @@ class OrcMCJITReplacement : public ExecutionEngine {
     OrcMCJITReplacement &M;
   };
 
+  // Compile functor that honors the engine's verify-modules setting. As in
+  // MCJIT, verification runs when a module is actually emitted, so trusted
+  // pre-optimized modules loaded with verification disabled skip it
+  // entirely and go straight to codegen.
+  class VerifyingCompiler {
+  public:
+    VerifyingCompiler(OrcMCJITReplacement &M) : M(M) {}
+
+    object::OwningBinary<object::ObjectFile> operator()(Module &Mod) const {
+      if (M.getVerifyModules()) {
+        std::string Buf;
+        raw_string_ostream OS(Buf);
+        if (verifyModule(Mod, &OS)) {
+          OS.flush();
+          report_fatal_error("Invalid module '" + Mod.getModuleIdentifier() +
+                             "': " + Buf);
+        }
+      }
+      return SimpleCompiler(*M.TM)(Mod);
+    }
+
+  private:
+    OrcMCJITReplacement &M;
+  };
+
 private:
 
   static ExecutionEngine *
@@ -124,7 +150,7 @@ public:
         NotifyObjectLoaded(*this), NotifyFinalized(*this),
         ObjectLayer(ObjectLayerT::CreateRTDyldMMFtor(), NotifyObjectLoaded,
                     NotifyFinalized),
-        CompileLayer(ObjectLayer, SimpleCompiler(*this->TM)),
+        CompileLayer(ObjectLayer, VerifyingCompiler(*this)),
         LazyEmitLayer(CompileLayer) {
     setDataLayout(this->TM->getDataLayout());
   }
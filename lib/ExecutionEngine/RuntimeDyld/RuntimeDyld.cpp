@@ -739,53 +739,77 @@ void RuntimeDyldImpl::resolveRelocationList(const RelocationList &Relocs,
 }
 
 void RuntimeDyldImpl::resolveExternalSymbols() {
+  StringMap<uint64_t> ResolvedSymbols;
+
   while (!ExternalSymbolRelocations.empty()) {
-    StringMap<RelocationList>::iterator i = ExternalSymbolRelocations.begin();
-
-    StringRef Name = i->first();
-    if (Name.size() == 0) {
-      // This is an absolute symbol, use an address of zero.
-      DEBUG(dbgs() << "Resolving absolute relocations."
-                   << "\n");
-      RelocationList &Relocs = i->second;
-      resolveRelocationList(Relocs, 0);
-    } else {
-      uint64_t Addr = 0;
-      RTDyldSymbolTable::const_iterator Loc = GlobalSymbolTable.find(Name);
-      if (Loc == GlobalSymbolTable.end()) {
-        // This is an external symbol, try to get its address from
-        // MemoryManager.
-        Addr = MemMgr->getSymbolAddress(Name.data());
-        // The call to getSymbolAddress may have caused additional modules to
-        // be loaded, which may have added new entries to the
-        // ExternalSymbolRelocations map.  Consquently, we need to update our
-        // iterator.  This is also why retrieval of the relocation list
-        // associated with this symbol is deferred until below this point.
-        // New entries may have been added to the relocation list.
-        i = ExternalSymbolRelocations.find(Name);
+    // Gather every symbol we don't already know an address for, and hand them
+    // to the memory manager in one batch, so that managers which forward
+    // resolution somewhere expensive (e.g. over IPC) pay for one round trip
+    // per object rather than one per symbol.
+    StringMap<uint64_t> NewSymbols;
+    for (StringMap<RelocationList>::iterator i =
+             ExternalSymbolRelocations.begin(),
+         e = ExternalSymbolRelocations.end(); i != e; ++i) {
+      StringRef Name = i->first();
+      if (!Name.empty() && !GlobalSymbolTable.count(Name) &&
+          !ResolvedSymbols.count(Name))
+        NewSymbols[Name] = 0;
+    }
+
+    if (!NewSymbols.empty()) {
+      // The batch call may cause additional modules to be loaded, which may
+      // add new entries to the ExternalSymbolRelocations map; those are
+      // gathered on the next pass around the outer loop.
+      MemMgr->getSymbolAddresses(NewSymbols);
+      for (StringMap<uint64_t>::iterator i = NewSymbols.begin(),
+           e = NewSymbols.end(); i != e; ++i)
+        ResolvedSymbols[i->first()] = i->second;
+    }
+
+    // Now apply the relocations, using the addresses gathered above.
+    while (!ExternalSymbolRelocations.empty()) {
+      StringMap<RelocationList>::iterator i = ExternalSymbolRelocations.begin();
+
+      StringRef Name = i->first();
+      if (Name.size() == 0) {
+        // This is an absolute symbol, use an address of zero.
+        DEBUG(dbgs() << "Resolving absolute relocations."
+                     << "\n");
+        RelocationList &Relocs = i->second;
+        resolveRelocationList(Relocs, 0);
       } else {
-        // We found the symbol in our global table.  It was probably in a
-        // Module that we loaded previously.
-        const auto &SymInfo = Loc->second;
-        Addr = getSectionLoadAddress(SymInfo.getSectionID()) +
-               SymInfo.getOffset();
+        uint64_t Addr = 0;
+        RTDyldSymbolTable::const_iterator Loc = GlobalSymbolTable.find(Name);
+        if (Loc == GlobalSymbolTable.end()) {
+          // This is an external symbol; its address was fetched through the
+          // memory manager above. If it wasn't, its relocations were added by
+          // that batch call, so go around again and gather a new batch.
+          StringMap<uint64_t>::const_iterator RSI = ResolvedSymbols.find(Name);
+          if (RSI == ResolvedSymbols.end())
+            break;
+          Addr = RSI->second;
+        } else {
+          // We found the symbol in our global table.  It was probably in a
+          // Module that we loaded previously.
+          const auto &SymInfo = Loc->second;
+          Addr = getSectionLoadAddress(SymInfo.getSectionID()) +
+                 SymInfo.getOffset();
+        }
+
+        // FIXME: Implement error handling that doesn't kill the host program!
+        if (!Addr)
+          report_fatal_error("Program used external function '" + Name +
+                             "' which could not be resolved!");
+
+        updateGOTEntries(Name, Addr);
+        DEBUG(dbgs() << "Resolving relocations Name: " << Name << "\t"
+                     << format("0x%lx", Addr) << "\n");
+        RelocationList &Relocs = i->second;
+        resolveRelocationList(Relocs, Addr);
       }
 
-      // FIXME: Implement error handling that doesn't kill the host program!
-      if (!Addr)
-        report_fatal_error("Program used external function '" + Name +
-                           "' which could not be resolved!");
-
-      updateGOTEntries(Name, Addr);
-      DEBUG(dbgs() << "Resolving relocations Name: " << Name << "\t"
-                   << format("0x%lx", Addr) << "\n");
-      // This list may have been updated when we called getSymbolAddress, so
-      // don't change this code to get the list earlier.
-      RelocationList &Relocs = i->second;
-      resolveRelocationList(Relocs, Addr);
+      ExternalSymbolRelocations.erase(i);
     }
-
-    ExternalSymbolRelocations.erase(i);
   }
 }
 
@@ -858,6 +858,64 @@ void RuntimeDyldELF::resolveRelocation(const RelocationEntry &RE,
                            RE.SymOffset);
 }
 
+void RuntimeDyldELF::resolveRelocationList(const RelocationList &Relocs,
+                                           uint64_t Value) {
+  // Batching only pays off for the x86-64 absolute relocation classes, which
+  // dominate large JITed objects; everything else takes the generic path.
+  if (Arch != Triple::x86_64)
+    return RuntimeDyldImpl::resolveRelocationList(Relocs, Value);
+
+  // Sort the entries by type so that each class below is applied in one tight
+  // loop over the section buffers instead of re-dispatching per relocation.
+  SmallVector<const RelocationEntry *, 64> Sorted;
+  Sorted.reserve(Relocs.size());
+  for (unsigned i = 0, e = Relocs.size(); i != e; ++i) {
+    const RelocationEntry &RE = Relocs[i];
+    // Ignore relocations for sections that were not loaded
+    if (Sections[RE.SectionID].Address == nullptr)
+      continue;
+    Sorted.push_back(&RE);
+  }
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const RelocationEntry *LHS, const RelocationEntry *RHS) {
+                     return LHS->RelType < RHS->RelType;
+                   });
+
+  for (size_t i = 0, e = Sorted.size(); i != e;) {
+    uint32_t Type = Sorted[i]->RelType;
+    size_t End = i + 1;
+    while (End != e && Sorted[End]->RelType == Type)
+      ++End;
+
+    switch (Type) {
+    case ELF::R_X86_64_64:
+      for (; i != End; ++i) {
+        const RelocationEntry &RE = *Sorted[i];
+        support::ulittle64_t::ref(Sections[RE.SectionID].Address + RE.Offset) =
+            Value + RE.Addend;
+      }
+      break;
+    case ELF::R_X86_64_32:
+    case ELF::R_X86_64_32S:
+      for (; i != End; ++i) {
+        const RelocationEntry &RE = *Sorted[i];
+        uint64_t RelValue = Value + RE.Addend;
+        assert((Type == ELF::R_X86_64_32 && (RelValue <= UINT32_MAX)) ||
+               (Type == ELF::R_X86_64_32S &&
+                ((int64_t)RelValue <= INT32_MAX &&
+                 (int64_t)RelValue >= INT32_MIN)));
+        support::ulittle32_t::ref(Sections[RE.SectionID].Address + RE.Offset) =
+            (uint32_t)(RelValue & 0xFFFFFFFF);
+      }
+      break;
+    default:
+      for (; i != End; ++i)
+        resolveRelocation(*Sorted[i], Value);
+      break;
+    }
+  }
+}
+
 void RuntimeDyldELF::resolveRelocation(const SectionEntry &Section,
                                        uint64_t Offset, uint64_t Value,
                                        uint32_t Type, int64_t Addend,
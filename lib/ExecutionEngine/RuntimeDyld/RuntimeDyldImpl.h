@@ -333,7 +333,10 @@ protected:
   uint8_t *createStubFunction(uint8_t *Addr, unsigned AbiVariant = 0);
 
   /// \brief Resolves relocations from Relocs list with address from Value.
-  void resolveRelocationList(const RelocationList &Relocs, uint64_t Value);
+  /// Virtual so that subclasses can batch common relocation classes instead
+  /// of dispatching through resolveRelocation per entry.
+  virtual void resolveRelocationList(const RelocationList &Relocs,
+                                     uint64_t Value);
 
   /// \brief A object file specific relocation resolver
   /// \param RE The relocation to be resolved
@@ -15,6 +15,7 @@
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Support/MathExtras.h"
+#include <algorithm>
 
 namespace llvm {
 
@@ -66,11 +67,14 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   // Note that all sections get allocated as read-write.  The permissions will
   // be updated later based on memory group.
   //
-  // FIXME: It would be useful to define a default allocation size (or add
-  // it as a constructor parameter) to minimize the number of allocations.
+  // If the client configured a slab size, round the request up to a multiple
+  // of it; the remainder goes on the free list below, so subsequent sections
+  // pack into the same mapping rather than each getting their own.
   //
   // FIXME: Initialize the Near member for each memory group to avoid
   // interleaving.
+  if (SlabSize)
+    RequiredSize = SlabSize * ((RequiredSize + SlabSize - 1) / SlabSize);
   std::error_code ec;
   sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(RequiredSize,
                                                           &MemGroup.Near,
@@ -146,16 +150,41 @@ bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
 std::error_code
 SectionMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                                   unsigned Permissions) {
-
-  for (int i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
-    std::error_code ec;
-    ec =
-        sys::Memory::protectMappedMemory(MemGroup.AllocatedMem[i], Permissions);
+  // Only blocks allocated since the last finalization need their permissions
+  // changed.  Earlier blocks already carry them, and because their free lists
+  // were dropped when they were finalized, nothing new lands in them.
+  unsigned Begin = MemGroup.NumFinalized;
+  unsigned End = MemGroup.AllocatedMem.size();
+  if (Begin == End)
+    return std::error_code();
+
+  // Sort the new blocks by address and merge contiguous ones, so that each
+  // run of adjacent mappings costs a single protection syscall.  Loading a
+  // batch of small modules carves many sections out of a few slabs, which is
+  // exactly such a run.
+  SmallVector<sys::MemoryBlock, 16> Blocks(
+      MemGroup.AllocatedMem.begin() + Begin, MemGroup.AllocatedMem.end());
+  std::sort(Blocks.begin(), Blocks.end(),
+            [](const sys::MemoryBlock &L, const sys::MemoryBlock &R) {
+              return L.base() < R.base();
+            });
+
+  for (unsigned i = 0, e = Blocks.size(); i != e;) {
+    uintptr_t RunBase = (uintptr_t)Blocks[i].base();
+    uintptr_t RunEnd = RunBase + Blocks[i].size();
+    unsigned j = i + 1;
+    while (j != e && (uintptr_t)Blocks[j].base() == RunEnd)
+      RunEnd += Blocks[j++].size();
+
+    sys::MemoryBlock Run((void *)RunBase, RunEnd - RunBase);
+    std::error_code ec = sys::Memory::protectMappedMemory(Run, Permissions);
     if (ec) {
       return ec;
     }
+    i = j;
   }
 
+  MemGroup.NumFinalized = End;
   return std::error_code();
 }
 
@@ -162,6 +162,13 @@ int FuzzerDriver(int argc, char **argv, UserCallback Callback) {
   Options.UseCoveragePairs = Flags.use_coverage_pairs;
   Options.PreferSmallDuringInitialShuffle =
       Flags.prefer_small_during_initial_shuffle;
+  Options.NumThreads = Flags.num_threads;
+  if (Flags.num_threads > 1 &&
+      (Flags.use_full_coverage_set || Flags.use_coverage_pairs)) {
+    std::cerr << "-num_threads is only supported with the default"
+                 " total-coverage mode\n";
+    return 1;
+  }
   if (Flags.runs >= 0)
     Options.MaxNumberOfRuns = Flags.runs;
   if (!inputs.empty())
@@ -8,11 +8,13 @@
 //===----------------------------------------------------------------------===//
 // Define the main class fuzzer::Fuzzer and most functions.
 //===----------------------------------------------------------------------===//
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <chrono>
 #include <cstddef>
 #include <cstdlib>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -52,6 +54,7 @@ class Fuzzer {
     bool UseCoveragePairs = false;
     int PreferSmallDuringInitialShuffle = -1;
     size_t MaxNumberOfRuns = ULONG_MAX;
+    int NumThreads = 0;
     std::string OutputCorpus;
   };
   Fuzzer(UserCallback Callback, FuzzingOptions Options)
@@ -79,6 +82,11 @@ class Fuzzer {
 
  private:
   size_t MutateAndTestOne(Unit *U);
+  size_t MutateAndTestOneThreaded(Unit *U, std::vector<Unit> *Batch);
+  size_t LoopInThreads(size_t NumIterations);
+  void WorkerThreadLoop(size_t NumIterations, std::atomic<size_t> *Cursor,
+                        std::atomic<size_t> *NewUnits);
+  void FlushOutputBatch(std::vector<Unit> *Batch);
   size_t RunOne(const Unit &U);
   size_t RunOneMaximizeTotalCoverage(const Unit &U);
   size_t RunOneMaximizeFullCoverageSet(const Unit &U);
@@ -90,9 +98,11 @@ class Fuzzer {
   static void DeathCallback();
   static Unit CurrentUnit;
 
-  size_t TotalNumberOfRuns = 0;
+  std::atomic<size_t> TotalNumberOfRuns{0};
 
   std::vector<Unit> Corpus;
+  // Guards Corpus when fuzzing with NumThreads > 1.
+  std::mutex CorpusMutex;
   std::unordered_set<uintptr_t> FullCoverageSets;
   std::unordered_set<uint64_t>  CoveragePairs;
   UserCallback Callback;
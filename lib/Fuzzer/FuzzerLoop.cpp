@@ -13,6 +13,7 @@
 #include <sanitizer/coverage_interface.h>
 #include <algorithm>
 #include <iostream>
+#include <thread>
 
 namespace fuzzer {
 
@@ -141,12 +142,13 @@ size_t Fuzzer::RunOneMaximizeTotalCoverage(const Unit &U) {
   size_t OldCoverage = __sanitizer_get_total_unique_coverage();
   Callback(U.data(), U.size());
   size_t NewCoverage = __sanitizer_get_total_unique_coverage();
-  if (!(TotalNumberOfRuns & (TotalNumberOfRuns - 1)) && Options.Verbosity) {
+  size_t NumRuns = TotalNumberOfRuns;
+  if (!(NumRuns & (NumRuns - 1)) && Options.Verbosity) {
     size_t Seconds = secondsSinceProcessStartUp();
     std::cerr
-        << "#" << TotalNumberOfRuns
+        << "#" << NumRuns
         << "\tcov: " << NewCoverage
-        << "\texec/s: " << (Seconds ? TotalNumberOfRuns / Seconds : 0) << "\n";
+        << "\texec/s: " << (Seconds ? NumRuns / Seconds : 0) << "\n";
   }
   if (NewCoverage > OldCoverage)
     return NewCoverage;
@@ -208,7 +210,107 @@ size_t Fuzzer::MutateAndTestOne(Unit *U) {
   return NewUnits;
 }
 
+// Like MutateAndTestOne, but safe to call from several threads: new units are
+// appended to the shared corpus under CorpusMutex and collected into Batch so
+// the output corpus can be written in batches instead of one file per find.
+size_t Fuzzer::MutateAndTestOneThreaded(Unit *U, std::vector<Unit> *Batch) {
+  size_t NewUnits = 0;
+  for (int i = 0; i < Options.MutateDepth; i++) {
+    if (TotalNumberOfRuns >= Options.MaxNumberOfRuns)
+      return NewUnits;
+    Mutate(U, Options.MaxLen);
+    size_t NewCoverage = RunOne(*U);
+    if (!NewCoverage) continue;
+    size_t CorpusSize;
+    {
+      std::lock_guard<std::mutex> Lock(CorpusMutex);
+      Corpus.push_back(*U);
+      CorpusSize = Corpus.size();
+    }
+    Batch->push_back(*U);
+    NewUnits++;
+    if (Options.Verbosity)
+      std::cerr << "#" << TotalNumberOfRuns
+                << "\tNEW: " << NewCoverage
+                << " L: " << U->size()
+                << " S: " << CorpusSize
+                << " I: " << i
+                << "\n";
+    if (Options.ExitOnFirst)
+      exit(0);
+  }
+  return NewUnits;
+}
+
+void Fuzzer::FlushOutputBatch(std::vector<Unit> *Batch) {
+  for (const auto &U : *Batch)
+    WriteToOutputCorpus(U);
+  Batch->clear();
+}
+
+void Fuzzer::WorkerThreadLoop(size_t NumIterations, std::atomic<size_t> *Cursor,
+                              std::atomic<size_t> *NewUnits) {
+  // Units written to the output corpus get distinct hash-based names, so only
+  // Corpus itself needs locking.  File writes are batched per worker.
+  const size_t kOutputBatchSize = 16;
+  Unit U, Base, Cross;
+  std::vector<Unit> Batch;
+  while (true) {
+    if (TotalNumberOfRuns >= Options.MaxNumberOfRuns) break;
+    size_t C = (*Cursor)++;
+    size_t SnapshotSize;
+    {
+      std::lock_guard<std::mutex> Lock(CorpusMutex);
+      SnapshotSize = Corpus.size();
+      if (!SnapshotSize) break;
+      if (C / SnapshotSize >= NumIterations) break;
+      Base = Corpus[C % SnapshotSize];
+    }
+    // First, simply mutate the unit w/o doing crosses.
+    U = Base;
+    *NewUnits += MutateAndTestOneThreaded(&U, &Batch);
+    // Now, cross with others.  The corpus only grows, so indexes below the
+    // snapshot size stay valid.
+    if (Options.DoCrossOver) {
+      for (size_t J2 = 0; J2 < SnapshotSize; J2++) {
+        if (TotalNumberOfRuns >= Options.MaxNumberOfRuns) break;
+        {
+          std::lock_guard<std::mutex> Lock(CorpusMutex);
+          Cross = Corpus[J2];
+        }
+        U.clear();
+        CrossOver(Base, Cross, &U, Options.MaxLen);
+        *NewUnits += MutateAndTestOneThreaded(&U, &Batch);
+      }
+    }
+    if (Batch.size() >= kOutputBatchSize)
+      FlushOutputBatch(&Batch);
+  }
+  FlushOutputBatch(&Batch);
+}
+
+// Experimental: run the fuzzing loop on several threads inside one process,
+// sharing a single corpus.  Coverage state in the sanitizer run-time is
+// process-global, so workers observe each other's progress for free: a unit
+// is kept if total coverage grew while it ran.  Only the default
+// total-coverage mode is supported; the coverage-set/pair modes reset global
+// state per run and must stay single-threaded.  The alarm timer and the
+// crash-time CurrentUnit snapshot are best-effort in this mode.
+size_t Fuzzer::LoopInThreads(size_t NumIterations) {
+  std::atomic<size_t> Cursor(0);
+  std::atomic<size_t> NewUnits(0);
+  std::vector<std::thread> V;
+  for (int i = 0; i < Options.NumThreads; i++)
+    V.push_back(std::thread(&Fuzzer::WorkerThreadLoop, this, NumIterations,
+                            &Cursor, &NewUnits));
+  for (auto &T : V)
+    T.join();
+  return NewUnits;
+}
+
 size_t Fuzzer::Loop(size_t NumIterations) {
+  if (Options.NumThreads > 1)
+    return LoopInThreads(NumIterations);
   size_t NewUnits = 0;
   for (size_t i = 1; i <= NumIterations; i++) {
     for (size_t J1 = 0; J1 < Corpus.size(); J1++) {
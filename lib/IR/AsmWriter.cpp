@@ -670,6 +670,19 @@ inline void SlotTracker::initialize() {
 void SlotTracker::processModule() {
   ST_DEBUG("begin processModule!\n");
 
+  // Size the map for all the unnamed globals and functions up front; walking
+  // the lists again is much cheaper than growing the map as we go.
+  unsigned NumSlots = 0;
+  for (Module::const_global_iterator I = TheModule->global_begin(),
+         E = TheModule->global_end(); I != E; ++I)
+    if (!I->hasName())
+      ++NumSlots;
+  for (Module::const_iterator I = TheModule->begin(), E = TheModule->end();
+       I != E; ++I)
+    if (!I->hasName())
+      ++NumSlots;
+  mMap.reserve(NumSlots);
+
   // Add all of the unnamed global variables to the value table.
   for (Module::const_global_iterator I = TheModule->global_begin(),
          E = TheModule->global_end(); I != E; ++I) {
@@ -707,6 +720,26 @@ void SlotTracker::processFunction() {
   ST_DEBUG("begin processFunction!\n");
   fNext = 0;
 
+  // Count the slots the function will need and size the map accordingly.
+  // For large functions the repeated grow-and-rehash cycles of an
+  // incrementally filled map cost far more than this extra walk, and the
+  // per-operand lookups during printing then never hit a resizing map.
+  unsigned NumSlots = 0;
+  for (Function::const_arg_iterator AI = TheFunction->arg_begin(),
+       AE = TheFunction->arg_end(); AI != AE; ++AI)
+    if (!AI->hasName())
+      ++NumSlots;
+  for (Function::const_iterator BB = TheFunction->begin(),
+       E = TheFunction->end(); BB != E; ++BB) {
+    if (!BB->hasName())
+      ++NumSlots;
+    for (BasicBlock::const_iterator I = BB->begin(), E = BB->end(); I != E;
+         ++I)
+      if (!I->getType()->isVoidTy() && !I->hasName())
+        ++NumSlots;
+  }
+  fMap.reserve(NumSlots);
+
   // Add all the function arguments with no names.
   for(Function::const_arg_iterator AI = TheFunction->arg_begin(),
       AE = TheFunction->arg_end(); AI != AE; ++AI)
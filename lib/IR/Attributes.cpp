@@ -436,18 +436,37 @@ uint64_t AttributeImpl::getAttrMask(Attribute::AttrKind Val) {
 // AttributeSetNode Definition
 //===----------------------------------------------------------------------===//
 
+namespace {
+/// \brief Make \p New the most recently used entry of the small MRU array
+/// kept in front of an attribute uniquing table.
+template <typename T> void updateAttrMRU(T *(&MRU)[4], T *New) {
+  MRU[3] = MRU[2];
+  MRU[2] = MRU[1];
+  MRU[1] = MRU[0];
+  MRU[0] = New;
+}
+}
+
 AttributeSetNode *AttributeSetNode::get(LLVMContext &C,
                                         ArrayRef<Attribute> Attrs) {
   if (Attrs.empty())
     return nullptr;
 
-  // Otherwise, build a key to look up the existing attributes.
   LLVMContextImpl *pImpl = C.pImpl;
-  FoldingSetNodeID ID;
 
   SmallVector<Attribute, 8> SortedAttrs(Attrs.begin(), Attrs.end());
   array_pod_sort(SortedAttrs.begin(), SortedAttrs.end());
 
+  // Check the most recently created nodes by content first.  Attributes are
+  // uniqued pointers, so this is a handful of pointer compares and avoids
+  // profiling and hashing for the common case of a repeated list.
+  for (AttributeSetNode *Cached : pImpl->AttrsNodeMRU)
+    if (Cached && Cached->NumAttrs == SortedAttrs.size() &&
+        std::equal(SortedAttrs.begin(), SortedAttrs.end(), Cached->begin()))
+      return Cached;
+
+  // Otherwise, build a key to look up the existing attributes.
+  FoldingSetNodeID ID;
   for (SmallVectorImpl<Attribute>::iterator I = SortedAttrs.begin(),
          E = SortedAttrs.end(); I != E; ++I)
     I->Profile(ID);
@@ -466,6 +485,8 @@ AttributeSetNode *AttributeSetNode::get(LLVMContext &C,
     pImpl->AttrsSetNodes.InsertNode(PA, InsertPoint);
   }
 
+  updateAttrMRU(pImpl->AttrsNodeMRU, PA);
+
   // Return the AttributesListNode that we found or created.
   return PA;
 }
@@ -576,6 +597,15 @@ AttributeSet
 AttributeSet::getImpl(LLVMContext &C,
                       ArrayRef<std::pair<unsigned, AttributeSetNode*> > Attrs) {
   LLVMContextImpl *pImpl = C.pImpl;
+
+  // Check the most recently created lists by content first; the entries are
+  // (index, uniqued node) pairs, so equality is cheap and a hit skips the
+  // profiling and hash lookup below.
+  for (AttributeSetImpl *Cached : pImpl->AttrsListMRU)
+    if (Cached && Cached->getNumAttributes() == Attrs.size() &&
+        std::equal(Attrs.begin(), Attrs.end(), Cached->getNode(0)))
+      return AttributeSet(Cached);
+
   FoldingSetNodeID ID;
   AttributeSetImpl::Profile(ID, Attrs);
 
@@ -593,6 +623,8 @@ AttributeSet::getImpl(LLVMContext &C,
     pImpl->AttrsLists.InsertNode(PA, InsertPoint);
   }
 
+  updateAttrMRU(pImpl->AttrsListMRU, PA);
+
   // Return the AttributesList that we found or created.
   return AttributeSet(PA);
 }
@@ -90,6 +90,13 @@ BasicBlock::~BasicBlock() {
 }
 
 void BasicBlock::setParent(Function *parent) {
+  // The instruction set of both the old and the new function changes with the
+  // block moving between them.
+  if (Parent)
+    Parent->bumpInstructionGeneration();
+  if (parent)
+    parent->bumpInstructionGeneration();
+
   // Set Parent=parent, updating instruction symtab entries as appropriate.
   InstList.setSymTabObject(&Parent, parent);
 }
@@ -0,0 +1,36 @@
+//===- CompileDeadline.cpp - Compile-time budget --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the CompileDeadline class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/CompileDeadline.h"
+#include "llvm/Pass.h"
+
+using namespace llvm;
+
+void CompileDeadline::begin(unsigned Milliseconds) {
+  Start = TimeRecord::getCurrentTime(/*Start=*/true);
+  BudgetSeconds = Milliseconds / 1000.0;
+  Armed = true;
+}
+
+bool CompileDeadline::expired() const {
+  if (!Armed)
+    return false;
+  TimeRecord Now = TimeRecord::getCurrentTime(/*Start=*/false);
+  return Now.getWallTime() - Start.getWallTime() > BudgetSeconds;
+}
+
+bool CompileDeadline::shouldSkipPass(const Pass *P) const {
+  // Check membership first: it is cheaper than reading the clock, and most
+  // passes in a pipeline are not deferrable.
+  return Armed && DeferrableIDs.count(P->getPassID()) && expired();
+}
@@ -558,13 +558,21 @@ Constant *ConstantInt::getFalse(Type *Ty) {
 ConstantInt *ConstantInt::get(LLVMContext &Context, const APInt &V) {
   // get an existing value or the insertion position
   LLVMContextImpl *pImpl = Context.pImpl;
-  ConstantInt *&Slot = pImpl->IntConstants[V];
-  if (!Slot) {
-    // Get the corresponding integer type for the bit width of the value.
-    IntegerType *ITy = IntegerType::get(Context, V.getBitWidth());
-    Slot = new ConstantInt(ITy, V);
+  unsigned Shard = pImpl->getIntConstantShard(V);
+  // In concurrent mode the integer type must be looked up before taking the
+  // shard lock, since type uniquing is not covered by the constant locks.
+  IntegerType *ITy = IntegerType::get(Context, V.getBitWidth());
+  if (pImpl->ConcurrentConstantsEnabled) {
+    sys::SmartScopedLock<true> Lock(pImpl->IntConstantLocks[Shard]);
+    ConstantInt *&Slot = pImpl->IntConstants[Shard][V];
+    if (!Slot)
+      Slot = new ConstantInt(ITy, V);
+    return Slot;
   }
-  assert(Slot->getType() == IntegerType::get(Context, V.getBitWidth()));
+  ConstantInt *&Slot = pImpl->IntConstants[Shard][V];
+  if (!Slot)
+    Slot = new ConstantInt(ITy, V);
+  assert(Slot->getType() == ITy);
   return Slot;
 }
 
@@ -687,28 +695,38 @@ Constant *ConstantFP::getZeroValueForNegation(Type *Ty) {
 ConstantFP* ConstantFP::get(LLVMContext &Context, const APFloat& V) {
   LLVMContextImpl* pImpl = Context.pImpl;
 
-  ConstantFP *&Slot = pImpl->FPConstants[V];
-
-  if (!Slot) {
-    Type *Ty;
-    if (&V.getSemantics() == &APFloat::IEEEhalf)
-      Ty = Type::getHalfTy(Context);
-    else if (&V.getSemantics() == &APFloat::IEEEsingle)
-      Ty = Type::getFloatTy(Context);
-    else if (&V.getSemantics() == &APFloat::IEEEdouble)
-      Ty = Type::getDoubleTy(Context);
-    else if (&V.getSemantics() == &APFloat::x87DoubleExtended)
-      Ty = Type::getX86_FP80Ty(Context);
-    else if (&V.getSemantics() == &APFloat::IEEEquad)
-      Ty = Type::getFP128Ty(Context);
-    else {
-      assert(&V.getSemantics() == &APFloat::PPCDoubleDouble && 
-             "Unknown FP format");
-      Ty = Type::getPPC_FP128Ty(Context);
-    }
-    Slot = new ConstantFP(Ty, V);
+  // The primitive FP types are members of LLVMContextImpl, so looking one up
+  // is a thread-safe read and may happen outside the shard lock.
+  Type *Ty;
+  if (&V.getSemantics() == &APFloat::IEEEhalf)
+    Ty = Type::getHalfTy(Context);
+  else if (&V.getSemantics() == &APFloat::IEEEsingle)
+    Ty = Type::getFloatTy(Context);
+  else if (&V.getSemantics() == &APFloat::IEEEdouble)
+    Ty = Type::getDoubleTy(Context);
+  else if (&V.getSemantics() == &APFloat::x87DoubleExtended)
+    Ty = Type::getX86_FP80Ty(Context);
+  else if (&V.getSemantics() == &APFloat::IEEEquad)
+    Ty = Type::getFP128Ty(Context);
+  else {
+    assert(&V.getSemantics() == &APFloat::PPCDoubleDouble && 
+           "Unknown FP format");
+    Ty = Type::getPPC_FP128Ty(Context);
   }
 
+  unsigned Shard = pImpl->getFPConstantShard(V);
+  if (pImpl->ConcurrentConstantsEnabled) {
+    sys::SmartScopedLock<true> Lock(pImpl->FPConstantLocks[Shard]);
+    ConstantFP *&Slot = pImpl->FPConstants[Shard][V];
+    if (!Slot)
+      Slot = new ConstantFP(Ty, V);
+    return Slot;
+  }
+
+  ConstantFP *&Slot = pImpl->FPConstants[Shard][V];
+  if (!Slot)
+    Slot = new ConstantFP(Ty, V);
+
   return Slot;
 }
 
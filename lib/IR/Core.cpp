@@ -525,10 +525,21 @@ const char *LLVMGetValueName(LLVMValueRef Val) {
   return unwrap(Val)->getName().data();
 }
 
+const char *LLVMGetValueName2(LLVMValueRef Val, size_t *Length) {
+  StringRef Name = unwrap(Val)->getName();
+  if (Length)
+    *Length = Name.size();
+  return Name.data();
+}
+
 void LLVMSetValueName(LLVMValueRef Val, const char *Name) {
   unwrap(Val)->setName(Name);
 }
 
+void LLVMSetValueName2(LLVMValueRef Val, const char *Name, size_t NameLen) {
+  unwrap(Val)->setName(StringRef(Name, NameLen));
+}
+
 void LLVMDumpValue(LLVMValueRef Val) {
   unwrap(Val)->dump();
 }
@@ -1641,10 +1652,22 @@ LLVMValueRef LLVMAddFunction(LLVMModuleRef M, const char *Name,
                                GlobalValue::ExternalLinkage, Name, unwrap(M)));
 }
 
+LLVMValueRef LLVMAddFunction2(LLVMModuleRef M, const char *Name,
+                              size_t NameLen, LLVMTypeRef FunctionTy) {
+  return wrap(Function::Create(unwrap<FunctionType>(FunctionTy),
+                               GlobalValue::ExternalLinkage,
+                               StringRef(Name, NameLen), unwrap(M)));
+}
+
 LLVMValueRef LLVMGetNamedFunction(LLVMModuleRef M, const char *Name) {
   return wrap(unwrap(M)->getFunction(Name));
 }
 
+LLVMValueRef LLVMGetNamedFunction2(LLVMModuleRef M, const char *Name,
+                                   size_t NameLen) {
+  return wrap(unwrap(M)->getFunction(StringRef(Name, NameLen)));
+}
+
 LLVMValueRef LLVMGetFirstFunction(LLVMModuleRef M) {
   Module *Mod = unwrap(M);
   Module::iterator I = Mod->begin();
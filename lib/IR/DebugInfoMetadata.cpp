@@ -31,6 +31,29 @@ MDLocation::MDLocation(LLVMContext &C, StorageType Storage, unsigned Line,
   SubclassData16 = Column;
 }
 
+void *MDLocation::operator new(size_t Size, LLVMContext &Context,
+                               unsigned NumOps) {
+  assert(Size == sizeof(MDLocation) && "Expected exact size for pool blocks");
+  void *Ptr =
+      Context.pImpl->LocationPool.allocate(Size + NumOps * sizeof(MDOperand),
+                                           NumOps);
+  MDOperand *O = static_cast<MDOperand *>(Ptr);
+  for (MDOperand *E = O + NumOps; O != E; ++O)
+    (void)new (O) MDOperand;
+  return O;
+}
+
+void MDLocation::operator delete(void *Mem) {
+  MDLocation *N = static_cast<MDLocation *>(Mem);
+  // NumOperands and the context pointer are POD and survive ~MDLocation.
+  unsigned NumOps = N->getNumOperands();
+  LLVMContextImpl *pImpl = N->getContext().pImpl;
+  MDOperand *O = static_cast<MDOperand *>(Mem);
+  for (MDOperand *E = O - NumOps; O != E; --O)
+    (O - 1)->~MDOperand();
+  pImpl->LocationPool.deallocate(O, NumOps);
+}
+
 static void adjustColumn(unsigned &Column) {
   // Set to unknown on overflow.  We only have 16 bits to play with here.
   if (Column >= (1u << 16))
@@ -59,7 +82,7 @@ MDLocation *MDLocation::getImpl(LLVMContext &Context, unsigned Line,
   Ops.push_back(Scope);
   if (InlinedAt)
     Ops.push_back(InlinedAt);
-  return storeImpl(new (Ops.size())
+  return storeImpl(new (Context, Ops.size())
                        MDLocation(Context, Storage, Line, Column, Ops),
                    Storage, Context.pImpl->MDLocations);
 }
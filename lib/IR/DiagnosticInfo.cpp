@@ -154,32 +154,51 @@ void DiagnosticInfoOptimizationBase::print(DiagnosticPrinter &DP) const {
   DP << getLocationStr() << ": " << getMsg();
 }
 
+/// Return true if \p PassName matches the pattern given in \p Loc.
+static bool passNameMatchesRemarkFilter(const PassRemarksOpt &Loc,
+                                        StringRef PassName) {
+  return Loc.Pattern && Loc.Pattern->match(PassName);
+}
+
+/// Return true if a remark from \p PassName needs to be constructed at all:
+/// either the matching -pass-remarks* filter accepts the pass name, or a
+/// handler that wants unfiltered diagnostics is installed on \p Ctx.
+/// Remark-heavy passes emit these diagnostics on every missed opportunity,
+/// so when they will just be dropped it is worth detecting before building
+/// the diagnostic object.
+static bool remarkNeedsDiagnostic(const LLVMContext &Ctx,
+                                  const PassRemarksOpt &Loc,
+                                  StringRef PassName) {
+  return passNameMatchesRemarkFilter(Loc, PassName) ||
+         !Ctx.diagnosticFiltersRespected();
+}
+
 bool DiagnosticInfoOptimizationRemark::isEnabled() const {
-  return PassRemarksOptLoc.Pattern &&
-         PassRemarksOptLoc.Pattern->match(getPassName());
+  return passNameMatchesRemarkFilter(PassRemarksOptLoc, getPassName());
 }
 
 bool DiagnosticInfoOptimizationRemarkMissed::isEnabled() const {
-  return PassRemarksMissedOptLoc.Pattern &&
-         PassRemarksMissedOptLoc.Pattern->match(getPassName());
+  return passNameMatchesRemarkFilter(PassRemarksMissedOptLoc, getPassName());
 }
 
 bool DiagnosticInfoOptimizationRemarkAnalysis::isEnabled() const {
-  return PassRemarksAnalysisOptLoc.Pattern &&
-         PassRemarksAnalysisOptLoc.Pattern->match(getPassName());
+  return passNameMatchesRemarkFilter(PassRemarksAnalysisOptLoc, getPassName());
 }
 
 void llvm::emitOptimizationRemark(LLVMContext &Ctx, const char *PassName,
                                   const Function &Fn, const DebugLoc &DLoc,
                                   const Twine &Msg) {
-  Ctx.diagnose(DiagnosticInfoOptimizationRemark(PassName, Fn, DLoc, Msg));
+  if (remarkNeedsDiagnostic(Ctx, PassRemarksOptLoc, PassName))
+    Ctx.diagnose(DiagnosticInfoOptimizationRemark(PassName, Fn, DLoc, Msg));
 }
 
 void llvm::emitOptimizationRemarkMissed(LLVMContext &Ctx, const char *PassName,
                                         const Function &Fn,
                                         const DebugLoc &DLoc,
                                         const Twine &Msg) {
-  Ctx.diagnose(DiagnosticInfoOptimizationRemarkMissed(PassName, Fn, DLoc, Msg));
+  if (remarkNeedsDiagnostic(Ctx, PassRemarksMissedOptLoc, PassName))
+    Ctx.diagnose(
+        DiagnosticInfoOptimizationRemarkMissed(PassName, Fn, DLoc, Msg));
 }
 
 void llvm::emitOptimizationRemarkAnalysis(LLVMContext &Ctx,
@@ -187,8 +206,9 @@ void llvm::emitOptimizationRemarkAnalysis(LLVMContext &Ctx,
                                           const Function &Fn,
                                           const DebugLoc &DLoc,
                                           const Twine &Msg) {
-  Ctx.diagnose(
-      DiagnosticInfoOptimizationRemarkAnalysis(PassName, Fn, DLoc, Msg));
+  if (remarkNeedsDiagnostic(Ctx, PassRemarksAnalysisOptLoc, PassName))
+    Ctx.diagnose(
+        DiagnosticInfoOptimizationRemarkAnalysis(PassName, Fn, DLoc, Msg));
 }
 
 bool DiagnosticInfoOptimizationFailure::isEnabled() const {
@@ -281,6 +281,30 @@ bool DominatorTree::isReachableFromEntry(const Use &U) const {
   return isReachableFromEntry(I->getParent());
 }
 
+void DominatorTree::insertEdge(BasicBlock *From, BasicBlock *To) {
+  // An edge out of unreachable code adds no paths from the entry, and an
+  // edge into a block that already dominates its source only creates cycles.
+  // Any walk around a cycle contains a sub-walk that avoids it, so neither
+  // kind of edge can change any dominance relation.
+  if (!isReachableFromEntry(From) || dominates(To, From))
+    return;
+
+  // TODO: Recognize more cases (e.g. when the nearest common ancestor of
+  // From and To is To's immediate dominator and To's subtree is unaffected)
+  // before giving up.
+  recalculate(*From->getParent());
+}
+
+void DominatorTree::deleteEdge(BasicBlock *From, BasicBlock *To) {
+  // The mirror image of insertEdge: removing an edge that could not add any
+  // acyclic paths cannot remove any either. Note that the tree still
+  // describes the old CFG here, which is exactly what the check needs.
+  if (!isReachableFromEntry(From) || dominates(To, From))
+    return;
+
+  recalculate(*From->getParent());
+}
+
 void DominatorTree::verifyDomTree() const {
   if (!VerifyDomInfo)
     return;
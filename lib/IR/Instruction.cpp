@@ -55,7 +55,20 @@ Instruction::~Instruction() {
 
 
 void Instruction::setParent(BasicBlock *P) {
+  // Moving an instruction changes which assumes and conditions dominate it,
+  // so position-dependent cached facts about it go stale even though no use
+  // was rewritten.
+  ++ValueMutationEpoch;
+
+  // Keep the owning functions' instruction generation in sync; both the old
+  // and the new function (if any) see their instruction set change.
+  if (Parent)
+    if (Function *F = Parent->getParent())
+      F->bumpInstructionGeneration();
   Parent = P;
+  if (P)
+    if (Function *F = P->getParent())
+      F->bumpInstructionGeneration();
 }
 
 void Instruction::removeFromParent() {
@@ -82,6 +95,9 @@ void Instruction::insertAfter(Instruction *InsertPos) {
 /// insert it into the basic block that MovePos lives in, right before
 /// MovePos.
 void Instruction::moveBefore(Instruction *MovePos) {
+  // A splice within one block never triggers the ilist callbacks (and thus
+  // setParent), but it is still motion; see the comment in setParent.
+  ++ValueMutationEpoch;
   MovePos->getParent()->getInstList().splice(MovePos,getParent()->getInstList(),
                                              this);
 }
@@ -20,11 +20,20 @@
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Metadata.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/RemarkStream.h"
 #include "llvm/Support/SourceMgr.h"
 #include <cctype>
 using namespace llvm;
 
+static cl::opt<std::string> RemarkStreamFile(
+    "remark-stream-file", cl::Hidden,
+    cl::desc("Append all optimization remarks to <file> as a binary remark "
+             "stream (see llvm/Support/RemarkStream.h)"),
+    cl::value_desc("file"));
+
 static ManagedStatic<LLVMContext> GlobalContext;
 
 LLVMContext& llvm::getGlobalContext() {
@@ -144,6 +153,10 @@ void *LLVMContext::getDiagnosticContext() const {
   return pImpl->DiagnosticContext;
 }
 
+bool LLVMContext::diagnosticFiltersRespected() const {
+  return !pImpl->DiagnosticHandler || pImpl->RespectDiagnosticFilters;
+}
+
 void LLVMContext::setYieldCallback(YieldCallbackTy Callback, void *OpaqueHandle)
 {
   pImpl->YieldCallback = Callback;
@@ -155,6 +168,22 @@ void LLVMContext::yield() {
     pImpl->YieldCallback(this, pImpl->YieldOpaqueHandle);
 }
 
+void LLVMContext::setCompileDeadline(CompileDeadline *Deadline) {
+  pImpl->Deadline = Deadline;
+}
+
+CompileDeadline *LLVMContext::getCompileDeadline() const {
+  return pImpl->Deadline;
+}
+
+void LLVMContext::enableConcurrentConstants(bool Enable) {
+  pImpl->ConcurrentConstantsEnabled = Enable;
+}
+
+bool LLVMContext::concurrentConstantsEnabled() const {
+  return pImpl->ConcurrentConstantsEnabled;
+}
+
 void LLVMContext::emitError(const Twine &ErrorStr) {
   diagnose(DiagnosticInfoInlineAsm(ErrorStr));
 }
@@ -188,7 +217,64 @@ static bool isDiagnosticEnabled(const DiagnosticInfo &DI) {
   return true;
 }
 
+/// Lazily open the binary remark stream named by -remark-stream-file.
+/// Returns null if the flag is unset or the file could not be opened.
+static RemarkStreamWriter *getRemarkStreamWriter() {
+  if (RemarkStreamFile.empty())
+    return nullptr;
+
+  static std::unique_ptr<raw_fd_ostream> StreamOS;
+  static std::unique_ptr<RemarkStreamWriter> Writer;
+  static bool Initialized = false;
+  if (!Initialized) {
+    Initialized = true;
+    std::error_code EC;
+    StreamOS.reset(new raw_fd_ostream(RemarkStreamFile, EC, sys::fs::F_None));
+    if (EC) {
+      errs() << "warning: could not open remark stream file '"
+             << RemarkStreamFile << "': " << EC.message() << "\n";
+      StreamOS.reset();
+    } else {
+      Writer.reset(new RemarkStreamWriter(*StreamOS));
+    }
+  }
+  return Writer.get();
+}
+
+/// If \p DI is an optimization remark and a remark stream is configured,
+/// append it to the stream. This is independent of both the diagnostic
+/// handler and the -pass-remarks filters: the stream exists to capture
+/// every remark for offline analysis, not just the ones a user asked to
+/// see on the console.
+static void streamOptimizationRemark(const DiagnosticInfo &DI) {
+  switch (DI.getKind()) {
+  case DK_OptimizationRemark:
+  case DK_OptimizationRemarkMissed:
+  case DK_OptimizationRemarkAnalysis:
+    break;
+  default:
+    return;
+  }
+  RemarkStreamWriter *Writer = getRemarkStreamWriter();
+  if (!Writer)
+    return;
+
+  // The cast below can't use cast<> because DiagnosticInfoOptimizationBase's
+  // classof only matches one of the three kinds.
+  const DiagnosticInfoOptimizationBase &Remark =
+      static_cast<const DiagnosticInfoOptimizationBase &>(DI);
+  StringRef Filename;
+  unsigned Line = 0, Column = 0;
+  if (Remark.isLocationAvailable())
+    Remark.getLocation(&Filename, &Line, &Column);
+  std::string Msg = Remark.getMsg().str();
+  Writer->emitRemark(Remark.getPassName(), Remark.getFunction().getName(),
+                     Filename, Line, Column, Msg);
+}
+
 void LLVMContext::diagnose(const DiagnosticInfo &DI) {
+  streamOptimizationRemark(DI);
+
   // If there is a report handler, use it.
   if (pImpl->DiagnosticHandler) {
     if (!pImpl->RespectDiagnosticFilters || isDiagnosticEnabled(DI))
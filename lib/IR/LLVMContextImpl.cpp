@@ -43,7 +43,11 @@ LLVMContextImpl::LLVMContextImpl(LLVMContext &C)
   RespectDiagnosticFilters = false;
   YieldCallback = nullptr;
   YieldOpaqueHandle = nullptr;
+  Deadline = nullptr;
+  ConcurrentConstantsEnabled = false;
   NamedStructTypesUniqueID = 0;
+  std::fill(std::begin(AttrsListMRU), std::end(AttrsListMRU), nullptr);
+  std::fill(std::begin(AttrsNodeMRU), std::end(AttrsNodeMRU), nullptr);
 }
 
 namespace {
@@ -113,8 +117,10 @@ LLVMContextImpl::~LLVMContextImpl() {
   DeleteContainerSeconds(CPNConstants);
   DeleteContainerSeconds(UVConstants);
   InlineAsms.freeConstants();
-  DeleteContainerSeconds(IntConstants);
-  DeleteContainerSeconds(FPConstants);
+  for (unsigned I = 0; I != NumConstantShards; ++I) {
+    DeleteContainerSeconds(IntConstants[I]);
+    DeleteContainerSeconds(FPConstants[I]);
+  }
   
   for (StringMap<ConstantDataSequential*>::iterator I = CDSConstants.begin(),
        E = CDSConstants.end(); I != E; ++I)
@@ -32,10 +32,12 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/Mutex.h"
 #include <vector>
 
 namespace llvm {
 
+class CompileDeadline;
 class ConstantInt;
 class ConstantFP;
 class DiagnosticInfoOptimizationRemark;
@@ -851,6 +853,41 @@ template <class NodeTy> struct MDNodeInfo {
 #define HANDLE_MDNODE_LEAF(CLASS) typedef MDNodeInfo<CLASS> CLASS##Info;
 #include "llvm/IR/Metadata.def"
 
+/// \brief Pool allocator for \a MDLocation nodes.
+///
+/// Debug locations are by far the most numerous metadata nodes in a -g
+/// compile, and they come in exactly two sizes: with and without an
+/// inlined-at operand.  Carving them out of a per-context bump allocator
+/// with a free list per size keeps them densely packed for the line table
+/// emitters and makes uniquing-collision deletion cheap.  All memory is
+/// released when the context is destroyed.
+class MDLocationPool {
+  BumpPtrAllocator Allocator;
+
+  /// Heads of the free lists for one- and two-operand nodes.  A freed block
+  /// stores the next pointer in its first word.
+  void *FreeLists[2];
+
+public:
+  MDLocationPool() { FreeLists[0] = FreeLists[1] = nullptr; }
+
+  void *allocate(size_t Size, unsigned NumOps) {
+    assert((NumOps == 1 || NumOps == 2) && "Expected a scope and optional inlined-at");
+    void *&Head = FreeLists[NumOps - 1];
+    if (void *Ptr = Head) {
+      Head = *static_cast<void **>(Ptr);
+      return Ptr;
+    }
+    return Allocator.Allocate(Size, AlignOf<MDLocation>::Alignment);
+  }
+
+  void deallocate(void *Ptr, unsigned NumOps) {
+    assert((NumOps == 1 || NumOps == 2) && "Expected a scope and optional inlined-at");
+    *static_cast<void **>(Ptr) = FreeLists[NumOps - 1];
+    FreeLists[NumOps - 1] = Ptr;
+  }
+};
+
 class LLVMContextImpl {
 public:
   /// OwnedModules - The set of modules instantiated in this context, and which
@@ -867,16 +904,47 @@ public:
   LLVMContext::YieldCallbackTy YieldCallback;
   void *YieldOpaqueHandle;
 
+  /// The client-owned compile deadline installed through
+  /// LLVMContext::setCompileDeadline, or null if none.
+  CompileDeadline *Deadline;
+
+  /// When true, ConstantInt and ConstantFP may be created concurrently from
+  /// multiple threads and the scalar uniquing tables below are sharded by key
+  /// hash with one lock per shard. All other IR construction (including type
+  /// creation) must still be externally synchronized. Set through
+  /// LLVMContext::enableConcurrentConstants().
+  bool ConcurrentConstantsEnabled;
+
+  /// Shard count for the scalar constant uniquing tables; a power of two so
+  /// that shard selection is a mask of the key hash.
+  enum { NumConstantShards = 16 };
+
   typedef DenseMap<APInt, ConstantInt *, DenseMapAPIntKeyInfo> IntMapTy;
-  IntMapTy IntConstants;
+  IntMapTy IntConstants[NumConstantShards];
+  sys::SmartMutex<true> IntConstantLocks[NumConstantShards];
 
   typedef DenseMap<APFloat, ConstantFP *, DenseMapAPFloatKeyInfo> FPMapTy;
-  FPMapTy FPConstants;
+  FPMapTy FPConstants[NumConstantShards];
+  sys::SmartMutex<true> FPConstantLocks[NumConstantShards];
+
+  unsigned getIntConstantShard(const APInt &V) const {
+    return DenseMapAPIntKeyInfo::getHashValue(V) & (NumConstantShards - 1);
+  }
+  unsigned getFPConstantShard(const APFloat &V) const {
+    return DenseMapAPFloatKeyInfo::getHashValue(V) & (NumConstantShards - 1);
+  }
 
   FoldingSet<AttributeImpl> AttrsSet;
   FoldingSet<AttributeSetImpl> AttrsLists;
   FoldingSet<AttributeSetNode> AttrsSetNodes;
 
+  /// The most recently created attribute lists and nodes.  Checked by content
+  /// before the uniquing tables above: frontends commonly stamp the same
+  /// attribute list onto long runs of call sites, and a hit here skips both
+  /// the profiling and the hash lookup.
+  AttributeSetImpl *AttrsListMRU[4];
+  AttributeSetNode *AttrsNodeMRU[4];
+
   StringMap<MDString> MDStringCache;
   DenseMap<Value *, ValueAsMetadata *> ValuesAsMetadata;
   DenseMap<Metadata *, MetadataAsValue *> MetadataAsValues;
@@ -884,6 +952,9 @@ public:
 #define HANDLE_MDNODE_LEAF(CLASS) DenseSet<CLASS *, CLASS##Info> CLASS##s;
 #include "llvm/IR/Metadata.def"
 
+  // Backing storage for MDLocation nodes; see MDLocation::operator new.
+  MDLocationPool LocationPool;
+
   // MDNodes may be uniqued or not uniqued.  When they're not uniqued, they
   // aren't in the MDNodeSet, but they're still shared between objects, so no
   // one object can destroy them.  This set allows us to at least destroy them
@@ -941,11 +1012,25 @@ public:
   DenseMap<std::pair<Type*, unsigned>, PointerType*> ASPointerTypes;
 
 
-  /// ValueHandles - This map keeps track of all of the value handles that are
-  /// watching a Value*.  The Value::HasValueHandle bit is used to know
-  /// whether or not a value has an entry in this map.
+  /// ValueHandles - These maps keep track of all of the value handles that
+  /// are watching a Value*.  The Value::HasValueHandle bit is used to know
+  /// whether or not a value has an entry in a map.  The maps are sharded by
+  /// pointer hash so that a rehash only invalidates, and the subsequent
+  /// fix-up walk only visits, the handle lists of a single shard; RAUW storms
+  /// during inlining add and remove entries at a very high rate.
   typedef DenseMap<Value*, ValueHandleBase*> ValueHandlesTy;
-  ValueHandlesTy ValueHandles;
+  enum { NumValueHandleShards = 16 };
+  ValueHandlesTy ValueHandles[NumValueHandleShards];
+
+  /// getValueHandleShard - Return the value handle map shard holding the
+  /// handle list of V.
+  ValueHandlesTy &getValueHandleShard(Value *V) {
+    uintptr_t Key = reinterpret_cast<uintptr_t>(V);
+    // Values are at least word aligned; mix in some high bits so neighboring
+    // allocations spread over the shards.
+    Key = (Key >> 4) ^ (Key >> 9);
+    return ValueHandles[Key % NumValueHandleShards];
+  }
   
   /// CustomMDKindNames - Map to hold the metadata string to ID mapping.
   StringMap<unsigned> CustomMDKindNames;
@@ -13,6 +13,7 @@
 
 
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/CompileDeadline.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/LegacyPassManagers.h"
@@ -31,6 +32,26 @@
 using namespace llvm;
 using namespace llvm::legacy;
 
+// The pass whose run method is currently executing on this thread, for
+// instrumentation that wants to attribute work to its requester.
+// Thread-local because pass managers may run concurrently on different
+// contexts.
+static LLVM_THREAD_LOCAL const Pass *ExecutingPass = nullptr;
+
+const Pass *llvm::getExecutingPass() { return ExecutingPass; }
+
+namespace {
+/// Set ExecutingPass for the duration of one pass run, restoring the
+/// previous value so that on-the-fly pass managers nest correctly.
+struct ExecutingPassScope {
+  const Pass *Prev;
+  explicit ExecutingPassScope(const Pass *P) : Prev(ExecutingPass) {
+    ExecutingPass = P;
+  }
+  ~ExecutingPassScope() { ExecutingPass = Prev; }
+};
+} // End anonymous namespace
+
 // See PassManagers.h for Pass Manager infrastructure overview.
 
 //===----------------------------------------------------------------------===//
@@ -1313,6 +1334,7 @@ bool BBPassManager::runOnFunction(Function &F) {
         // If the pass crashes, remember this.
         PassManagerPrettyStackEntry X(BP, *I);
         TimeRegion PassTimer(getPassTimer(BP));
+        ExecutingPassScope Scope(BP);
 
         LocalChanged |= BP->runOnBasicBlock(*I);
       }
@@ -1522,10 +1544,17 @@ bool FPPassManager::runOnFunction(Function &F) {
   // Collect inherited analysis from Module level pass manager.
   populateInheritedAnalysis(TPM->activeStack);
 
+  CompileDeadline *Deadline = F.getContext().getCompileDeadline();
+
   for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index) {
     FunctionPass *FP = getContainedPass(Index);
     bool LocalChanged = false;
 
+    // Skipping a pass before it touches anything leaves all recorded
+    // analyses intact, so no bookkeeping is needed beyond the check.
+    if (Deadline && Deadline->shouldSkipPass(FP))
+      continue;
+
     dumpPassInfo(FP, EXECUTION_MSG, ON_FUNCTION_MSG, F.getName());
     dumpRequiredSet(FP);
 
@@ -1534,6 +1563,7 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      ExecutingPassScope Scope(FP);
 
       LocalChanged |= FP->runOnFunction(F);
     }
@@ -1600,10 +1630,15 @@ MPPassManager::runOnModule(Module &M) {
   for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index)
     Changed |= getContainedPass(Index)->doInitialization(M);
 
+  CompileDeadline *Deadline = M.getContext().getCompileDeadline();
+
   for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index) {
     ModulePass *MP = getContainedPass(Index);
     bool LocalChanged = false;
 
+    if (Deadline && Deadline->shouldSkipPass(MP))
+      continue;
+
     dumpPassInfo(MP, EXECUTION_MSG, ON_MODULE_MSG, M.getModuleIdentifier());
     dumpRequiredSet(MP);
 
@@ -1612,6 +1647,7 @@ MPPassManager::runOnModule(Module &M) {
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      ExecutingPassScope Scope(MP);
 
       LocalChanged |= MP->runOnModule(M);
     }
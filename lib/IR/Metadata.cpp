@@ -17,6 +17,7 @@
 #include "SymbolTableListTraitsImpl.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringMap.h"
@@ -764,14 +765,18 @@ MDNode *MDNode::concatenate(MDNode *A, MDNode *B) {
   if (!B)
     return A;
 
-  SmallVector<Metadata *, 4> MDs;
-  MDs.reserve(A->getNumOperands() + B->getNumOperands());
-  MDs.append(A->op_begin(), A->op_end());
-  MDs.append(B->op_begin(), B->op_end());
+  // Keep each operand only once, in order of first appearance, so that
+  // concatenating lists with common elements (as inlining does repeatedly
+  // with alias scope lists) cannot grow them without bound. Pointer order
+  // would not be a deterministic canonical form, so no attempt is made to
+  // unique lists that hold the same operands in a different order.
+  SmallSetVector<Metadata *, 4> MDs(A->op_begin(), A->op_end());
+  MDs.insert(B->op_begin(), B->op_end());
 
   // FIXME: This preserves long-standing behaviour, but is it really the right
   // behaviour?  Or was that an unintended side-effect of node uniquing?
-  return getOrSelfReference(A->getContext(), MDs);
+  return getOrSelfReference(A->getContext(),
+                            makeArrayRef(MDs.begin(), MDs.end()));
 }
 
 MDNode *MDNode::intersect(MDNode *A, MDNode *B) {
@@ -1033,6 +1038,10 @@ void Instruction::setMetadata(unsigned KindID, MDNode *Node) {
   if (!Node && !hasMetadata())
     return;
 
+  // Metadata such as !range and !nonnull feeds value tracking, so treat this
+  // as an IR mutation for caching purposes.
+  ++ValueMutationEpoch;
+
   // Handle 'dbg' as a special case since it is not stored in the hash table.
   if (KindID == LLVMContext::MD_dbg) {
     DbgLoc = DebugLoc::getFromDILocation(Node);
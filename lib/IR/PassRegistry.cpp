@@ -36,18 +36,24 @@ PassRegistry *PassRegistry::getPassRegistry() {
 // Accessors
 //
 
-PassRegistry::~PassRegistry() {}
+PassRegistry::~PassRegistry() {
+  delete Tables.load(std::memory_order_relaxed);
+}
 
 const PassInfo *PassRegistry::getPassInfo(const void *TI) const {
-  sys::SmartScopedReader<true> Guard(Lock);
-  MapType::const_iterator I = PassInfoMap.find(TI);
-  return I != PassInfoMap.end() ? I->second : nullptr;
+  const LookupTables *T = Tables.load(std::memory_order_acquire);
+  if (!T)
+    return nullptr;
+  MapType::const_iterator I = T->PassInfoMap.find(TI);
+  return I != T->PassInfoMap.end() ? I->second : nullptr;
 }
 
 const PassInfo *PassRegistry::getPassInfo(StringRef Arg) const {
-  sys::SmartScopedReader<true> Guard(Lock);
-  StringMapType::const_iterator I = PassInfoStringMap.find(Arg);
-  return I != PassInfoStringMap.end() ? I->second : nullptr;
+  const LookupTables *T = Tables.load(std::memory_order_acquire);
+  if (!T)
+    return nullptr;
+  StringMapType::const_iterator I = T->PassInfoStringMap.find(Arg);
+  return I != T->PassInfoStringMap.end() ? I->second : nullptr;
 }
 
 //===----------------------------------------------------------------------===//
@@ -56,11 +62,30 @@ const PassInfo *PassRegistry::getPassInfo(StringRef Arg) const {
 
 void PassRegistry::registerPass(const PassInfo &PI, bool ShouldFree) {
   sys::SmartScopedWriter<true> Guard(Lock);
+
+  // Lookups never take the lock, so build a fresh copy of the tables, add the
+  // new pass to it, and only then publish it.  The superseded snapshot may
+  // still be in use by a concurrent lookup, so retire it rather than deleting
+  // it here.
+  const LookupTables *Old = Tables.load(std::memory_order_relaxed);
+  std::unique_ptr<LookupTables> New(new LookupTables());
+  if (Old) {
+    New->PassInfoMap = Old->PassInfoMap;
+    for (StringMapType::const_iterator I = Old->PassInfoStringMap.begin(),
+                                       E = Old->PassInfoStringMap.end();
+         I != E; ++I)
+      New->PassInfoStringMap[I->getKey()] = I->getValue();
+  }
+
   bool Inserted =
-      PassInfoMap.insert(std::make_pair(PI.getTypeInfo(), &PI)).second;
+      New->PassInfoMap.insert(std::make_pair(PI.getTypeInfo(), &PI)).second;
   assert(Inserted && "Pass registered multiple times!");
   (void)Inserted;
-  PassInfoStringMap[PI.getPassArgument()] = &PI;
+  New->PassInfoStringMap[PI.getPassArgument()] = &PI;
+
+  Tables.store(New.release(), std::memory_order_release);
+  if (Old)
+    RetiredTables.push_back(std::unique_ptr<const LookupTables>(Old));
 
   // Notify any listeners.
   for (auto *Listener : Listeners)
@@ -71,9 +96,9 @@ void PassRegistry::registerPass(const PassInfo &PI, bool ShouldFree) {
 }
 
 void PassRegistry::enumerateWith(PassRegistrationListener *L) {
-  sys::SmartScopedReader<true> Guard(Lock);
-  for (auto PassInfoPair : PassInfoMap)
-    L->passEnumerate(PassInfoPair.second);
+  if (const LookupTables *T = Tables.load(std::memory_order_acquire))
+    for (auto PassInfoPair : T->PassInfoMap)
+      L->passEnumerate(PassInfoPair.second);
 }
 
 /// Analysis Group Mechanisms.
@@ -0,0 +1,77 @@
+//===-- StructuralHash.cpp - IR Hash for expensive checks -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/StructuralHash.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+
+using namespace llvm;
+
+namespace {
+
+/// Accumulates the hash with a fixed FNV-1a style mix. We deliberately do
+/// not use hash_combine() here: its per-execution seed would make the
+/// digest useless for anything persisted across runs, such as a JIT cache.
+class StructuralHashImpl {
+  uint64_t Hash;
+
+  void add(uint64_t V) {
+    Hash = (Hash ^ V) * 0x100000001b3ULL;
+  }
+
+public:
+  StructuralHashImpl() : Hash(0xcbf29ce484222325ULL) {}
+
+  void update(const Function &F) {
+    add(F.isVarArg());
+    add(F.arg_size());
+
+    if (F.isDeclaration())
+      return;
+
+    // Visit the blocks in the same order FunctionComparator::compare()
+    // walks them: from the entry, following terminator successors. This
+    // makes the hash independent of block layout, so functions that only
+    // differ in block order still land in the same bucket.
+    SmallVector<const BasicBlock *, 8> BBs;
+    SmallPtrSet<const BasicBlock *, 16> VisitedBBs;
+
+    BBs.push_back(&F.getEntryBlock());
+    VisitedBBs.insert(BBs[0]);
+    while (!BBs.empty()) {
+      const BasicBlock *BB = BBs.pop_back_val();
+      add(45798); // Block header marker.
+      for (BasicBlock::const_iterator I = BB->begin(), E = BB->end(); I != E;
+           ++I) {
+        add(I->getOpcode());
+        add(I->getNumOperands());
+        add(I->getType()->getTypeID());
+      }
+
+      const TerminatorInst *Term = BB->getTerminator();
+      for (unsigned i = 0, e = Term->getNumSuccessors(); i != e; ++i) {
+        if (!VisitedBBs.insert(Term->getSuccessor(i)).second)
+          continue;
+        BBs.push_back(Term->getSuccessor(i));
+      }
+    }
+  }
+
+  uint64_t getHash() const { return Hash; }
+};
+
+} // end anonymous namespace
+
+uint64_t llvm::StructuralHash(const Function &F) {
+  StructuralHashImpl H;
+  H.update(F);
+  return H.getHash();
+}
@@ -35,6 +35,10 @@
 #include <algorithm>
 using namespace llvm;
 
+// See the comment in Use.h: bumped on every IR mutation so caches of derived
+// facts can cheaply detect staleness.
+LLVM_THREAD_LOCAL uint64_t llvm::ValueMutationEpoch = 0;
+
 //===----------------------------------------------------------------------===//
 //                                Value Class
 //===----------------------------------------------------------------------===//
@@ -60,6 +64,10 @@ Value::Value(Type *ty, unsigned scid)
 }
 
 Value::~Value() {
+  // Deleting a value invalidates any cache entry keyed on its address: the
+  // allocation may be reused for an unrelated value.
+  ++ValueMutationEpoch;
+
   // Notify all ValueHandles (if present) that this value is going away.
   if (HasValueHandle)
     ValueHandleBase::ValueIsDeleted(this);
@@ -674,9 +682,9 @@ void ValueHandleBase::AddToUseList() {
   LLVMContextImpl *pImpl = V->getContext().pImpl;
 
   if (V->HasValueHandle) {
-    // If this value already has a ValueHandle, then it must be in the
-    // ValueHandles map already.
-    ValueHandleBase *&Entry = pImpl->ValueHandles[V];
+    // If this value already has a ValueHandle, then it must be in its
+    // ValueHandles map shard already.
+    ValueHandleBase *&Entry = pImpl->getValueHandleShard(V)[V];
     assert(Entry && "Value doesn't have any handles?");
     AddToExistingUseList(&Entry);
     return;
@@ -687,7 +695,7 @@ void ValueHandleBase::AddToUseList() {
   // reallocate itself, which would invalidate all of the PrevP pointers that
   // point into the old table.  Handle this by checking for reallocation and
   // updating the stale pointers only if needed.
-  DenseMap<Value*, ValueHandleBase*> &Handles = pImpl->ValueHandles;
+  DenseMap<Value*, ValueHandleBase*> &Handles = pImpl->getValueHandleShard(V);
   const void *OldBucketPtr = Handles.getPointerIntoBucketsArray();
 
   ValueHandleBase *&Entry = Handles[V];
@@ -696,7 +704,7 @@ void ValueHandleBase::AddToUseList() {
   V->HasValueHandle = true;
 
   // If reallocation didn't happen or if this was the first insertion, don't
-  // walk the table.
+  // walk the shard.
   if (Handles.isPointerIntoBucketsArray(OldBucketPtr) ||
       Handles.size() == 1) {
     return;
@@ -728,9 +736,9 @@ void ValueHandleBase::RemoveFromUseList() {
 
   // If the Next pointer was null, then it is possible that this was the last
   // ValueHandle watching VP.  If so, delete its entry from the ValueHandles
-  // map.
+  // map shard.
   LLVMContextImpl *pImpl = V->getContext().pImpl;
-  DenseMap<Value*, ValueHandleBase*> &Handles = pImpl->ValueHandles;
+  DenseMap<Value*, ValueHandleBase*> &Handles = pImpl->getValueHandleShard(V);
   if (Handles.isPointerIntoBucketsArray(PrevPtr)) {
     Handles.erase(V);
     V->HasValueHandle = false;
@@ -744,7 +752,7 @@ void ValueHandleBase::ValueIsDeleted(Value *V) {
   // Get the linked list base, which is guaranteed to exist since the
   // HasValueHandle flag is set.
   LLVMContextImpl *pImpl = V->getContext().pImpl;
-  ValueHandleBase *Entry = pImpl->ValueHandles[V];
+  ValueHandleBase *Entry = pImpl->getValueHandleShard(V)[V];
   assert(Entry && "Value bit set but no entries exist");
 
   // We use a local ValueHandleBase as an iterator so that ValueHandles can add
@@ -785,7 +793,7 @@ void ValueHandleBase::ValueIsDeleted(Value *V) {
 #ifndef NDEBUG      // Only in +Asserts mode...
     dbgs() << "While deleting: " << *V->getType() << " %" << V->getName()
            << "\n";
-    if (pImpl->ValueHandles[V]->getKind() == Assert)
+    if (pImpl->getValueHandleShard(V)[V]->getKind() == Assert)
       llvm_unreachable("An asserting value handle still pointed to this"
                        " value!");
 
@@ -804,7 +812,7 @@ void ValueHandleBase::ValueIsRAUWd(Value *Old, Value *New) {
   // Get the linked list base, which is guaranteed to exist since the
   // HasValueHandle flag is set.
   LLVMContextImpl *pImpl = Old->getContext().pImpl;
-  ValueHandleBase *Entry = pImpl->ValueHandles[Old];
+  ValueHandleBase *Entry = pImpl->getValueHandleShard(Old)[Old];
 
   assert(Entry && "Value bit set but no entries exist");
 
@@ -843,7 +851,7 @@ void ValueHandleBase::ValueIsRAUWd(Value *Old, Value *New) {
   // If any new tracking or weak value handles were added while processing the
   // list, then complain about it now.
   if (Old->HasValueHandle)
-    for (Entry = pImpl->ValueHandles[Old]; Entry; Entry = Entry->Next)
+    for (Entry = pImpl->getValueHandleShard(Old)[Old]; Entry; Entry = Entry->Next)
       switch (Entry->getKind()) {
       case Tracking:
       case Weak:
@@ -113,3 +113,12 @@ void ValueSymbolTable::dump() const {
     //DEBUG(dbgs() << "\n");
   }
 }
+
+ValueSymbolTableSnapshot::ValueSymbolTableSnapshot(const ValueSymbolTable &VST) {
+  // One pass over the live table; after this the snapshot never changes, so
+  // readers need no synchronization beyond seeing the fully constructed
+  // object.
+  for (ValueSymbolTable::const_iterator I = VST.begin(), E = VST.end(); I != E;
+       ++I)
+    Map[I->getKey()] = I->getValue();
+}
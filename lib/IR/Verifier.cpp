@@ -73,6 +73,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdarg>
@@ -3083,6 +3084,97 @@ bool llvm::verifyModule(const Module &M, raw_ostream *OS) {
   return !V.verify(M) || !DIV.verify(M) || Broken;
 }
 
+bool llvm::verifyModuleParallel(const Module &M, raw_ostream *OS) {
+  // Snapshot the function bodies so each worker gets a stable index.
+  std::vector<const Function *> Bodies;
+  for (Module::const_iterator I = M.begin(), E = M.end(); I != E; ++I)
+    if (!I->isDeclaration() && !I->isMaterializable())
+      Bodies.push_back(&*I);
+
+  // Each worker verifies one body with its own Verifier and writes into its
+  // own buffer; the buffers are emitted in module order below, so the output
+  // is deterministic and matches the serial mode. Use char rather than bool
+  // for the result array: vector<bool> packs bits and adjacent writes from
+  // different threads would race.
+  std::vector<std::string> Messages(Bodies.size());
+  std::vector<char> BodyBroken(Bodies.size(), 0);
+  ThreadPool Pool;
+  for (size_t i = 0, e = Bodies.size(); i != e; ++i)
+    Pool.async([&Bodies, &Messages, &BodyBroken, i] {
+      raw_string_ostream BufOS(Messages[i]);
+      Verifier V(BufOS);
+      BodyBroken[i] = !V.verify(*Bodies[i]);
+      BufOS.flush();
+    });
+
+  // The module-level rules run here on the calling thread while the workers
+  // chew through the bodies.
+  std::string ModuleMessage;
+  raw_string_ostream ModuleOS(ModuleMessage);
+  Verifier V(ModuleOS);
+  bool Broken = !V.verify(M);
+  DebugInfoVerifier DIV(ModuleOS);
+  Broken |= !DIV.verify(M);
+  ModuleOS.flush();
+
+  Pool.wait();
+
+  for (size_t i = 0, e = Bodies.size(); i != e; ++i) {
+    Broken |= BodyBroken[i] != 0;
+    if (OS)
+      *OS << Messages[i];
+  }
+  if (OS)
+    *OS << ModuleMessage;
+
+  // Note that this function's return value is inverted from what you would
+  // expect of a function called "verify".
+  return Broken;
+}
+
+bool llvm::verifyModuleIncremental(const Module &M,
+                                   ArrayRef<const GlobalValue *> Dirty,
+                                   raw_ostream *OS) {
+  raw_null_ostream NullStr;
+  Verifier V(OS ? *OS : NullStr);
+
+  // Collect the functions whose checks may be invalidated: the dirty
+  // functions themselves plus every function with a use of a dirty value,
+  // looking through constant expression users.
+  SmallPtrSet<const Function *, 16> ToVerify;
+  SmallPtrSet<const User *, 32> Visited;
+  SmallVector<const User *, 32> Worklist;
+  for (const GlobalValue *GV : Dirty) {
+    if (const Function *F = dyn_cast<Function>(GV))
+      if (!F->isDeclaration() && !F->isMaterializable())
+        ToVerify.insert(F);
+    for (const User *U : GV->users())
+      if (Visited.insert(U).second)
+        Worklist.push_back(U);
+  }
+  while (!Worklist.empty()) {
+    const User *U = Worklist.pop_back_val();
+    if (const Instruction *I = dyn_cast<Instruction>(U)) {
+      const Function *F = I->getParent()->getParent();
+      if (!F->isDeclaration() && !F->isMaterializable())
+        ToVerify.insert(F);
+    } else if (isa<Constant>(U)) {
+      for (const User *CU : U->users())
+        if (Visited.insert(CU).second)
+          Worklist.push_back(CU);
+    }
+  }
+
+  bool Broken = false;
+  for (const Function *F : ToVerify)
+    Broken |= !V.verify(*F);
+
+  // The module-level rules (globals, aliases, named metadata) are cheap
+  // relative to function bodies; always re-check them since Dirty may name
+  // global variables or aliases.
+  return !V.verify(M) || Broken;
+}
+
 namespace {
 struct VerifierLegacyPass : public FunctionPass {
   static char ID;
@@ -29,9 +29,9 @@ namespace llvm {
 static const char *const TimeIRParsingGroupName = "LLVM IR Parsing";
 static const char *const TimeIRParsingName = "Parse IR";
 
-static std::unique_ptr<Module>
-getLazyIRModule(std::unique_ptr<MemoryBuffer> Buffer, SMDiagnostic &Err,
-                LLVMContext &Context) {
+std::unique_ptr<Module>
+llvm::getLazyIRModule(std::unique_ptr<MemoryBuffer> Buffer, SMDiagnostic &Err,
+                      LLVMContext &Context) {
   if (isBitcode((const unsigned char *)Buffer->getBufferStart(),
                 (const unsigned char *)Buffer->getBufferEnd())) {
     ErrorOr<Module *> ModuleOrErr =
@@ -50,6 +50,24 @@ getLazyIRModule(std::unique_ptr<MemoryBuffer> Buffer, SMDiagnostic &Err,
 std::unique_ptr<Module> llvm::getLazyIRFileModule(StringRef Filename,
                                                   SMDiagnostic &Err,
                                                   LLVMContext &Context) {
+  // Open the file without requiring a null terminator: bitcode does not need
+  // one, and dropping the requirement lets MemoryBuffer mmap large files so
+  // that lazy materialization only faults in the pages of function bodies
+  // that are actually read. The LL parser does need a terminator, so reopen
+  // the file in that (cold) case. stdin can never be mapped anyway.
+  if (Filename != "-") {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
+        MemoryBuffer::getFile(Filename, -1, /*RequiresNullTerminator=*/false);
+    if (std::error_code EC = FileOrErr.getError()) {
+      Err = SMDiagnostic(Filename, SourceMgr::DK_Error,
+                         "Could not open input file: " + EC.message());
+      return nullptr;
+    }
+    if (isBitcode((const unsigned char *)FileOrErr.get()->getBufferStart(),
+                  (const unsigned char *)FileOrErr.get()->getBufferEnd()))
+      return getLazyIRModule(std::move(FileOrErr.get()), Err, Context);
+  }
+
   ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
       MemoryBuffer::getFileOrSTDIN(Filename);
   if (std::error_code EC = FileOrErr.getError()) {
@@ -13,11 +13,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/LTO/LTOCodeGenerator.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/CodeGen/RuntimeLibcalls.h"
 #include "llvm/Config/config.h"
 #include "llvm/IR/Constants.h"
@@ -83,6 +85,8 @@ void LTOCodeGenerator::initialize() {
   DiagHandler = nullptr;
   DiagContext = nullptr;
   OwnedModule = nullptr;
+  PreMergeDeadStrip = false;
+  RelocModel = Reloc::Default;
 
   initializeLTOPasses();
 }
@@ -143,7 +147,13 @@ bool LTOCodeGenerator::addModule(LTOModule *mod) {
   assert(&mod->getModule().getContext() == &Context &&
          "Expected module in same context");
 
-  bool ret = IRLinker.linkInModule(&mod->getModule());
+  bool ret = false;
+  if (PreMergeDeadStrip)
+    // Defer the link until liveness can be resolved across all modules; the
+    // caller keeps the module alive (see setPreMergeDeadStrip).
+    PendingModules.push_back(mod);
+  else
+    ret = IRLinker.linkInModule(&mod->getModule());
 
   const std::vector<const char*> &undefs = mod->getAsmUndefinedRefs();
   for (int i = 0, e = undefs.size(); i != e; ++i)
@@ -202,6 +212,10 @@ bool LTOCodeGenerator::writeMergedModules(const char *path,
   if (!determineTarget(errMsg))
     return false;
 
+  // Link in any modules deferred by pre-merge dead stripping.
+  if (!mergePendingModules(errMsg))
+    return false;
+
   // mark which symbols can not be internalized
   applyScopeRestrictions();
 
@@ -321,6 +335,10 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
     return true;
 
   std::string TripleStr = IRLinker.getModule()->getTargetTriple();
+  // With pre-merge dead stripping the destination module is still empty at
+  // this point; take the triple from the first deferred module instead.
+  if (TripleStr.empty() && !PendingModules.empty())
+    TripleStr = PendingModules.front()->getModule().getTargetTriple();
   if (TripleStr.empty())
     TripleStr = sys::getDefaultTargetTriple();
   llvm::Triple Triple(TripleStr);
@@ -332,7 +350,6 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
 
   // The relocation model is actually a static member of TargetMachine and
   // needs to be set before the TargetMachine is instantiated.
-  Reloc::Model RelocModel = Reloc::Default;
   switch (CodeModel) {
   case LTO_CODEGEN_PIC_MODEL_STATIC:
     RelocModel = Reloc::Static;
@@ -352,7 +369,7 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
   // the default set of features.
   SubtargetFeatures Features(MAttr);
   Features.getDefaultSubtargetFeatures(Triple);
-  std::string FeatureStr = Features.getString();
+  FeatureStr = Features.getString();
   // Set a default CPU for Darwin triples.
   if (MCpu.empty() && Triple.isOSDarwin()) {
     if (Triple.getArch() == llvm::Triple::x86_64)
@@ -511,6 +528,190 @@ void LTOCodeGenerator::applyScopeRestrictions() {
   ScopeRestrictionsDone = true;
 }
 
+// Append the GlobalValues referenced by C, looking through constant
+// expressions, to Refs.
+static void collectReferencedGlobals(Constant *C,
+                                     SmallVectorImpl<GlobalValue *> &Refs) {
+  if (GlobalValue *GV = dyn_cast<GlobalValue>(C)) {
+    Refs.push_back(GV);
+    return;
+  }
+  for (unsigned I = 0, E = C->getNumOperands(); I != E; ++I)
+    if (Constant *OpC = dyn_cast<Constant>(C->getOperand(I)))
+      collectReferencedGlobals(OpC, Refs);
+}
+
+// Link the modules deferred by pre-merge dead stripping (see
+// setPreMergeDeadStrip) into the destination module, first resolving symbol
+// liveness across all of them and discarding definitions nothing live
+// references. This removes the same definitions the internalize/-globaldce
+// combination would remove from the merged module, but before paying to
+// merge them.
+bool LTOCodeGenerator::mergePendingModules(std::string &errMsg) {
+  if (PendingModules.empty())
+    return true;
+  assert(TargetMach && "target must be determined before merging");
+
+  SmallVector<GlobalValue *, 128> Worklist;
+  SmallPtrSet<GlobalValue *, 32> LiveGVs;
+  StringSet LiveNames;
+
+  auto MarkLive = [&](GlobalValue *GV) {
+    if (LiveGVs.insert(GV).second)
+      Worklist.push_back(GV);
+  };
+  // A live reference to an external name makes every non-local definition of
+  // that name live; the linker picks between multiple copies when merging.
+  auto MarkNameLive = [&](StringRef Name) {
+    if (LiveNames.count(Name))
+      return;
+    LiveNames[Name] = 1;
+    for (LTOModule *M : PendingModules)
+      if (GlobalValue *Def = M->getModule().getNamedValue(Name))
+        if (!Def->isDeclaration() && !Def->hasLocalLinkage())
+          MarkLive(Def);
+  };
+
+  // All members of a comdat group are kept or discarded as a unit, so a live
+  // member makes its whole group live.
+  DenseMap<const Comdat *, SmallVector<GlobalValue *, 2>> ComdatMembers;
+  for (LTOModule *M : PendingModules) {
+    Module &Mod = M->getModule();
+    for (Function &F : Mod)
+      if (F.hasComdat())
+        ComdatMembers[F.getComdat()].push_back(&F);
+    for (GlobalVariable &V : Mod.globals())
+      if (V.hasComdat())
+        ComdatMembers[V.getComdat()].push_back(&V);
+  }
+
+  // Gather the liveness roots: symbols the client must preserve, symbols
+  // referenced from module-level inline assembly, runtime library functions
+  // (as in applyRestriction), and compiler-reserved globals such as
+  // llvm.used and llvm.global_ctors. Aliases are rare and awkward to turn
+  // into declarations, so keep them all.
+  Mangler Mangler(TargetMach->getDataLayout());
+  std::vector<StringRef> Libcalls;
+  TargetLibraryInfoImpl TLII(Triple(TargetMach->getTargetTriple()));
+  TargetLibraryInfo TLI(TLII);
+  for (LTOModule *M : PendingModules)
+    accumulateAndSortLibcalls(Libcalls, TLI, M->getModule(), *TargetMach);
+
+  auto MarkIfRoot = [&](GlobalValue &GV) {
+    if (GV.isDeclaration())
+      return;
+    if (GV.hasAppendingLinkage() || GV.getName().startswith("llvm.")) {
+      MarkLive(&GV);
+      return;
+    }
+    if (GV.hasLocalLinkage())
+      return;
+    SmallString<64> Buffer;
+    TargetMach->getNameWithPrefix(Buffer, &GV, Mangler);
+    if (MustPreserveSymbols.count(Buffer) || AsmUndefinedRefs.count(Buffer) ||
+        (isa<Function>(GV) &&
+         std::binary_search(Libcalls.begin(), Libcalls.end(), GV.getName())))
+      MarkLive(&GV);
+  };
+
+  for (LTOModule *M : PendingModules) {
+    Module &Mod = M->getModule();
+    for (Function &F : Mod)
+      MarkIfRoot(F);
+    for (GlobalVariable &V : Mod.globals())
+      MarkIfRoot(V);
+    for (GlobalAlias &A : Mod.aliases())
+      if (!A.isDeclaration())
+        MarkLive(&A);
+  }
+
+  // If a destination module was installed with setModule, its outstanding
+  // declarations are references into the deferred modules.
+  Module *Merged = IRLinker.getModule();
+  for (Function &F : *Merged)
+    if (F.isDeclaration())
+      MarkNameLive(F.getName());
+  for (GlobalVariable &V : Merged->globals())
+    if (V.isDeclaration())
+      MarkNameLive(V.getName());
+
+  // Propagate liveness over the symbol reference graph. References to a
+  // definition in the same module are followed directly, which resolves
+  // local symbols; references to declarations resolve by name across all
+  // modules.
+  while (!Worklist.empty()) {
+    GlobalValue *GV = Worklist.pop_back_val();
+    if (GlobalObject *GO = dyn_cast<GlobalObject>(GV))
+      if (const Comdat *C = GO->getComdat())
+        for (GlobalValue *Member : ComdatMembers.find(C)->second)
+          MarkLive(Member);
+    SmallVector<GlobalValue *, 8> Refs;
+    if (Function *F = dyn_cast<Function>(GV)) {
+      for (BasicBlock &BB : *F)
+        for (Instruction &I : BB)
+          for (unsigned Op = 0, E = I.getNumOperands(); Op != E; ++Op)
+            if (Constant *C = dyn_cast<Constant>(I.getOperand(Op)))
+              collectReferencedGlobals(C, Refs);
+      if (F->hasPrefixData())
+        collectReferencedGlobals(F->getPrefixData(), Refs);
+      if (F->hasPrologueData())
+        collectReferencedGlobals(F->getPrologueData(), Refs);
+    } else if (GlobalVariable *V = dyn_cast<GlobalVariable>(GV)) {
+      if (V->hasInitializer())
+        collectReferencedGlobals(V->getInitializer(), Refs);
+    } else if (GlobalAlias *A = dyn_cast<GlobalAlias>(GV)) {
+      collectReferencedGlobals(A->getAliasee(), Refs);
+    }
+    for (GlobalValue *Ref : Refs) {
+      if (!Ref->isDeclaration())
+        MarkLive(Ref);
+      else
+        MarkNameLive(Ref->getName());
+    }
+  }
+
+  // Strip dead definitions and link what is left.
+  for (LTOModule *M : PendingModules) {
+    Module &Mod = M->getModule();
+
+    for (Function &F : Mod) {
+      if (F.isDeclaration() || LiveGVs.count(&F))
+        continue;
+      F.deleteBody();
+      F.setComdat(nullptr);
+    }
+    for (GlobalVariable &V : Mod.globals()) {
+      if (V.isDeclaration() || LiveGVs.count(&V))
+        continue;
+      V.setInitializer(nullptr);
+      V.setLinkage(GlobalValue::ExternalLinkage);
+      V.setComdat(nullptr);
+    }
+
+    // Stripping the dead bodies dropped their references; remove the
+    // declarations nothing uses any more so they are not merged either.
+    for (Module::iterator I = Mod.begin(), E = Mod.end(); I != E;) {
+      Function &F = *I++;
+      if (F.isDeclaration() && F.use_empty())
+        F.eraseFromParent();
+    }
+    for (Module::global_iterator I = Mod.global_begin(), E = Mod.global_end();
+         I != E;) {
+      GlobalVariable &V = *I++;
+      if (V.isDeclaration() && V.use_empty())
+        V.eraseFromParent();
+    }
+
+    if (IRLinker.linkInModule(&Mod)) {
+      errMsg = "error linking deferred module, see diagnostics";
+      return false;
+    }
+  }
+
+  PendingModules.clear();
+  return true;
+}
+
 /// Optimize merged modules using various IPO passes
 bool LTOCodeGenerator::optimize(bool DisableOpt,
                                 bool DisableInline,
@@ -520,6 +721,10 @@ bool LTOCodeGenerator::optimize(bool DisableOpt,
   if (!this->determineTarget(errMsg))
     return false;
 
+  // Link in any modules deferred by pre-merge dead stripping.
+  if (!this->mergePendingModules(errMsg))
+    return false;
+
   Module *mergedModule = IRLinker.getModule();
 
   // Mark which symbols can not be internalized
@@ -556,10 +761,51 @@ bool LTOCodeGenerator::optimize(bool DisableOpt,
   return true;
 }
 
+bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_ostream *> out,
+                                        std::string &errMsg) {
+  if (out.empty())
+    return false;
+
+  if (!this->determineTarget(errMsg))
+    return false;
+
+  // Link in any modules deferred by pre-merge dead stripping.
+  if (!this->mergePendingModules(errMsg))
+    return false;
+
+  Module *mergedModule = IRLinker.getModule();
+
+  // Mark which symbols can not be internalized
+  this->applyScopeRestrictions();
+
+  // Lower what must be lowered on the whole module before it is partitioned.
+  // As in the single stream path, ObjCARCContractPass must be run in case the
+  // bitcode files contain ARC code compiled with optimization.
+  legacy::PassManager preCodeGenPasses;
+  preCodeGenPasses.add(new DataLayoutPass());
+  preCodeGenPasses.add(createObjCARCContractPass());
+  preCodeGenPasses.run(*mergedModule);
+
+  // splitCodeGen externalizes local symbols so that partitions may reference
+  // each other, partitions the module by function and runs the codegen
+  // pipeline on one thread per output stream. Ownership of the merged module
+  // stays with IRLinker (or OwnedModule), so release the temporary handle.
+  std::unique_ptr<Module> M(mergedModule);
+  M = splitCodeGen(std::move(M), out, MCpu, FeatureStr, Options, RelocModel,
+                   CodeModel::Default, CodeGenOpt::Aggressive);
+  M.release();
+
+  return true;
+}
+
 bool LTOCodeGenerator::compileOptimized(raw_ostream &out, std::string &errMsg) {
   if (!this->determineTarget(errMsg))
     return false;
 
+  // Link in any modules deferred by pre-merge dead stripping.
+  if (!this->mergePendingModules(errMsg))
+    return false;
+
   Module *mergedModule = IRLinker.getModule();
 
   // Mark which symbols can not be internalized
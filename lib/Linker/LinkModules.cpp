@@ -873,7 +873,12 @@ void ModuleLinker::computeTypeMapping() {
     // we prefer to take the '%C' version. So we are then left with both
     // '%C.1' and '%C' being used for the same types. This leads to some
     // variables using one type and some using the other.
-    if (TypeMap.DstStructTypesSet.hasType(DST))
+    // Probe the structural signature table first: unequal signatures prove
+    // the types cannot be isomorphic, which skips the speculative recursive
+    // check (and its rollback) for the common case of a name collision
+    // between unrelated types.
+    if (TypeMap.DstStructTypesSet.hasType(DST) &&
+        TypeMap.DstStructTypesSet.mayBeIsomorphic(DST, ST))
       TypeMap.addTypeMapping(DST, ST);
   }
 
@@ -1708,6 +1713,73 @@ bool Linker::IdentifiedStructTypeSet::hasType(StructType *Ty) {
   return *I == Ty;
 }
 
+/// Compute a name-insensitive hash of \p Ty's shape. Isomorphic types hash
+/// identically: identified structs hash as the DFS number of their first
+/// visit, so back-references depend only on the graph's shape, not on the
+/// struct names involved. \p SawOpaque is set if the walk reached an opaque
+/// type, in which case the shape is not final and the hash is unusable.
+static hash_code hashStructuralType(Type *Ty,
+                                    DenseMap<StructType *, unsigned> &Visited,
+                                    bool &SawOpaque) {
+  if (StructType *STy = dyn_cast<StructType>(Ty)) {
+    if (!STy->isLiteral()) {
+      auto Ins = Visited.insert(std::make_pair(STy, Visited.size()));
+      if (!Ins.second)
+        return hash_combine(~0u, Ins.first->second);
+      if (STy->isOpaque()) {
+        SawOpaque = true;
+        return hash_combine(Ty->getTypeID());
+      }
+    }
+    hash_code Hash =
+        hash_combine(Ty->getTypeID(), STy->isPacked(), STy->getNumElements());
+    for (Type *ETy : STy->elements())
+      Hash = hash_combine(Hash, hashStructuralType(ETy, Visited, SawOpaque));
+    return Hash;
+  }
+
+  hash_code Hash = hash_combine(Ty->getTypeID(), Ty->getNumContainedTypes());
+  if (IntegerType *ITy = dyn_cast<IntegerType>(Ty))
+    Hash = hash_combine(Hash, ITy->getBitWidth());
+  else if (PointerType *PTy = dyn_cast<PointerType>(Ty))
+    Hash = hash_combine(Hash, PTy->getAddressSpace());
+  else if (FunctionType *FTy = dyn_cast<FunctionType>(Ty))
+    Hash = hash_combine(Hash, FTy->isVarArg());
+  else if (ArrayType *ATy = dyn_cast<ArrayType>(Ty))
+    Hash = hash_combine(Hash, ATy->getNumElements());
+  else if (VectorType *VTy = dyn_cast<VectorType>(Ty))
+    Hash = hash_combine(Hash, VTy->getNumElements());
+  for (unsigned I = 0, E = Ty->getNumContainedTypes(); I != E; ++I)
+    Hash = hash_combine(
+        Hash, hashStructuralType(Ty->getContainedType(I), Visited, SawOpaque));
+  return Hash;
+}
+
+bool Linker::IdentifiedStructTypeSet::mayBeIsomorphic(Type *DstTy,
+                                                      Type *SrcTy) {
+  DenseMap<StructType *, unsigned> Visited;
+  bool SrcSawOpaque = false;
+  uint64_t SrcHash = hashStructuralType(SrcTy, Visited, SrcSawOpaque);
+  if (SrcSawOpaque)
+    return true;
+
+  uint64_t DstHash;
+  auto I = StructuralHashes.find(DstTy);
+  if (I != StructuralHashes.end()) {
+    DstHash = I->second;
+  } else {
+    Visited.clear();
+    bool DstSawOpaque = false;
+    DstHash = hashStructuralType(DstTy, Visited, DstSawOpaque);
+    // A shape containing an opaque type is not final; neither cache nor
+    // filter on it.
+    if (DstSawOpaque)
+      return true;
+    StructuralHashes[DstTy] = DstHash;
+  }
+  return SrcHash == DstHash;
+}
+
 void Linker::init(Module *M, DiagnosticHandlerFunction DiagnosticHandler) {
   this->Composite = M;
   this->DiagnosticHandler = DiagnosticHandler;
@@ -33,6 +33,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ELF.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <vector>
 using namespace llvm;
@@ -47,6 +48,7 @@ class FragmentWriter {
 public:
   FragmentWriter(bool IsLittleEndian);
   template <typename T> void write(MCDataFragment &F, T Val);
+  bool isLittleEndian() const { return IsLittleEndian; }
 };
 
 typedef DenseMap<const MCSectionELF *, uint32_t> SectionIndexMapTy;
@@ -368,24 +370,29 @@ void SymbolTableWriter::writeSymbol(uint32_t name, uint8_t info, uint64_t value,
 
   uint16_t Index = LargeIndex ? uint16_t(ELF::SHN_XINDEX) : shndx;
 
-  raw_svector_ostream OS(SymtabF->getContents());
+  // Stage the whole symbol record and append it with a single copy rather
+  // than growing the fragment a field at a time.
+  support::endian::RecordBuffer<sizeof(ELF::Elf64_Sym)> Rec(
+      FWriter.isLittleEndian());
 
   if (Is64Bit) {
-    write(*SymtabF, name);  // st_name
-    write(*SymtabF, info);  // st_info
-    write(*SymtabF, other); // st_other
-    write(*SymtabF, Index); // st_shndx
-    write(*SymtabF, value); // st_value
-    write(*SymtabF, size);  // st_size
+    Rec.write(name);  // st_name
+    Rec.write(info);  // st_info
+    Rec.write(other); // st_other
+    Rec.write(Index); // st_shndx
+    Rec.write(value); // st_value
+    Rec.write(size);  // st_size
   } else {
-    write(*SymtabF, name);            // st_name
-    write(*SymtabF, uint32_t(value)); // st_value
-    write(*SymtabF, uint32_t(size));  // st_size
-    write(*SymtabF, info);            // st_info
-    write(*SymtabF, other);           // st_other
-    write(*SymtabF, Index);           // st_shndx
+    Rec.write(name);            // st_name
+    Rec.write(uint32_t(value)); // st_value
+    Rec.write(uint32_t(size));  // st_size
+    Rec.write(info);            // st_info
+    Rec.write(other);           // st_other
+    Rec.write(Index);           // st_shndx
   }
 
+  SymtabF->getContents().append(Rec.begin(), Rec.end());
+
   ++NumWritten;
 }
 
@@ -1155,31 +1162,6 @@ ELFObjectWriter::createRelocationSection(MCAssembler &Asm,
   return &Asm.getOrCreateSectionData(*RelaSection);
 }
 
-static SmallVector<char, 128>
-getUncompressedData(MCAsmLayout &Layout,
-                    MCSectionData::FragmentListType &Fragments) {
-  SmallVector<char, 128> UncompressedData;
-  for (const MCFragment &F : Fragments) {
-    const SmallVectorImpl<char> *Contents;
-    switch (F.getKind()) {
-    case MCFragment::FT_Data:
-      Contents = &cast<MCDataFragment>(F).getContents();
-      break;
-    case MCFragment::FT_Dwarf:
-      Contents = &cast<MCDwarfLineAddrFragment>(F).getContents();
-      break;
-    case MCFragment::FT_DwarfFrame:
-      Contents = &cast<MCDwarfCallFrameFragment>(F).getContents();
-      break;
-    default:
-      llvm_unreachable(
-          "Not expecting any other fragment types in a debug_* section");
-    }
-    UncompressedData.append(Contents->begin(), Contents->end());
-  }
-  return UncompressedData;
-}
-
 // Include the debug info compression header:
 // "ZLIB" followed by 8 bytes representing the uncompressed size of the section,
 // useful for consumers to preallocate a buffer to decompress into.
@@ -1207,20 +1189,38 @@ getCompressedFragment(MCAsmLayout &Layout,
                       MCSectionData::FragmentListType &Fragments) {
   std::unique_ptr<MCDataFragment> CompressedFragment(new MCDataFragment());
 
-  // Gather the uncompressed data from all the fragments, recording the
-  // alignment fragment, if seen, and any fixups.
-  SmallVector<char, 128> UncompressedData =
-      getUncompressedData(Layout, Fragments);
-
   SmallVectorImpl<char> &CompressedContents = CompressedFragment->getContents();
 
-  zlib::Status Success = zlib::compress(
-      StringRef(UncompressedData.data(), UncompressedData.size()),
-      CompressedContents);
-  if (Success != zlib::StatusOK)
+  // Stream the fragment contents through the compressor one fragment at a
+  // time rather than concatenating the whole section first; debug sections
+  // dominate object size and the extra copy is measurable.
+  zlib::StreamCompressor Compressor(CompressedContents);
+  uint64_t UncompressedSize = 0;
+  for (const MCFragment &F : Fragments) {
+    const SmallVectorImpl<char> *Contents;
+    switch (F.getKind()) {
+    case MCFragment::FT_Data:
+      Contents = &cast<MCDataFragment>(F).getContents();
+      break;
+    case MCFragment::FT_Dwarf:
+      Contents = &cast<MCDwarfLineAddrFragment>(F).getContents();
+      break;
+    case MCFragment::FT_DwarfFrame:
+      Contents = &cast<MCDwarfCallFrameFragment>(F).getContents();
+      break;
+    default:
+      llvm_unreachable(
+          "Not expecting any other fragment types in a debug_* section");
+    }
+    if (Compressor.update(StringRef(Contents->data(), Contents->size())) !=
+        zlib::StatusOK)
+      return nullptr;
+    UncompressedSize += Contents->size();
+  }
+  if (Compressor.finish() != zlib::StatusOK)
     return nullptr;
 
-  if (!prependCompressionHeader(UncompressedData.size(), CompressedContents))
+  if (!prependCompressionHeader(UncompressedSize, CompressedContents))
     return nullptr;
 
   return CompressedFragment;
@@ -1368,32 +1368,38 @@ void ELFObjectWriter::WriteRelocationsFragment(const MCAssembler &Asm,
     unsigned Index =
         Entry.Symbol ? getSymbolIndexInSymbolTable(Asm, Entry.Symbol) : 0;
 
+    // Stage each relocation record and append it with a single copy.
+    support::endian::RecordBuffer<sizeof(ELF::Elf64_Rela)> Rec(
+        isLittleEndian());
+
     if (is64Bit()) {
-      write(*F, Entry.Offset);
+      Rec.write(Entry.Offset);
       if (TargetObjectWriter->isN64()) {
-        write(*F, uint32_t(Index));
+        Rec.write(uint32_t(Index));
 
-        write(*F, TargetObjectWriter->getRSsym(Entry.Type));
-        write(*F, TargetObjectWriter->getRType3(Entry.Type));
-        write(*F, TargetObjectWriter->getRType2(Entry.Type));
-        write(*F, TargetObjectWriter->getRType(Entry.Type));
+        Rec.write(TargetObjectWriter->getRSsym(Entry.Type));
+        Rec.write(TargetObjectWriter->getRType3(Entry.Type));
+        Rec.write(TargetObjectWriter->getRType2(Entry.Type));
+        Rec.write(TargetObjectWriter->getRType(Entry.Type));
       } else {
         struct ELF::Elf64_Rela ERE64;
         ERE64.setSymbolAndType(Index, Entry.Type);
-        write(*F, ERE64.r_info);
+        Rec.write(ERE64.r_info);
       }
       if (hasRelocationAddend())
-        write(*F, Entry.Addend);
+        Rec.write(Entry.Addend);
     } else {
-      write(*F, uint32_t(Entry.Offset));
+      Rec.write(uint32_t(Entry.Offset));
 
       struct ELF::Elf32_Rela ERE32;
       ERE32.setSymbolAndType(Index, Entry.Type);
-      write(*F, ERE32.r_info);
+      Rec.write(ERE32.r_info);
 
       if (hasRelocationAddend())
-        write(*F, uint32_t(Entry.Addend));
+        Rec.write(uint32_t(Entry.Addend));
     }
+
+    F->getContents().append(Rec.begin(), Rec.end());
   }
 }
 
@@ -1622,7 +1628,7 @@ void ELFObjectWriter::WriteDataSectionData(MCAssembler &Asm,
       WriteBytes(cast<MCDataFragment>(F).getContents());
     }
   } else {
-    Asm.writeSectionData(&SD, Layout);
+    writeSectionContents(Asm, &SD, Layout);
   }
 }
 
@@ -1771,6 +1777,8 @@ void ELFObjectWriter::WriteObject(MCAssembler &Asm,
   // Write out the ELF header ...
   WriteHeader(Asm, SectionHeaderOffset, NumSections + 1);
 
+  renderSections(Asm, Layout);
+
   // ... then the regular sections ...
   // + because of .shstrtab
   for (unsigned i = 0; i < NumRegularSections + 1; ++i)
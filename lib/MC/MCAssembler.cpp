@@ -29,6 +29,7 @@
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cstring>
 #include <tuple>
 using namespace llvm;
 
@@ -675,11 +676,41 @@ static void writeFragmentContents(const MCFragment &F, MCObjectWriter *OW) {
   OW->WriteBytes(EF.getContents());
 }
 
-/// \brief Write the fragment \p F to the output file.
-static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
-                          const MCFragment &F) {
-  MCObjectWriter *OW = &Asm.getWriter();
+/// \brief Write \p Count copies of the \p ValueSize byte value \p Value
+/// through \p OW.  Large padding and fill regions are common in debug-heavy
+/// objects; emitting them a chunk at a time instead of one write call per
+/// copy keeps them from being bound by per-byte call overhead.
+static void writeFillPattern(MCObjectWriter *OW, uint64_t Value,
+                             unsigned ValueSize, uint64_t Count) {
+  assert(ValueSize > 0 && ValueSize <= 8 && "Invalid fill value size!");
+  if (!Count)
+    return;
+
+  // Encode one copy with the writer's endianness, then replicate it to fill
+  // a chunk buffer.
+  char Unit[8];
+  for (unsigned i = 0; i != ValueSize; ++i) {
+    unsigned Shift = OW->isLittleEndian() ? i : ValueSize - i - 1;
+    Unit[i] = char(Value >> (8 * Shift));
+  }
 
+  char Chunk[256];
+  uint64_t ChunkUnits = sizeof(Chunk) / ValueSize;
+  if (ChunkUnits > Count)
+    ChunkUnits = Count;
+  for (uint64_t i = 0; i != ChunkUnits; ++i)
+    memcpy(Chunk + i * ValueSize, Unit, ValueSize);
+
+  while (Count) {
+    uint64_t N = ChunkUnits < Count ? ChunkUnits : Count;
+    OW->WriteBytes(StringRef(Chunk, N * ValueSize));
+    Count -= N;
+  }
+}
+
+/// \brief Write the fragment \p F through \p OW.
+static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
+                          const MCFragment &F, MCObjectWriter *OW) {
   // FIXME: Embed in fragments instead?
   uint64_t FragmentSize = Asm.computeFragmentSize(Layout, F);
 
@@ -748,15 +779,7 @@ static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
     }
 
     // Otherwise, write out in multiples of the value size.
-    for (uint64_t i = 0; i != Count; ++i) {
-      switch (AF.getValueSize()) {
-      default: llvm_unreachable("Invalid size!");
-      case 1: OW->Write8 (uint8_t (AF.getValue())); break;
-      case 2: OW->Write16(uint16_t(AF.getValue())); break;
-      case 4: OW->Write32(uint32_t(AF.getValue())); break;
-      case 8: OW->Write64(uint64_t(AF.getValue())); break;
-      }
-    }
+    writeFillPattern(OW, AF.getValue(), AF.getValueSize(), Count);
     break;
   }
 
@@ -781,15 +804,8 @@ static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
 
     assert(FF.getValueSize() && "Invalid virtual align in concrete fragment!");
 
-    for (uint64_t i = 0, e = FF.getSize() / FF.getValueSize(); i != e; ++i) {
-      switch (FF.getValueSize()) {
-      default: llvm_unreachable("Invalid size!");
-      case 1: OW->Write8 (uint8_t (FF.getValue())); break;
-      case 2: OW->Write16(uint16_t(FF.getValue())); break;
-      case 4: OW->Write32(uint32_t(FF.getValue())); break;
-      case 8: OW->Write64(uint64_t(FF.getValue())); break;
-      }
-    }
+    writeFillPattern(OW, FF.getValue(), FF.getValueSize(),
+                     FF.getSize() / FF.getValueSize());
     break;
   }
 
@@ -803,8 +819,7 @@ static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
     ++stats::EmittedOrgFragments;
     const MCOrgFragment &OF = cast<MCOrgFragment>(F);
 
-    for (uint64_t i = 0, e = FragmentSize; i != e; ++i)
-      OW->Write8(uint8_t(OF.getValue()));
+    writeFillPattern(OW, uint8_t(OF.getValue()), 1, FragmentSize);
 
     break;
   }
@@ -827,6 +842,12 @@ static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
 
 void MCAssembler::writeSectionData(const MCSectionData *SD,
                                    const MCAsmLayout &Layout) const {
+  writeSectionData(SD, Layout, getWriter());
+}
+
+void MCAssembler::writeSectionData(const MCSectionData *SD,
+                                   const MCAsmLayout &Layout,
+                                   MCObjectWriter &OW) const {
   // Ignore virtual sections.
   if (SD->getSection().isVirtualSection()) {
     assert(Layout.getSectionFileSize(SD) == 0 && "Invalid size for section!");
@@ -871,14 +892,14 @@ void MCAssembler::writeSectionData(const MCSectionData *SD,
     return;
   }
 
-  uint64_t Start = getWriter().getStream().tell();
+  uint64_t Start = OW.getStream().tell();
   (void)Start;
 
   for (MCSectionData::const_iterator it = SD->begin(), ie = SD->end();
        it != ie; ++it)
-    writeFragment(*this, Layout, *it);
+    writeFragment(*this, Layout, *it, &OW);
 
-  assert(getWriter().getStream().tell() - Start ==
+  assert(OW.getStream().tell() - Start ==
          Layout.getSectionAddressSize(SD));
 }
 
@@ -1024,16 +1045,18 @@ bool MCAssembler::relaxInstruction(MCAsmLayout &Layout,
   //
   // FIXME-PERF: If it matters, we could let the target do this. It can
   // probably do so more efficiently in many cases.
-  SmallVector<MCFixup, 4> Fixups;
-  SmallString<256> Code;
-  raw_svector_ostream VecOS(Code);
-  getEmitter().EncodeInstruction(Relaxed, VecOS, Fixups, F.getSubtargetInfo());
+  //
+  // Encode straight into the fragment's storage so the code and fixups don't
+  // have to be copied through temporaries.
+  F.getContents().clear();
+  F.getFixups().clear();
+  raw_svector_ostream VecOS(F.getContents());
+  getEmitter().EncodeInstruction(Relaxed, VecOS, F.getFixups(),
+                                 F.getSubtargetInfo());
   VecOS.flush();
 
   // Update the fragment.
-  F.setInst(Relaxed);
-  F.getContents() = Code;
-  F.getFixups() = Fixups;
+  F.setInst(std::move(Relaxed));
 
   return true;
 }
@@ -9,6 +9,7 @@
 
 #include "llvm/MC/MCContext.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCDwarf.h"
@@ -33,7 +34,7 @@ MCContext::MCContext(const MCAsmInfo *mai, const MCRegisterInfo *mri,
                      const MCObjectFileInfo *mofi, const SourceMgr *mgr,
                      bool DoAutoReset)
     : SrcMgr(mgr), MAI(mai), MRI(mri), MOFI(mofi), Allocator(),
-      Symbols(Allocator), UsedNames(Allocator), NextUniqueID(0),
+      UsedNames(UsedNamesAllocator), NextUniqueID(0),
       CurrentDwarfLoc(0, 0, 0, DWARF2_FLAG_IS_STMT, 0, 0), DwarfLocSeen(false),
       GenDwarfForAssembly(false), GenDwarfFileNumber(0), DwarfVersion(4),
       AllowTemporaryLabels(true), DwarfCompileUnitID(0),
@@ -70,7 +71,11 @@ MCContext::~MCContext() {
 
 void MCContext::reset() {
   UsedNames.clear();
-  Symbols.clear();
+  UsedNamesAllocator.Reset();
+  for (unsigned i = 0; i != NumSymbolShards; ++i) {
+    SymbolShards[i].Symbols.clear();
+    SymbolShards[i].Allocator.Reset();
+  }
   Allocator.Reset();
   Instances.clear();
   CompilationDir.clear();
@@ -97,13 +102,19 @@ void MCContext::reset() {
 // Symbol Manipulation
 //===----------------------------------------------------------------------===//
 
+MCContext::SymbolTableShard &MCContext::getSymbolShard(StringRef Name) const {
+  return SymbolShards[HashString(Name) & (NumSymbolShards - 1)];
+}
+
 MCSymbol *MCContext::GetOrCreateSymbol(StringRef Name) {
   assert(!Name.empty() && "Normal symbols cannot be unnamed!");
 
-  MCSymbol *&Sym = Symbols[Name];
+  SymbolTableShard &Shard = getSymbolShard(Name);
+  sys::SmartScopedLock<true> Guard(Shard.Lock);
+  MCSymbol *&Sym = Shard.Symbols[Name];
 
   if (!Sym)
-    Sym = CreateSymbol(Name);
+    Sym = CreateSymbol(Shard, Name);
 
   return Sym;
 }
@@ -115,14 +126,21 @@ MCSymbol *MCContext::getOrCreateSectionSymbol(const MCSectionELF &Section) {
 
   StringRef Name = Section.getSectionName();
 
-  MCSymbol *&OldSym = Symbols[Name];
+  SymbolTableShard &Shard = getSymbolShard(Name);
+  sys::SmartScopedLock<true> Guard(Shard.Lock);
+  MCSymbol *&OldSym = Shard.Symbols[Name];
   if (OldSym && OldSym->isUndefined()) {
     Sym = OldSym;
     return OldSym;
   }
 
-  auto NameIter = UsedNames.insert(std::make_pair(Name, true)).first;
-  Sym = new (*this) MCSymbol(NameIter->getKey(), /*isTemporary*/ false);
+  StringRef NameCopy;
+  {
+    sys::SmartScopedLock<true> UsedNamesGuard(UsedNamesLock);
+    NameCopy = UsedNames.insert(std::make_pair(Name, true)).first->getKey();
+  }
+  Sym = new (Shard.Allocator.Allocate<MCSymbol>())
+      MCSymbol(NameCopy, /*isTemporary*/ false);
 
   if (!OldSym)
     OldSym = Sym;
@@ -136,11 +154,18 @@ MCSymbol *MCContext::getOrCreateFrameAllocSymbol(StringRef FuncName) {
 }
 
 MCSymbol *MCContext::CreateSymbol(StringRef Name) {
+  SymbolTableShard &Shard = getSymbolShard(Name);
+  sys::SmartScopedLock<true> Guard(Shard.Lock);
+  return CreateSymbol(Shard, Name);
+}
+
+MCSymbol *MCContext::CreateSymbol(SymbolTableShard &Shard, StringRef Name) {
   // Determine whether this is an assembler temporary or normal label, if used.
   bool isTemporary = false;
   if (AllowTemporaryLabels)
     isTemporary = Name.startswith(MAI->getPrivateGlobalPrefix());
 
+  sys::SmartScopedLock<true> UsedNamesGuard(UsedNamesLock);
   auto NameEntry = UsedNames.insert(std::make_pair(Name, true));
   if (!NameEntry.second) {
     assert(isTemporary && "Cannot rename non-temporary symbols");
@@ -154,8 +179,8 @@ MCSymbol *MCContext::CreateSymbol(StringRef Name) {
 
   // Ok, the entry doesn't already exist.  Have the MCSymbol object itself refer
   // to the copy of the string that is embedded in the UsedNames entry.
-  MCSymbol *Result =
-      new (*this) MCSymbol(NameEntry.first->getKey(), isTemporary);
+  MCSymbol *Result = new (Shard.Allocator.Allocate<MCSymbol>())
+      MCSymbol(NameEntry.first->getKey(), isTemporary);
 
   return Result;
 }
@@ -215,7 +240,9 @@ MCSymbol *MCContext::GetDirectionalLocalSymbol(unsigned LocalLabelVal,
 }
 
 MCSymbol *MCContext::LookupSymbol(StringRef Name) const {
-  return Symbols.lookup(Name);
+  SymbolTableShard &Shard = getSymbolShard(Name);
+  sys::SmartScopedLock<true> Guard(Shard.Lock);
+  return Shard.Symbols.lookup(Name);
 }
 
 MCSymbol *MCContext::LookupSymbol(const Twine &Name) const {
@@ -224,6 +251,16 @@ MCSymbol *MCContext::LookupSymbol(const Twine &Name) const {
   return LookupSymbol(NameSV.str());
 }
 
+void MCContext::getSymbols(SmallVectorImpl<MCSymbol *> &Syms) const {
+  for (unsigned i = 0; i != NumSymbolShards; ++i) {
+    sys::SmartScopedLock<true> Guard(SymbolShards[i].Lock);
+    for (SymbolTable::const_iterator I = SymbolShards[i].Symbols.begin(),
+                                     E = SymbolShards[i].Symbols.end();
+         I != E; ++I)
+      Syms.push_back(I->getValue());
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Section Management
 //===----------------------------------------------------------------------===//
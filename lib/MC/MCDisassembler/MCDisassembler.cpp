@@ -16,6 +16,24 @@ using namespace llvm;
 MCDisassembler::~MCDisassembler() {
 }
 
+uint64_t MCDisassembler::getInstructions(std::vector<DecodedInst> &Insts,
+                                         ArrayRef<uint8_t> Bytes,
+                                         uint64_t NumBytes, uint64_t Address,
+                                         raw_ostream &VStream) const {
+  uint64_t Index = 0;
+  while (Index < NumBytes && Index < Bytes.size()) {
+    Insts.push_back(DecodedInst());
+    DecodedInst &DI = Insts.back();
+    raw_svector_ostream CStream(DI.Comments);
+    DI.Status = getInstruction(DI.Inst, DI.Size, Bytes.slice(Index),
+                               Address + Index, VStream, CStream);
+    if (DI.Size == 0)
+      DI.Size = 1; // Always make progress, skipping illegible bytes.
+    Index += DI.Size;
+  }
+  return Index;
+}
+
 bool MCDisassembler::tryAddingSymbolicOperand(MCInst &Inst, int64_t Value,
                                               uint64_t Address, bool IsBranch,
                                               uint64_t Offset,
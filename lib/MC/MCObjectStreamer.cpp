@@ -9,6 +9,7 @@
 
 #include "llvm/MC/MCObjectStreamer.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/MC/MCAsmBackend.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCAssembler.h"
@@ -16,9 +17,11 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCDwarf.h"
 #include "llvm/MC/MCExpr.h"
+#include "llvm/MC/MCFixupKindInfo.h"
 #include "llvm/MC/MCObjectWriter.h"
 #include "llvm/MC/MCSection.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/MC/MCValue.h"
 #include "llvm/Support/ErrorHandling.h"
 using namespace llvm;
 
@@ -109,6 +112,25 @@ void MCObjectStreamer::EmitCFISections(bool EH, bool Debug) {
   EmitDebugFrame = Debug;
 }
 
+void MCObjectStreamer::EmitIntValue(uint64_t Value, unsigned Size) {
+  assert(1 <= Size && Size <= 8 && "Invalid size");
+  assert((isUIntN(8 * Size, Value) || isIntN(8 * Size, Value)) &&
+         "Invalid size");
+  MCLineEntry::Make(this, getCurrentSection().first);
+
+  // Encode straight into the current data fragment.  DWARF emission comes
+  // through here a couple of bytes at a time, and the generic path pays for
+  // a temporary StringRef and a virtual EmitBytes call per value.
+  SmallVectorImpl<char> &Contents = getOrCreateDataFragment()->getContents();
+  const bool IsLittleEndian = getContext().getAsmInfo()->isLittleEndian();
+  char Buf[8];
+  for (unsigned i = 0; i != Size; ++i) {
+    unsigned index = IsLittleEndian ? i : (Size - i - 1);
+    Buf[i] = uint8_t(Value >> (index * 8));
+  }
+  Contents.append(Buf, Buf + Size);
+}
+
 void MCObjectStreamer::EmitValueImpl(const MCExpr *Value, unsigned Size,
                                      const SMLoc &Loc) {
   MCStreamer::EmitValueImpl(Value, Size, Loc);
@@ -234,10 +256,73 @@ void MCObjectStreamer::EmitInstruction(const MCInst &Inst,
     return;
   }
 
+  // A backwards branch within the current data fragment has a distance that
+  // layout can never change; if the backend confirms the unrelaxed form
+  // reaches, resolve the fixup immediately and emit plain bytes. Loop
+  // back-edges hit this constantly, and every hit both avoids a
+  // MCRelaxableFragment (which keeps the whole MCInst alive until layout)
+  // and keeps the current data fragment growing instead of cutting it short.
+  if (!Assembler.isBundlingEnabled() && tryEmitInstResolved(Inst, STI))
+    return;
+
   // Otherwise emit to a separate fragment.
   EmitInstToFragment(Inst, STI);
 }
 
+bool MCObjectStreamer::tryEmitInstResolved(const MCInst &Inst,
+                                           const MCSubtargetInfo &STI) {
+  MCDataFragment *DF = dyn_cast_or_null<MCDataFragment>(getCurrentFragment());
+  if (!DF)
+    return false;
+
+  MCAssembler &Assembler = getAssembler();
+  MCAsmBackend &Backend = Assembler.getBackend();
+
+  SmallString<16> Code;
+  SmallVector<MCFixup, 2> Fixups;
+  raw_svector_ostream VecOS(Code);
+  Assembler.getEmitter().EncodeInstruction(Inst, VecOS, Fixups, STI);
+  VecOS.flush();
+
+  if (Fixups.size() != 1)
+    return false;
+  const MCFixup &Fixup = Fixups[0];
+
+  unsigned FixupFlags = Backend.getFixupKindInfo(Fixup.getKind()).Flags;
+  if (!(FixupFlags & MCFixupKindInfo::FKF_IsPCRel) ||
+      (FixupFlags & MCFixupKindInfo::FKF_IsAlignedDownTo32Bits))
+    return false;
+
+  // Mirror what evaluateFixup will conclude after layout. Both the fixup and
+  // its target must live in DF; offsets within a fragment are fixed as soon
+  // as they are assigned, so the pc-relative value is already final.
+  MCValue Target;
+  if (!Fixup.getValue()->EvaluateAsRelocatable(Target, nullptr, &Fixup))
+    return false;
+  if (Target.getSymB() || !Target.getSymA())
+    return false;
+  const MCSymbolRefExpr *A = Target.getSymA();
+  const MCSymbol &SA = A->getSymbol().AliasedSymbol();
+  if (A->getKind() != MCSymbolRefExpr::VK_None || SA.isUndefined() ||
+      !Assembler.hasSymbolData(SA))
+    return false;
+  const MCSymbolData &SD = Assembler.getSymbolData(SA);
+  if (SD.getFragment() != DF ||
+      !Assembler.getWriter().IsSymbolRefDifferenceFullyResolvedImpl(
+          Assembler, SD, *DF, false, true))
+    return false;
+
+  uint64_t FixupOffset = DF->getContents().size() + Fixup.getOffset();
+  uint64_t Value = Target.getConstant() + SD.getOffset() - FixupOffset;
+  if (Backend.fixupValueNeedsRelaxation(Fixup, Value))
+    return false;
+
+  Backend.applyFixup(Fixup, Code.data(), Code.size(), Value, /*IsPCRel=*/true);
+  DF->setHasInstructions(true);
+  DF->getContents().append(Code.begin(), Code.end());
+  return true;
+}
+
 void MCObjectStreamer::EmitInstToFragment(const MCInst &Inst,
                                           const MCSubtargetInfo &STI) {
   // Always create a new, separate fragment here, because its size can change
@@ -245,12 +330,12 @@ void MCObjectStreamer::EmitInstToFragment(const MCInst &Inst,
   MCRelaxableFragment *IF = new MCRelaxableFragment(Inst, STI);
   insert(IF);
 
-  SmallString<128> Code;
-  raw_svector_ostream VecOS(Code);
+  // Encode directly into the fragment's storage to avoid copying the encoded
+  // instruction through a temporary buffer.
+  raw_svector_ostream VecOS(IF->getContents());
   getAssembler().getEmitter().EncodeInstruction(Inst, VecOS, IF->getFixups(),
                                                 STI);
   VecOS.flush();
-  IF->getContents().append(Code.begin(), Code.end());
 }
 
 #ifndef NDEBUG
@@ -283,6 +368,25 @@ void MCObjectStreamer::EmitDwarfLocDirective(unsigned FileNo, unsigned Line,
                                           Isa, Discriminator, FileName);
 }
 
+Optional<int64_t>
+MCObjectStreamer::absoluteSymbolDiff(const MCSymbol *Hi,
+                                     const MCSymbol *Lo) const {
+  const MCAssembler &Asm = *Assembler;
+  if (Hi->isVariable() || Lo->isVariable() || !Asm.hasSymbolData(*Hi) ||
+      !Asm.hasSymbolData(*Lo))
+    return None;
+  const MCSymbolData &HiSD = Asm.getSymbolData(*Hi);
+  const MCSymbolData &LoSD = Asm.getSymbolData(*Lo);
+
+  // Offsets within a data fragment are fixed as soon as the labels are
+  // emitted; only relaxation between fragments is unknown before layout.
+  if (!HiSD.getFragment() || HiSD.getFragment() != LoSD.getFragment() ||
+      !isa<MCDataFragment>(HiSD.getFragment()))
+    return None;
+
+  return (int64_t)HiSD.getOffset() - (int64_t)LoSD.getOffset();
+}
+
 static const MCExpr *buildSymbolDiff(MCObjectStreamer &OS, const MCSymbol *A,
                                      const MCSymbol *B) {
   MCContext &Context = OS.getContext();
@@ -314,6 +418,13 @@ void MCObjectStreamer::EmitDwarfAdvanceLineAddr(int64_t LineDelta,
     emitDwarfSetLineAddr(*this, LineDelta, Label, PointerSize);
     return;
   }
+  // Line table entries usually advance between two labels in the same data
+  // fragment; emit those eagerly instead of growing the fragment list by one
+  // MCDwarfLineAddrFragment per entry.
+  if (Optional<int64_t> Diff = absoluteSymbolDiff(Label, LastLabel)) {
+    MCDwarfLineAddr::Emit(this, LineDelta, *Diff);
+    return;
+  }
   const MCExpr *AddrDelta = buildSymbolDiff(*this, Label, LastLabel);
   int64_t Res;
   if (AddrDelta->EvaluateAsAbsolute(Res, getAssembler())) {
@@ -325,6 +436,10 @@ void MCObjectStreamer::EmitDwarfAdvanceLineAddr(int64_t LineDelta,
 
 void MCObjectStreamer::EmitDwarfAdvanceFrameAddr(const MCSymbol *LastLabel,
                                                  const MCSymbol *Label) {
+  if (Optional<int64_t> Diff = absoluteSymbolDiff(Label, LastLabel)) {
+    MCDwarfFrameEmitter::EmitAdvanceLoc(*this, *Diff);
+    return;
+  }
   const MCExpr *AddrDelta = buildSymbolDiff(*this, Label, LastLabel);
   int64_t Res;
   if (AddrDelta->EvaluateAsAbsolute(Res, getAssembler())) {
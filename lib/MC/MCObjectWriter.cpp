@@ -10,13 +10,88 @@
 #include "llvm/MC/MCAssembler.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCObjectWriter.h"
+#include "llvm/MC/MCSection.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/MC/MCValue.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
 
 using namespace llvm;
 
+static cl::opt<unsigned>
+SectionRenderThreads("mc-render-threads", cl::Hidden, cl::init(1),
+                     cl::desc("Number of threads used to render section "
+                              "contents during object emission"));
+
 MCObjectWriter::~MCObjectWriter() {
 }
 
+namespace {
+/// An object writer that only exists to reuse the fragment emission helpers
+/// when a section is rendered into a memory buffer. The high-level callbacks
+/// are never invoked; relocations have already been recorded by the time
+/// section contents are written.
+class SectionRenderer : public MCObjectWriter {
+public:
+  SectionRenderer(raw_ostream &OS, bool IsLittleEndian)
+      : MCObjectWriter(OS, IsLittleEndian) {}
+
+  void ExecutePostLayoutBinding(MCAssembler &Asm,
+                                const MCAsmLayout &Layout) override {
+    llvm_unreachable("not used when rendering section contents");
+  }
+  void RecordRelocation(MCAssembler &Asm, const MCAsmLayout &Layout,
+                        const MCFragment *Fragment, const MCFixup &Fixup,
+                        MCValue Target, bool &IsPCRel,
+                        uint64_t &FixedValue) override {
+    llvm_unreachable("not used when rendering section contents");
+  }
+  void WriteObject(MCAssembler &Asm, const MCAsmLayout &Layout) override {
+    llvm_unreachable("not used when rendering section contents");
+  }
+};
+}
+
+void MCObjectWriter::renderSections(const MCAssembler &Asm,
+                                    const MCAsmLayout &Layout) {
+  if (SectionRenderThreads < 2)
+    return;
+
+  std::vector<const MCSectionData *> Work;
+  for (MCAssembler::const_iterator it = Asm.begin(), ie = Asm.end(); it != ie;
+       ++it)
+    if (!it->getSection().isVirtualSection())
+      Work.push_back(it);
+
+  // Create all map entries up front so the workers never mutate the map.
+  for (const MCSectionData *SD : Work)
+    RenderedSections[SD];
+
+  ThreadPool Pool(SectionRenderThreads);
+  for (const MCSectionData *SD : Work) {
+    SmallVectorImpl<char> &Buffer = RenderedSections[SD];
+    Pool.async([this, &Asm, &Layout, SD, &Buffer] {
+      raw_svector_ostream VecOS(Buffer);
+      SectionRenderer Renderer(VecOS, isLittleEndian());
+      Asm.writeSectionData(SD, Layout, Renderer);
+    });
+  }
+  Pool.wait();
+}
+
+void MCObjectWriter::writeSectionContents(const MCAssembler &Asm,
+                                          const MCSectionData *SD,
+                                          const MCAsmLayout &Layout) {
+  std::map<const MCSectionData *, SmallVector<char, 0>>::const_iterator I =
+      RenderedSections.find(SD);
+  if (I == RenderedSections.end()) {
+    Asm.writeSectionData(SD, Layout);
+    return;
+  }
+  OS.write(I->second.data(), I->second.size());
+}
+
 bool
 MCObjectWriter::IsSymbolRefDifferenceFullyResolved(const MCAssembler &Asm,
                                                    const MCSymbolRefExpr *A,
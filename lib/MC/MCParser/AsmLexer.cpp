@@ -264,6 +264,18 @@ AsmToken AsmLexer::LexDigit() {
 
     StringRef Result(TokStart, CurPtr - TokStart);
 
+    // Almost all literals fit in 64 bits; parse those with machine arithmetic
+    // and only fall back to APInt, which heap-allocates at the width below,
+    // when the value overflows (or the string is malformed).
+    uint64_t SmallValue;
+    if (!Result.getAsInteger(Radix, SmallValue)) {
+      // Consume the [bB][hH].
+      if (Radix == 2 || Radix == 16)
+        ++CurPtr;
+      SkipIgnoredIntegerSuffix(CurPtr);
+      return AsmToken(AsmToken::Integer, Result, (int64_t)SmallValue);
+    }
+
     APInt Value(128, 0, true);
     if (Result.getAsInteger(Radix, Value))
       return ReturnError(TokStart, !isHex ? "invalid decimal number" :
@@ -324,6 +336,16 @@ AsmToken AsmLexer::LexDigit() {
     if (CurPtr == NumStart)
       return ReturnError(CurPtr-2, "invalid hexadecimal number");
 
+    // 64-bit fast path, as for decimal literals above.
+    uint64_t SmallValue;
+    if (!StringRef(TokStart, CurPtr - TokStart).getAsInteger(0, SmallValue)) {
+      if (*CurPtr == 'h' || *CurPtr == 'H')
+        ++CurPtr;
+      SkipIgnoredIntegerSuffix(CurPtr);
+      return AsmToken(AsmToken::Integer, StringRef(TokStart, CurPtr - TokStart),
+                      (int64_t)SmallValue);
+    }
+
     APInt Result(128, 0);
     if (StringRef(TokStart, CurPtr - TokStart).getAsInteger(0, Result))
       return ReturnError(TokStart, "invalid hexadecimal number");
@@ -340,10 +362,21 @@ AsmToken AsmLexer::LexDigit() {
   }
 
   // Either octal or hexadecimal.
-  APInt Value(128, 0, true);
   unsigned Radix = doLookAhead(CurPtr, 8);
   bool isHex = Radix == 16;
   StringRef Result(TokStart, CurPtr - TokStart);
+
+  // 64-bit fast path, as for decimal literals above.  This covers the very
+  // common bare "0".
+  uint64_t SmallValue;
+  if (!Result.getAsInteger(Radix, SmallValue)) {
+    if (Radix == 16)
+      ++CurPtr;
+    SkipIgnoredIntegerSuffix(CurPtr);
+    return AsmToken(AsmToken::Integer, Result, (int64_t)SmallValue);
+  }
+
+  APInt Value(128, 0, true);
   if (Result.getAsInteger(Radix, Value))
     return ReturnError(TokStart, !isHex ? "invalid octal number" :
                        "invalid hexdecimal number");
@@ -461,19 +494,26 @@ const AsmToken AsmLexer::peekTok(bool ShouldSkipSpace) {
 bool AsmLexer::isAtStartOfComment(const char *Ptr) {
   const char *CommentString = MAI.getCommentString();
 
+  // This is called for every token, so compare the first character before
+  // doing any string work.
+  if (CommentString[0] != Ptr[0])
+    return false;
+
   if (CommentString[1] == '\0')
-    return CommentString[0] == Ptr[0];
+    return true;
 
   // FIXME: special case for the bogus "##" comment string in X86MCAsmInfoDarwin
   if (CommentString[1] == '#')
-    return CommentString[0] == Ptr[0];
+    return true;
 
   return strncmp(Ptr, CommentString, strlen(CommentString)) == 0;
 }
 
 bool AsmLexer::isAtStatementSeparator(const char *Ptr) {
-  return strncmp(Ptr, MAI.getSeparatorString(),
-                 strlen(MAI.getSeparatorString())) == 0;
+  const char *SeparatorString = MAI.getSeparatorString();
+  if (SeparatorString[0] != Ptr[0])
+    return false;
+  return strncmp(Ptr, SeparatorString, strlen(SeparatorString)) == 0;
 }
 
 AsmToken AsmLexer::LexToken() {
@@ -661,11 +661,12 @@ bool AsmParser::Run(bool NoInitialTextSection, bool NoFinalize) {
   // so conservatively exclude them. Only do this if we're finalizing, though,
   // as otherwise we won't necessarilly have seen everything yet.
   if (!NoFinalize && MAI.hasSubsectionsViaSymbols()) {
-    const MCContext::SymbolTable &Symbols = getContext().getSymbols();
-    for (MCContext::SymbolTable::const_iterator i = Symbols.begin(),
-                                                e = Symbols.end();
+    SmallVector<MCSymbol *, 64> Symbols;
+    getContext().getSymbols(Symbols);
+    for (SmallVectorImpl<MCSymbol *>::const_iterator i = Symbols.begin(),
+                                                     e = Symbols.end();
          i != e; ++i) {
-      MCSymbol *Sym = i->getValue();
+      MCSymbol *Sym = *i;
       // Variable symbols may not be marked as defined, so check those
       // explicitly. If we know it's a variable, we have a definition for
       // the purposes of this check.
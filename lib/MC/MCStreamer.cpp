@@ -89,6 +89,14 @@ void MCStreamer::EmitIntValue(uint64_t Value, unsigned Size) {
 /// EmitULEB128Value - Special case of EmitULEB128Value that avoids the
 /// client having to pass in a MCExpr for constant integers.
 void MCStreamer::EmitULEB128IntValue(uint64_t Value, unsigned Padding) {
+  // Common case: encode into a stack buffer rather than through a stream.
+  // DWARF emission goes through here millions of times.
+  if (Padding < 16) {
+    uint8_t Buf[32];
+    unsigned Len = encodeULEB128(Value, Buf, Padding);
+    EmitBytes(StringRef((const char *)Buf, Len));
+    return;
+  }
   SmallString<128> Tmp;
   raw_svector_ostream OSE(Tmp);
   encodeULEB128(Value, OSE, Padding);
@@ -98,10 +106,9 @@ void MCStreamer::EmitULEB128IntValue(uint64_t Value, unsigned Padding) {
 /// EmitSLEB128Value - Special case of EmitSLEB128Value that avoids the
 /// client having to pass in a MCExpr for constant integers.
 void MCStreamer::EmitSLEB128IntValue(int64_t Value) {
-  SmallString<128> Tmp;
-  raw_svector_ostream OSE(Tmp);
-  encodeSLEB128(Value, OSE);
-  EmitBytes(OSE.str());
+  uint8_t Buf[16];
+  unsigned Len = encodeSLEB128(Value, Buf);
+  EmitBytes(StringRef((const char *)Buf, Len));
 }
 
 void MCStreamer::EmitValue(const MCExpr *Value, unsigned Size,
@@ -27,14 +27,38 @@ static bool compareBySuffix(StringRef a, StringRef b) {
   return sizeA > sizeB;
 }
 
+/// Pack the last (up to) eight bytes of \p S into an integer whose unsigned
+/// comparison matches compareBySuffix on those bytes: the last character ends
+/// up in the most significant byte, and short strings are zero-padded below.
+/// Sorting on this key descending gives the same order as compareBySuffix for
+/// all pairs that differ within their last eight bytes, so the full byte-wise
+/// comparison is only needed to break key ties.
+static uint64_t getSuffixKey(StringRef S) {
+  uint64_t Key = 0;
+  unsigned N = std::min<size_t>(S.size(), 8);
+  for (unsigned i = 0; i != N; ++i)
+    Key |= uint64_t((unsigned char)S[S.size() - i - 1]) << (56 - 8 * i);
+  return Key;
+}
+
 void StringTableBuilder::finalize(Kind kind) {
-  SmallVector<StringRef, 8> Strings;
+  // Carry the map entries themselves so offsets can be stored back without
+  // rehashing every string, and pair each with its suffix key so almost all
+  // sort comparisons are a single integer compare instead of a byte-wise
+  // walk from the end of both strings.
+  typedef std::pair<uint64_t, StringMapEntry<size_t> *> SuffixKeyedEntry;
+  SmallVector<SuffixKeyedEntry, 8> Strings;
   Strings.reserve(StringIndexMap.size());
 
   for (auto i = StringIndexMap.begin(), e = StringIndexMap.end(); i != e; ++i)
-    Strings.push_back(i->getKey());
+    Strings.push_back(std::make_pair(getSuffixKey(i->getKey()), &*i));
 
-  std::sort(Strings.begin(), Strings.end(), compareBySuffix);
+  std::sort(Strings.begin(), Strings.end(),
+            [](const SuffixKeyedEntry &L, const SuffixKeyedEntry &R) {
+              if (L.first != R.first)
+                return L.first > R.first;
+              return compareBySuffix(L.second->getKey(), R.second->getKey());
+            });
 
   switch (kind) {
   case ELF:
@@ -49,16 +73,17 @@ void StringTableBuilder::finalize(Kind kind) {
   }
 
   StringRef Previous;
-  for (StringRef s : Strings) {
+  for (const SuffixKeyedEntry &P : Strings) {
+    StringRef s = P.second->getKey();
     if (kind == WinCOFF)
       assert(s.size() > COFF::NameSize && "Short string in COFF string table!");
 
     if (Previous.endswith(s)) {
-      StringIndexMap[s] = StringTable.size() - 1 - s.size();
+      P.second->setValue(StringTable.size() - 1 - s.size());
       continue;
     }
 
-    StringIndexMap[s] = StringTable.size();
+    P.second->setValue(StringTable.size());
     StringTable += s;
     StringTable += '\x00';
     Previous = s;
@@ -1003,6 +1003,8 @@ void WinCOFFObjectWriter::WriteObject(MCAssembler &Asm,
       }
     }
 
+    renderSections(Asm, Layout);
+
     for (i = Sections.begin(), ie = Sections.end(),
          j = Asm.begin(), je = Asm.end();
          (i != ie) && (j != je); ++i, ++j) {
@@ -1020,7 +1022,7 @@ void WinCOFFObjectWriter::WriteObject(MCAssembler &Asm,
 
         WriteZeros(SectionDataPadding);
 
-        Asm.writeSectionData(j, Layout);
+        writeSectionContents(Asm, j, Layout);
       }
 
       if ((*i)->Relocations.size() > 0) {
@@ -206,7 +206,8 @@ ErrorOr<std::unique_ptr<Archive>> Archive::create(MemoryBufferRef Source) {
 }
 
 Archive::Archive(MemoryBufferRef Source, std::error_code &ec)
-    : Binary(Binary::ID_Archive, Source), SymbolTable(child_end()) {
+    : Binary(Binary::ID_Archive, Source), SymbolTable(child_end()),
+      SymbolIndexBuilt(false) {
   StringRef Buffer = Data.getBuffer();
   // Check for sufficient magic.
   if (Buffer.startswith(ThinMagic)) {
@@ -519,20 +520,34 @@ Archive::symbol_iterator Archive::symbol_end() const {
 }
 
 Archive::child_iterator Archive::findSym(StringRef name) const {
-  Archive::symbol_iterator bs = symbol_begin();
-  Archive::symbol_iterator es = symbol_end();
-
-  for (; bs != es; ++bs) {
-    StringRef SymName = bs->getName();
-    if (SymName == name) {
-      ErrorOr<Archive::child_iterator> ResultOrErr = bs->getMember();
-      // FIXME: Should we really eat the error?
-      if (ResultOrErr.getError())
-        return child_end();
-      return ResultOrErr.get();
-    }
+  if (!hasSymbolTable())
+    return child_end();
+
+  // Index the symbol table on the first lookup. An LTO link probes the same
+  // archive once per undefined symbol, and rescanning the whole table each
+  // time is visible in link profiles.
+  if (!SymbolIndexBuilt) {
+    Archive::symbol_iterator bs = symbol_begin();
+    Archive::symbol_iterator es = symbol_end();
+    for (; bs != es; ++bs)
+      // insert keeps the first entry for a name, matching the order the
+      // linear scan used to find definitions in.
+      SymbolIndexMap.insert(std::make_pair(
+          bs->getName(), std::make_pair(bs->SymbolIndex, bs->StringIndex)));
+    SymbolIndexBuilt = true;
   }
-  return child_end();
+
+  StringMap<std::pair<uint32_t, uint32_t>>::const_iterator I =
+      SymbolIndexMap.find(name);
+  if (I == SymbolIndexMap.end())
+    return child_end();
+
+  Symbol Sym(this, I->second.first, I->second.second);
+  ErrorOr<Archive::child_iterator> ResultOrErr = Sym.getMember();
+  // FIXME: Should we really eat the error?
+  if (ResultOrErr.getError())
+    return child_end();
+  return ResultOrErr.get();
 }
 
 bool Archive::hasSymbolTable() const {
@@ -0,0 +1,84 @@
+//===- ContentHash.cpp - Object file content hashing ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines utilities for computing stable content hashes for the
+// sections and symbols of an object file.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ContentHash.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MD5.h"
+
+using namespace llvm;
+using namespace object;
+
+/// Return the first eight bytes of the MD5 digest of \p Data, read
+/// little-endian.  MD5 is used rather than the hashing routines in
+/// llvm/ADT/Hashing.h because those are documented to be unstable across
+/// processes, and these hashes are persisted by build systems.
+static uint64_t truncatedMD5(StringRef Data) {
+  MD5 Hash;
+  MD5::MD5Result Digest;
+  Hash.update(Data);
+  Hash.final(Digest);
+  return support::endian::read<uint64_t, support::little, support::unaligned>(
+      Digest);
+}
+
+uint64_t object::hashSectionContents(const SectionRef &Sec) {
+  StringRef Contents;
+  if (Sec.isVirtual() || Sec.getContents(Contents)) {
+    // No bytes in the file; all that can change is the size.
+    uint8_t SizeBytes[8];
+    support::endian::write<uint64_t, support::little, support::unaligned>(
+        SizeBytes, Sec.getSize());
+    return truncatedMD5(
+        StringRef(reinterpret_cast<char *>(SizeBytes), sizeof(SizeBytes)));
+  }
+  return truncatedMD5(Contents);
+}
+
+std::vector<SectionContentHash>
+object::computeSectionHashes(const ObjectFile &Obj) {
+  std::vector<SectionContentHash> Hashes;
+  for (const SectionRef &Sec : Obj.sections()) {
+    SectionContentHash H = {Sec, hashSectionContents(Sec)};
+    Hashes.push_back(H);
+  }
+  return Hashes;
+}
+
+std::vector<SymbolContentHash>
+object::computeSymbolHashes(const ObjectFile &Obj) {
+  std::vector<SymbolContentHash> Hashes;
+  for (const SymbolRef &Sym : Obj.symbols()) {
+    section_iterator SecI = Obj.section_end();
+    if (Sym.getSection(SecI) || SecI == Obj.section_end())
+      continue;
+
+    uint64_t Addr, Size;
+    if (Sym.getAddress(Addr) || Addr == UnknownAddressOrSize ||
+        Sym.getSize(Size) || Size == UnknownAddressOrSize)
+      continue;
+
+    StringRef SecContents;
+    if (SecI->isVirtual() || SecI->getContents(SecContents))
+      continue;
+
+    // Symbol addresses are image relative, not section relative.
+    uint64_t Offset = Addr - SecI->getAddress();
+    if (Offset > SecContents.size() || Size > SecContents.size() - Offset)
+      continue;
+
+    SymbolContentHash H = {Sym, truncatedMD5(SecContents.substr(Offset, Size))};
+    Hashes.push_back(H);
+  }
+  return Hashes;
+}
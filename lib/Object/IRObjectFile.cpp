@@ -13,6 +13,7 @@
 
 #include "llvm/Object/IRObjectFile.h"
 #include "RecordStreamer.h"
+#include "llvm/Bitcode/LLVMBitCodes.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/GVMaterializer.h"
 #include "llvm/IR/LLVMContext.h"
@@ -292,6 +293,46 @@ ErrorOr<MemoryBufferRef> IRObjectFile::findBitcodeInMemBuffer(MemoryBufferRef Ob
   }
 }
 
+ErrorOr<bool> IRObjectFile::readSymbols(MemoryBufferRef Object,
+                                        std::vector<FileSymbol> &Symbols) {
+  ErrorOr<MemoryBufferRef> BCOrErr = findBitcodeInMemBuffer(Object);
+  if (!BCOrErr)
+    return BCOrErr.getError();
+
+  std::vector<BitcodeSymbol> BCSymbols;
+  ErrorOr<bool> FoundOrErr = readBitcodeSymbols(*BCOrErr, BCSymbols);
+  if (!FoundOrErr || !*FoundOrErr)
+    return FoundOrErr;
+
+  Symbols.reserve(BCSymbols.size());
+  for (BitcodeSymbol &BCSym : BCSymbols) {
+    Symbols.push_back(FileSymbol());
+    FileSymbol &Sym = Symbols.back();
+
+    uint32_t Res = BasicSymbolRef::SF_None;
+    if (BCSym.Flags & bitc::SYMTAB_SYMBOL_UNDEFINED)
+      Res |= BasicSymbolRef::SF_Undefined;
+    if (BCSym.Flags & bitc::SYMTAB_SYMBOL_GLOBAL)
+      Res |= BasicSymbolRef::SF_Global;
+    if (BCSym.Flags & bitc::SYMTAB_SYMBOL_WEAK)
+      Res |= BasicSymbolRef::SF_Weak;
+    if (BCSym.Flags & bitc::SYMTAB_SYMBOL_COMMON)
+      Res |= BasicSymbolRef::SF_Common;
+    if (BCSym.Flags & bitc::SYMTAB_SYMBOL_FORMAT_SPECIFIC)
+      Res |= BasicSymbolRef::SF_FormatSpecific;
+    Sym.Flags = Res;
+
+    Sym.Visibility = BCSym.Visibility;
+    Sym.IsExternalWeak = BCSym.Flags & bitc::SYMTAB_SYMBOL_EXTERNAL_WEAK;
+    Sym.IsWeakForLinker = BCSym.Flags & bitc::SYMTAB_SYMBOL_WEAK_FOR_LINKER;
+    Sym.Comdat = (BCSym.Flags & bitc::SYMTAB_SYMBOL_SELF_COMDAT)
+                     ? BCSym.Name
+                     : std::move(BCSym.ComdatKey);
+    Sym.Name = std::move(BCSym.Name);
+  }
+  return true;
+}
+
 ErrorOr<std::unique_ptr<IRObjectFile>>
 llvm::object::IRObjectFile::create(MemoryBufferRef Object,
                                    LLVMContext &Context) {
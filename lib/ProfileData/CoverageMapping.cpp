@@ -20,6 +20,7 @@
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 using namespace coverage;
@@ -182,10 +183,23 @@ CoverageMapping::load(CoverageMappingReader &CoverageReader,
                       IndexedInstrProfReader &ProfileReader) {
   auto Coverage = std::unique_ptr<CoverageMapping>(new CoverageMapping());
 
+  // The reader decodes each record into scratch storage that is reused for
+  // the next one and the profile reader is stateful, so reading stays serial.
+  // Evaluating the counter expressions of each function is independent work,
+  // so that part runs on the shared thread pool.
+  struct PendingFunction {
+    PendingFunction(StringRef Name, ArrayRef<StringRef> Filenames)
+        : Function(Name, Filenames), Mismatched(false) {}
+    std::vector<CounterExpression> Expressions;
+    std::vector<CounterMappingRegion> MappingRegions;
+    std::vector<uint64_t> Counts;
+    FunctionRecord Function;
+    bool Mismatched;
+  };
+  std::vector<PendingFunction> Pending;
+
   std::vector<uint64_t> Counts;
   for (const auto &Record : CoverageReader) {
-    CounterMappingContext Ctx(Record.Expressions);
-
     Counts.clear();
     if (std::error_code EC = ProfileReader.getFunctionCounts(
             Record.FunctionName, Record.FunctionHash, Counts)) {
@@ -194,23 +208,38 @@ CoverageMapping::load(CoverageMappingReader &CoverageReader,
         continue;
       } else if (EC != instrprof_error::unknown_function)
         return EC;
-    } else
-      Ctx.setCounts(Counts);
+      Counts.clear();
+    }
 
     assert(!Record.MappingRegions.empty() && "Function has no regions");
-    FunctionRecord Function(Record.FunctionName, Record.Filenames);
-    for (const auto &Region : Record.MappingRegions) {
+    Pending.emplace_back(Record.FunctionName, Record.Filenames);
+    PendingFunction &P = Pending.back();
+    P.Expressions.assign(Record.Expressions.begin(), Record.Expressions.end());
+    P.MappingRegions.assign(Record.MappingRegions.begin(),
+                            Record.MappingRegions.end());
+    P.Counts = std::move(Counts);
+  }
+
+  parallel::for_each_n((size_t)0, Pending.size(), [&](size_t I) {
+    PendingFunction &P = Pending[I];
+    CounterMappingContext Ctx(P.Expressions);
+    Ctx.setCounts(P.Counts);
+    for (const auto &Region : P.MappingRegions) {
       ErrorOr<int64_t> ExecutionCount = Ctx.evaluate(Region.Count);
       if (!ExecutionCount)
         break;
-      Function.pushRegion(Region, *ExecutionCount);
+      P.Function.pushRegion(Region, *ExecutionCount);
     }
-    if (Function.CountedRegions.size() != Record.MappingRegions.size()) {
+    if (P.Function.CountedRegions.size() != P.MappingRegions.size())
+      P.Mismatched = true;
+  });
+
+  for (auto &P : Pending) {
+    if (P.Mismatched) {
       Coverage->MismatchedFunctionCount++;
       continue;
     }
-
-    Coverage->Functions.push_back(std::move(Function));
+    Coverage->Functions.push_back(std::move(P.Function));
   }
 
   return std::move(Coverage);
@@ -218,7 +247,15 @@ CoverageMapping::load(CoverageMappingReader &CoverageReader,
 
 ErrorOr<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(StringRef ObjectFilename, StringRef ProfileFilename) {
-  auto CounterMappingBuff = MemoryBuffer::getFileOrSTDIN(ObjectFilename);
+  // Map the object file rather than reading it into memory; nothing in the
+  // readers needs a null terminator and the sections are consumed in place,
+  // so this avoids copying the whole binary just to look at its coverage
+  // mapping.
+  auto CounterMappingBuff =
+      ObjectFilename == "-"
+          ? MemoryBuffer::getSTDIN()
+          : MemoryBuffer::getFile(ObjectFilename, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
   if (auto EC = CounterMappingBuff.getError())
     return EC;
   ObjectFileCoverageMappingReader CoverageReader(CounterMappingBuff.get());
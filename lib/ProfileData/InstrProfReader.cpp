@@ -20,9 +20,14 @@
 using namespace llvm;
 
 static ErrorOr<std::unique_ptr<MemoryBuffer>>
-setupMemoryBuffer(std::string Path) {
+setupMemoryBuffer(std::string Path, bool RequiresNullTerminator = true) {
+  // Readers of binary formats check bounds explicitly and should not require
+  // a null terminator, so that large profiles can be memory mapped and paged
+  // in on demand rather than read up front.
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFileOrSTDIN(Path);
+      Path == "-" ? MemoryBuffer::getSTDIN()
+                  : MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                          RequiresNullTerminator);
   if (std::error_code EC = BufferOrErr.getError())
     return EC;
   return std::move(BufferOrErr.get());
@@ -67,8 +72,9 @@ InstrProfReader::create(std::unique_ptr<MemoryBuffer> Buffer) {
 
 ErrorOr<std::unique_ptr<IndexedInstrProfReader>>
 IndexedInstrProfReader::create(std::string Path) {
-  // Set up the buffer to read.
-  auto BufferOrError = setupMemoryBuffer(Path);
+  // Set up the buffer to read. The indexed format never relies on a
+  // terminating null, so the file can be mapped instead of copied.
+  auto BufferOrError = setupMemoryBuffer(Path, /*RequiresNullTerminator=*/false);
   if (std::error_code EC = BufferOrError.getError())
     return EC;
   return IndexedInstrProfReader::create(std::move(BufferOrError.get()));
@@ -223,10 +229,20 @@ static uint64_t getRawVersion() {
   return 1;
 }
 
+/// Version of the raw format whose counter section is run-length encoded as
+/// a sequence of (run length, counter value) word pairs.  Counters in
+/// instrumented services are overwhelmingly zeros and ones, so runtimes that
+/// write this format produce far smaller profiles; the reader expands the
+/// runs once per header so the rest of the code can index counters directly.
+static uint64_t getRawRLEVersion() {
+  return 2;
+}
+
 template <class IntPtrT>
 std::error_code
 RawInstrProfReader<IntPtrT>::readHeader(const RawHeader &Header) {
-  if (swap(Header.Version) != getRawVersion())
+  uint64_t Version = swap(Header.Version);
+  if (Version != getRawVersion() && Version != getRawRLEVersion())
     return error(instrprof_error::unsupported_version);
 
   CountersDelta = swap(Header.CountersDelta);
@@ -235,6 +251,8 @@ RawInstrProfReader<IntPtrT>::readHeader(const RawHeader &Header) {
   auto CountersSize = swap(Header.CountersSize);
   auto NamesSize = swap(Header.NamesSize);
 
+  // For version 2, CountersSize counts the encoded words in the file, not
+  // the counters they expand to.
   ptrdiff_t DataOffset = sizeof(RawHeader);
   ptrdiff_t CountersOffset = DataOffset + sizeof(ProfileData) * DataSize;
   ptrdiff_t NamesOffset = CountersOffset + sizeof(uint64_t) * CountersSize;
@@ -246,10 +264,36 @@ RawInstrProfReader<IntPtrT>::readHeader(const RawHeader &Header) {
 
   Data = reinterpret_cast<const ProfileData *>(Start + DataOffset);
   DataEnd = Data + DataSize;
-  CountersStart = reinterpret_cast<const uint64_t *>(Start + CountersOffset);
   NamesStart = Start + NamesOffset;
   ProfileEnd = Start + ProfileSize;
 
+  auto *RawCounters =
+      reinterpret_cast<const uint64_t *>(Start + CountersOffset);
+  if (Version == getRawRLEVersion()) {
+    if (CountersSize % 2)
+      return error(instrprof_error::malformed);
+    // Cap the expansion so a malformed header cannot make us allocate
+    // arbitrary amounts of memory.  Per-function counter counts are 32 bit,
+    // so this loses nothing the rest of the reader could represent.
+    const uint64_t MaxCounters = uint64_t(1) << 32;
+    DecodedCounters.clear();
+    for (uint64_t I = 0; I != CountersSize; I += 2) {
+      uint64_t RunLength = swap(RawCounters[I]);
+      if (RunLength == 0 ||
+          RunLength > MaxCounters - DecodedCounters.size())
+        return error(instrprof_error::malformed);
+      // Keep the value in file byte order; readNextRecord swaps counters
+      // when it consumes them.
+      DecodedCounters.insert(DecodedCounters.end(), RunLength,
+                             RawCounters[I + 1]);
+    }
+    CountersStart = DecodedCounters.data();
+    CountersEnd = CountersStart + DecodedCounters.size();
+  } else {
+    CountersStart = RawCounters;
+    CountersEnd = reinterpret_cast<const uint64_t *>(NamesStart);
+  }
+
   return success();
 }
 
@@ -268,11 +312,10 @@ RawInstrProfReader<IntPtrT>::readNextRecord(InstrProfRecord &Record) {
   auto RawCounts = makeArrayRef(getCounter(Data->CounterPtr), NumCounters);
 
   // Check bounds.
-  auto *NamesStartAsCounter = reinterpret_cast<const uint64_t *>(NamesStart);
   if (RawName.data() < NamesStart ||
       RawName.data() + RawName.size() > DataBuffer->getBufferEnd() ||
       RawCounts.data() < CountersStart ||
-      RawCounts.data() + RawCounts.size() > NamesStartAsCounter)
+      RawCounts.data() + RawCounts.size() > CountersEnd)
     return error(instrprof_error::malformed);
 
   // Store the data in Record, byte-swapping as necessary.
@@ -355,22 +398,26 @@ std::error_code IndexedInstrProfReader::getFunctionCounts(
   if (Iter == Index->end())
     return error(instrprof_error::unknown_function);
 
-  // Found it. Look for counters with the right hash.
-  ArrayRef<uint64_t> Data = (*Iter).Data;
+  // Found it. Look for counters with the right hash. Only the counters for
+  // the matching hash are decoded; the others are skipped over in place.
+  InstrProfLookupTrait::data_type Data = *Iter;
   uint64_t NumCounts;
-  for (uint64_t I = 0, E = Data.size(); I != E; I += NumCounts) {
+  for (uint64_t I = 0, E = Data.NumWords; I != E; I += NumCounts) {
     // The function hash comes first.
-    uint64_t FoundHash = Data[I++];
+    uint64_t FoundHash = Data.getWord(I++);
     // In v1, we have at least one count. Later, we have the number of counts.
     if (I == E)
       return error(instrprof_error::malformed);
-    NumCounts = FormatVersion == 1 ? E - I : Data[I++];
+    NumCounts = FormatVersion == 1 ? E - I : Data.getWord(I++);
     // If we have more counts than data, this is bogus.
     if (I + NumCounts > E)
       return error(instrprof_error::malformed);
     // Check for a match and fill the vector if there is one.
     if (FoundHash == FuncHash) {
-      Counts = Data.slice(I, NumCounts);
+      Counts.clear();
+      Counts.reserve(NumCounts);
+      for (uint64_t C = I, CE = I + NumCounts; C != CE; ++C)
+        Counts.push_back(Data.getWord(C));
       return success();
     }
   }
@@ -383,27 +430,30 @@ IndexedInstrProfReader::readNextRecord(InstrProfRecord &Record) {
   if (RecordIterator == Index->data_end())
     return error(instrprof_error::eof);
 
+  InstrProfLookupTrait::data_type Data = *RecordIterator;
   // Record the current function name.
-  Record.Name = (*RecordIterator).Name;
+  Record.Name = Data.Name;
 
-  ArrayRef<uint64_t> Data = (*RecordIterator).Data;
   // Valid data starts with a hash and either a count or the number of counts.
-  if (CurrentOffset + 1 > Data.size())
+  if (CurrentOffset + 1 > Data.NumWords)
     return error(instrprof_error::malformed);
   // First we have a function hash.
-  Record.Hash = Data[CurrentOffset++];
+  Record.Hash = Data.getWord(CurrentOffset++);
   // In version 1 we knew the number of counters implicitly, but in newer
   // versions we store the number of counters next.
-  uint64_t NumCounts =
-      FormatVersion == 1 ? Data.size() - CurrentOffset : Data[CurrentOffset++];
-  if (CurrentOffset + NumCounts > Data.size())
+  uint64_t NumCounts = FormatVersion == 1 ? Data.NumWords - CurrentOffset
+                                          : Data.getWord(CurrentOffset++);
+  if (CurrentOffset + NumCounts > Data.NumWords)
     return error(instrprof_error::malformed);
   // And finally the counts themselves.
-  Record.Counts = Data.slice(CurrentOffset, NumCounts);
+  CountBuffer.clear();
+  CountBuffer.reserve(NumCounts);
+  for (uint64_t E = CurrentOffset + NumCounts; CurrentOffset != E;)
+    CountBuffer.push_back(Data.getWord(CurrentOffset++));
+  Record.Counts = CountBuffer;
 
   // If we've exhausted this function's data, increment the record.
-  CurrentOffset += NumCounts;
-  if (CurrentOffset == Data.size()) {
+  if (CurrentOffset == Data.NumWords) {
     ++RecordIterator;
     CurrentOffset = 0;
   }
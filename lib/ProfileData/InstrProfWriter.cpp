@@ -106,6 +106,16 @@ InstrProfWriter::addFunctionCounts(StringRef FunctionName,
   return instrprof_error::success;
 }
 
+void InstrProfWriter::mergeRecordsFromWriter(
+    InstrProfWriter &&Other,
+    function_ref<void(StringRef, std::error_code)> Warn) {
+  for (auto &I : Other.FunctionData)
+    for (auto &J : I.getValue())
+      if (std::error_code EC =
+              addFunctionCounts(I.getKey(), J.first, J.second))
+        Warn(I.getKey(), EC);
+}
+
 std::pair<uint64_t, uint64_t> InstrProfWriter::writeImpl(raw_ostream &OS) {
   OnDiskChainedHashTableGenerator<InstrProfRecordTrait> Generator;
 
@@ -8,10 +8,13 @@
 //===----------------------------------------------------------------------===//
 //
 // This file implements the class that reads LLVM sample profiles. It
-// supports two file formats: text and binary. The textual representation
-// is useful for debugging and testing purposes. The binary representation
-// is more compact, resulting in smaller file sizes. However, they can
-// both be used interchangeably.
+// supports three file formats: text, binary and indexed binary. The
+// textual representation is useful for debugging and testing purposes.
+// The binary representation is more compact, resulting in smaller file
+// sizes. The indexed binary representation additionally ends with an
+// index mapping function names to record offsets, which allows readers
+// to load individual function profiles on demand. All formats can be
+// used interchangeably.
 //
 // NOTE: If you are making changes to the file format, please remember
 //       to document them in the Clang documentation at
@@ -96,6 +99,7 @@
 
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/LineIterator.h"
@@ -264,63 +268,69 @@ ErrorOr<StringRef> SampleProfileReaderBinary::readString() {
   return Str;
 }
 
-std::error_code SampleProfileReaderBinary::read() {
-  while (!at_eof()) {
-    auto FName(readString());
-    if (std::error_code EC = FName.getError())
-      return EC;
+std::error_code SampleProfileReaderBinary::readFunctionProfile() {
+  auto FName(readString());
+  if (std::error_code EC = FName.getError())
+    return EC;
 
-    Profiles[*FName] = FunctionSamples();
-    FunctionSamples &FProfile = Profiles[*FName];
+  Profiles[*FName] = FunctionSamples();
+  FunctionSamples &FProfile = Profiles[*FName];
+
+  auto Val = readNumber<unsigned>();
+  if (std::error_code EC = Val.getError())
+    return EC;
+  FProfile.addTotalSamples(*Val);
+
+  Val = readNumber<unsigned>();
+  if (std::error_code EC = Val.getError())
+    return EC;
+  FProfile.addHeadSamples(*Val);
 
-    auto Val = readNumber<unsigned>();
-    if (std::error_code EC = Val.getError())
+  // Read the samples in the body.
+  auto NumRecords = readNumber<unsigned>();
+  if (std::error_code EC = NumRecords.getError())
+    return EC;
+  for (unsigned I = 0; I < *NumRecords; ++I) {
+    auto LineOffset = readNumber<uint64_t>();
+    if (std::error_code EC = LineOffset.getError())
       return EC;
-    FProfile.addTotalSamples(*Val);
 
-    Val = readNumber<unsigned>();
-    if (std::error_code EC = Val.getError())
+    auto Discriminator = readNumber<uint64_t>();
+    if (std::error_code EC = Discriminator.getError())
       return EC;
-    FProfile.addHeadSamples(*Val);
 
-    // Read the samples in the body.
-    auto NumRecords = readNumber<unsigned>();
-    if (std::error_code EC = NumRecords.getError())
+    auto NumSamples = readNumber<uint64_t>();
+    if (std::error_code EC = NumSamples.getError())
       return EC;
-    for (unsigned I = 0; I < *NumRecords; ++I) {
-      auto LineOffset = readNumber<uint64_t>();
-      if (std::error_code EC = LineOffset.getError())
-        return EC;
 
-      auto Discriminator = readNumber<uint64_t>();
-      if (std::error_code EC = Discriminator.getError())
-        return EC;
+    auto NumCalls = readNumber<unsigned>();
+    if (std::error_code EC = NumCalls.getError())
+      return EC;
 
-      auto NumSamples = readNumber<uint64_t>();
-      if (std::error_code EC = NumSamples.getError())
+    for (unsigned J = 0; J < *NumCalls; ++J) {
+      auto CalledFunction(readString());
+      if (std::error_code EC = CalledFunction.getError())
         return EC;
 
-      auto NumCalls = readNumber<unsigned>();
-      if (std::error_code EC = NumCalls.getError())
+      auto CalledFunctionSamples = readNumber<uint64_t>();
+      if (std::error_code EC = CalledFunctionSamples.getError())
         return EC;
 
-      for (unsigned J = 0; J < *NumCalls; ++J) {
-        auto CalledFunction(readString());
-        if (std::error_code EC = CalledFunction.getError())
-          return EC;
+      FProfile.addCalledTargetSamples(*LineOffset, *Discriminator,
+                                      *CalledFunction,
+                                      *CalledFunctionSamples);
+    }
 
-        auto CalledFunctionSamples = readNumber<uint64_t>();
-        if (std::error_code EC = CalledFunctionSamples.getError())
-          return EC;
+    FProfile.addBodySamples(*LineOffset, *Discriminator, *NumSamples);
+  }
 
-        FProfile.addCalledTargetSamples(*LineOffset, *Discriminator,
-                                        *CalledFunction,
-                                        *CalledFunctionSamples);
-      }
+  return sampleprof_error::success;
+}
 
-      FProfile.addBodySamples(*LineOffset, *Discriminator, *NumSamples);
-    }
-  }
+std::error_code SampleProfileReaderBinary::read() {
+  while (!at_eof())
+    if (std::error_code EC = readFunctionProfile())
+      return EC;
 
   return sampleprof_error::success;
 }
@@ -353,6 +363,104 @@ bool SampleProfileReaderBinary::hasFormat(const MemoryBuffer &Buffer) {
   return Magic == SPMagic();
 }
 
+std::error_code SampleProfileReaderIndexed::readHeader() {
+  const uint8_t *BufStart =
+      reinterpret_cast<const uint8_t *>(Buffer->getBufferStart());
+  Data = BufStart;
+  End = BufStart + Buffer->getBufferSize();
+
+  // Read and check the magic identifier.
+  auto Magic = readNumber<uint64_t>();
+  if (std::error_code EC = Magic.getError())
+    return EC;
+  else if (*Magic != SPMagicIndexed())
+    return sampleprof_error::bad_magic;
+
+  // Read the version number.
+  auto Version = readNumber<uint64_t>();
+  if (std::error_code EC = Version.getError())
+    return EC;
+  else if (*Version != SPVersion())
+    return sampleprof_error::unsupported_version;
+
+  // The last 8 bytes of the file hold the offset of the function index.
+  if (Buffer->getBufferSize() < sizeof(uint64_t))
+    return sampleprof_error::truncated;
+  uint64_t IndexOffset =
+      support::endian::read<uint64_t, support::little, support::unaligned>(
+          End - sizeof(uint64_t));
+  if (IndexOffset >= Buffer->getBufferSize())
+    return sampleprof_error::malformed;
+
+  // Read the index. Each entry is a function name followed by the offset
+  // of its record. The names point into the profile buffer, so no string
+  // data is copied here.
+  Data = BufStart + IndexOffset;
+  auto NumFunctions = readNumber<unsigned>();
+  if (std::error_code EC = NumFunctions.getError())
+    return EC;
+  for (unsigned I = 0; I < *NumFunctions; ++I) {
+    auto FName(readString());
+    if (std::error_code EC = FName.getError())
+      return EC;
+
+    auto Offset = readNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+    if (*Offset >= IndexOffset)
+      return sampleprof_error::malformed;
+
+    FuncOffsets[*FName] = *Offset;
+  }
+
+  return sampleprof_error::success;
+}
+
+/// \brief Read the record for \p FName, if the index has an entry for it.
+///
+/// Functions absent from the index are not an error; they simply carry
+/// no samples.
+std::error_code SampleProfileReaderIndexed::readFunctionProfile(
+    StringRef FName) {
+  auto Entry = FuncOffsets.find(FName);
+  if (Entry == FuncOffsets.end())
+    return sampleprof_error::success;
+
+  Data = reinterpret_cast<const uint8_t *>(Buffer->getBufferStart()) +
+         Entry->second;
+  return SampleProfileReaderBinary::readFunctionProfile();
+}
+
+std::error_code SampleProfileReaderIndexed::read() {
+  for (const auto &Entry : FuncOffsets)
+    if (std::error_code EC = readFunctionProfile(Entry.getKey()))
+      return EC;
+
+  return sampleprof_error::success;
+}
+
+/// \brief Load only the profiles of functions defined in \p M.
+///
+/// This is what makes the indexed format useful during compilation: a
+/// profile collected over a whole program may describe many more
+/// functions than the module being compiled contains, and none of those
+/// records need to be decoded.
+std::error_code SampleProfileReaderIndexed::read(const Module &M) {
+  for (const auto &F : M)
+    if (!F.isDeclaration())
+      if (std::error_code EC = readFunctionProfile(F.getName()))
+        return EC;
+
+  return sampleprof_error::success;
+}
+
+bool SampleProfileReaderIndexed::hasFormat(const MemoryBuffer &Buffer) {
+  const uint8_t *Data =
+      reinterpret_cast<const uint8_t *>(Buffer.getBufferStart());
+  uint64_t Magic = decodeULEB128(Data);
+  return Magic == SPMagicIndexed();
+}
+
 /// \brief Prepare a memory buffer for the contents of \p Filename.
 ///
 /// \returns an error code indicating the status of the buffer.
@@ -387,7 +495,9 @@ SampleProfileReader::create(StringRef Filename, LLVMContext &C) {
 
   auto Buffer = std::move(BufferOrError.get());
   std::unique_ptr<SampleProfileReader> Reader;
-  if (SampleProfileReaderBinary::hasFormat(*Buffer))
+  if (SampleProfileReaderIndexed::hasFormat(*Buffer))
+    Reader.reset(new SampleProfileReaderIndexed(std::move(Buffer), C));
+  else if (SampleProfileReaderBinary::hasFormat(*Buffer))
     Reader.reset(new SampleProfileReaderBinary(std::move(Buffer), C));
   else
     Reader.reset(new SampleProfileReaderText(std::move(Buffer), C));
@@ -8,10 +8,12 @@
 //===----------------------------------------------------------------------===//
 //
 // This file implements the class that writes LLVM sample profiles. It
-// supports two file formats: text and binary. The textual representation
-// is useful for debugging and testing purposes. The binary representation
-// is more compact, resulting in smaller file sizes. However, they can
-// both be used interchangeably.
+// supports three file formats: text, binary and indexed binary. The
+// textual representation is useful for debugging and testing purposes.
+// The binary representation is more compact, resulting in smaller file
+// sizes. The indexed binary representation appends a function index so
+// readers can load individual function profiles on demand. All formats
+// can be used interchangeably.
 //
 // See lib/ProfileData/SampleProfReader.cpp for documentation on each of the
 // supported formats.
@@ -20,6 +22,7 @@
 
 #include "llvm/ProfileData/SampleProfWriter.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/LineIterator.h"
@@ -56,13 +59,14 @@ bool SampleProfileWriterText::write(StringRef FName, const FunctionSamples &S) {
 }
 
 SampleProfileWriterBinary::SampleProfileWriterBinary(StringRef F,
-                                                     std::error_code &EC)
+                                                     std::error_code &EC,
+                                                     uint64_t Magic)
     : SampleProfileWriter(F, EC, sys::fs::F_None) {
   if (EC)
     return;
 
   // Write the file header.
-  encodeULEB128(SPMagic(), OS);
+  encodeULEB128(Magic, OS);
   encodeULEB128(SPVersion(), OS);
 }
 
@@ -98,6 +102,40 @@ bool SampleProfileWriterBinary::write(StringRef FName,
   return true;
 }
 
+/// \brief Write samples to an indexed binary file.
+///
+/// Records use the binary encoding; in addition, the offset of each
+/// record is remembered so the index can be emitted once the file is
+/// complete.
+///
+/// \returns true if the samples were written successfully, false otherwise.
+bool SampleProfileWriterIndexed::write(StringRef FName,
+                                       const FunctionSamples &S) {
+  if (S.empty())
+    return true;
+
+  IndexEntries.push_back(std::make_pair(FName.str(), OS.tell()));
+  return SampleProfileWriterBinary::write(FName, S);
+}
+
+/// \brief Append the function index to the file.
+///
+/// The index is a ULEB128-encoded entry count followed by one
+/// (null-terminated name, ULEB128 record offset) pair per function. The
+/// last 8 bytes of the file hold the offset of the index as a fixed-width
+/// little-endian integer, so readers can locate it without scanning the
+/// records.
+void SampleProfileWriterIndexed::writeIndex() {
+  uint64_t IndexOffset = OS.tell();
+  encodeULEB128(IndexEntries.size(), OS);
+  for (const auto &Entry : IndexEntries) {
+    OS << Entry.first;
+    encodeULEB128(0, OS);
+    encodeULEB128(Entry.second, OS);
+  }
+  support::endian::Writer<support::little>(OS).write<uint64_t>(IndexOffset);
+}
+
 /// \brief Create a sample profile writer based on the specified format.
 ///
 /// \param Filename The file to create.
@@ -114,6 +152,8 @@ SampleProfileWriter::create(StringRef Filename, SampleProfileFormat Format) {
 
   if (Format == SPF_Binary)
     Writer.reset(new SampleProfileWriterBinary(Filename, EC));
+  else if (Format == SPF_Indexed)
+    Writer.reset(new SampleProfileWriterIndexed(Filename, EC));
   else if (Format == SPF_Text)
     Writer.reset(new SampleProfileWriterText(Filename, EC));
   else
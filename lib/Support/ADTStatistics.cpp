@@ -0,0 +1,56 @@
+//===-- ADTStatistics.cpp - Container instrumentation ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Out-of-line counter hooks for the opt-in ADT statistics mode.  Keeping the
+// Statistic objects here rather than in the container headers keeps those
+// headers free of the -stats machinery and gives one set of counters for the
+// whole process.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "adt"
+#include "llvm/ADT/ADTStatistics.h"
+#include "llvm/ADT/Statistic.h"
+using namespace llvm;
+
+#if LLVM_ENABLE_ADT_STATS
+
+STATISTIC(NumDenseMapGrows, "Number of DenseMap bucket array doublings");
+STATISTIC(NumDenseMapRehashes,
+          "Number of DenseMap same-size rebuilds to purge tombstones");
+STATISTIC(NumDenseMapRehashedEntries,
+          "Number of entries reinserted while rebuilding DenseMap buckets");
+STATISTIC(NumDenseMapLookups, "Number of DenseMap bucket searches");
+STATISTIC(NumDenseMapProbes,
+          "Number of buckets examined across all DenseMap searches");
+STATISTIC(NumSmallVectorGrows, "Number of SmallVector storage grows");
+STATISTIC(NumSmallVectorSpills,
+          "Number of SmallVectors that spilled from inline storage to the "
+          "heap");
+
+void adtstats::countDenseMapGrow() { ++NumDenseMapGrows; }
+
+void adtstats::countDenseMapRehash() { ++NumDenseMapRehashes; }
+
+void adtstats::countDenseMapRehashedEntries(unsigned NumEntries) {
+  NumDenseMapRehashedEntries += NumEntries;
+}
+
+void adtstats::countDenseMapLookup(unsigned ProbeLength) {
+  ++NumDenseMapLookups;
+  NumDenseMapProbes += ProbeLength;
+}
+
+void adtstats::countSmallVectorGrow(bool SpilledFromInline) {
+  ++NumSmallVectorGrows;
+  if (SpilledFromInline)
+    ++NumSmallVectorSpills;
+}
+
+#endif
@@ -231,6 +231,24 @@ APInt& APInt::operator--() {
   return clearUnusedBits();
 }
 
+#ifdef __SIZEOF_INT128__
+/// Compose the two words of a 65-128 bit value into the host's native 128-bit
+/// integer type. ConstantRange and ScalarEvolution constantly widen to 65 or
+/// 128 bits for overflow checks, and the host compiler generates far better
+/// code for native 128-bit arithmetic than for the general word loops, so the
+/// two-word case is special-cased in the hot arithmetic operations below.
+/// @brief Read a two-word value as a native 128-bit integer.
+static inline unsigned __int128 read128(const uint64_t *pVal) {
+  return (unsigned __int128)pVal[1] << 64 | pVal[0];
+}
+
+/// @brief Write a native 128-bit integer back as two 64-bit words.
+static inline void write128(uint64_t *pVal, unsigned __int128 V) {
+  pVal[0] = (uint64_t)V;
+  pVal[1] = (uint64_t)(V >> 64);
+}
+#endif
+
 /// add - This function adds the integer array x to the integer array Y and
 /// places the result in dest.
 /// @returns the carry out from the addition
@@ -253,6 +271,10 @@ APInt& APInt::operator+=(const APInt& RHS) {
   assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
   if (isSingleWord())
     VAL += RHS.VAL;
+#ifdef __SIZEOF_INT128__
+  else if (getNumWords() == 2)
+    write128(pVal, read128(pVal) + read128(RHS.pVal));
+#endif
   else {
     add(pVal, pVal, RHS.pVal, getNumWords());
   }
@@ -280,6 +302,10 @@ APInt& APInt::operator-=(const APInt& RHS) {
   assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
   if (isSingleWord())
     VAL -= RHS.VAL;
+#ifdef __SIZEOF_INT128__
+  else if (getNumWords() == 2)
+    write128(pVal, read128(pVal) - read128(RHS.pVal));
+#endif
   else
     sub(pVal, pVal, RHS.pVal, getNumWords());
   return clearUnusedBits();
@@ -377,6 +403,15 @@ APInt& APInt::operator*=(const APInt& RHS) {
     return *this;
   }
 
+#ifdef __SIZEOF_INT128__
+  if (getNumWords() == 2) {
+    // Two-word case: multiply natively, modulo 2^128, which matches the
+    // truncating semantics below without the scratch allocation.
+    write128(pVal, read128(pVal) * read128(RHS.pVal));
+    return clearUnusedBits();
+  }
+#endif
+
   // Allocate space for the result
   unsigned destWords = rhsWords + lhsWords;
   uint64_t *dest = getMemory(destWords);
@@ -1889,6 +1924,16 @@ APInt APInt::udiv(const APInt& RHS) const {
     return APInt(BitWidth, this->pVal[0] / RHS.pVal[0]);
   }
 
+#ifdef __SIZEOF_INT128__
+  if (lhsWords == 2 && rhsWords <= 2) {
+    // Two active words, divide natively.
+    APInt Quotient(BitWidth, 0);
+    write128(Quotient.pVal, read128(pVal) / (rhsWords == 2 ? read128(RHS.pVal)
+                                                           : RHS.pVal[0]));
+    return Quotient;
+  }
+#endif
+
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
   APInt Quotient(1,0); // to hold result.
   divide(*this, lhsWords, RHS, rhsWords, &Quotient, nullptr);
@@ -1937,6 +1982,16 @@ APInt APInt::urem(const APInt& RHS) const {
     return APInt(BitWidth, pVal[0] % RHS.pVal[0]);
   }
 
+#ifdef __SIZEOF_INT128__
+  if (lhsWords == 2 && rhsWords <= 2) {
+    // Two active words, take the remainder natively.
+    APInt Remainder(BitWidth, 0);
+    write128(Remainder.pVal, read128(pVal) % (rhsWords == 2 ? read128(RHS.pVal)
+                                                            : RHS.pVal[0]));
+    return Remainder;
+  }
+#endif
+
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
   APInt Remainder(1,0);
   divide(*this, lhsWords, RHS, rhsWords, nullptr, &Remainder);
@@ -2002,6 +2057,20 @@ void APInt::udivrem(const APInt &LHS, const APInt &RHS,
     return;
   }
 
+#ifdef __SIZEOF_INT128__
+  if (lhsWords == 2 && rhsWords <= 2) {
+    // Two active words, divide natively.
+    unsigned __int128 Dividend = read128(LHS.pVal);
+    unsigned __int128 Divisor =
+        rhsWords == 2 ? read128(RHS.pVal) : RHS.pVal[0];
+    Quotient = APInt(LHS.BitWidth, 0);
+    write128(Quotient.pVal, Dividend / Divisor);
+    Remainder = APInt(LHS.BitWidth, 0);
+    write128(Remainder.pVal, Dividend % Divisor);
+    return;
+  }
+#endif
+
   // Okay, lets do it the long way
   divide(LHS, lhsWords, RHS, rhsWords, &Quotient, &Remainder);
 }
@@ -61,16 +61,85 @@ zlib::Status zlib::compress(StringRef InputBuffer,
   return Res;
 }
 
-zlib::Status zlib::uncompress(StringRef InputBuffer,
-                              SmallVectorImpl<char> &UncompressedBuffer,
-                              size_t UncompressedSize) {
-  UncompressedBuffer.resize(UncompressedSize);
+zlib::StreamCompressor::StreamCompressor(
+    SmallVectorImpl<char> &CompressedBuffer, CompressionLevel Level)
+    : Strm(nullptr), Out(CompressedBuffer) {
+  z_stream *ZS = new z_stream();
+  if (::deflateInit(ZS, encodeZlibCompressionLevel(Level)) != Z_OK) {
+    delete ZS;
+    return; // Leave Strm null; update() and finish() report the failure.
+  }
+  Strm = ZS;
+}
+
+zlib::StreamCompressor::~StreamCompressor() {
+  if (z_stream *ZS = static_cast<z_stream *>(Strm)) {
+    ::deflateEnd(ZS);
+    delete ZS;
+  }
+}
+
+// Run deflate over the stream's current input, appending whatever output it
+// produces. With Z_FINISH this loops until the stream is fully flushed.
+static zlib::Status deflateToBuffer(z_stream *ZS, SmallVectorImpl<char> &Out,
+                                    int Flush) {
+  const size_t ChunkSize = 4096;
+  int Ret;
+  do {
+    size_t OldSize = Out.size();
+    Out.resize(OldSize + ChunkSize);
+    ZS->next_out = (Bytef *)&Out[OldSize];
+    ZS->avail_out = ChunkSize;
+    Ret = ::deflate(ZS, Flush);
+    // Tell MemorySanitizer that zlib output buffer is fully initialized.
+    // This avoids a false report when running LLVM with uninstrumented ZLib.
+    __msan_unpoison(&Out[OldSize], ChunkSize - ZS->avail_out);
+    Out.resize(OldSize + (ChunkSize - ZS->avail_out));
+    if (Ret == Z_STREAM_ERROR)
+      return zlib::StatusInvalidArg;
+  } while (ZS->avail_out == 0 || (Flush == Z_FINISH && Ret != Z_STREAM_END));
+  return zlib::StatusOK;
+}
+
+zlib::Status zlib::StreamCompressor::update(StringRef Chunk) {
+  z_stream *ZS = static_cast<z_stream *>(Strm);
+  if (!ZS)
+    return StatusOutOfMemory;
+  ZS->next_in = (Bytef *)const_cast<char *>(Chunk.data());
+  ZS->avail_in = Chunk.size();
+  return deflateToBuffer(ZS, Out, Z_NO_FLUSH);
+}
+
+zlib::Status zlib::StreamCompressor::finish() {
+  z_stream *ZS = static_cast<z_stream *>(Strm);
+  if (!ZS)
+    return StatusOutOfMemory;
+  ZS->next_in = nullptr;
+  ZS->avail_in = 0;
+  Status Res = deflateToBuffer(ZS, Out, Z_FINISH);
+  ::deflateEnd(ZS);
+  delete ZS;
+  Strm = nullptr;
+  return Res;
+}
+
+zlib::Status zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                              size_t &UncompressedSize) {
   Status Res = encodeZlibReturnValue(::uncompress(
-      (Bytef *)UncompressedBuffer.data(), (uLongf *)&UncompressedSize,
+      (Bytef *)UncompressedBuffer, (uLongf *)&UncompressedSize,
       (const Bytef *)InputBuffer.data(), InputBuffer.size()));
   // Tell MemorySanitizer that zlib output buffer is fully initialized.
   // This avoids a false report when running LLVM with uninstrumented ZLib.
-  __msan_unpoison(UncompressedBuffer.data(), UncompressedSize);
+  __msan_unpoison(UncompressedBuffer, UncompressedSize);
+  return Res;
+}
+
+zlib::Status zlib::uncompress(StringRef InputBuffer,
+                              SmallVectorImpl<char> &UncompressedBuffer,
+                              size_t UncompressedSize) {
+  UncompressedBuffer.resize(UncompressedSize);
+  Status Res =
+      uncompress(InputBuffer, UncompressedBuffer.data(), UncompressedSize);
   UncompressedBuffer.resize(UncompressedSize);
   return Res;
 }
@@ -86,6 +155,20 @@ zlib::Status zlib::compress(StringRef InputBuffer,
                             CompressionLevel Level) {
   return zlib::StatusUnsupported;
 }
+zlib::StreamCompressor::StreamCompressor(
+    SmallVectorImpl<char> &CompressedBuffer, CompressionLevel Level)
+    : Strm(nullptr), Out(CompressedBuffer) {}
+zlib::StreamCompressor::~StreamCompressor() {}
+zlib::Status zlib::StreamCompressor::update(StringRef Chunk) {
+  return zlib::StatusUnsupported;
+}
+zlib::Status zlib::StreamCompressor::finish() {
+  return zlib::StatusUnsupported;
+}
+zlib::Status zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                              size_t &UncompressedSize) {
+  return zlib::StatusUnsupported;
+}
 zlib::Status zlib::uncompress(StringRef InputBuffer,
                               SmallVectorImpl<char> &UncompressedBuffer,
                               size_t UncompressedSize) {
@@ -8,12 +8,90 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/ConvertUTF.h"
+#include "llvm/Support/DataTypes.h"
 #include "llvm/Support/SwapByteOrder.h"
 #include <string>
 #include <vector>
 
 namespace llvm {
 
+// A machine word of UTF-8 bytes is pure ASCII iff none of its high bits are
+// set.  The mask truncates to the right width on 32-bit hosts.
+static const uintptr_t ASCIIHighBits = (uintptr_t)UINT64_C(0x8080808080808080);
+
+/// Return the length of the leading run of ASCII bytes in [Begin, End).
+/// Checks a machine word at a time once the pointer is aligned, so pure-ASCII
+/// input costs one test per word instead of one per byte.
+static size_t asciiPrefixLength(const UTF8 *Begin, const UTF8 *End) {
+  const UTF8 *Ptr = Begin;
+  while (Ptr != End && (uintptr_t)Ptr % sizeof(uintptr_t)) {
+    if (*Ptr & 0x80)
+      return Ptr - Begin;
+    ++Ptr;
+  }
+  while ((size_t)(End - Ptr) >= sizeof(uintptr_t) &&
+         (*(const uintptr_t *)Ptr & ASCIIHighBits) == 0)
+    Ptr += sizeof(uintptr_t);
+  while (Ptr != End && !(*Ptr & 0x80))
+    ++Ptr;
+  return Ptr - Begin;
+}
+
+/// Return the first ASCII byte in [Begin, End), or End if there is none,
+/// again a machine word at a time.
+static const UTF8 *findASCIIByte(const UTF8 *Begin, const UTF8 *End) {
+  const UTF8 *Ptr = Begin;
+  while (Ptr != End && (uintptr_t)Ptr % sizeof(uintptr_t)) {
+    if (!(*Ptr & 0x80))
+      return Ptr;
+    ++Ptr;
+  }
+  while ((size_t)(End - Ptr) >= sizeof(uintptr_t) &&
+         (~*(const uintptr_t *)Ptr & ASCIIHighBits) == 0)
+    Ptr += sizeof(uintptr_t);
+  while (Ptr != End && (*Ptr & 0x80))
+    ++Ptr;
+  return Ptr;
+}
+
+/// ConvertUTF8toUTF16 with a bulk fast path for ASCII runs.  ASCII needs no
+/// validation or decoder state, so runs of it are widened with a simple loop
+/// the compiler can vectorize; only stretches containing multi-byte sequences
+/// go through the table-driven converter.  Multi-byte sequences never contain
+/// bytes below 0x80, so cutting the input just before an ASCII byte always
+/// falls on a sequence boundary and the scalar converter sees no spurious
+/// truncation.
+static ConversionResult convertUTF8toUTF16Fast(const UTF8 **SourceStart,
+                                               const UTF8 *SourceEnd,
+                                               UTF16 **TargetStart,
+                                               UTF16 *TargetEnd,
+                                               ConversionFlags Flags) {
+  const UTF8 *Src = *SourceStart;
+  UTF16 *Dst = *TargetStart;
+  ConversionResult CR = conversionOK;
+  while (Src < SourceEnd) {
+    size_t NumASCII = asciiPrefixLength(Src, SourceEnd);
+    if ((size_t)(TargetEnd - Dst) < NumASCII) {
+      CR = targetExhausted;
+      break;
+    }
+    for (size_t i = 0; i != NumASCII; ++i)
+      Dst[i] = Src[i];
+    Src += NumASCII;
+    Dst += NumASCII;
+    if (Src == SourceEnd)
+      break;
+
+    const UTF8 *ChunkEnd = findASCIIByte(Src + 1, SourceEnd);
+    CR = ConvertUTF8toUTF16(&Src, ChunkEnd, &Dst, TargetEnd, Flags);
+    if (CR != conversionOK)
+      break;
+  }
+  *SourceStart = Src;
+  *TargetStart = Dst;
+  return CR;
+}
+
 bool ConvertUTF8toWide(unsigned WideCharWidth, llvm::StringRef Source,
                        char *&ResultPtr, const UTF8 *&ErrorPtr) {
   assert(WideCharWidth == 1 || WideCharWidth == 2 || WideCharWidth == 4);
@@ -21,10 +99,21 @@ bool ConvertUTF8toWide(unsigned WideCharWidth, llvm::StringRef Source,
   // Copy the character span over.
   if (WideCharWidth == 1) {
     const UTF8 *Pos = reinterpret_cast<const UTF8*>(Source.begin());
-    if (!isLegalUTF8String(&Pos, reinterpret_cast<const UTF8*>(Source.end()))) {
-      result = sourceIllegal;
-      ErrorPtr = Pos;
-    } else {
+    const UTF8 *End = reinterpret_cast<const UTF8*>(Source.end());
+    // Validate, skipping ASCII runs a machine word at a time; only multi-byte
+    // sequences need the table-driven legality check.
+    while (Pos != End) {
+      Pos += asciiPrefixLength(Pos, End);
+      if (Pos == End)
+        break;
+      if (!isLegalUTF8Sequence(Pos, End)) {
+        result = sourceIllegal;
+        ErrorPtr = Pos;
+        break;
+      }
+      Pos += getNumBytesForUTF8(*Pos);
+    }
+    if (result == conversionOK) {
       memcpy(ResultPtr, Source.data(), Source.size());
       ResultPtr += Source.size();
     }
@@ -34,7 +123,7 @@ bool ConvertUTF8toWide(unsigned WideCharWidth, llvm::StringRef Source,
     // using reinterpret_cast.
     UTF16 *targetStart = reinterpret_cast<UTF16*>(ResultPtr);
     ConversionFlags flags = strictConversion;
-    result = ConvertUTF8toUTF16(
+    result = convertUTF8toUTF16Fast(
         &sourceStart, sourceStart + Source.size(),
         &targetStart, targetStart + 2*Source.size(), flags);
     if (result == conversionOK)
@@ -154,7 +243,7 @@ bool convertUTF8ToUTF16String(StringRef SrcUTF8,
   UTF16 *DstEnd = Dst + DstUTF16.size();
 
   ConversionResult CR =
-      ConvertUTF8toUTF16(&Src, SrcEnd, &Dst, DstEnd, strictConversion);
+      convertUTF8toUTF16Fast(&Src, SrcEnd, &Dst, DstEnd, strictConversion);
   assert(CR != targetExhausted);
 
   if (CR != conversionOK) {
@@ -28,7 +28,24 @@ using namespace llvm;
 /// ComputeHash - Compute a strong hash value for this FoldingSetNodeIDRef,
 /// used to lookup the node in the FoldingSetImpl.
 unsigned FoldingSetNodeIDRef::ComputeHash() const {
-  return static_cast<unsigned>(hash_combine_range(Data, Data+Size));
+  // Almost every ID built for uniquing (SCEVs, selection DAG nodes, attribute
+  // lists) is a kind word plus a couple of pointers. Feed those directly to
+  // the short-key mixers instead of going through the generic range dispatch;
+  // the bytes consumed are the same ones hash_combine_range would hash.
+  const char *Bytes = reinterpret_cast<const char *>(Data);
+  const uint64_t Seed = hashing::detail::get_execution_seed();
+  switch (Size) {
+  case 1:
+  case 2:
+    return static_cast<unsigned>(
+        hashing::detail::hash_4to8_bytes(Bytes, Size * sizeof(*Data), Seed));
+  case 3:
+  case 4:
+    return static_cast<unsigned>(
+        hashing::detail::hash_9to16_bytes(Bytes, Size * sizeof(*Data), Seed));
+  default:
+    return static_cast<unsigned>(hash_combine_range(Data, Data + Size));
+  }
 }
 
 bool FoldingSetNodeIDRef::operator==(FoldingSetNodeIDRef RHS) const {
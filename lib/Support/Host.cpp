@@ -12,8 +12,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Host.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Config/config.h"
@@ -757,6 +759,48 @@ bool sys::getHostCPUFeatures(StringMap<bool> &Features){
 }
 #endif
 
+#if defined(__linux__)
+int sys::getHostNumPhysicalCores() {
+  // /proc/cpuinfo describes each logical CPU together with the package and
+  // core it lives on; the number of distinct (physical id, core id) pairs is
+  // the physical core count.  The file reports a size of zero, so it has to
+  // be read as a stream rather than mapped.
+  int FD;
+  if (sys::fs::openFileForRead("/proc/cpuinfo", FD))
+    return -1;
+  SmallString<4096> Content;
+  char Buf[4096];
+  ssize_t N;
+  while ((N = read(FD, Buf, sizeof(Buf))) > 0)
+    Content.append(Buf, Buf + N);
+  close(FD);
+  if (N < 0)
+    return -1;
+
+  SmallVector<StringRef, 256> Lines;
+  StringRef(Content).split(Lines, "\n");
+
+  StringSet<> Cores;
+  StringRef PhysicalId;
+  for (StringRef Line : Lines) {
+    std::pair<StringRef, StringRef> Parts = Line.split(':');
+    StringRef Key = Parts.first.trim();
+    StringRef Val = Parts.second.trim();
+    if (Key == "physical id")
+      PhysicalId = Val;
+    else if (Key == "core id")
+      Cores.insert((PhysicalId + ":" + Val).str());
+  }
+  if (Cores.empty())
+    return -1;
+  return Cores.size();
+}
+#else
+// Unknown how to query physical cores here; callers fall back to the logical
+// CPU count.
+int sys::getHostNumPhysicalCores() { return -1; }
+#endif
+
 std::string sys::getProcessTriple() {
   Triple PT(Triple::normalize(LLVM_HOST_TRIPLE));
 
@@ -97,8 +97,32 @@ public:
 };
 }
 
+namespace {
+/// MemoryBufferSlice - Named sub-range of another MemoryBuffer, sharing
+/// ownership of the underlying data so that any number of slices can alias
+/// one mapping without copying it.
+class MemoryBufferSlice : public MemoryBuffer {
+  std::shared_ptr<MemoryBuffer> Underlying;
+
+public:
+  MemoryBufferSlice(std::shared_ptr<MemoryBuffer> Underlying, StringRef Data)
+      : Underlying(std::move(Underlying)) {
+    init(Data.begin(), Data.end(), /*RequiresNullTerminator=*/false);
+  }
+
+  const char *getBufferIdentifier() const override {
+    // The name is stored after the class itself.
+    return reinterpret_cast<const char *>(this + 1);
+  }
+
+  BufferKind getBufferKind() const override {
+    return Underlying->getBufferKind();
+  }
+};
+}
+
 static ErrorOr<std::unique_ptr<MemoryBuffer>>
-getFileAux(const Twine &Filename, int64_t FileSize, uint64_t MapSize, 
+getFileAux(const Twine &Filename, int64_t FileSize, uint64_t MapSize,
            uint64_t Offset, bool RequiresNullTerminator, bool IsVolatileSize);
 
 std::unique_ptr<MemoryBuffer>
@@ -115,6 +139,18 @@ MemoryBuffer::getMemBuffer(MemoryBufferRef Ref, bool RequiresNullTerminator) {
       Ref.getBuffer(), Ref.getBufferIdentifier(), RequiresNullTerminator));
 }
 
+std::unique_ptr<MemoryBuffer>
+MemoryBuffer::getSlice(const std::shared_ptr<MemoryBuffer> &Buffer,
+                       uint64_t Offset, uint64_t Length,
+                       const Twine &BufferName) {
+  StringRef Data = Buffer->getBuffer();
+  assert(Offset + Length >= Offset && Offset + Length <= Data.size() &&
+         "Slice is out of bounds!");
+  auto *Ret = new (NamedBufferAlloc(BufferName))
+      MemoryBufferSlice(Buffer, Data.substr(Offset, Length));
+  return std::unique_ptr<MemoryBuffer>(Ret);
+}
+
 std::unique_ptr<MemoryBuffer>
 MemoryBuffer::getMemBufferCopy(StringRef InputData, const Twine &BufferName) {
   std::unique_ptr<MemoryBuffer> Buf =
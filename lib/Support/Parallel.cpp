@@ -0,0 +1,16 @@
+//===- Parallel.cpp - Parallel algorithm support --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/ManagedStatic.h"
+using namespace llvm;
+
+static ManagedStatic<ThreadPool> SharedPool;
+
+ThreadPool &parallel::getPool() { return *SharedPool; }
@@ -0,0 +1,95 @@
+//===- PerfEvent.cpp - Hardware counter access ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the llvm::sys::PerfEvent class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/PerfEvent.h"
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+using namespace llvm::sys;
+
+#if defined(__linux__)
+
+std::error_code PerfEvent::open(EventKind Kind) {
+  struct perf_event_attr Attr;
+  memset(&Attr, 0, sizeof(Attr));
+  Attr.size = sizeof(Attr);
+  Attr.type = PERF_TYPE_HARDWARE;
+  switch (Kind) {
+  case CPUCycles:
+    Attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    break;
+  case InstructionsRetired:
+    Attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    break;
+  }
+  Attr.disabled = 1;
+  Attr.exclude_kernel = 1;
+  Attr.exclude_hv = 1;
+
+  // Count for the calling thread on any CPU. There is no glibc wrapper for
+  // this system call.
+  FD = syscall(__NR_perf_event_open, &Attr, /*pid=*/0, /*cpu=*/-1,
+               /*group_fd=*/-1, /*flags=*/0);
+  if (FD < 0) {
+    FD = -1;
+    return std::error_code(errno, std::generic_category());
+  }
+  return std::error_code();
+}
+
+std::error_code PerfEvent::start() {
+  if (ioctl(FD, PERF_EVENT_IOC_RESET, 0) < 0 ||
+      ioctl(FD, PERF_EVENT_IOC_ENABLE, 0) < 0)
+    return std::error_code(errno, std::generic_category());
+  return std::error_code();
+}
+
+std::error_code PerfEvent::stop(uint64_t &Count) {
+  if (ioctl(FD, PERF_EVENT_IOC_DISABLE, 0) < 0)
+    return std::error_code(errno, std::generic_category());
+  if (::read(FD, &Count, sizeof(Count)) != sizeof(Count))
+    return std::error_code(errno, std::generic_category());
+  return std::error_code();
+}
+
+PerfEvent::~PerfEvent() {
+  if (FD != -1)
+    ::close(FD);
+}
+
+#else
+
+std::error_code PerfEvent::open(EventKind Kind) {
+  (void)Kind;
+  return std::make_error_code(std::errc::function_not_supported);
+}
+
+std::error_code PerfEvent::start() {
+  return std::make_error_code(std::errc::function_not_supported);
+}
+
+std::error_code PerfEvent::stop(uint64_t &Count) {
+  (void)Count;
+  return std::make_error_code(std::errc::function_not_supported);
+}
+
+PerfEvent::~PerfEvent() {}
+
+#endif
@@ -0,0 +1,132 @@
+//===- RemarkStream.cpp - Binary remark stream ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the writer and reader for the binary remark stream
+// format described in llvm/Support/RemarkStream.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/RemarkStream.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+// Eight byte header: format name and a version digit.
+static const char RemarkStreamMagic[] = "LLVMRMK1";
+
+RemarkStreamWriter::RemarkStreamWriter(raw_ostream &OS) : OS(OS) {
+  OS << StringRef(RemarkStreamMagic, 8);
+}
+
+unsigned RemarkStreamWriter::getStringID(StringRef Str) {
+  unsigned NextID = StringIDs.size();
+  auto Ins = StringIDs.insert(std::make_pair(Str, NextID));
+  if (Ins.second) {
+    encodeULEB128(RS_String, OS);
+    encodeULEB128(Str.size(), OS);
+    OS << Str;
+  }
+  return Ins.first->second;
+}
+
+void RemarkStreamWriter::emitRemark(StringRef PassName, StringRef FunctionName,
+                                    StringRef File, unsigned Line,
+                                    unsigned Column, StringRef Message) {
+  // Intern the strings first so their definitions precede the record that
+  // references them.
+  unsigned PassID = getStringID(PassName);
+  unsigned FnID = getStringID(FunctionName);
+  unsigned FileID = File.empty() ? 0 : getStringID(File) + 1;
+
+  encodeULEB128(RS_Remark, OS);
+  encodeULEB128(PassID, OS);
+  encodeULEB128(FnID, OS);
+  encodeULEB128(FileID, OS);
+  encodeULEB128(Line, OS);
+  encodeULEB128(Column, OS);
+  encodeULEB128(Message.size(), OS);
+  OS << Message;
+}
+
+RemarkStreamReader::RemarkStreamReader(StringRef Buffer)
+    : Buffer(Buffer), Pos(0), Malformed(false) {
+  if (Buffer.size() < 8 ||
+      !Buffer.startswith(StringRef(RemarkStreamMagic, 8))) {
+    Malformed = true;
+    return;
+  }
+  Pos = 8;
+}
+
+bool RemarkStreamReader::readULEB(uint64_t &Value) {
+  Value = 0;
+  unsigned Shift = 0;
+  uint8_t Byte;
+  do {
+    if (Pos == Buffer.size() || Shift >= 64) {
+      Malformed = true;
+      return false;
+    }
+    Byte = Buffer[Pos++];
+    Value |= uint64_t(Byte & 0x7f) << Shift;
+    Shift += 7;
+  } while (Byte >= 128);
+  return true;
+}
+
+bool RemarkStreamReader::readBytes(uint64_t Size, StringRef &Str) {
+  if (Size > Buffer.size() - Pos) {
+    Malformed = true;
+    return false;
+  }
+  Str = Buffer.substr(Pos, Size);
+  Pos += Size;
+  return true;
+}
+
+bool RemarkStreamReader::readRemark(RemarkRecord &R) {
+  while (!Malformed && Pos != Buffer.size()) {
+    uint64_t Kind;
+    if (!readULEB(Kind))
+      return false;
+
+    if (Kind == RS_String) {
+      uint64_t Size;
+      StringRef Str;
+      if (!readULEB(Size) || !readBytes(Size, Str))
+        return false;
+      Strings.push_back(Str);
+      continue;
+    }
+
+    if (Kind != RS_Remark) {
+      Malformed = true;
+      return false;
+    }
+
+    uint64_t PassID, FnID, FileID, Line, Column, MsgSize;
+    if (!readULEB(PassID) || !readULEB(FnID) || !readULEB(FileID) ||
+        !readULEB(Line) || !readULEB(Column) || !readULEB(MsgSize))
+      return false;
+    if (PassID >= Strings.size() || FnID >= Strings.size() ||
+        FileID > Strings.size()) {
+      Malformed = true;
+      return false;
+    }
+
+    R.PassName = Strings[PassID];
+    R.FunctionName = Strings[FnID];
+    R.File = FileID ? Strings[FileID - 1] : StringRef();
+    R.Line = Line;
+    R.Column = Column;
+    return readBytes(MsgSize, R.Message);
+  }
+  return false;
+}
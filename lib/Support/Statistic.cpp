@@ -65,6 +65,88 @@ public:
 static ManagedStatic<StatisticInfo> StatInfo;
 static ManagedStatic<sys::SmartMutex<true> > StatLock;
 
+#if LLVM_ENABLE_THREADS && (!defined(NDEBUG) || defined(LLVM_ENABLE_STATS))
+namespace llvm {
+namespace stats_detail {
+LLVM_THREAD_LOCAL StatisticBucket *ThreadBucket = nullptr;
+}
+}
+
+/// Head of the list of every thread's bucket, chained through the Next
+/// fields and guarded by StatLock.  Buckets are never freed: a thread may
+/// exit with deltas still buffered, and those are folded in when the
+/// statistics are printed.
+static stats_detail::StatisticBucket *BucketList = nullptr;
+
+stats_detail::StatisticBucket *stats_detail::claimBucket() {
+  StatisticBucket *B = new StatisticBucket();
+  sys::SmartScopedLock<true> Guard(*StatLock);
+  B->Next = BucketList;
+  BucketList = B;
+  ThreadBucket = B;
+  return B;
+}
+
+void Statistic::evictAndOccupy(stats_detail::StatisticSlot &S, int64_t V) {
+  if (Statistic *Old = S.Stat) {
+    sys::AtomicAdd(&Old->Value, (sys::cas_flag)S.Delta);
+    Old->init();
+  }
+  S.Stat = this;
+  S.Delta = V;
+}
+
+void Statistic::flushPending() {
+  stats_detail::StatisticBucket *B = stats_detail::ThreadBucket;
+  if (!B)
+    return;
+  stats_detail::StatisticSlot &S = B->Slots[bucketIndex()];
+  if (S.Stat != this)
+    return;
+  sys::AtomicAdd(&Value, (sys::cas_flag)S.Delta);
+  S.Stat = nullptr;
+  S.Delta = 0;
+}
+
+void Statistic::discardPending() {
+  stats_detail::StatisticBucket *B = stats_detail::ThreadBucket;
+  if (!B)
+    return;
+  stats_detail::StatisticSlot &S = B->Slots[bucketIndex()];
+  if (S.Stat != this)
+    return;
+  S.Stat = nullptr;
+  S.Delta = 0;
+}
+
+/// FlushBucketedCounts - Fold every pending per-thread delta into its
+/// statistic and register statistics that were only ever updated through
+/// their buckets.  Registration is done by hand here because
+/// RegisterStatistic would re-acquire StatLock.  This must not race with
+/// threads that are still updating counters; it runs when statistics are
+/// printed, after the parallel work has finished.
+static void FlushBucketedCounts() {
+  sys::SmartScopedLock<true> Guard(*StatLock);
+  for (stats_detail::StatisticBucket *B = BucketList; B; B = B->Next) {
+    for (unsigned I = 0; I != stats_detail::StatisticBucket::NumSlots; ++I) {
+      stats_detail::StatisticSlot &S = B->Slots[I];
+      if (!S.Stat)
+        continue;
+      S.Stat->Value += (sys::cas_flag)S.Delta;
+      if (!S.Stat->Initialized) {
+        if (Enabled)
+          StatInfo->addStatistic(S.Stat);
+        S.Stat->Initialized = true;
+      }
+      S.Stat = nullptr;
+      S.Delta = 0;
+    }
+  }
+}
+#else
+static void FlushBucketedCounts() {}
+#endif
+
 /// RegisterStatistic - The first time a statistic is bumped, this method is
 /// called.
 void Statistic::RegisterStatistic() {
@@ -98,6 +180,7 @@ bool llvm::AreStatisticsEnabled() {
 }
 
 void llvm::PrintStatistics(raw_ostream &OS) {
+  FlushBucketedCounts();
   StatisticInfo &Stats = *StatInfo;
 
   // Figure out how long the biggest Value and Name fields are.
@@ -138,6 +221,9 @@ void llvm::PrintStatistics(raw_ostream &OS) {
 
 void llvm::PrintStatistics() {
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
+  // Fold pending per-thread deltas first; a statistic that was only ever
+  // updated through its bucket is not registered until this point.
+  FlushBucketedCounts();
   StatisticInfo &Stats = *StatInfo;
 
   // Statistics not enabled?
@@ -34,6 +34,7 @@ public:
   bool isValidAddress(uint64_t address) const override {
     return validAddress(address);
   }
+  bool isContiguous() const override { return true; }
 
 private:
   const uint8_t* const FirstChar;
@@ -9,16 +9,76 @@
 
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <cassert>
+#include <cstring>
 #include <vector>
 using namespace llvm;
 
 // Clients are responsible for avoid race conditions in registration.
 static Target *FirstTarget = nullptr;
 
+namespace llvm {
+/// A frozen index of the registered targets.
+///
+/// The target list is only modified during the InitializeAll* style entry
+/// points at startup, but lookupTarget is hot: it runs for every
+/// TargetMachine created, and walking the list calls each target's
+/// ArchMatchFn. The index answers both lookup flavors with a single hash or
+/// array access. It is built lazily on the first lookup after a registration.
+struct TargetRegistrySnapshot {
+  /// Targets indexed by their registered name.
+  StringMap<const Target *> TargetsByName;
+
+  /// The unique target matching each Triple::ArchType, if any. There is no
+  /// LastArchType enumerator; kalimba is the final architecture.
+  const Target *TargetsByArch[Triple::kalimba + 1];
+
+  /// Architectures claimed by more than one target. Lookups for these fall
+  /// back to the list walk, which names the clashing targets in its error.
+  bool ArchIsAmbiguous[Triple::kalimba + 1];
+
+  TargetRegistrySnapshot() {
+    std::memset(TargetsByArch, 0, sizeof(TargetsByArch));
+    std::memset(ArchIsAmbiguous, 0, sizeof(ArchIsAmbiguous));
+    for (const Target *T = FirstTarget; T; T = T->Next) {
+      TargetsByName[T->Name] = T;
+      for (unsigned Arch = 0; Arch <= Triple::kalimba; ++Arch)
+        if (T->ArchMatchFn(Triple::ArchType(Arch))) {
+          if (TargetsByArch[Arch])
+            ArchIsAmbiguous[Arch] = true;
+          else
+            TargetsByArch[Arch] = T;
+        }
+    }
+  }
+};
+}
+
+static std::atomic<TargetRegistrySnapshot *> CurrentSnapshot;
+
+static TargetRegistrySnapshot *getSnapshot() {
+  TargetRegistrySnapshot *S = CurrentSnapshot.load(std::memory_order_acquire);
+  if (S)
+    return S;
+
+  // Concurrent lookups may race to build the first index; the loser's copy
+  // is discarded.
+  S = new TargetRegistrySnapshot();
+  TargetRegistrySnapshot *Existing = nullptr;
+  if (!CurrentSnapshot.compare_exchange_strong(Existing, S,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+    delete S;
+    S = Existing;
+  }
+  return S;
+}
+
 TargetRegistry::iterator TargetRegistry::begin() {
   return iterator(FirstTarget);
 }
@@ -31,13 +91,7 @@ const Target *TargetRegistry::lookupTarget(const std::string &ArchName,
   // name, because it might be a backend that has no mapping to a target triple.
   const Target *TheTarget = nullptr;
   if (!ArchName.empty()) {
-    for (TargetRegistry::iterator it = TargetRegistry::begin(),
-           ie = TargetRegistry::end(); it != ie; ++it) {
-      if (ArchName == it->getName()) {
-        TheTarget = &*it;
-        break;
-      }
-    }
+    TheTarget = getSnapshot()->TargetsByName.lookup(ArchName);
 
     if (!TheTarget) {
       Error = "error: invalid target '" + ArchName + "'.\n";
@@ -71,19 +125,26 @@ const Target *TargetRegistry::lookupTarget(const std::string &TT,
     Error = "Unable to find target for this triple (no targets are registered)";
     return nullptr;
   }
-  const Target *Matching = nullptr;
   Triple::ArchType Arch =  Triple(TT).getArch();
-  for (iterator it = begin(), ie = end(); it != ie; ++it) {
-    if (it->ArchMatchFn(Arch)) {
-      if (Matching) {
-        Error = std::string("Cannot choose between targets \"") +
-          Matching->Name  + "\" and \"" + it->Name + "\"";
-        return nullptr;
+  const TargetRegistrySnapshot &S = *getSnapshot();
+
+  // Ambiguous matches are always an error; take the old list walk so the
+  // diagnostic can name the clashing targets.
+  if (S.ArchIsAmbiguous[Arch]) {
+    const Target *Matching = nullptr;
+    for (iterator it = begin(), ie = end(); it != ie; ++it) {
+      if (it->ArchMatchFn(Arch)) {
+        if (Matching) {
+          Error = std::string("Cannot choose between targets \"") +
+            Matching->Name  + "\" and \"" + it->Name + "\"";
+          return nullptr;
+        }
+        Matching = &*it;
       }
-      Matching = &*it;
     }
   }
 
+  const Target *Matching = S.TargetsByArch[Arch];
   if (!Matching) {
     Error = "No available targets are compatible with this triple, "
       "see -version for the available targets.";
@@ -110,6 +171,11 @@ void TargetRegistry::RegisterTarget(Target &T,
   T.Next = FirstTarget;
   FirstTarget = &T;
 
+  // Drop any existing lookup index; it is rebuilt on the next lookup.
+  // Registration does not race with lookups (see the comment on
+  // FirstTarget), so nobody can still be reading the old index.
+  delete CurrentSnapshot.exchange(nullptr);
+
   T.Name = Name;
   T.ShortDesc = ShortDesc;
   T.ArchMatchFn = ArchMatchFn;
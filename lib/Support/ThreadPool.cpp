@@ -0,0 +1,109 @@
+//===-- ThreadPool.cpp - A ThreadPool implementation ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a crude C++11 based thread pool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Host.h"
+#include <cassert>
+using namespace llvm;
+
+static unsigned getDefaultThreadCount() {
+  int NumPhysical = sys::getHostNumPhysicalCores();
+  if (NumPhysical > 0)
+    return NumPhysical;
+  unsigned NumLogical = std::thread::hardware_concurrency();
+  return NumLogical ? NumLogical : 1;
+}
+
+ThreadPool::ThreadPool() : ThreadPool(getDefaultThreadCount()) {}
+
+#if LLVM_ENABLE_THREADS
+
+ThreadPool::ThreadPool(unsigned ThreadCount)
+    : ThreadCount(ThreadCount), ActiveThreads(0), EnableFlag(true) {
+  Threads.reserve(ThreadCount);
+  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
+    Threads.emplace_back([&] {
+      while (true) {
+        std::packaged_task<void()> Task;
+        {
+          std::unique_lock<std::mutex> LockGuard(QueueLock);
+          QueueCondition.wait(LockGuard,
+                              [&] { return !EnableFlag || !Tasks.empty(); });
+          // Exit once the queue is drained and the pool is shutting down.
+          if (!EnableFlag && Tasks.empty())
+            return;
+          // Flag the thread busy under the lock so that wait() cannot
+          // observe an empty queue while the task is still in flight.
+          ++ActiveThreads;
+          Task = std::move(Tasks.front());
+          Tasks.pop_front();
+        }
+        Task();
+        {
+          std::unique_lock<std::mutex> LockGuard(QueueLock);
+          --ActiveThreads;
+        }
+        CompletionCondition.notify_all();
+      }
+    });
+  }
+}
+
+std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
+  std::packaged_task<void()> PackagedTask(std::move(Task));
+  std::shared_future<void> Future = PackagedTask.get_future().share();
+  {
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    assert(EnableFlag && "Queuing a task during ThreadPool destruction");
+    Tasks.push_back(std::move(PackagedTask));
+  }
+  QueueCondition.notify_one();
+  return Future;
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> LockGuard(QueueLock);
+  CompletionCondition.wait(LockGuard,
+                           [&] { return Tasks.empty() && !ActiveThreads; });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    EnableFlag = false;
+  }
+  QueueCondition.notify_all();
+  for (std::thread &Worker : Threads)
+    Worker.join();
+}
+
+#else // LLVM_ENABLE_THREADS
+
+// No threads are launched; tasks run serially on submission and the futures
+// are already satisfied by the time the caller gets them back.
+
+ThreadPool::ThreadPool(unsigned ThreadCount)
+    : ThreadCount(ThreadCount), ActiveThreads(0), EnableFlag(true) {}
+
+std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
+  std::packaged_task<void()> PackagedTask(std::move(Task));
+  PackagedTask();
+  return PackagedTask.get_future().share();
+}
+
+void ThreadPool::wait() {}
+
+ThreadPool::~ThreadPool() {}
+
+#endif
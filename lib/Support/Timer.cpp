@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Timer.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -22,6 +23,7 @@
 #include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
 using namespace llvm;
 
 // CreateInfoOutputFile - Return a file stream to print our output on.
@@ -42,6 +44,53 @@ static std::string &getLibSupportInfoOutputFilename() {
 
 static ManagedStatic<sys::SmartMutex<true> > TimerLock;
 
+namespace {
+  /// ThreadTimerData - Per-thread accumulation of timer intervals.  Each
+  /// thread that starts a timer gets one of these; startTimer/stopTimer only
+  /// ever touch the calling thread's block, so concurrent timing on different
+  /// threads does not serialize through a shared lock.  The per-block lock is
+  /// only contended when a report aggregates the contributions.
+  struct ThreadTimerData {
+    sys::SmartMutex<true> Lock;
+    DenseMap<Timer*, TimeRecord> Contributions;
+    ThreadTimerData *Next;
+  };
+}
+
+/// ThreadTimerList - Global list of the per-thread blocks so reports can
+/// aggregate them, protected by TimerLock.  The blocks are never freed:
+/// aggregation may run after the owning thread has exited, and a surviving
+/// block costs a few hundred bytes per thread that ever timed something.
+static ThreadTimerData *ThreadTimerList = nullptr;
+static LLVM_THREAD_LOCAL ThreadTimerData *ThreadData = nullptr;
+
+static ThreadTimerData &getThreadTimerData() {
+  if (!ThreadData) {
+    ThreadTimerData *TTD = new ThreadTimerData();
+    sys::SmartScopedLock<true> L(*TimerLock);
+    TTD->Next = ThreadTimerList;
+    ThreadTimerList = TTD;
+    ThreadData = TTD;
+  }
+  return *ThreadData;
+}
+
+/// takeThreadContributions - Sum and remove the intervals every thread has
+/// accumulated for T.  Must be called with TimerLock held, and only for a
+/// timer that is not running on any thread.
+static TimeRecord takeThreadContributions(Timer &T) {
+  TimeRecord Total;
+  for (ThreadTimerData *TTD = ThreadTimerList; TTD; TTD = TTD->Next) {
+    sys::SmartScopedLock<true> L(TTD->Lock);
+    DenseMap<Timer*, TimeRecord>::iterator I = TTD->Contributions.find(&T);
+    if (I != TTD->Contributions.end()) {
+      Total += I->second;
+      TTD->Contributions.erase(I);
+    }
+  }
+  return Total;
+}
+
 namespace {
   static cl::opt<bool>
   TrackSpace("track-memory", cl::desc("Enable -time-passes memory "
@@ -52,6 +101,12 @@ namespace {
   InfoOutputFilename("info-output-file", cl::value_desc("filename"),
                      cl::desc("File to append -stats and -timer output to"),
                    cl::Hidden, cl::location(getLibSupportInfoOutputFilename()));
+
+  static cl::opt<bool>
+  InfoOutputJSON("info-output-json",
+                 cl::desc("Emit -timer output as JSON objects instead of "
+                          "formatted tables"),
+                 cl::Hidden);
 }
 
 // CreateInfoOutputFile - Return a file stream to print our output on.
@@ -144,25 +199,35 @@ TimeRecord TimeRecord::getCurrentTime(bool Start) {
   return Result;
 }
 
-static ManagedStatic<std::vector<Timer*> > ActiveTimers;
-
 void Timer::startTimer() {
   Started = true;
-  ActiveTimers->push_back(this);
-  Time -= TimeRecord::getCurrentTime(true);
+  ThreadTimerData &TTD = getThreadTimerData();
+  sys::SmartScopedLock<true> L(TTD.Lock);
+  TTD.Contributions[this] -= TimeRecord::getCurrentTime(true);
 }
 
 void Timer::stopTimer() {
-  Time += TimeRecord::getCurrentTime(false);
+  TimeRecord Now = TimeRecord::getCurrentTime(false);
+  ThreadTimerData &TTD = getThreadTimerData();
+  sys::SmartScopedLock<true> L(TTD.Lock);
+  TTD.Contributions[this] += Now;
+}
 
-  if (ActiveTimers->back() == this) {
-    ActiveTimers->pop_back();
-  } else {
-    std::vector<Timer*>::iterator I =
-      std::find(ActiveTimers->begin(), ActiveTimers->end(), this);
-    assert(I != ActiveTimers->end() && "stop but no startTimer?");
-    ActiveTimers->erase(I);
-  }
+//===----------------------------------------------------------------------===//
+// FineTimer Implementation
+//===----------------------------------------------------------------------===//
+
+static uint64_t getMonotonicNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FineTimer::startTimer() {
+  StartNanos = getMonotonicNanos();
+}
+
+void FineTimer::stopTimer() {
+  TotalNanos += getMonotonicNanos() - StartNanos;
 }
 
 static void printVal(double Val, double Total, raw_ostream &OS) {
@@ -280,8 +345,11 @@ void TimerGroup::removeTimer(Timer &T) {
   sys::SmartScopedLock<true> L(*TimerLock);
   
   // If the timer was started, move its data to TimersToPrint.
-  if (T.Started)
-    TimersToPrint.push_back(std::make_pair(T.Time, T.Name));
+  if (T.Started) {
+    TimeRecord TR = takeThreadContributions(T);
+    TR += T.Time;
+    TimersToPrint.push_back(std::make_pair(TR, T.Name));
+  }
 
   T.TG = nullptr;
   
@@ -296,7 +364,10 @@ void TimerGroup::removeTimer(Timer &T) {
     return;
   
   raw_ostream *OutStream = CreateInfoOutputFile();
-  PrintQueuedTimers(*OutStream);
+  if (InfoOutputJSON)
+    PrintQueuedTimersJSON(*OutStream);
+  else
+    PrintQueuedTimers(*OutStream);
   delete OutStream;   // Close the file.
 }
 
@@ -360,6 +431,62 @@ void TimerGroup::PrintQueuedTimers(raw_ostream &OS) {
   TimersToPrint.clear();
 }
 
+/// printJSONString - Print S as a double-quoted JSON string, escaping the
+/// characters JSON requires to be escaped.
+static void printJSONString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (unsigned i = 0, e = S.size(); i != e; ++i) {
+    unsigned char C = S[i];
+    if (C == '"' || C == '\\')
+      OS << '\\' << (char)C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", (unsigned)C);
+    else
+      OS << (char)C;
+  }
+  OS << '"';
+}
+
+void TimerGroup::PrintQueuedTimersJSON(raw_ostream &OS) {
+  // Sort the timers in descending order by amount of time taken.
+  std::sort(TimersToPrint.begin(), TimersToPrint.end());
+
+  TimeRecord Total;
+  for (unsigned i = 0, e = TimersToPrint.size(); i != e; ++i)
+    Total += TimersToPrint[i].first;
+
+  // Emit one complete object per line so appended reports stay parseable.
+  OS << '{';
+  printJSONString(OS, "group");
+  OS << ": ";
+  printJSONString(OS, Name);
+  OS << ", ";
+  printJSONString(OS, "timers");
+  OS << ": {";
+  for (unsigned i = 0, e = TimersToPrint.size(); i != e; ++i) {
+    const std::pair<TimeRecord, std::string> &Entry = TimersToPrint[e-i-1];
+    if (i) OS << ", ";
+    printJSONString(OS, Entry.second);
+    OS << format(": {\"wall\": %.6f, \"user\": %.6f, \"sys\": %.6f",
+                 Entry.first.getWallTime(), Entry.first.getUserTime(),
+                 Entry.first.getSystemTime());
+    if (Total.getMemUsed())
+      OS << format(", \"mem\": %" PRId64, (int64_t)Entry.first.getMemUsed());
+    OS << '}';
+  }
+  OS << "}, ";
+  printJSONString(OS, "total");
+  OS << format(": {\"wall\": %.6f, \"user\": %.6f, \"sys\": %.6f",
+               Total.getWallTime(), Total.getUserTime(),
+               Total.getSystemTime());
+  if (Total.getMemUsed())
+    OS << format(", \"mem\": %" PRId64, (int64_t)Total.getMemUsed());
+  OS << "}}\n";
+  OS.flush();
+
+  TimersToPrint.clear();
+}
+
 /// print - Print any started timers in this group and zero them.
 void TimerGroup::print(raw_ostream &OS) {
   sys::SmartScopedLock<true> L(*TimerLock);
@@ -368,8 +495,10 @@ void TimerGroup::print(raw_ostream &OS) {
   // reset them.
   for (Timer *T = FirstTimer; T; T = T->Next) {
     if (!T->Started) continue;
-    TimersToPrint.push_back(std::make_pair(T->Time, T->Name));
-    
+    TimeRecord TR = takeThreadContributions(*T);
+    TR += T->Time;
+    TimersToPrint.push_back(std::make_pair(TR, T->Name));
+
     // Clear out the time.
     T->Started = 0;
     T->Time = TimeRecord();
@@ -387,3 +516,34 @@ void TimerGroup::printAll(raw_ostream &OS) {
   for (TimerGroup *TG = TimerGroupList; TG; TG = TG->Next)
     TG->print(OS);
 }
+
+/// printJSON - Print any started timers in this group as JSON and zero them.
+void TimerGroup::printJSON(raw_ostream &OS) {
+  sys::SmartScopedLock<true> L(*TimerLock);
+
+  // See if any of our timers were started, if so add them to TimersToPrint and
+  // reset them.
+  for (Timer *T = FirstTimer; T; T = T->Next) {
+    if (!T->Started) continue;
+    TimeRecord TR = takeThreadContributions(*T);
+    TR += T->Time;
+    TimersToPrint.push_back(std::make_pair(TR, T->Name));
+
+    // Clear out the time.
+    T->Started = 0;
+    T->Time = TimeRecord();
+  }
+
+  // If any timers were started, print the group.
+  if (!TimersToPrint.empty())
+    PrintQueuedTimersJSON(OS);
+}
+
+/// printAllJSON - This static method prints all timers as JSON and clears
+/// them all out.
+void TimerGroup::printAllJSON(raw_ostream &OS) {
+  sys::SmartScopedLock<true> L(*TimerLock);
+
+  for (TimerGroup *TG = TimerGroupList; TG; TG = TG->Next)
+    TG->printJSON(OS);
+}
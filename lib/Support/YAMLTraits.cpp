@@ -490,8 +490,7 @@ bool Output::preflightFlowElement(unsigned, void *&) {
     output(", ");
   if (Column > 70) {
     output("\n");
-    for (int i = 0; i < ColumnAtFlowStart; ++i)
-      output(" ");
+    padding(ColumnAtFlowStart);
     Column = ColumnAtFlowStart;
     output("  ");
   }
@@ -635,15 +634,26 @@ void Output::newLineCheck() {
     OutputDash = true;
   }
 
-  for (unsigned i = 0; i < Indent; ++i) {
-    output("  ");
-  }
+  padding(Indent * 2);
   if (OutputDash) {
     output("- ");
   }
 
 }
 
+// Emit Count spaces in chunks from a constant table instead of one write
+// per character.  Indentation dominates the output of deeply nested
+// documents.
+void Output::padding(unsigned Count) {
+  static const char Blanks[] = "                                ";
+  const unsigned ChunkSize = sizeof(Blanks) - 1;
+  while (Count > ChunkSize) {
+    output(StringRef(Blanks, ChunkSize));
+    Count -= ChunkSize;
+  }
+  output(StringRef(Blanks, Count));
+}
+
 void Output::paddedKey(StringRef key) {
   output(key);
   output(":");
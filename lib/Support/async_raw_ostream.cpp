@@ -0,0 +1,70 @@
+//===- async_raw_ostream.cpp - Asynchronously drained stream --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements support for the asynchronously drained stream.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/async_raw_ostream.h"
+
+using namespace llvm;
+
+async_raw_ostream::async_raw_ostream(raw_ostream &OS)
+    : OS(OS), Done(false), WriterBusy(false), Pos(OS.tell()) {
+  Writer = std::thread([this] { writerLoop(); });
+}
+
+async_raw_ostream::~async_raw_ostream() {
+  // Push whatever is left in our raw_ostream buffer into Pending, then wake
+  // the writer for the last time and wait for it.
+  flush();
+  {
+    std::unique_lock<std::mutex> Lock(Mtx);
+    Done = true;
+  }
+  WorkAvailable.notify_one();
+  Writer.join();
+  OS.flush();
+}
+
+void async_raw_ostream::write_impl(const char *Ptr, size_t Size) {
+  {
+    std::unique_lock<std::mutex> Lock(Mtx);
+    Pending.append(Ptr, Ptr + Size);
+  }
+  WorkAvailable.notify_one();
+  Pos += Size;
+}
+
+void async_raw_ostream::drain() {
+  flush();
+  std::unique_lock<std::mutex> Lock(Mtx);
+  Drained.wait(Lock, [this] { return Pending.empty() && !WriterBusy; });
+  OS.flush();
+}
+
+void async_raw_ostream::writerLoop() {
+  SmallVector<char, 0> Local;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> Lock(Mtx);
+      WriterBusy = false;
+      Drained.notify_all();
+      WorkAvailable.wait(Lock, [this] { return Done || !Pending.empty(); });
+      if (Pending.empty() && Done)
+        return;
+      // Take the filled buffer and hand our drained one back, so the
+      // producer never waits on I/O and allocations are recycled.
+      Local.clear();
+      Local.swap(Pending);
+      WriterBusy = true;
+    }
+    OS.write(Local.data(), Local.size());
+  }
+}
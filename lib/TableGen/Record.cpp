@@ -761,75 +761,23 @@ UnOpInit *UnOpInit::get(UnaryOp opc, Init *lhs, RecTy *Type) {
   return I;
 }
 
-Init *UnOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
-  switch (getOpcode()) {
-  case CAST: {
-    if (getType()->getAsString() == "string") {
-      if (StringInit *LHSs = dyn_cast<StringInit>(LHS))
-        return LHSs;
-
-      if (DefInit *LHSd = dyn_cast<DefInit>(LHS))
-        return StringInit::get(LHSd->getDef()->getName());
-
-      if (IntInit *LHSi = dyn_cast<IntInit>(LHS))
-        return StringInit::get(LHSi->getAsString());
-    } else {
-      if (StringInit *LHSs = dyn_cast<StringInit>(LHS)) {
-        std::string Name = LHSs->getValue();
-
-        // From TGParser::ParseIDValue
-        if (CurRec) {
-          if (const RecordVal *RV = CurRec->getValue(Name)) {
-            if (RV->getType() != getType())
-              PrintFatalError("type mismatch in cast");
-            return VarInit::get(Name, RV->getType());
-          }
-
-          Init *TemplateArgName = QualifyName(*CurRec, CurMultiClass, Name,
-                                              ":");
-      
-          if (CurRec->isTemplateArg(TemplateArgName)) {
-            const RecordVal *RV = CurRec->getValue(TemplateArgName);
-            assert(RV && "Template arg doesn't exist??");
-
-            if (RV->getType() != getType())
-              PrintFatalError("type mismatch in cast");
-
-            return VarInit::get(TemplateArgName, RV->getType());
-          }
-        }
-
-        if (CurMultiClass) {
-          Init *MCName = QualifyName(CurMultiClass->Rec, CurMultiClass, Name, "::");
-
-          if (CurMultiClass->Rec.isTemplateArg(MCName)) {
-            const RecordVal *RV = CurMultiClass->Rec.getValue(MCName);
-            assert(RV && "Template arg doesn't exist??");
-
-            if (RV->getType() != getType())
-              PrintFatalError("type mismatch in cast");
-
-            return VarInit::get(MCName, RV->getType());
-          }
-        }
-        assert(CurRec && "NULL pointer");
-        if (Record *D = (CurRec->getRecords()).getDef(Name))
-          return DefInit::get(D);
-
-        PrintFatalError(CurRec->getLoc(),
-                        "Undefined reference:'" + Name + "'\n");
-      }
-    }
-    break;
-  }
-  case HEAD: {
+// Fold !head, !tail or !empty, or return null if the operand is not resolved
+// enough yet. These are context free like the binary operators; !cast is
+// handled separately in Fold because it resolves names against the enclosing
+// record and the record keeper.
+static Init *foldUnOp(const UnOpInit *I) {
+  Init *LHS = I->getOperand();
+  switch (I->getOpcode()) {
+  case UnOpInit::CAST:
+    llvm_unreachable("!cast is not context free");
+  case UnOpInit::HEAD: {
     if (ListInit *LHSl = dyn_cast<ListInit>(LHS)) {
       assert(LHSl->getSize() != 0 && "Empty list in car");
       return LHSl->getElement(0);
     }
     break;
   }
-  case TAIL: {
+  case UnOpInit::TAIL: {
     if (ListInit *LHSl = dyn_cast<ListInit>(LHS)) {
       assert(LHSl->getSize() != 0 && "Empty list in cdr");
       // Note the +1.  We can't just pass the result of getValues()
@@ -843,7 +791,7 @@ Init *UnOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
     }
     break;
   }
-  case EMPTY: {
+  case UnOpInit::EMPTY: {
     if (ListInit *LHSl = dyn_cast<ListInit>(LHS)) {
       if (LHSl->getSize() == 0) {
         return IntInit::get(1);
@@ -862,6 +810,82 @@ Init *UnOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
     break;
   }
   }
+  return nullptr;
+}
+
+Init *UnOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
+  if (getOpcode() != CAST) {
+    // Memoize context-free unary operators by identity, as Fold does for the
+    // binary ones.
+    static DenseMap<const UnOpInit *, Init *> FoldCache;
+    DenseMap<const UnOpInit *, Init *>::iterator It = FoldCache.find(this);
+    if (It != FoldCache.end())
+      return It->second;
+    Init *Result = foldUnOp(this);
+    if (!Result)
+      Result = const_cast<UnOpInit *>(this);
+    FoldCache[this] = Result;
+    return Result;
+  }
+
+  // !cast: resolve the name against the enclosing record, the multiclass and
+  // finally the record keeper.
+  if (getType()->getAsString() == "string") {
+    if (StringInit *LHSs = dyn_cast<StringInit>(LHS))
+      return LHSs;
+
+    if (DefInit *LHSd = dyn_cast<DefInit>(LHS))
+      return StringInit::get(LHSd->getDef()->getName());
+
+    if (IntInit *LHSi = dyn_cast<IntInit>(LHS))
+      return StringInit::get(LHSi->getAsString());
+  } else {
+    if (StringInit *LHSs = dyn_cast<StringInit>(LHS)) {
+      std::string Name = LHSs->getValue();
+
+      // From TGParser::ParseIDValue
+      if (CurRec) {
+        if (const RecordVal *RV = CurRec->getValue(Name)) {
+          if (RV->getType() != getType())
+            PrintFatalError("type mismatch in cast");
+          return VarInit::get(Name, RV->getType());
+        }
+
+        Init *TemplateArgName = QualifyName(*CurRec, CurMultiClass, Name,
+                                            ":");
+    
+        if (CurRec->isTemplateArg(TemplateArgName)) {
+          const RecordVal *RV = CurRec->getValue(TemplateArgName);
+          assert(RV && "Template arg doesn't exist??");
+
+          if (RV->getType() != getType())
+            PrintFatalError("type mismatch in cast");
+
+          return VarInit::get(TemplateArgName, RV->getType());
+        }
+      }
+
+      if (CurMultiClass) {
+        Init *MCName = QualifyName(CurMultiClass->Rec, CurMultiClass, Name, "::");
+
+        if (CurMultiClass->Rec.isTemplateArg(MCName)) {
+          const RecordVal *RV = CurMultiClass->Rec.getValue(MCName);
+          assert(RV && "Template arg doesn't exist??");
+
+          if (RV->getType() != getType())
+            PrintFatalError("type mismatch in cast");
+
+          return VarInit::get(MCName, RV->getType());
+        }
+      }
+      assert(CurRec && "NULL pointer");
+      if (Record *D = (CurRec->getRecords()).getDef(Name))
+        return DefInit::get(D);
+
+      PrintFatalError(CurRec->getLoc(),
+                      "Undefined reference:'" + Name + "'\n");
+    }
+  }
   return const_cast<UnOpInit *>(this);
 }
 
@@ -901,9 +925,15 @@ BinOpInit *BinOpInit::get(BinaryOp opc, Init *lhs,
   return I;
 }
 
-Init *BinOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
-  switch (getOpcode()) {
-  case CONCAT: {
+// Fold a binary operator with fully resolved operands, or return null if it
+// cannot be folded yet. Unlike !cast, binary operators never consult the
+// enclosing record or the record keeper, so the result depends only on the
+// operator itself.
+static Init *foldBinOp(const BinOpInit *I) {
+  Init *LHS = I->getLHS();
+  Init *RHS = I->getRHS();
+  switch (I->getOpcode()) {
+  case BinOpInit::CONCAT: {
     DagInit *LHSs = dyn_cast<DagInit>(LHS);
     DagInit *RHSs = dyn_cast<DagInit>(RHS);
     if (LHSs && RHSs) {
@@ -925,7 +955,7 @@ Init *BinOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
     }
     break;
   }
-  case LISTCONCAT: {
+  case BinOpInit::LISTCONCAT: {
     ListInit *LHSs = dyn_cast<ListInit>(LHS);
     ListInit *RHSs = dyn_cast<ListInit>(RHS);
     if (LHSs && RHSs) {
@@ -937,14 +967,14 @@ Init *BinOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
     }
     break;
   }
-  case STRCONCAT: {
+  case BinOpInit::STRCONCAT: {
     StringInit *LHSs = dyn_cast<StringInit>(LHS);
     StringInit *RHSs = dyn_cast<StringInit>(RHS);
     if (LHSs && RHSs)
       return StringInit::get(LHSs->getValue() + RHSs->getValue());
     break;
   }
-  case EQ: {
+  case BinOpInit::EQ: {
     // try to fold eq comparison for 'bit' and 'int', otherwise fallback
     // to string objects.
     IntInit *L =
@@ -964,11 +994,11 @@ Init *BinOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
 
     break;
   }
-  case ADD:
-  case AND:
-  case SHL:
-  case SRA:
-  case SRL: {
+  case BinOpInit::ADD:
+  case BinOpInit::AND:
+  case BinOpInit::SHL:
+  case BinOpInit::SRA:
+  case BinOpInit::SRL: {
     IntInit *LHSi =
       dyn_cast_or_null<IntInit>(LHS->convertInitializerTo(IntRecTy::get()));
     IntInit *RHSi =
@@ -976,20 +1006,36 @@ Init *BinOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
     if (LHSi && RHSi) {
       int64_t LHSv = LHSi->getValue(), RHSv = RHSi->getValue();
       int64_t Result;
-      switch (getOpcode()) {
+      switch (I->getOpcode()) {
       default: llvm_unreachable("Bad opcode!");
-      case ADD: Result = LHSv +  RHSv; break;
-      case AND: Result = LHSv &  RHSv; break;
-      case SHL: Result = LHSv << RHSv; break;
-      case SRA: Result = LHSv >> RHSv; break;
-      case SRL: Result = (uint64_t)LHSv >> (uint64_t)RHSv; break;
+      case BinOpInit::ADD: Result = LHSv +  RHSv; break;
+      case BinOpInit::AND: Result = LHSv &  RHSv; break;
+      case BinOpInit::SHL: Result = LHSv << RHSv; break;
+      case BinOpInit::SRA: Result = LHSv >> RHSv; break;
+      case BinOpInit::SRL: Result = (uint64_t)LHSv >> (uint64_t)RHSv; break;
       }
       return IntInit::get(Result);
     }
     break;
   }
   }
-  return const_cast<BinOpInit *>(this);
+  return nullptr;
+}
+
+Init *BinOpInit::Fold(Record *CurRec, MultiClass *CurMultiClass) const {
+  // get() uniques each distinct operation and folding is context free, so the
+  // result can be memoized by operator identity. resolveReferences refolds
+  // every operator it visits; without the cache, deep !strconcat and
+  // !listconcat chains are reconcatenated on every pass over a record.
+  static DenseMap<const BinOpInit *, Init *> FoldCache;
+  DenseMap<const BinOpInit *, Init *>::iterator It = FoldCache.find(this);
+  if (It != FoldCache.end())
+    return It->second;
+  Init *Result = foldBinOp(this);
+  if (!Result)
+    Result = const_cast<BinOpInit *>(this);
+  FoldCache[this] = Result;
+  return Result;
 }
 
 Init *BinOpInit::resolveReferences(Record &R, const RecordVal *RV) const {
@@ -129,6 +129,9 @@ public:
                             const MCRelaxableFragment *DF,
                             const MCAsmLayout &Layout) const override;
 
+  bool fixupValueNeedsRelaxation(const MCFixup &Fixup,
+                                 uint64_t Value) const override;
+
   void relaxInstruction(const MCInst &Inst, MCInst &Res) const override;
 
   bool writeNopData(uint64_t Count, MCObjectWriter *OW) const override;
@@ -274,6 +277,13 @@ bool X86AsmBackend::fixupNeedsRelaxation(const MCFixup &Fixup,
   return int64_t(Value) != int64_t(int8_t(Value));
 }
 
+bool X86AsmBackend::fixupValueNeedsRelaxation(const MCFixup &Fixup,
+                                              uint64_t Value) const {
+  // Same test as above; a branch distance within one fragment is final, so
+  // layout can never change the answer.
+  return int64_t(Value) != int64_t(int8_t(Value));
+}
+
 // FIXME: Can tblgen help at all here to verify there aren't other instructions
 // we can relax?
 void X86AsmBackend::relaxInstruction(const MCInst &Inst, MCInst &Res) const {
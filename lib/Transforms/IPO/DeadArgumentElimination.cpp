@@ -15,25 +15,36 @@
 // This pass is often useful as a cleanup pass to run after aggressive
 // interprocedural passes, which add possibly-dead arguments or return values.
 //
+// To support running over lazily materialized modules, the pass can record a
+// usage summary for every function body in the "llvm.dae.summary" named
+// metadata (-dae-emit-summary). When the pass later runs over a module with
+// unmaterialized bodies, it consults the summary instead of scanning those
+// bodies, and only materializes the bodies that actually need rewriting.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/IPO.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Constant.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
 #include <set>
@@ -44,8 +55,33 @@ using namespace llvm;
 
 STATISTIC(NumArgumentsEliminated, "Number of unread args removed");
 STATISTIC(NumRetValsEliminated  , "Number of unused return values removed");
-STATISTIC(NumArgumentsReplacedWithUndef, 
+STATISTIC(NumArgumentsReplacedWithUndef,
           "Number of unread args replaced with undef");
+STATISTIC(NumBodiesMaterialized,
+          "Number of lazy function bodies materialized for rewriting");
+
+static cl::opt<bool>
+EmitArgUsageSummary("dae-emit-summary", cl::Hidden, cl::init(false),
+                    cl::desc("Emit the llvm.dae.summary named metadata "
+                             "describing per-function argument and return "
+                             "value usage"));
+
+/// The name of the named metadata holding the usage summary. Each operand
+/// describes one function body:
+///   !{F, i64 UsedArgs, G1, i32 Flags1, G2, i32 Flags2, ...}
+/// where bit N of UsedArgs is set when argument N of F has uses in F's body
+/// (arguments past 64 are not recorded and must be assumed used), and each
+/// (G, Flags) pair describes how F's body refers to the function G.
+static const char *SummaryMDName = "llvm.dae.summary";
+
+namespace {
+  /// Flags recorded in the usage summary for each function a body refers to.
+  enum SummaryRefFlags {
+    RefRetUsed = 1,  ///< The result of a direct call to it is used.
+    RefAddrTaken = 2 ///< It is referenced other than as a direct callee.
+  };
+}
+
 namespace {
   /// DAE - The dead argument elimination pass.
   ///
@@ -129,6 +165,21 @@ namespace {
     // they are stored in map for short duration anyway.
     DenseMap<const Function *, DISubprogram> FunctionDIs;
 
+    /// Usage summary for a single unmaterialized function body, parsed from
+    /// the "llvm.dae.summary" named metadata.
+    struct FunctionSummary {
+      uint64_t UsedArgs; ///< Bit N set when argument N has uses in the body.
+      FunctionSummary() : UsedArgs(0) {}
+    };
+
+    /// Summaries for functions whose bodies have not been materialized.
+    DenseMap<const Function *, FunctionSummary> Summaries;
+    /// Combined SummaryRefFlags for every function referenced from an
+    /// unmaterialized body, and the bodies making those references. Such
+    /// references do not show up on use lists until the bodies are read.
+    DenseMap<const Function *, unsigned> LazyRefFlags;
+    DenseMap<const Function *, SmallVector<Function *, 4> > LazyRefBodies;
+
   protected:
     // DAH uses this to specify a different ID.
     explicit DAE(char &ID) : ModulePass(ID) {}
@@ -158,6 +209,9 @@ namespace {
     bool RemoveDeadStuffFromFunction(Function *F);
     bool DeleteDeadVarargs(Function &Fn);
     bool RemoveDeadArgumentsFromCallers(Function &Fn);
+    void CollectSummaries(Module &M);
+    void MaterializeReferences(Function *F);
+    void WriteSummary(Module &M);
   };
 }
 
@@ -188,12 +242,169 @@ INITIALIZE_PASS(DAH, "deadarghaX0r",
 ModulePass *llvm::createDeadArgEliminationPass() { return new DAE(); }
 ModulePass *llvm::createDeadArgHackingPass() { return new DAH(); }
 
+/// CollectConstantRefs - Record any functions referenced by the constant C as
+/// address taken. References made by other global values are not followed;
+/// those exist at module level and are always visible on use lists.
+static void CollectConstantRefs(Constant *C,
+                                MapVector<Function *, unsigned> &Refs,
+                                SmallPtrSetImpl<const Constant *> &Visited) {
+  if (!Visited.insert(C).second)
+    return;
+  if (Function *F = dyn_cast<Function>(C)) {
+    Refs[F] |= RefAddrTaken;
+    return;
+  }
+  if (isa<GlobalValue>(C))
+    return;
+  for (User::op_iterator OI = C->op_begin(), OE = C->op_end(); OI != OE; ++OI)
+    if (Constant *OpC = dyn_cast<Constant>(*OI))
+      CollectConstantRefs(OpC, Refs, Visited);
+}
+
+/// CollectFunctionRefs - Record every function referenced from F's body. A
+/// function appearing only as the callee of direct calls gets RefRetUsed when
+/// any such call's result is used; any other appearance is RefAddrTaken.
+static void CollectFunctionRefs(const Function &F,
+                                MapVector<Function *, unsigned> &Refs) {
+  SmallPtrSet<const Constant *, 16> Visited;
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB)
+    for (BasicBlock::const_iterator I = BB->begin(), E = BB->end(); I != E;
+         ++I) {
+      ImmutableCallSite CS(&*I);
+      for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+        Value *Op = I->getOperand(i);
+        if (Function *Callee = dyn_cast<Function>(Op)) {
+          if (CS && CS.isCallee(&I->getOperandUse(i))) {
+            unsigned &Flags = Refs[Callee];
+            if (!I->use_empty())
+              Flags |= RefRetUsed;
+          } else
+            Refs[Callee] |= RefAddrTaken;
+        } else if (Constant *C = dyn_cast<Constant>(Op))
+          CollectConstantRefs(C, Refs, Visited);
+      }
+    }
+}
+
+/// MaterializeFunction - Read in the body of F. Failing to do so leaves the
+/// module in a state we cannot recover from, so it is fatal.
+static void MaterializeFunction(Function *F) {
+  if (std::error_code EC = F->materialize())
+    report_fatal_error("Failed to materialize function '" + F->getName() +
+                       "': " + EC.message());
+  ++NumBodiesMaterialized;
+}
+
+/// CollectSummaries - Parse the usage summary for any function bodies that
+/// have not been materialized. A body with no summary entry could reference
+/// anything, so it is materialized up front and scanned normally.
+void DAE::CollectSummaries(Module &M) {
+  Summaries.clear();
+  LazyRefFlags.clear();
+  LazyRefBodies.clear();
+
+  bool HaveLazyBodies = false;
+  for (Function &F : M)
+    if (F.isMaterializable()) {
+      HaveLazyBodies = true;
+      break;
+    }
+  if (!HaveLazyBodies)
+    return;
+
+  if (NamedMDNode *NMD = M.getNamedMetadata(SummaryMDName))
+    for (unsigned i = 0, e = NMD->getNumOperands(); i != e; ++i) {
+      MDNode *N = NMD->getOperand(i);
+      if (N->getNumOperands() < 2 || N->getNumOperands() % 2 != 0)
+        continue;
+      Function *F = mdconst::dyn_extract_or_null<Function>(N->getOperand(0));
+      ConstantInt *Mask =
+          mdconst::dyn_extract_or_null<ConstantInt>(N->getOperand(1));
+      if (!F || !Mask || !F->isMaterializable())
+        continue;
+      Summaries[F].UsedArgs = Mask->getZExtValue();
+      for (unsigned Op = 2, OpE = N->getNumOperands(); Op != OpE; Op += 2) {
+        Function *G = mdconst::dyn_extract_or_null<Function>(N->getOperand(Op));
+        if (!G)
+          continue; // The referenced function no longer exists.
+        ConstantInt *Flags =
+            mdconst::dyn_extract_or_null<ConstantInt>(N->getOperand(Op + 1));
+        LazyRefFlags[G] |= Flags ? (unsigned)Flags->getZExtValue()
+                                 : (unsigned)RefAddrTaken;
+        LazyRefBodies[G].push_back(F);
+      }
+    }
+
+  for (Function &F : M)
+    if (F.isMaterializable() && !Summaries.count(&F))
+      MaterializeFunction(&F);
+}
+
+/// MaterializeReferences - We are about to rewrite F and every one of its
+/// call sites. In a lazily loaded module some of those call sites live in
+/// bodies that have not been read yet; read them (and F's own body) now so
+/// that they appear on F's use list.
+void DAE::MaterializeReferences(Function *F) {
+  if (F->isMaterializable())
+    MaterializeFunction(F);
+
+  DenseMap<const Function *, SmallVector<Function *, 4> >::iterator I =
+      LazyRefBodies.find(F);
+  if (I == LazyRefBodies.end())
+    return;
+  for (unsigned i = 0, e = I->second.size(); i != e; ++i)
+    if (I->second[i]->isMaterializable())
+      MaterializeFunction(I->second[i]);
+}
+
+/// WriteSummary - Record a usage summary for every function body in the
+/// module, replacing any existing one. Bodies that are still unmaterialized
+/// are skipped; consumers treat a missing entry conservatively.
+void DAE::WriteSummary(Module &M) {
+  if (NamedMDNode *Old = M.getNamedMetadata(SummaryMDName))
+    M.eraseNamedMetadata(Old);
+  NamedMDNode *NMD = M.getOrInsertNamedMetadata(SummaryMDName);
+
+  Type *I64Ty = Type::getInt64Ty(M.getContext());
+  Type *I32Ty = Type::getInt32Ty(M.getContext());
+  for (Function &F : M) {
+    if (F.empty())
+      continue;
+
+    uint64_t UsedArgs = 0;
+    unsigned i = 0;
+    for (Function::arg_iterator AI = F.arg_begin(), AE = F.arg_end(); AI != AE;
+         ++AI, ++i)
+      if (i < 64 && !AI->use_empty())
+        UsedArgs |= (uint64_t)1 << i;
+
+    MapVector<Function *, unsigned> Refs;
+    CollectFunctionRefs(F, Refs);
+
+    SmallVector<Metadata *, 8> Ops;
+    Ops.push_back(ConstantAsMetadata::get(&F));
+    Ops.push_back(ConstantAsMetadata::get(ConstantInt::get(I64Ty, UsedArgs)));
+    for (MapVector<Function *, unsigned>::iterator RI = Refs.begin(),
+         RE = Refs.end(); RI != RE; ++RI) {
+      Ops.push_back(ConstantAsMetadata::get(RI->first));
+      Ops.push_back(
+          ConstantAsMetadata::get(ConstantInt::get(I32Ty, RI->second)));
+    }
+    NMD->addOperand(MDNode::get(M.getContext(), Ops));
+  }
+}
+
 /// DeleteDeadVarargs - If this is an function that takes a ... list, and if
 /// llvm.vastart is never called, the varargs list is dead for the function.
 bool DAE::DeleteDeadVarargs(Function &Fn) {
   assert(Fn.getFunctionType()->isVarArg() && "Function isn't varargs!");
   if (Fn.isDeclaration() || !Fn.hasLocalLinkage()) return false;
 
+  // We cannot scan an unmaterialized body for va_start, and call sites in
+  // other unmaterialized bodies would be missed when rewriting.
+  if (Fn.isMaterializable() || LazyRefFlags.count(&Fn))
+    return false;
+
   // Ensure that the function is only directly called.
   if (Fn.hasAddressTaken())
     return false;
@@ -329,6 +540,10 @@ bool DAE::RemoveDeadArgumentsFromCallers(Function &Fn)
   if (Fn.isDeclaration() || Fn.mayBeOverridden())
     return false;
 
+  // An unmaterialized body cannot be inspected for argument uses.
+  if (Fn.isMaterializable())
+    return false;
+
   // Functions with local linkage should already have been handled, except the
   // fragile (variadic) ones which we can improve here.
   if (Fn.hasLocalLinkage() && !Fn.getFunctionType()->isVarArg())
@@ -570,10 +785,40 @@ void DAE::SurveyFunction(const Function &F) {
     return;
   }
 
+  // An unmaterialized body cannot be scanned; judge its argument usage from
+  // the recorded summary. Bodies without a summary entry were materialized
+  // up front, but be conservative should one slip through.
+  const FunctionSummary *FS = nullptr;
+  if (F.isMaterializable()) {
+    DenseMap<const Function *, FunctionSummary>::const_iterator SI =
+        Summaries.find(&F);
+    if (SI == Summaries.end()) {
+      MarkLive(F);
+      return;
+    }
+    FS = &SI->second;
+  }
+
   DEBUG(dbgs() << "DAE - Inspecting callers for fn: " << F.getName() << "\n");
   // Keep track of the number of live retvals, so we can skip checks once all
   // of them turn out to be live.
   unsigned NumLiveRetVals = 0;
+
+  // Account for references made from unmaterialized bodies; they do not show
+  // up on the use list below.
+  DenseMap<const Function *, unsigned>::const_iterator LR =
+      LazyRefFlags.find(&F);
+  if (LR != LazyRefFlags.end()) {
+    if (LR->second & RefAddrTaken) {
+      MarkLive(F);
+      return;
+    }
+    if (LR->second & RefRetUsed) {
+      RetValLiveness.assign(RetCount, Live);
+      NumLiveRetVals = RetCount;
+    }
+  }
+
   // Loop all uses of the function.
   for (const Use &U : F.uses()) {
     // If the function is PASSED IN as an argument, its address has been
@@ -647,9 +892,14 @@ void DAE::SurveyFunction(const Function &F) {
       // register and stack HFAs very differently, and this is reflected in the
       // IR which has already been generated.
       Result = Live;
+    } else if (FS) {
+      // Judge from the recorded usage mask. Arguments past 64 are not
+      // recorded and must be assumed used.
+      Result = (i >= 64 || (FS->UsedArgs & ((uint64_t)1 << i))) ? Live
+                                                                : MaybeLive;
     } else {
       // See what the effect of this use is (recording any uses that cause
-      // MaybeLive in MaybeLiveArgUses). 
+      // MaybeLive in MaybeLiveArgUses).
       Result = SurveyUses(AI, MaybeLiveArgUses);
     }
 
@@ -879,6 +1129,11 @@ bool DAE::RemoveDeadStuffFromFunction(Function *F) {
   if (NFTy == FTy)
     return false;
 
+  // We are going to rewrite F and every one of its call sites; bring any
+  // unmaterialized bodies containing such call sites (and F's own body) into
+  // memory first.
+  MaterializeReferences(F);
+
   // Create the new function body and insert it into the module...
   Function *NF = Function::Create(NFTy, F->getLinkage());
   NF->copyAttributesFrom(F);
@@ -1103,6 +1358,11 @@ bool DAE::RemoveDeadStuffFromFunction(Function *F) {
 bool DAE::runOnModule(Module &M) {
   bool Changed = false;
 
+  // Collect usage summaries for any function bodies that have not been
+  // materialized, so that the phases below can reason about them without
+  // reading them in.
+  CollectSummaries(M);
+
   // Collect debug info descriptors for functions.
   FunctionDIs = makeSubprogramMap(M);
 
@@ -1139,5 +1399,12 @@ bool DAE::runOnModule(Module &M) {
   for (auto &F : M)
     Changed |= RemoveDeadArgumentsFromCallers(F);
 
+  // Refresh the usage summary when requested, so that it is written out with
+  // the module and can be consumed when the module is lazily reloaded.
+  if (EmitArgUsageSummary) {
+    WriteSummary(M);
+    Changed = true;
+  }
+
   return Changed;
 }
@@ -156,8 +156,12 @@ bool FunctionAttrs::AddReadAttrs(const CallGraphSCC &SCC) {
     SCCNodes.insert((*I)->getFunction());
 
   // Check if any of the functions in the SCC read or write memory.  If they
-  // write memory then they can't be marked readnone or readonly.
+  // write memory then they can't be marked readnone or readonly.  Do the
+  // cheap attribute-only checks for every function first so that a
+  // declaration or weak definition that may write memory bails out before
+  // any function body is scanned.
   bool ReadsMemory = false;
+  SmallVector<Function*, 8> BodiesToScan;
   for (CallGraphSCC::iterator I = SCC.begin(), E = SCC.end(); I != E; ++I) {
     Function *F = (*I)->getFunction();
 
@@ -182,10 +186,27 @@ bool FunctionAttrs::AddReadAttrs(const CallGraphSCC &SCC) {
       continue;
     }
 
+    BodiesToScan.push_back(F);
+  }
+
+  for (unsigned i = 0, e = BodiesToScan.size(); i != e; ++i) {
+    Function *F = BodiesToScan[i];
+
+    // If the SCC is already known to read memory and this function is known
+    // not to write it, scanning the body cannot change the outcome.
+    if (ReadsMemory && F->onlyReadsMemory())
+      continue;
+
     // Scan the function body for instructions that may read or write memory.
     for (inst_iterator II = inst_begin(F), E = inst_end(F); II != E; ++II) {
       Instruction *I = &*II;
 
+      // Once the SCC is known to read memory, only writes can still change
+      // the result; skip the alias queries for instructions that cannot
+      // write.
+      if (ReadsMemory && !I->mayWriteToMemory())
+        continue;
+
       // Some instructions can be ignored even if they read or write memory.
       // Detect these now, skipping to the next instruction if one is found.
       CallSite CS(cast<Value>(I));
@@ -793,7 +814,10 @@ bool FunctionAttrs::AddNoAliasAttrs(const CallGraphSCC &SCC) {
     SCCNodes.insert((*I)->getFunction());
 
   // Check each function in turn, determining which functions return noalias
-  // pointers.
+  // pointers.  Do the cheap attribute-only checks for every function first
+  // so that a declaration or weak definition bails out before any function
+  // body is scanned.
+  SmallVector<Function*, 8> BodiesToScan;
   for (CallGraphSCC::iterator I = SCC.begin(), E = SCC.end(); I != E; ++I) {
     Function *F = (*I)->getFunction();
 
@@ -810,15 +834,18 @@ bool FunctionAttrs::AddNoAliasAttrs(const CallGraphSCC &SCC) {
     if (F->isDeclaration() || F->mayBeOverridden())
       return false;
 
-    // We annotate noalias return values, which are only applicable to 
+    // We annotate noalias return values, which are only applicable to
     // pointer types.
     if (!F->getReturnType()->isPointerTy())
       continue;
 
-    if (!IsFunctionMallocLike(F, SCCNodes))
-      return false;
+    BodiesToScan.push_back(F);
   }
 
+  for (unsigned i = 0, e = BodiesToScan.size(); i != e; ++i)
+    if (!IsFunctionMallocLike(BodiesToScan[i], SCCNodes))
+      return false;
+
   bool MadeChange = false;
   for (CallGraphSCC::iterator I = SCC.begin(), E = SCC.end(); I != E; ++I) {
     Function *F = (*I)->getFunction();
@@ -89,6 +89,19 @@ namespace {
     const DataLayout *DL;
     TargetLibraryInfo *TLI;
     SmallSet<const Comdat *, 8> NotDiscardableComdats;
+
+    /// Incremented every time this pass changes the module.  Together with
+    /// AnalyzedGlobals it lets OptimizeGlobalVars skip re-walking the use
+    /// lists of globals that nothing could have changed since their last
+    /// fruitless analysis; on machine-generated modules with hundreds of
+    /// thousands of globals those re-walks dominate the pass.
+    unsigned GlobalEpoch;
+
+    /// For each global that ProcessGlobal analyzed without making a change,
+    /// the value of GlobalEpoch at the time.  Entries for deleted globals go
+    /// stale harmlessly: deletion bumps GlobalEpoch, so they can never match
+    /// it again.
+    DenseMap<const GlobalVariable *, unsigned> AnalyzedGlobals;
   };
 }
 
@@ -1963,7 +1976,19 @@ bool GlobalOpt::OptimizeGlobalVars(Module &M) {
       if (const Comdat *C = GV->getComdat())
         if (NotDiscardableComdats.count(C) && !GV->hasLocalLinkage())
           continue;
-      Changed |= ProcessGlobal(GV, GVI);
+
+      // If nothing has changed in the module since the last time this global
+      // was analyzed without result, analyzing it again cannot conclude
+      // anything new.
+      if (AnalyzedGlobals.lookup(GV) == GlobalEpoch)
+        continue;
+
+      if (ProcessGlobal(GV, GVI)) {
+        Changed = true;
+        ++GlobalEpoch;
+      } else {
+        AnalyzedGlobals[GV] = GlobalEpoch;
+      }
     }
   }
   return Changed;
@@ -3044,6 +3069,11 @@ bool GlobalOpt::runOnModule(Module &M) {
   DL = DLP ? &DLP->getDataLayout() : nullptr;
   TLI = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
 
+  // Start at 1 so that a missing AnalyzedGlobals entry (which reads as 0)
+  // never matches the current epoch.
+  GlobalEpoch = 1;
+  AnalyzedGlobals.clear();
+
   bool LocalChange = true;
   while (LocalChange) {
     LocalChange = false;
@@ -3063,24 +3093,34 @@ bool GlobalOpt::runOnModule(Module &M) {
           NotDiscardableComdats.insert(C);
 
     // Delete functions that are trivially dead, ccc -> fastcc
-    LocalChange |= OptimizeFunctions(M);
+    if (OptimizeFunctions(M)) {
+      LocalChange = true;
+      ++GlobalEpoch;
+    }
 
     // Optimize global_ctors list.
-    LocalChange |= optimizeGlobalCtorsList(M, [&](Function *F) {
-      return EvaluateStaticConstructor(F, DL, TLI);
-    });
+    if (optimizeGlobalCtorsList(
+            M, [&](Function *F) { return EvaluateStaticConstructor(F, DL, TLI); })) {
+      LocalChange = true;
+      ++GlobalEpoch;
+    }
 
     // Optimize non-address-taken globals.
     LocalChange |= OptimizeGlobalVars(M);
 
     // Resolve aliases, when possible.
-    LocalChange |= OptimizeGlobalAliases(M);
+    if (OptimizeGlobalAliases(M)) {
+      LocalChange = true;
+      ++GlobalEpoch;
+    }
 
     // Try to remove trivial global destructors if they are not removed
     // already.
     Function *CXAAtExitFn = FindCXAAtExit(M, TLI);
-    if (CXAAtExitFn)
-      LocalChange |= OptimizeEmptyGlobalCXXDtors(CXAAtExitFn);
+    if (CXAAtExitFn && OptimizeEmptyGlobalCXXDtors(CXAAtExitFn)) {
+      LocalChange = true;
+      ++GlobalEpoch;
+    }
 
     Changed |= LocalChange;
   }
@@ -0,0 +1,165 @@
+//===- HotColdSplitting.cpp - Outline cold regions ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass outlines cold regions of functions into separate functions marked
+// cold and minsize, so that the rarely executed bytes (error handling,
+// assertion failures, and the like) stop diluting the instruction cache
+// footprint of the hot path.
+//
+// A region is a block together with everything it dominates, which guarantees
+// a single entry and lets CodeExtractor pull it out wholesale. A region is
+// outlined when every block in it is cold according to BlockFrequencyInfo,
+// which reflects profile data when branch weights are present and static
+// branch heuristics otherwise.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/CodeExtractor.h"
+#include <vector>
+using namespace llvm;
+
+#define DEBUG_TYPE "hotcoldsplit"
+
+STATISTIC(NumColdRegionsFound, "Number of cold regions found");
+STATISTIC(NumColdRegionsOutlined, "Number of cold regions outlined");
+
+static cl::opt<unsigned> ColdRatio(
+    "hotcoldsplit-cold-ratio", cl::Hidden, cl::init(100), cl::ZeroOrMore,
+    cl::desc("Consider a block cold when it executes at most 1/N as often "
+             "as the function entry"));
+
+namespace {
+  struct HotColdSplitting : public ModulePass {
+    static char ID; // Pass identification, replacement for typeid
+    HotColdSplitting() : ModulePass(ID) {
+      initializeHotColdSplittingPass(*PassRegistry::getPassRegistry());
+    }
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.addRequired<BlockFrequencyInfo>();
+    }
+
+    bool runOnModule(Module &M) override;
+
+  private:
+    bool outlineColdRegions(Function &F);
+  };
+}
+
+char HotColdSplitting::ID = 0;
+INITIALIZE_PASS_BEGIN(HotColdSplitting, "hotcoldsplit", "Hot Cold Splitting",
+                      false, false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfo)
+INITIALIZE_PASS_END(HotColdSplitting, "hotcoldsplit", "Hot Cold Splitting",
+                    false, false)
+
+ModulePass *llvm::createHotColdSplittingPass() {
+  return new HotColdSplitting();
+}
+
+bool HotColdSplitting::outlineColdRegions(Function &F) {
+  BlockFrequencyInfo &BFI = getAnalysis<BlockFrequencyInfo>(F);
+  uint64_t EntryFreq = BFI.getEntryFreq();
+
+  SmallPtrSet<const BasicBlock *, 16> ColdBlocks;
+  for (BasicBlock &BB : F)
+    if (BFI.getBlockFreq(&BB).getFrequency() * ColdRatio <= EntryFreq)
+      ColdBlocks.insert(&BB);
+  if (ColdBlocks.empty())
+    return false;
+
+  DominatorTree DT;
+  DT.recalculate(F);
+
+  // Group the cold blocks into maximal single-entry regions: walk the
+  // dominator tree from the root so that an enclosing region claims its
+  // sub-regions, and take each cold block together with everything it
+  // dominates, provided all of that is cold as well.
+  std::vector<std::vector<BasicBlock *>> Regions;
+  SmallPtrSet<BasicBlock *, 16> Claimed;
+  for (DomTreeNode *N : depth_first(DT.getRootNode())) {
+    BasicBlock *BB = N->getBlock();
+    if (BB == &F.getEntryBlock() || Claimed.count(BB) ||
+        !ColdBlocks.count(BB))
+      continue;
+
+    std::vector<BasicBlock *> Region;
+    bool AllCold = true;
+    for (DomTreeNode *C : depth_first(N)) {
+      if (!ColdBlocks.count(C->getBlock())) {
+        AllCold = false;
+        break;
+      }
+      Region.push_back(C->getBlock());
+    }
+    if (!AllCold)
+      continue;
+
+    Claimed.insert(Region.begin(), Region.end());
+    Regions.push_back(std::move(Region));
+    ++NumColdRegionsFound;
+  }
+
+  // The region block lists stay valid across extractions since extracting one
+  // region only moves its own blocks out of F.
+  bool Changed = false;
+  for (std::vector<BasicBlock *> &Region : Regions) {
+    CodeExtractor CE(Region);
+    Function *Outlined = CE.extractCodeRegion();
+    if (!Outlined) {
+      // Landing pads, allocas and the like make a region ineligible.
+      DEBUG(dbgs() << "Not extracting ineligible cold region in "
+                   << F.getName() << "\n");
+      continue;
+    }
+
+    Outlined->addFnAttr(Attribute::Cold);
+    Outlined->addFnAttr(Attribute::MinSize);
+    // The outlined function has internal linkage and a single call site,
+    // which makes it a prime inlining candidate; forbid that or the split
+    // would be undone immediately.
+    Outlined->addFnAttr(Attribute::NoInline);
+
+    DEBUG(dbgs() << "Outlined cold region from " << F.getName() << " into "
+                 << Outlined->getName() << "\n");
+    ++NumColdRegionsOutlined;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool HotColdSplitting::runOnModule(Module &M) {
+  // Collect the worklist up front; outlining appends functions to the module.
+  std::vector<Function *> Worklist;
+  for (Function &F : M) {
+    // Entirely cold functions gain nothing from being split.
+    if (F.isDeclaration() || F.hasFnAttribute(Attribute::Cold) ||
+        F.hasFnAttribute(Attribute::OptimizeNone))
+      continue;
+    Worklist.push_back(&F);
+  }
+
+  bool Changed = false;
+  for (Function *F : Worklist)
+    Changed |= outlineColdRegions(*F);
+  return Changed;
+}
@@ -30,14 +30,18 @@ void llvm::initializeIPO(PassRegistry &Registry) {
   initializeGlobalDCEPass(Registry);
   initializeGlobalOptPass(Registry);
   initializeIPCPPass(Registry);
+  initializeIndirectCallPromotionPass(Registry);
   initializeAlwaysInlinerPass(Registry);
   initializeSimpleInlinerPass(Registry);
   initializeInternalizePassPass(Registry);
   initializeLoopExtractorPass(Registry);
   initializeBlockExtractorPassPass(Registry);
   initializeSingleLoopExtractorPass(Registry);
+  initializeHotColdSplittingPass(Registry);
   initializeLowerBitSetsPass(Registry);
   initializeMergeFunctionsPass(Registry);
+  initializeParallelFunctionPassesPass(Registry);
+  initializeParallelIPOPassesPass(Registry);
   initializePartialInlinerPass(Registry);
   initializePruneEHPass(Registry);
   initializeStripDeadPrototypesPassPass(Registry);
@@ -0,0 +1,201 @@
+//===- IndirectCallPromotion.cpp - Promote profiled indirect calls --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass promotes indirect call sites with a known dominant target to a
+// guarded direct call:
+//
+//   %cmp = icmp eq void()* %fp, @target
+//   br i1 %cmp, label %direct, label %indirect
+//
+// so the inliner and the rest of the IPO pipeline can see through the call.
+// Candidate targets are read from !indirect.call.targets metadata attached to
+// the call instruction by a profiling front end or an offline tool:
+//
+//   !indirect.call.targets = !{i64 <total>, !"<name>", i64 <count>, ...}
+//
+// where <total> is the execution count of the call site and each pair names a
+// target and the number of calls that reached it.  Only the hottest target is
+// promoted, and only if it accounts for a large enough share of the calls.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "indirect-call-promotion"
+
+STATISTIC(NumPromoted, "Number of indirect call sites promoted");
+
+// The dominant target must account for at least this percentage of the
+// profiled calls before the site is worth a compare-and-branch.
+static cl::opt<unsigned>
+ICPPercentThreshold("icp-percent-threshold",
+                    cl::desc("Min percentage of calls going to the dominant "
+                             "target to promote an indirect call site"),
+                    cl::init(66), cl::Hidden);
+
+namespace {
+  struct IndirectCallPromotion : public ModulePass {
+    static char ID; // Pass identification, replacement for typeid
+    IndirectCallPromotion() : ModulePass(ID) {
+      initializeIndirectCallPromotionPass(*PassRegistry::getPassRegistry());
+    }
+
+    bool runOnModule(Module &M) override;
+
+  private:
+    bool promoteCallSite(CallInst *CI, Module &M);
+  };
+}
+
+char IndirectCallPromotion::ID = 0;
+INITIALIZE_PASS(IndirectCallPromotion, "indirect-call-promotion",
+                "Promote profiled indirect calls to guarded direct calls",
+                false, false)
+
+ModulePass *llvm::createIndirectCallPromotionPass() {
+  return new IndirectCallPromotion();
+}
+
+/// Pick the hottest target out of the !indirect.call.targets metadata, or
+/// return null if the metadata is malformed or no target is dominant enough.
+static Function *findDominantTarget(const MDNode *MD, Module &M,
+                                    uint64_t &Count, uint64_t &Total) {
+  if (MD->getNumOperands() < 3 || (MD->getNumOperands() & 1) == 0)
+    return nullptr;
+
+  ConstantInt *TotalCI = mdconst::dyn_extract<ConstantInt>(MD->getOperand(0));
+  if (!TotalCI || TotalCI->isZero())
+    return nullptr;
+  Total = TotalCI->getZExtValue();
+
+  StringRef BestName;
+  uint64_t BestCount = 0;
+  for (unsigned i = 1, e = MD->getNumOperands(); i != e; i += 2) {
+    MDString *Name = dyn_cast<MDString>(MD->getOperand(i));
+    ConstantInt *CountCI =
+        mdconst::dyn_extract<ConstantInt>(MD->getOperand(i + 1));
+    if (!Name || !CountCI)
+      return nullptr;
+    if (CountCI->getZExtValue() > BestCount) {
+      BestCount = CountCI->getZExtValue();
+      BestName = Name->getString();
+    }
+  }
+
+  if (BestCount > Total || BestCount * 100 < Total * ICPPercentThreshold)
+    return nullptr;
+
+  Count = BestCount;
+  return M.getFunction(BestName);
+}
+
+bool IndirectCallPromotion::promoteCallSite(CallInst *CI, Module &M) {
+  MDNode *MD = CI->getMetadata("indirect.call.targets");
+  if (!MD)
+    return false;
+
+  uint64_t Count = 0, Total = 0;
+  Function *Target = findDominantTarget(MD, M, Count, Total);
+  if (!Target)
+    return false;
+
+  // Only promote when the types match exactly; the guard compares function
+  // addresses, so a mismatched prototype means the profile names a different
+  // overload and the direct call would be ill-formed.
+  PointerType *CalleeTy = cast<PointerType>(CI->getCalledValue()->getType());
+  if (Target->getFunctionType() != CalleeTy->getElementType())
+    return false;
+
+  DEBUG(dbgs() << "ICP: promoting call in "
+               << CI->getParent()->getParent()->getName() << " to "
+               << Target->getName() << " (" << Count << " of " << Total
+               << " calls)\n");
+
+  // Split the block at the call; the call and everything after it move to
+  // MergeBB, and OrigBB ends in the guard branch.
+  BasicBlock *OrigBB = CI->getParent();
+  Function *F = OrigBB->getParent();
+  BasicBlock *MergeBB = OrigBB->splitBasicBlock(CI, "icp.merge");
+  OrigBB->getTerminator()->eraseFromParent();
+
+  BasicBlock *DirectBB =
+      BasicBlock::Create(F->getContext(), "icp.direct", F, MergeBB);
+  BasicBlock *IndirectBB =
+      BasicBlock::Create(F->getContext(), "icp.indirect", F, MergeBB);
+
+  IRBuilder<> Builder(OrigBB);
+  Value *Guard = Builder.CreateICmpEQ(
+      CI->getCalledValue(), Builder.CreateBitCast(Target, CalleeTy),
+      "icp.cmp");
+  BranchInst *GuardBr = Builder.CreateCondBr(Guard, DirectBB, IndirectBB);
+  uint64_t Scale = 1;
+  while ((Total / Scale) > UINT32_MAX)
+    Scale *= 2;
+  GuardBr->setMetadata(LLVMContext::MD_prof,
+                       MDBuilder(F->getContext())
+                           .createBranchWeights(Count / Scale,
+                                                (Total - Count) / Scale));
+
+  // The direct call is a clone of the original with the callee replaced.
+  CallInst *DirectCall = cast<CallInst>(CI->clone());
+  DirectCall->setCalledFunction(Target);
+  DirectCall->setMetadata("indirect.call.targets", nullptr);
+  DirectBB->getInstList().push_back(DirectCall);
+  BranchInst::Create(MergeBB, DirectBB);
+
+  // The original call keeps handling the remaining targets.
+  CI->removeFromParent();
+  CI->setMetadata("indirect.call.targets", nullptr);
+  IndirectBB->getInstList().push_back(CI);
+  BranchInst::Create(MergeBB, IndirectBB);
+
+  if (!CI->getType()->isVoidTy()) {
+    PHINode *Phi = PHINode::Create(CI->getType(), 2, "icp.retval",
+                                   MergeBB->begin());
+    CI->replaceAllUsesWith(Phi);
+    Phi->addIncoming(DirectCall, DirectBB);
+    Phi->addIncoming(CI, IndirectBB);
+  }
+
+  ++NumPromoted;
+  return true;
+}
+
+bool IndirectCallPromotion::runOnModule(Module &M) {
+  // Collect the candidates up front; promotion splits blocks under the
+  // iterators otherwise.
+  SmallVector<CallInst *, 16> Candidates;
+  for (Function &F : M)
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB) {
+        CallInst *CI = dyn_cast<CallInst>(&I);
+        // Leave musttail calls alone; they must stay glued to the return.
+        if (CI && !CI->getCalledFunction() && !CI->isInlineAsm() &&
+            !CI->isMustTailCall() && CI->getMetadata("indirect.call.targets"))
+          Candidates.push_back(CI);
+      }
+
+  bool Changed = false;
+  for (CallInst *CI : Candidates)
+    Changed |= promoteCallSite(CI, M);
+  return Changed;
+}
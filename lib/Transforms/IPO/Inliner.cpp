@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/IPO/InlinerPass.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
@@ -61,16 +62,28 @@ static cl::opt<int>
 ColdThreshold("inlinecold-threshold", cl::Hidden, cl::init(225),
               cl::desc("Threshold for inlining functions with cold attribute"));
 
+// A module-level code-size budget, in estimated IR instructions of growth.
+// Thresholds decay linearly as cumulative inlining growth consumes the
+// budget, so profitable inlines early in the pipeline proceed at full
+// strength and marginal ones stop once the module nears its icache budget.
+// This is module-global rather than per hot region: the legacy inliner is not
+// hooked up to BPI/BFI (see the comment on -inlinecold-threshold above).
+static cl::opt<unsigned>
+SizeBudget("inline-size-budget", cl::Hidden, cl::init(0), cl::ZeroOrMore,
+           cl::desc("Decay inline thresholds as cumulative growth approaches "
+                    "this many instructions (default = 0, unlimited)"));
+
 // Threshold to use when optsize is specified (and there is no -inline-limit).
 const int OptSizeThreshold = 75;
 
-Inliner::Inliner(char &ID) 
-  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit), InsertLifetime(true) {}
+Inliner::Inliner(char &ID)
+  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit), InsertLifetime(true),
+    GrowthSoFar(0) {}
 
 Inliner::Inliner(char &ID, int Threshold, bool InsertLifetime)
   : CallGraphSCCPass(ID), InlineThreshold(InlineLimit.getNumOccurrences() > 0 ?
                                           InlineLimit : Threshold),
-    InsertLifetime(InsertLifetime) {}
+    InsertLifetime(InsertLifetime), GrowthSoFar(0) {}
 
 /// getAnalysisUsage - For this class, we declare that we require and preserve
 /// the call graph.  If the derived class implements this method, it should
@@ -290,6 +303,14 @@ unsigned Inliner::getInlineThreshold(CallSite CS) const {
       ColdThreshold < thres)
     thres = ColdThreshold;
 
+  // Decay the threshold by the unconsumed fraction of the size budget, if one
+  // was configured.
+  if (SizeBudget && thres > 0) {
+    if (GrowthSoFar >= SizeBudget)
+      return 0;
+    thres = (int)(uint64_t(thres) * (SizeBudget - GrowthSoFar) / SizeBudget);
+  }
+
   return thres;
 }
 
@@ -497,6 +518,17 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
   InlinedArrayAllocasTy InlinedArrayAllocas;
   InlineFunctionInfo InlineInfo(&CG, DL, AA, ACT);
 
+  // The outer loop below revisits every surviving call site whenever some
+  // call site changed.  An inline decision only depends on the caller and
+  // the callee, though, so a call site rejected by shouldInline cannot
+  // become profitable until one of those two functions changes.  Track in
+  // which "epoch" each call site was rejected and each function was last
+  // modified, and skip the (expensive) cost evaluation for rejections that
+  // are still current.
+  unsigned Epoch = 1;
+  DenseMap<Instruction *, unsigned> RejectionEpoch;
+  DenseMap<Function *, unsigned> ChangeEpoch;
+
   // Now that we have all of the call sites, loop over them and inline them if
   // it looks profitable to do so.
   bool Changed = false;
@@ -520,8 +552,12 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
                      << *CS.getInstruction() << "\n");
         // Update the call graph by deleting the edge from Callee to Caller.
         CG[Caller]->removeCallEdgeFor(CS);
+        RejectionEpoch.erase(CS.getInstruction());
         CS.getInstruction()->eraseFromParent();
         ++NumCallsDeleted;
+        ChangeEpoch[Caller] = ++Epoch;
+        if (Callee)
+          ChangeEpoch[Callee] = Epoch;
       } else {
         // We can only inline direct calls to non-declarations.
         if (!Callee || Callee->isDeclaration()) continue;
@@ -541,6 +577,14 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
         // Get DebugLoc to report. CS will be invalid after Inliner.
         DebugLoc DLoc = CS.getInstruction()->getDebugLoc();
 
+        // If this call site was rejected before and neither its caller nor
+        // its callee has changed since, the decision cannot change; don't
+        // evaluate the cost again (or emit a duplicate remark).
+        unsigned RejectedAt = RejectionEpoch.lookup(CS.getInstruction());
+        if (RejectedAt && RejectedAt >= ChangeEpoch.lookup(Caller) &&
+            RejectedAt >= ChangeEpoch.lookup(Callee))
+          continue;
+
         // If the policy determines that we should inline this function,
         // try to do so.
         if (!shouldInline(CS)) {
@@ -548,6 +592,7 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
                                        Twine(Callee->getName() +
                                              " will not be inlined into " +
                                              Caller->getName()));
+          RejectionEpoch[CS.getInstruction()] = Epoch;
           continue;
         }
 
@@ -562,6 +607,23 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
         }
         ++NumInlined;
 
+        // Charge the estimated growth (the callee's body, which the caller
+        // just gained a copy of) against the module's size budget.
+        if (SizeBudget) {
+          uint64_t CalleeSize = 0;
+          for (Function::const_iterator BB = Callee->begin(),
+                                        BBE = Callee->end();
+               BB != BBE; ++BB)
+            CalleeSize += BB->size();
+          GrowthSoFar += CalleeSize;
+        }
+
+        // The caller gained the callee's body and the callee lost a user;
+        // either can flip a previously rejected inline decision.  The call
+        // instruction itself is gone, so drop any record of it.
+        RejectionEpoch.erase(CS.getInstruction());
+        ChangeEpoch[Caller] = ChangeEpoch[Callee] = ++Epoch;
+
         // Report the inline decision.
         emitOptimizationRemark(
             CallerCtx, DEBUG_TYPE, *Caller, DLoc,
@@ -625,6 +687,12 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
   return Changed;
 }
 
+// doInitialization - Each module starts with a full size budget.
+bool Inliner::doInitialization(CallGraph &CG) {
+  GrowthSoFar = 0;
+  return false;
+}
+
 // doFinalization - Remove now-dead linkonce functions at the end of
 // processing to avoid breaking the SCC traversal.
 bool Inliner::doFinalization(CallGraph &CG) {
@@ -96,6 +96,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
+#include "llvm/IR/StructuralHash.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
@@ -396,11 +397,21 @@ class FunctionNode {
   AssertingVH<Function> F;
   const DataLayout *DL;
 
+  /// Digest of the function's structure, computed once on insertion.
+  /// Structurally equivalent functions are guaranteed to hash alike, so
+  /// ordering by the hash first is consistent with the full comparison.
+  uint64_t Hash;
+
 public:
-  FunctionNode(Function *F, const DataLayout *DL) : F(F), DL(DL) {}
+  FunctionNode(Function *F, const DataLayout *DL)
+      : F(F), DL(DL), Hash(StructuralHash(*F)) {}
   Function *getFunc() const { return F; }
   void release() { F = 0; }
   bool operator<(const FunctionNode &RHS) const {
+    // Order first by the cheap structural hash; only functions that land in
+    // the same bucket pay for a deep FunctionComparator walk.
+    if (Hash != RHS.Hash)
+      return Hash < RHS.Hash;
     return (FunctionComparator(DL, F, RHS.getFunc()).compare()) == -1;
   }
 };
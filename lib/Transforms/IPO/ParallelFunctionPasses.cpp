@@ -0,0 +1,279 @@
+//===- ParallelFunctionPasses.cpp - Run function passes in parallel -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass runs a pipeline of function passes over the functions of a module
+// on several worker threads. The legacy pass manager and the IR itself are not
+// thread-safe, so the module is partitioned the same way splitCodeGen does it:
+// local symbols are externalized, the module is round-tripped through bitcode
+// into one private LLVMContext per worker, each worker strips the function
+// bodies it does not own and runs its own FunctionPassManager over the rest,
+// and the optimized partitions are linked back into the original module.
+//
+// The round trip is profitable when the pipeline cost dominates, which is the
+// case for large modules; for small modules the pass falls back to running the
+// pipeline serially in place.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Pass.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "parallel-function-passes"
+
+static cl::opt<unsigned> ParallelFunctionPassThreads(
+    "parallel-function-passes-threads", cl::init(2), cl::Hidden,
+    cl::desc("Number of worker threads used by -parallel-function-passes"));
+
+static cl::opt<std::string> ParallelFunctionPassPipeline(
+    "parallel-function-passes-pipeline", cl::init(""), cl::Hidden,
+    cl::desc("Comma-separated list of function pass arguments to run"));
+
+namespace {
+struct ParallelFunctionPasses : public ModulePass {
+  static char ID;
+
+  std::string Pipeline;
+  unsigned NumThreads;
+
+  ParallelFunctionPasses()
+      : ModulePass(ID), Pipeline(ParallelFunctionPassPipeline),
+        NumThreads(ParallelFunctionPassThreads) {
+    initializeParallelFunctionPassesPass(*PassRegistry::getPassRegistry());
+  }
+  ParallelFunctionPasses(StringRef Pipeline, unsigned NumThreads)
+      : ModulePass(ID), Pipeline(Pipeline), NumThreads(NumThreads) {
+    initializeParallelFunctionPassesPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override;
+
+private:
+  bool populatePipeline(legacy::FunctionPassManager &FPM);
+  bool runSerially(Module &M);
+};
+} // end anonymous namespace
+
+char ParallelFunctionPasses::ID = 0;
+INITIALIZE_PASS(ParallelFunctionPasses, "parallel-function-passes",
+                "Run function passes over partitions in parallel", false,
+                false)
+
+ModulePass *llvm::createParallelFunctionPassesPass(StringRef Pipeline,
+                                                   unsigned NumThreads) {
+  return new ParallelFunctionPasses(Pipeline, NumThreads);
+}
+
+/// Instantiate the configured pipeline into FPM. Returns false (emitting a
+/// diagnostic) if an argument does not name a registered function pass.
+bool ParallelFunctionPasses::populatePipeline(legacy::FunctionPassManager &FPM) {
+  SmallVector<StringRef, 8> Names;
+  StringRef(Pipeline).split(Names, ",", /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef Name : Names) {
+    const PassInfo *PI = PassRegistry::getPassRegistry()->getPassInfo(Name);
+    if (!PI || !PI->getNormalCtor()) {
+      errs() << "parallel-function-passes: unknown pass '" << Name << "'\n";
+      return false;
+    }
+    Pass *P = PI->getNormalCtor()();
+    if (P->getPassKind() != PT_Function && P->getPassKind() != PT_Loop &&
+        P->getPassKind() != PT_BasicBlock) {
+      errs() << "parallel-function-passes: '" << Name
+             << "' is not a function pass\n";
+      delete P;
+      return false;
+    }
+    FPM.add(P);
+  }
+  return true;
+}
+
+bool ParallelFunctionPasses::runSerially(Module &M) {
+  legacy::FunctionPassManager FPM(&M);
+  if (!populatePipeline(FPM))
+    return false;
+  bool Changed = false;
+  FPM.doInitialization();
+  for (Function &F : M)
+    if (!F.isDeclaration())
+      Changed |= FPM.run(F);
+  FPM.doFinalization();
+  return Changed;
+}
+
+/// See splitCodeGen: definitions and references may end up in different
+/// partitions, so local symbols must be externally visible to the linker.
+static void externalize(GlobalValue &GV) {
+  if (!GV.hasLocalLinkage())
+    return;
+  if (!GV.hasName())
+    GV.setName("__llvmsplit_unnamed");
+  GV.setLinkage(GlobalValue::ExternalLinkage);
+  GV.setVisibility(GlobalValue::HiddenVisibility);
+}
+
+bool ParallelFunctionPasses::runOnModule(Module &M) {
+  if (Pipeline.empty())
+    return false;
+
+  if (NumThreads <= 1 || !llvm_is_multithreaded() || M.size() < 2 * NumThreads)
+    return runSerially(M);
+
+  for (GlobalVariable &GV : M.globals())
+    externalize(GV);
+  for (Function &F : M)
+    externalize(F);
+  for (GlobalAlias &GA : M.aliases())
+    externalize(GA);
+
+  // Assign function bodies to the least loaded partition, by instruction
+  // count. Everything that is not a function body (globals, aliases, named
+  // metadata, module inline asm) is owned by partition 0.
+  std::vector<unsigned> Partition;
+  std::vector<uint64_t> Load(NumThreads, 0);
+  for (Function &F : M) {
+    unsigned Part = 0;
+    if (!F.isDeclaration()) {
+      for (unsigned I = 1; I != NumThreads; ++I)
+        if (Load[I] < Load[Part])
+          Part = I;
+      uint64_t Cost = 1;
+      for (const BasicBlock &BB : F)
+        Cost += BB.size();
+      Load[Part] += Cost;
+    }
+    Partition.push_back(Part);
+  }
+
+  SmallString<0> BC;
+  raw_svector_ostream BCOS(BC);
+  WriteBitcodeToFile(&M, BCOS);
+  BCOS.flush();
+
+  std::vector<SmallString<0>> Results(NumThreads);
+  // char, not bool: vector<bool> packs bits and adjacent writes from
+  // different threads would race.
+  std::vector<char> Failed(NumThreads, 0);
+  std::vector<std::thread> Threads;
+  for (unsigned ThreadNo = 0; ThreadNo != NumThreads; ++ThreadNo) {
+    Threads.emplace_back([=, &BC, &Partition, &Results, &Failed] {
+      LLVMContext Ctx;
+      ErrorOr<Module *> MOrErr = parseBitcodeFile(
+          MemoryBufferRef(StringRef(BC.data(), BC.size()), "split"), Ctx);
+      if (!MOrErr) {
+        Failed[ThreadNo] = true;
+        return;
+      }
+      std::unique_ptr<Module> MPart(MOrErr.get());
+
+      unsigned Idx = 0;
+      for (Function &F : *MPart) {
+        if (Partition[Idx] != ThreadNo && !F.isDeclaration())
+          F.deleteBody();
+        ++Idx;
+      }
+      if (ThreadNo != 0) {
+        for (GlobalVariable &GV : MPart->globals())
+          if (GV.hasInitializer())
+            GV.setInitializer(nullptr);
+        MPart->setModuleInlineAsm("");
+        while (!MPart->named_metadata_empty())
+          MPart->named_metadata_begin()->eraseFromParent();
+        // Replace alias definitions with declarations of the aliased symbol
+        // so that only partition 0 defines them.
+        for (auto I = MPart->alias_begin(), E = MPart->alias_end(); I != E;) {
+          GlobalAlias *GA = &*I++;
+          std::string Name = GA->getName();
+          GA->setName("");
+          GlobalValue *Decl;
+          Type *ValTy = GA->getType()->getElementType();
+          if (FunctionType *FTy = dyn_cast<FunctionType>(ValTy))
+            Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, Name,
+                                    MPart.get());
+          else
+            Decl = new GlobalVariable(*MPart, ValTy, false,
+                                      GlobalValue::ExternalLinkage, nullptr,
+                                      Name);
+          GA->replaceAllUsesWith(Decl);
+          GA->eraseFromParent();
+        }
+      }
+
+      legacy::FunctionPassManager FPM(MPart.get());
+      if (!populatePipeline(FPM)) {
+        Failed[ThreadNo] = true;
+        return;
+      }
+      FPM.doInitialization();
+      Idx = 0;
+      for (Function &F : *MPart) {
+        if (Partition[Idx] == ThreadNo && !F.isDeclaration())
+          FPM.run(F);
+        ++Idx;
+      }
+      FPM.doFinalization();
+
+      raw_svector_ostream OS(Results[ThreadNo]);
+      WriteBitcodeToFile(MPart.get(), OS);
+      OS.flush();
+    });
+  }
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned I = 0; I != NumThreads; ++I)
+    if (Failed[I])
+      report_fatal_error("parallel-function-passes: worker failed");
+
+  // Empty the original module and link the optimized partitions back in. The
+  // partitions were parsed in worker contexts, so reparse each result in this
+  // module's context for the linker.
+  M.dropAllReferences();
+  while (!M.alias_empty())
+    M.alias_begin()->eraseFromParent();
+  while (!M.global_empty())
+    M.global_begin()->eraseFromParent();
+  while (!M.empty())
+    M.begin()->eraseFromParent();
+  while (!M.named_metadata_empty())
+    M.named_metadata_begin()->eraseFromParent();
+  M.setModuleInlineAsm("");
+
+  Linker L(&M);
+  for (unsigned I = 0; I != NumThreads; ++I) {
+    ErrorOr<Module *> MOrErr = parseBitcodeFile(
+        MemoryBufferRef(StringRef(Results[I].data(), Results[I].size()),
+                        "partition"),
+        M.getContext());
+    if (!MOrErr)
+      report_fatal_error("parallel-function-passes: bad partition bitcode");
+    std::unique_ptr<Module> Src(MOrErr.get());
+    if (L.linkInModule(Src.get()))
+      report_fatal_error("parallel-function-passes: relink failed");
+  }
+
+  return true;
+}
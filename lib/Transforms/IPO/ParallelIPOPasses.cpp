@@ -0,0 +1,308 @@
+//===- ParallelIPOPasses.cpp - Run IPO passes over partitions -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass runs a pipeline of module-level IPO passes over balanced
+// partitions of the module on several worker threads. It shares its approach
+// with ParallelFunctionPasses: local symbols are externalized, the module is
+// round-tripped through bitcode into one private LLVMContext per worker, each
+// worker strips the function bodies it does not own and runs its own pass
+// manager over the rest, and the optimized partitions are linked back into
+// the original module.
+//
+// Two things are different from the function-pass variant. First, partitions
+// are balanced by weighted scheduling: function bodies are assigned largest
+// first to the least loaded partition, using instruction counts as the cost
+// model, so one oversized partition does not serialize the whole run. Second,
+// after the partitions are relinked the pass restores the linkage of the
+// symbols it externalized and runs GlobalDCE and ConstantMerge as a
+// reconciliation step; per-partition passes only see a slice of the module
+// and must leave cross-partition cleanup to this final pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Pass.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "parallel-ipo-passes"
+
+static cl::opt<unsigned> ParallelIPOPassThreads(
+    "parallel-ipo-passes-threads", cl::init(2), cl::Hidden,
+    cl::desc("Number of worker threads used by -parallel-ipo-passes"));
+
+static cl::opt<std::string> ParallelIPOPassPipeline(
+    "parallel-ipo-passes-pipeline", cl::init(""), cl::Hidden,
+    cl::desc("Comma-separated list of module pass arguments to run"));
+
+namespace {
+struct ParallelIPOPasses : public ModulePass {
+  static char ID;
+
+  std::string Pipeline;
+  unsigned NumThreads;
+
+  ParallelIPOPasses()
+      : ModulePass(ID), Pipeline(ParallelIPOPassPipeline),
+        NumThreads(ParallelIPOPassThreads) {
+    initializeParallelIPOPassesPass(*PassRegistry::getPassRegistry());
+  }
+  ParallelIPOPasses(StringRef Pipeline, unsigned NumThreads)
+      : ModulePass(ID), Pipeline(Pipeline), NumThreads(NumThreads) {
+    initializeParallelIPOPassesPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override;
+
+private:
+  bool populatePipeline(legacy::PassManagerBase &PM);
+};
+} // end anonymous namespace
+
+char ParallelIPOPasses::ID = 0;
+INITIALIZE_PASS(ParallelIPOPasses, "parallel-ipo-passes",
+                "Run IPO passes over partitions in parallel", false, false)
+
+ModulePass *llvm::createParallelIPOPassesPass(StringRef Pipeline,
+                                              unsigned NumThreads) {
+  return new ParallelIPOPasses(Pipeline, NumThreads);
+}
+
+/// Instantiate the configured pipeline into PM. Returns false (emitting a
+/// diagnostic) if an argument does not name a registered pass.
+bool ParallelIPOPasses::populatePipeline(legacy::PassManagerBase &PM) {
+  SmallVector<StringRef, 8> Names;
+  StringRef(Pipeline).split(Names, ",", /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef Name : Names) {
+    const PassInfo *PI = PassRegistry::getPassRegistry()->getPassInfo(Name);
+    if (!PI || !PI->getNormalCtor()) {
+      errs() << "parallel-ipo-passes: unknown pass '" << Name << "'\n";
+      return false;
+    }
+    // Module, CGSCC, and function passes are all schedulable by the module
+    // pass manager.
+    PM.add(PI->getNormalCtor()());
+  }
+  return true;
+}
+
+/// See splitCodeGen: definitions and references may end up in different
+/// partitions, so local symbols must be externally visible to the linker.
+static void externalize(GlobalValue &GV) {
+  if (!GV.hasName())
+    GV.setName("__llvmsplit_unnamed");
+  GV.setLinkage(GlobalValue::ExternalLinkage);
+  GV.setVisibility(GlobalValue::HiddenVisibility);
+}
+
+bool ParallelIPOPasses::runOnModule(Module &M) {
+  if (Pipeline.empty())
+    return false;
+
+  if (NumThreads <= 1 || !llvm_is_multithreaded() || M.size() < 2 * NumThreads) {
+    legacy::PassManager PM;
+    if (!populatePipeline(PM))
+      return false;
+    return PM.run(M);
+  }
+
+  // Externalize local symbols, remembering their original linkage and
+  // visibility by name so the reconciliation step can restore them once all
+  // partitions are relinked into one module.
+  typedef std::pair<GlobalValue::LinkageTypes, GlobalValue::VisibilityTypes>
+      LinkageInfo;
+  StringMap<LinkageInfo> SavedLinkage;
+  auto ExternalizeAndSave = [&](GlobalValue &GV) {
+    if (!GV.hasLocalLinkage())
+      return;
+    LinkageInfo LI(GV.getLinkage(), GV.getVisibility());
+    externalize(GV);
+    SavedLinkage[GV.getName()] = LI;
+  };
+  for (GlobalVariable &GV : M.globals())
+    ExternalizeAndSave(GV);
+  for (Function &F : M)
+    ExternalizeAndSave(F);
+  for (GlobalAlias &GA : M.aliases())
+    ExternalizeAndSave(GA);
+
+  // Assign function bodies to partitions largest first, each to the least
+  // loaded partition at the time it is placed. Costs are instruction counts.
+  // Placing the heavy bodies before the light ones keeps the partition loads
+  // within one body of each other, where arrival-order placement can leave a
+  // fat partition that serializes the run. Everything that is not a function
+  // body (globals, aliases, named metadata, module inline asm) is owned by
+  // partition 0.
+  std::vector<std::pair<uint64_t, unsigned>> Costs;
+  unsigned Idx = 0;
+  for (Function &F : M) {
+    if (!F.isDeclaration()) {
+      uint64_t Cost = 1;
+      for (const BasicBlock &BB : F)
+        Cost += BB.size();
+      Costs.push_back(std::make_pair(Cost, Idx));
+    }
+    ++Idx;
+  }
+  std::sort(Costs.begin(), Costs.end(),
+            std::greater<std::pair<uint64_t, unsigned>>());
+
+  std::vector<unsigned> Partition(M.size(), 0);
+  std::vector<uint64_t> Load(NumThreads, 0);
+  for (unsigned i = 0, e = Costs.size(); i != e; ++i) {
+    unsigned Part = 0;
+    for (unsigned I = 1; I != NumThreads; ++I)
+      if (Load[I] < Load[Part])
+        Part = I;
+    Load[Part] += Costs[i].first;
+    Partition[Costs[i].second] = Part;
+  }
+
+  SmallString<0> BC;
+  raw_svector_ostream BCOS(BC);
+  WriteBitcodeToFile(&M, BCOS);
+  BCOS.flush();
+
+  std::vector<SmallString<0>> Results(NumThreads);
+  // char, not bool: vector<bool> packs bits and adjacent writes from
+  // different threads would race.
+  std::vector<char> Failed(NumThreads, 0);
+  std::vector<std::thread> Threads;
+  for (unsigned ThreadNo = 0; ThreadNo != NumThreads; ++ThreadNo) {
+    Threads.emplace_back([=, &BC, &Partition, &Results, &Failed] {
+      LLVMContext Ctx;
+      ErrorOr<Module *> MOrErr = parseBitcodeFile(
+          MemoryBufferRef(StringRef(BC.data(), BC.size()), "split"), Ctx);
+      if (!MOrErr) {
+        Failed[ThreadNo] = true;
+        return;
+      }
+      std::unique_ptr<Module> MPart(MOrErr.get());
+
+      unsigned Idx = 0;
+      for (Function &F : *MPart) {
+        if (Partition[Idx] != ThreadNo && !F.isDeclaration())
+          F.deleteBody();
+        ++Idx;
+      }
+      if (ThreadNo != 0) {
+        for (GlobalVariable &GV : MPart->globals())
+          if (GV.hasInitializer())
+            GV.setInitializer(nullptr);
+        MPart->setModuleInlineAsm("");
+        while (!MPart->named_metadata_empty())
+          MPart->named_metadata_begin()->eraseFromParent();
+        // Replace alias definitions with declarations of the aliased symbol
+        // so that only partition 0 defines them.
+        for (auto I = MPart->alias_begin(), E = MPart->alias_end(); I != E;) {
+          GlobalAlias *GA = &*I++;
+          std::string Name = GA->getName();
+          GA->setName("");
+          GlobalValue *Decl;
+          Type *ValTy = GA->getType()->getElementType();
+          if (FunctionType *FTy = dyn_cast<FunctionType>(ValTy))
+            Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, Name,
+                                    MPart.get());
+          else
+            Decl = new GlobalVariable(*MPart, ValTy, false,
+                                      GlobalValue::ExternalLinkage, nullptr,
+                                      Name);
+          GA->replaceAllUsesWith(Decl);
+          GA->eraseFromParent();
+        }
+      }
+
+      legacy::PassManager PM;
+      if (!populatePipeline(PM)) {
+        Failed[ThreadNo] = true;
+        return;
+      }
+      PM.run(*MPart);
+
+      raw_svector_ostream OS(Results[ThreadNo]);
+      WriteBitcodeToFile(MPart.get(), OS);
+      OS.flush();
+    });
+  }
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned I = 0; I != NumThreads; ++I)
+    if (Failed[I])
+      report_fatal_error("parallel-ipo-passes: worker failed");
+
+  // Empty the original module and link the optimized partitions back in. The
+  // partitions were parsed in worker contexts, so reparse each result in this
+  // module's context for the linker.
+  M.dropAllReferences();
+  while (!M.alias_empty())
+    M.alias_begin()->eraseFromParent();
+  while (!M.global_empty())
+    M.global_begin()->eraseFromParent();
+  while (!M.empty())
+    M.begin()->eraseFromParent();
+  while (!M.named_metadata_empty())
+    M.named_metadata_begin()->eraseFromParent();
+  M.setModuleInlineAsm("");
+
+  Linker L(&M);
+  for (unsigned I = 0; I != NumThreads; ++I) {
+    ErrorOr<Module *> MOrErr = parseBitcodeFile(
+        MemoryBufferRef(StringRef(Results[I].data(), Results[I].size()),
+                        "partition"),
+        M.getContext());
+    if (!MOrErr)
+      report_fatal_error("parallel-ipo-passes: bad partition bitcode");
+    std::unique_ptr<Module> Src(MOrErr.get());
+    if (L.linkInModule(Src.get()))
+      report_fatal_error("parallel-ipo-passes: relink failed");
+  }
+
+  // Reconcile across partitions: give the externalized locals their original
+  // linkage back, then clean up what the per-partition passes could not see
+  // was dead or duplicated.
+  auto RestoreLinkage = [&](GlobalValue &GV) {
+    StringMap<LinkageInfo>::iterator I = SavedLinkage.find(GV.getName());
+    if (I == SavedLinkage.end())
+      return;
+    GV.setLinkage(I->second.first);
+    GV.setVisibility(I->second.second);
+  };
+  for (GlobalVariable &GV : M.globals())
+    RestoreLinkage(GV);
+  for (Function &F : M)
+    RestoreLinkage(F);
+  for (GlobalAlias &GA : M.aliases())
+    RestoreLinkage(GA);
+
+  legacy::PassManager ReconcilePM;
+  ReconcilePM.add(createGlobalDCEPass());
+  ReconcilePM.add(createConstantMergePass());
+  ReconcilePM.run(M);
+
+  return true;
+}
@@ -17,11 +17,16 @@
 #include "llvm-c/Transforms/PassManagerBuilder.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/Passes.h"
+#include "llvm/IR/CompileDeadline.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/LineIterator.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
@@ -71,17 +76,29 @@ RunSLPAfterLoopVectorization("run-slp-after-loop-vectorization",
 
 static cl::opt<bool> UseCFLAA("use-cfl-aa",
   cl::init(false), cl::Hidden,
-  cl::desc("Enable the new, experimental CFL alias analysis"));
+  cl::desc("Enable the new, experimental CFL alias analysis as a "
+           "summary-based pre-filter in front of BasicAA"));
 
 static cl::opt<bool>
 EnableMLSM("mlsm", cl::init(true), cl::Hidden,
            cl::desc("Enable motion of merged load and store"));
 
+static cl::opt<bool> EnableHotColdSplit(
+    "hot-cold-split", cl::init(false), cl::Hidden,
+    cl::desc("Enable hot/cold splitting of functions"));
+
+static cl::opt<std::string> PipelineTuningFile(
+    "pipeline-tuning-file", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Apply the pipeline knob overrides for the matching module "
+             "category from the given file (see "
+             "PassManagerBuilder::applyPipelineTuning)"));
+
 PassManagerBuilder::PassManagerBuilder() {
     OptLevel = 2;
     SizeLevel = 0;
     LibraryInfo = nullptr;
     Inliner = nullptr;
+    Deadline = nullptr;
     DisableTailCalls = false;
     DisableUnitAtATime = false;
     DisableUnrollLoops = false;
@@ -112,6 +129,158 @@ void PassManagerBuilder::addGlobalExtension(
   GlobalExtensions->push_back(std::make_pair(Ty, Fn));
 }
 
+namespace {
+/// A category from a -pipeline-tuning-file: the shape limits a module must
+/// satisfy to belong to it, and the knob overrides applied when it does.
+struct PipelineTuningCategory {
+  std::string Name;
+  // Shape limits. Zero and UINT64_MAX mean unconstrained.
+  uint64_t MinFunctions, MaxFunctions;
+  uint64_t MinAvgBlocks, MaxAvgBlocks;
+  // Knob overrides. Negative values mean "leave the builder's setting alone".
+  int InlineThreshold;
+  int LoopVectorize, SLPVectorize, BBVectorize;
+  int UnrollLoops, RerollLoops, LoadCombine, MergeFunctions;
+
+  PipelineTuningCategory(StringRef Name)
+      : Name(Name), MinFunctions(0), MaxFunctions(UINT64_MAX), MinAvgBlocks(0),
+        MaxAvgBlocks(UINT64_MAX), InlineThreshold(-1), LoopVectorize(-1),
+        SLPVectorize(-1), BBVectorize(-1), UnrollLoops(-1), RerollLoops(-1),
+        LoadCombine(-1), MergeFunctions(-1) {}
+
+  bool matches(uint64_t NumFunctions, uint64_t AvgBlocks) const {
+    return NumFunctions >= MinFunctions && NumFunctions <= MaxFunctions &&
+           AvgBlocks >= MinAvgBlocks && AvgBlocks <= MaxAvgBlocks;
+  }
+};
+} // anonymous namespace
+
+/// Parse the tuning file \p Path. The format is line based: '[name]' starts a
+/// category, '#' starts a comment, and 'key = value' lines fill in the
+/// current category's limits (min-functions, max-functions, min-avg-blocks,
+/// max-avg-blocks) and knobs (inline-threshold, and the 0/1 toggles
+/// loop-vectorize, slp-vectorize, bb-vectorize, unroll-loops, reroll-loops,
+/// combine-loads, merge-functions).
+static void
+parsePipelineTuningFile(StringRef Path,
+                        std::vector<PipelineTuningCategory> &Categories) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr = MemoryBuffer::getFile(Path);
+  if (std::error_code EC = BufOrErr.getError())
+    report_fatal_error("could not open '" + Path + "': " + EC.message());
+
+  for (line_iterator LineIt(*BufOrErr.get(), /*SkipBlanks=*/true, '#');
+       !LineIt.is_at_eof(); ++LineIt) {
+    StringRef Line = LineIt->trim();
+    if (Line.empty())
+      continue;
+
+    if (Line.startswith("[")) {
+      if (!Line.endswith("]") || Line.size() < 3)
+        report_fatal_error(Path + ":" + Twine(LineIt.line_number()) +
+                           ": malformed category header");
+      Categories.push_back(
+          PipelineTuningCategory(Line.slice(1, Line.size() - 1)));
+      continue;
+    }
+    if (Categories.empty())
+      report_fatal_error(Path + ":" + Twine(LineIt.line_number()) +
+                         ": setting outside any category");
+
+    std::pair<StringRef, StringRef> KV = Line.split('=');
+    StringRef Key = KV.first.trim(), Value = KV.second.trim();
+    PipelineTuningCategory &C = Categories.back();
+    bool Malformed = Value.empty();
+
+    auto ParseToggle = [&](int &Knob) {
+      unsigned B = 0;
+      if (Value.getAsInteger(10, B) || B > 1)
+        Malformed = true;
+      else
+        Knob = B;
+    };
+
+    if (Key == "min-functions")
+      Malformed |= Value.getAsInteger(10, C.MinFunctions);
+    else if (Key == "max-functions")
+      Malformed |= Value.getAsInteger(10, C.MaxFunctions);
+    else if (Key == "min-avg-blocks")
+      Malformed |= Value.getAsInteger(10, C.MinAvgBlocks);
+    else if (Key == "max-avg-blocks")
+      Malformed |= Value.getAsInteger(10, C.MaxAvgBlocks);
+    else if (Key == "inline-threshold")
+      Malformed |= Value.getAsInteger(10, C.InlineThreshold) ||
+                   C.InlineThreshold < 0;
+    else if (Key == "loop-vectorize")
+      ParseToggle(C.LoopVectorize);
+    else if (Key == "slp-vectorize")
+      ParseToggle(C.SLPVectorize);
+    else if (Key == "bb-vectorize")
+      ParseToggle(C.BBVectorize);
+    else if (Key == "unroll-loops")
+      ParseToggle(C.UnrollLoops);
+    else if (Key == "reroll-loops")
+      ParseToggle(C.RerollLoops);
+    else if (Key == "combine-loads")
+      ParseToggle(C.LoadCombine);
+    else if (Key == "merge-functions")
+      ParseToggle(C.MergeFunctions);
+    else
+      report_fatal_error(Path + ":" + Twine(LineIt.line_number()) +
+                         ": unknown setting '" + Key + "'");
+
+    if (Malformed)
+      report_fatal_error(Path + ":" + Twine(LineIt.line_number()) +
+                         ": malformed value for '" + Key + "'");
+  }
+}
+
+void PassManagerBuilder::applyPipelineTuning(const Module &M) {
+  if (PipelineTuningFile.empty())
+    return;
+
+  std::vector<PipelineTuningCategory> Categories;
+  parsePipelineTuningFile(PipelineTuningFile, Categories);
+
+  // Categorize the module by cheap shape features.
+  uint64_t NumFunctions = 0, NumBlocks = 0;
+  for (Module::const_iterator I = M.begin(), E = M.end(); I != E; ++I) {
+    if (I->isDeclaration())
+      continue;
+    ++NumFunctions;
+    NumBlocks += I->size();
+  }
+  uint64_t AvgBlocks = NumFunctions ? NumBlocks / NumFunctions : 0;
+
+  // A module belongs to the first category whose limits it satisfies.
+  const PipelineTuningCategory *C = nullptr;
+  for (unsigned i = 0, e = Categories.size(); i != e; ++i)
+    if (Categories[i].matches(NumFunctions, AvgBlocks)) {
+      C = &Categories[i];
+      break;
+    }
+  if (!C)
+    return;
+
+  if (C->InlineThreshold >= 0 && Inliner) {
+    delete Inliner;
+    Inliner = createFunctionInliningPass(C->InlineThreshold);
+  }
+  if (C->LoopVectorize >= 0)
+    LoopVectorize = C->LoopVectorize;
+  if (C->SLPVectorize >= 0)
+    SLPVectorize = C->SLPVectorize;
+  if (C->BBVectorize >= 0)
+    BBVectorize = C->BBVectorize;
+  if (C->UnrollLoops >= 0)
+    DisableUnrollLoops = !C->UnrollLoops;
+  if (C->RerollLoops >= 0)
+    RerollLoops = C->RerollLoops;
+  if (C->LoadCombine >= 0)
+    LoadCombine = C->LoadCombine;
+  if (C->MergeFunctions >= 0)
+    MergeFunctions = C->MergeFunctions;
+}
+
 void PassManagerBuilder::addExtension(ExtensionPointTy Ty, ExtensionFn Fn) {
   Extensions.push_back(std::make_pair(Ty, Fn));
 }
@@ -126,16 +295,28 @@ void PassManagerBuilder::addExtensionsToPM(ExtensionPointTy ETy,
       Extensions[i].second(*this, PM);
 }
 
+/// Register \p P as deferrable on the compile deadline, if one was given.
+/// Deferrable passes are skipped once an armed deadline's budget is spent.
+Pass *PassManagerBuilder::deferrable(Pass *P) const {
+  if (Deadline)
+    Deadline->addDeferrablePass(P->getPassID());
+  return P;
+}
+
 void PassManagerBuilder::addInitialAliasAnalysisPasses(
     legacy::PassManagerBase &PM) const {
   // Add TypeBasedAliasAnalysis before BasicAliasAnalysis so that
   // BasicAliasAnalysis wins if they disagree. This is intended to help
   // support "obvious" type-punning idioms.
-  if (UseCFLAA)
-    PM.add(createCFLAliasAnalysisPass());
   PM.add(createTypeBasedAliasAnalysisPass());
   PM.add(createScopedNoAliasAAPass());
   PM.add(createBasicAliasAnalysisPass());
+  // Add CFLAliasAnalysis after BasicAliasAnalysis so that its cached
+  // per-function points-to summary is consulted first, as a constant-time
+  // pre-filter: only queries the summary cannot decide fall through to
+  // BasicAA's GEP decomposition walk.
+  if (UseCFLAA)
+    PM.add(createCFLAliasAnalysisPass());
 }
 
 void PassManagerBuilder::populateFunctionPassManager(
@@ -202,6 +383,10 @@ void PassManagerBuilder::populateModulePassManager(
     MPM.add(createCFGSimplificationPass());   // Clean up after IPCP & DAE
   }
 
+  // Promote profiled indirect calls before the inliner so the guarded
+  // direct calls it introduces are inlining candidates.
+  MPM.add(createIndirectCallPromotionPass());
+
   // Start of CallGraph SCC passes.
   if (!DisableUnitAtATime)
     MPM.add(createPruneEHPass());             // Remove dead EH info
@@ -247,7 +432,7 @@ void PassManagerBuilder::populateModulePassManager(
   if (OptLevel > 1) {
     if (EnableMLSM)
       MPM.add(createMergedLoadStoreMotionPass()); // Merge ld/st in diamonds
-    MPM.add(createGVNPass(DisableGVNLoadPRE));  // Remove redundancies
+    MPM.add(deferrable(createGVNPass(DisableGVNLoadPRE))); // Remove redundancies
   }
   MPM.add(createMemCpyOptPass());             // Remove memcpy / form memset
   MPM.add(createSCCPPass());                  // Constant prop with SCCP
@@ -272,14 +457,15 @@ void PassManagerBuilder::populateModulePassManager(
     MPM.add(createLoopRerollPass());
   if (!RunSLPAfterLoopVectorization) {
     if (SLPVectorize)
-      MPM.add(createSLPVectorizerPass());   // Vectorize parallel scalar chains.
+      MPM.add(deferrable(createSLPVectorizerPass())); // Vectorize parallel
+                                                     // scalar chains.
 
     if (BBVectorize) {
-      MPM.add(createBBVectorizePass());
+      MPM.add(deferrable(createBBVectorizePass()));
       MPM.add(createInstructionCombiningPass());
       addExtensionsToPM(EP_Peephole, MPM);
       if (OptLevel > 1 && UseGVNAfterVectorization)
-        MPM.add(createGVNPass(DisableGVNLoadPRE)); // Remove redundancies
+        MPM.add(deferrable(createGVNPass(DisableGVNLoadPRE)));
       else
         MPM.add(createEarlyCSEPass());      // Catch trivial redundancies
 
@@ -308,7 +494,8 @@ void PassManagerBuilder::populateModulePassManager(
   if (ExtraVectorizerPasses)
     MPM.add(createLoopRotatePass());
 
-  MPM.add(createLoopVectorizePass(DisableUnrollLoops, LoopVectorize));
+  MPM.add(deferrable(createLoopVectorizePass(DisableUnrollLoops,
+                                             LoopVectorize)));
   // FIXME: Because of #pragma vectorize enable, the passes below are always
   // inserted in the pipeline, even when the vectorizer doesn't run (ex. when
   // on -O1 and no #pragma is found). Would be good to have these two passes
@@ -333,18 +520,19 @@ void PassManagerBuilder::populateModulePassManager(
 
   if (RunSLPAfterLoopVectorization) {
     if (SLPVectorize) {
-      MPM.add(createSLPVectorizerPass());   // Vectorize parallel scalar chains.
+      MPM.add(deferrable(createSLPVectorizerPass())); // Vectorize parallel
+                                                      // scalar chains.
       if (OptLevel > 1 && ExtraVectorizerPasses) {
         MPM.add(createEarlyCSEPass());
       }
     }
 
     if (BBVectorize) {
-      MPM.add(createBBVectorizePass());
+      MPM.add(deferrable(createBBVectorizePass()));
       MPM.add(createInstructionCombiningPass());
       addExtensionsToPM(EP_Peephole, MPM);
       if (OptLevel > 1 && UseGVNAfterVectorization)
-        MPM.add(createGVNPass(DisableGVNLoadPRE)); // Remove redundancies
+        MPM.add(deferrable(createGVNPass(DisableGVNLoadPRE)));
       else
         MPM.add(createEarlyCSEPass());      // Catch trivial redundancies
 
@@ -380,6 +568,11 @@ void PassManagerBuilder::populateModulePassManager(
   if (MergeFunctions)
     MPM.add(createMergeFunctionsPass());
 
+  // Split out cold regions late, after the shape of the hot code has settled
+  // and branch weights have had every chance to propagate.
+  if (EnableHotColdSplit)
+    MPM.add(createHotColdSplittingPass());
+
   addExtensionsToPM(EP_OptimizerLast, MPM);
 }
 
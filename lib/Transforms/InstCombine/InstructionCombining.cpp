@@ -2618,9 +2618,13 @@ static bool TryToSinkInstruction(Instruction *I, BasicBlock *DestBlock) {
 }
 
 bool InstCombiner::run() {
+  // Prefer draining worklist entries for the block we last visited before
+  // hopping to another one; see InstCombineWorklist::RemoveOne.
+  const BasicBlock *CurBB = nullptr;
   while (!Worklist.isEmpty()) {
-    Instruction *I = Worklist.RemoveOne();
+    Instruction *I = Worklist.RemoveOne(CurBB);
     if (I == nullptr) continue;  // skip null values.
+    CurBB = I->getParent();
 
     // Check to see if we can DCE the instruction.
     if (isInstructionTriviallyDead(I, TLI)) {
@@ -19,12 +19,21 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Transforms/Utils/ModuleUtils.h"
 
 using namespace llvm;
 
 #define DEBUG_TYPE "instrprof"
 
+// Emit 4-byte region counters instead of 8-byte ones.  Compact counters
+// saturate at UINT32_MAX instead of wrapping, halve the size of the counter
+// sections that instrumented binaries write out, and require a profile
+// runtime built to match.
+static cl::opt<bool> CompactCounters(
+    "instrprof-compact-counters", cl::init(false), cl::Hidden,
+    cl::desc("Use 4-byte saturating region counters"));
+
 namespace {
 
 class InstrProfiling : public ModulePass {
@@ -147,7 +156,15 @@ void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   uint64_t Index = Inc->getIndex()->getZExtValue();
   llvm::Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters, 0, Index);
   llvm::Value *Count = Builder.CreateLoad(Addr, "pgocount");
-  Count = Builder.CreateAdd(Count, Builder.getInt64(1));
+  if (CompactCounters) {
+    // Compact counters saturate rather than wrap, so that a pinned counter
+    // reads as "hot beyond measurement" instead of as a small value.
+    llvm::Value *Incremented = Builder.CreateAdd(Count, Builder.getInt32(1));
+    llvm::Value *IsPinned = Builder.CreateICmpEQ(Count, Builder.getInt32(~0U));
+    Count = Builder.CreateSelect(IsPinned, Count, Incremented);
+  } else {
+    Count = Builder.CreateAdd(Count, Builder.getInt64(1));
+  }
   Inc->replaceAllUsesWith(Builder.CreateStore(Count, Addr));
   Inc->eraseFromParent();
 }
@@ -201,7 +218,9 @@ InstrProfiling::getOrCreateRegionCounters(InstrProfIncrementInst *Inc) {
 
   uint64_t NumCounters = Inc->getNumCounters()->getZExtValue();
   LLVMContext &Ctx = M->getContext();
-  ArrayType *CounterTy = ArrayType::get(Type::getInt64Ty(Ctx), NumCounters);
+  Type *CounterElemTy =
+      CompactCounters ? Type::getInt32Ty(Ctx) : Type::getInt64Ty(Ctx);
+  ArrayType *CounterTy = ArrayType::get(CounterElemTy, NumCounters);
 
   // Create the counters variable.
   auto *Counters = new GlobalVariable(*M, CounterTy, false, Name->getLinkage(),
@@ -209,7 +228,7 @@ InstrProfiling::getOrCreateRegionCounters(InstrProfIncrementInst *Inc) {
                                       getVarName(Inc, "counters"));
   Counters->setVisibility(Name->getVisibility());
   Counters->setSection(getCountersSection());
-  Counters->setAlignment(8);
+  Counters->setAlignment(CompactCounters ? 4 : 8);
 
   RegionCounters[Inc->getName()] = Counters;
 
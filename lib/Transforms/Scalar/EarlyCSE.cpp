@@ -13,8 +13,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Scalar/EarlyCSE.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
-#include "llvm/ADT/ScopedHashTable.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/InstructionSimplify.h"
@@ -26,7 +27,6 @@
 #include "llvm/IR/PatternMatch.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/Debug.h"
-#include "llvm/Support/RecyclingAllocator.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Local.h"
@@ -47,7 +47,8 @@ STATISTIC(NumDSE,      "Number of trivial dead stores removed");
 //===----------------------------------------------------------------------===//
 
 namespace {
-/// \brief Struct representing the available values in the scoped hash table.
+/// \brief Struct representing the available values in the available-values
+/// table.
 struct SimpleValue {
   Instruction *Inst;
 
@@ -193,8 +194,8 @@ bool DenseMapInfo<SimpleValue>::isEqual(SimpleValue LHS, SimpleValue RHS) {
 //===----------------------------------------------------------------------===//
 
 namespace {
-/// \brief Struct representing the available call values in the scoped hash
-/// table.
+/// \brief Struct representing the available call values in the
+/// available-calls table.
 struct CallValue {
   Instruction *Inst;
 
@@ -248,6 +249,75 @@ bool DenseMapInfo<CallValue>::isEqual(CallValue LHS, CallValue RHS) {
   return LHSI->isIdenticalTo(RHSI);
 }
 
+//===----------------------------------------------------------------------===//
+// DomScopedTable
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// \brief Hash table of values available within a dominator sub-tree.
+///
+/// This replaces ScopedHashTable for EarlyCSE's walk.  Instead of pushing and
+/// popping a scope (and recycling its allocations) for every dominator tree
+/// node, entries are stamped with the DFS-in/out interval of the node that
+/// inserted them, and validity is a containment check against the node
+/// currently being processed.  Because the walk is a depth-first traversal of
+/// the dominator tree, an entry whose sub-tree has been completed can never
+/// become visible again, so dead entries are popped lazily the next time
+/// their key is touched instead of eagerly on scope exit.
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class DomScopedTable {
+  struct Entry {
+    ValueT Val;
+    unsigned DFSIn, DFSOut;
+  };
+
+  /// Per-key stack of entries, outermost dominator first.  Shadowing inserts
+  /// from dominated blocks push on top.
+  DenseMap<KeyT, SmallVector<Entry, 2>, KeyInfoT> Map;
+
+  /// DFS-in number of the dominator tree node being processed.
+  unsigned CurDFSIn;
+
+  bool isLive(const Entry &E) const {
+    return E.DFSIn <= CurDFSIn && CurDFSIn <= E.DFSOut;
+  }
+
+  /// Pop entries from completed sub-trees off the top of a key's stack.
+  void popDead(SmallVectorImpl<Entry> &Stack) {
+    while (!Stack.empty() && !isLive(Stack.back()))
+      Stack.pop_back();
+  }
+
+public:
+  DomScopedTable() : CurDFSIn(0) {}
+
+  /// Position the table at \p Node before processing its block.
+  void enterBlock(const DomTreeNode *Node) { CurDFSIn = Node->getDFSNumIn(); }
+
+  ValueT lookup(KeyT Key) {
+    auto It = Map.find(Key);
+    if (It == Map.end())
+      return ValueT();
+    popDead(It->second);
+    if (It->second.empty()) {
+      Map.erase(It);
+      return ValueT();
+    }
+    return It->second.back().Val;
+  }
+
+  void insert(KeyT Key, ValueT Val, const DomTreeNode *Node) {
+    SmallVector<Entry, 2> &Stack = Map[Key];
+    popDead(Stack);
+    Entry E = {Val, Node->getDFSNumIn(), Node->getDFSNumOut()};
+    Stack.push_back(E);
+  }
+
+  void reserve(unsigned NumEntries) { Map.reserve(NumEntries); }
+};
+}
+
 //===----------------------------------------------------------------------===//
 // EarlyCSE implementation
 //===----------------------------------------------------------------------===//
@@ -268,20 +338,17 @@ public:
   const TargetTransformInfo &TTI;
   DominatorTree &DT;
   AssumptionCache &AC;
-  typedef RecyclingAllocator<
-      BumpPtrAllocator, ScopedHashTableVal<SimpleValue, Value *>> AllocatorTy;
-  typedef ScopedHashTable<SimpleValue, Value *, DenseMapInfo<SimpleValue>,
-                          AllocatorTy> ScopedHTType;
+  typedef DomScopedTable<SimpleValue, Value *> ValueHTType;
 
-  /// \brief A scoped hash table of the current values of all of our simple
-  /// scalar expressions.
+  /// \brief A dominator-scoped hash table of the current values of all of our
+  /// simple scalar expressions.
   ///
   /// As we walk down the domtree, we look to see if instructions are in this:
   /// if so, we replace them with what we find, otherwise we insert them so
   /// that dominated values can succeed in their lookup.
-  ScopedHTType AvailableValues;
+  ValueHTType AvailableValues;
 
-  /// \brief A scoped hash table of the current values of loads.
+  /// \brief A dominator-scoped hash table of the current values of loads.
   ///
   /// This allows us to get efficient access to dominating loads when we have
   /// a fully redundant load.  In addition to the most recent load, we keep
@@ -289,19 +356,14 @@ public:
   /// current generation count.  The current generation count is incremented
   /// after every possibly writing memory operation, which ensures that we only
   /// CSE loads with other loads that have no intervening store.
-  typedef RecyclingAllocator<
-      BumpPtrAllocator,
-      ScopedHashTableVal<Value *, std::pair<Value *, unsigned>>>
-      LoadMapAllocator;
-  typedef ScopedHashTable<Value *, std::pair<Value *, unsigned>,
-                          DenseMapInfo<Value *>, LoadMapAllocator> LoadHTType;
+  typedef DomScopedTable<Value *, std::pair<Value *, unsigned>> LoadHTType;
   LoadHTType AvailableLoads;
 
-  /// \brief A scoped hash table of the current values of read-only call
-  /// values.
+  /// \brief A dominator-scoped hash table of the current values of read-only
+  /// call values.
   ///
   /// It uses the same generation count as loads.
-  typedef ScopedHashTable<CallValue, std::pair<Value *, unsigned>> CallHTType;
+  typedef DomScopedTable<CallValue, std::pair<Value *, unsigned>> CallHTType;
   CallHTType AvailableCalls;
 
   /// \brief This is the current generation of the memory value.
@@ -317,37 +379,17 @@ public:
   bool run();
 
 private:
-  // Almost a POD, but needs to call the constructors for the scoped hash
-  // tables so that a new scope gets pushed on. These are RAII so that the
-  // scope gets popped when the NodeScope is destroyed.
-  class NodeScope {
-  public:
-    NodeScope(ScopedHTType &AvailableValues, LoadHTType &AvailableLoads,
-              CallHTType &AvailableCalls)
-        : Scope(AvailableValues), LoadScope(AvailableLoads),
-          CallScope(AvailableCalls) {}
-
-  private:
-    NodeScope(const NodeScope &) = delete;
-    void operator=(const NodeScope &) = delete;
-
-    ScopedHTType::ScopeTy Scope;
-    LoadHTType::ScopeTy LoadScope;
-    CallHTType::ScopeTy CallScope;
-  };
-
   // Contains all the needed information to create a stack for doing a depth
-  // first tranversal of the tree. This includes scopes for values, loads, and
-  // calls as well as the generation. There is a child iterator so that the
-  // children do not need to be store spearately.
+  // first tranversal of the tree. This includes the generation to restore for
+  // the node's children. There is a child iterator so that the children do
+  // not need to be store spearately. The available-value tables scope their
+  // entries by DFS interval, so no per-node state is needed for them.
   class StackNode {
   public:
-    StackNode(ScopedHTType &AvailableValues, LoadHTType &AvailableLoads,
-              CallHTType &AvailableCalls, unsigned cg, DomTreeNode *n,
-              DomTreeNode::iterator child, DomTreeNode::iterator end)
+    StackNode(unsigned cg, DomTreeNode *n, DomTreeNode::iterator child,
+              DomTreeNode::iterator end)
         : CurrentGeneration(cg), ChildGeneration(cg), Node(n), ChildIter(child),
-          EndIter(end), Scopes(AvailableValues, AvailableLoads, AvailableCalls),
-          Processed(false) {}
+          EndIter(end), Processed(false) {}
 
     // Accessors.
     unsigned currentGeneration() { return CurrentGeneration; }
@@ -374,7 +416,6 @@ private:
     DomTreeNode *Node;
     DomTreeNode::iterator ChildIter;
     DomTreeNode::iterator EndIter;
-    NodeScope Scopes;
     bool Processed;
   };
 
@@ -453,6 +494,12 @@ private:
 bool EarlyCSE::processNode(DomTreeNode *Node) {
   BasicBlock *BB = Node->getBlock();
 
+  // Entries inserted while processing this node are tagged with its DFS
+  // interval and expire with its sub-tree.
+  AvailableValues.enterBlock(Node);
+  AvailableLoads.enterBlock(Node);
+  AvailableCalls.enterBlock(Node);
+
   // If this block has a single predecessor, then the predecessor is the parent
   // of the domtree node and all of the live out memory values are still current
   // in this block.  If this block has multiple predecessors, then they could
@@ -517,7 +564,7 @@ bool EarlyCSE::processNode(DomTreeNode *Node) {
       }
 
       // Otherwise, just remember that this value is available.
-      AvailableValues.insert(Inst, Inst);
+      AvailableValues.insert(Inst, Inst, Node);
       continue;
     }
 
@@ -553,7 +600,8 @@ bool EarlyCSE::processNode(DomTreeNode *Node) {
 
       // Otherwise, remember that we have this instruction.
       AvailableLoads.insert(MemInst.getPtr(), std::pair<Value *, unsigned>(
-                                                  Inst, CurrentGeneration));
+                                                  Inst, CurrentGeneration),
+                            Node);
       LastStore = nullptr;
       continue;
     }
@@ -585,7 +633,7 @@ bool EarlyCSE::processNode(DomTreeNode *Node) {
 
       // Otherwise, remember that we have this instruction.
       AvailableCalls.insert(
-          Inst, std::pair<Value *, unsigned>(Inst, CurrentGeneration));
+          Inst, std::pair<Value *, unsigned>(Inst, CurrentGeneration), Node);
       continue;
     }
 
@@ -617,7 +665,8 @@ bool EarlyCSE::processNode(DomTreeNode *Node) {
         // to non-volatile loads, so we don't have to check for volatility of
         // the store.
         AvailableLoads.insert(MemInst.getPtr(), std::pair<Value *, unsigned>(
-                                                    Inst, CurrentGeneration));
+                                                    Inst, CurrentGeneration),
+                              Node);
 
         // Remember that this was the last store we saw for DSE.
         if (!MemInst.isVolatile())
@@ -639,10 +688,25 @@ bool EarlyCSE::run() {
 
   bool Changed = false;
 
+  // Size the available-value tables from the instruction count. At most every
+  // instruction is live in them at once, so reserving up front removes the
+  // rehash-and-copy cycles from the insertion path on large functions.
+  unsigned NumInsts = 0;
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB)
+    NumInsts += BB->size();
+  AvailableValues.reserve(NumInsts);
+  AvailableLoads.reserve(NumInsts);
+  AvailableCalls.reserve(NumInsts);
+
+  // The available-value tables scope their entries by dominator tree DFS
+  // intervals, so make sure the numbers are computed before the walk.  The
+  // pass does not change the CFG, so they stay valid throughout.
+  DT.updateDFSNumbers();
+
   // Process the root node.
-  nodesToProcess.push_back(new StackNode(
-      AvailableValues, AvailableLoads, AvailableCalls, CurrentGeneration,
-      DT.getRootNode(), DT.getRootNode()->begin(), DT.getRootNode()->end()));
+  nodesToProcess.push_back(
+      new StackNode(CurrentGeneration, DT.getRootNode(),
+                    DT.getRootNode()->begin(), DT.getRootNode()->end()));
 
   // Save the current generation.
   unsigned LiveOutGeneration = CurrentGeneration;
@@ -665,10 +729,9 @@ bool EarlyCSE::run() {
     } else if (NodeToProcess->childIter() != NodeToProcess->end()) {
       // Push the next child onto the stack.
       DomTreeNode *child = NodeToProcess->nextChild();
-      nodesToProcess.push_back(
-          new StackNode(AvailableValues, AvailableLoads, AvailableCalls,
-                        NodeToProcess->childGeneration(), child, child->begin(),
-                        child->end()));
+      nodesToProcess.push_back(new StackNode(NodeToProcess->childGeneration(),
+                                             child, child->begin(),
+                                             child->end()));
     } else {
       // It has been processed, and there are no more children to process,
       // so delete it and pop it off the stack.
@@ -128,6 +128,7 @@ namespace {
     uint32_t lookup_or_add_cmp(unsigned Opcode, CmpInst::Predicate Pred,
                                Value *LHS, Value *RHS);
     void add(Value *V, uint32_t num);
+    void reserve(unsigned NumInsts);
     void clear();
     void erase(Value *v);
     void setAliasAnalysis(AliasAnalysis* A) { AA = A; }
@@ -278,6 +279,15 @@ void ValueTable::add(Value *V, uint32_t num) {
   valueNumbering.insert(std::make_pair(V, num));
 }
 
+/// reserve - Pre-size the tables for a function with NumInsts instructions.
+/// The instruction count bounds the number of values and expressions that can
+/// be numbered, so sizing up front avoids the rehash-and-copy cycles that
+/// otherwise dominate table time on large functions.
+void ValueTable::reserve(unsigned NumInsts) {
+  valueNumbering.reserve(NumInsts);
+  expressionNumbering.reserve(NumInsts);
+}
+
 uint32_t ValueTable::lookup_or_add_call(CallInst *C) {
   if (AA->doesNotAccessMemory(C)) {
     Expression exp = create_expression(C);
@@ -2365,6 +2375,13 @@ bool GVN::runOnFunction(Function& F) {
   VN.setMemDep(MD);
   VN.setDomTree(DT);
 
+  // Size the value numbering tables from the instruction count so numbering
+  // the function doesn't grow them incrementally.
+  unsigned NumInsts = 0;
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB)
+    NumInsts += BB->size();
+  VN.reserve(NumInsts);
+
   bool Changed = false;
   bool ShouldContinue = true;
 
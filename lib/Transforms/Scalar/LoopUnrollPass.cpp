@@ -14,6 +14,8 @@
 
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/CodeMetrics.h"
 #include "llvm/Analysis/LoopPass.h"
@@ -27,6 +29,7 @@
 #include "llvm/IR/Metadata.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/UnrollLoop.h"
 #include "llvm/IR/InstVisitor.h"
@@ -76,6 +79,13 @@ PragmaUnrollThreshold("pragma-unroll-threshold", cl::init(16 * 1024), cl::Hidden
   cl::desc("Unrolled size limit for loops with an unroll(full) or "
            "unroll_count pragma."));
 
+static cl::opt<std::string> UnrollFeedbackFile(
+    "unroll-feedback-file", cl::init(""), cl::Hidden,
+    cl::desc("File of measured unroll factors, one '<function>:<header>"
+             " <count>' per line.  Matching loops use the recorded count"
+             " (0 or 1 leaves the loop alone) in place of heuristics and"
+             " pragmas."));
+
 namespace {
   class LoopUnroll : public LoopPass {
   public:
@@ -634,6 +644,66 @@ static unsigned UnrollCountPragmaValue(const Loop *L) {
   return 0;
 }
 
+// Parse -unroll-feedback-file on first use.  The file is produced by
+// measurement tooling that attributes post-codegen block sizes and stalls
+// back to source loops and distills them into per-loop unroll factors; here
+// we only consume the distilled result.  Returns null if no usable file was
+// given.
+static const StringMap<unsigned> *getUnrollFeedbackMap() {
+  static StringMap<unsigned> Map;
+  static bool Initialized = false;
+  static bool Usable = false;
+  if (!Initialized) {
+    Initialized = true;
+    if (UnrollFeedbackFile.empty())
+      return nullptr;
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFile(UnrollFeedbackFile);
+    if (!BufOrErr) {
+      errs() << "warning: could not read unroll feedback file '"
+             << UnrollFeedbackFile << "'\n";
+      return nullptr;
+    }
+    StringRef Rest = (*BufOrErr)->getBuffer();
+    while (!Rest.empty()) {
+      StringRef Line;
+      std::tie(Line, Rest) = Rest.split('\n');
+      Line = Line.trim();
+      if (Line.empty() || Line.startswith("#"))
+        continue;
+      StringRef Key, CountStr;
+      std::tie(Key, CountStr) = Line.rsplit(' ');
+      unsigned Count;
+      if (Key.empty() || CountStr.trim().getAsInteger(10, Count))
+        continue;
+      Map[Key] = Count;
+    }
+    Usable = true;
+  }
+  return Usable ? &Map : nullptr;
+}
+
+// If measured feedback identifies this loop, return true and set Count to the
+// recorded factor.  Loops are keyed by "<function>:<header block name>",
+// which survives the mid-level pipeline for any loop that still has its
+// header; loops synthesized or renamed after measurement simply miss.
+static bool getFeedbackUnrollCount(const Loop *L, unsigned &Count) {
+  const StringMap<unsigned> *Map = getUnrollFeedbackMap();
+  if (!Map)
+    return false;
+  const BasicBlock *Header = L->getHeader();
+  const Function *F = Header->getParent();
+  if (!Header->hasName() || !F->hasName())
+    return false;
+  SmallString<128> Key;
+  (F->getName() + ":" + Header->getName()).toVector(Key);
+  StringMap<unsigned>::const_iterator It = Map->find(Key);
+  if (It == Map->end())
+    return false;
+  Count = It->second;
+  return true;
+}
+
 // Remove existing unroll metadata and add unroll disable metadata to
 // indicate the loop has already been unrolled.  This prevents a loop
 // from being unrolled more than is directed by a pragma if the loop
@@ -680,6 +750,13 @@ unsigned LoopUnroll::selectUnrollCount(
   // constructor parameter) has highest precedence.
   unsigned Count = UserCount ? CurrentCount : 0;
 
+  // Measured feedback comes next.  It exists precisely to replace hand-written
+  // pragmas with observed outcomes, so it outranks them; a recorded factor of
+  // 0 or 1 means the measured best was to leave the loop alone.
+  unsigned FeedbackCount;
+  if (Count == 0 && getFeedbackUnrollCount(L, FeedbackCount))
+    Count = std::max(FeedbackCount, 1u);
+
   // If there is no user-specified count, unroll pragmas have the next
   // highest precendence.
   if (Count == 0) {
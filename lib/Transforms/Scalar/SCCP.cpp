@@ -205,6 +205,13 @@ class SCCPSolver : public InstVisitor<SCCPSolver> {
   /// PHI nodes retriggered.
   typedef std::pair<BasicBlock*, BasicBlock*> Edge;
   DenseSet<Edge> KnownFeasibleEdges;
+
+  /// UndefScanWork - The functions whose lattice state has changed since they
+  /// were last scanned by ResolvedUndefsIn.  The scan's outcome depends only
+  /// on the executable blocks and the lattice values of a function's
+  /// instructions and arguments, so a function absent from this set would
+  /// report exactly what it did on its previous scan.
+  SmallPtrSet<Function*, 64> UndefScanWork;
 public:
   SCCPSolver(const DataLayout *DL, const TargetLibraryInfo *tli)
     : DL(DL), TLI(tli) {}
@@ -218,6 +225,7 @@ public:
       return false;
     DEBUG(dbgs() << "Marking Block Executable: " << BB->getName() << '\n');
     BBWorkList.push_back(BB);  // Add the block to the work list!
+    UndefScanWork.insert(BB->getParent());
     return true;
   }
 
@@ -263,6 +271,13 @@ public:
   /// should be rerun.
   bool ResolvedUndefsIn(Function &F);
 
+  /// needsUndefScan - Check (and clear) whether the lattice state of \p F has
+  /// changed since ResolvedUndefsIn last scanned it.  If not, another scan
+  /// would find nothing new and can be skipped.
+  bool needsUndefScan(Function &F) {
+    return UndefScanWork.erase(&F);
+  }
+
   bool isBlockExecutable(BasicBlock *BB) const {
     return BBExecutable.count(BB);
   }
@@ -301,6 +316,16 @@ public:
   }
 
 private:
+  // The undef-resolution scan reads the lattice values of a function's
+  // instructions and their operands, so record the affected function
+  // whenever one of them changes state.
+  void markUndefScanWork(Value *V) {
+    if (Instruction *I = dyn_cast<Instruction>(V))
+      UndefScanWork.insert(I->getParent()->getParent());
+    else if (Argument *A = dyn_cast<Argument>(V))
+      UndefScanWork.insert(A->getParent());
+  }
+
   // markConstant - Make a value be marked as "constant".  If the value
   // is not already a constant, add it to the instruction work list so that
   // the users of the instruction are updated later.
@@ -312,6 +337,7 @@ private:
       OverdefinedInstWorkList.push_back(V);
     else
       InstWorkList.push_back(V);
+    markUndefScanWork(V);
   }
 
   void markConstant(Value *V, Constant *C) {
@@ -328,6 +354,7 @@ private:
       OverdefinedInstWorkList.push_back(V);
     else
       InstWorkList.push_back(V);
+    markUndefScanWork(V);
   }
 
 
@@ -344,6 +371,7 @@ private:
             dbgs() << *V << '\n');
     // Only instructions go on the work list
     OverdefinedInstWorkList.push_back(V);
+    markUndefScanWork(V);
   }
 
   void mergeInValue(LatticeVal &IV, Value *V, LatticeVal MergeWithV) {
@@ -1462,6 +1490,9 @@ bool SCCPSolver::ResolvedUndefsIn(Function &F) {
       if (isa<UndefValue>(BI->getCondition())) {
         BI->setCondition(ConstantInt::getFalse(BI->getContext()));
         markEdgeExecutable(BB, TI->getSuccessor(1));
+        // This may not have changed any lattice state, but the rest of the
+        // function still needs scanning.
+        UndefScanWork.insert(&F);
         return true;
       }
 
@@ -1484,6 +1515,8 @@ bool SCCPSolver::ResolvedUndefsIn(Function &F) {
       if (isa<UndefValue>(SI->getCondition())) {
         SI->setCondition(SI->case_begin().getCaseValue());
         markEdgeExecutable(BB, SI->case_begin().getCaseSuccessor());
+        // As above, rescan even if no lattice state changed.
+        UndefScanWork.insert(&F);
         return true;
       }
 
@@ -1579,7 +1612,7 @@ bool SCCP::runOnFunction(Function &F) {
   while (ResolvedUndefs) {
     Solver.Solve();
     DEBUG(dbgs() << "RESOLVING UNDEFs\n");
-    ResolvedUndefs = Solver.ResolvedUndefsIn(F);
+    ResolvedUndefs = Solver.needsUndefScan(F) && Solver.ResolvedUndefsIn(F);
   }
 
   bool MadeChanges = false;
@@ -1753,7 +1786,8 @@ bool IPSCCP::runOnModule(Module &M) {
     DEBUG(dbgs() << "RESOLVING UNDEFS\n");
     ResolvedUndefs = false;
     for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
-      ResolvedUndefs |= Solver.ResolvedUndefsIn(*F);
+      if (Solver.needsUndefScan(*F))
+        ResolvedUndefs |= Solver.ResolvedUndefsIn(*F);
   }
 
   bool MadeChanges = false;
@@ -307,16 +307,16 @@ static void CloneAliasScopeMetadata(CallSite CS, ValueToValueMapTy &VMap) {
   if (MD.empty())
     return;
 
-  // Walk the existing metadata, adding the complete (perhaps cyclic) chain to
-  // the set.
-  SmallVector<const Metadata *, 16> Queue(MD.begin(), MD.end());
-  while (!Queue.empty()) {
-    const MDNode *M = cast<MDNode>(Queue.pop_back_val());
-    for (unsigned i = 0, ie = M->getNumOperands(); i != ie; ++i)
-      if (const MDNode *M1 = dyn_cast<MDNode>(M->getOperand(i)))
-        if (MD.insert(M1))
-          Queue.push_back(M1);
-  }
+  // Add the scopes named by those lists to the set. The domains the scopes
+  // belong to (their second operand) are deliberately left out: only the
+  // scopes themselves have to be unique to this call site for the metadata to
+  // remain correct, so all inlined instances can share the original domains.
+  // Cloning the domains as well would multiply the metadata with every level
+  // of inlining for no semantic gain.
+  for (unsigned i = 0, ie = MD.size(); i != ie; ++i)
+    for (unsigned j = 0, je = MD[i]->getNumOperands(); j != je; ++j)
+      if (const MDNode *M = dyn_cast<MDNode>(MD[i]->getOperand(j)))
+        MD.insert(M);
 
   // Now we have a complete set of all metadata in the chains used to specify
   // the noalias scopes and the lists of those scopes.
@@ -336,9 +336,12 @@ static void CloneAliasScopeMetadata(CallSite CS, ValueToValueMapTy &VMap) {
     SmallVector<Metadata *, 4> NewOps;
     for (unsigned i = 0, ie = (*I)->getNumOperands(); i != ie; ++i) {
       const Metadata *V = (*I)->getOperand(i);
-      if (const MDNode *M = dyn_cast<MDNode>(V))
+      const MDNode *M = dyn_cast<MDNode>(V);
+      if (M && MDMap.count(M))
         NewOps.push_back(MDMap[M]);
       else
+        // Nodes that aren't being cloned (the domains, and the scopes' name
+        // strings) are referenced as they are.
         NewOps.push_back(const_cast<Metadata *>(V));
     }
 
@@ -482,3 +482,24 @@ LoadAndStorePromoter::isInstInList(Instruction *I,
                                    const {
   return std::find(Insts.begin(), Insts.end(), I) != Insts.end();
 }
+
+void llvm::promoteAllocasWithSSAUpdater(ArrayRef<AllocaInst *> Allocas,
+                                        SSAUpdater &SSA) {
+  SmallVector<Instruction *, 16> Insts;
+  for (AllocaInst *AI : Allocas) {
+    Insts.clear();
+    for (User *U : AI->users()) {
+      assert((isa<LoadInst>(U) || isa<StoreInst>(U)) &&
+             "alloca to promote must only be used by loads and stores!");
+      Insts.push_back(cast<Instruction>(U));
+    }
+
+    // Initialize explicitly so that an alloca with no uses (or only loads,
+    // which become undef) is still handled; the promoter skips this step for
+    // an empty instruction list.
+    SSA.Initialize(AI->getAllocatedType(), AI->getName());
+    LoadAndStorePromoter(Insts, SSA, AI->getName()).run(Insts);
+    assert(AI->use_empty() && "non-load/store use left behind?");
+    AI->eraseFromParent();
+  }
+}
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Utils/ValueMapper.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/InlineAsm.h"
@@ -237,6 +238,45 @@ static Metadata *mapDistinctNode(const MDNode *Node,
   return NewMD;
 }
 
+/// \brief Check whether remapping could change anything reachable from \p MD.
+///
+/// Walks the transitive operands of \p MD without cloning anything. Distinct
+/// and unresolved nodes are always recreated, so they count as changes; so
+/// does any value that maps to something new. The answer is an OR over
+/// everything reachable from the original query, so when a cycle leads back
+/// to a node already on the stack it is safe to report "no change seen here"
+/// and let the other paths out of the cycle decide.
+static bool mayChangeMetadata(const Metadata *MD,
+                              SmallPtrSetImpl<const Metadata *> &Visited,
+                              ValueToValueMapTy &VM, RemapFlags Flags,
+                              ValueMapTypeRemapper *TypeMapper,
+                              ValueMaterializer *Materializer) {
+  if (!MD)
+    return false;
+  if (Metadata *NewMD = VM.MD().lookup(MD).get())
+    return NewMD != MD;
+  if (!Visited.insert(MD).second)
+    return false;
+
+  if (isa<MDString>(MD))
+    return false;
+
+  if (const auto *VMD = dyn_cast<ValueAsMetadata>(MD)) {
+    Value *MappedV =
+        MapValue(VMD->getValue(), VM, Flags, TypeMapper, Materializer);
+    return !(VMD->getValue() == MappedV ||
+             (!MappedV && (Flags & RF_IgnoreMissingEntries)));
+  }
+
+  const MDNode *Node = cast<MDNode>(MD);
+  if (!Node->isUniqued() || !Node->isResolved())
+    return true;
+  for (Metadata *Op : Node->operands())
+    if (mayChangeMetadata(Op, Visited, VM, Flags, TypeMapper, Materializer))
+      return true;
+  return false;
+}
+
 /// \brief Map a uniqued MDNode.
 ///
 /// Uniqued nodes may not need to be recreated (they may map to themselves).
@@ -247,6 +287,19 @@ static Metadata *mapUniquedNode(const MDNode *Node,
                                 ValueMaterializer *Materializer) {
   assert(Node->isUniqued() && "Expected uniqued node");
 
+  // Check for the common case first: nothing reachable from this node
+  // changes, so the whole subgraph maps to itself. Recording the identity
+  // mappings for everything visited makes remapping an untouched metadata
+  // graph a sequence of table inserts instead of a clone/unique/destroy
+  // round trip per node.
+  SmallPtrSet<const Metadata *, 16> Visited;
+  if (!mayChangeMetadata(Node, Visited, VM, Flags, TypeMapper, Materializer)) {
+    for (const Metadata *Op : Visited)
+      if (isa<MDNode>(Op))
+        mapToSelf(VM, Op);
+    return mapToSelf(VM, Node);
+  }
+
   // Create a temporary node upfront in case we have a metadata cycle.
   auto ClonedMD = Node->clone();
   if (!remap(Node, ClonedMD.get(), Cycles, VM, Flags, TypeMapper, Materializer))
@@ -342,8 +395,32 @@ MDNode *llvm::MapMetadata(const MDNode *MD, ValueToValueMapTy &VM,
 void llvm::RemapInstruction(Instruction *I, ValueToValueMapTy &VMap,
                             RemapFlags Flags, ValueMapTypeRemapper *TypeMapper,
                             ValueMaterializer *Materializer){
+  // When nothing at the module level is changing and there is no type mapper
+  // or materializer, operands which miss the map can often be proven mapped
+  // to themselves without the general machinery below.
+  bool IdentityModuleLevel =
+      (Flags & RF_NoModuleLevelChanges) && !TypeMapper && !Materializer;
+
   // Remap operands.
   for (User::op_iterator op = I->op_begin(), E = I->op_end(); op != E; ++op) {
+    // Almost every operand is either a function-local value, which hits the
+    // map directly, or a simple constant, which cannot be remapped at all.
+    // Handle both with a single map probe and no map growth; cloning a
+    // function visits every operand of every instruction through here, so
+    // this is very hot.
+    ValueToValueMapTy::iterator Existing = VMap.find(*op);
+    if (Existing != VMap.end() && Existing->second) {
+      *op = Existing->second;
+      continue;
+    }
+    if (IdentityModuleLevel)
+      if (Constant *C = dyn_cast<Constant>(*op))
+        // Constants with operands may transitively reference a block address
+        // or further constants which do need remapping; leave those to
+        // MapValue.
+        if (isa<GlobalValue>(C) || C->getNumOperands() == 0)
+          continue;
+
     Value *V = MapValue(*op, VMap, Flags, TypeMapper, Materializer);
     // If we aren't ignoring missing entries, assert that something happened.
     if (V)
@@ -367,16 +444,18 @@ void llvm::RemapInstruction(Instruction *I, ValueToValueMapTy &VMap,
   }
 
   // Remap attached metadata.
-  SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
-  I->getAllMetadata(MDs);
-  for (SmallVectorImpl<std::pair<unsigned, MDNode *>>::iterator
-           MI = MDs.begin(),
-           ME = MDs.end();
-       MI != ME; ++MI) {
-    MDNode *Old = MI->second;
-    MDNode *New = MapMetadata(Old, VMap, Flags, TypeMapper, Materializer);
-    if (New != Old)
-      I->setMetadata(MI->first, New);
+  if (I->hasMetadata()) {
+    SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+    I->getAllMetadata(MDs);
+    for (SmallVectorImpl<std::pair<unsigned, MDNode *>>::iterator
+             MI = MDs.begin(),
+             ME = MDs.end();
+         MI != ME; ++MI) {
+      MDNode *Old = MI->second;
+      MDNode *New = MapMetadata(Old, VMap, Flags, TypeMapper, Materializer);
+      if (New != Old)
+        I->setMetadata(MI->first, New);
+    }
   }
   
   // If the instruction's type is being remapped, do so now.
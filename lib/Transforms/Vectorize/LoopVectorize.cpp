@@ -828,6 +828,10 @@ private:
   /// invariant.
   void collectStridedAccess(Value *LoadOrStoreInst);
 
+  /// Compute the answer for isConsecutivePtr. This walks SCEV and is only
+  /// called on the first query for each pointer; see ConsecutivePtrCache.
+  int computeConsecutivePtr(Value *Ptr);
+
   /// Report an analysis message to assist the user in diagnosing loops that are
   /// not vectorized.  These are handled as LoopAccessReport rather than
   /// VectorizationReport because the << operator of VectorizationReport returns
@@ -884,7 +888,14 @@ private:
 
   ValueToValueMap Strides;
   SmallPtrSet<Value *, 8> StrideSet;
-  
+
+  /// Memoized isConsecutivePtr answers. The result is fixed once induction
+  /// and stride collection are done, and the cost model then repeats the
+  /// same queries for every candidate VF. Answers cached before that point
+  /// (during the if-conversion check) are discarded by canVectorizeInstrs.
+  DenseMap<Value *, int> ConsecutivePtrCache;
+
+
   /// While vectorizing these instructions we have to generate a
   /// call to the appropriate masked intrinsic
   SmallPtrSet<const Instruction*, 8> MaskedOp;
@@ -1584,6 +1595,15 @@ static unsigned getGEPInductionOperand(const DataLayout *DL,
 }
 
 int LoopVectorizationLegality::isConsecutivePtr(Value *Ptr) {
+  auto It = ConsecutivePtrCache.find(Ptr);
+  if (It != ConsecutivePtrCache.end())
+    return It->second;
+  int Stride = computeConsecutivePtr(Ptr);
+  ConsecutivePtrCache.insert(std::make_pair(Ptr, Stride));
+  return Stride;
+}
+
+int LoopVectorizationLegality::computeConsecutivePtr(Value *Ptr) {
   assert(Ptr->getType()->isPointerTy() && "Unexpected non-ptr");
   // Make sure that the pointer does not point to structs.
   if (Ptr->getType()->getPointerElementType()->isAggregateType())
@@ -3660,6 +3680,11 @@ bool LoopVectorizationLegality::canVectorizeInstrs() {
     }
   }
 
+  // The if-conversion check may have queried isConsecutivePtr before the
+  // induction and stride information above was collected. Drop those early
+  // answers so that all memoized results reflect the final analysis.
+  ConsecutivePtrCache.clear();
+
   return true;
 }
 
@@ -16,6 +16,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "llvm/Transforms/Vectorize.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
@@ -54,6 +55,8 @@ using namespace llvm;
 #define DEBUG_TYPE "SLP"
 
 STATISTIC(NumVectorInstructions, "Number of vector instructions generated");
+STATISTIC(NumScreenedBundles, "Number of candidate bundles rejected by "
+                              "fingerprint screening");
 
 static cl::opt<int>
     SLPCostThreshold("slp-threshold", cl::init(0), cl::Hidden,
@@ -190,6 +193,36 @@ static unsigned getSameOpcode(ArrayRef<Value *> VL) {
   return Opcode;
 }
 
+/// \returns a cheap structural fingerprint for \p V. Two values that
+/// buildTree could place in the same vectorizable bundle always have the same
+/// fingerprint; mismatched fingerprints mean the bundle is certain to be
+/// gathered. All non-instructions share one fingerprint and alternate opcode
+/// pairs (see canCombineAsAltInst) share one as well, so this is only a
+/// screen - matching fingerprints prove nothing.
+static size_t getShapeFingerprint(Value *V) {
+  Instruction *I = dyn_cast<Instruction>(V);
+  if (!I)
+    return 0;
+  // Alternating sequences of the paired opcodes can still be vectorized as a
+  // shuffle (see isAltInst), so both members of a pair map to one
+  // fingerprint.
+  unsigned Opcode = I->getOpcode();
+  if (unsigned AltOpcode = getAltOpcode(Opcode))
+    Opcode = std::min(Opcode, AltOpcode);
+  return hash_combine(Opcode, I->getType(), I->getParent());
+}
+
+/// \returns true if all values in \p VL have the same structural fingerprint.
+/// When this is false the bundle mixes opcodes (beyond an alternate pair),
+/// types or parent blocks, and buildTree is certain to gather it.
+static bool allSameShape(ArrayRef<Value *> VL) {
+  size_t Fingerprint = getShapeFingerprint(VL[0]);
+  for (int i = 1, e = VL.size(); i < e; i++)
+    if (getShapeFingerprint(VL[i]) != Fingerprint)
+      return false;
+  return true;
+}
+
 /// Get the intersection (logical and) of all of the potential IR flags
 /// of each scalar operation (VL) that will be converted into a vector (I).
 /// Flag set: NSW, NUW, exact, and all of fast-math.
@@ -3218,6 +3251,19 @@ bool SLPVectorizer::vectorizeStoreChain(ArrayRef<Value *> Chain,
           << "\n");
     ArrayRef<Value *> Operands = Chain.slice(i, VF);
 
+    // The tree for this window would be a vectorized store root over its
+    // value operands. If the values mix opcodes, types or blocks that bundle
+    // is certain to be gathered, and a height-two tree containing a gather
+    // never passes the cost check (see isFullyVectorizableTinyTree), so don't
+    // bother building a tree just to discard it.
+    SmallVector<Value *, 8> Values;
+    for (Value *V : Operands)
+      Values.push_back(cast<StoreInst>(V)->getValueOperand());
+    if (!allSameShape(Values)) {
+      ++NumScreenedBundles;
+      continue;
+    }
+
     R.buildTree(Operands);
 
     int Cost = R.getTreeCost();
@@ -3378,6 +3424,14 @@ bool SLPVectorizer::tryToVectorizeList(ArrayRef<Value *> VL, BoUpSLP &R,
                  << "\n");
     ArrayRef<Value *> Ops = VL.slice(i, OpsWidth);
 
+    // Reject windows that mix types or blocks (the opcodes were checked
+    // above): buildTree would gather the whole root bundle and the cost check
+    // always discards such trees.
+    if (!allSameShape(Ops)) {
+      ++NumScreenedBundles;
+      continue;
+    }
+
     ArrayRef<Value *> BuildVectorSlice;
     if (!BuildVector.empty())
       BuildVectorSlice = BuildVector.slice(i, OpsWidth);
@@ -0,0 +1,12 @@
+; Compressed bitcode containers must round-trip through the buffer based
+; readers transparently.
+; REQUIRES: zlib
+; RUN: llvm-as -compress %s -o %t.bc
+; RUN: opt -S -o - %t.bc | FileCheck %s
+; RUN: llvm-link %t.bc -S -o - | FileCheck %s
+
+; CHECK: define i32 @f(i32 %x)
+define i32 @f(i32 %x) {
+  %y = add i32 %x, 1
+  ret i32 %y
+}
@@ -0,0 +1,21 @@
+; RUN: llvm-as -bitcode-function-digests < %s | llvm-bcanalyzer -dump | FileCheck %s
+; Each function body gets a digest record; declarations have no body and
+; therefore no entry.
+
+; CHECK: <FUNCTION_DIGEST_BLOCK
+; CHECK: <ENTRY
+; CHECK: <ENTRY
+; CHECK-NOT: <ENTRY
+; CHECK: </FUNCTION_DIGEST_BLOCK
+
+declare i32 @decl(i32)
+
+define i32 @foo(i32 %a) {
+  %r = add i32 %a, 1
+  ret i32 %r
+}
+
+define i32 @bar(i32 %a) {
+  %r = call i32 @decl(i32 %a)
+  ret i32 %r
+}
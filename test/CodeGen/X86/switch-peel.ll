@@ -0,0 +1,56 @@
+; RUN: llc -mtriple=x86_64-linux-gnu < %s | FileCheck %s
+
+; Branch weight metadata says case 5 takes almost every hit, so it must be
+; peeled into a compare-and-branch ahead of the jump table.
+
+define void @test_peel(i32 %x) nounwind {
+entry:
+  switch i32 %x, label %sw.epilog [
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 4, label %bb4
+    i32 5, label %bb5
+    i32 6, label %bb6
+    i32 7, label %bb7
+    i32 8, label %bb8
+  ], !prof !0
+
+; CHECK-LABEL: test_peel:
+; CHECK: cmpl $5
+; CHECK-NOT: jmpq *
+; CHECK: je
+; CHECK: jmpq *
+
+bb1:
+  tail call void @f(i32 1) nounwind
+  br label %sw.epilog
+bb2:
+  tail call void @f(i32 2) nounwind
+  br label %sw.epilog
+bb3:
+  tail call void @f(i32 3) nounwind
+  br label %sw.epilog
+bb4:
+  tail call void @f(i32 4) nounwind
+  br label %sw.epilog
+bb5:
+  tail call void @f(i32 5) nounwind
+  br label %sw.epilog
+bb6:
+  tail call void @f(i32 6) nounwind
+  br label %sw.epilog
+bb7:
+  tail call void @f(i32 7) nounwind
+  br label %sw.epilog
+bb8:
+  tail call void @f(i32 8) nounwind
+  br label %sw.epilog
+
+sw.epilog:
+  ret void
+}
+
+declare void @f(i32)
+
+!0 = !{!"branch_weights", i32 1, i32 1, i32 1, i32 1, i32 1, i32 1000, i32 1, i32 1, i32 1}
@@ -0,0 +1,23 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -function-sections | FileCheck %s --check-prefix=FNSECTIONS
+
+; Cold functions go to .text.unlikely so the linker groups them away from hot
+; code, with or without -function-sections.
+
+; CHECK: .text{{$}}
+; CHECK: normal:
+; FNSECTIONS: .section .text.normal,"ax",@progbits
+; FNSECTIONS: normal:
+define void @normal() {
+entry:
+  ret void
+}
+
+; CHECK: .section .text.unlikely,"ax",@progbits
+; CHECK: coldfn:
+; FNSECTIONS: .section .text.unlikely.coldfn,"ax",@progbits
+; FNSECTIONS: coldfn:
+define void @coldfn() cold {
+entry:
+  ret void
+}
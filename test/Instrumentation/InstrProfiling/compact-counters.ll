@@ -0,0 +1,20 @@
+; RUN: opt < %s -instrprof -instrprof-compact-counters -S | FileCheck %s
+
+target triple = "x86_64-apple-macosx10.10.0"
+
+@__llvm_profile_name_foo = hidden constant [3 x i8] c"foo"
+
+; CHECK: @__llvm_profile_counters_foo = hidden global [1 x i32] zeroinitializer, section "__DATA,__llvm_prf_cnts", align 4
+define void @foo() {
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8]* @__llvm_profile_name_foo, i32 0, i32 0), i64 0, i32 1, i32 0)
+  ret void
+}
+
+; Compact counters saturate at UINT32_MAX instead of wrapping.
+; CHECK: %pgocount = load i32
+; CHECK-NEXT: %[[INC:.*]] = add i32 %pgocount, 1
+; CHECK-NEXT: %[[PIN:.*]] = icmp eq i32 %pgocount, -1
+; CHECK-NEXT: %[[SAT:.*]] = select i1 %[[PIN]], i32 %pgocount, i32 %[[INC]]
+; CHECK-NEXT: store i32 %[[SAT]]
+
+declare void @llvm.instrprof.increment(i8*, i64, i32, i32)
@@ -0,0 +1,14 @@
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o %t
+// RUN: llvm-objdump -d %t | FileCheck %s
+
+// Branches to labels already placed in the same fragment are resolved at
+// streaming time. An in-range backwards branch must keep the short form and
+// an out-of-range one must still relax to the near form.
+1:
+        xorl %eax, %eax
+        jne 1b
+// CHECK: 75 fc
+2:
+        .skip 200, 0x90
+        jmp 2b
+// CHECK: e9 33 ff ff ff
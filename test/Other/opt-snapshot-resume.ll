@@ -0,0 +1,17 @@
+; REQUIRES: shell
+; RUN: cd %T && opt -mem2reg -gvn -snapshot-after=mem2reg %s -o /dev/null
+; RUN: cd %T && opt -mem2reg -gvn -resume-from=mem2reg.snapshot.bc -S -o - | FileCheck %s
+
+; The snapshot is taken after mem2reg, so the resumed run must see the
+; promoted form even though it only runs the passes after the snapshot.
+
+; CHECK-LABEL: @f(
+; CHECK-NOT: alloca
+
+define i32 @f(i32 %x) {
+entry:
+  %p = alloca i32
+  store i32 %x, i32* %p
+  %v = load i32, i32* %p
+  ret i32 %v
+}
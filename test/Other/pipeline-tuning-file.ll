@@ -0,0 +1,18 @@
+; Knob overrides from the matching category are applied to the -O2 pipeline.
+; RUN: echo '[all]' > %t.cfg
+; RUN: echo 'loop-vectorize = 0' >> %t.cfg
+; RUN: opt -O2 -pipeline-tuning-file=%t.cfg -debug-pass=Arguments \
+; RUN:     -disable-output < %s 2>&1 | FileCheck %s --check-prefix=TUNED
+; TUNED-NOT: -loop-vectorize
+
+; A category whose limits this module does not satisfy changes nothing.
+; RUN: echo '[huge]' > %t2.cfg
+; RUN: echo 'min-functions = 1000' >> %t2.cfg
+; RUN: echo 'loop-vectorize = 0' >> %t2.cfg
+; RUN: opt -O2 -pipeline-tuning-file=%t2.cfg -debug-pass=Arguments \
+; RUN:     -disable-output < %s 2>&1 | FileCheck %s --check-prefix=UNTUNED
+; UNTUNED: -loop-vectorize
+
+define void @f() {
+  ret void
+}
@@ -0,0 +1,30 @@
+; RUN: opt < %s -constprop -S | FileCheck %s
+
+; Calls over f32/f64 constant data vectors take a host-float fast path; the
+; results must be identical to folding each lane through the scalar folder.
+
+define <4 x float> @fabs_v4f32() {
+; CHECK-LABEL: @fabs_v4f32(
+; CHECK: ret <4 x float> <float 1.000000e+00, float 2.000000e+00, float 0.000000e+00, float 5.000000e-01>
+  %r = call <4 x float> @llvm.fabs.v4f32(<4 x float> <float -1.0, float 2.0, float -0.0, float -0.5>)
+  ret <4 x float> %r
+}
+
+define <2 x double> @floor_v2f64() {
+; CHECK-LABEL: @floor_v2f64(
+; CHECK: ret <2 x double> <double 1.000000e+00, double -3.000000e+00>
+  %r = call <2 x double> @llvm.floor.v2f64(<2 x double> <double 1.5, double -2.5>)
+  ret <2 x double> %r
+}
+
+; A NaN lane blocks the whole fold, as in the scalar folder.
+define <2 x double> @fabs_nan_v2f64() {
+; CHECK-LABEL: @fabs_nan_v2f64(
+; CHECK: call <2 x double> @llvm.fabs.v2f64
+  %r = call <2 x double> @llvm.fabs.v2f64(<2 x double> <double 0x7FF8000000000000, double 1.0>)
+  ret <2 x double> %r
+}
+
+declare <4 x float> @llvm.fabs.v4f32(<4 x float>)
+declare <2 x double> @llvm.floor.v2f64(<2 x double>)
+declare <2 x double> @llvm.fabs.v2f64(<2 x double>)
@@ -0,0 +1,39 @@
+; RUN: opt -deadargelim -dae-emit-summary -S < %s | FileCheck %s
+
+; The summary records, for every function body, a mask of the arguments it
+; uses and how it refers to other functions.
+
+; @callee reads %a but not %b.
+; CHECK-DAG: !{i32 (i32, i32)* @callee, i64 1}
+define i32 @callee(i32 %a, i32 %b) {
+entry:
+  ret i32 %a
+}
+
+; CHECK-DAG: !{void ()* @g, i64 0}
+define void @g() {
+entry:
+  ret void
+}
+
+@fptr = global void ()* @g
+
+; @caller uses the result of its call to @callee (flags 1) and ignores the
+; result of its call to @g (flags 0).
+; CHECK-DAG: !{i32 (i32)* @caller, i64 1, i32 (i32, i32)* @callee, i32 1, void ()* @g, i32 0}
+define i32 @caller(i32 %x) {
+entry:
+  %r = call i32 @callee(i32 %x, i32 0)
+  call void @g()
+  ret i32 %r
+}
+
+; @taker refers to @g other than as a direct callee (flags 2).
+; CHECK-DAG: !{void ()* @taker, i64 0, void ()* @g, i32 2}
+define void @taker() {
+entry:
+  store void ()* @g, void ()** @fptr
+  ret void
+}
+
+; CHECK-DAG: !llvm.dae.summary = !{
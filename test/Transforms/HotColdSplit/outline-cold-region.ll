@@ -0,0 +1,48 @@
+; RUN: opt -hotcoldsplit -S < %s | FileCheck %s
+
+declare void @sink()
+
+; A profile-cold block is outlined into a cold, minsize function.
+
+; CHECK-LABEL: define void @foo(
+; CHECK: call void @foo_cold()
+; CHECK-NOT: call void @sink()
+define void @foo(i32 %x) {
+entry:
+  %cmp = icmp eq i32 %x, 0
+  br i1 %cmp, label %cold, label %exit, !prof !0
+
+cold:
+  call void @sink()
+  call void @sink()
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A statically cold path (leading to unreachable) is outlined even without
+; profile metadata.
+
+; CHECK-LABEL: define void @bar(
+; CHECK: call void @bar_cold()
+define void @bar(i1 %tobool) {
+entry:
+  br i1 %tobool, label %cold, label %exit
+
+cold:
+  call void @sink()
+  unreachable
+
+exit:
+  ret void
+}
+
+; CHECK: Function Attrs: cold minsize noinline
+; CHECK-NEXT: define internal void @foo_cold()
+; CHECK: call void @sink()
+
+; CHECK: Function Attrs: cold minsize noinline
+; CHECK-NEXT: define internal void @bar_cold()
+
+!0 = !{!"branch_weights", i32 1, i32 1000}
@@ -0,0 +1,36 @@
+; RUN: opt < %s -indirect-call-promotion -S | FileCheck %s
+
+define i32 @hot(i32 %x) {
+entry:
+  ret i32 %x
+}
+
+; A dominant target is promoted to a guarded direct call.
+; CHECK-LABEL: define i32 @caller(
+; CHECK: %icp.cmp = icmp eq i32 (i32)* %fp, @hot
+; CHECK: br i1 %icp.cmp, label %icp.direct, label %icp.indirect, !prof
+; CHECK: icp.direct:
+; CHECK: %[[DIRECT:.*]] = call i32 @hot(i32 %x)
+; CHECK: icp.indirect:
+; CHECK: %call = call i32 %fp(i32 %x)
+; CHECK: icp.merge:
+; CHECK: %icp.retval = phi i32 [ %[[DIRECT]], %icp.direct ], [ %call, %icp.indirect ]
+; CHECK: ret i32 %icp.retval
+define i32 @caller(i32 (i32)* %fp, i32 %x) {
+entry:
+  %call = call i32 %fp(i32 %x), !indirect.call.targets !0
+  ret i32 %call
+}
+
+; No target reaches the threshold, so the call site is left alone.
+; CHECK-LABEL: define i32 @caller_flat(
+; CHECK-NOT: icp.cmp
+; CHECK: %call = call i32 %fp(i32 %x)
+define i32 @caller_flat(i32 (i32)* %fp, i32 %x) {
+entry:
+  %call = call i32 %fp(i32 %x), !indirect.call.targets !1
+  ret i32 %call
+}
+
+!0 = !{i64 1000, !"hot", i64 900, !"lukewarm", i64 100}
+!1 = !{i64 1000, !"hot", i64 400, !"lukewarm", i64 350}
@@ -0,0 +1,45 @@
+; RUN: opt < %s -inline -inline-size-budget=1 -S | FileCheck %s
+; RUN: opt < %s -inline -S | FileCheck --check-prefix=DEFAULT %s
+; The first inline consumes the entire one-instruction budget, so the second,
+; otherwise profitable, call site must stay out of line. Without a budget both
+; calls are inlined.
+
+define i32 @callee1(i32 %x) {
+  %a = add i32 %x, 1
+  ret i32 %a
+}
+
+define i32 @callee2(i32 %x) {
+  %a1 = add i32 %x, 1
+  %a2 = add i32 %a1, 2
+  %a3 = add i32 %a2, 3
+  %a4 = add i32 %a3, 4
+  %a5 = add i32 %a4, 5
+  %a6 = add i32 %a5, 6
+  %a7 = add i32 %a6, 7
+  %a8 = add i32 %a7, 8
+  %a9 = add i32 %a8, 9
+  %a10 = add i32 %a9, 10
+  %a11 = add i32 %a10, 11
+  %a12 = add i32 %a11, 12
+  %a13 = add i32 %a12, 13
+  %a14 = add i32 %a13, 14
+  %a15 = add i32 %a14, 15
+  %a16 = add i32 %a15, 16
+  %a17 = add i32 %a16, 17
+  %a18 = add i32 %a17, 18
+  %a19 = add i32 %a18, 19
+  %a20 = add i32 %a19, 20
+  ret i32 %a20
+}
+
+; CHECK-LABEL: define i32 @caller(
+; CHECK-NOT: call i32 @callee1
+; CHECK: call i32 @callee2
+; DEFAULT-LABEL: define i32 @caller(
+; DEFAULT-NOT: call
+define i32 @caller(i32 %x) {
+  %r1 = call i32 @callee1(i32 %x)
+  %r2 = call i32 @callee2(i32 %r1)
+  ret i32 %r2
+}
@@ -27,20 +27,20 @@ entry:
 ; CHECK: entry:
 ; CHECK:   %0 = load float* %c, align 4, !noalias !6
 ; CHECK:   %arrayidx.i.i = getelementptr inbounds float* %a, i64 5
-; CHECK:   store float %0, float* %arrayidx.i.i, align 4, !alias.scope !12, !noalias !13
+; CHECK:   store float %0, float* %arrayidx.i.i, align 4, !alias.scope !11, !noalias !12
 ; CHECK:   %arrayidx1.i.i = getelementptr inbounds float* %b, i64 8
-; CHECK:   store float %0, float* %arrayidx1.i.i, align 4, !alias.scope !14, !noalias !15
-; CHECK:   %1 = load float* %c, align 4, !noalias !16
+; CHECK:   store float %0, float* %arrayidx1.i.i, align 4, !alias.scope !13, !noalias !14
+; CHECK:   %1 = load float* %c, align 4, !noalias !15
 ; CHECK:   %arrayidx.i = getelementptr inbounds float* %a, i64 7
-; CHECK:   store float %1, float* %arrayidx.i, align 4, !noalias !16
-; CHECK:   %2 = load float* %a, align 4, !alias.scope !16, !noalias !17
+; CHECK:   store float %1, float* %arrayidx.i, align 4, !noalias !15
+; CHECK:   %2 = load float* %a, align 4, !alias.scope !15, !noalias !16
 ; CHECK:   %arrayidx.i.i1 = getelementptr inbounds float* %b, i64 5
-; CHECK:   store float %2, float* %arrayidx.i.i1, align 4, !alias.scope !21, !noalias !22
+; CHECK:   store float %2, float* %arrayidx.i.i1, align 4, !alias.scope !19, !noalias !20
 ; CHECK:   %arrayidx1.i.i2 = getelementptr inbounds float* %b, i64 8
-; CHECK:   store float %2, float* %arrayidx1.i.i2, align 4, !alias.scope !23, !noalias !24
-; CHECK:   %3 = load float* %a, align 4, !alias.scope !16
+; CHECK:   store float %2, float* %arrayidx1.i.i2, align 4, !alias.scope !21, !noalias !22
+; CHECK:   %3 = load float* %a, align 4, !alias.scope !15
 ; CHECK:   %arrayidx.i3 = getelementptr inbounds float* %b, i64 7
-; CHECK:   store float %3, float* %arrayidx.i3, align 4, !alias.scope !16
+; CHECK:   store float %3, float* %arrayidx.i3, align 4, !alias.scope !15
 ; CHECK:   ret void
 ; CHECK: }
 
@@ -62,23 +62,23 @@ attributes #0 = { nounwind uwtable }
 ; CHECK: !3 = distinct !{!3, !2, !"hello2: %b"}
 ; CHECK: !4 = !{!1}
 ; CHECK: !5 = !{!3}
-; CHECK: !6 = !{!7, !9, !10}
-; CHECK: !7 = distinct !{!7, !8, !"hello2: %a"}
-; CHECK: !8 = distinct !{!8, !"hello2"}
-; CHECK: !9 = distinct !{!9, !8, !"hello2: %b"}
-; CHECK: !10 = distinct !{!10, !11, !"hello: %a"}
-; CHECK: !11 = distinct !{!11, !"hello"}
-; CHECK: !12 = !{!7}
-; CHECK: !13 = !{!9, !10}
-; CHECK: !14 = !{!9}
-; CHECK: !15 = !{!7, !10}
-; CHECK: !16 = !{!10}
-; CHECK: !17 = !{!18, !20}
-; CHECK: !18 = distinct !{!18, !19, !"hello2: %a"}
-; CHECK: !19 = distinct !{!19, !"hello2"}
-; CHECK: !20 = distinct !{!20, !19, !"hello2: %b"}
-; CHECK: !21 = !{!18, !10}
-; CHECK: !22 = !{!20}
-; CHECK: !23 = !{!20, !10}
-; CHECK: !24 = !{!18}
+; The "hello2" scopes cloned for each inlined call site share the original
+; "hello2" domain !2; domains are not duplicated per call site.
+; CHECK: !6 = !{!7, !8, !9}
+; CHECK: !7 = distinct !{!7, !2, !"hello2: %a"}
+; CHECK: !8 = distinct !{!8, !2, !"hello2: %b"}
+; CHECK: !9 = distinct !{!9, !10, !"hello: %a"}
+; CHECK: !10 = distinct !{!10, !"hello"}
+; CHECK: !11 = !{!7}
+; CHECK: !12 = !{!8, !9}
+; CHECK: !13 = !{!8}
+; CHECK: !14 = !{!7, !9}
+; CHECK: !15 = !{!9}
+; CHECK: !16 = !{!17, !18}
+; CHECK: !17 = distinct !{!17, !2, !"hello2: %a"}
+; CHECK: !18 = distinct !{!18, !2, !"hello2: %b"}
+; CHECK: !19 = !{!17, !9}
+; CHECK: !20 = !{!18}
+; CHECK: !21 = !{!18, !9}
+; CHECK: !22 = !{!17}
 
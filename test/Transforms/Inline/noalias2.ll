@@ -54,17 +54,17 @@ entry:
 
 ; CHECK: define void @foo2(float* nocapture %a, float* nocapture %b, float* nocapture readonly %c) #0 {
 ; CHECK: entry:
-; CHECK:   %0 = load float* %c, align 4, !alias.scope !5, !noalias !10
+; CHECK:   %0 = load float* %c, align 4, !alias.scope !5, !noalias !9
 ; CHECK:   %arrayidx.i.i = getelementptr inbounds float* %a, i64 5
-; CHECK:   store float %0, float* %arrayidx.i.i, align 4, !alias.scope !10, !noalias !5
-; CHECK:   %1 = load float* %c, align 4, !alias.scope !13, !noalias !14
+; CHECK:   store float %0, float* %arrayidx.i.i, align 4, !alias.scope !9, !noalias !5
+; CHECK:   %1 = load float* %c, align 4, !alias.scope !12, !noalias !13
 ; CHECK:   %arrayidx.i = getelementptr inbounds float* %a, i64 7
-; CHECK:   store float %1, float* %arrayidx.i, align 4, !alias.scope !14, !noalias !13
-; CHECK:   %2 = load float* %c, align 4, !noalias !15
+; CHECK:   store float %1, float* %arrayidx.i, align 4, !alias.scope !13, !noalias !12
+; CHECK:   %2 = load float* %c, align 4, !noalias !14
 ; CHECK:   %arrayidx.i1 = getelementptr inbounds float* %a, i64 6
-; CHECK:   store float %2, float* %arrayidx.i1, align 4, !alias.scope !19, !noalias !20
+; CHECK:   store float %2, float* %arrayidx.i1, align 4, !alias.scope !18, !noalias !19
 ; CHECK:   %arrayidx1.i = getelementptr inbounds float* %b, i64 8
-; CHECK:   store float %2, float* %arrayidx1.i, align 4, !alias.scope !20, !noalias !19
+; CHECK:   store float %2, float* %arrayidx1.i, align 4, !alias.scope !19, !noalias !18
 ; CHECK:   %3 = load float* %c, align 4
 ; CHECK:   %arrayidx = getelementptr inbounds float* %a, i64 7
 ; CHECK:   store float %3, float* %arrayidx, align 4
@@ -76,22 +76,23 @@ entry:
 ; CHECK: !2 = distinct !{!2, !"hello"}
 ; CHECK: !3 = !{!4}
 ; CHECK: !4 = distinct !{!4, !2, !"hello: %a"}
-; CHECK: !5 = !{!6, !8}
-; CHECK: !6 = distinct !{!6, !7, !"hello: %c"}
-; CHECK: !7 = distinct !{!7, !"hello"}
-; CHECK: !8 = distinct !{!8, !9, !"foo: %c"}
-; CHECK: !9 = distinct !{!9, !"foo"}
-; CHECK: !10 = !{!11, !12}
-; CHECK: !11 = distinct !{!11, !7, !"hello: %a"}
-; CHECK: !12 = distinct !{!12, !9, !"foo: %a"}
-; CHECK: !13 = !{!8}
-; CHECK: !14 = !{!12}
-; CHECK: !15 = !{!16, !18}
-; CHECK: !16 = distinct !{!16, !17, !"hello2: %a"}
-; CHECK: !17 = distinct !{!17, !"hello2"}
-; CHECK: !18 = distinct !{!18, !17, !"hello2: %b"}
-; CHECK: !19 = !{!16}
-; CHECK: !20 = !{!18}
+; The cloned "hello" scopes !6 and !10 still belong to the original "hello"
+; domain !2; only the scopes themselves are unique per call site.
+; CHECK: !5 = !{!6, !7}
+; CHECK: !6 = distinct !{!6, !2, !"hello: %c"}
+; CHECK: !7 = distinct !{!7, !8, !"foo: %c"}
+; CHECK: !8 = distinct !{!8, !"foo"}
+; CHECK: !9 = !{!10, !11}
+; CHECK: !10 = distinct !{!10, !2, !"hello: %a"}
+; CHECK: !11 = distinct !{!11, !8, !"foo: %a"}
+; CHECK: !12 = !{!7}
+; CHECK: !13 = !{!11}
+; CHECK: !14 = !{!15, !17}
+; CHECK: !15 = distinct !{!15, !16, !"hello2: %a"}
+; CHECK: !16 = distinct !{!16, !"hello2"}
+; CHECK: !17 = distinct !{!17, !16, !"hello2: %b"}
+; CHECK: !18 = !{!15}
+; CHECK: !19 = !{!17}
 
 attributes #0 = { nounwind uwtable }
 
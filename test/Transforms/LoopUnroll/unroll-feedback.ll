@@ -0,0 +1,57 @@
+; RUN: echo "foo:loop 4" > %t
+; RUN: echo "bar:loop 0" >> %t
+; RUN: opt < %s -loop-unroll -unroll-feedback-file=%t -S | FileCheck %s
+;
+; Measured unroll factors from -unroll-feedback-file override the static
+; heuristics for the loops they name; a recorded factor of 0 pins the loop to
+; its rolled form.
+
+; @foo would not be partially unrolled by default; the recorded factor of 4
+; forces it.
+; CHECK-LABEL: @foo(
+; CHECK: store i32
+; CHECK: store i32
+; CHECK: store i32
+; CHECK: store i32
+; CHECK: ret void
+define void @foo(i32* nocapture %a) {
+entry:
+  br label %loop
+
+loop:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %loop ]
+  %p = getelementptr inbounds i32, i32* %a, i64 %iv
+  %v = load i32, i32* %p
+  %inc = add nsw i32 %v, 1
+  store i32 %inc, i32* %p
+  %iv.next = add nuw nsw i64 %iv, 1
+  %cmp = icmp eq i64 %iv.next, 1024
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; @bar would be fully unrolled by default; the recorded factor of 0 keeps it
+; rolled.
+; CHECK-LABEL: @bar(
+; CHECK: store i32
+; CHECK-NOT: store i32
+; CHECK: ret void
+define void @bar(i32* nocapture %a) {
+entry:
+  br label %loop
+
+loop:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %loop ]
+  %p = getelementptr inbounds i32, i32* %a, i64 %iv
+  %v = load i32, i32* %p
+  %inc = add nsw i32 %v, 1
+  store i32 %inc, i32* %p
+  %iv.next = add nuw nsw i64 %iv, 1
+  %cmp = icmp eq i64 %iv.next, 4
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,19 @@
+; Basic test: check that the module is split into two partitions along
+; function boundaries, with a declaration left behind in the other half.
+
+; RUN: llvm-split -j2 -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; CHECK0: declare void @funcFoo
+; CHECK1: define void @funcFoo
+define void @funcFoo() {
+  ret void
+}
+
+; CHECK0: define void @funcBar
+; CHECK1: declare void @funcBar
+define void @funcBar() {
+  call void @funcFoo()
+  ret void
+}
@@ -0,0 +1,19 @@
+; Check that internal symbols are externalized with hidden visibility so the
+; partitions can still reference each other after splitting.
+
+; RUN: llvm-split -j2 -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; CHECK0: define hidden void @foo
+; CHECK1: declare hidden void @foo
+define internal void @foo() {
+  ret void
+}
+
+; CHECK0: declare void @bar
+; CHECK1: define void @bar
+define void @bar() {
+  call void @foo()
+  ret void
+}
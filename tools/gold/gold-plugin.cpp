@@ -322,6 +322,73 @@ static ld_plugin_status claim_file_hook(const ld_plugin_input_file *file,
     BufferRef = Buffer->getMemBufferRef();
   }
 
+  // Fast path: bitcode with a symbol table block describes its symbols
+  // without the module being materialized. Bitcode without the block and
+  // native objects with embedded bitcode fall through to the full parse.
+  std::vector<object::IRObjectFile::FileSymbol> FileSyms;
+  ErrorOr<bool> HasSymtab = object::IRObjectFile::readSymbols(BufferRef,
+                                                              FileSyms);
+  if (HasSymtab && *HasSymtab) {
+    *claimed = 1;
+
+    Modules.resize(Modules.size() + 1);
+    claimed_file &cf = Modules.back();
+
+    cf.handle = file->handle;
+
+    for (object::IRObjectFile::FileSymbol &FileSym : FileSyms) {
+      if (shouldSkip(FileSym.Flags))
+        continue;
+
+      cf.syms.push_back(ld_plugin_symbol());
+      ld_plugin_symbol &sym = cf.syms.back();
+      sym.version = nullptr;
+
+      sym.name = strdup(FileSym.Name.c_str());
+
+      sym.visibility = LDPV_DEFAULT;
+      switch (FileSym.Visibility) {
+      case GlobalValue::DefaultVisibility:
+        sym.visibility = LDPV_DEFAULT;
+        break;
+      case GlobalValue::HiddenVisibility:
+        sym.visibility = LDPV_HIDDEN;
+        break;
+      case GlobalValue::ProtectedVisibility:
+        sym.visibility = LDPV_PROTECTED;
+        break;
+      }
+
+      if (FileSym.Flags & object::BasicSymbolRef::SF_Undefined) {
+        sym.def = LDPK_UNDEF;
+        if (FileSym.IsExternalWeak)
+          sym.def = LDPK_WEAKUNDEF;
+      } else {
+        sym.def = LDPK_DEF;
+        if (FileSym.Flags & object::BasicSymbolRef::SF_Common)
+          sym.def = LDPK_COMMON;
+        else if (FileSym.IsWeakForLinker)
+          sym.def = LDPK_WEAKDEF;
+      }
+
+      sym.size = 0;
+      sym.comdat_key = nullptr;
+      if (!FileSym.Comdat.empty())
+        sym.comdat_key = strdup(FileSym.Comdat.c_str());
+
+      sym.resolution = LDPR_UNKNOWN;
+    }
+
+    if (!cf.syms.empty()) {
+      if (add_symbols(cf.handle, cf.syms.size(), &cf.syms[0]) != LDPS_OK) {
+        message(LDPL_ERROR, "Unable to add symbols!");
+        return LDPS_ERR;
+      }
+    }
+
+    return LDPS_OK;
+  }
+
   Context.setDiagnosticHandler(diagnosticHandler);
   ErrorOr<std::unique_ptr<object::IRObjectFile>> ObjOrErr =
       object::IRObjectFile::create(BufferRef, Context);
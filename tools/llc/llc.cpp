@@ -39,6 +39,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/async_raw_ostream.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
@@ -79,6 +80,11 @@ TargetTriple("mtriple", cl::desc("Override target triple for module"));
 static cl::opt<bool> NoVerify("disable-verify", cl::Hidden,
                               cl::desc("Do not verify input module"));
 
+static cl::opt<bool>
+    AsyncOutput("async-output", cl::Hidden,
+                cl::desc("Drain assembly output through a background writer "
+                         "thread, overlapping I/O with codegen"));
+
 static cl::opt<bool> DisableSimplifyLibCalls("disable-simplify-libcalls",
                                              cl::desc("Disable simplify-libcalls"));
 
@@ -314,7 +320,18 @@ static int compileModule(char **argv, LLVMContext &Context) {
              << ": warning: ignoring -mc-relax-all because filetype != obj";
 
   {
-    formatted_raw_ostream FOS(Out->os());
+    // With -async-output, hand the text stream to a background writer thread
+    // so slow file systems do not stall the printer. Object emission seeks in
+    // its stream, which the async writer cannot do.
+    std::unique_ptr<async_raw_ostream> AOS;
+    if (AsyncOutput) {
+      if (FileType == TargetMachine::CGFT_AssemblyFile)
+        AOS.reset(new async_raw_ostream(Out->os()));
+      else
+        errs() << argv[0]
+               << ": warning: ignoring -async-output because filetype != asm";
+    }
+    formatted_raw_ostream FOS(AOS ? *AOS : Out->os());
 
     AnalysisID StartAfterID = nullptr;
     AnalysisID StopAfterID = nullptr;
@@ -17,6 +17,7 @@
 #include "RemoteMemoryManager.h"
 #include "RemoteTarget.h"
 #include "RemoteTargetExternal.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
@@ -52,6 +53,9 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Instrumentation.h"
 #include <cerrno>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #ifdef __CYGWIN__
 #include <cygwin/version.h>
@@ -75,6 +79,17 @@ namespace {
                                  cl::desc("Force interpretation: disable JIT"),
                                  cl::init(false));
 
+  cl::opt<bool> Tiered("tiered",
+                       cl::desc("Start in the interpreter and compile hot "
+                                "functions with MCJIT on a background thread"),
+                       cl::init(false));
+
+  cl::opt<unsigned> TierUpThreshold(
+      "tier-up-threshold",
+      cl::desc("Number of invocations before a function is handed to the "
+               "JIT in -tiered mode (default = 1000)"),
+      cl::init(1000));
+
   cl::opt<bool> UseOrcMCJITReplacement("use-orcmcjit",
                                        cl::desc("Use the experimental "
                                                 "OrcMCJITReplacement as a "
@@ -318,6 +333,100 @@ private:
   }
 };
 
+// The background compiler used by -tiered execution. It owns an MCJIT
+// instance built from a bitcode copy of the module in a private LLVMContext,
+// so the interpreter's IR is never touched off the main thread. Hot functions
+// are requested and delivered by name; the interpreter keeps interpreting a
+// function until its native body is ready. MCJIT compiles a module at a time,
+// so the first request pays for the whole module and later requests are plain
+// lookups.
+class BackgroundTierUpCompiler {
+public:
+  explicit BackgroundTierUpCompiler(StringRef Bitcode)
+      : Bitcode(Bitcode), ShuttingDown(false), Worker([this] { run(); }) {}
+
+  ~BackgroundTierUpCompiler() {
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      ShuttingDown = true;
+    }
+    WorkAvailable.notify_one();
+    Worker.join();
+  }
+
+  /// Return the native body for F if its compilation has finished, requesting
+  /// compilation first if it has not been requested yet.
+  void *getCompiledBody(Function &F) {
+    if (!F.hasName())
+      return nullptr;
+    std::lock_guard<std::mutex> Guard(Lock);
+    StringMap<void *>::iterator I = Compiled.find(F.getName());
+    if (I != Compiled.end())
+      return I->second;
+    if (Requested.insert(F.getName()).second) {
+      Pending.push_back(F.getName());
+      WorkAvailable.notify_one();
+    }
+    return nullptr;
+  }
+
+private:
+  void run() {
+    LLVMContext Ctx;
+    ErrorOr<Module *> MOrErr =
+        parseBitcodeFile(MemoryBufferRef(Bitcode, "tier-up"), Ctx);
+    std::unique_ptr<ExecutionEngine> JIT;
+    if (MOrErr) {
+      std::unique_ptr<Module> M(MOrErr.get());
+      // Global variable storage belongs to the interpreter. Drop the copied
+      // definitions of named globals so the JIT resolves them through the
+      // symbols main() registered with the process symbol table, and
+      // externalize local definitions so they can be looked up by name.
+      for (GlobalVariable &GV : M->globals())
+        if (GV.hasName() && GV.hasInitializer()) {
+          GV.setInitializer(nullptr);
+          GV.setLinkage(GlobalValue::ExternalLinkage);
+        }
+      for (Function &F : *M)
+        if (!F.isDeclaration() && F.hasLocalLinkage())
+          F.setLinkage(GlobalValue::ExternalLinkage);
+      JIT.reset(EngineBuilder(std::move(M))
+                    .setEngineKind(EngineKind::JIT)
+                    .create());
+    }
+    if (!JIT)
+      errs() << "lli: -tiered: background JIT unavailable, "
+                "staying in the interpreter\n";
+
+    while (true) {
+      std::string Name;
+      {
+        std::unique_lock<std::mutex> Guard(Lock);
+        WorkAvailable.wait(Guard,
+                           [this] { return ShuttingDown || !Pending.empty(); });
+        if (ShuttingDown)
+          return;
+        Name = Pending.back();
+        Pending.pop_back();
+      }
+      uint64_t Addr = JIT ? JIT->getFunctionAddress(Name) : 0;
+      if (Addr) {
+        std::lock_guard<std::mutex> Guard(Lock);
+        Compiled[Name] = (void *)(uintptr_t)Addr;
+      }
+    }
+  }
+
+  std::string Bitcode;
+  std::mutex Lock;
+  std::condition_variable WorkAvailable;
+  std::vector<std::string> Pending;
+  StringSet<> Requested;
+  StringMap<void *> Compiled;
+  bool ShuttingDown;
+  std::thread Worker; // Must be last: the thread uses the other members.
+};
+
 static ExecutionEngine *EE = nullptr;
 static LLIObjectCache *CacheManager = nullptr;
 
@@ -426,7 +535,9 @@ int main(int argc, char **argv, char * const *envp) {
   builder.setRelocationModel(RelocModel);
   builder.setCodeModel(CMModel);
   builder.setErrorStr(&ErrorMsg);
-  builder.setEngineKind(ForceInterpreter
+  // Tiered execution starts in the interpreter; the JIT tier is a separate
+  // engine owned by the background compiler.
+  builder.setEngineKind(ForceInterpreter || Tiered
                         ? EngineKind::Interpreter
                         : EngineKind::JIT);
   builder.setUseOrcMCJITReplacement(UseOrcMCJITReplacement);
@@ -437,7 +548,7 @@ int main(int argc, char **argv, char * const *envp) {
 
   // Enable MCJIT if desired.
   RTDyldMemoryManager *RTDyldMM = nullptr;
-  if (!ForceInterpreter) {
+  if (!ForceInterpreter && !Tiered) {
     if (RemoteMCJIT)
       RTDyldMM = new RemoteMemoryManager();
     else
@@ -495,6 +606,26 @@ int main(int argc, char **argv, char * const *envp) {
     EE->setObjectCache(CacheManager);
   }
 
+  // Set up tiered execution: snapshot the module as bitcode for the
+  // background compiler before anything mutates it, publish the
+  // interpreter's global variable storage so JIT'ed code shares it, and
+  // install the compiler in the interpreter.
+  std::unique_ptr<BackgroundTierUpCompiler> TierUpJIT;
+  if (Tiered) {
+    SmallString<0> BC;
+    raw_svector_ostream BCOS(BC);
+    WriteBitcodeToFile(Mod, BCOS);
+    BCOS.flush();
+    for (GlobalVariable &GV : Mod->globals())
+      if (GV.hasName() && !GV.isDeclaration())
+        sys::DynamicLibrary::AddSymbol(GV.getName(),
+                                       EE->getPointerToGlobal(&GV));
+    TierUpJIT.reset(new BackgroundTierUpCompiler(BC.str()));
+    EE->InstallTierUpCompiler(
+        [&](Function &F) { return TierUpJIT->getCompiledBody(F); },
+        TierUpThreshold);
+  }
+
   // Load any additional modules specified on the command line.
   for (unsigned i = 0, e = ExtraModules.size(); i != e; ++i) {
     std::unique_ptr<Module> XMod = parseIRFile(ExtraModules[i], Err, Context);
@@ -600,7 +731,7 @@ int main(int argc, char **argv, char * const *envp) {
                                                       nullptr);
 
     // Run static constructors.
-    if (!ForceInterpreter) {
+    if (!ForceInterpreter && !Tiered) {
       // Give MCJIT a chance to apply relocations and set page permissions.
       EE->finalizeObject();
     }
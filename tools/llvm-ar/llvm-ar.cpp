@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <memory>
+#include <thread>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
@@ -684,34 +685,33 @@ static void writeStringTable(raw_fd_ostream &Out,
   Out.seek(Pos);
 }
 
-// Returns the offset of the first reference to a member offset.
-static unsigned writeSymbolTable(raw_fd_ostream &Out,
-                                 ArrayRef<NewArchiveIterator> Members,
-                                 ArrayRef<MemoryBufferRef> Buffers,
-                                 std::vector<unsigned> &MemberOffsetRefs) {
-  unsigned StartOffset = 0;
-  unsigned MemberNum = 0;
-  std::string NameBuf;
-  raw_string_ostream NameOS(NameBuf);
-  unsigned NumSyms = 0;
-  LLVMContext &Context = getGlobalContext();
-  for (ArrayRef<NewArchiveIterator>::iterator I = Members.begin(),
-                                              E = Members.end();
-       I != E; ++I, ++MemberNum) {
-    MemoryBufferRef MemberBuffer = Buffers[MemberNum];
+namespace {
+/// Symbols extracted from one prospective archive member.
+struct MemberSymbols {
+  std::string Names; // Null-terminated symbol names, concatenated.
+  unsigned NumSyms;
+  bool IsObject;      // Whether the member parsed as a symbolic file.
+  std::error_code EC; // Deferred error from reading the member.
+  MemberSymbols() : NumSyms(0), IsObject(false) {}
+};
+}
+
+static void extractMemberSymbols(ArrayRef<MemoryBufferRef> Buffers,
+                                 MutableArrayRef<MemberSymbols> Infos) {
+  // Each worker needs its own context: bitcode members get materialized into
+  // it and LLVMContext is not thread safe.
+  LLVMContext Context;
+  for (unsigned I = 0, N = Buffers.size(); I != N; ++I) {
+    MemberSymbols &Info = Infos[I];
     ErrorOr<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
         object::SymbolicFile::createSymbolicFile(
-            MemberBuffer, sys::fs::file_magic::unknown, &Context);
+            Buffers[I], sys::fs::file_magic::unknown, &Context);
     if (!ObjOrErr)
       continue;  // FIXME: check only for "not an object file" errors.
     object::SymbolicFile &Obj = *ObjOrErr.get();
+    Info.IsObject = true;
 
-    if (!StartOffset) {
-      printMemberHeader(Out, "", sys::TimeValue::now(), 0, 0, 0, 0);
-      StartOffset = Out.tell();
-      print32BE(Out, 0);
-    }
-
+    raw_string_ostream NameOS(Info.Names);
     for (const object::BasicSymbolRef &S : Obj.symbols()) {
       uint32_t Symflags = S.getFlags();
       if (Symflags & object::SymbolRef::SF_FormatSpecific)
@@ -720,14 +720,64 @@ static unsigned writeSymbolTable(raw_fd_ostream &Out,
         continue;
       if (Symflags & object::SymbolRef::SF_Undefined)
         continue;
-      failIfError(S.printName(NameOS));
+      if ((Info.EC = S.printName(NameOS)))
+        return;
       NameOS << '\0';
-      ++NumSyms;
+      ++Info.NumSyms;
+    }
+  }
+}
+
+// Returns the offset of the first reference to a member offset.
+static unsigned writeSymbolTable(raw_fd_ostream &Out,
+                                 ArrayRef<NewArchiveIterator> Members,
+                                 ArrayRef<MemoryBufferRef> Buffers,
+                                 std::vector<unsigned> &MemberOffsetRefs) {
+  // Reading the members is what dominates archive writes, so extract the
+  // symbols of all members first, splitting them over a group of threads.
+  // Emission below stays serial and in member order, so the output is the
+  // same as with a serial scan.
+  std::vector<MemberSymbols> Infos(Buffers.size());
+  unsigned NumThreads = std::max(1u, std::thread::hardware_concurrency());
+  NumThreads = std::min(NumThreads, unsigned(Buffers.size()));
+  if (NumThreads <= 1) {
+    extractMemberSymbols(Buffers, Infos);
+  } else {
+    std::vector<std::thread> Threads;
+    for (unsigned I = 0; I != NumThreads; ++I) {
+      size_t Begin = Buffers.size() * I / NumThreads;
+      size_t End = Buffers.size() * (I + 1) / NumThreads;
+      Threads.emplace_back(
+          extractMemberSymbols, Buffers.slice(Begin, End - Begin),
+          MutableArrayRef<MemberSymbols>(Infos).slice(Begin, End - Begin));
+    }
+    for (std::thread &T : Threads)
+      T.join();
+  }
+  for (const MemberSymbols &Info : Infos)
+    failIfError(Info.EC);
+
+  unsigned StartOffset = 0;
+  unsigned NumSyms = 0;
+  for (unsigned MemberNum = 0, N = Infos.size(); MemberNum != N; ++MemberNum) {
+    const MemberSymbols &Info = Infos[MemberNum];
+    if (!Info.IsObject)
+      continue;
+
+    if (!StartOffset) {
+      printMemberHeader(Out, "", sys::TimeValue::now(), 0, 0, 0, 0);
+      StartOffset = Out.tell();
+      print32BE(Out, 0);
+    }
+
+    for (unsigned I = 0; I != Info.NumSyms; ++I) {
       MemberOffsetRefs.push_back(MemberNum);
       print32BE(Out, 0);
     }
+    NumSyms += Info.NumSyms;
   }
-  Out << NameOS.str();
+  for (const MemberSymbols &Info : Infos)
+    Out << Info.Names;
 
   if (StartOffset == 0)
     return 0;
@@ -21,6 +21,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -51,6 +52,10 @@ static cl::opt<bool>
 DisableVerify("disable-verify", cl::Hidden,
               cl::desc("Do not run verifier on input LLVM (dangerous!)"));
 
+static cl::opt<bool>
+CompressBitcode("compress",
+                cl::desc("Emit a zlib-compressed bitcode container"));
+
 static void WriteOutputFile(const Module *M) {
   // Infer the output filename if needed.
   if (OutputFilename.empty()) {
@@ -77,8 +82,12 @@ static void WriteOutputFile(const Module *M) {
     exit(1);
   }
 
-  if (Force || !CheckBitcodeOutputToConsole(Out->os(), true))
-    WriteBitcodeToFile(M, Out->os());
+  if (Force || !CheckBitcodeOutputToConsole(Out->os(), true)) {
+    if (CompressBitcode)
+      WriteCompressedBitcodeToFile(M, Out->os());
+    else
+      WriteBitcodeToFile(M, Out->os());
+  }
 
   // Declare success.
   Out->keep();
@@ -92,6 +101,11 @@ int main(int argc, char **argv) {
   llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
   cl::ParseCommandLineOptions(argc, argv, "llvm .ll -> .bc assembler\n");
 
+  if (CompressBitcode && !zlib::isAvailable()) {
+    errs() << argv[0] << ": -compress requires zlib, which is not available\n";
+    return 1;
+  }
+
   // Parse the file now...
   SMDiagnostic Err;
   std::unique_ptr<Module> M = parseAssemblyFile(InputFilename, Err, Context);
@@ -110,6 +110,7 @@ static const char *GetBlockName(unsigned BlockID,
   case bitc::METADATA_BLOCK_ID:        return "METADATA_BLOCK";
   case bitc::METADATA_ATTACHMENT_ID:   return "METADATA_ATTACHMENT_BLOCK";
   case bitc::USELIST_BLOCK_ID:         return "USELIST_BLOCK_ID";
+  case bitc::FUNCTION_DIGEST_BLOCK_ID: return "FUNCTION_DIGEST_BLOCK";
   }
 }
 
@@ -259,6 +260,11 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
     case bitc::VST_CODE_ENTRY: return "ENTRY";
     case bitc::VST_CODE_BBENTRY: return "BBENTRY";
     }
+  case bitc::FUNCTION_DIGEST_BLOCK_ID:
+    switch (CodeID) {
+    default: return nullptr;
+    case bitc::FNDIGEST_CODE_ENTRY: return "ENTRY";
+    }
   case bitc::METADATA_ATTACHMENT_ID:
     switch(CodeID) {
     default:return nullptr;
@@ -15,6 +15,7 @@
 #include "RenderingSupport.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 namespace {
@@ -200,11 +201,20 @@ void CoverageReport::renderFileReports(raw_ostream &OS) {
      << "\n";
   renderDivider(FileReportColumns, OS);
   OS << "\n";
+  // Summarizing the functions of each file is independent work; do it on the
+  // shared thread pool and render the results in order afterwards.
+  std::vector<StringRef> Files = Coverage->getUniqueSourceFiles();
+  std::vector<std::vector<FunctionCoverageSummary>> FileSummaries(
+      Files.size());
+  parallel::for_each_n((size_t)0, Files.size(), [&](size_t I) {
+    for (const auto &F : Coverage->getCoveredFunctions(Files[I]))
+      FileSummaries[I].push_back(FunctionCoverageSummary::get(F));
+  });
+
   FileCoverageSummary Totals("TOTAL");
-  for (StringRef Filename : Coverage->getUniqueSourceFiles()) {
-    FileCoverageSummary Summary(Filename);
-    for (const auto &F : Coverage->getCoveredFunctions(Filename)) {
-      FunctionCoverageSummary Function = FunctionCoverageSummary::get(F);
+  for (size_t I = 0, E = Files.size(); I != E; ++I) {
+    FileCoverageSummary Summary(Files[I]);
+    for (const auto &Function : FileSummaries[I]) {
       Summary.addFunction(Function);
       Totals.addFunction(Function);
     }
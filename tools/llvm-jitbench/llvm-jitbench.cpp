@@ -0,0 +1,275 @@
+//===- llvm-jitbench.cpp - JIT throughput and latency stress harness ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This tool stresses the MCJIT and Orc execution engine stacks with
+// synthetically generated modules and reports compile latency percentiles,
+// aggregate throughput and code cache allocation behavior across a
+// configurable number of worker threads. It exists so that JIT changes can be
+// quantified on a developer machine instead of in deployment.
+//
+// Each worker owns its LLVMContext, module and engine; the only shared state
+// is the job counter and the result vectors, so the scaling numbers reflect
+// the JIT stack itself rather than harness locking.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/OrcMCJITReplacement.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+enum BenchEngine { EngineMCJIT, EngineOrc };
+
+cl::opt<BenchEngine> Engine(
+    "engine", cl::desc("Execution engine stack to stress:"),
+    cl::values(clEnumValN(EngineMCJIT, "mcjit", "MCJIT (default)"),
+               clEnumValN(EngineOrc, "orc",
+                          "Orc, via the MCJIT replacement layers"),
+               clEnumValEnd),
+    cl::init(EngineMCJIT));
+
+cl::opt<unsigned> NumThreads("threads",
+                             cl::desc("Number of compile threads (0 = one per "
+                                      "hardware thread)"),
+                             cl::init(1));
+
+cl::opt<unsigned> NumModules("modules",
+                             cl::desc("Number of modules to compile"),
+                             cl::init(64));
+
+cl::opt<unsigned>
+    FuncsPerModule("functions", cl::desc("Functions generated per module"),
+                   cl::init(16));
+
+cl::opt<unsigned> OpsPerFunc("ops",
+                             cl::desc("Arithmetic operations per function"),
+                             cl::init(64));
+
+cl::opt<unsigned> Seed("seed", cl::desc("Seed for module generation"),
+                       cl::init(1));
+
+cl::opt<bool> RunCode("run",
+                      cl::desc("Execute each compiled function once"),
+                      cl::init(false));
+
+/// Code cache counters, shared by all workers' memory managers.
+std::atomic<uint64_t> CodeBytes(0);
+std::atomic<uint64_t> DataBytes(0);
+std::atomic<uint64_t> CodeSections(0);
+std::atomic<uint64_t> DataSections(0);
+
+/// A SectionMemoryManager that tallies what the JIT asks for, so the report
+/// can show cache footprint per configuration.
+class CountingMemoryManager : public SectionMemoryManager {
+public:
+  uint8_t *allocateCodeSection(uintptr_t Size, unsigned Alignment,
+                               unsigned SectionID,
+                               StringRef SectionName) override {
+    CodeBytes += Size;
+    ++CodeSections;
+    return SectionMemoryManager::allocateCodeSection(Size, Alignment,
+                                                     SectionID, SectionName);
+  }
+
+  uint8_t *allocateDataSection(uintptr_t Size, unsigned Alignment,
+                               unsigned SectionID, StringRef SectionName,
+                               bool IsReadOnly) override {
+    DataBytes += Size;
+    ++DataSections;
+    return SectionMemoryManager::allocateDataSection(
+        Size, Alignment, SectionID, SectionName, IsReadOnly);
+  }
+};
+
+/// Simple deterministic generator so runs are comparable across machines and
+/// revisions.
+class LCG {
+  uint64_t State;
+
+public:
+  explicit LCG(uint64_t S) : State(S) {}
+  uint64_t next() {
+    State = State * 6364136223846793005ULL + 1442695040888963407ULL;
+    return State >> 33;
+  }
+};
+
+/// Generate one module of straight-line integer arithmetic. Functions call
+/// their predecessor so every module also exercises local relocations.
+std::unique_ptr<Module> generateModule(LLVMContext &Context, unsigned Index) {
+  auto M = llvm::make_unique<Module>("jitbench" + Twine(Index).str(), Context);
+  IRBuilder<> B(Context);
+  LCG Rand((uint64_t)Seed * 9973 + Index);
+
+  Function *Prev = nullptr;
+  for (unsigned F = 0; F != FuncsPerModule; ++F) {
+    Function *Fn = Function::Create(
+        FunctionType::get(B.getInt64Ty(), /*isVarArg=*/false),
+        GlobalValue::ExternalLinkage,
+        "m" + Twine(Index).str() + "_f" + Twine(F).str(), M.get());
+    BasicBlock *Entry = BasicBlock::Create(Context, "entry", Fn);
+    B.SetInsertPoint(Entry);
+
+    Value *Acc = B.getInt64(Rand.next());
+    for (unsigned Op = 0; Op != OpsPerFunc; ++Op) {
+      Value *C = B.getInt64(Rand.next() | 1);
+      switch (Rand.next() % 4) {
+      case 0: Acc = B.CreateAdd(Acc, C); break;
+      case 1: Acc = B.CreateSub(Acc, C); break;
+      case 2: Acc = B.CreateMul(Acc, C); break;
+      case 3: Acc = B.CreateXor(Acc, C); break;
+      }
+    }
+    if (Prev)
+      Acc = B.CreateXor(Acc, B.CreateCall(Prev));
+    B.CreateRet(Acc);
+    Prev = Fn;
+  }
+
+  assert(!verifyModule(*M) && "generated module failed verification");
+  return M;
+}
+
+/// Compile (and optionally run) one module, returning the latency in
+/// milliseconds, or a negative value on failure.
+double compileOneModule(unsigned Index) {
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point Start = Clock::now();
+
+  LLVMContext Context;
+  std::unique_ptr<Module> M = generateModule(Context, Index);
+  std::string EntryName = M->getFunctionList().back().getName();
+
+  std::string Error;
+  EngineBuilder Builder(std::move(M));
+  Builder.setErrorStr(&Error)
+      .setEngineKind(EngineKind::JIT)
+      .setMCJITMemoryManager(llvm::make_unique<CountingMemoryManager>())
+      .setUseOrcMCJITReplacement(Engine == EngineOrc);
+  std::unique_ptr<ExecutionEngine> EE(Builder.create());
+  if (!EE) {
+    errs() << "error: failed to create execution engine: " << Error << "\n";
+    return -1.0;
+  }
+
+  uint64_t Addr = EE->getFunctionAddress(EntryName);
+  if (!Addr) {
+    errs() << "error: no address for " << EntryName << "\n";
+    return -1.0;
+  }
+  if (RunCode)
+    ((int64_t (*)())(intptr_t)Addr)();
+
+  Clock::time_point End = Clock::now();
+  return std::chrono::duration<double, std::milli>(End - Start).count();
+}
+
+double percentile(const std::vector<double> &Sorted, double Pct) {
+  if (Sorted.empty())
+    return 0.0;
+  size_t Index = (size_t)(Pct / 100.0 * (Sorted.size() - 1) + 0.5);
+  return Sorted[std::min(Index, Sorted.size() - 1)];
+}
+
+} // end anonymous namespace
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;
+  cl::ParseCommandLineOptions(argc, argv, "llvm JIT stress harness\n");
+
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+  InitializeNativeTargetAsmParser();
+
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::atomic<unsigned> NextModule(0);
+  std::atomic<bool> Failed(false);
+  std::vector<double> Latencies;
+  std::mutex LatenciesLock;
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point Start = Clock::now();
+
+  std::vector<std::thread> Workers;
+  for (unsigned T = 0; T != Threads; ++T)
+    Workers.push_back(std::thread([&] {
+      std::vector<double> Local;
+      for (;;) {
+        unsigned Index = NextModule++;
+        if (Index >= NumModules)
+          break;
+        double Ms = compileOneModule(Index);
+        if (Ms < 0.0) {
+          Failed = true;
+          break;
+        }
+        Local.push_back(Ms);
+      }
+      std::lock_guard<std::mutex> Guard(LatenciesLock);
+      Latencies.insert(Latencies.end(), Local.begin(), Local.end());
+    }));
+  for (std::thread &W : Workers)
+    W.join();
+
+  double WallMs = std::chrono::duration<double, std::milli>(
+      Clock::now() - Start).count();
+
+  if (Failed || Latencies.empty())
+    return 1;
+
+  std::sort(Latencies.begin(), Latencies.end());
+  double Total = 0.0;
+  for (double Ms : Latencies)
+    Total += Ms;
+
+  outs() << "engine:           "
+         << (Engine == EngineOrc ? "orc" : "mcjit") << "\n"
+         << "threads:          " << Threads << "\n"
+         << "modules:          " << Latencies.size() << " ("
+         << FuncsPerModule << " functions x " << OpsPerFunc << " ops)\n"
+         << format("wall time:        %.1f ms\n", WallMs)
+         << format("throughput:       %.1f modules/s\n",
+                   Latencies.size() * 1000.0 / WallMs)
+         << format("latency mean:     %.2f ms\n", Total / Latencies.size())
+         << format("latency p50:      %.2f ms\n", percentile(Latencies, 50))
+         << format("latency p90:      %.2f ms\n", percentile(Latencies, 90))
+         << format("latency p99:      %.2f ms\n", percentile(Latencies, 99))
+         << format("latency max:      %.2f ms\n", Latencies.back())
+         << "code allocated:   " << CodeBytes << " bytes in " << CodeSections
+         << " sections\n"
+         << "data allocated:   " << DataBytes << " bytes in " << DataSections
+         << " sections\n";
+  return 0;
+}
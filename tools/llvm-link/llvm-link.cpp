@@ -29,7 +29,11 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 using namespace llvm;
 
 static cl::list<std::string>
@@ -57,6 +61,84 @@ static cl::opt<bool>
 SuppressWarnings("suppress-warnings", cl::desc("Suppress all linking warnings"),
                  cl::init(false));
 
+static cl::opt<unsigned>
+PreloadInputs("preload-inputs", cl::init(0),
+              cl::desc("Read up to N input files ahead on a background thread "
+                       "while earlier inputs are linked (0 = no preloading)"));
+
+namespace {
+/// Reads input files into memory buffers ahead of the link so that file I/O
+/// overlaps with bitcode decoding and value mapping. Only the raw reads
+/// happen on the background thread; parsing and materialization mutate the
+/// LLVMContext and stay on the main thread.
+class InputPrefetcher {
+public:
+  explicit InputPrefetcher(unsigned Lookahead)
+      : Slots(InputFilenames.size()), NextToTake(0), Lookahead(Lookahead),
+        Stop(false), Reader([this]() { run(); }) {}
+
+  ~InputPrefetcher() {
+    {
+      std::lock_guard<std::mutex> Lock(Mtx);
+      Stop = true;
+    }
+    SlotFreed.notify_one();
+    Reader.join();
+  }
+
+  /// Hand over the buffer for input \p I, blocking until the background
+  /// thread has read it.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> take(unsigned I) {
+    std::unique_lock<std::mutex> Lock(Mtx);
+    BufferReady.wait(Lock, [&] { return Slots[I].Done; });
+    std::error_code EC = Slots[I].EC;
+    std::unique_ptr<MemoryBuffer> Buffer = std::move(Slots[I].Buffer);
+    NextToTake = I + 1;
+    SlotFreed.notify_one();
+    if (EC)
+      return EC;
+    return std::move(Buffer);
+  }
+
+private:
+  struct Slot {
+    std::error_code EC;
+    std::unique_ptr<MemoryBuffer> Buffer;
+    bool Done = false;
+  };
+
+  void run() {
+    for (unsigned I = 0, E = InputFilenames.size(); I != E; ++I) {
+      {
+        std::unique_lock<std::mutex> Lock(Mtx);
+        SlotFreed.wait(
+            Lock, [&] { return Stop || I < NextToTake + Lookahead; });
+        if (Stop)
+          return;
+      }
+      ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+          MemoryBuffer::getFileOrSTDIN(InputFilenames[I]);
+      std::lock_guard<std::mutex> Lock(Mtx);
+      if (BufOrErr)
+        Slots[I].Buffer = std::move(BufOrErr.get());
+      else
+        Slots[I].EC = BufOrErr.getError();
+      Slots[I].Done = true;
+      BufferReady.notify_one();
+    }
+  }
+
+  std::mutex Mtx;
+  std::condition_variable BufferReady;
+  std::condition_variable SlotFreed;
+  std::vector<Slot> Slots;
+  unsigned NextToTake;
+  unsigned Lookahead;
+  bool Stop;
+  std::thread Reader; // Declared last: starts once the state above is set up.
+};
+}
+
 // Read the specified bitcode file in and return it. This routine searches the
 // link path for the specified file to try to find it...
 //
@@ -104,8 +186,26 @@ int main(int argc, char **argv) {
   auto Composite = make_unique<Module>("llvm-link", Context);
   Linker L(Composite.get(), diagnosticHandler);
 
+  std::unique_ptr<InputPrefetcher> Prefetcher;
+  if (PreloadInputs)
+    Prefetcher.reset(new InputPrefetcher(PreloadInputs));
+
   for (unsigned i = 0; i < InputFilenames.size(); ++i) {
-    std::unique_ptr<Module> M = loadFile(argv[0], InputFilenames[i], Context);
+    std::unique_ptr<Module> M;
+    if (Prefetcher) {
+      ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr = Prefetcher->take(i);
+      if (std::error_code EC = BufOrErr.getError()) {
+        errs() << argv[0] << ": could not open input file '"
+               << InputFilenames[i] << "': " << EC.message() << "\n";
+        return 1;
+      }
+      if (Verbose) errs() << "Loading '" << InputFilenames[i] << "'\n";
+      SMDiagnostic Err;
+      M = getLazyIRModule(std::move(BufOrErr.get()), Err, Context);
+      if (!M)
+        Err.print(argv[0], errs());
+    } else
+      M = loadFile(argv[0], InputFilenames[i], Context);
     if (!M.get()) {
       errs() << argv[0] << ": error loading file '" <<InputFilenames[i]<< "'\n";
       return 1;
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/LTO/LTOCodeGenerator.h"
@@ -23,6 +24,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
+#include <list>
 
 using namespace llvm;
 
@@ -55,6 +57,11 @@ OutputFilename("o", cl::init(""),
   cl::desc("Override output filename"),
   cl::value_desc("filename"));
 
+static cl::opt<unsigned>
+Parallelism("j", cl::Prefix, cl::init(1),
+  cl::desc("Number of backend codegen partitions (requires -o); partition i "
+           "is written to <filename>.<i> for i > 0"));
+
 static cl::list<std::string>
 ExportedSymbols("exported-symbol",
   cl::desc("Symbol to export from the resulting object file"),
@@ -73,6 +80,11 @@ static cl::opt<bool> SetMergedModule(
     "set-merged-module", cl::init(false),
     cl::desc("Use the first input module as the merged module"));
 
+static cl::opt<bool> PreMergeDeadStrip(
+    "pre-merge-dead-strip", cl::init(false),
+    cl::desc("Resolve symbol liveness across the input modules and strip "
+             "dead definitions before merging them"));
+
 namespace {
 struct ModuleInfo {
   std::vector<bool> CanBeHidden;
@@ -186,8 +198,15 @@ int main(int argc, char **argv) {
   for (unsigned i = 0; i < DSOSymbols.size(); ++i)
     DSOSymbolsSet.insert(DSOSymbols[i]);
 
+  if (PreMergeDeadStrip)
+    CodeGen.setPreMergeDeadStrip(true);
+
   std::vector<std::string> KeptDSOSyms;
 
+  // With pre-merge dead stripping the code generator does not link the
+  // modules until compilation, so they must stay alive until then.
+  std::vector<std::unique_ptr<LTOModule>> KeptModules;
+
   for (unsigned i = BaseArg; i < InputFilenames.size(); ++i) {
     std::string error;
     std::unique_ptr<LTOModule> Module(
@@ -205,8 +224,11 @@ int main(int argc, char **argv) {
     if (SetMergedModule && i == BaseArg) {
       // Transfer ownership to the code generator.
       CodeGen.setModule(Module.release());
-    } else if (!CodeGen.addModule(Module.get()))
+    } else if (!CodeGen.addModule(Module.get())) {
       return 1;
+    } else if (PreMergeDeadStrip) {
+      KeptModules.push_back(std::move(Module));
+    }
 
     unsigned NumSyms = LTOMod->getSymbolCount();
     for (unsigned I = 0; I < NumSyms; ++I) {
@@ -241,6 +263,45 @@ int main(int argc, char **argv) {
   if (!attrs.empty())
     CodeGen.setAttr(attrs.c_str());
 
+  if (Parallelism < 1) {
+    errs() << argv[0] << ": -j must be at least 1\n";
+    return 1;
+  }
+
+  if (!OutputFilename.empty() && Parallelism > 1) {
+    std::string ErrorInfo;
+    if (!CodeGen.optimize(DisableOpt, DisableInline, DisableGVNLoadPRE,
+                          DisableLTOVectorization, ErrorInfo)) {
+      errs() << argv[0] << ": error optimizing the code: " << ErrorInfo
+             << "\n";
+      return 1;
+    }
+
+    std::list<raw_fd_ostream> OSs;
+    std::vector<raw_ostream *> OSPtrs;
+    for (unsigned I = 0; I != Parallelism; ++I) {
+      std::string PartFilename = OutputFilename;
+      if (I)
+        PartFilename += "." + utostr(I);
+      std::error_code EC;
+      OSs.emplace_back(PartFilename, EC, sys::fs::F_None);
+      if (EC) {
+        errs() << argv[0] << ": error opening the file '" << PartFilename
+               << "': " << EC.message() << "\n";
+        return 1;
+      }
+      OSPtrs.push_back(&OSs.back());
+    }
+
+    if (!CodeGen.compileOptimized(OSPtrs, ErrorInfo)) {
+      errs() << argv[0] << ": error compiling the code: " << ErrorInfo
+             << "\n";
+      return 1;
+    }
+
+    return 0;
+  }
+
   if (!OutputFilename.empty()) {
     size_t len = 0;
     std::string ErrorInfo;
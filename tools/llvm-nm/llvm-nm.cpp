@@ -37,8 +37,10 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
 #include <cstring>
@@ -152,11 +154,18 @@ cl::opt<bool> FormatMachOasHex("x", cl::desc("Print symbol entry in hex, "
 cl::opt<bool> NoLLVMBitcode("no-llvm-bc",
                             cl::desc("Disable LLVM bitcode reader"));
 
+cl::opt<unsigned>
+    BulkThreads("bulk-threads",
+                cl::desc("Parse and scan archive members with this number of "
+                         "threads; results are still printed in member order "
+                         "(0 = sequential)"),
+                cl::init(0));
+
 bool PrintAddress = true;
 
 bool MultipleFiles = false;
 
-bool HadError = false;
+std::atomic<bool> HadError(false);
 
 std::string ToolName;
 }
@@ -893,23 +902,25 @@ static unsigned getNsectInMachO(MachOObjectFile &Obj, basic_symbol_iterator I) {
   return 0;
 }
 
-static void dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
-                                      std::string ArchiveName = std::string(),
-                                      std::string ArchitectureName =
-                                        std::string()) {
+/// Build the symbol list for \p Obj into \p List.  The symbol names are
+/// stored back to back in \p NameBuffer, which must stay alive as long as
+/// \p List is used.  Returns false if the object should not be printed at
+/// all.  Safe to run off the main thread; nothing here touches the output
+/// stream or the global symbol list.
+static bool gatherSymbolList(SymbolicFile &Obj, SymbolListT &List,
+                             std::string &NameBuffer) {
   basic_symbol_iterator IBegin = Obj.symbol_begin();
   basic_symbol_iterator IEnd = Obj.symbol_end();
   if (DynamicSyms) {
     if (!Obj.isELF()) {
       error("File format has no dynamic symbol table", Obj.getFileName());
-      return;
+      return false;
     }
     std::pair<symbol_iterator, symbol_iterator> IDyn =
         getELFDynamicSymbolIterators(&Obj);
     IBegin = IDyn.first;
     IEnd = IDyn.second;
   }
-  std::string NameBuffer;
   raw_string_ostream OS(NameBuffer);
   // If a "-s segname sectname" option was specified and this is a Mach-O
   // file get the section number for that section in this object file.
@@ -919,7 +930,7 @@ static void dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
     Nsect = getNsectForSegSect(MachO);
     // If this section is not in the object file no symbols are printed.
     if (Nsect == 0)
-      return;
+      return false;
   }
   for (basic_symbol_iterator I = IBegin; I != IEnd; ++I) {
     uint32_t SymFlags = I->getFlags();
@@ -953,15 +964,25 @@ static void dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
       break;
     OS << '\0';
     S.Symb = I->getRawDataRefImpl();
-    SymbolList.push_back(S);
+    List.push_back(S);
   }
 
   OS.flush();
   const char *P = NameBuffer.c_str();
-  for (unsigned I = 0; I < SymbolList.size(); ++I) {
-    SymbolList[I].Name = P;
+  for (unsigned I = 0; I < List.size(); ++I) {
+    List[I].Name = P;
     P += strlen(P) + 1;
   }
+  return true;
+}
+
+static void dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
+                                      std::string ArchiveName = std::string(),
+                                      std::string ArchitectureName =
+                                        std::string()) {
+  std::string NameBuffer;
+  if (!gatherSymbolList(Obj, SymbolList, NameBuffer))
+    return;
 
   CurrentFilename = Obj.getFileName();
   sortAndPrintSymbolList(Obj, printName, ArchiveName, ArchitectureName);
@@ -1034,6 +1055,68 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
       }
     }
 
+    // Bulk mode: every member is a slice of the archive buffer already in
+    // memory, so they can be materialized and scanned concurrently.  The
+    // results are printed in member order below.
+    if (BulkThreads > 1) {
+      std::vector<Archive::child_iterator> Members;
+      for (Archive::child_iterator I = A->child_begin(), E = A->child_end();
+           I != E; ++I)
+        Members.push_back(I);
+
+      struct MemberDump {
+        // Bitcode members get their own context so they can be parsed
+        // concurrently.
+        std::unique_ptr<LLVMContext> Context;
+        std::unique_ptr<Binary> Bin;
+        SymbolListT Symbols;
+        std::string Names;
+        bool Valid;
+        MemberDump() : Valid(false) {}
+      };
+      std::vector<MemberDump> Dumps(Members.size());
+
+      {
+        ThreadPool Pool(BulkThreads);
+        for (unsigned i = 0, e = Members.size(); i != e; ++i) {
+          Pool.async([&Members, &Dumps, i] {
+            MemberDump &D = Dumps[i];
+            D.Context.reset(new LLVMContext);
+            ErrorOr<std::unique_ptr<Binary>> ChildOrErr =
+                Members[i]->getAsBinary(D.Context.get());
+            if (ChildOrErr.getError())
+              return;
+            if (isa<SymbolicFile>(ChildOrErr.get().get())) {
+              D.Bin = std::move(*ChildOrErr);
+              D.Valid = gatherSymbolList(*cast<SymbolicFile>(D.Bin.get()),
+                                         D.Symbols, D.Names);
+            }
+          });
+        }
+        Pool.wait();
+      }
+
+      for (unsigned i = 0, e = Dumps.size(); i != e; ++i) {
+        if (!Dumps[i].Valid)
+          continue;
+        SymbolicFile *O = cast<SymbolicFile>(Dumps[i].Bin.get());
+        if (!checkMachOAndArchFlags(O, Filename))
+          return;
+        if (!PrintFileName) {
+          outs() << "\n";
+          if (isa<MachOObjectFile>(O)) {
+            outs() << Filename << "(" << O->getFileName() << ")";
+          } else
+            outs() << O->getFileName();
+          outs() << ":\n";
+        }
+        SymbolList = std::move(Dumps[i].Symbols);
+        CurrentFilename = O->getFileName();
+        sortAndPrintSymbolList(*O, false, Filename, std::string());
+      }
+      return;
+    }
+
     for (Archive::child_iterator I = A->child_begin(), E = A->child_end();
          I != E; ++I) {
       ErrorOr<std::unique_ptr<Binary>> ChildOrErr = I->getAsBinary(&Context);
@@ -49,6 +49,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
@@ -195,6 +196,10 @@ static const Target *getTarget(const ObjectFile *Obj = nullptr) {
 }
 
 void llvm::DumpBytes(StringRef bytes) {
+  DumpBytes(bytes, outs());
+}
+
+void llvm::DumpBytes(StringRef bytes, raw_ostream &OS) {
   static const char hex_rep[] = "0123456789abcdef";
   // FIXME: The real way to do this is to figure out the longest instruction
   //        and align to that size before printing. I'll fix this when I get
@@ -217,7 +222,7 @@ void llvm::DumpBytes(StringRef bytes) {
   }
 
   output[sizeof(output) - 1] = 0;
-  outs() << output;
+  OS << output;
 }
 
 bool llvm::RelocAddressLess(RelocationRef a, RelocationRef b) {
@@ -227,6 +232,152 @@ bool llvm::RelocAddressLess(RelocationRef a, RelocationRef b) {
   return a_addr < b_addr;
 }
 
+namespace {
+// Work item for one text section. The symbol and relocation lists are
+// gathered on the main thread (the accessors report through the shared
+// error() handler); decoding and formatting then run on a worker, which
+// writes into Text and Warnings, and the main thread emits the finished
+// chunks in section order.
+struct SectionDisasmJob {
+  SectionDisasmJob() : HadError(false) {}
+
+  SectionRef Section;
+  std::vector<std::pair<uint64_t, StringRef>> Symbols;
+  std::vector<RelocationRef> Rels;
+  StringRef SegmentName;
+  StringRef SectionName;
+  std::string Text;
+  std::string Warnings;
+  bool HadError;
+};
+}
+
+// Disassemble and format a single section into Job.Text. The immutable
+// target tables (register, asm, subtarget and instruction info) are shared
+// across workers; the context, disassembler and printer carry mutable state
+// and are created privately here.
+static void disassembleSectionJob(const ObjectFile *Obj,
+                                  const Target *TheTarget,
+                                  const MCAsmInfo &AsmInfo,
+                                  const MCRegisterInfo &MRI,
+                                  const MCSubtargetInfo &STI,
+                                  const MCInstrInfo &MII,
+                                  SectionDisasmJob &Job) {
+  raw_string_ostream OS(Job.Text);
+  raw_string_ostream WarnOS(Job.Warnings);
+
+  // Failures on this thread land in the per-section warning buffer so the
+  // merged output stays deterministic.
+  auto ReadError = [&](std::error_code EC) -> bool {
+    if (!EC)
+      return false;
+    WarnOS << ToolName << ": error reading file: " << EC.message() << ".\n";
+    Job.HadError = true;
+    return true;
+  };
+
+  std::unique_ptr<const MCObjectFileInfo> MOFI(new MCObjectFileInfo);
+  MCContext Ctx(&AsmInfo, &MRI, MOFI.get());
+  std::unique_ptr<MCDisassembler> DisAsm(
+      TheTarget->createMCDisassembler(STI, Ctx));
+  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+      AsmInfo.getAssemblerDialect(), AsmInfo, MII, MRI, STI));
+  // The caller already diagnosed a target that cannot create these.
+  if (!DisAsm || !IP)
+    return;
+
+  StringRef Fmt = Obj->getBytesInAddress() > 4 ? "\t\t%016" PRIx64 ":  " :
+                                                 "\t\t\t%08" PRIx64 ":  ";
+
+  uint64_t SectionAddr = Job.Section.getAddress();
+  uint64_t SectSize = Job.Section.getSize();
+
+  OS << "Disassembly of section ";
+  if (!Job.SegmentName.empty())
+    OS << Job.SegmentName << ",";
+  OS << Job.SectionName << ':';
+
+  StringRef BytesStr;
+  if (ReadError(Job.Section.getContents(BytesStr)))
+    return;
+  ArrayRef<uint8_t> Bytes(reinterpret_cast<const uint8_t *>(BytesStr.data()),
+                          BytesStr.size());
+
+  uint64_t Size;
+  uint64_t Index;
+
+  std::vector<RelocationRef>::const_iterator rel_cur = Job.Rels.begin();
+  std::vector<RelocationRef>::const_iterator rel_end = Job.Rels.end();
+  // Disassemble symbol by symbol.
+  for (unsigned si = 0, se = Job.Symbols.size(); si != se; ++si) {
+
+    uint64_t Start = Job.Symbols[si].first;
+    // The end is either the section end or the beginning of the next symbol.
+    uint64_t End = (si == se - 1) ? SectSize : Job.Symbols[si + 1].first;
+    // If this symbol has the same address as the next symbol, then skip it.
+    if (Start == End)
+      continue;
+
+    OS << '\n' << Job.Symbols[si].second << ":\n";
+
+#ifndef NDEBUG
+    raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+#else
+    raw_ostream &DebugOut = nulls();
+#endif
+
+    // Decode the whole run in one batch, then print.
+    std::vector<MCDisassembler::DecodedInst> Insts;
+    DisAsm->getInstructions(Insts, Bytes.slice(Start), End - Start,
+                            SectionAddr + Start, DebugOut);
+
+    Index = Start;
+    for (unsigned ii = 0, ie = Insts.size(); ii != ie;
+         Index += Size, ++ii) {
+      MCDisassembler::DecodedInst &DI = Insts[ii];
+      Size = DI.Size;
+
+      if (DI.Status) {
+        OS << format("%8" PRIx64 ":", SectionAddr + Index);
+        if (!NoShowRawInsn) {
+          OS << "\t";
+          DumpBytes(StringRef(
+              reinterpret_cast<const char *>(Bytes.data()) + Index, Size), OS);
+        }
+        IP->printInst(&DI.Inst, OS, "");
+        OS << DI.Comments;
+        OS << "\n";
+      } else {
+        WarnOS << ToolName << ": warning: invalid instruction encoding\n";
+      }
+
+      // Print relocation for instruction.
+      while (rel_cur != rel_end) {
+        bool hidden = false;
+        uint64_t addr;
+        SmallString<16> name;
+        SmallString<32> val;
+
+        // If this relocation is hidden, skip it.
+        if (ReadError(rel_cur->getHidden(hidden))) goto skip_print_rel;
+        if (hidden) goto skip_print_rel;
+
+        if (ReadError(rel_cur->getOffset(addr))) goto skip_print_rel;
+        // Stop when rel_cur's address is past the current instruction.
+        if (addr >= Index + Size) break;
+        if (ReadError(rel_cur->getTypeName(name))) goto skip_print_rel;
+        if (ReadError(rel_cur->getValueString(val))) goto skip_print_rel;
+
+        OS << format(Fmt.data(), SectionAddr + addr) << name
+           << "\t" << val << "\n";
+
+      skip_print_rel:
+        ++rel_cur;
+      }
+    }
+  }
+}
+
 static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   const Target *TheTarget = getTarget(Obj);
   // getTarget() will have already issued a diagnostic if necessary, so
@@ -271,32 +422,29 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     return;
   }
 
-  std::unique_ptr<const MCObjectFileInfo> MOFI(new MCObjectFileInfo);
-  MCContext Ctx(AsmInfo.get(), MRI.get(), MOFI.get());
-
-  std::unique_ptr<MCDisassembler> DisAsm(
-    TheTarget->createMCDisassembler(*STI, Ctx));
-
-  if (!DisAsm) {
-    errs() << "error: no disassembler for target " << TripleName << "\n";
-    return;
-  }
-
-  std::unique_ptr<const MCInstrAnalysis> MIA(
-      TheTarget->createMCInstrAnalysis(MII.get()));
+  // Validate up front that the target can disassemble and print at all, so
+  // a broken target is diagnosed exactly once. The per-section workers below
+  // create their own disassembler and printer; both carry mutable state and
+  // cannot be shared across threads.
+  {
+    std::unique_ptr<const MCObjectFileInfo> MOFI(new MCObjectFileInfo);
+    MCContext Ctx(AsmInfo.get(), MRI.get(), MOFI.get());
+    std::unique_ptr<MCDisassembler> DisAsm(
+      TheTarget->createMCDisassembler(*STI, Ctx));
+    if (!DisAsm) {
+      errs() << "error: no disassembler for target " << TripleName << "\n";
+      return;
+    }
 
-  int AsmPrinterVariant = AsmInfo->getAssemblerDialect();
-  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
-      AsmPrinterVariant, *AsmInfo, *MII, *MRI, *STI));
-  if (!IP) {
-    errs() << "error: no instruction printer for target " << TripleName
-      << '\n';
-    return;
+    std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+        AsmInfo->getAssemblerDialect(), *AsmInfo, *MII, *MRI, *STI));
+    if (!IP) {
+      errs() << "error: no instruction printer for target " << TripleName
+        << '\n';
+      return;
+    }
   }
 
-  StringRef Fmt = Obj->getBytesInAddress() > 4 ? "\t\t%016" PRIx64 ":  " :
-                                                 "\t\t\t%08" PRIx64 ":  ";
-
   // Create a mapping, RelocSecs = SectionRelocMap[S], where sections
   // in RelocSecs contain the relocations for section S.
   std::error_code EC;
@@ -307,6 +455,10 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
       SectionRelocMap[*Sec2].push_back(Section);
   }
 
+  // Gather each text section's symbol and relocation lists here, since the
+  // accessors report failures through the shared error() handler, then hand
+  // the decode and formatting work to the pool.
+  std::vector<std::unique_ptr<SectionDisasmJob>> Jobs;
   for (const SectionRef &Section : Obj->sections()) {
     if (!Section.isText() || Section.isVirtual())
       continue;
@@ -316,8 +468,10 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     if (!SectSize)
       continue;
 
+    std::unique_ptr<SectionDisasmJob> Job(new SectionDisasmJob);
+    Job->Section = Section;
+
     // Make a list of all the symbols in this section.
-    std::vector<std::pair<uint64_t, StringRef>> Symbols;
     for (const SymbolRef &Symbol : Obj->symbols()) {
       if (Section.containsSymbol(Symbol)) {
         uint64_t Address;
@@ -332,124 +486,61 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
         StringRef Name;
         if (error(Symbol.getName(Name)))
           break;
-        Symbols.push_back(std::make_pair(Address, Name));
+        Job->Symbols.push_back(std::make_pair(Address, Name));
       }
     }
 
     // Sort the symbols by address, just in case they didn't come in that way.
-    array_pod_sort(Symbols.begin(), Symbols.end());
+    array_pod_sort(Job->Symbols.begin(), Job->Symbols.end());
 
     // Make a list of all the relocations for this section.
-    std::vector<RelocationRef> Rels;
     if (InlineRelocs) {
       for (const SectionRef &RelocSec : SectionRelocMap[Section]) {
         for (const RelocationRef &Reloc : RelocSec.relocations()) {
-          Rels.push_back(Reloc);
+          Job->Rels.push_back(Reloc);
         }
       }
     }
 
     // Sort relocations by address.
-    std::sort(Rels.begin(), Rels.end(), RelocAddressLess);
+    std::sort(Job->Rels.begin(), Job->Rels.end(), RelocAddressLess);
 
-    StringRef SegmentName = "";
     if (const MachOObjectFile *MachO = dyn_cast<const MachOObjectFile>(Obj)) {
       DataRefImpl DR = Section.getRawDataRefImpl();
-      SegmentName = MachO->getSectionFinalSegmentName(DR);
+      Job->SegmentName = MachO->getSectionFinalSegmentName(DR);
     }
-    StringRef name;
-    if (error(Section.getName(name)))
+    if (error(Section.getName(Job->SectionName)))
       break;
-    outs() << "Disassembly of section ";
-    if (!SegmentName.empty())
-      outs() << SegmentName << ",";
-    outs() << name << ':';
 
     // If the section has no symbols just insert a dummy one and disassemble
     // the whole section.
-    if (Symbols.empty())
-      Symbols.push_back(std::make_pair(0, name));
-
-
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
-    StringRef BytesStr;
-    if (error(Section.getContents(BytesStr)))
-      break;
-    ArrayRef<uint8_t> Bytes(reinterpret_cast<const uint8_t *>(BytesStr.data()),
-                            BytesStr.size());
+    if (Job->Symbols.empty())
+      Job->Symbols.push_back(std::make_pair(0, Job->SectionName));
 
-    uint64_t Size;
-    uint64_t Index;
-
-    std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
-    // Disassemble symbol by symbol.
-    for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
-
-      uint64_t Start = Symbols[si].first;
-      // The end is either the section end or the beginning of the next symbol.
-      uint64_t End = (si == se - 1) ? SectSize : Symbols[si + 1].first;
-      // If this symbol has the same address as the next symbol, then skip it.
-      if (Start == End)
-        continue;
-
-      outs() << '\n' << Symbols[si].second << ":\n";
-
-#ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
-#else
-      raw_ostream &DebugOut = nulls();
-#endif
-
-      for (Index = Start; Index < End; Index += Size) {
-        MCInst Inst;
-
-        if (DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
-                                   SectionAddr + Index, DebugOut,
-                                   CommentStream)) {
-          outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-          if (!NoShowRawInsn) {
-            outs() << "\t";
-            DumpBytes(StringRef(
-                reinterpret_cast<const char *>(Bytes.data()) + Index, Size));
-          }
-          IP->printInst(&Inst, outs(), "");
-          outs() << CommentStream.str();
-          Comments.clear();
-          outs() << "\n";
-        } else {
-          errs() << ToolName << ": warning: invalid instruction encoding\n";
-          if (Size == 0)
-            Size = 1; // skip illegible bytes
-        }
-
-        // Print relocation for instruction.
-        while (rel_cur != rel_end) {
-          bool hidden = false;
-          uint64_t addr;
-          SmallString<16> name;
-          SmallString<32> val;
-
-          // If this relocation is hidden, skip it.
-          if (error(rel_cur->getHidden(hidden))) goto skip_print_rel;
-          if (hidden) goto skip_print_rel;
-
-          if (error(rel_cur->getOffset(addr))) goto skip_print_rel;
-          // Stop when rel_cur's address is past the current instruction.
-          if (addr >= Index + Size) break;
-          if (error(rel_cur->getTypeName(name))) goto skip_print_rel;
-          if (error(rel_cur->getValueString(val))) goto skip_print_rel;
-
-          outs() << format(Fmt.data(), SectionAddr + addr) << name
-                 << "\t" << val << "\n";
+    Jobs.push_back(std::move(Job));
+  }
 
-        skip_print_rel:
-          ++rel_cur;
-        }
-      }
+  // Decode and format the sections in parallel.
+  {
+    ThreadPool Pool;
+    for (std::unique_ptr<SectionDisasmJob> &J : Jobs) {
+      SectionDisasmJob *Job = J.get();
+      Pool.async([Obj, TheTarget, &AsmInfo, &MRI, &STI, &MII, Job] {
+        disassembleSectionJob(Obj, TheTarget, *AsmInfo, *MRI, *STI, *MII,
+                              *Job);
+      });
     }
+    Pool.wait();
+  }
+
+  // Emit the finished chunks in section order so the output is identical to
+  // a serial run.
+  for (std::unique_ptr<SectionDisasmJob> &J : Jobs) {
+    outs() << J->Text;
+    if (!J->Warnings.empty())
+      errs() << J->Warnings;
+    if (J->HadError)
+      ReturnValue = EXIT_FAILURE;
   }
 }
 
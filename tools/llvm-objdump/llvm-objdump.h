@@ -15,6 +15,7 @@
 #include "llvm/Support/DataTypes.h"
 
 namespace llvm {
+class raw_ostream;
 namespace object {
   class COFFObjectFile;
   class MachOObjectFile;
@@ -50,6 +51,7 @@ extern cl::opt<bool> UnwindInfo;
 bool error(std::error_code ec);
 bool RelocAddressLess(object::RelocationRef a, object::RelocationRef b);
 void DumpBytes(StringRef bytes);
+void DumpBytes(StringRef bytes, raw_ostream &OS);
 void ParseInputMachO(StringRef Filename);
 void printCOFFUnwindInfo(const object::COFFObjectFile* o);
 void printMachOUnwindInfo(const object::MachOObjectFile* o);
@@ -25,6 +25,7 @@
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
+#include <thread>
 
 using namespace llvm;
 
@@ -38,8 +39,43 @@ static void exitWithError(const Twine &Message, StringRef Whence = "") {
 
 enum ProfileKinds { instr, sample };
 
+namespace {
+/// State for one shard of a parallel merge. Fatal errors and per-function
+/// diagnostics are deferred until the shard has been joined, so worker
+/// threads never touch errs() or call exit().
+struct WriterContext {
+  InstrProfWriter Writer;
+  std::error_code FatalError;
+  std::string FatalWhence;
+  std::string Warnings;
+};
+}
+
+static void mergeInputFiles(ArrayRef<std::string> Inputs, WriterContext &WC) {
+  raw_string_ostream Warnings(WC.Warnings);
+  for (const auto &Filename : Inputs) {
+    auto ReaderOrErr = InstrProfReader::create(Filename);
+    if (std::error_code EC = ReaderOrErr.getError()) {
+      WC.FatalError = EC;
+      WC.FatalWhence = Filename;
+      return;
+    }
+
+    auto Reader = std::move(ReaderOrErr.get());
+    for (const auto &I : *Reader)
+      if (std::error_code EC =
+              WC.Writer.addFunctionCounts(I.Name, I.Hash, I.Counts))
+        Warnings << Filename << ": " << I.Name << ": " << EC.message() << "\n";
+    if (Reader->hasError()) {
+      WC.FatalError = Reader->getError();
+      WC.FatalWhence = Filename;
+      return;
+    }
+  }
+}
+
 void mergeInstrProfile(const cl::list<std::string> &Inputs,
-                       StringRef OutputFilename) {
+                       StringRef OutputFilename, unsigned NumThreads) {
   if (OutputFilename.compare("-") == 0)
     exitWithError("Cannot write indexed profdata format to stdout.");
 
@@ -48,21 +84,45 @@ void mergeInstrProfile(const cl::list<std::string> &Inputs,
   if (EC)
     exitWithError(EC.message(), OutputFilename);
 
-  InstrProfWriter Writer;
-  for (const auto &Filename : Inputs) {
-    auto ReaderOrErr = InstrProfReader::create(Filename);
-    if (std::error_code ec = ReaderOrErr.getError())
-      exitWithError(ec.message(), Filename);
+  std::vector<std::string> InputFiles(Inputs.begin(), Inputs.end());
+
+  // Size the merge to the smaller of the requested (or detected) thread count
+  // and the number of inputs; hardware_concurrency may return 0.
+  if (NumThreads == 0)
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+  NumThreads = std::min(NumThreads, unsigned(InputFiles.size()));
+
+  std::vector<WriterContext> Contexts(NumThreads);
+  if (NumThreads == 1) {
+    mergeInputFiles(InputFiles, Contexts[0]);
+  } else {
+    // Merge the inputs in contiguous shards, one shard per thread.
+    std::vector<std::thread> Threads;
+    for (unsigned I = 0; I != NumThreads; ++I) {
+      size_t Begin = InputFiles.size() * I / NumThreads;
+      size_t End = InputFiles.size() * (I + 1) / NumThreads;
+      Threads.emplace_back(mergeInputFiles,
+                           makeArrayRef(InputFiles).slice(Begin, End - Begin),
+                           std::ref(Contexts[I]));
+    }
+    for (std::thread &T : Threads)
+      T.join();
+  }
 
-    auto Reader = std::move(ReaderOrErr.get());
-    for (const auto &I : *Reader)
-      if (std::error_code EC =
-              Writer.addFunctionCounts(I.Name, I.Hash, I.Counts))
-        errs() << Filename << ": " << I.Name << ": " << EC.message() << "\n";
-    if (Reader->hasError())
-      exitWithError(Reader->getError().message(), Filename);
+  // Combine the shards into the first writer and report any diagnostics the
+  // worker threads deferred.
+  for (unsigned I = 0; I != NumThreads; ++I) {
+    WriterContext &WC = Contexts[I];
+    errs() << WC.Warnings;
+    if (WC.FatalError)
+      exitWithError(WC.FatalError.message(), WC.FatalWhence);
+    if (I != 0)
+      Contexts[0].Writer.mergeRecordsFromWriter(
+          std::move(WC.Writer), [](StringRef Name, std::error_code EC) {
+            errs() << Name << ": " << EC.message() << "\n";
+          });
   }
-  Writer.write(Output);
+  Contexts[0].Writer.write(Output);
 }
 
 void mergeSampleProfile(const cl::list<std::string> &Inputs,
@@ -106,6 +166,11 @@ int merge_main(int argc, const char *argv[]) {
                                       cl::desc("Output file"));
   cl::alias OutputFilenameA("o", cl::desc("Alias for --output"),
                             cl::aliasopt(OutputFilename));
+  cl::opt<unsigned> NumThreads(
+      "num-threads", cl::init(0),
+      cl::desc("Number of merge threads to use (default: autodetect)"));
+  cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                        cl::aliasopt(NumThreads));
   cl::opt<ProfileKinds> ProfileKind(
       cl::desc("Profile kind:"), cl::init(instr),
       cl::values(clEnumVal(instr, "Instrumentation profile (default)"),
@@ -116,6 +181,8 @@ int merge_main(int argc, const char *argv[]) {
       cl::init(sampleprof::SPF_Binary),
       cl::values(clEnumValN(sampleprof::SPF_Binary, "binary",
                             "Binary encoding (default)"),
+                 clEnumValN(sampleprof::SPF_Indexed, "indexed",
+                            "Indexed binary encoding"),
                  clEnumValN(sampleprof::SPF_Text, "text", "Text encoding"),
                  clEnumValN(sampleprof::SPF_GCC, "gcc", "GCC encoding"),
                  clEnumValEnd));
@@ -123,7 +190,7 @@ int merge_main(int argc, const char *argv[]) {
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
   if (ProfileKind == instr)
-    mergeInstrProfile(Inputs, OutputFilename);
+    mergeInstrProfile(Inputs, OutputFilename, NumThreads);
   else
     mergeSampleProfile(Inputs, OutputFilename, OutputFormat);
 
@@ -0,0 +1,245 @@
+//===-- llvm-schedcal.cpp - Scheduling model calibration driver -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility measures the latency or throughput of a kernel of host
+// instructions with the hardware cycle counter, for calibrating the
+// hand-written per-target scheduling models.
+//
+// The input is an assembly snippet for one instruction class. The snippet is
+// repeated to form an unrolled kernel, assembled with MC for the host,
+// copied into executable memory and run under a perf cycle counter. Writing
+// the snippet as a serial dependence chain (each instruction consuming the
+// previous result) measures latency; writing it with independent operands
+// measures throughput. The result is printed as a TableGen overlay record
+// when -sched-write is given, suitable for pasting into a target's
+// scheduling definitions.
+//
+// The snippet runs in this process's own frame: it must preserve the stack
+// pointer and all callee-saved registers, and must not branch outside
+// itself.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCCodeEmitter.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetAsmParser.h"
+#include "llvm/MC/MCTargetOptionsCommandFlags.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Memory.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PerfEvent.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstring>
+using namespace llvm;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<snippet file>"), cl::init("-"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Output filename"), cl::value_desc("filename"),
+               cl::init("-"));
+
+static cl::opt<std::string>
+MCPU("mcpu", cl::desc("Target a specific cpu type (-mcpu=help for details)"),
+     cl::value_desc("cpu-name"), cl::init(""));
+
+static cl::opt<unsigned>
+UnrollCount("unroll", cl::desc("Number of snippet repetitions per kernel"),
+            cl::init(1000));
+
+static cl::opt<unsigned>
+NumRuns("runs", cl::desc("Number of kernel executions; the minimum counts"),
+        cl::init(10));
+
+static cl::opt<std::string>
+SchedWriteName("sched-write",
+               cl::desc("SchedWrite to emit a WriteRes overlay record for"),
+               cl::value_desc("name"), cl::init(""));
+
+static cl::opt<std::string>
+ReturnInst("return-inst", cl::desc("Instruction appended to return from the "
+                                   "kernel"),
+           cl::init("ret"));
+
+static const char *ToolName;
+
+static int error(const Twine &Message) {
+  errs() << ToolName << ": error: " << Message << "\n";
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;
+
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmParser();
+
+  cl::ParseCommandLineOptions(argc, argv,
+                              "scheduling model calibration driver\n");
+  ToolName = argv[0];
+  MCTargetOptions MCOptions = InitMCTargetOptionsFromFlags();
+
+  // Kernels execute in this process, so the target is always the host.
+  std::string TripleName = Triple::normalize(sys::getProcessTriple());
+  std::string Error;
+  const Target *TheTarget = TargetRegistry::lookupTarget(TripleName, Error);
+  if (!TheTarget)
+    return error(Error);
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
+      MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (std::error_code EC = BufferPtr.getError())
+    return error(InputFilename + ": " + EC.message());
+
+  // Build the kernel: the snippet repeated UnrollCount times, followed by a
+  // return.
+  std::string Kernel;
+  Kernel.reserve((*BufferPtr)->getBufferSize() * UnrollCount + 16);
+  for (unsigned I = 0; I != UnrollCount; ++I) {
+    Kernel += (*BufferPtr)->getBuffer();
+    Kernel += '\n';
+  }
+  Kernel += ReturnInst;
+  Kernel += '\n';
+
+  SourceMgr SrcMgr;
+  SrcMgr.AddNewSourceBuffer(MemoryBuffer::getMemBufferCopy(Kernel, "<kernel>"),
+                            SMLoc());
+
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
+  assert(MRI && "Unable to create target register info!");
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
+  assert(MAI && "Unable to create target asm info!");
+
+  MCObjectFileInfo MOFI;
+  MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
+  MOFI.InitMCObjectFileInfo(TripleName, Reloc::Default, CodeModel::Default,
+                            Ctx);
+
+  std::string CPU = MCPU.empty() ? sys::getHostCPUName().str() : MCPU;
+  std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      TheTarget->createMCSubtargetInfo(TripleName, CPU, ""));
+
+  // Assemble the kernel to an in-memory object.
+  SmallString<0> ObjectBytes;
+  raw_svector_ostream OS(ObjectBytes);
+  MCCodeEmitter *CE = TheTarget->createMCCodeEmitter(*MCII, *MRI, *STI, Ctx);
+  MCAsmBackend *MAB = TheTarget->createMCAsmBackend(*MRI, TripleName, CPU);
+  std::unique_ptr<MCStreamer> Str(TheTarget->createMCObjectStreamer(
+      TripleName, Ctx, *MAB, OS, CE, *STI, /*RelaxAll=*/false));
+
+  std::unique_ptr<MCAsmParser> Parser(
+      createMCAsmParser(SrcMgr, Ctx, *Str, *MAI));
+  std::unique_ptr<MCTargetAsmParser> TAP(
+      TheTarget->createMCAsmParser(*STI, *Parser, *MCII, MCOptions));
+  if (!TAP)
+    return error("this target does not support assembly parsing");
+  Parser->setTargetParser(*TAP);
+  if (Parser->Run(/*NoInitialTextSection=*/false))
+    return 1;
+  OS.flush();
+
+  // Pull the kernel's bytes back out of the object's text section.
+  ErrorOr<std::unique_ptr<object::ObjectFile>> ObjOrErr =
+      object::ObjectFile::createObjectFile(
+          MemoryBufferRef(StringRef(ObjectBytes), "<kernel>"));
+  if (std::error_code EC = ObjOrErr.getError())
+    return error("reading assembled kernel: " + EC.message());
+
+  StringRef Code;
+  for (const object::SectionRef &Section : (*ObjOrErr)->sections()) {
+    if (!Section.isText())
+      continue;
+    if (Section.relocation_begin() != Section.relocation_end())
+      return error("kernel requires relocations; snippets must not reference "
+                   "external symbols");
+    if (std::error_code EC = Section.getContents(Code))
+      return error(EC.message());
+    break;
+  }
+  if (Code.empty())
+    return error("assembled kernel is empty");
+
+  // Copy it into executable memory.
+  std::error_code EC;
+  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(
+      Code.size(), nullptr, sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+  if (EC)
+    return error("allocating kernel memory: " + EC.message());
+  memcpy(MB.base(), Code.data(), Code.size());
+  if ((EC = sys::Memory::protectMappedMemory(
+           MB, sys::Memory::MF_READ | sys::Memory::MF_EXEC)))
+    return error("marking kernel executable: " + EC.message());
+  sys::Memory::InvalidateInstructionCache(MB.base(), Code.size());
+
+  sys::PerfEvent Cycles;
+  if ((EC = Cycles.open(sys::PerfEvent::CPUCycles)))
+    return error("opening cycle counter: " + EC.message() +
+                 " (is perf_event_paranoid too restrictive?)");
+
+  typedef void (*KernelFn)();
+  KernelFn Fn = (KernelFn)(intptr_t)MB.base();
+
+  // Warm up caches and branch predictors, then take the minimum over several
+  // runs to shed interrupts and migrations.
+  Fn();
+  uint64_t MinCycles = UINT64_MAX;
+  for (unsigned Run = 0; Run != NumRuns; ++Run) {
+    uint64_t Count;
+    if ((EC = Cycles.start()))
+      return error("starting cycle counter: " + EC.message());
+    Fn();
+    if ((EC = Cycles.stop(Count)))
+      return error("reading cycle counter: " + EC.message());
+    MinCycles = std::min(MinCycles, Count);
+  }
+  sys::Memory::releaseMappedMemory(MB);
+
+  double CyclesPerIteration = (double)MinCycles / UnrollCount;
+  // Latencies are integral in the scheduling model; round to nearest.
+  unsigned Latency = (unsigned)(CyclesPerIteration + 0.5);
+
+  std::unique_ptr<tool_output_file> Out(
+      new tool_output_file(OutputFilename, EC, sys::fs::F_Text));
+  if (EC)
+    return error(EC.message());
+
+  Out->os() << "// " << InputFilename << ": "
+            << format("%.2f", CyclesPerIteration) << " cycles per iteration ("
+            << UnrollCount << " repetitions, best of " << NumRuns
+            << " runs) on " << CPU << "\n";
+  if (!SchedWriteName.empty())
+    Out->os() << "def : WriteRes<" << SchedWriteName << ", []> { let Latency = "
+              << Latency << "; }\n";
+  Out->keep();
+  return 0;
+}
@@ -240,6 +240,11 @@ void LLVMSymbolizer::flush() {
   DeleteContainerSeconds(Modules);
   ObjectPairForPathArch.clear();
   ObjectFileForArch.clear();
+  // Release the binaries after everything that points into them is gone.
+  // Destroy them before the buffers they were parsed from.
+  ParsedBinariesAndObjects.clear();
+  MemoryBuffers.clear();
+  CacheSize = 0;
 }
 
 // For Path="/path/to/foo" and Basename="foo" assume that debug info is in
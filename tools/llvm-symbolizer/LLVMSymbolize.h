@@ -50,7 +50,8 @@ public:
           Demangle(Demangle), DefaultArch(DefaultArch) {}
   };
 
-  LLVMSymbolizer(const Options &Opts = Options()) : Opts(Opts) {}
+  LLVMSymbolizer(const Options &Opts = Options())
+      : Opts(Opts), CacheSize(0) {}
   ~LLVMSymbolizer() {
     flush();
   }
@@ -61,7 +62,13 @@ public:
   symbolizeCode(const std::string &ModuleName, uint64_t ModuleOffset);
   std::string
   symbolizeData(const std::string &ModuleName, uint64_t ModuleOffset);
+  /// Drop all cached binaries, object files and module info. Long-lived
+  /// processes can call this to bound their memory use.
   void flush();
+  /// Approximate memory footprint of the cached binaries. This only counts
+  /// the file buffers, not the debug info parsed from them, so it is a lower
+  /// bound.
+  size_t getCacheSize() const { return CacheSize; }
   static std::string DemangleName(const std::string &Name);
 private:
   typedef std::pair<ObjectFile*, ObjectFile*> ObjectPair;
@@ -86,6 +93,8 @@ private:
     std::unique_ptr<Binary> Bin;
     std::unique_ptr<MemoryBuffer> MemBuf;
     std::tie(Bin, MemBuf) = OwningBin.takeBinary();
+    if (MemBuf)
+      CacheSize += MemBuf->getBufferSize();
     ParsedBinariesAndObjects.push_back(std::move(Bin));
     MemoryBuffers.push_back(std::move(MemBuf));
   }
@@ -98,6 +107,7 @@ private:
       ObjectPairForPathArch;
 
   Options Opts;
+  size_t CacheSize;
   static const char kBadString[];
 };
 
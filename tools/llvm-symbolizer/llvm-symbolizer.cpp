@@ -67,18 +67,32 @@ ClDsymHint("dsym-hint", cl::ZeroOrMore,
            cl::desc("Path to .dSYM bundles to search for debug info for the "
                     "object files"));
 
-static bool parseCommand(bool &IsData, std::string &ModuleName,
+static cl::opt<unsigned long long> ClMaxCacheSize(
+    "max-cache-size", cl::init(0),
+    cl::desc("Flush cached binaries once their total size exceeds this "
+             "many bytes (default: unlimited)"));
+
+static bool parseCommand(bool &IsData, bool &IsFlush, std::string &ModuleName,
                          uint64_t &ModuleOffset) {
   const char *kDataCmd = "DATA ";
   const char *kCodeCmd = "CODE ";
+  const char *kFlushCmd = "FLUSH";
   const int kMaxInputStringLength = 1024;
   const char kDelimiters[] = " \n";
   char InputString[kMaxInputStringLength];
   if (!fgets(InputString, sizeof(InputString), stdin))
     return false;
   IsData = false;
+  IsFlush = false;
   ModuleName = "";
   char *pos = InputString;
+  // A lone FLUSH drops all cached state. This lets a long-lived client (e.g.
+  // a crash-ingest service feeding batches of addresses, ideally sorted by
+  // module) bound the symbolizer's memory without restarting the process.
+  if (strncmp(pos, kFlushCmd, strlen(kFlushCmd)) == 0) {
+    IsFlush = true;
+    return true;
+  }
   if (strncmp(pos, kDataCmd, strlen(kDataCmd)) == 0) {
     IsData = true;
     pos += strlen(kDataCmd);
@@ -136,14 +150,21 @@ int main(int argc, char **argv) {
   LLVMSymbolizer Symbolizer(Opts);
 
   bool IsData = false;
+  bool IsFlush = false;
   std::string ModuleName;
   uint64_t ModuleOffset;
-  while (parseCommand(IsData, ModuleName, ModuleOffset)) {
+  while (parseCommand(IsData, IsFlush, ModuleName, ModuleOffset)) {
+    if (IsFlush) {
+      Symbolizer.flush();
+      continue;
+    }
     std::string Result =
         IsData ? Symbolizer.symbolizeData(ModuleName, ModuleOffset)
                : Symbolizer.symbolizeCode(ModuleName, ModuleOffset);
     outs() << Result << "\n";
     outs().flush();
+    if (ClMaxCacheSize && Symbolizer.getCacheSize() > ClMaxCacheSize)
+      Symbolizer.flush();
   }
   return 0;
 }
@@ -23,7 +23,9 @@
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/CommandFlags.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LLVMContext.h"
@@ -178,7 +180,19 @@ DefaultDataLayout("default-data-layout",
           cl::desc("data layout string to use if not specified by module"),
           cl::value_desc("layout-string"), cl::init(""));
 
+static cl::opt<std::string>
+SnapshotAfter("snapshot-after",
+              cl::desc("Write a bitcode snapshot of the module after each "
+                       "occurrence of the named pass in the pass list; the "
+                       "snapshot can be fed back with -resume-from"),
+              cl::value_desc("pass-name"));
 
+static cl::opt<std::string>
+ResumeFrom("resume-from",
+           cl::desc("Read the module from a snapshot written by "
+                    "-snapshot-after and skip the passes that already ran "
+                    "when it was taken"),
+           cl::value_desc("filename"));
 
 static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
   // Add the pass to the pass manager...
@@ -196,7 +210,7 @@ static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
 ///
 /// OptLevel - Optimization Level
 static void AddOptimizationPasses(legacy::PassManagerBase &MPM,
-                                  legacy::FunctionPassManager &FPM,
+                                  legacy::FunctionPassManager &FPM, Module &M,
                                   unsigned OptLevel, unsigned SizeLevel) {
   FPM.add(createVerifierPass());          // Verify that input is correct
   MPM.add(createDebugInfoVerifierPass()); // Verify that debug info is correct
@@ -227,6 +241,10 @@ static void AddOptimizationPasses(legacy::PassManagerBase &MPM,
   Builder.SLPVectorize =
       DisableSLPVectorization ? false : OptLevel > 1 && SizeLevel < 2;
 
+  // Let a -pipeline-tuning-file override the knobs for this module's
+  // category.
+  Builder.applyPipelineTuning(M);
+
   Builder.populateFunctionPassManager(FPM);
   Builder.populateModulePassManager(MPM);
 }
@@ -283,6 +301,71 @@ static TargetMachine* GetTargetMachine(Triple TheTriple) {
                                         GetCodeGenOptLevel());
 }
 
+//===----------------------------------------------------------------------===//
+// Pipeline snapshot support.
+//
+
+/// The module flag used to record which pipeline position a snapshot was
+/// taken at.  It is only present inside snapshot files.
+static const char *SnapshotPositionKey = "opt.snapshot.position";
+
+/// Remove the snapshot position flag from \p M, if present.  Module flags
+/// cannot be deleted individually, so the flag list is rebuilt without it.
+static void removeSnapshotPositionFlag(Module &M) {
+  NamedMDNode *ModFlags = M.getModuleFlagsMetadata();
+  if (!ModFlags)
+    return;
+  SmallVector<MDNode *, 8> Keep;
+  for (unsigned I = 0, E = ModFlags->getNumOperands(); I != E; ++I) {
+    MDNode *Flag = ModFlags->getOperand(I);
+    MDString *Key = dyn_cast_or_null<MDString>(Flag->getOperand(1));
+    if (Key && Key->getString() == SnapshotPositionKey)
+      continue;
+    Keep.push_back(Flag);
+  }
+  if (Keep.size() == ModFlags->getNumOperands())
+    return;
+  M.eraseNamedMetadata(ModFlags);
+  for (MDNode *Flag : Keep)
+    M.getOrInsertModuleFlagsMetadata()->addOperand(Flag);
+}
+
+namespace {
+/// Writes the module to a bitcode file when reached in the pipeline,
+/// stamping the pipeline position into a module flag first so that a later
+/// opt invocation can resume after the pass that preceded this writer.
+class BitcodeSnapshotWriter : public ModulePass {
+  std::unique_ptr<tool_output_file> Out;
+  unsigned Position;
+
+public:
+  static char ID;
+  BitcodeSnapshotWriter(std::unique_ptr<tool_output_file> Out,
+                        unsigned Position)
+      : ModulePass(ID), Out(std::move(Out)), Position(Position) {}
+
+  const char *getPassName() const override {
+    return "Bitcode Snapshot Writer";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+  }
+
+  bool runOnModule(Module &M) override {
+    // The stamp belongs in the snapshot only; take it out of the live module
+    // again so it cannot leak into the final output.
+    M.addModuleFlag(Module::Error, SnapshotPositionKey, Position);
+    WriteBitcodeToFile(&M, Out->os());
+    Out->keep();
+    removeSnapshotPositionFlag(M);
+    return false;
+  }
+};
+}
+
+char BitcodeSnapshotWriter::ID = 0;
+
 #ifdef LINK_POLLY_INTO_TOOLS
 namespace polly {
 void initializePollyPasses(llvm::PassRegistry &Registry);
@@ -341,14 +424,37 @@ int main(int argc, char **argv) {
 
   SMDiagnostic Err;
 
+  // When resuming, the snapshot replaces the input module.
+  if (!ResumeFrom.empty() && InputFilename != "-")
+    errs() << argv[0] << ": warning: input file '" << InputFilename
+           << "' is ignored when -resume-from is given.\n";
+
   // Load the input module...
-  std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
+  std::unique_ptr<Module> M = parseIRFile(
+      ResumeFrom.empty() ? InputFilename : ResumeFrom, Err, Context);
 
   if (!M) {
     Err.print(argv[0], errs());
     return 1;
   }
 
+  // A snapshot records the pipeline position it was taken at; read it back so
+  // the pass list loop below knows how much of the pipeline to skip.
+  bool Resuming = false;
+  unsigned ResumePosition = 0;
+  if (!ResumeFrom.empty()) {
+    auto *Position = mdconst::dyn_extract_or_null<ConstantInt>(
+        M->getModuleFlag(SnapshotPositionKey));
+    if (!Position) {
+      errs() << argv[0] << ": '" << ResumeFrom
+             << "' is not a snapshot written by -snapshot-after.\n";
+      return 1;
+    }
+    Resuming = true;
+    ResumePosition = Position->getZExtValue();
+    removeSnapshotPositionFlag(*M);
+  }
+
   // If we are supposed to override the target triple, do so now.
   if (!TargetTriple.empty())
     M->setTargetTriple(Triple::normalize(TargetTriple));
@@ -465,37 +571,52 @@ int main(int argc, char **argv) {
 
   // Create a new optimization pass for each one specified on the command line
   for (unsigned i = 0; i < PassList.size(); ++i) {
+    // A pass bundle positioned before a skipped pass already ran before the
+    // snapshot was taken; consume its flag without adding anything.
+    bool Skip = Resuming && i <= ResumePosition;
+
     if (StandardLinkOpts &&
         StandardLinkOpts.getPosition() < PassList.getPosition(i)) {
-      AddStandardLinkPasses(Passes);
+      if (!Skip)
+        AddStandardLinkPasses(Passes);
       StandardLinkOpts = false;
     }
 
     if (OptLevelO1 && OptLevelO1.getPosition() < PassList.getPosition(i)) {
-      AddOptimizationPasses(Passes, *FPasses, 1, 0);
+      if (!Skip)
+        AddOptimizationPasses(Passes, *FPasses, *M, 1, 0);
       OptLevelO1 = false;
     }
 
     if (OptLevelO2 && OptLevelO2.getPosition() < PassList.getPosition(i)) {
-      AddOptimizationPasses(Passes, *FPasses, 2, 0);
+      if (!Skip)
+        AddOptimizationPasses(Passes, *FPasses, *M, 2, 0);
       OptLevelO2 = false;
     }
 
     if (OptLevelOs && OptLevelOs.getPosition() < PassList.getPosition(i)) {
-      AddOptimizationPasses(Passes, *FPasses, 2, 1);
+      if (!Skip)
+        AddOptimizationPasses(Passes, *FPasses, *M, 2, 1);
       OptLevelOs = false;
     }
 
     if (OptLevelOz && OptLevelOz.getPosition() < PassList.getPosition(i)) {
-      AddOptimizationPasses(Passes, *FPasses, 2, 2);
+      if (!Skip)
+        AddOptimizationPasses(Passes, *FPasses, *M, 2, 2);
       OptLevelOz = false;
     }
 
     if (OptLevelO3 && OptLevelO3.getPosition() < PassList.getPosition(i)) {
-      AddOptimizationPasses(Passes, *FPasses, 3, 0);
+      if (!Skip)
+        AddOptimizationPasses(Passes, *FPasses, *M, 3, 0);
       OptLevelO3 = false;
     }
 
+    // This pass (and everything before it) ran before the snapshot was
+    // taken; the resumed module already reflects it.
+    if (Skip)
+      continue;
+
     const PassInfo *PassInf = PassList[i];
     Pass *P = nullptr;
     if (PassInf->getTargetMachineCtor())
@@ -533,6 +654,26 @@ int main(int argc, char **argv) {
       }
     }
 
+    // Snapshot the module after the requested pass so a later invocation can
+    // resume from this point in the pipeline.
+    if (!SnapshotAfter.empty() && SnapshotAfter == PassInf->getPassArgument()) {
+      // Later occurrences of a repeated pass get the pipeline position worked
+      // into the name so they don't overwrite the first snapshot.
+      std::string SnapshotName = SnapshotAfter + ".snapshot.bc";
+      if (std::count(PassList.begin(), PassList.begin() + i, PassInf))
+        SnapshotName =
+            (Twine(SnapshotAfter) + "." + Twine(i) + ".snapshot.bc").str();
+      std::error_code EC;
+      auto SnapshotOut =
+          llvm::make_unique<tool_output_file>(SnapshotName, EC, sys::fs::F_None);
+      if (EC) {
+        errs() << argv[0] << ": cannot open snapshot file '" << SnapshotName
+               << "': " << EC.message() << '\n';
+        return 1;
+      }
+      Passes.add(new BitcodeSnapshotWriter(std::move(SnapshotOut), i));
+    }
+
     if (PrintEachXForm)
       Passes.add(createPrintModulePass(errs()));
   }
@@ -543,19 +684,19 @@ int main(int argc, char **argv) {
   }
 
   if (OptLevelO1)
-    AddOptimizationPasses(Passes, *FPasses, 1, 0);
+    AddOptimizationPasses(Passes, *FPasses, *M, 1, 0);
 
   if (OptLevelO2)
-    AddOptimizationPasses(Passes, *FPasses, 2, 0);
+    AddOptimizationPasses(Passes, *FPasses, *M, 2, 0);
 
   if (OptLevelOs)
-    AddOptimizationPasses(Passes, *FPasses, 2, 1);
+    AddOptimizationPasses(Passes, *FPasses, *M, 2, 1);
 
   if (OptLevelOz)
-    AddOptimizationPasses(Passes, *FPasses, 2, 2);
+    AddOptimizationPasses(Passes, *FPasses, *M, 2, 2);
 
   if (OptLevelO3)
-    AddOptimizationPasses(Passes, *FPasses, 3, 0);
+    AddOptimizationPasses(Passes, *FPasses, *M, 3, 0);
 
   if (OptLevelO1 || OptLevelO2 || OptLevelOs || OptLevelOz || OptLevelO3) {
     FPasses->doInitialization();
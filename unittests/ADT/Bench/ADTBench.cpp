@@ -0,0 +1,252 @@
+//===- ADTBench.cpp - Microbenchmarks for core ADT containers -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Microbenchmarks for the containers the pass pipelines lean on hardest:
+// DenseMap, SmallPtrSet, StringMap, SmallVector and FoldingSet. The workloads
+// mirror how passes actually use them (pointer-keyed visited sets, string
+// interning, worklists, node uniquing) rather than uniform-random churn, so a
+// container change can be judged with numbers from the 'bench' build target.
+//
+// This is deliberately a self-contained harness: each benchmark processes a
+// fixed workload per call and reports nanoseconds per operation, with the
+// call count scaled until the measurement is long enough to be stable. Pass a
+// substring as argv[1] to run a subset.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+/// Keep the optimizer from discarding a computed value.
+template <typename T> void doNotOptimize(const T &Value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "g"(&Value) : "memory");
+#else
+  volatile const char *Sink = reinterpret_cast<volatile const char *>(&Value);
+  (void)Sink;
+#endif
+}
+
+/// Cheap deterministic index sequence; benchmarks must not depend on rand().
+unsigned nextIndex(unsigned &State, unsigned Limit) {
+  State = State * 1664525u + 1013904223u;
+  return State % Limit;
+}
+
+//===----------------------------------------------------------------------===//
+// Workloads
+//===----------------------------------------------------------------------===//
+
+/// Pointer-keyed visited map, as in GVN's value numbering or a dominance
+/// cache: every key inserted once, then re-queried several times in data
+/// dependent order.
+uint64_t benchDenseMapPointerVisited() {
+  const unsigned N = 1 << 14;
+  static std::vector<int> Storage(N);
+
+  DenseMap<const int *, unsigned> Visited;
+  for (unsigned I = 0; I != N; ++I)
+    Visited.insert(std::make_pair(&Storage[I], I));
+
+  unsigned State = 1;
+  unsigned Found = 0;
+  for (unsigned I = 0; I != 4 * N; ++I)
+    Found += Visited.count(&Storage[nextIndex(State, N)]);
+  doNotOptimize(Found);
+  return 5 * N;
+}
+
+/// Same workload with the final size reserved up front, the pattern the
+/// instruction-count based reserve() calls in GVN and EarlyCSE rely on.
+uint64_t benchDenseMapPointerVisitedReserved() {
+  const unsigned N = 1 << 14;
+  static std::vector<int> Storage(N);
+
+  DenseMap<const int *, unsigned> Visited;
+  Visited.reserve(N);
+  for (unsigned I = 0; I != N; ++I)
+    Visited.insert(std::make_pair(&Storage[I], I));
+
+  unsigned State = 1;
+  unsigned Found = 0;
+  for (unsigned I = 0; I != 4 * N; ++I)
+    Found += Visited.count(&Storage[nextIndex(State, N)]);
+  doNotOptimize(Found);
+  return 5 * N;
+}
+
+/// Small visited set with a high revisit rate, the shape of almost every CFG
+/// walk: most insertions are duplicates and most sets stay small.
+uint64_t benchSmallPtrSetVisited() {
+  const unsigned N = 1 << 12;
+  static std::vector<int> Storage(N);
+
+  uint64_t Ops = 0;
+  unsigned State = 7;
+  for (unsigned Walk = 0; Walk != 64; ++Walk) {
+    SmallPtrSet<const int *, 16> Visited;
+    for (unsigned I = 0; I != 256; ++I) {
+      // Three quarters of the probes revisit a recent block.
+      unsigned Idx = (I & 3) ? nextIndex(State, 32) + (I & ~31u) % (N - 32)
+                             : nextIndex(State, N);
+      Visited.insert(&Storage[Idx]);
+      ++Ops;
+    }
+    doNotOptimize(Visited.size());
+  }
+  return Ops;
+}
+
+/// Identifier interning, the StringMap workload of LLVMContext and MCContext:
+/// structured names with common prefixes and a significant duplicate rate.
+uint64_t benchStringMapIntern() {
+  const unsigned N = 1 << 14;
+  static std::vector<std::string> Names;
+  if (Names.empty()) {
+    Names.reserve(N);
+    for (unsigned I = 0; I != N; ++I) {
+      Names.push_back(std::string());
+      raw_string_ostream OS(Names.back());
+      // One duplicate for every three unique names.
+      OS << "llvm.bench.sym." << (I % (3 * N / 4)) << ".suffix";
+      OS.flush();
+    }
+  }
+
+  StringMap<unsigned> Table;
+  unsigned Interned = 0;
+  for (unsigned I = 0; I != N; ++I)
+    Interned += Table.insert(std::make_pair(StringRef(Names[I]), I)).second;
+  doNotOptimize(Interned);
+  return N;
+}
+
+/// Worklist churn: push a frontier, pop in LIFO order, occasionally push
+/// successors - the inner loop of every worklist-driven pass.
+uint64_t benchSmallVectorWorklist() {
+  uint64_t Ops = 0;
+  unsigned State = 42;
+  SmallVector<unsigned, 16> Worklist;
+  for (unsigned Round = 0; Round != 256; ++Round) {
+    for (unsigned I = 0; I != 32; ++I)
+      Worklist.push_back(I);
+    unsigned Budget = 512;
+    while (!Worklist.empty() && Budget--) {
+      unsigned Item = Worklist.pop_back_val();
+      doNotOptimize(Item);
+      ++Ops;
+      if (nextIndex(State, 4) == 0) {
+        Worklist.push_back(Item + 1);
+        Worklist.push_back(Item + 2);
+      }
+    }
+    Worklist.clear();
+  }
+  return Ops;
+}
+
+struct UniquedNode : FoldingSetNode {
+  unsigned A, B;
+  UniquedNode(unsigned A, unsigned B) : A(A), B(B) {}
+  void Profile(FoldingSetNodeID &ID) const {
+    ID.AddInteger(A);
+    ID.AddInteger(B);
+  }
+};
+
+/// Node uniquing as done for SCEVs and SDNodes: profile, probe, and only
+/// allocate on a miss. Three lookups for every unique node.
+uint64_t benchFoldingSetUnique() {
+  const unsigned N = 1 << 13;
+  FoldingSet<UniquedNode> Set;
+  std::deque<UniquedNode> Pool;
+
+  unsigned State = 3;
+  for (unsigned I = 0; I != N; ++I) {
+    unsigned A = nextIndex(State, N / 3);
+    unsigned B = A ^ 0x5a5a;
+    FoldingSetNodeID ID;
+    ID.AddInteger(A);
+    ID.AddInteger(B);
+    void *InsertPos;
+    UniquedNode *Node = Set.FindNodeOrInsertPos(ID, InsertPos);
+    if (!Node) {
+      Pool.push_back(UniquedNode(A, B));
+      Set.InsertNode(&Pool.back(), InsertPos);
+      Node = &Pool.back();
+    }
+    doNotOptimize(Node);
+  }
+  return N;
+}
+
+//===----------------------------------------------------------------------===//
+// Harness
+//===----------------------------------------------------------------------===//
+
+struct BenchmarkEntry {
+  const char *Name;
+  uint64_t (*Fn)();
+};
+
+const BenchmarkEntry Benchmarks[] = {
+    {"DenseMap/pointer-visited", benchDenseMapPointerVisited},
+    {"DenseMap/pointer-visited-reserved", benchDenseMapPointerVisitedReserved},
+    {"SmallPtrSet/cfg-visited", benchSmallPtrSetVisited},
+    {"StringMap/intern", benchStringMapIntern},
+    {"SmallVector/worklist", benchSmallVectorWorklist},
+    {"FoldingSet/unique", benchFoldingSetUnique},
+};
+
+void runBenchmark(const BenchmarkEntry &B) {
+  typedef std::chrono::steady_clock Clock;
+  const double MinSeconds = 0.2;
+
+  // Warm up once so lazily built inputs and cold caches do not count.
+  B.Fn();
+
+  uint64_t Ops = 0;
+  unsigned Calls = 0;
+  Clock::time_point Start = Clock::now();
+  double Elapsed;
+  do {
+    Ops += B.Fn();
+    ++Calls;
+    Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+  } while (Elapsed < MinSeconds);
+
+  outs() << format("%-36s %10u %16llu %12.1f\n", B.Name, Calls,
+                   (unsigned long long)Ops, Elapsed * 1e9 / double(Ops));
+}
+
+} // end anonymous namespace
+
+int main(int argc, char **argv) {
+  StringRef Filter = argc > 1 ? StringRef(argv[1]) : StringRef();
+
+  outs() << "Benchmark                                 Calls              Ops"
+            "        ns/op\n";
+  for (const BenchmarkEntry &B : Benchmarks)
+    if (Filter.empty() || StringRef(B.Name).find(Filter) != StringRef::npos)
+      runBenchmark(B);
+  return 0;
+}
@@ -396,4 +396,19 @@ TEST(DenseMapCustomTest, SmallDenseMapGrowTest) {
   EXPECT_TRUE(map.find(32) == map.end());
 }
 
+// Test that reserve() is in terms of entries: after reserving for N entries,
+// inserting N of them must not rehash (observable as bucket stability).
+TEST(DenseMapCustomTest, ReserveTest) {
+  for (unsigned Size : {1u, 2u, 48u, 100u, 1000u}) {
+    DenseMap<unsigned, unsigned, ContiguousDenseMapInfo> map;
+    map.reserve(Size);
+    map[0] = 0;
+    unsigned *Entry = &map[0];
+    for (unsigned i = 1; i < Size; ++i)
+      map[i] = i;
+    EXPECT_EQ(Size, map.size());
+    EXPECT_EQ(Entry, &map[0]);
+  }
+}
+
 }
@@ -35,5 +35,48 @@ TEST(FoldingSetTest, UnalignedStringTest) {
   EXPECT_EQ(a.ComputeHash(), b.ComputeHash());
 }
 
+// A node whose profile is a configurable number of words, to exercise the
+// short-key hash paths on either side of their boundaries.
+class TrivialPair : public FoldingSetNode {
+public:
+  unsigned Words;
+  unsigned Value;
+  TrivialPair(unsigned Words, unsigned Value) : Words(Words), Value(Value) {}
+
+  void Profile(FoldingSetNodeID &ID) const {
+    for (unsigned i = 0; i != Words; ++i)
+      ID.AddInteger(Value + i);
+  }
+};
+
+TEST(FoldingSetTest, SmallKeySizes) {
+  SCOPED_TRACE("SmallKeySizes");
+
+  FoldingSet<TrivialPair> Set;
+  std::vector<TrivialPair> Nodes;
+  Nodes.reserve(10);
+
+  // One node per profile width from one to five words, each inserted once and
+  // then found again both by node and by a freshly built ID.
+  for (unsigned Words = 1; Words != 6; ++Words) {
+    Nodes.push_back(TrivialPair(Words, 100));
+    EXPECT_EQ(&Nodes.back(), Set.GetOrInsertNode(&Nodes.back()));
+  }
+  for (unsigned Words = 1; Words != 6; ++Words) {
+    FoldingSetNodeID ID;
+    for (unsigned i = 0; i != Words; ++i)
+      ID.AddInteger(100 + i);
+    void *InsertPos = nullptr;
+    TrivialPair *Found = Set.FindNodeOrInsertPos(ID, InsertPos);
+    ASSERT_TRUE(Found);
+    EXPECT_EQ(Words, Found->Words);
+  }
+
+  // Same width but different contents must not collide into equality.
+  TrivialPair Other(2, 200);
+  EXPECT_EQ(&Other, Set.GetOrInsertNode(&Other));
+  EXPECT_EQ(6U, Set.size());
+}
+
 }
 
@@ -0,0 +1,113 @@
+//===- CFGSummaryTest.cpp - Unit tests for CFGSummaryCache ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/CFGSummary.h"
+#include "llvm/Analysis/CallGraph.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+#include <memory>
+
+using namespace llvm;
+
+namespace {
+
+std::unique_ptr<Module> parseAssembly(const char *Assembly) {
+  SMDiagnostic Error;
+  std::unique_ptr<Module> M =
+      parseAssemblyString(Assembly, Error, getGlobalContext());
+
+  std::string ErrMsg;
+  raw_string_ostream OS(ErrMsg);
+  Error.print("", OS);
+
+  // A failure here means that the test itself is buggy.
+  if (!M)
+    report_fatal_error(OS.str().c_str());
+
+  return M;
+}
+
+static const char *ModuleString = "define void @f() {\n"
+                                  "entry:\n"
+                                  "  call void @g()\n"
+                                  "  br label %next\n"
+                                  "next:\n"
+                                  "  call void @g()\n"
+                                  "  ret void\n"
+                                  "}\n"
+                                  "define void @g() {\n"
+                                  "entry:\n"
+                                  "  ret void\n"
+                                  "}\n";
+
+TEST(CFGSummaryTest, CallSitesInProgramOrder) {
+  std::unique_ptr<Module> M = parseAssembly(ModuleString);
+  Function *F = M->getFunction("f");
+  Function *G = M->getFunction("g");
+
+  CFGSummaryCache Cache;
+  ArrayRef<Instruction *> CallSites = Cache.getCallSites(*F);
+  ASSERT_EQ(2u, CallSites.size());
+  EXPECT_EQ(&F->getEntryBlock().front(), CallSites[0]);
+  EXPECT_EQ(G, CallSite(CallSites[0]).getCalledFunction());
+  EXPECT_EQ(G, CallSite(CallSites[1]).getCalledFunction());
+
+  EXPECT_TRUE(Cache.getCallSites(*G).empty());
+
+  // A second query without intervening IR changes reuses the same storage.
+  EXPECT_EQ(CallSites.data(), Cache.getCallSites(*F).data());
+}
+
+TEST(CFGSummaryTest, GenerationTracksInstructionChanges) {
+  std::unique_ptr<Module> M = parseAssembly(ModuleString);
+  Function *F = M->getFunction("f");
+  Function *G = M->getFunction("g");
+
+  CFGSummaryCache Cache;
+  ASSERT_EQ(2u, Cache.getCallSites(*F).size());
+
+  // Inserting a call invalidates the cached summary for f only.
+  uint64_t OldGen = F->getInstructionGeneration();
+  Instruction *NewCall =
+      CallInst::Create(G, "", F->getEntryBlock().getTerminator());
+  EXPECT_GT(F->getInstructionGeneration(), OldGen);
+  ArrayRef<Instruction *> CallSites = Cache.getCallSites(*F);
+  ASSERT_EQ(3u, CallSites.size());
+  EXPECT_EQ(NewCall, CallSites[1]);
+
+  // Removing it is reflected as well.
+  NewCall->eraseFromParent();
+  EXPECT_EQ(2u, Cache.getCallSites(*F).size());
+}
+
+TEST(CFGSummaryTest, CallGraphFromSummary) {
+  std::unique_ptr<Module> M = parseAssembly(ModuleString);
+  Function *F = M->getFunction("f");
+  Function *G = M->getFunction("g");
+
+  CFGSummaryCache Cache;
+  CallGraph Plain(*M);
+  CallGraph Cached(*M, &Cache);
+
+  // Both graphs record the same f -> g edges.
+  EXPECT_EQ(Plain[F]->size(), Cached[F]->size());
+  ASSERT_EQ(2u, Cached[F]->size());
+  EXPECT_EQ(Cached[G], (*Cached[F])[0]);
+  EXPECT_EQ(Cached[G], (*Cached[F])[1]);
+  EXPECT_EQ(0u, Cached[G]->size());
+}
+
+} // end anonymous namespace
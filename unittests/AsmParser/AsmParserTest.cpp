@@ -0,0 +1,134 @@
+//===- llvm/unittest/AsmParser/AsmParserTest.cpp - asm parser unittests ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(AsmParserTest, FunctionCallbackOrder) {
+  LLVMContext &Ctx = getGlobalContext();
+  StringRef Source = "define void @f1() {\n"
+                     "  ret void\n"
+                     "}\n"
+                     "define void @f2() {\n"
+                     "  call void @f1()\n"
+                     "  call void @f3()\n"
+                     "  ret void\n"
+                     "}\n"
+                     "define void @f3() {\n"
+                     "  ret void\n"
+                     "}\n";
+  SMDiagnostic Error;
+  std::vector<std::string> Names;
+  MemoryBufferRef Buf(Source, "<string>");
+  std::unique_ptr<Module> M =
+      parseAssembly(Buf, Error, Ctx, [&Names](Function &F) {
+        Names.push_back(F.getName().str());
+        // A streaming client may drop the body once it is done with it.
+        F.deleteBody();
+      });
+  ASSERT_TRUE(M.get() != nullptr);
+
+  // The callback sees each function as its definition completes, in input
+  // order.
+  ASSERT_EQ(3u, Names.size());
+  EXPECT_EQ("f1", Names[0]);
+  EXPECT_EQ("f2", Names[1]);
+  EXPECT_EQ("f3", Names[2]);
+
+  // The deleted bodies leave declarations behind; references from later
+  // functions (including the forward reference to @f3) still resolved.
+  for (Function &F : *M)
+    EXPECT_TRUE(F.isDeclaration());
+}
+
+TEST(AsmParserTest, FunctionParseCacheSplicesIdenticalBodies) {
+  LLVMContext &Ctx = getGlobalContext();
+  StringRef Source = "@g = global i32 0\n"
+                     "declare void @h(i32)\n"
+                     "define void @f(i32 %x) {\n"
+                     "entry:\n"
+                     "  %v = load i32, i32* @g\n"
+                     "  %s = add i32 %v, %x\n"
+                     "  call void @h(i32 %s)\n"
+                     "  ret void\n"
+                     "}\n";
+  FunctionParseCache Cache(Ctx);
+  SMDiagnostic Error;
+
+  std::unique_ptr<Module> M1 =
+      parseAssemblyString(Source, Error, Ctx, &Cache);
+  ASSERT_TRUE(M1.get() != nullptr);
+
+  // The second parse splices the cached body instead of re-parsing it. The
+  // result must be indistinguishable: same shape, and every reference
+  // resolved within the new module.
+  std::unique_ptr<Module> M2 =
+      parseAssemblyString(Source, Error, Ctx, &Cache);
+  ASSERT_TRUE(M2.get() != nullptr);
+
+  Function *F = M2->getFunction("f");
+  ASSERT_TRUE(F != nullptr);
+  EXPECT_FALSE(F->isDeclaration());
+  ASSERT_EQ(1u, F->size());
+  EXPECT_EQ(4u, F->front().size());
+  for (Instruction &I : F->front())
+    for (Value *Op : I.operands())
+      if (auto *GV = dyn_cast<GlobalValue>(Op))
+        EXPECT_EQ(M2.get(), GV->getParent());
+}
+
+TEST(AsmParserTest, FunctionParseCacheIgnoresName) {
+  LLVMContext &Ctx = getGlobalContext();
+  // Two definitions identical but for their names share one cache entry; the
+  // second is spliced and still calls the first.
+  StringRef Source = "declare i32 @ext()\n"
+                     "define i32 @a() {\n"
+                     "  %r = call i32 @ext()\n"
+                     "  ret i32 %r\n"
+                     "}\n"
+                     "define i32 @b() {\n"
+                     "  %r = call i32 @ext()\n"
+                     "  ret i32 %r\n"
+                     "}\n";
+  FunctionParseCache Cache(Ctx);
+  SMDiagnostic Error;
+  std::unique_ptr<Module> M = parseAssemblyString(Source, Error, Ctx, &Cache);
+  ASSERT_TRUE(M.get() != nullptr);
+
+  Function *B = M->getFunction("b");
+  ASSERT_TRUE(B != nullptr);
+  EXPECT_FALSE(B->isDeclaration());
+  auto *Call = dyn_cast<CallInst>(&B->front().front());
+  ASSERT_TRUE(Call != nullptr);
+  EXPECT_EQ(M->getFunction("ext"), Call->getCalledFunction());
+}
+
+TEST(AsmParserTest, NoCallbackWithoutDefinitions) {
+  LLVMContext &Ctx = getGlobalContext();
+  StringRef Source = "declare void @f()\n"
+                     "@g = global i32 0\n";
+  SMDiagnostic Error;
+  unsigned Calls = 0;
+  MemoryBufferRef Buf(Source, "<string>");
+  std::unique_ptr<Module> M =
+      parseAssembly(Buf, Error, Ctx, [&Calls](Function &) { ++Calls; });
+  ASSERT_TRUE(M.get() != nullptr);
+  EXPECT_EQ(0u, Calls);
+}
+
+} // end anonymous namespace
@@ -10,6 +10,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
+#include "llvm/Bitcode/LLVMBitCodes.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
@@ -164,4 +165,46 @@ TEST(BitReaderTest, MaterializeFunctionsForBlockAddrInFunctionAfter) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+TEST(BitReaderTest, ReadSymbolsFromSymtabBlock) {
+  SmallString<1024> Mem;
+  writeModuleToBuffer(parseAssembly("@g = global i32 0\n"
+                                    "@c = common global i32 0\n"
+                                    "define linkonce_odr void @f() {\n"
+                                    "  ret void\n"
+                                    "}\n"
+                                    "declare extern_weak void @w()\n"),
+                      Mem);
+
+  std::vector<BitcodeSymbol> Symbols;
+  ErrorOr<bool> Found =
+      readBitcodeSymbols(MemoryBufferRef(Mem.str(), "test"), Symbols);
+  ASSERT_TRUE(bool(Found));
+  EXPECT_TRUE(*Found);
+  ASSERT_EQ(4u, Symbols.size());
+
+  // Functions come first, then global variables, in module order.
+  EXPECT_EQ("f", Symbols[0].Name);
+  EXPECT_TRUE(Symbols[0].Flags & bitc::SYMTAB_SYMBOL_WEAK);
+  EXPECT_TRUE(Symbols[0].Flags & bitc::SYMTAB_SYMBOL_SELF_COMDAT);
+  EXPECT_EQ("w", Symbols[1].Name);
+  EXPECT_TRUE(Symbols[1].Flags & bitc::SYMTAB_SYMBOL_UNDEFINED);
+  EXPECT_TRUE(Symbols[1].Flags & bitc::SYMTAB_SYMBOL_EXTERNAL_WEAK);
+  EXPECT_EQ("g", Symbols[2].Name);
+  EXPECT_TRUE(Symbols[2].Flags & bitc::SYMTAB_SYMBOL_GLOBAL);
+  EXPECT_EQ("c", Symbols[3].Name);
+  EXPECT_TRUE(Symbols[3].Flags & bitc::SYMTAB_SYMBOL_COMMON);
+}
+
+TEST(BitReaderTest, SymtabBlockOmittedForModuleAsm) {
+  SmallString<1024> Mem;
+  writeModuleToBuffer(parseAssembly("module asm \".text\"\n"), Mem);
+
+  std::vector<BitcodeSymbol> Symbols;
+  ErrorOr<bool> Found =
+      readBitcodeSymbols(MemoryBufferRef(Mem.str(), "test"), Symbols);
+  ASSERT_TRUE(bool(Found));
+  EXPECT_FALSE(*Found);
+  EXPECT_TRUE(Symbols.empty());
+}
+
 } // end namespace
@@ -0,0 +1,108 @@
+//===- ConstantPoolingLayerTest.cpp - Unit tests for constant pooling -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/ConstantPoolingLayer.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "gtest/gtest.h"
+#include <list>
+
+using namespace llvm;
+
+namespace {
+
+struct MockBaseLayer {
+  typedef int ModuleSetHandleT;
+  ModuleSetHandleT addModuleSet(std::list<std::unique_ptr<Module>>,
+                                std::unique_ptr<RTDyldMemoryManager> MM) {
+    EXPECT_FALSE(MM);
+    return 42;
+  }
+};
+
+// Add a module containing an internal unnamed_addr constant array of 8192
+// 'x' bytes, returned to the caller through a function so the global has a
+// use.
+std::unique_ptr<Module> makeModuleWithTable(LLVMContext &Ctx,
+                                            StringRef ModuleName) {
+  auto M = llvm::make_unique<Module>(ModuleName, Ctx);
+  Constant *Init = ConstantDataArray::getString(
+      Ctx, std::string(8192, 'x'), /* AddNull */ false);
+  auto *GV = new GlobalVariable(*M, Init->getType(), /* isConstant */ true,
+                                GlobalValue::InternalLinkage, Init, "table");
+  GV->setUnnamedAddr(true);
+  Function *F = Function::Create(
+      FunctionType::get(Type::getInt8PtrTy(Ctx), /* isVarArg */ false),
+      GlobalValue::ExternalLinkage, "gettable", &*M);
+  BasicBlock *BB = BasicBlock::Create(Ctx, "entry", F);
+  IRBuilder<> Builder(BB);
+  Builder.CreateRet(
+      Builder.CreateBitCast(GV, Type::getInt8PtrTy(Ctx)));
+  return M;
+}
+
+// Return the pooled address that the module's table was replaced with, or 0
+// if the replacement did not have the expected shape.
+static uint64_t getPooledAddress(Module &M) {
+  Function *F = M.getFunction("gettable");
+  if (!F)
+    return 0;
+  auto *Ret = dyn_cast<ReturnInst>(F->getEntryBlock().getTerminator());
+  if (!Ret)
+    return 0;
+  auto *CE = dyn_cast<ConstantExpr>(Ret->getReturnValue());
+  while (CE && CE->getOpcode() == Instruction::BitCast)
+    CE = dyn_cast<ConstantExpr>(CE->getOperand(0));
+  if (!CE || CE->getOpcode() != Instruction::IntToPtr)
+    return 0;
+  auto *Addr = dyn_cast<ConstantInt>(CE->getOperand(0));
+  return Addr ? Addr->getZExtValue() : 0;
+}
+
+TEST(ConstantPoolingLayerTest, PoolsIdenticalTables) {
+  LLVMContext Ctx;
+  MockBaseLayer B;
+  llvm::orc::ConstantPoolingLayer<MockBaseLayer> L(B, 4096);
+
+  std::list<std::unique_ptr<Module>> Ms;
+  Ms.push_back(makeModuleWithTable(Ctx, "a"));
+  Ms.push_back(makeModuleWithTable(Ctx, "b"));
+  Module &MA = *Ms.front();
+  Module &MB = *Ms.back();
+
+  L.addModuleSet(std::move(Ms), nullptr);
+
+  // Both globals should be gone, replaced by pointers to one shared copy.
+  EXPECT_EQ(nullptr, MA.getGlobalVariable("table", true));
+  EXPECT_EQ(nullptr, MB.getGlobalVariable("table", true));
+  uint64_t AddrA = getPooledAddress(MA);
+  uint64_t AddrB = getPooledAddress(MB);
+  ASSERT_NE(0u, AddrA);
+  EXPECT_EQ(AddrA, AddrB);
+  EXPECT_EQ(0u, AddrA % 64);
+  EXPECT_EQ(0, memcmp(reinterpret_cast<const char *>(uintptr_t(AddrA)),
+                      std::string(8192, 'x').data(), 8192));
+}
+
+TEST(ConstantPoolingLayerTest, LeavesSmallConstantsAlone) {
+  LLVMContext Ctx;
+  MockBaseLayer B;
+  llvm::orc::ConstantPoolingLayer<MockBaseLayer> L(B, 1 << 20);
+
+  std::list<std::unique_ptr<Module>> Ms;
+  Ms.push_back(makeModuleWithTable(Ctx, "a"));
+  Module &MA = *Ms.front();
+
+  L.addModuleSet(std::move(Ms), nullptr);
+
+  EXPECT_NE(nullptr, MA.getGlobalVariable("table", true));
+}
+
+}
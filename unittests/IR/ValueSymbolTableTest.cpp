@@ -0,0 +1,48 @@
+//===- ValueSymbolTableTest.cpp - Symbol table snapshot unit tests --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+using namespace llvm;
+
+namespace {
+
+TEST(ValueSymbolTableTest, SnapshotIsFrozen) {
+  LLVMContext C;
+
+  const char *ModuleString = "define void @foo() {\n"
+                             "  ret void\n"
+                             "}\n"
+                             "@gv = global i32 0\n";
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(ModuleString, Err, C);
+  ASSERT_TRUE(M.get() != nullptr);
+
+  Function *Foo = M->getFunction("foo");
+  ValueSymbolTableSnapshot Snap(M->getValueSymbolTable());
+  EXPECT_EQ(2u, Snap.size());
+  EXPECT_EQ(Foo, Snap.lookup("foo"));
+  EXPECT_EQ(M->getNamedValue("gv"), Snap.lookup("gv"));
+
+  // Mutations after the snapshot is taken are not visible through it.
+  Foo->setName("bar");
+  EXPECT_EQ(nullptr, M->getNamedValue("foo"));
+  EXPECT_EQ(Foo, Snap.lookup("foo"));
+  EXPECT_EQ(nullptr, Snap.lookup("bar"));
+
+  // The live table is unaffected by the snapshot's existence.
+  EXPECT_EQ(Foo, M->getNamedValue("bar"));
+}
+
+} // end anonymous namespace
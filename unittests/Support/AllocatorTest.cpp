@@ -73,6 +73,23 @@ TEST(AllocatorTest, TestReset) {
   EXPECT_EQ(2U, Alloc.GetNumSlabs());
 }
 
+// Allocate enough bytes to create two slabs, reset the allocator keeping its
+// slabs, and check that refilling reuses them instead of allocating more.
+TEST(AllocatorTest, TestResetKeepingSlabs) {
+  BumpPtrAllocator Alloc;
+  void *a = Alloc.Allocate(3000, 1);
+  Alloc.Allocate(3000, 1);
+  EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  Alloc.ResetKeepingSlabs();
+  EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  // The first allocation lands back at the start of the first slab.
+  EXPECT_EQ(a, Alloc.Allocate(3000, 1));
+  Alloc.Allocate(3000, 1);
+  EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  Alloc.Allocate(3000, 1);
+  EXPECT_EQ(3U, Alloc.GetNumSlabs());
+}
+
 // Test some allocations at varying alignments.
 TEST(AllocatorTest, TestAlignment) {
   BumpPtrAllocator Alloc;
@@ -59,6 +59,36 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+TEST(CompressionTest, ZlibStream) {
+  const size_t kSize = 1024;
+  char BinaryData[kSize];
+  for (size_t i = 0; i < kSize; ++i) {
+    BinaryData[i] = i & 255;
+  }
+  StringRef BinaryDataStr(BinaryData, kSize);
+
+  // Feed the input in uneven chunks and check that the result uncompresses
+  // back to the concatenated input.
+  SmallString<32> Compressed;
+  zlib::StreamCompressor Compressor(Compressed);
+  EXPECT_EQ(zlib::StatusOK, Compressor.update(BinaryDataStr.substr(0, 1)));
+  EXPECT_EQ(zlib::StatusOK, Compressor.update(""));
+  EXPECT_EQ(zlib::StatusOK, Compressor.update(BinaryDataStr.substr(1, 100)));
+  EXPECT_EQ(zlib::StatusOK, Compressor.update(BinaryDataStr.substr(101)));
+  EXPECT_EQ(zlib::StatusOK, Compressor.finish());
+
+  SmallString<32> Uncompressed;
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::uncompress(Compressed, Uncompressed, kSize));
+  EXPECT_EQ(BinaryDataStr, Uncompressed);
+
+  // An empty stream is still a valid zlib stream.
+  SmallString<32> Empty;
+  zlib::StreamCompressor EmptyCompressor(Empty);
+  EXPECT_EQ(zlib::StatusOK, EmptyCompressor.finish());
+  EXPECT_EQ(zlib::StatusOK, zlib::uncompress(Empty, Uncompressed, 0));
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
@@ -51,6 +51,35 @@ TEST(ConvertUTFTest, ConvertUTF8ToUTF16String) {
     EXPECT_EQ(Expected[I], Result[I]);
 }
 
+TEST(ConvertUTFTest, ConvertUTF8ToUTF16StringLongMixed) {
+  // Mix long ASCII runs with multi-byte sequences at varying offsets so the
+  // word-at-a-time ASCII fast path has to hand off to the scalar converter
+  // at unaligned boundaries.
+  std::string Src;
+  std::vector<UTF16> Expected;
+  for (unsigned I = 0; I != 64; ++I) {
+    Src.append(I, 'a');
+    Expected.insert(Expected.end(), I, 0x0061);
+    Src += "\xe0\xb2\xa0";
+    Expected.push_back(0x0CA0);
+  }
+  SmallVector<UTF16, 8> Result;
+  bool Success = convertUTF8ToUTF16String(Src, Result);
+  EXPECT_TRUE(Success);
+  ASSERT_EQ(Expected.size(), Result.size());
+  for (unsigned I = 0, E = Expected.size(); I != E; ++I)
+    EXPECT_EQ(Expected[I], Result[I]);
+}
+
+TEST(ConvertUTFTest, ConvertUTF8ToUTF16StringIllegalAfterASCIIRun) {
+  // An illegal sequence after a long ASCII run must still be diagnosed.
+  std::string Src(32, 'a');
+  Src += "\xfc\x80";
+  SmallVector<UTF16, 8> Result;
+  bool Success = convertUTF8ToUTF16String(Src, Result);
+  EXPECT_FALSE(Success);
+}
+
 TEST(ConvertUTFTest, OddLengthInput) {
   std::string Result;
   bool Success = convertUTF16ToUTF8String(makeArrayRef("xxxxx", 5), Result);
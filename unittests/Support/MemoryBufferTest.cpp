@@ -214,9 +214,25 @@ TEST_F(MemoryBufferTest, slice) {
   EXPECT_TRUE(BufData2.substr(0x17F8,8).equals("12345678"));
   EXPECT_TRUE(BufData2.substr(0x1800,8).equals("abcdefgh"));
   EXPECT_TRUE(BufData2.substr(0x2FF8,8).equals("abcdefgh"));
- 
-}
 
+}
 
+TEST_F(MemoryBufferTest, sharedSlice) {
+  std::shared_ptr<MemoryBuffer> Base =
+      MemoryBuffer::getMemBufferCopy("0123456789abcdef", "base");
+  const char *BaseData = Base->getBufferStart();
+
+  OwningBuffer Slice =
+      MemoryBuffer::getSlice(Base, 4, 8, "slice");
+  EXPECT_STREQ("slice", Slice->getBufferIdentifier());
+  EXPECT_EQ(8UL, Slice->getBufferSize());
+  // The slice aliases the original data rather than copying it.
+  EXPECT_EQ(BaseData + 4, Slice->getBufferStart());
+  EXPECT_TRUE(Slice->getBuffer().equals("456789ab"));
+
+  // The data stays alive after the original handle is dropped.
+  Base.reset();
+  EXPECT_TRUE(Slice->getBuffer().equals("456789ab"));
+}
 
 }
@@ -0,0 +1,91 @@
+//===- unittests/Support/RemarkStreamTest.cpp - Remark stream tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/RemarkStream.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(RemarkStreamTest, RoundTrip) {
+  std::string Storage;
+  {
+    raw_string_ostream OS(Storage);
+    RemarkStreamWriter Writer(OS);
+    Writer.emitRemark("inline", "caller", "a.c", 10, 3, "callee inlined");
+    Writer.emitRemark("licm", "caller", "a.c", 20, 7, "hoisted load");
+    Writer.emitRemark("inline", "other", "", 0, 0, "no location");
+  }
+
+  RemarkStreamReader Reader(Storage);
+  RemarkRecord R;
+
+  ASSERT_TRUE(Reader.readRemark(R));
+  EXPECT_EQ("inline", R.PassName);
+  EXPECT_EQ("caller", R.FunctionName);
+  EXPECT_EQ("a.c", R.File);
+  EXPECT_EQ(10u, R.Line);
+  EXPECT_EQ(3u, R.Column);
+  EXPECT_EQ("callee inlined", R.Message);
+
+  ASSERT_TRUE(Reader.readRemark(R));
+  EXPECT_EQ("licm", R.PassName);
+  EXPECT_EQ(20u, R.Line);
+  EXPECT_EQ("hoisted load", R.Message);
+
+  ASSERT_TRUE(Reader.readRemark(R));
+  EXPECT_EQ("other", R.FunctionName);
+  EXPECT_TRUE(R.File.empty());
+  EXPECT_EQ("no location", R.Message);
+
+  EXPECT_FALSE(Reader.readRemark(R));
+  EXPECT_FALSE(Reader.malformed());
+}
+
+TEST(RemarkStreamTest, StringsAreInterned) {
+  std::string Once, Twice;
+  {
+    raw_string_ostream OS(Once);
+    RemarkStreamWriter Writer(OS);
+    Writer.emitRemark("inline", "f", "a.c", 1, 1, "m");
+  }
+  {
+    raw_string_ostream OS(Twice);
+    RemarkStreamWriter Writer(OS);
+    Writer.emitRemark("inline", "f", "a.c", 1, 1, "m");
+    Writer.emitRemark("inline", "f", "a.c", 2, 2, "m");
+  }
+  // The second remark reuses every string table entry, so it must cost
+  // less than the strings would.
+  EXPECT_LT(Twice.size() - Once.size(), strlen("inline") + strlen("a.c"));
+}
+
+TEST(RemarkStreamTest, RejectsBadMagic) {
+  RemarkStreamReader Reader("not a remark stream");
+  RemarkRecord R;
+  EXPECT_FALSE(Reader.readRemark(R));
+  EXPECT_TRUE(Reader.malformed());
+}
+
+TEST(RemarkStreamTest, RejectsTruncatedRecord) {
+  std::string Storage;
+  {
+    raw_string_ostream OS(Storage);
+    RemarkStreamWriter Writer(OS);
+    Writer.emitRemark("inline", "f", "a.c", 1, 1, "message");
+  }
+  RemarkStreamReader Reader(StringRef(Storage).drop_back(4));
+  RemarkRecord R;
+  EXPECT_FALSE(Reader.readRemark(R));
+  EXPECT_TRUE(Reader.malformed());
+}
+
+} // end anonymous namespace
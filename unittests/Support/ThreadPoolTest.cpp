@@ -0,0 +1,64 @@
+//===- unittests/Support/ThreadPoolTest.cpp -------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Parallel.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+TEST(ThreadPoolTest, AsyncAndWait) {
+  std::atomic<unsigned> Count(0);
+  {
+    ThreadPool Pool(4);
+    for (unsigned I = 0; I < 32; ++I)
+      Pool.async([&Count] { ++Count; });
+    Pool.wait();
+    EXPECT_EQ(32u, Count.load());
+  }
+}
+
+TEST(ThreadPoolTest, FutureResult) {
+  ThreadPool Pool(2);
+  std::atomic<bool> Ran(false);
+  std::shared_future<void> Future = Pool.async([&Ran] { Ran = true; });
+  Future.wait();
+  EXPECT_TRUE(Ran.load());
+}
+
+TEST(ThreadPoolTest, DestructorWaits) {
+  std::atomic<unsigned> Count(0);
+  {
+    ThreadPool Pool(2);
+    for (unsigned I = 0; I < 16; ++I)
+      Pool.async([&Count] { ++Count; });
+    // No explicit wait; the destructor must drain the queue.
+  }
+  EXPECT_EQ(16u, Count.load());
+}
+
+TEST(ThreadPoolTest, ParallelForEachN) {
+  std::vector<size_t> Data(4096, 0);
+  parallel::for_each_n(size_t(0), Data.size(), [&](size_t I) { Data[I] = I; });
+  for (size_t I = 0; I < Data.size(); ++I)
+    EXPECT_EQ(I, Data[I]);
+}
+
+TEST(ThreadPoolTest, ParallelSort) {
+  std::mt19937 Gen(20);
+  std::uniform_int_distribution<uint32_t> Dist;
+  std::vector<uint32_t> Data(10000);
+  for (uint32_t &Elt : Data)
+    Elt = Dist(Gen);
+  parallel::sort(Data.begin(), Data.end());
+  ASSERT_TRUE(std::is_sorted(Data.begin(), Data.end()));
+}
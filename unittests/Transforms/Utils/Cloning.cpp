@@ -406,4 +406,82 @@ TEST_F(CloneFunc, DebugIntrinsics) {
   }
 }
 
+class CloneModuleLazy : public ::testing::Test {
+protected:
+  void SetUp() override {
+    M.reset(new Module("lazy", C));
+    IRBuilder<> IBuilder(C);
+
+    GV = new GlobalVariable(*M, Type::getInt32Ty(C), false,
+                            GlobalValue::InternalLinkage, IBuilder.getInt32(7),
+                            "gv");
+
+    FunctionType *FuncType = FunctionType::get(Type::getInt32Ty(C), false);
+    Callee = Function::Create(FuncType, GlobalValue::InternalLinkage, "g",
+                              M.get());
+    BasicBlock *GEntry = BasicBlock::Create(C, "", Callee);
+    IBuilder.SetInsertPoint(GEntry);
+    IBuilder.CreateRet(IBuilder.CreateLoad(GV));
+
+    Caller = Function::Create(FuncType, GlobalValue::ExternalLinkage, "f",
+                              M.get());
+    BasicBlock *FEntry = BasicBlock::Create(C, "", Caller);
+    IBuilder.SetInsertPoint(FEntry);
+    IBuilder.CreateRet(IBuilder.CreateCall(Callee));
+
+    Clone.reset(CloneModuleLazily(M.get()));
+  }
+
+  LLVMContext C;
+  std::unique_ptr<Module> M;
+  std::unique_ptr<Module> Clone;
+  GlobalVariable *GV;
+  Function *Callee;
+  Function *Caller;
+};
+
+// Function bodies must not be copied until they are materialized, while the
+// interface (and global initializers) are cloned eagerly.
+TEST_F(CloneModuleLazy, BodiesAreDeferred) {
+  Function *NewF = Clone->getFunction("f");
+  Function *NewG = Clone->getFunction("g");
+  ASSERT_TRUE(NewF && NewG);
+  EXPECT_TRUE(NewF->empty());
+  EXPECT_TRUE(NewG->empty());
+  EXPECT_TRUE(NewF->isMaterializable());
+  EXPECT_TRUE(NewG->isMaterializable());
+
+  GlobalVariable *NewGV = Clone->getGlobalVariable("gv", true);
+  ASSERT_TRUE(NewGV);
+  EXPECT_TRUE(NewGV->hasInitializer());
+}
+
+// Materializing one function clones only its body, remapped into the clone.
+TEST_F(CloneModuleLazy, MaterializeOneFunction) {
+  Function *NewF = Clone->getFunction("f");
+  ASSERT_FALSE(Clone->materialize(NewF));
+
+  EXPECT_FALSE(NewF->isMaterializable());
+  ASSERT_EQ(1U, NewF->size());
+  EXPECT_EQ(Caller->front().size(), NewF->front().size());
+
+  // The call must target the clone's 'g', which is still unmaterialized.
+  CallInst *Call = cast<CallInst>(&NewF->front().front());
+  EXPECT_EQ(Clone->getFunction("g"), Call->getCalledFunction());
+  EXPECT_TRUE(Clone->getFunction("g")->empty());
+
+  // The source module is untouched.
+  EXPECT_EQ(1U, Caller->size());
+}
+
+// materializeAll fills in every remaining body.
+TEST_F(CloneModuleLazy, MaterializeAll) {
+  ASSERT_FALSE(Clone->materializeAll());
+
+  Function *NewG = Clone->getFunction("g");
+  ASSERT_EQ(1U, NewG->size());
+  LoadInst *Load = cast<LoadInst>(&NewG->front().front());
+  EXPECT_EQ(Clone->getGlobalVariable("gv", true), Load->getPointerOperand());
+}
+
 }
@@ -0,0 +1,71 @@
+//===- SSAUpdaterTest.cpp - Unit tests for SSAUpdater ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/SSAUpdater.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+TEST(SSAUpdater, PromoteAllocaBatch) {
+  LLVMContext &C(getGlobalContext());
+  Module M("PromoteAllocaBatch", C);
+
+  // Build:
+  //   entry: %p = alloca i32; br i1 %c, label %then, label %else
+  //   then:  store i32 %a, i32* %p; br label %merge
+  //   else:  store i32 %b, i32* %p; br label %merge
+  //   merge: %v = load i32* %p; ret i32 %v
+  Type *Int32Ty = Type::getInt32Ty(C);
+  Type *ArgTys[] = {Type::getInt1Ty(C), Int32Ty, Int32Ty};
+  Function *F = Function::Create(FunctionType::get(Int32Ty, ArgTys, false),
+                                 Function::ExternalLinkage, "f", &M);
+  Function::arg_iterator AI = F->arg_begin();
+  Value *Cond = AI++;
+  Value *A = AI++;
+  Value *B = AI;
+
+  BasicBlock *Entry = BasicBlock::Create(C, "entry", F);
+  BasicBlock *Then = BasicBlock::Create(C, "then", F);
+  BasicBlock *Else = BasicBlock::Create(C, "else", F);
+  BasicBlock *Merge = BasicBlock::Create(C, "merge", F);
+
+  IRBuilder<> Builder(Entry);
+  AllocaInst *P = Builder.CreateAlloca(Int32Ty, nullptr, "p");
+  Builder.CreateCondBr(Cond, Then, Else);
+  Builder.SetInsertPoint(Then);
+  Builder.CreateStore(A, P);
+  Builder.CreateBr(Merge);
+  Builder.SetInsertPoint(Else);
+  Builder.CreateStore(B, P);
+  Builder.CreateBr(Merge);
+  Builder.SetInsertPoint(Merge);
+  Value *V = Builder.CreateLoad(P, "v");
+  ReturnInst *Ret = Builder.CreateRet(V);
+
+  SmallVector<PHINode *, 4> Inserted;
+  SSAUpdater SSA(&Inserted);
+  AllocaInst *Allocas[] = {P};
+  promoteAllocasWithSSAUpdater(Allocas, SSA);
+
+  // The load and stores are gone, the alloca is gone, and the return value
+  // is a PHI of the two incoming arguments.
+  ASSERT_EQ(1u, Inserted.size());
+  PHINode *PN = Inserted[0];
+  EXPECT_EQ(Merge, PN->getParent());
+  EXPECT_EQ(PN, Ret->getReturnValue());
+  EXPECT_TRUE(isa<BranchInst>(Entry->front()));
+  EXPECT_TRUE(isa<BranchInst>(Then->front()));
+  EXPECT_TRUE(isa<BranchInst>(Else->front()));
+}
@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+
+"""Deterministic LLVM IR corpus generator for the check-perf suite.
+
+Emits a module of interlinked functions, each containing a loop with a
+configurable amount of straight-line integer arithmetic and memory traffic.
+The output only depends on the command line options (the RNG is explicitly
+seeded), so benchmark inputs do not have to be checked into the tree.
+"""
+
+from __future__ import print_function
+
+import argparse
+import random
+import sys
+
+BINOPS = ['add', 'sub', 'mul', 'and', 'or', 'xor']
+
+
+def emit_function(out, index, num_functions, ops, rng):
+    name = 'f%d' % index
+    out.write('define i32 @%s(i32 %%a, i32 %%b) {\n' % name)
+    out.write('entry:\n')
+    out.write('  %buf = alloca [64 x i32]\n')
+    out.write('  br label %loop\n')
+    out.write('loop:\n')
+    out.write('  %iv = phi i32 [ 0, %entry ], [ %iv.next, %loop ]\n')
+    out.write('  %acc = phi i32 [ %a, %entry ], [ %acc.next, %loop ]\n')
+
+    # Straight-line arithmetic feeding off the loop-carried values. Every
+    # value is used at least by its successors with some probability, which
+    # leaves plenty of work for GVN/DCE/isel without making the IR trivially
+    # foldable.
+    vals = ['%iv', '%acc', '%b']
+    tmp = 0
+    for _ in range(ops):
+        op = rng.choice(BINOPS)
+        lhs = rng.choice(vals)
+        rhs = rng.choice(vals + [str(rng.randint(1, 255))])
+        out.write('  %%t%d = %s i32 %s, %s\n' % (tmp, op, lhs, rhs))
+        vals.append('%%t%d' % tmp)
+        tmp += 1
+
+    # A little memory traffic so the memory-dependence passes have something
+    # to chew on.
+    slot = rng.randint(0, 63)
+    out.write('  %%p%d = getelementptr inbounds [64 x i32], '
+              '[64 x i32]* %%buf, i32 0, i32 %d\n' % (tmp, slot))
+    out.write('  store i32 %s, i32* %%p%d\n' % (vals[-1], tmp))
+    out.write('  %%ld%d = load i32, i32* %%p%d\n' % (tmp, tmp))
+
+    out.write('  %%acc.next = add i32 %s, %%ld%d\n' % (vals[-1], tmp))
+    out.write('  %iv.next = add i32 %iv, 1\n')
+    out.write('  %cmp = icmp slt i32 %iv.next, 128\n')
+    out.write('  br i1 %cmp, label %loop, label %exit\n')
+    out.write('exit:\n')
+
+    # Chain into the next function so the inliner and the call graph passes
+    # see a deep, acyclic call structure.
+    if index + 1 < num_functions:
+        out.write('  %%call = call i32 @f%d(i32 %%acc.next, i32 %%ld%d)\n'
+                  % (index + 1, tmp))
+        out.write('  %r = add i32 %acc.next, %call\n')
+    else:
+        out.write('  %r = add i32 %acc.next, 1\n')
+    out.write('  ret i32 %r\n')
+    out.write('}\n\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--functions', type=int, default=200,
+                        help='number of functions to generate')
+    parser.add_argument('--ops', type=int, default=40,
+                        help='arithmetic operations per loop body')
+    parser.add_argument('--seed', type=int, default=1,
+                        help='RNG seed; the output is a pure function of '
+                             'the options')
+    parser.add_argument('-o', dest='output', required=True,
+                        help='output .ll file')
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    out = open(args.output, 'w')
+    out.write('; Generated by utils/perf/gen_corpus.py'
+              ' --functions %d --ops %d --seed %d\n\n'
+              % (args.functions, args.ops, args.seed))
+    for i in range(args.functions):
+        emit_function(out, i, args.functions, args.ops, rng)
+    out.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,199 @@
+#!/usr/bin/env python
+
+"""Compile-time benchmark driver for the check-perf suite.
+
+Runs a compiler invocation (everything after '--') several times with
+-time-passes, parses the timer report, and records per-pass and total wall
+times. If a baseline recording exists for this benchmark the new numbers are
+compared against it with variance-aware thresholds; otherwise the run only
+records results.
+
+A regression is reported when the new median exceeds the baseline median by
+both a relative tolerance and a multiple of the larger of the two standard
+deviations, so run-to-run noise on small timings does not trip the check.
+
+Baselines are machine-specific: record them with --update-baseline on the
+machine that will run the comparison (typically the performance bot), and see
+test/Perf/baselines/README.txt for the policy on checking them in.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import math
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+# Timer rows look like:
+#    0.0040 ( 44.4%)   0.0000 (  0.0%)  ...   0.0040 ( 39.6%)  Greedy Register
+# The number of time columns varies with what was measured, so take the last
+# "seconds (percent%)" group as the wall time and the rest of the line as the
+# pass name.
+TIME_RE = re.compile(r'(\d+\.\d+) \(\s*\d+\.\d+%\)')
+
+
+def parse_timer_report(path):
+    """Return {pass name: wall seconds} from an -info-output-file report."""
+    times = {}
+    for line in open(path):
+        matches = list(TIME_RE.finditer(line))
+        if not matches:
+            continue
+        name = line[matches[-1].end():].strip()
+        if not name or name == 'Total':
+            continue
+        # Repeated pass instances report under one name; accumulate.
+        times[name] = times.get(name, 0.0) + float(matches[-1].group(1))
+    return times
+
+
+def median(xs):
+    xs = sorted(xs)
+    n = len(xs)
+    if n % 2:
+        return xs[n // 2]
+    return (xs[n // 2 - 1] + xs[n // 2]) / 2.0
+
+
+def stddev(xs):
+    if len(xs) < 2:
+        return 0.0
+    mean = sum(xs) / len(xs)
+    return math.sqrt(sum((x - mean) ** 2 for x in xs) / (len(xs) - 1))
+
+
+def summarize(samples):
+    return {'median': median(samples), 'stddev': stddev(samples),
+            'samples': samples}
+
+
+def is_regression(base, new, tolerance, sigmas, floor):
+    delta = new['median'] - base['median']
+    if delta <= base['median'] * tolerance:
+        return False
+    noise = max(base['stddev'], new['stddev'], floor / sigmas)
+    return delta > sigmas * noise
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--name', required=True,
+                        help='benchmark name; keys the baseline file')
+    parser.add_argument('--baseline-dir', required=True)
+    parser.add_argument('--results-dir', required=True)
+    parser.add_argument('--iterations', type=int, default=3)
+    parser.add_argument('--tolerance', type=float, default=0.10,
+                        help='relative slowdown tolerated before a pass is '
+                             'even considered (default 10%%)')
+    parser.add_argument('--sigmas', type=float, default=3.0,
+                        help='required significance in standard deviations')
+    parser.add_argument('--floor', type=float, default=0.02,
+                        help='absolute seconds below which deltas are noise')
+    parser.add_argument('--update-baseline', action='store_true',
+                        help='record this run as the new baseline and exit')
+    parser.add_argument('command', nargs=argparse.REMAINDER,
+                        help="-- followed by the compiler invocation; "
+                             "-time-passes and -info-output-file are added "
+                             "by the driver")
+    args = parser.parse_args()
+
+    command = args.command
+    if command and command[0] == '--':
+        command = command[1:]
+    if not command:
+        parser.error('no benchmark command given')
+
+    per_pass = {}
+    totals = []
+    for i in range(args.iterations):
+        fd, report = tempfile.mkstemp(suffix='.timers')
+        os.close(fd)
+        try:
+            start = time.time()
+            rc = subprocess.call(command + ['-time-passes',
+                                            '-info-output-file', report])
+            totals.append(time.time() - start)
+            if rc != 0:
+                print('%s: benchmark command failed (exit %d): %s'
+                      % (args.name, rc, ' '.join(command)))
+                return 1
+            for name, secs in parse_timer_report(report).items():
+                per_pass.setdefault(name, []).append(secs)
+        finally:
+            os.remove(report)
+
+    results = {
+        'name': args.name,
+        'iterations': args.iterations,
+        'total_wall': summarize(totals),
+        'passes': dict((name, summarize(samples))
+                       for name, samples in per_pass.items()
+                       # Passes missing from some iterations never had a
+                       # stable report line; skip them.
+                       if len(samples) == args.iterations),
+    }
+
+    if not os.path.isdir(args.results_dir):
+        os.makedirs(args.results_dir)
+    results_file = os.path.join(args.results_dir, args.name + '.json')
+    with open(results_file, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+
+    baseline_file = os.path.join(args.baseline_dir, args.name + '.json')
+    if args.update_baseline or os.environ.get('LLVM_PERF_UPDATE_BASELINE'):
+        if not os.path.isdir(args.baseline_dir):
+            os.makedirs(args.baseline_dir)
+        with open(baseline_file, 'w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+        print('%s: baseline updated: %s' % (args.name, baseline_file))
+        return 0
+
+    if not os.path.exists(baseline_file):
+        print('%s: no baseline recorded; results written to %s'
+              % (args.name, results_file))
+        print('%s: run with --update-baseline (or set '
+              'LLVM_PERF_UPDATE_BASELINE=1) to record one' % args.name)
+        return 0
+
+    baseline = json.load(open(baseline_file))
+    regressions = []
+
+    if is_regression(baseline['total_wall'], results['total_wall'],
+                     args.tolerance, args.sigmas, args.floor):
+        regressions.append(('total wall time', baseline['total_wall'],
+                            results['total_wall']))
+
+    total = results['total_wall']['median']
+    for name, base in sorted(baseline.get('passes', {}).items()):
+        new = results['passes'].get(name)
+        if new is None:
+            continue
+        # Only passes that matter to the whole compile are worth failing on.
+        if new['median'] < max(args.floor, 0.02 * total):
+            continue
+        if is_regression(base, new, args.tolerance, args.sigmas, args.floor):
+            regressions.append((name, base, new))
+
+    if regressions:
+        print('%s: compile-time regressions against %s:'
+              % (args.name, baseline_file))
+        for name, base, new in regressions:
+            print('  %-50s %8.4fs -> %8.4fs (+%.1f%%)'
+                  % (name, base['median'], new['median'],
+                     100.0 * (new['median'] - base['median']) /
+                     base['median']))
+        return 1
+
+    print('%s: no regressions (total %.4fs, baseline %.4fs)'
+          % (args.name, results['total_wall']['median'],
+             baseline['total_wall']['median']))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())